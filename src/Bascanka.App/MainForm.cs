@@ -4,8 +4,10 @@ using Bascanka.Core.Buffer;
 using Bascanka.Core.Diff;
 using Bascanka.Core.Encoding;
 using Bascanka.Core.IO;
+using Bascanka.Core.Navigation;
 using Bascanka.Core.Search;
 using Bascanka.Core.Syntax;
+using Bascanka.Core.Transforms;
 using Bascanka.Editor.Controls;
 using Bascanka.Editor.Diff;
 using Bascanka.Editor.Panels;
@@ -37,6 +39,7 @@ public sealed class MainForm : Form
     private readonly BottomPanelTabStrip _bottomTabStrip;
     private readonly Panel _bottomContentPanel;
     private TerminalPanel? _terminalPanel;
+    private CsvTablePanel? _csvTablePanel;
 
     // ── Symbol list ───────────────────────────────────────────────────
     private readonly SymbolListPanel _symbolListPanel;
@@ -52,14 +55,13 @@ public sealed class MainForm : Form
     private readonly RecoveryManager _recoveryManager;
 
     // ── Deferred large-file recovery data ─────────────────────────────
-    // When a modified large file is restored from crash recovery but its tab
-    // is not the active tab, we defer the expensive async loading until the
-    // tab is first activated.  The recovery metadata is stashed here and
-    // consumed by LoadDeferredTab.
+    // When a modified large file is restored from crash recovery, we defer
+    // the expensive async loading until the tab is first activated.  The
+    // recovery metadata is stashed here and consumed by LoadDeferredTab,
+    // which only then reads the add buffer and pieces.
     private sealed record DeferredRecoveryData(
-        string AddBuffer, IReadOnlyList<Piece> Pieces,
         int CodePage, bool HasBom, string? LineEnding, string? Language,
-        long SavedCaret, int SavedScroll, int SavedZoom,
+        long SavedCaret, int SavedScroll, long SavedScrollOffset, int SavedZoom,
         Guid? RecoveryTabId, bool WordWrap, string? CustomProfileName);
     private readonly Dictionary<string, DeferredRecoveryData> _deferredRecovery = new(StringComparer.OrdinalIgnoreCase);
 
@@ -405,15 +407,8 @@ public sealed class MainForm : Form
                 if (mode is null) return; // cancelled
                 if (mode == "hex")
                 {
-                    if (fileSize > 100 * 1024 * 1024)
-                    {
-                        MessageBox.Show(this,
-                            string.Format(Strings.BinaryFileTooLargeForHex, fileSize / (1024 * 1024)),
-                            Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Warning);
-                        return;
-                    }
-                    byte[] rawBytes = File.ReadAllBytes(path);
-                    OpenBinaryFile(path, rawBytes);
+                    // The hex editor maps the file, so there is no size limit.
+                    OpenBinaryFile(path);
                     return;
                 }
                 // mode == "text": fall through with forced Latin-1 encoding
@@ -555,8 +550,21 @@ public sealed class MainForm : Form
     /// </summary>
     public void SaveAll()
     {
-        foreach (TabInfo tab in _tabs)
-        {
+        var skipped = new List<string>();
+        foreach (TabInfo tab in _tabs.ToList())
+        {
+            // A recovered tab that was never activated holds no text yet;
+            // a large one is loaded asynchronously and can only be saved
+            // once that finishes, so the user is told which were skipped.
+            if (tab.IsDeferredLoad && tab.PendingRecoveryFormat == "text")
+                LoadDeferredTab(tab);
+            if (tab.IsDeferredLoad)
+            {
+                if (tab.IsModified)
+                    skipped.Add(tab.FilePath ?? tab.Title);
+                continue;
+            }
+
             if (tab.IsModified)
             {
                 if (tab.FilePath is null)
@@ -571,6 +579,13 @@ public sealed class MainForm : Form
                 }
             }
         }
+
+        if (skipped.Count > 0)
+        {
+            MessageBox.Show(this,
+                string.Format(Strings.SaveAllSkippedRecoveredFormat, string.Join(Environment.NewLine, skipped)),
+                Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Warning);
+        }
     }
 
     /// <summary>
@@ -613,7 +628,7 @@ public sealed class MainForm : Form
         }
 
         // ── Deferred loading: load the file on first activation ───
-        if (tab.IsDeferredLoad && tab.FilePath is not null)
+        if (tab.IsDeferredLoad)
         {
             LoadDeferredTab(tab);
 
@@ -677,6 +692,7 @@ public sealed class MainForm : Form
         _menuBuilder.RefreshLanguageMenu(this);
         _menuBuilder.RefreshEncodingMenu(this);
         RefreshSymbolList(tab);
+        RefreshCsvTable();
     }
 
     /// <summary>
@@ -748,6 +764,241 @@ public sealed class MainForm : Form
         ActiveTab?.Editor.ShowGoToLineDialog();
     }
 
+    /// <summary>
+    /// Moves the caret to the bracket matching the one at the caret.
+    /// </summary>
+    public void GoToMatchingBracket()
+    {
+        ActiveTab?.Editor.GoToMatchingBracket();
+    }
+
+    /// <summary>
+    /// Shows the Go to JSON Path dialog for the active JSON document.
+    /// </summary>
+    public void ShowGoToJsonPath()
+    {
+        ActiveTab?.Editor.ShowGoToJsonPathDialog();
+    }
+
+    /// <summary>
+    /// Shows the Go to Time dialog for the active log document.
+    /// </summary>
+    public async void ShowGoToTime()
+    {
+        TabInfo? tab = ActiveTab;
+        if (tab is null || tab.IsLoading || !await EnsureLogTimestampsAsync(tab)) return;
+        tab.Editor.ShowGoToTimeDialog();
+    }
+
+    /// <summary>
+    /// Prompts for a range of times and selects the lines of the active log
+    /// stamped within it.
+    /// </summary>
+    public async void SelectTimeRange()
+    {
+        TabInfo? tab = ActiveTab;
+        if (tab is null || tab.IsLoading || !await EnsureLogTimestampsAsync(tab)) return;
+        tab.Editor.ShowSelectTimeRangeDialog();
+    }
+
+    /// <summary>
+    /// Prompts for a range of times and writes the lines of the active log
+    /// stamped within it to a new file, streamed from the document in the
+    /// document's encoding and line endings.
+    /// </summary>
+    public async void ExportTimeRange()
+    {
+        TabInfo? tab = ActiveTab;
+        if (tab is null || tab.IsLoading || !await EnsureLogTimestampsAsync(tab)) return;
+
+        EditorControl editor = tab.Editor;
+        if (editor.PromptTimeRange() is not { } range) return;
+
+        using var dialog = new SaveFileDialog
+        {
+            Title = Strings.MenuExportTimeRange.Replace("&", ""),
+            Filter = BuildFileFilter(),
+            FileName = Path.GetFileNameWithoutExtension(tab.FilePath ?? tab.Title) + "-range" +
+                       Path.GetExtension(tab.FilePath ?? tab.Title),
+        };
+        if (dialog.ShowDialog(this) != DialogResult.OK) return;
+
+        string path = dialog.FileName;
+        Encoding encoding = editor.EncodingManager?.CurrentEncoding ?? new UTF8Encoding(false);
+        bool hasBom = editor.EncodingManager?.HasBom ?? false;
+        string le = editor.LineEnding;
+        PieceTable document = editor.Document;
+
+        var theme = ThemeManager.Instance.CurrentTheme;
+        using var cts = new CancellationTokenSource();
+        var (overlayForm, dialogForm, progressLabel, progressBar) = CreateEditorOverlay(editor, theme, cts);
+
+        // The document is read on the background thread, so block edits.
+        tab.IsLoading = true;
+        editor.IsReadOnly = true;
+        try
+        {
+            var progress = new Progress<long>(written =>
+            {
+                if (range.Length <= 0) return;
+                progressBar.Value = Math.Min((int)(written * 1000 / range.Length), 1000);
+                progressLabel.Text = string.Format(Strings.SavingProgressFormat,
+                    StatusBarManager.FormatFileSize(written), StatusBarManager.FormatFileSize(range.Length));
+            });
+
+            await Task.Run(() =>
+            {
+                using var fs = new FileStream(path, FileMode.Create, FileAccess.Write,
+                    FileShare.None, bufferSize: 65536);
+                if (hasBom)
+                    fs.Write(encoding.GetPreamble());
+                WriteDocumentChunked(document, range.Start, range.Length, fs, encoding, le, progress, cts.Token);
+            });
+        }
+        catch (Exception ex)
+        {
+            try { File.Delete(path); } catch { /* best effort */ }
+            if (ex is not OperationCanceledException)
+                MessageBox.Show(ex.Message, Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Error);
+        }
+        finally
+        {
+            tab.IsLoading = false;
+            editor.IsReadOnly = false;
+            CloseEditorOverlay(overlayForm, dialogForm);
+        }
+    }
+
+    /// <summary>
+    /// Returns whether the lines of <paramref name="tab"/> start with
+    /// timestamps, and tells the user when they do not.  The first call
+    /// after an edit samples the document in the background behind a
+    /// progress overlay that can cancel it.
+    /// </summary>
+    private async Task<bool> EnsureLogTimestampsAsync(TabInfo tab)
+    {
+        EditorControl editor = tab.Editor;
+        LogTimeIndex? index;
+        if (editor.IsLogTimeIndexBuilt)
+        {
+            index = await editor.GetLogTimeIndexAsync();
+        }
+        else
+        {
+            var theme = ThemeManager.Instance.CurrentTheme;
+            using var cts = new CancellationTokenSource();
+            var (overlayForm, dialogForm, progressLabel, progressBar) = CreateEditorOverlay(editor, theme, cts);
+            progressLabel.Text = string.Format(Strings.IndexingTimestampsProgressFormat, 0);
+
+            // The document is sampled on the background thread, so block edits.
+            tab.IsLoading = true;
+            editor.IsReadOnly = true;
+            try
+            {
+                var progress = new Progress<int>(percent =>
+                {
+                    progressBar.Value = Math.Clamp(percent * 10, 0, 1000);
+                    progressLabel.Text = string.Format(Strings.IndexingTimestampsProgressFormat, percent);
+                });
+                index = await editor.GetLogTimeIndexAsync(progress, cts.Token);
+            }
+            catch (Exception ex)
+            {
+                if (ex is not OperationCanceledException)
+                    MessageBox.Show(ex.Message, Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Error);
+                return false;
+            }
+            finally
+            {
+                tab.IsLoading = false;
+                editor.IsReadOnly = false;
+                CloseEditorOverlay(overlayForm, dialogForm);
+            }
+
+            // The user may have moved to another tab meanwhile.
+            if (ActiveTab != tab) return false;
+        }
+
+        if (index is not null) return true;
+
+        MessageBox.Show(this, Strings.NoLogTimestamps, Strings.AppTitle,
+            MessageBoxButtons.OK, MessageBoxIcon.Information);
+        return false;
+    }
+
+    /// <summary>
+    /// Asks for a regular expression and opens a read-only tab showing the
+    /// lines of the active document it matches, numbered as in the
+    /// document.  The tab fills in while the document is read and follows
+    /// its edits and reloads.
+    /// </summary>
+    public void ShowFilteredView()
+    {
+        if (ActiveTab is not { IsLoading: false } sourceTab) return;
+
+        string? pattern = _pluginHost.ShowInputDialog(Strings.PromptFilterViewPattern);
+        if (string.IsNullOrEmpty(pattern)) return;
+
+        SearchOptions options = new() { Pattern = pattern, UseRegex = true, MatchCase = true };
+        LinePredicate match;
+        try
+        {
+            match = SearchEngine.CreateLinePredicate(options);
+        }
+        catch (ArgumentException ex)
+        {
+            MessageBox.Show(this, ex.Message, Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Warning);
+            return;
+        }
+
+        var editor = new EditorControl(new PieceTable(string.Empty))
+        {
+            Theme = ThemeManager.Instance.CurrentTheme
+        };
+        WireEditorEvents(editor);
+
+        string title = string.Format(Strings.FilterViewTitle, pattern);
+        var tab = new TabInfo
+        {
+            Title = title,
+            FilePath = null,
+            IsModified = false,
+            Editor = editor,
+        };
+
+        var view = new FilteredLineView(sourceTab.Editor, editor, match);
+        Exception? reported = null;
+        view.Updated += (_, _) =>
+        {
+            tab.Title = view.IsBuilding ? $"{title} ({view.Percent}%)" : title;
+            RefreshTabDisplay(tab);
+            if (view.Error is { } error && !ReferenceEquals(error, reported))
+            {
+                reported = error;
+                MessageBox.Show(this, error.Message, Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Warning);
+            }
+        };
+        tab.Tag = view;
+
+        AddTab(tab);
+    }
+
+    /// <summary>
+    /// Goes from the caret line of a filtered view to the same line in the
+    /// document the view filters.
+    /// </summary>
+    public void ShowFilteredLineInSource()
+    {
+        if (ActiveTab is not { Tag: FilteredLineView view } tab) return;
+
+        int sourceIndex = _tabs.FindIndex(t => ReferenceEquals(t.Editor, view.Source));
+        if (sourceIndex < 0) return;
+
+        long line = view.GetSourceLine(tab.Editor.CurrentLine);
+        ActivateTab(sourceIndex);
+        _tabs[sourceIndex].Editor.GoToLine(line);
+    }
+
     /// <summary>
     /// Sets the language/lexer for the active document.
     /// </summary>
@@ -839,6 +1090,106 @@ public sealed class MainForm : Form
         _menuBuilder.RefreshEncodingMenu(this);
     }
 
+    /// <summary>
+    /// Rewrites the file of the active document in <paramref name="encoding"/>
+    /// and reloads it.  The bytes on disk are streamed through
+    /// <see cref="StreamingTranscoder"/> into a temporary file next to the
+    /// original, behind a progress overlay that can cancel it, so files of
+    /// any size convert in bounded memory with their line endings kept as
+    /// they are.  A document that is unsaved or has edits has no file that
+    /// matches it, so its encoding is set for the next save instead.
+    /// </summary>
+    public async void ConvertFileEncoding(Encoding encoding, bool hasBom)
+    {
+        TabInfo? tab = ActiveTab;
+        if (tab is null || tab.IsLoading) return;
+        if (tab.FilePath is null || tab.IsModified)
+        {
+            SetEncoding(encoding, hasBom);
+            return;
+        }
+
+        EditorControl editor = tab.Editor;
+        string path = tab.FilePath;
+        string tmpPath = path + ".converting.tmp";
+        Encoding sourceEncoding = editor.EncodingManager?.CurrentEncoding ?? new UTF8Encoding(false);
+        long fileSize = new FileInfo(path).Length;
+
+        var theme = ThemeManager.Instance.CurrentTheme;
+        using var cts = new CancellationTokenSource();
+        var (overlayForm, dialogForm, progressLabel, progressBar) = CreateEditorOverlay(editor, theme, cts);
+
+        tab.IsLoading = true;
+        editor.IsReadOnly = true;
+        bool released = false;
+        bool overlayClosed = false;
+        try
+        {
+            var progress = new Progress<long>(read =>
+            {
+                if (fileSize <= 0) return;
+                progressBar.Value = Math.Min((int)(read * 1000 / fileSize), 1000);
+                progressLabel.Text = string.Format(Strings.ConvertingProgressFormat,
+                    StatusBarManager.FormatFileSize(read), StatusBarManager.FormatFileSize(fileSize));
+            });
+
+            await Task.Run(() =>
+            {
+                using var source = new FileStream(path, FileMode.Open, FileAccess.Read,
+                    FileShare.ReadWrite, bufferSize: 65536);
+                using var destination = new FileStream(tmpPath, FileMode.Create, FileAccess.Write,
+                    FileShare.None, bufferSize: 65536);
+                StreamingTranscoder.Transcode(source, sourceEncoding, destination, encoding,
+                    hasBom, progress, cts.Token);
+            });
+
+            // A memory-mapped document holds the file open; release it
+            // before the converted file takes its place.
+            long savedScroll = editor.ScrollMgr.FirstVisibleLine;
+            long savedCaret = editor.CaretOffset;
+            if (editor.IsMemoryMappedDocument)
+            {
+                SendMessage(editor.Handle, WM_SETREDRAW, IntPtr.Zero, IntPtr.Zero);
+                editor.Document = new PieceTable(string.Empty);
+                SendMessage(editor.Handle, WM_SETREDRAW, (IntPtr)1, IntPtr.Zero);
+                released = true;
+            }
+
+            _fileWatcher.SuppressNextChange(path);
+            File.Move(tmpPath, path, overwrite: true);
+
+            CloseEditorOverlay(overlayForm, dialogForm);
+            overlayClosed = true;
+            await ReloadDocumentAsync(tab, encoding);
+
+            long docLen = editor.Document.Length;
+            if (savedCaret > 0 && savedCaret <= docLen)
+                editor.CaretOffset = savedCaret;
+            editor.ScrollMgr.ScrollToLine(Math.Min(savedScroll, docLen));
+        }
+        catch (Exception ex)
+        {
+            try { File.Delete(tmpPath); } catch { /* best effort */ }
+            if (ex is not OperationCanceledException)
+                MessageBox.Show(ex.Message, Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Error);
+
+            // The original file is still in place; show it again.
+            if (released && !overlayClosed)
+            {
+                CloseEditorOverlay(overlayForm, dialogForm);
+                overlayClosed = true;
+                await ReloadDocumentAsync(tab);
+            }
+        }
+        finally
+        {
+            tab.IsLoading = false;
+            editor.IsReadOnly = false;
+            if (!overlayClosed)
+                CloseEditorOverlay(overlayForm, dialogForm);
+        }
+    }
+
     /// <summary>
     /// Sets the line ending mode for the active document.
     /// </summary>
@@ -877,6 +1228,254 @@ public sealed class MainForm : Form
             editor.TransformDocument(transform);
     }
 
+    /// <summary>
+    /// Selections up to this many characters are transformed in memory and
+    /// replaced as one undoable edit.
+    /// </summary>
+    private const long InMemoryTransformLimit = 16L * 1024 * 1024;
+
+    /// <summary>
+    /// Selections up to this many characters are transformed chunk by chunk
+    /// into edits that are applied as one undoable bulk edit.  Larger ones go
+    /// through a temporary file.
+    /// </summary>
+    private const long BulkEditTransformLimit = 256L * 1024 * 1024;
+
+    /// <summary>
+    /// Applies a chunked transform to the selection in the active editor.
+    /// </summary>
+    public void TransformSelectionInChunks(ChunkTransform transform)
+    {
+        if (ActiveTab is { } tab)
+            RunChunkTransform(tab, transform);
+    }
+
+    /// <summary>
+    /// Sorts the selected lines in the active editor.
+    /// </summary>
+    public void SortSelectedLines(LineSortOptions options)
+    {
+        if (ActiveTab is { } tab)
+            RunStreamingTransform(tab, LineSorter.Create(options));
+    }
+
+    /// <summary>
+    /// Removes, keeps only or counts the duplicate selected lines in the
+    /// active editor.
+    /// </summary>
+    public void ProcessDuplicateLines(DuplicateLineMode mode)
+    {
+        if (ActiveTab is { } tab)
+            RunStreamingTransform(tab, LineDeduplicator.Create(new DuplicateLineOptions { Mode = mode }));
+    }
+
+    /// <summary>
+    /// Pretty-prints or minifies the JSON in the selection, or in the whole
+    /// document when nothing is selected.
+    /// </summary>
+    public void ReformatJson(bool indented)
+    {
+        if (ActiveTab is { } tab)
+            RunStreamingTransform(tab, JsonReformatter.Create(indented), wholeDocumentIfNoSelection: true);
+    }
+
+    /// <summary>
+    /// Runs a chunked transform over the selection of the tab's editor on a
+    /// background thread and applies the changed chunks as one undoable
+    /// edit.  Selections above <see cref="InMemoryTransformLimit"/> show a
+    /// progress overlay that can cancel the transform; those above
+    /// <see cref="BulkEditTransformLimit"/> are streamed through
+    /// <see cref="RunStreamingTransform"/>.
+    /// </summary>
+    private async void RunChunkTransform(TabInfo tab, ChunkTransform transform)
+    {
+        EditorControl editor = tab.Editor;
+        var selection = editor.SelectionMgr;
+        if (tab.IsLoading || editor.IsReadOnly || selection.IsColumnMode || !selection.HasSelection) return;
+
+        long start = selection.SelectionStart;
+        long length = selection.SelectionEnd - start;
+        if (length > BulkEditTransformLimit)
+        {
+            RunStreamingTransform(tab, ChunkedTransformer.ToStreaming(transform));
+            return;
+        }
+
+        PieceTable document = editor.Document;
+        using var cts = new CancellationTokenSource();
+        (Form Overlay, Form Dialog, Label Label, ProgressBar Bar)? overlay = null;
+        IProgress<int>? progress = null;
+        if (length > InMemoryTransformLimit)
+        {
+            var created = CreateEditorOverlay(editor, ThemeManager.Instance.CurrentTheme, cts);
+            created.Label.Text = string.Format(Strings.TransformProgressFormat, 0);
+            created.Bar.Value = 0;
+            progress = new Progress<int>(percent =>
+            {
+                created.Bar.Value = Math.Clamp(percent * 10, 0, 1000);
+                created.Label.Text = string.Format(Strings.TransformProgressFormat, percent);
+            });
+            overlay = created;
+            tab.IsLoading = true;
+        }
+
+        List<TextEdit> edits;
+        editor.IsReadOnly = true;
+        try
+        {
+            edits = await Task.Run(() =>
+                ChunkedTransformer.CreateEdits(document, start, length, transform, progress, cts.Token));
+        }
+        catch (Exception ex)
+        {
+            if (ex is not OperationCanceledException)
+                MessageBox.Show(ex.Message, Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Error);
+            return;
+        }
+        finally
+        {
+            editor.IsReadOnly = false;
+            if (overlay is { } shown)
+            {
+                tab.IsLoading = false;
+                CloseEditorOverlay(shown.Overlay, shown.Dialog);
+            }
+        }
+
+        if (!_tabs.Contains(tab) || !ReferenceEquals(editor.Document, document) || edits.Count == 0)
+            return;
+
+        long delta = 0;
+        foreach (var edit in edits)
+            delta += edit.Text.Length - edit.Length;
+
+        editor.ApplyBulkEdit(edits, "Transform");
+        editor.Select(start, (int)(length + delta));
+    }
+
+    /// <summary>
+    /// Runs a streaming transform over the selection of the tab's editor on
+    /// a background thread.  Small selections are replaced as one undoable
+    /// edit.  Larger ones are streamed, together with the text around them,
+    /// into a temporary file behind a progress overlay that can cancel them,
+    /// and the document is rebuilt on that file; that edit clears the undo
+    /// history.
+    /// </summary>
+    /// <param name="wholeDocumentIfNoSelection">
+    /// Transform the whole document when nothing is selected, rather than
+    /// doing nothing.
+    /// </param>
+    /// <param name="wholeDocument">Transform the whole document regardless of the selection.</param>
+    private async void RunStreamingTransform(TabInfo tab, StreamingTransform transform,
+        bool wholeDocumentIfNoSelection = false, bool wholeDocument = false)
+    {
+        EditorControl editor = tab.Editor;
+        var selection = editor.SelectionMgr;
+        if (tab.IsLoading || editor.IsReadOnly || (selection.IsColumnMode && !wholeDocument)) return;
+
+        PieceTable document = editor.Document;
+        bool hasSelection = selection.HasSelection && !wholeDocument;
+        if (!hasSelection && !wholeDocumentIfNoSelection && !wholeDocument) return;
+
+        long start = hasSelection ? selection.SelectionStart : 0;
+        long length = hasSelection ? selection.SelectionEnd - start : document.Length;
+
+        if (length <= InMemoryTransformLimit)
+        {
+            var output = new StringWriter();
+            editor.IsReadOnly = true;
+            try
+            {
+                await Task.Run(() => transform(document, start, length, output, null, CancellationToken.None));
+            }
+            catch (Exception ex)
+            {
+                MessageBox.Show(ex.Message, Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Error);
+                return;
+            }
+            finally
+            {
+                editor.IsReadOnly = false;
+            }
+
+            string result = output.ToString();
+            if (!_tabs.Contains(tab) || !ReferenceEquals(editor.Document, document)
+                || result == document.GetText(start, (int)length))
+                return;
+
+            editor.ReplaceRange(start, length, result);
+            if (hasSelection)
+                editor.Select(start, result.Length);
+            return;
+        }
+
+        string tmpPath = Path.Combine(Path.GetTempPath(), $"bascanka-{Guid.NewGuid():N}.transform");
+        var theme = ThemeManager.Instance.CurrentTheme;
+        using var cts = new CancellationTokenSource();
+        var (overlayForm, dialogForm, progressLabel, progressBar) = CreateEditorOverlay(editor, theme, cts);
+        progressLabel.Text = string.Format(Strings.TransformProgressFormat, 0);
+        progressBar.Value = 0;
+
+        // Block editing, saving and the recovery timer while the document
+        // is read on the background thread.
+        tab.IsLoading = true;
+        editor.IsReadOnly = true;
+        MemoryMappedFileSource? source = null;
+        try
+        {
+            var progress = new Progress<int>(percent =>
+            {
+                progressBar.Value = Math.Clamp(percent * 10, 0, 1000);
+                progressLabel.Text = string.Format(Strings.TransformProgressFormat, percent);
+            });
+
+            long docLength = document.Length;
+            source = await Task.Run(() =>
+            {
+                using (var writer = new StreamWriter(tmpPath, append: false, new UTF8Encoding(false), 1024 * 1024))
+                {
+                    WriteRangeChunked(document, 0, start, writer);
+                    transform(document, start, length, writer, progress, cts.Token);
+                    WriteRangeChunked(document, start + length, docLength - start - length, writer);
+                }
+                return new MemoryMappedFileSource(tmpPath, new UTF8Encoding(false),
+                    normalizeLineEndings: true, deleteOnDispose: true);
+            });
+
+            if (!_tabs.Contains(tab) || !ReferenceEquals(editor.Document, document))
+            {
+                source.Dispose();
+                return;
+            }
+
+            var transformed = new PieceTable(source);
+            if (source.LineOffsets is { } lineOffsets)
+                transformed.SetLineOffsetCache((long[])lineOffsets.Clone());
+
+            // The new document lives in the temporary file, so it is saved
+            // like any other memory-mapped document.
+            editor.IsMemoryMappedDocument = true;
+            editor.ReplaceDocumentContent(transformed, start);
+        }
+        catch (Exception ex)
+        {
+            if (source is not null)
+                source.Dispose();
+            else if (File.Exists(tmpPath))
+                try { File.Delete(tmpPath); } catch { /* best effort */ }
+
+            if (ex is not OperationCanceledException)
+                MessageBox.Show(ex.Message, Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Error);
+        }
+        finally
+        {
+            tab.IsLoading = false;
+            editor.IsReadOnly = false;
+            CloseEditorOverlay(overlayForm, dialogForm);
+            UpdateStatusBar();
+        }
+    }
+
     /// <summary>
     /// Toggles word wrap in the active editor.
     /// </summary>
@@ -1004,6 +1603,108 @@ public sealed class MainForm : Form
     /// <summary>Whether the Terminal tab is currently selected in the bottom panel.</summary>
     public bool IsTerminalTabActive => _bottomTabStrip.SelectedTabId == "terminal";
 
+    /// <summary>Whether the Table View tab is currently selected in the bottom panel.</summary>
+    public bool IsCsvTableTabActive => _bottomTabStrip.SelectedTabId == "csvTable";
+
+    /// <summary>
+    /// Toggles the table view of the active document as CSV or TSV. Creates
+    /// the table tab on first call.
+    /// </summary>
+    public void ToggleCsvTable()
+    {
+        if (IsBottomPanelVisible && IsCsvTableTabActive)
+        {
+            IsBottomPanelVisible = false;
+        }
+        else
+        {
+            EnsureCsvTableTab();
+            RefreshCsvTable();
+            _bottomTabStrip.SelectTab("csvTable");
+            ShowSelectedBottomTab();
+            IsBottomPanelVisible = true;
+        }
+    }
+
+    private void EnsureCsvTableTab()
+    {
+        if (_bottomTabStrip.HasTab("csvTable")) return;
+
+        _csvTablePanel = new CsvTablePanel
+        {
+            Dock = DockStyle.Fill,
+            Visible = false,
+            Theme = ThemeManager.Instance.CurrentTheme
+        };
+        _csvTablePanel.NavigateToLine += OnCsvNavigateToLine;
+        _csvTablePanel.SortRequested += OnCsvSortRequested;
+        _csvTablePanel.FilterRequested += OnCsvFilterRequested;
+        _bottomContentPanel.Controls.Add(_csvTablePanel);
+
+        _bottomTabStrip.AddTab(new BottomPanelTab
+        {
+            Id = "csvTable",
+            Title = Strings.MenuTableView.Replace("&", ""),
+            Content = _csvTablePanel,
+            Closable = true,
+        });
+    }
+
+    /// <summary>Shows the active document in the table view, if it is open.</summary>
+    private void RefreshCsvTable()
+    {
+        if (_csvTablePanel is null) return;
+
+        if (ActiveTab is { } tab)
+            _csvTablePanel.Attach(tab.Editor.Document, DetectCsvDialect(tab));
+        else
+            _csvTablePanel.Attach(null, CsvDialect.Comma);
+    }
+
+    /// <summary>
+    /// Picks the dialect of a tab: tab-separated for <c>.tsv</c> and
+    /// <c>.tab</c> files, otherwise guessed from the start of the document.
+    /// </summary>
+    private static CsvDialect DetectCsvDialect(TabInfo tab)
+    {
+        string extension = Path.GetExtension(tab.FilePath ?? string.Empty);
+        if (extension.Equals(".tsv", StringComparison.OrdinalIgnoreCase)
+            || extension.Equals(".tab", StringComparison.OrdinalIgnoreCase))
+            return CsvDialect.Tab;
+
+        PieceTable document = tab.Editor.Document;
+        return CsvDialect.Detect(document.GetText(0, (int)Math.Min(document.Length, 64 * 1024)));
+    }
+
+    private void OnCsvNavigateToLine(object? sender, CsvLineEventArgs e)
+    {
+        if (ActiveTab is not { } tab) return;
+        tab.Editor.GoToLine(e.Line);
+        tab.Editor.Focus();
+    }
+
+    private void OnCsvSortRequested(object? sender, CsvSortRequestEventArgs e)
+    {
+        if (ActiveTab is not { } tab || _csvTablePanel is not { } panel) return;
+
+        RunStreamingTransform(tab, LineSorter.Create(new LineSortOptions
+        {
+            Csv = panel.Dialect,
+            KeyField = e.Column + 1,
+            Descending = e.Descending,
+            Comparison = e.Numeric ? LineComparison.Numeric : LineComparison.Ordinal,
+            KeepFirstLine = panel.FirstRowIsHeader,
+        }), wholeDocument: true);
+    }
+
+    private void OnCsvFilterRequested(object? sender, CsvFilterRequestEventArgs e)
+    {
+        if (ActiveTab is not { } tab || _csvTablePanel is not { } panel) return;
+
+        RunStreamingTransform(tab, LineFilter.Create(panel.Dialect.CreateFieldPredicate(e.Column, e.Value),
+            keepFirstLine: panel.FirstRowIsHeader), wholeDocument: true);
+    }
+
     private void EnsureTerminalTab()
     {
         if (_bottomTabStrip.HasTab("terminal")) return;
@@ -1054,9 +1755,17 @@ public sealed class MainForm : Form
             _findResultsPanel.Visible = false;
             _bottomTabStrip.RemoveTab("findResults");
         }
+        else if (e.TabId == "csvTable" && _csvTablePanel is not null)
+        {
+            _bottomContentPanel.Controls.Remove(_csvTablePanel);
+            _csvTablePanel.Dispose();
+            _csvTablePanel = null;
+            _bottomTabStrip.RemoveTab("csvTable");
+        }
 
         // If no tabs remain, collapse the panel
-        if (!_bottomTabStrip.HasTab("findResults") && !_bottomTabStrip.HasTab("terminal"))
+        if (!_bottomTabStrip.HasTab("findResults") && !_bottomTabStrip.HasTab("terminal")
+            && !_bottomTabStrip.HasTab("csvTable"))
         {
             IsBottomPanelVisible = false;
         }
@@ -1071,6 +1780,7 @@ public sealed class MainForm : Form
     {
         _findResultsPanel.Visible = _bottomTabStrip.SelectedTabId == "findResults";
         _terminalPanel?.Visible = _bottomTabStrip.SelectedTabId == "terminal";
+        _csvTablePanel?.Visible = _bottomTabStrip.SelectedTabId == "csvTable";
     }
 
     /// <summary>
@@ -1196,11 +1906,100 @@ public sealed class MainForm : Form
     /// </summary>
     public void PlayMacro() => ActiveTab?.Editor.PlayMacro();
 
+    /// <summary>
+    /// Plays the last recorded macro repeatedly until the end of the document.
+    /// </summary>
+    public void PlayMacroToEnd() => ActiveTab?.Editor.PlayMacroToEnd();
+
+    /// <summary>
+    /// Asks for a regular expression and plays the last recorded macro once
+    /// on every line it matches.
+    /// </summary>
+    public void PlayMacroOnMatchingLines()
+    {
+        if (ActiveTab is not { } tab) return;
+
+        string? pattern = _pluginHost.ShowInputDialog(Strings.PromptMacroLinePattern);
+        if (string.IsNullOrEmpty(pattern)) return;
+
+        SearchOptions options = new() { Pattern = pattern, UseRegex = true, MatchCase = true };
+        try
+        {
+            SearchEngine.CreateLinePredicate(options);
+        }
+        catch (ArgumentException ex)
+        {
+            MessageBox.Show(this, ex.Message, Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Warning);
+            return;
+        }
+
+        tab.Editor.PlayMacroOnMatchingLines(options);
+    }
+
     /// <summary>
     /// Shows the macro manager dialog.
     /// </summary>
     public void ShowMacroManager() => ActiveTab?.Editor.ShowMacroManager();
 
+    /// <summary>
+    /// Playbacks that finish within this time never show the progress
+    /// overlay, so short macros do not flash it.
+    /// </summary>
+    private const int MacroOverlayDelayMs = 300;
+
+    /// <summary>
+    /// Shows a progress overlay with a Cancel button over the editor while
+    /// one of its macro playbacks runs longer than
+    /// <see cref="MacroOverlayDelayMs"/>, and reports playback failures.
+    /// </summary>
+    private void WireMacroPlayback(EditorControl editor)
+    {
+        (Form Overlay, Form Dialog, Label Label, ProgressBar Bar)? overlay = null;
+        CancellationTokenSource? cts = null;
+        int percent = 0;
+        var delay = new System.Windows.Forms.Timer { Interval = MacroOverlayDelayMs };
+
+        void showProgress()
+        {
+            if (overlay is not { } shown) return;
+            shown.Bar.Value = Math.Clamp(percent * 10, 0, 1000);
+            shown.Label.Text = string.Format(Strings.MacroProgressFormat, percent);
+        }
+
+        delay.Tick += (_, _) =>
+        {
+            delay.Stop();
+            if (cts is null || editor.IsDisposed || !editor.IsPlayingMacro) return;
+            overlay = CreateEditorOverlay(editor, ThemeManager.Instance.CurrentTheme, cts);
+            showProgress();
+        };
+
+        editor.MacroPlaybackStarted += (_, _) =>
+        {
+            percent = 0;
+            cts = new CancellationTokenSource();
+            cts.Token.Register(editor.CancelMacroPlayback);
+            delay.Start();
+        };
+        editor.MacroPlaybackProgressChanged += (_, e) =>
+        {
+            percent = e.Percent;
+            showProgress();
+        };
+        editor.MacroPlaybackFinished += (_, _) =>
+        {
+            delay.Stop();
+            if (overlay is { } shown)
+                CloseEditorOverlay(shown.Overlay, shown.Dialog);
+            overlay = null;
+            cts?.Dispose();
+            cts = null;
+        };
+        editor.MacroPlaybackError += (_, e) =>
+            MessageBox.Show(this, e.Exception.Message, Strings.AppTitle, MessageBoxButtons.OK, MessageBoxIcon.Error);
+        editor.Disposed += (_, _) => delay.Dispose();
+    }
+
     // ── Printing ──────────────────────────────────────────────────────
 
     private System.Drawing.Printing.PrintDocument? _printDoc;
@@ -1461,8 +2260,18 @@ public sealed class MainForm : Form
     /// </summary>
     public async void ReloadActiveDocument()
     {
-        TabInfo? tab = ActiveTab;
-        if (tab?.FilePath is null) return;
+        if (ActiveTab is { } tab)
+            await ReloadDocumentAsync(tab);
+    }
+
+    /// <summary>
+    /// Reloads the document of <paramref name="tab"/> from disk, decoding it
+    /// with <paramref name="encoding"/>, or with the detected encoding when
+    /// <see langword="null"/>.
+    /// </summary>
+    private async Task ReloadDocumentAsync(TabInfo tab, Encoding? encoding = null)
+    {
+        if (tab.FilePath is null) return;
 
         try
         {
@@ -1475,7 +2284,7 @@ public sealed class MainForm : Form
                 tab.Editor.IsReadOnly = true;
 
                 var source = await Task.Run(() =>
-                    new MemoryMappedFileSource(filePath, normalizeLineEndings: true, deferScan: true));
+                    new MemoryMappedFileSource(filePath, encoding, normalizeLineEndings: true, deferScan: true));
 
                 const int FirstBatchChunks = 128;
                 const int SubsequentBatchChunks = 2048;
@@ -1552,7 +2361,7 @@ public sealed class MainForm : Form
 
             // ── Small file path: existing sync reload ───────────────
             byte[] rawBytes = File.ReadAllBytes(tab.FilePath);
-            var encoding = EncodingDetector.DetectEncoding(rawBytes.AsSpan());
+            encoding ??= EncodingDetector.DetectEncoding(rawBytes.AsSpan());
             byte[] preamble = encoding.GetPreamble();
             bool hasBom = preamble.Length > 0 && rawBytes.Length >= preamble.Length
                 && rawBytes.AsSpan(0, preamble.Length).SequenceEqual(preamble);
@@ -1855,9 +2664,9 @@ public sealed class MainForm : Form
     /// The expensive async MMF scanning is delayed until the tab is activated.
     /// </summary>
     internal void AddDeferredRecoveryLargeTab(
-        string path, string addBuffer, IReadOnlyList<Piece> pieces,
+        string path,
         int codePage, bool hasBom, string? lineEnding, string? language,
-        long savedCaret, int savedScroll, int savedZoom,
+        long savedCaret, int savedScroll, long savedScrollOffset, int savedZoom,
         Guid? recoveryTabId, bool wordWrap, string? customProfileName)
     {
         var editor = new EditorControl
@@ -1875,6 +2684,7 @@ public sealed class MainForm : Form
             IsDeferredLoad = true,
             PendingZoom = savedZoom,
             PendingScroll = savedScroll,
+            PendingScrollOffset = savedScrollOffset,
             PendingCaret = savedCaret,
             PendingWordWrap = wordWrap ? true : null,
             PendingLanguage = language,
@@ -1886,8 +2696,9 @@ public sealed class MainForm : Form
         };
 
         _deferredRecovery[path] = new DeferredRecoveryData(
-            addBuffer, pieces, codePage, hasBom, lineEnding, language,
-            savedCaret, savedScroll, savedZoom, recoveryTabId, wordWrap, customProfileName);
+            codePage, hasBom, lineEnding, language,
+            savedCaret, savedScroll, savedScrollOffset, savedZoom,
+            recoveryTabId, wordWrap, customProfileName);
 
         _tabs.Add(tab);
         _tabStrip.AddTab(tab, select: false);
@@ -1897,14 +2708,15 @@ public sealed class MainForm : Form
     /// Asynchronously restores a large MMF-backed tab from recovery data.
     /// Creates a placeholder tab immediately, scans the file incrementally on a
     /// background thread, then reconstructs the piece table from recovery pieces.
-    /// Same pattern as <see cref="OpenLargeFile"/>.
+    /// Same pattern as <see cref="OpenLargeFile"/>, including showing the
+    /// saved position first when <paramref name="savedScrollOffset"/> is set.
     /// </summary>
     internal async void RestoreLargeFileFromRecovery(
         string path, long fileSize,
         string addBuffer, IReadOnlyList<Piece> pieces,
         int codePage, bool hasBom, string? lineEnding, string? language,
         int savedZoom, Guid? recoveryTabId = null, bool wordWrap = false,
-        string? customProfileName = null)
+        string? customProfileName = null, long savedCaret = 0, long savedScrollOffset = -1)
     {
         // 1. Create tab immediately with an empty document + read-only.
         var editor = new EditorControl(new PieceTable(string.Empty))
@@ -1965,6 +2777,11 @@ public sealed class MainForm : Form
                         : RecoveryManager.FilterPiecesToScannedRange(
                             pieces, scannedCharLen, source);
 
+                    // Viewport first: nothing is shown until the scan
+                    // reaches the saved position, so skip the document.
+                    if (!d && savedScrollOffset > safePieces.Sum(p => p.Length))
+                        return (Done: false, Doc: (PieceTable?)null, source.ScannedBytes);
+
                     ITextSource textSrc = d
                         ? (ITextSource)source
                         : new BorrowedTextSource(source);
@@ -1985,17 +2802,28 @@ public sealed class MainForm : Form
                         pt.PrecomputeLineOffsets();
                     }
 
-                    return (Done: d, Doc: pt, source.ScannedBytes);
+                    return (Done: d, Doc: (PieceTable?)pt, source.ScannedBytes);
                 });
 
                 done = Done;
 
                 if (!_tabs.Contains(tab))
                 {
-                    Doc.Dispose();
+                    if (Doc is not null)
+                        Doc.Dispose();
+                    else
+                        source.Dispose();
                     return;
                 }
 
+                if (Doc is null)
+                {
+                    if (ActiveTab == tab)
+                        _statusBarManager.ShowLoadingProgress(ScannedBytes, fileSize);
+                    batchSize = SubsequentBatchChunks;
+                    continue;
+                }
+
                 long curScroll = tab.Editor.ScrollMgr.FirstVisibleLine;
                 long curCaret = tab.Editor.CaretOffset;
 
@@ -2004,10 +2832,18 @@ public sealed class MainForm : Form
                 {
                     tab.Editor.Document = Doc;
 
-                    long docLen = tab.Editor.Document.Length;
-                    if (curCaret > 0 && curCaret <= docLen)
-                        tab.Editor.CaretOffset = curCaret;
-                    tab.Editor.ScrollMgr.ScrollToLine(curScroll);
+                    if (savedScrollOffset >= 0)
+                    {
+                        ShowSavedPosition(tab.Editor, savedScrollOffset, savedCaret);
+                        savedScrollOffset = -1;
+                    }
+                    else
+                    {
+                        long docLen = tab.Editor.Document.Length;
+                        if (curCaret > 0 && curCaret <= docLen)
+                            tab.Editor.CaretOffset = curCaret;
+                        tab.Editor.ScrollMgr.ScrollToLine(curScroll);
+                    }
                 }
                 finally
                 {
@@ -2077,38 +2913,54 @@ public sealed class MainForm : Form
     /// </summary>
     private void LoadDeferredTab(TabInfo tab)
     {
-        string path = tab.FilePath!;
         tab.IsDeferredLoad = false;
 
-        if (!File.Exists(path))
+        // Modified text from crash recovery: the editor was set up at
+        // startup, only the text is read now.
+        if (tab.PendingRecoveryFormat == "text")
+        {
+            LoadDeferredRecoveryText(tab);
+            return;
+        }
+
+        string? path = tab.FilePath;
+        if (path is null || !File.Exists(path))
             return;
 
         // Check for deferred recovery data (modified large file from crash recovery).
         if (_deferredRecovery.Remove(path, out var recovery))
         {
-            long fileSize = new FileInfo(path).Length;
-            int idx = _tabs.IndexOf(tab);
-            if (idx >= 0)
+            var (addBuffer, pieces) = RecoveryManager.ReadRecoveryPieces(tab.Id);
+            if (addBuffer is not null && pieces is not null)
             {
-                _tabs.RemoveAt(idx);
-                _tabStrip.RemoveTab(idx);
-                _deferredInsertIndex = idx;
+                long fileSize = new FileInfo(path).Length;
+                int idx = _tabs.IndexOf(tab);
+                if (idx >= 0)
+                {
+                    _tabs.RemoveAt(idx);
+                    _tabStrip.RemoveTab(idx);
+                    _deferredInsertIndex = idx;
+                }
+                RestoreLargeFileFromRecovery(
+                    path, fileSize,
+                    addBuffer, pieces,
+                    recovery.CodePage, recovery.HasBom, recovery.LineEnding, recovery.Language,
+                    recovery.SavedZoom, recovery.RecoveryTabId, recovery.WordWrap,
+                    recovery.CustomProfileName, recovery.SavedCaret, recovery.SavedScrollOffset);
+                _deferredInsertIndex = -1;
+                return;
             }
-            RestoreLargeFileFromRecovery(
-                path, fileSize,
-                recovery.AddBuffer, recovery.Pieces,
-                recovery.CodePage, recovery.HasBom, recovery.LineEnding, recovery.Language,
-                recovery.SavedZoom, recovery.RecoveryTabId, recovery.WordWrap,
-                recovery.CustomProfileName);
-            _deferredInsertIndex = -1;
-            return;
+
+            // Unreadable recovery data: fall back to the file on disk.
+            tab.IsModified = false;
         }
 
         try
         {
             long fileSize = new FileInfo(path).Length;
+            bool isBinary = IsBinaryFileFromStream(path);
 
-            if (IsBinaryFileFromStream(path) || fileSize > LargeFileThreshold)
+            if (isBinary || fileSize > LargeFileThreshold)
             {
                 // Binary / large files need specialised loading.
                 // Remove the placeholder and use the normal OpenFile path,
@@ -2120,7 +2972,10 @@ public sealed class MainForm : Form
                     _tabStrip.RemoveTab(idx);
                     _deferredInsertIndex = idx;
                 }
-                OpenFile(path);
+                if (isBinary)
+                    OpenFile(path);
+                else
+                    OpenLargeFile(path, fileSize, scrollOffset: tab.PendingScrollOffset, caret: tab.PendingCaret);
                 _deferredInsertIndex = -1;
                 return;
             }
@@ -2164,6 +3019,49 @@ public sealed class MainForm : Form
         }
     }
 
+    /// <summary>
+    /// Reads the recovered text of a deferred text-format tab into its
+    /// editor, which <see cref="RecoveryManager"/> already configured.
+    /// If the text is unreadable the tab is left empty and unmodified, so
+    /// that saving cannot overwrite the file with nothing.
+    /// </summary>
+    private static void LoadDeferredRecoveryText(TabInfo tab)
+    {
+        tab.PendingRecoveryFormat = null;
+        try
+        {
+            string text = RecoveryManager.ReadRecoveryText(tab.Id);
+            tab.Editor.Document = new PieceTable(text);
+
+            // Set file size for the status bar from recovered content.
+            var sizeEnc = tab.Editor.EncodingManager?.CurrentEncoding
+                ?? new UTF8Encoding(false);
+            tab.Editor.FileSizeBytes = sizeEnc.GetByteCount(text);
+        }
+        catch (Exception ex)
+        {
+            System.Diagnostics.Debug.WriteLine($"Failed to load recovered text: {ex.Message}");
+            tab.IsModified = false;
+        }
+    }
+
+    /// <summary>
+    /// Scrolls a progressively loaded editor to the line containing
+    /// <paramref name="scrollOffset"/> and places the caret, once the
+    /// scanned part of the file covers the saved position.
+    /// </summary>
+    private static void ShowSavedPosition(EditorControl editor, long scrollOffset, long caret)
+    {
+        PieceTable doc = editor.Document;
+
+        // Caret first so that the saved scroll position wins over EnsureVisible.
+        if (caret > 0 && caret <= doc.Length)
+            editor.CaretOffset = caret;
+
+        long line = doc.OffsetToLineColumn(Math.Min(scrollOffset, doc.Length)).Line;
+        editor.ScrollMgr.ScrollToLine(line);
+    }
+
     /// <summary>
     /// Applies and clears pending zoom/scroll/caret/language state on a tab.
     /// </summary>
@@ -2523,11 +3421,20 @@ public sealed class MainForm : Form
             }
         }
 
+        // Filtered views read this tab's document, which is disposed below.
+        for (int i = _tabs.Count - 1; i >= 0; i--)
+        {
+            if (_tabs[i].Tag is FilteredLineView filtered && ReferenceEquals(filtered.Source, tab.Editor))
+                CloseTab(i);
+        }
+        index = _tabs.IndexOf(tab);
+
         // Cleanup.
         string closedPath = tab.FilePath ?? string.Empty;
         if (tab.FilePath is not null)
             _fileWatcher.Unwatch(tab.FilePath);
 
+        (tab.Tag as FilteredLineView)?.Dispose();
         _editorPanel.Controls.Remove(tab.Editor);
         tab.Editor.Dispose();
         if (tab.Tag is DiffViewControl diffView)
@@ -2556,6 +3463,7 @@ public sealed class MainForm : Form
             _statusBarManager.Clear();
             _menuBuilder.UpdateMenuState(this);
             _symbolListPanel.Clear();
+            RefreshCsvTable();
         }
         else
         {
@@ -2685,10 +3593,18 @@ public sealed class MainForm : Form
 
             // Validate: the written file must not be drastically smaller than
             // the original.  A truncated write (e.g. from corrupted piece data)
-            // would silently destroy the user's file on the swap below.
-            long originalFileSize = new FileInfo(tab.FilePath).Length;
+            // would silently destroy the user's file on the swap below.  A
+            // document rebuilt by a transform (sort, dedupe) is not made of
+            // pieces of the original, and may legitimately be much smaller.
+            // A change of encoding, such as UTF-16 to UTF-8, may shrink the
+            // file by as much as the ratio of the encodings' ASCII widths.
+            bool rebuilt = document.OriginalSource is MemoryMappedFileSource { DeleteOnDispose: true };
+            long originalFileSize = !rebuilt && File.Exists(tab.FilePath) ? new FileInfo(tab.FilePath).Length : 0;
+            int shrink = document.OriginalSource is MemoryMappedFileSource mapped
+                ? Math.Max(1, mapped.Encoding.GetByteCount("a") / encoding.GetByteCount("a"))
+                : 1;
             long writtenSize = new FileInfo(tmpPath).Length;
-            if (originalFileSize > 0 && writtenSize < originalFileSize / 2)
+            if (originalFileSize > 0 && writtenSize < originalFileSize / (2 * shrink))
             {
                 try { File.Delete(tmpPath); } catch { }
                 tab.Editor.IsReadOnly = false;
@@ -2836,36 +3752,43 @@ public sealed class MainForm : Form
 
     /// <summary>
     /// Writes a <see cref="PieceTable"/> to a stream in 1 MB chunks with line
-    /// ending conversion.  Safe to call from a background thread when no
-    /// concurrent writes are happening to the document.
+    /// ending conversion, encoding the chunks in parallel through
+    /// <see cref="StreamingTranscoder"/>.  Safe to call from a background
+    /// thread when no concurrent writes are happening to the document.
     /// </summary>
     private static void WriteDocumentChunked(PieceTable document, FileStream fs,
         Encoding encoding, string lineEnding, IProgress<long>? progress = null)
     {
-        const int ChunkSize = 1024 * 1024;
-        long docLength = document.Length;
-        long offset = 0;
-
-        while (offset < docLength)
-        {
-            long remaining = docLength - offset;
-            int take = (int)Math.Min(remaining, ChunkSize);
-
-            string chunk = document.GetText(offset, take);
-
-            if (chunk.Contains('\r'))
-                chunk = chunk.Replace("\r\n", "\n").Replace("\r", "\n");
+        WriteDocumentChunked(document, 0, document.Length, fs, encoding, lineEnding, progress,
+            CancellationToken.None);
+    }
 
-            if (lineEnding == "CRLF")
-                chunk = chunk.Replace("\n", "\r\n");
-            else if (lineEnding == "CR")
-                chunk = chunk.Replace("\n", "\r");
+    /// <summary>
+    /// Writes <c>document[start, start + length)</c> to a file stream like
+    /// <see cref="WriteDocumentChunked(PieceTable, FileStream, Encoding, string, IProgress{long}?)"/>,
+    /// reporting the characters written so far.
+    /// </summary>
+    private static void WriteDocumentChunked(PieceTable document, long start, long length, FileStream fs,
+        Encoding encoding, string lineEnding, IProgress<long>? progress, CancellationToken cancellationToken)
+    {
+        StreamingTranscoder.Encode(document, start, length, fs, encoding, lineEnding, progress, cancellationToken);
+    }
 
-            byte[] bytes = encoding.GetBytes(chunk);
-            fs.Write(bytes, 0, bytes.Length);
+    /// <summary>
+    /// Copies <c>document[offset, offset + length)</c> to a writer in 1 MB
+    /// chunks.  Safe to call from a background thread when no concurrent
+    /// writes are happening to the document.
+    /// </summary>
+    private static void WriteRangeChunked(PieceTable document, long offset, long length, TextWriter writer)
+    {
+        const int ChunkSize = 1024 * 1024;
+        long end = offset + length;
 
+        while (offset < end)
+        {
+            int take = (int)Math.Min(end - offset, ChunkSize);
+            writer.Write(document.GetText(offset, take));
             offset += take;
-            progress?.Report(offset);
         }
     }
 
@@ -2874,9 +3797,12 @@ public sealed class MainForm : Form
     /// dimming effect, and a small opaque dialog with themed progress controls.
     /// The overlay uses <see cref="Form.Opacity"/> so the text behind it stays
     /// visible.  Only this editor is blocked — other tabs remain interactive.
+    /// When <paramref name="cancellation"/> is given, the dialog also has a
+    /// Cancel button that cancels it.
     /// </summary>
     private (Form Overlay, Form Dialog, Label Label, ProgressBar Bar) CreateEditorOverlay(
-        EditorControl editor, Bascanka.Editor.Themes.ITheme theme)
+        EditorControl editor, Bascanka.Editor.Themes.ITheme theme,
+        CancellationTokenSource? cancellation = null)
     {
         var screenBounds = editor.RectangleToScreen(editor.ClientRectangle);
 
@@ -2931,18 +3857,41 @@ public sealed class MainForm : Form
             ForeColor = theme.EditorForeground,
         };
 
+        const int cancelWidth = 80;
+        int barWidth = cancellation is null ? dlgWidth - pad * 2 : dlgWidth - pad * 3 - cancelWidth;
+
         var bar = new ProgressBar
         {
             Style = ProgressBarStyle.Continuous,
             Minimum = 0,
             Maximum = 1000,
             Location = new Point(pad, 32),
-            Size = new Size(dlgWidth - pad * 2, 28),
+            Size = new Size(barWidth, 28),
         };
 
         dialog.Controls.Add(label);
         dialog.Controls.Add(bar);
 
+        if (cancellation is not null)
+        {
+            var cancelButton = new Button
+            {
+                Text = Strings.ButtonCancel,
+                FlatStyle = FlatStyle.Flat,
+                Location = new Point(dlgWidth - pad - cancelWidth, 32),
+                Size = new Size(cancelWidth, 28),
+                BackColor = theme.EditorBackground,
+                ForeColor = theme.EditorForeground,
+            };
+            cancelButton.FlatAppearance.BorderColor = borderColor;
+            cancelButton.Click += (_, _) =>
+            {
+                cancelButton.Enabled = false;
+                cancellation.Cancel();
+            };
+            dialog.Controls.Add(cancelButton);
+        }
+
         // Center the dialog on the overlay / editor area.
         void centerDialog()
         {
@@ -3000,53 +3949,87 @@ public sealed class MainForm : Form
         editor.ZoomChanged += OnEditorZoomChanged;
         editor.HexPanelVisibilityChanged += (_, _) => _menuBuilder.UpdateMenuState(this);
         editor.InsertModeChanged += (_, _) => UpdateStatusBar();
+        editor.DocumentChanged += (_, _) =>
+        {
+            if (ActiveTab?.Editor == editor)
+                RefreshCsvTable();
+        };
+        editor.JsonIndexChanged += (_, _) =>
+        {
+            UpdateStatusBar();
+            _menuBuilder.UpdateMenuState(this);
+        };
+        editor.StatisticsChanged += (_, _) =>
+        {
+            if (ActiveTab?.Editor == editor)
+                UpdateStatusBar();
+        };
         editor.FindNextRequested += OnEditorFindNextRequested;
         editor.FindAllRequested += OnEditorFindAllRequested;
         editor.FindAllInTabsRequested += OnEditorFindAllInTabsRequested;
+        WireMacroPlayback(editor);
         BuildEditorContextMenu(editor);
         ApplyEditorLocalization(editor);
     }
 
-    private static void BuildEditorContextMenu(EditorControl editor)
+    private void BuildEditorContextMenu(EditorControl editor)
     {
+        // Line transforms run in the background behind the tab's progress overlay.
+        void runTransform(StreamingTransform transform, bool wholeDocumentIfNoSelection = false)
+        {
+            if (_tabs.FirstOrDefault(t => t.Editor == editor) is { } tab)
+                RunStreamingTransform(tab, transform, wholeDocumentIfNoSelection);
+        }
+
+        // Per-line and encoding transforms run chunk by chunk as one bulk edit.
+        void runChunked(ChunkTransform transform)
+        {
+            if (_tabs.FirstOrDefault(t => t.Editor == editor) is { } tab)
+                RunChunkTransform(tab, transform);
+        }
+
         var selectedTextMenu = new ToolStripMenuItem(Strings.CtxSelectedText);
 
         // ── Case conversions ────────────────────────────────────
         var caseMenu = new ToolStripMenuItem(Strings.MenuCaseConversion);
         caseMenu.DropDownItems.AddRange([
-            new ToolStripMenuItem(Strings.MenuUpperCase, null, (_, _) => editor.TransformSelection(TextTransformations.ToUpperCase)),
-            new ToolStripMenuItem(Strings.MenuLowerCase, null, (_, _) => editor.TransformSelection(TextTransformations.ToLowerCase)),
-            new ToolStripMenuItem(Strings.MenuTitleCase, null, (_, _) => editor.TransformSelection(TextTransformations.ToTitleCase)),
-            new ToolStripMenuItem(Strings.MenuSwapCase, null, (_, _) => editor.TransformSelection(TextTransformations.SwapCase)),
+            new ToolStripMenuItem(Strings.MenuUpperCase, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.ToUpperCase))),
+            new ToolStripMenuItem(Strings.MenuLowerCase, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.ToLowerCase))),
+            new ToolStripMenuItem(Strings.MenuTitleCase, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.ToTitleCase))),
+            new ToolStripMenuItem(Strings.MenuSwapCase, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.SwapCase))),
         ]);
 
         // ── Encoding ────────────────────────────────────────────
         var encMenu = new ToolStripMenuItem(Strings.MenuTextEncoding);
         encMenu.DropDownItems.AddRange([
-            new ToolStripMenuItem(Strings.MenuBase64Encode, null, (_, _) => editor.TransformSelection(TextTransformations.Base64Encode)),
-            new ToolStripMenuItem(Strings.MenuBase64Decode, null, (_, _) => editor.TransformSelection(TextTransformations.Base64Decode)),
+            new ToolStripMenuItem(Strings.MenuBase64Encode, null, (_, _) => runChunked(new Base64EncodeTransform())),
+            new ToolStripMenuItem(Strings.MenuBase64Decode, null, (_, _) => runChunked(new Base64DecodeTransform())),
             new ToolStripSeparator(),
-            new ToolStripMenuItem(Strings.MenuUrlEncode, null, (_, _) => editor.TransformSelection(TextTransformations.UrlEncode)),
-            new ToolStripMenuItem(Strings.MenuUrlDecode, null, (_, _) => editor.TransformSelection(TextTransformations.UrlDecode)),
+            new ToolStripMenuItem(Strings.MenuUrlEncode, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.UrlEncode))),
+            new ToolStripMenuItem(Strings.MenuUrlDecode, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.UrlDecode))),
             new ToolStripSeparator(),
-            new ToolStripMenuItem(Strings.MenuHtmlEncode, null, (_, _) => editor.TransformSelection(TextTransformations.HtmlEncode)),
-            new ToolStripMenuItem(Strings.MenuHtmlDecode, null, (_, _) => editor.TransformSelection(TextTransformations.HtmlDecode)),
+            new ToolStripMenuItem(Strings.MenuHtmlEncode, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.HtmlEncode))),
+            new ToolStripMenuItem(Strings.MenuHtmlDecode, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.HtmlDecode))),
         ]);
 
         selectedTextMenu.DropDownItems.AddRange([
             caseMenu, encMenu,
             new ToolStripSeparator(),
-            new ToolStripMenuItem(Strings.MenuSortLinesAsc, null, (_, _) => editor.TransformSelection(TextTransformations.SortLinesAscending)),
-            new ToolStripMenuItem(Strings.MenuSortLinesDesc, null, (_, _) => editor.TransformSelection(TextTransformations.SortLinesDescending)),
-            new ToolStripMenuItem(Strings.MenuRemoveDuplicateLines, null, (_, _) => editor.TransformSelection(TextTransformations.RemoveDuplicateLines)),
+            new ToolStripMenuItem(Strings.MenuSortLinesAsc, null, (_, _) => runTransform(LineSorter.Create(new LineSortOptions()))),
+            new ToolStripMenuItem(Strings.MenuSortLinesDesc, null, (_, _) => runTransform(LineSorter.Create(new LineSortOptions { Descending = true }))),
+            new ToolStripMenuItem(Strings.MenuSortLinesIgnoreCase, null, (_, _) => runTransform(LineSorter.Create(new LineSortOptions { Comparison = LineComparison.IgnoreCase }))),
+            new ToolStripMenuItem(Strings.MenuSortLinesNumeric, null, (_, _) => runTransform(LineSorter.Create(new LineSortOptions { Comparison = LineComparison.Numeric }))),
+            new ToolStripMenuItem(Strings.MenuRemoveDuplicateLines, null, (_, _) => runTransform(LineDeduplicator.Create(new DuplicateLineOptions()))),
+            new ToolStripMenuItem(Strings.MenuKeepOnlyDuplicateLines, null, (_, _) => runTransform(LineDeduplicator.Create(new DuplicateLineOptions { Mode = DuplicateLineMode.KeepOnlyDuplicates }))),
+            new ToolStripMenuItem(Strings.MenuCountDuplicateLines, null, (_, _) => runTransform(LineDeduplicator.Create(new DuplicateLineOptions { Mode = DuplicateLineMode.CountDuplicates }))),
             new ToolStripMenuItem(Strings.MenuReverseLines, null, (_, _) => editor.TransformSelection(TextTransformations.ReverseLines)),
             new ToolStripSeparator(),
-            new ToolStripMenuItem(Strings.MenuTrimTrailingWhitespace, null, (_, _) => editor.TransformSelection(TextTransformations.TrimTrailingWhitespace)),
-            new ToolStripMenuItem(Strings.MenuTrimLeadingWhitespace, null, (_, _) => editor.TransformSelection(TextTransformations.TrimLeadingWhitespace)),
-            new ToolStripMenuItem(Strings.MenuCompactWhitespace, null, (_, _) => editor.TransformSelection(TextTransformations.CompactWhitespace)),
+            new ToolStripMenuItem(Strings.MenuTrimTrailingWhitespace, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.TrimTrailingWhitespace))),
+            new ToolStripMenuItem(Strings.MenuTrimLeadingWhitespace, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.TrimLeadingWhitespace))),
+            new ToolStripMenuItem(Strings.MenuCompactWhitespace, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.CompactWhitespace))),
             new ToolStripSeparator(),
-            new ToolStripMenuItem(Strings.MenuTabsToSpaces, null, (_, _) => editor.TransformSelection(TextTransformations.TabsToSpaces)),
-            new ToolStripMenuItem(Strings.MenuSpacesToTabs, null, (_, _) => editor.TransformSelection(TextTransformations.SpacesToTabs)),
+            new ToolStripMenuItem(Strings.MenuTabsToSpaces, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.TabsToSpaces))),
+            new ToolStripMenuItem(Strings.MenuSpacesToTabs, null, (_, _) => runChunked(ChunkTransform.PerLine(TextTransformations.SpacesToTabs))),
             new ToolStripSeparator(),
             new ToolStripMenuItem(Strings.MenuReverseText, null, (_, _) => editor.TransformSelection(TextTransformations.ReverseText)),
         ]);
@@ -3055,19 +4038,9 @@ public sealed class MainForm : Form
         var jsonMenu = new ToolStripMenuItem(Strings.MenuJson);
         jsonMenu.DropDownItems.AddRange([
             new ToolStripMenuItem(Strings.MenuJsonFormat, null, (_, _) =>
-            {
-                if (editor.SelectionLength > 0)
-                    editor.TransformSelection(TextTransformations.JsonFormat);
-                else
-                    editor.TransformDocument(TextTransformations.JsonFormat);
-            }),
+                runTransform(JsonReformatter.Create(indented: true), wholeDocumentIfNoSelection: true)),
             new ToolStripMenuItem(Strings.MenuJsonMinimize, null, (_, _) =>
-            {
-                if (editor.SelectionLength > 0)
-                    editor.TransformSelection(TextTransformations.JsonMinimize);
-                else
-                    editor.TransformDocument(TextTransformations.JsonMinimize);
-            }),
+                runTransform(JsonReformatter.Create(indented: false), wholeDocumentIfNoSelection: true)),
         ]);
 
         editor.AddContextMenuItems([selectedTextMenu, jsonMenu], [selectedTextMenu]);
@@ -3370,6 +4343,7 @@ public sealed class MainForm : Form
         // ── Bottom panel tab strip and terminal ─────────────────────
         _bottomTabStrip.Theme = theme;
         _terminalPanel?.Theme = theme;
+        _csvTablePanel?.Theme = theme;
 
         // ── Symbol list panel ────────────────────────────────────────
         _symbolListPanel.Theme = theme;
@@ -3421,6 +4395,8 @@ public sealed class MainForm : Form
         _bottomTabStrip.SetTabTitle("findResults", Strings.FindResultsHeader);
         if (_bottomTabStrip.HasTab("terminal"))
             _bottomTabStrip.SetTabTitle("terminal", Strings.MenuTerminal.Replace("&", ""));
+        if (_bottomTabStrip.HasTab("csvTable"))
+            _bottomTabStrip.SetTabTitle("csvTable", Strings.MenuTableView.Replace("&", ""));
 
         // Update all open editor context menus.
         foreach (var tab in _tabs)
@@ -3474,7 +4450,7 @@ public sealed class MainForm : Form
     /// <summary>
     /// Opens a binary file in hex-only mode (no text editor).
     /// </summary>
-    private void OpenBinaryFile(string path, byte[] rawBytes)
+    private void OpenBinaryFile(string path)
     {
         var pieceTable = new PieceTable(string.Empty);
         var editor = new EditorControl(pieceTable)
@@ -3483,7 +4459,7 @@ public sealed class MainForm : Form
             IsReadOnly = true
         };
         WireEditorEvents(editor);
-        editor.ShowHexOnly(rawBytes);
+        editor.ShowHexOnly(path);
 
         var tab = new TabInfo
         {
@@ -3725,9 +4701,12 @@ public sealed class MainForm : Form
     /// <summary>
     /// Opens a large file with incremental progressive loading.  The user sees
     /// content appear and grow as chunks are scanned in the background.
+    /// When <paramref name="scrollOffset"/> is set (a restored session), the
+    /// document is first shown once the scan reaches that offset, already
+    /// scrolled there, and the rest of the file is scanned afterwards.
     /// </summary>
     private async void OpenLargeFile(string path, long fileSize,
-        System.Text.Encoding? forcedEncoding = null)
+        System.Text.Encoding? forcedEncoding = null, long scrollOffset = -1, long caret = 0)
     {
         // 1. Create tab immediately with an empty document.
         var editor = new EditorControl(new PieceTable(string.Empty))
@@ -3794,6 +4773,16 @@ public sealed class MainForm : Form
                     return;
                 }
 
+                // Viewport first: nothing is shown until the scan reaches
+                // the saved position, so skip the document swaps before it.
+                if (!done && scrollOffset > source.Length)
+                {
+                    if (ActiveTab == tab)
+                        _statusBarManager.ShowLoadingProgress(source.ScannedBytes, fileSize);
+                    batchSize = SubsequentBatchChunks;
+                    continue;
+                }
+
                 long savedScroll = tab.Editor.ScrollMgr.FirstVisibleLine;
                 long savedCaret = tab.Editor.CaretOffset;
                 var selMgr = tab.Editor.SelectionMgr;
@@ -3816,20 +4805,28 @@ public sealed class MainForm : Form
                     if (ownedLineOffsets is not null)
                         tab.Editor.Document.SetLineOffsetCache(ownedLineOffsets);
 
-                    // Restore caret BEFORE scroll so that the scroll position
-                    // the user is actually looking at wins over EnsureVisible.
-                    long docLen = tab.Editor.Document.Length;
-                    if (hadSelection && savedSelStart < docLen)
+                    if (scrollOffset >= 0)
                     {
-                        long clampedEnd = Math.Min(savedSelEnd, docLen);
-                        tab.Editor.Select(savedSelStart, (int)(clampedEnd - savedSelStart));
+                        ShowSavedPosition(tab.Editor, scrollOffset, caret);
+                        scrollOffset = -1;
                     }
-                    else if (savedCaret > 0 && savedCaret <= docLen)
+                    else
                     {
-                        tab.Editor.CaretOffset = savedCaret;
-                    }
+                        // Restore caret BEFORE scroll so that the scroll position
+                        // the user is actually looking at wins over EnsureVisible.
+                        long docLen = tab.Editor.Document.Length;
+                        if (hadSelection && savedSelStart < docLen)
+                        {
+                            long clampedEnd = Math.Min(savedSelEnd, docLen);
+                            tab.Editor.Select(savedSelStart, (int)(clampedEnd - savedSelStart));
+                        }
+                        else if (savedCaret > 0 && savedCaret <= docLen)
+                        {
+                            tab.Editor.CaretOffset = savedCaret;
+                        }
 
-                    tab.Editor.ScrollMgr.ScrollToLine(savedScroll);
+                        tab.Editor.ScrollMgr.ScrollToLine(savedScroll);
+                    }
                 }
                 finally
                 {
@@ -3898,6 +4895,7 @@ public sealed class MainForm : Form
         public char this[long index] => _inner[index];
         public long Length => _inner.Length;
         public string GetText(long start, long length) => _inner.GetText(start, length);
+        public void CopyTo(long start, Span<char> destination) => _inner.CopyTo(start, destination);
         public int CountLineFeeds(long start, long length) => _inner.CountLineFeeds(start, length);
         public int InitialLineFeedCount => _inner.InitialLineFeedCount;
         public long[]? LineOffsets => _inner.LineOffsets;
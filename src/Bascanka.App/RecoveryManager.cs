@@ -14,10 +14,16 @@ namespace Bascanka.App;
 /// Silently writes document state to disk every 10 seconds, enabling full
 /// workspace restoration across launches and after crashes. Recovery data is
 /// stored in <c>%AppData%\Bascanka\recovery\</c>.
+/// <para>
+/// Restored tabs are placeholders: no tab reads its recovery data or
+/// scans its file until it is first activated, so only the tab that was
+/// active is loaded at startup.
+/// </para>
 /// </summary>
 public sealed class RecoveryManager : IDisposable
 {
-    // Binary format magic bytes and version for piece-table recovery files.
+    // Magic bytes and version of the pieces files written before recovery
+    // moved to edit journals; still read when restoring an older session.
     private static readonly byte[] Magic = "BSRV"u8.ToArray();
     private const uint FormatVersion = 1;
 
@@ -32,6 +38,7 @@ public sealed class RecoveryManager : IDisposable
     private readonly MainForm _form;
     private readonly System.Windows.Forms.Timer _timer;
     private readonly HashSet<Guid> _dirtyTabs = [];
+    private readonly Dictionary<Guid, EditJournal> _journals = [];
     private bool _saving;
     private bool _disposed;
 
@@ -69,16 +76,21 @@ public sealed class RecoveryManager : IDisposable
     public void ForceWrite() => OnTimerTick(null, EventArgs.Empty);
 
     /// <summary>
-    /// Removes the recovery content file for a tab (e.g. after save or close).
+    /// Removes the recovery files for a tab (e.g. after save or close).
     /// </summary>
     public void RemoveTabRecovery(Guid tabId)
     {
         _dirtyTabs.Remove(tabId);
         try
         {
-            string contentPath = Path.Combine(RecoveryDir, $"{tabId}.content");
-            if (File.Exists(contentPath))
-                File.Delete(contentPath);
+            if (_journals.Remove(tabId, out var journal))
+                journal.Delete();
+
+            foreach (string file in RecoveryFiles(tabId))
+            {
+                if (File.Exists(file))
+                    File.Delete(file);
+            }
         }
         catch { /* best effort */ }
     }
@@ -130,13 +142,22 @@ public sealed class RecoveryManager : IDisposable
                 if (!tab.IsModified) continue;
                 if (!_dirtyTabs.Contains(tab.Id)) continue;
 
+                // A document rebuilt by a large transform lives in a
+                // temporary file that does not outlive the process; its
+                // journal could not be replayed, so the tab reopens its file.
+                if (tab.Editor.Document.OriginalSource is MemoryMappedFileSource { DeleteOnDispose: true })
+                {
+                    RemoveTabRecovery(tab.Id);
+                    continue;
+                }
+
                 WriteTabContent(tab);
             }
 
             WriteManifest(tabs);
             _dirtyTabs.Clear();
 
-            // Remove orphaned .content files from previous sessions whose
+            // Remove orphaned recovery files from previous sessions whose
             // tab IDs no longer exist (e.g. after recovery restore with
             // preserved IDs, old files from closed tabs linger).
             CleanOrphanedContentFiles(tabs);
@@ -153,58 +174,41 @@ public sealed class RecoveryManager : IDisposable
 
     // ── Per-tab content writing ──────────────────────────────────────
 
-    private static void WriteTabContent(TabInfo tab)
-    {
-        string contentPath = Path.Combine(RecoveryDir, $"{tab.Id}.content");
-        string tmpPath = contentPath + ".tmp";
+    private static string CheckpointPath(Guid tabId) => Path.Combine(RecoveryDir, $"{tabId}.checkpoint");
+    private static string JournalPath(Guid tabId) => Path.Combine(RecoveryDir, $"{tabId}.journal");
+    private static string LegacyContentPath(Guid tabId) => Path.Combine(RecoveryDir, $"{tabId}.content");
 
-        try
-        {
-            if (tab.Editor.IsMemoryMappedDocument)
-                WritePiecesFormat(tab, tmpPath);
-            else
-                WriteTextFormat(tab, tmpPath);
+    private static string[] RecoveryFiles(Guid tabId) =>
+        [CheckpointPath(tabId), CheckpointPath(tabId) + ".tmp", JournalPath(tabId), LegacyContentPath(tabId)];
 
-            // Atomic swap.
-            if (File.Exists(contentPath))
-                File.Delete(contentPath);
-            File.Move(tmpPath, contentPath);
-        }
-        catch
+    /// <summary>
+    /// Records the tab's document in its edit journal.  After the first
+    /// write only what changed since the previous tick is appended, so a
+    /// few keystrokes in a large document cost a few hundred bytes rather
+    /// than a rewrite of the whole text.  Memory-mapped documents keep
+    /// their original on disk; their journal holds only the add buffer
+    /// and the piece list.
+    /// </summary>
+    private void WriteTabContent(TabInfo tab)
+    {
+        if (!_journals.TryGetValue(tab.Id, out var journal))
         {
-            // Clean up partial write.
-            try { if (File.Exists(tmpPath)) File.Delete(tmpPath); } catch { }
+            journal = new EditJournal(CheckpointPath(tab.Id), JournalPath(tab.Id));
+            _journals[tab.Id] = journal;
         }
-    }
-
-    private static void WriteTextFormat(TabInfo tab, string tmpPath)
-    {
-        string text = tab.Editor.Document.ToString();
-        File.WriteAllText(tmpPath, text, new UTF8Encoding(false));
-    }
-
-    private static void WritePiecesFormat(TabInfo tab, string tmpPath)
-    {
-        var doc = tab.Editor.Document;
-        string addBuffer = doc.GetAddBufferContents();
-        var pieces = doc.GetPiecesInOrder();
-        byte[] addBufferBytes = Encoding.UTF8.GetBytes(addBuffer);
-
-        using var fs = new FileStream(tmpPath, FileMode.Create, FileAccess.Write, FileShare.None);
-        using var bw = new BinaryWriter(fs);
 
-        bw.Write(Magic);                      // 4 bytes: "BSRV"
-        bw.Write(FormatVersion);               // uint32
-        bw.Write((long)addBufferBytes.Length); // int64: add buffer byte length
-        bw.Write(addBufferBytes);              // raw UTF-8 add buffer
-        bw.Write(pieces.Count);                // int32: piece count
+        try
+        {
+            journal.Write(tab.Editor.Document, includeOriginal: !tab.Editor.IsMemoryMappedDocument);
 
-        foreach (var p in pieces)
+            // A full-content file left by an older version is superseded.
+            string legacyPath = LegacyContentPath(tab.Id);
+            if (File.Exists(legacyPath))
+                File.Delete(legacyPath);
+        }
+        catch (Exception ex)
         {
-            bw.Write((byte)p.BufferType);      // byte: 0=Original, 1=Add
-            bw.Write(p.Start);                 // int64
-            bw.Write(p.Length);                // int64
-            bw.Write(p.LineFeeds);             // int32
+            System.Diagnostics.Debug.WriteLine($"Recovery journal write failed: {ex.Message}");
         }
     }
 
@@ -237,6 +241,8 @@ public sealed class RecoveryManager : IDisposable
                 entry["IsDeferredLoad"] = true;
                 entry["Caret"] = (long)tab.PendingCaret;
                 entry["Scroll"] = tab.PendingScroll;
+                if (tab.PendingScrollOffset > 0)
+                    entry["ScrollOffset"] = tab.PendingScrollOffset;
                 entry["Zoom"] = tab.PendingZoom;
                 if (tab.PendingWordWrap == true)
                     entry["WordWrap"] = 1;
@@ -261,6 +267,12 @@ public sealed class RecoveryManager : IDisposable
             {
                 entry["Caret"] = tab.Editor.CaretOffset;
                 entry["Scroll"] = (int)tab.Editor.ScrollMgr.FirstVisibleLine;
+
+                // The line's offset can be shown as soon as a progressive
+                // scan reaches it, before the file's line count is known.
+                long firstLine = tab.Editor.ScrollMgr.FirstVisibleLine;
+                if (!tab.Editor.WordWrap && firstLine > 0 && firstLine < tab.Editor.Document.LineCount)
+                    entry["ScrollOffset"] = tab.Editor.Document.GetLineStartOffset(firstLine);
                 entry["Zoom"] = tab.Editor.ZoomLevel;
                 entry["Language"] = tab.Editor.Language;
                 entry["LineEnding"] = tab.Editor.LineEnding;
@@ -330,21 +342,32 @@ public sealed class RecoveryManager : IDisposable
         File.Move(tmpPath, ManifestPath);
     }
 
-    private static void CleanOrphanedContentFiles(IReadOnlyList<TabInfo> tabs)
+    private void CleanOrphanedContentFiles(IReadOnlyList<TabInfo> tabs)
     {
         try
         {
-            var knownIds = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+            var knownIds = new HashSet<Guid>();
             foreach (var tab in tabs)
-                knownIds.Add(tab.Id.ToString());
+                knownIds.Add(tab.Id);
 
-            foreach (string file in Directory.EnumerateFiles(RecoveryDir, "*.content"))
+            foreach (Guid id in _journals.Keys.Where(id => !knownIds.Contains(id)).ToList())
             {
-                string name = Path.GetFileNameWithoutExtension(file);
-                if (!knownIds.Contains(name))
-                {
-                    try { File.Delete(file); } catch { }
-                }
+                _journals[id].Dispose();
+                _journals.Remove(id);
+            }
+
+            foreach (string file in Directory.EnumerateFiles(RecoveryDir))
+            {
+                if (Path.GetFileName(file) == Path.GetFileName(ManifestPath))
+                    continue;
+
+                // "{id}.content", "{id}.journal", "{id}.checkpoint.tmp", ...
+                string name = Path.GetFileName(file);
+                int dot = name.IndexOf('.');
+                if (dot > 0 && Guid.TryParse(name.AsSpan(0, dot), out Guid id) && knownIds.Contains(id))
+                    continue;
+
+                try { File.Delete(file); } catch { }
             }
         }
         catch { /* best effort */ }
@@ -440,44 +463,24 @@ public sealed class RecoveryManager : IDisposable
         bool isBinary = GetBool(tabEl, "IsBinaryMode");
         bool isDeferred = GetBool(tabEl, "IsDeferredLoad");
 
-        // Skip binary tabs — nothing to recover.
+        // Binary tabs — nothing to recover; reopened in the hex view on activation.
         if (isBinary && path is not null && File.Exists(path))
         {
-            _form.OpenFile(path);
+            _form.AddDeferredTab(path, 0, 0, 0);
             return true;
         }
 
-        // Deferred tabs — restore as deferred if file exists.
-        if (isDeferred && path is not null && File.Exists(path))
+        // Deferred tabs — restore as deferred if file exists.  A modified
+        // tab that was never activated keeps its recovery data; text-format
+        // tabs take the modified-tab path below.
+        if (isDeferred && path is not null && File.Exists(path) && !(isModified && format == "text"))
         {
             // Deferred tab with recovery data (modified large file) — re-defer
             // with recovery metadata so loading happens only when activated.
-            if (isModified && format == "pieces")
+            if (isModified && format == "pieces"
+                && Guid.TryParse(idStr, out Guid recTabId) && HasRecoveryContent(recTabId))
             {
-                Guid? recTabId = Guid.TryParse(idStr, out var parsed) ? parsed : null;
-                string recContentPath = Path.Combine(RecoveryDir, $"{recTabId}.content");
-                if (File.Exists(recContentPath))
-                {
-                    var (addBuffer, pieces) = ReadPiecesFile(recContentPath);
-                    if (addBuffer is not null && pieces is not null)
-                    {
-                        int codePage = GetInt(tabEl, "EncodingCodePage", 65001);
-                        bool hasBom = GetBool(tabEl, "HasBom");
-                        string? lineEnding = GetString(tabEl, "LineEnding");
-                        string? language = GetString(tabEl, "Language");
-                        string? customProfile = GetString(tabEl, "CustomProfileName");
-                        long caret2 = GetLong(tabEl, "Caret", 0);
-                        int scroll2 = GetInt(tabEl, "Scroll", 0);
-                        int zoom2 = GetInt(tabEl, "Zoom", 0);
-                        bool wordWrap2 = GetInt(tabEl, "WordWrap", 0) != 0;
-
-                        _form.AddDeferredRecoveryLargeTab(
-                            path, addBuffer, pieces,
-                            codePage, hasBom, lineEnding, language,
-                            caret2, scroll2, zoom2, recTabId, wordWrap2, customProfile);
-                        return true;
-                    }
-                }
+                return RestorePiecesTab(tabEl, recTabId, path);
             }
 
             int zoom = GetInt(tabEl, "Zoom", 0);
@@ -494,6 +497,7 @@ public sealed class RecoveryManager : IDisposable
             tab.PendingLanguage = pendingLanguage;
             tab.PendingCustomProfileName = pendingCustomProfile;
             tab.SelectedCustomProfileName = pendingCustomProfile;
+            tab.PendingScrollOffset = GetLong(tabEl, "ScrollOffset", 0);
             return true;
         }
 
@@ -517,6 +521,7 @@ public sealed class RecoveryManager : IDisposable
                 tab.PendingLanguage = pendingLanguage;
                 tab.PendingCustomProfileName = pendingCustomProfile;
                 tab.SelectedCustomProfileName = pendingCustomProfile;
+                tab.PendingScrollOffset = GetLong(tabEl, "ScrollOffset", 0);
                 return true;
             }
             return false;
@@ -526,32 +531,34 @@ public sealed class RecoveryManager : IDisposable
 
         if (!Guid.TryParse(idStr, out Guid tabId)) return false;
 
-        string contentPath = Path.Combine(RecoveryDir, $"{tabId}.content");
-        if (!File.Exists(contentPath))
+        if (!HasRecoveryContent(tabId))
         {
-            // No content file — try to open the file normally if it exists.
+            // No content file — reopen the file from disk when activated.
             if (path is not null && File.Exists(path))
             {
-                _form.OpenFile(path);
+                _form.AddDeferredTab(path, 0, 0, 0);
                 return true;
             }
             return false;
         }
 
         if (format == "pieces")
-            return RestorePiecesTab(tabEl, tabId, contentPath, path);
+            return RestorePiecesTab(tabEl, tabId, path);
 
         // Default to text format.
-        return RestoreTextTab(tabEl, tabId, contentPath, path);
+        return RestoreTextTab(tabEl, tabId, path);
     }
 
-    private bool RestoreTextTab(JsonElement tabEl, Guid tabId, string contentPath, string? path)
+    /// <summary>
+    /// Adds a text-format tab whose editor is configured from the manifest
+    /// but whose text is read from the recovery directory only when the
+    /// tab is first activated (see <see cref="ReadRecoveryText"/>).
+    /// </summary>
+    private bool RestoreTextTab(JsonElement tabEl, Guid tabId, string? path)
     {
         try
         {
-            string text = File.ReadAllText(contentPath, new UTF8Encoding(false));
-            var pieceTable = new PieceTable(text);
-            var editor = new EditorControl(pieceTable)
+            var editor = new EditorControl
             {
                 Theme = ThemeManager.Instance.CurrentTheme
             };
@@ -596,11 +603,6 @@ public sealed class RecoveryManager : IDisposable
                 }
             }
 
-            // Set file size for the status bar from recovered content.
-            var sizeEnc = editor.EncodingManager?.CurrentEncoding
-                ?? new UTF8Encoding(false);
-            editor.FileSizeBytes = sizeEnc.GetByteCount(text);
-
             bool wordWrap = GetInt(tabEl, "WordWrap", 0) != 0;
 
             _form.WireAndAddRecoveredTab(new TabInfo
@@ -610,8 +612,14 @@ public sealed class RecoveryManager : IDisposable
                 FilePath = (path is not null && File.Exists(path)) ? path : null,
                 IsModified = true,
                 Editor = editor,
+                IsDeferredLoad = true,
                 PendingWordWrap = wordWrap ? true : null,
                 PendingCustomProfileName = customProfile,
+                SelectedCustomProfileName = customProfile,
+                PendingRecoveryFormat = "text",
+                PendingEncodingCodePage = codePage,
+                PendingHasBom = hasBom,
+                PendingLineEnding = lineEnding,
             },
             caret: GetLong(tabEl, "Caret", 0),
             scroll: GetInt(tabEl, "Scroll", 0),
@@ -626,21 +634,22 @@ public sealed class RecoveryManager : IDisposable
         }
     }
 
-    private bool RestorePiecesTab(JsonElement tabEl, Guid tabId, string contentPath, string? path)
+    private bool RestorePiecesTab(JsonElement tabEl, Guid tabId, string? path)
     {
         if (path is null || !File.Exists(path))
             return false;
 
         try
         {
-            // Validate original file hasn't changed.
+            // Validate original file hasn't changed; if it has, the pieces no
+            // longer apply and the file is reopened as it is on disk.
             var fi = new FileInfo(path);
             long savedSize = GetLong(tabEl, "OriginalFileSize", -1);
             string? savedWrite = GetString(tabEl, "OriginalLastWrite");
 
             if (savedSize >= 0 && fi.Length != savedSize)
             {
-                _form.OpenFile(path);
+                _form.AddDeferredTab(path, 0, 0, 0);
                 return true;
             }
 
@@ -649,48 +658,45 @@ public sealed class RecoveryManager : IDisposable
             {
                 if (Math.Abs((fi.LastWriteTimeUtc - savedDt).TotalSeconds) > 2)
                 {
-                    _form.OpenFile(path);
+                    _form.AddDeferredTab(path, 0, 0, 0);
                     return true;
                 }
             }
 
-            // Read the binary recovery file (tiny — just add buffer + piece descriptors).
-            var (addBuffer, pieces) = ReadPiecesFile(contentPath);
-            if (pieces is null)
-            {
-                _form.OpenFile(path);
-                return true;
-            }
-
-            // Collect metadata before kicking off async work.
-            int codePage = GetInt(tabEl, "EncodingCodePage", 65001);
-            bool hasBom = GetBool(tabEl, "HasBom");
-            string? lineEnding = GetString(tabEl, "LineEnding");
-            string? language = GetString(tabEl, "Language");
-            string? customProfile = GetString(tabEl, "CustomProfileName");
-            long caret = GetLong(tabEl, "Caret", 0);
-            int scroll = GetInt(tabEl, "Scroll", 0);
-            int zoom = GetInt(tabEl, "Zoom", 0);
-            bool wordWrap = GetInt(tabEl, "WordWrap", 0) != 0;
-
-            // Defer loading until tab is activated — avoids loading multi-GB
-            // files in the background on startup.
-            _form.AddDeferredRecoveryLargeTab(
-                path, addBuffer!, pieces,
-                codePage, hasBom, lineEnding, language,
-                caret, scroll, zoom, tabId, wordWrap, customProfile);
-
+            AddDeferredPiecesTab(tabEl, tabId, path);
             return true;
         }
         catch (Exception ex)
         {
             System.Diagnostics.Debug.WriteLine($"Failed to restore pieces tab: {ex.Message}");
             if (File.Exists(path))
-                _form.OpenFile(path);
+                _form.AddDeferredTab(path, 0, 0, 0);
             return true;
         }
     }
 
+    /// <summary>
+    /// Adds a placeholder for a modified large file.  Neither the recovery
+    /// data nor the file is read until the tab is activated — avoids
+    /// loading multi-GB files in the background on startup.
+    /// </summary>
+    private void AddDeferredPiecesTab(JsonElement tabEl, Guid tabId, string path)
+    {
+        _form.AddDeferredRecoveryLargeTab(
+            path,
+            codePage: GetInt(tabEl, "EncodingCodePage", 65001),
+            hasBom: GetBool(tabEl, "HasBom"),
+            lineEnding: GetString(tabEl, "LineEnding"),
+            language: GetString(tabEl, "Language"),
+            savedCaret: GetLong(tabEl, "Caret", 0),
+            savedScroll: GetInt(tabEl, "Scroll", 0),
+            savedScrollOffset: GetLong(tabEl, "ScrollOffset", 0),
+            savedZoom: GetInt(tabEl, "Zoom", 0),
+            recoveryTabId: tabId,
+            wordWrap: GetInt(tabEl, "WordWrap", 0) != 0,
+            customProfileName: GetString(tabEl, "CustomProfileName"));
+    }
+
     // ── Large-file recovery helpers ─────────────────────────────────
 
     /// <summary>
@@ -917,6 +923,45 @@ public sealed class RecoveryManager : IDisposable
         return lo;
     }
 
+    private static bool HasRecoveryContent(Guid tabId) =>
+        File.Exists(CheckpointPath(tabId)) || File.Exists(LegacyContentPath(tabId));
+
+    /// <summary>
+    /// Reads the recovered text of a text-format tab from its journal, or
+    /// from a full-content file written by an older version.
+    /// </summary>
+    internal static string ReadRecoveryText(Guid tabId)
+    {
+        if (File.Exists(CheckpointPath(tabId)))
+        {
+            JournalSnapshot snapshot = EditJournal.Read(CheckpointPath(tabId), JournalPath(tabId))
+                ?? throw new InvalidDataException("The recovery checkpoint is damaged.");
+            return snapshot.BuildText();
+        }
+        return File.ReadAllText(LegacyContentPath(tabId), new UTF8Encoding(false));
+    }
+
+    /// <summary>
+    /// Reads the add buffer and piece list of a pieces-format tab from its
+    /// journal, or from a pieces file written by an older version.
+    /// </summary>
+    internal static (string? AddBuffer, IReadOnlyList<Piece>? Pieces) ReadRecoveryPieces(Guid tabId)
+    {
+        if (File.Exists(CheckpointPath(tabId)))
+        {
+            try
+            {
+                JournalSnapshot? snapshot = EditJournal.Read(CheckpointPath(tabId), JournalPath(tabId));
+                return snapshot is null ? (null, null) : (snapshot.AddBuffer, snapshot.Pieces);
+            }
+            catch
+            {
+                return (null, null);
+            }
+        }
+        return ReadPiecesFile(LegacyContentPath(tabId));
+    }
+
     private static (string? AddBuffer, IReadOnlyList<Piece>? Pieces) ReadPiecesFile(string contentPath)
     {
         try
@@ -1041,5 +1086,9 @@ public sealed class RecoveryManager : IDisposable
         _disposed = true;
         _timer.Stop();
         _timer.Dispose();
+
+        foreach (var journal in _journals.Values)
+            journal.Dispose();
+        _journals.Clear();
     }
 }
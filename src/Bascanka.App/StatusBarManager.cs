@@ -1,4 +1,5 @@
 using Bascanka.Core.Encoding;
+using Bascanka.Core.Navigation;
 using Bascanka.Core.Syntax;
 using Bascanka.Editor.Tabs;
 
@@ -7,7 +8,8 @@ namespace Bascanka.App;
 /// <summary>
 /// Manages the status bar at the bottom of the main window.
 /// Displays cursor position, selection, encoding, line ending, language,
-/// file size, insert/overwrite mode, and read-only indicator.
+/// word and line counts, file size, insert/overwrite mode, and read-only
+/// indicator.
 /// </summary>
 public sealed class StatusBarManager
 {
@@ -16,9 +18,11 @@ public sealed class StatusBarManager
     // Status bar fields.
     private readonly ToolStripStatusLabel _positionLabel;
     private readonly ToolStripStatusLabel _selectionLabel;
+    private readonly ToolStripStatusLabel _jsonPathLabel;
     private readonly ToolStripStatusLabel _encodingLabel;
     private readonly ToolStripStatusLabel _lineEndingLabel;
     private readonly ToolStripStatusLabel _languageLabel;
+    private readonly ToolStripStatusLabel _statisticsLabel;
     private readonly ToolStripStatusLabel _fileSizeLabel;
     private readonly ToolStripStatusLabel _insertModeLabel;
     private readonly ToolStripStatusLabel _readOnlyLabel;
@@ -36,6 +40,7 @@ public sealed class StatusBarManager
     {
         _statusStrip = statusStrip;
         _statusStrip.SizingGrip = true;
+        _statusStrip.ShowItemToolTips = true;
         _statusStrip.LayoutStyle = ToolStripLayoutStyle.HorizontalStackWithOverflow;
 
         // Spring label pushes subsequent items to the right.
@@ -47,9 +52,15 @@ public sealed class StatusBarManager
 
         _positionLabel = CreateLabel(Strings.StatusPosition, 120);
         _selectionLabel = CreateLabel(string.Empty, 80);
+        _jsonPathLabel = new ToolStripStatusLabel
+        {
+            TextAlign = System.Drawing.ContentAlignment.MiddleLeft,
+            Visible = false,
+        };
         _encodingLabel = CreateClickableLabel("UTF-8", 90);
         _lineEndingLabel = CreateClickableLabel("CRLF", 50);
         _languageLabel = CreateClickableLabel(Strings.PlainText, 100);
+        _statisticsLabel = CreateLabel(string.Empty, 160);
         _fileSizeLabel = CreateLabel("0 B", 130);
         _insertModeLabel = CreateLabel("INS", 40);
         _readOnlyLabel = CreateLabel(string.Empty, 30);
@@ -88,6 +99,7 @@ public sealed class StatusBarManager
             (_encodingLabel,   90),
             (_lineEndingLabel, 50),
             (_languageLabel,  100),
+            (_statisticsLabel, 160),
             (_fileSizeLabel,  130),
             (_insertModeLabel, 40),
             (_readOnlyLabel,   30),
@@ -99,8 +111,10 @@ public sealed class StatusBarManager
         {
             _positionLabel,
             _selectionLabel,
+            _jsonPathLabel,
             _macroRecordingLabel,
             _springLabel,
+            _statisticsLabel,
             _fileSizeLabel,
             _encodingLabel,
             _lineEndingLabel,
@@ -133,6 +147,11 @@ public sealed class StatusBarManager
             ? string.Format(Strings.StatusSelectionFormat, sel)
             : string.Empty;
 
+        // JSON path at the caret.
+        string jsonPath = editor.JsonPathAtCaret;
+        _jsonPathLabel.Text = jsonPath;
+        _jsonPathLabel.Visible = jsonPath.Length > 0;
+
         // Encoding.
         EncodingManager? enc = editor.EncodingManager;
         if (enc is not null)
@@ -161,6 +180,23 @@ public sealed class StatusBarManager
                 : Strings.PlainText;
         }
 
+        // Word and line counts, with the details in tool tips.
+        if (!tab.IsLoading && editor.Statistics is { } statistics)
+        {
+            _statisticsLabel.Text = string.Format(Strings.StatusStatisticsFormat, statistics.Words, statistics.Lines);
+            _statisticsLabel.ToolTipText = FormatStatistics(statistics, editor.EncodingManager);
+        }
+        else
+        {
+            _statisticsLabel.Text = tab.IsLoading || editor.StatisticsError is not null
+                ? string.Empty
+                : string.Format(Strings.StatusCountingFormat, editor.StatisticsPercent);
+            _statisticsLabel.ToolTipText = string.Empty;
+        }
+        _selectionLabel.ToolTipText = sel > 0 && !tab.IsLoading && editor.SelectionStatistics is { } selected
+            ? FormatStatistics(selected, editor.EncodingManager)
+            : string.Empty;
+
         // File size (bytes on disk).
         long length = editor.FileSizeBytes;
         _fileSizeLabel.Text = FormatFileSize(length);
@@ -210,9 +246,14 @@ public sealed class StatusBarManager
     {
         _positionLabel.Text = string.Empty;
         _selectionLabel.Text = string.Empty;
+        _jsonPathLabel.Text = string.Empty;
+        _jsonPathLabel.Visible = false;
         _encodingLabel.Text = string.Empty;
         _lineEndingLabel.Text = string.Empty;
         _languageLabel.Text = string.Empty;
+        _statisticsLabel.Text = string.Empty;
+        _statisticsLabel.ToolTipText = string.Empty;
+        _selectionLabel.ToolTipText = string.Empty;
         _fileSizeLabel.Text = string.Empty;
         _zoomLabel.Text = string.Empty;
         _insertModeLabel.Text = string.Empty;
@@ -431,6 +472,15 @@ public sealed class StatusBarManager
         };
     }
 
+    private static string FormatStatistics(TextStatistics statistics, EncodingManager? enc)
+    {
+        string encodingName = enc is not null ? GetEncodingDisplayName(enc) : "UTF-8";
+        return string.Format(Strings.StatisticsTooltipFormat,
+            statistics.Characters, statistics.Words, statistics.Lines, statistics.NonBlankLines,
+            statistics.MaxLineLength, FormatFileSize(statistics.Utf8Bytes), FormatFileSize(statistics.Utf16Bytes),
+            encodingName, FormatFileSize(statistics.EncodedBytes));
+    }
+
     private static string FormatLanguageName(string languageId)
     {
         return languageId.ToLowerInvariant() switch
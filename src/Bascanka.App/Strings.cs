@@ -32,6 +32,13 @@ internal static class Strings
     internal static string MenuReplace => LocalizationManager.Get("MenuReplace");
     internal static string MenuFindInFiles => LocalizationManager.Get("MenuFindInFiles");
     internal static string MenuGoToLine => LocalizationManager.Get("MenuGoToLine");
+    internal static string MenuGoToMatchingBracket => LocalizationManager.Get("MenuGoToMatchingBracket");
+    internal static string MenuGoToJsonPath => LocalizationManager.Get("MenuGoToJsonPath");
+    internal static string MenuGoToTime => LocalizationManager.Get("MenuGoToTime");
+    internal static string MenuSelectTimeRange => LocalizationManager.Get("MenuSelectTimeRange");
+    internal static string MenuExportTimeRange => LocalizationManager.Get("MenuExportTimeRange");
+    internal static string MenuFilterView => LocalizationManager.Get("MenuFilterView");
+    internal static string MenuShowLineInSource => LocalizationManager.Get("MenuShowLineInSource");
 
     // Text Menu
     internal static string MenuText => LocalizationManager.Get("MenuText");
@@ -49,7 +56,11 @@ internal static class Strings
     internal static string MenuHtmlDecode => LocalizationManager.Get("MenuHtmlDecode");
     internal static string MenuSortLinesAsc => LocalizationManager.Get("MenuSortLinesAsc");
     internal static string MenuSortLinesDesc => LocalizationManager.Get("MenuSortLinesDesc");
+    internal static string MenuSortLinesIgnoreCase => LocalizationManager.Get("MenuSortLinesIgnoreCase");
+    internal static string MenuSortLinesNumeric => LocalizationManager.Get("MenuSortLinesNumeric");
     internal static string MenuRemoveDuplicateLines => LocalizationManager.Get("MenuRemoveDuplicateLines");
+    internal static string MenuKeepOnlyDuplicateLines => LocalizationManager.Get("MenuKeepOnlyDuplicateLines");
+    internal static string MenuCountDuplicateLines => LocalizationManager.Get("MenuCountDuplicateLines");
     internal static string MenuReverseLines => LocalizationManager.Get("MenuReverseLines");
     internal static string MenuTrimTrailingWhitespace => LocalizationManager.Get("MenuTrimTrailingWhitespace");
     internal static string MenuTrimLeadingWhitespace => LocalizationManager.Get("MenuTrimLeadingWhitespace");
@@ -78,6 +89,7 @@ internal static class Strings
     internal static string MenuSymbolList => LocalizationManager.Get("MenuSymbolList");
     internal static string MenuFindResults => LocalizationManager.Get("MenuFindResults");
     internal static string MenuTerminal => LocalizationManager.Get("MenuTerminal");
+    internal static string MenuTableView => LocalizationManager.Get("MenuTableView");
     internal static string MenuFolding => LocalizationManager.Get("MenuFolding");
     internal static string MenuToggleFold => LocalizationManager.Get("MenuToggleFold");
     internal static string MenuFoldAll => LocalizationManager.Get("MenuFoldAll");
@@ -87,6 +99,7 @@ internal static class Strings
     internal static string MenuEncoding => LocalizationManager.Get("MenuEncoding");
     internal static string MenuEncodingChineseGB18030 => LocalizationManager.Get("MenuEncodingChineseGB18030");
     internal static string MenuConvertLineEndings => LocalizationManager.Get("MenuConvertLineEndings");
+    internal static string MenuConvertFileEncoding => LocalizationManager.Get("MenuConvertFileEncoding");
 
     // Tools Menu
     internal static string MenuTools => LocalizationManager.Get("MenuTools");
@@ -94,6 +107,8 @@ internal static class Strings
     internal static string MenuRecordMacro => LocalizationManager.Get("MenuRecordMacro");
     internal static string MenuStopRecording => LocalizationManager.Get("MenuStopRecording");
     internal static string MenuPlayMacro => LocalizationManager.Get("MenuPlayMacro");
+    internal static string MenuPlayMacroToEnd => LocalizationManager.Get("MenuPlayMacroToEnd");
+    internal static string MenuPlayMacroOnMatchingLines => LocalizationManager.Get("MenuPlayMacroOnMatchingLines");
     internal static string MenuMacroManager => LocalizationManager.Get("MenuMacroManager");
     internal static string MenuCompareFiles => LocalizationManager.Get("MenuCompareFiles");
     internal static string CompareWithTab => LocalizationManager.Get("CompareWithTab");
@@ -146,9 +161,14 @@ internal static class Strings
     internal static string StatusPosition => LocalizationManager.Get("StatusPosition");
     internal static string StatusPositionFormat => LocalizationManager.Get("StatusPositionFormat");
     internal static string StatusSelectionFormat => LocalizationManager.Get("StatusSelectionFormat");
+    internal static string StatusStatisticsFormat => LocalizationManager.Get("StatusStatisticsFormat");
+    internal static string StatusCountingFormat => LocalizationManager.Get("StatusCountingFormat");
+    internal static string StatisticsTooltipFormat => LocalizationManager.Get("StatisticsTooltipFormat");
 
     // Dialogs
     internal static string PromptSaveChanges => LocalizationManager.Get("PromptSaveChanges");
+    internal static string PromptMacroLinePattern => LocalizationManager.Get("PromptMacroLinePattern");
+    internal static string PromptFilterViewPattern => LocalizationManager.Get("PromptFilterViewPattern");
     internal static string ButtonOK => LocalizationManager.Get("ButtonOK");
     internal static string ButtonCancel => LocalizationManager.Get("ButtonCancel");
     internal static string ButtonYes => LocalizationManager.Get("ButtonYes");
@@ -180,7 +200,14 @@ internal static class Strings
 
     // Save progress
     internal static string SavingProgressFormat => LocalizationManager.Get("SavingProgressFormat");
+    internal static string ConvertingProgressFormat => LocalizationManager.Get("ConvertingProgressFormat");
     internal static string ReloadingAfterSave => LocalizationManager.Get("ReloadingAfterSave");
+    internal static string TransformProgressFormat => LocalizationManager.Get("TransformProgressFormat");
+    internal static string MacroProgressFormat => LocalizationManager.Get("MacroProgressFormat");
+    internal static string IndexingTimestampsProgressFormat => LocalizationManager.Get("IndexingTimestampsProgressFormat");
+    internal static string SaveAllSkippedRecoveredFormat => LocalizationManager.Get("SaveAllSkippedRecoveredFormat");
+    internal static string NoLogTimestamps => LocalizationManager.Get("NoLogTimestamps");
+    internal static string FilterViewTitle => LocalizationManager.Get("FilterViewTitle");
     internal static string ReloadingProgressFormat => LocalizationManager.Get("ReloadingProgressFormat");
 
     // Zoom
@@ -416,7 +443,6 @@ internal static class Strings
     internal static string BinaryOpenAsText => LocalizationManager.Get("BinaryOpenAsText");
     internal static string BinaryRememberForExt => LocalizationManager.Get("BinaryRememberForExt");
     internal static string BinaryRememberNoExt => LocalizationManager.Get("BinaryRememberNoExt");
-    internal static string BinaryFileTooLargeForHex => LocalizationManager.Get("BinaryFileTooLargeForHex");
 
     // Binary file extension preferences (Settings)
     internal static string SettingsCategoryFiles => LocalizationManager.Get("SettingsCategoryFiles");
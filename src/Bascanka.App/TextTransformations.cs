@@ -1,7 +1,5 @@
 using System.Globalization;
 using System.Text;
-using System.Text.Encodings.Web;
-using System.Text.Json;
 using System.Web;
 
 namespace Bascanka.App;
@@ -35,22 +33,6 @@ internal static class TextTransformations
 
     // ── Encoding ────────────────────────────────────────────────────
 
-    public static string Base64Encode(string text)
-        => Convert.ToBase64String(Encoding.UTF8.GetBytes(text));
-
-    public static string Base64Decode(string text)
-    {
-        try
-        {
-            byte[] bytes = Convert.FromBase64String(text.Trim());
-            return Encoding.UTF8.GetString(bytes);
-        }
-        catch (FormatException)
-        {
-            return text; // Return original if invalid Base64.
-        }
-    }
-
     public static string UrlEncode(string text) => Uri.EscapeDataString(text);
 
     public static string UrlDecode(string text) => Uri.UnescapeDataString(text);
@@ -61,34 +43,6 @@ internal static class TextTransformations
 
     // ── Line operations ─────────────────────────────────────────────
 
-    public static string SortLinesAscending(string text)
-    {
-        var lines = SplitLines(text, out string eol);
-        Array.Sort(lines, StringComparer.Ordinal);
-        return string.Join(eol, lines);
-    }
-
-    public static string SortLinesDescending(string text)
-    {
-        var lines = SplitLines(text, out string eol);
-        Array.Sort(lines, StringComparer.Ordinal);
-        Array.Reverse(lines);
-        return string.Join(eol, lines);
-    }
-
-    public static string RemoveDuplicateLines(string text)
-    {
-        var lines = SplitLines(text, out string eol);
-        var seen = new HashSet<string>();
-        var unique = new List<string>(lines.Length);
-        foreach (string line in lines)
-        {
-            if (seen.Add(line))
-                unique.Add(line);
-        }
-        return string.Join(eol, unique);
-    }
-
     public static string ReverseLines(string text)
     {
         var lines = SplitLines(text, out string eol);
@@ -156,56 +110,6 @@ internal static class TextTransformations
     public static string SpacesToTabs(string text)
         => text.Replace("    ", "\t");
 
-    // ── JSON ────────────────────────────────────────────────────
-
-    public static string JsonFormat(string text)
-    {
-        try
-        {
-            using var doc = JsonDocument.Parse(text.Trim(),
-                new JsonDocumentOptions { AllowTrailingCommas = true, CommentHandling = JsonCommentHandling.Skip });
-            using var ms = new System.IO.MemoryStream();
-            using (var writer = new Utf8JsonWriter(ms, new JsonWriterOptions
-            {
-                Indented = true,
-                IndentCharacter = '\t',
-                IndentSize = 1,
-                Encoder = JavaScriptEncoder.UnsafeRelaxedJsonEscaping,
-            }))
-            {
-                doc.WriteTo(writer);
-            }
-            return System.Text.Encoding.UTF8.GetString(ms.ToArray());
-        }
-        catch (JsonException)
-        {
-            return text; // Return original if invalid JSON.
-        }
-    }
-
-    public static string JsonMinimize(string text)
-    {
-        try
-        {
-            using var doc = JsonDocument.Parse(text.Trim(),
-                new JsonDocumentOptions { AllowTrailingCommas = true, CommentHandling = JsonCommentHandling.Skip });
-            using var ms = new System.IO.MemoryStream();
-            using (var writer = new Utf8JsonWriter(ms, new JsonWriterOptions
-            {
-                Indented = false,
-                Encoder = JavaScriptEncoder.UnsafeRelaxedJsonEscaping,
-            }))
-            {
-                doc.WriteTo(writer);
-            }
-            return System.Text.Encoding.UTF8.GetString(ms.ToArray());
-        }
-        catch (JsonException)
-        {
-            return text; // Return original if invalid JSON.
-        }
-    }
-
     // ── Helpers ──────────────────────────────────────────────────────
 
     private static string[] SplitLines(string text, out string eol)
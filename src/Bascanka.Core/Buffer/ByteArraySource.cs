@@ -0,0 +1,28 @@
+namespace Bascanka.Core.Buffer;
+
+/// <summary>
+/// An <see cref="IByteSource"/> backed by an in-memory byte array.  The
+/// array is not copied; callers must not modify it afterwards.
+/// </summary>
+public sealed class ByteArraySource : IByteSource
+{
+    private readonly byte[] _bytes;
+
+    public ByteArraySource(byte[] bytes)
+    {
+        ArgumentNullException.ThrowIfNull(bytes);
+        _bytes = bytes;
+    }
+
+    /// <inheritdoc />
+    public long Length => _bytes.Length;
+
+    /// <inheritdoc />
+    public void CopyTo(long offset, Span<byte> destination)
+    {
+        if (offset < 0 || offset + destination.Length > _bytes.Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+
+        _bytes.AsSpan((int)offset, destination.Length).CopyTo(destination);
+    }
+}
@@ -0,0 +1,408 @@
+using System.Buffers;
+using Bascanka.Core.IO;
+
+namespace Bascanka.Core.Buffer;
+
+/// <summary>
+/// A byte-level piece table: the binary counterpart of <see cref="PieceTable"/>
+/// used by the hex editor.  The original bytes (typically a memory-mapped
+/// file) are never modified or copied; inserted bytes go into an append-only
+/// add buffer and the logical content is described by a
+/// <see cref="RedBlackTree"/> of pieces.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Insert, delete and overwrite are O(log n) in the number of pieces,
+/// independent of the file size, so a 50 GB file edits as cheaply as a
+/// 50 KB one.  Reads are paged: callers copy just the range they display
+/// with <see cref="Read"/>.  <see cref="WriteTo"/> streams unmodified ranges
+/// straight from the original source, so saving touches each byte once and
+/// never materialises the document.
+/// </para>
+/// <para>
+/// Line-feed bookkeeping in <see cref="Piece"/> is not used; byte pieces
+/// always carry a line-feed count of zero (splits may leave it at -1).
+/// </para>
+/// <para>This class is <b>not</b> thread-safe; callers must synchronize
+/// externally if they access it from multiple threads.  Reads never modify
+/// the table, so concurrent readers (such as a parallel search) are safe as
+/// long as no edit runs at the same time.</para>
+/// </remarks>
+public sealed class BytePieceTable : IDisposable
+{
+    /// <summary>Size of each block of the add buffer.</summary>
+    private const int AddBlockSize = 64 * 1024;
+
+    /// <summary>Buffer size used when streaming original bytes to a stream.</summary>
+    private const int CopyBufferSize = 1024 * 1024;
+
+    private readonly IByteSource _original;
+    private readonly bool _ownsOriginal;
+    private readonly RedBlackTree _tree;
+
+    // The add buffer is a list of fixed-size blocks so that appending never
+    // copies earlier bytes and it can grow past 2 GB.
+    private readonly List<byte[]> _addBlocks = [];
+    private long _addLength;
+    private bool _disposed;
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Construction
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Creates a table over <paramref name="original"/>, which is treated as
+    /// immutable.  When <paramref name="ownsOriginal"/> is set and the source
+    /// is <see cref="IDisposable"/>, it is disposed with the table.
+    /// </summary>
+    public BytePieceTable(IByteSource original, bool ownsOriginal = false)
+    {
+        _original = original ?? throw new ArgumentNullException(nameof(original));
+        _ownsOriginal = ownsOriginal;
+        _tree = new RedBlackTree();
+
+        if (_original.Length > 0)
+            _tree.InsertAtOffset(0, new Piece(BufferType.Original, 0, _original.Length, 0));
+    }
+
+    /// <summary>
+    /// Convenience constructor that wraps a byte array.  The array is not
+    /// copied and must not be modified afterwards.
+    /// </summary>
+    public BytePieceTable(byte[] bytes)
+        : this(new ByteArraySource(bytes ?? []))
+    {
+    }
+
+    /// <summary>
+    /// Opens <paramref name="path"/> through a <see cref="MemoryMappedByteSource"/>
+    /// owned by the returned table.  No file content is read until it is
+    /// accessed.
+    /// </summary>
+    public static BytePieceTable FromFile(string path) =>
+        new(new MemoryMappedByteSource(path), ownsOriginal: true);
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Properties
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>Total number of bytes in the document.</summary>
+    public long Length => _tree.TotalLength;
+
+    /// <summary>Number of pieces describing the document.</summary>
+    public int PieceCount => _tree.Count;
+
+    /// <summary>The immutable source the table was created over.</summary>
+    public IByteSource Original => _original;
+
+    /// <summary>Returns the byte at <paramref name="offset"/>.</summary>
+    public byte this[long offset]
+    {
+        get
+        {
+            if (offset < 0 || offset >= Length)
+                throw new ArgumentOutOfRangeException(nameof(offset));
+
+            var (node, offsetInNode) = _tree.FindByOffset(offset);
+            Span<byte> one = stackalloc byte[1];
+            CopyFromPiece(node.Piece, offsetInNode, one);
+            return one[0];
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Reading
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Copies up to <c>destination.Length</c> bytes starting at
+    /// <paramref name="offset"/> into <paramref name="destination"/>.
+    /// </summary>
+    /// <returns>
+    /// The number of bytes copied, which is less than requested only when
+    /// the range runs past the end of the document.
+    /// </returns>
+    public int Read(long offset, Span<byte> destination)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        ArgumentOutOfRangeException.ThrowIfNegative(offset);
+
+        long length = Length;
+        if (offset >= length || destination.IsEmpty) return 0;
+
+        int count = (int)Math.Min(destination.Length, length - offset);
+        var (node, offsetInNode) = _tree.FindByOffset(offset);
+        int copied = 0;
+        while (copied < count && node != _tree.Nil)
+        {
+            int take = (int)Math.Min(node.Piece.Length - offsetInNode, count - copied);
+            CopyFromPiece(node.Piece, offsetInNode, destination.Slice(copied, take));
+            copied += take;
+            node = _tree.Successor(node);
+            offsetInNode = 0;
+        }
+        return copied;
+    }
+
+    /// <summary>
+    /// Like <see cref="Read(long, Span{byte})"/>, and also sets
+    /// <c>inserted[i]</c> for each byte that comes from the add buffer, i.e.
+    /// was typed, pasted or filled rather than loaded from the original.
+    /// </summary>
+    public int Read(long offset, Span<byte> destination, Span<bool> inserted)
+    {
+        if (inserted.Length < destination.Length)
+            throw new ArgumentException("Span is shorter than the destination.", nameof(inserted));
+
+        int copied = Read(offset, destination);
+        if (copied == 0) return 0;
+
+        var (node, offsetInNode) = _tree.FindByOffset(offset);
+        int marked = 0;
+        while (marked < copied && node != _tree.Nil)
+        {
+            int take = (int)Math.Min(node.Piece.Length - offsetInNode, copied - marked);
+            inserted.Slice(marked, take).Fill(node.Piece.BufferType == BufferType.Add);
+            marked += take;
+            node = _tree.Successor(node);
+            offsetInNode = 0;
+        }
+        return copied;
+    }
+
+    /// <summary>
+    /// Returns the piece descriptors covering <c>[offset, offset + length)</c>,
+    /// trimmed to the range.  Pieces only reference the immutable original
+    /// and the append-only add buffer, so the list stays valid across later
+    /// edits and can be put back with <see cref="InsertPieces"/> — this is
+    /// how edit history restores removed bytes without copying them.
+    /// </summary>
+    public List<Piece> GetPieces(long offset, long length)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        if (offset < 0 || length < 0 || offset + length > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+
+        var pieces = new List<Piece>();
+        if (length == 0) return pieces;
+
+        var (node, offsetInNode) = _tree.FindByOffset(offset);
+        while (length > 0 && node != _tree.Nil)
+        {
+            Piece p = node.Piece;
+            long take = Math.Min(p.Length - offsetInNode, length);
+            pieces.Add(new Piece(p.BufferType, p.Start + offsetInNode, take, 0));
+            length -= take;
+            node = _tree.Successor(node);
+            offsetInNode = 0;
+        }
+        return pieces;
+    }
+
+    /// <summary>
+    /// Copies the whole document into a new array.  Only suitable for
+    /// documents that fit in a single managed array.
+    /// </summary>
+    public byte[] ToArray()
+    {
+        long length = Length;
+        if (length > Array.MaxLength)
+            throw new InvalidOperationException("Document is too large to copy into a single array.");
+
+        byte[] result = new byte[length];
+        Read(0, result);
+        return result;
+    }
+
+    /// <summary>
+    /// Writes the document to <paramref name="destination"/>.  Unmodified
+    /// ranges are streamed from the original source in large blocks; only
+    /// inserted bytes come from the add buffer.
+    /// </summary>
+    public void WriteTo(Stream destination)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        ArgumentNullException.ThrowIfNull(destination);
+
+        byte[] buffer = ArrayPool<byte>.Shared.Rent(CopyBufferSize);
+        try
+        {
+            foreach (Piece piece in _tree)
+            {
+                if (piece.BufferType == BufferType.Add)
+                {
+                    WriteAddRange(destination, piece.Start, piece.Length);
+                    continue;
+                }
+
+                long done = 0;
+                while (done < piece.Length)
+                {
+                    int take = (int)Math.Min(buffer.Length, piece.Length - done);
+                    _original.CopyTo(piece.Start + done, buffer.AsSpan(0, take));
+                    destination.Write(buffer, 0, take);
+                    done += take;
+                }
+            }
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(buffer);
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Edit operations
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Inserts <paramref name="bytes"/> at <paramref name="offset"/>, shifting
+    /// subsequent bytes right.
+    /// </summary>
+    public void Insert(long offset, ReadOnlySpan<byte> bytes)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        if (offset < 0 || offset > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+        if (bytes.IsEmpty) return;
+
+        long addStart = AppendToAddBuffer(bytes);
+
+        // Typing appends to the piece created by the previous keystroke:
+        // grow it in place instead of adding a node per byte.
+        if (offset > 0)
+        {
+            var (prev, offsetInPrev) = _tree.FindByOffset(offset - 1);
+            Piece p = prev.Piece;
+            if (p.BufferType == BufferType.Add &&
+                offsetInPrev == p.Length - 1 &&
+                p.Start + p.Length == addStart)
+            {
+                prev.Piece = new Piece(BufferType.Add, p.Start, p.Length + bytes.Length, 0);
+                _tree.UpdateAugmentationUp(prev);
+                return;
+            }
+        }
+
+        _tree.InsertAtOffset(offset, new Piece(BufferType.Add, addStart, bytes.Length, 0));
+    }
+
+    /// <summary>
+    /// Inserts previously obtained piece descriptors (see
+    /// <see cref="GetPieces"/>) at <paramref name="offset"/>, in order.
+    /// Costs O(k log n) for k pieces, independent of the bytes they cover.
+    /// </summary>
+    public void InsertPieces(long offset, IReadOnlyList<Piece> pieces)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        ArgumentNullException.ThrowIfNull(pieces);
+        if (offset < 0 || offset > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+
+        foreach (Piece p in pieces)
+        {
+            long limit = p.BufferType == BufferType.Add ? _addLength : _original.Length;
+            if (p.Start < 0 || p.Length <= 0 || p.Start + p.Length > limit)
+                throw new ArgumentException("Piece does not belong to this table.", nameof(pieces));
+        }
+
+        foreach (Piece p in pieces)
+        {
+            _tree.InsertAtOffset(offset, new Piece(p.BufferType, p.Start, p.Length, 0));
+            offset += p.Length;
+        }
+    }
+
+    /// <summary>
+    /// Deletes <paramref name="length"/> bytes starting at
+    /// <paramref name="offset"/>, shifting subsequent bytes left.
+    /// </summary>
+    public void Delete(long offset, long length)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        if (length <= 0) return;
+        if (offset < 0 || offset + length > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+
+        _tree.DeleteRange(offset, length);
+    }
+
+    /// <summary>
+    /// Replaces the bytes at <paramref name="offset"/> with
+    /// <paramref name="bytes"/>, extending the document if the range runs
+    /// past its end.
+    /// </summary>
+    public void Overwrite(long offset, ReadOnlySpan<byte> bytes)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        if (offset < 0 || offset > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+        if (bytes.IsEmpty) return;
+
+        Delete(offset, Math.Min(bytes.Length, Length - offset));
+        Insert(offset, bytes);
+    }
+
+    public void Dispose()
+    {
+        if (_disposed) return;
+        _disposed = true;
+
+        if (_ownsOriginal && _original is IDisposable disposable)
+            disposable.Dispose();
+        _addBlocks.Clear();
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Add buffer
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>Appends to the add buffer and returns the start offset.</summary>
+    private long AppendToAddBuffer(ReadOnlySpan<byte> bytes)
+    {
+        long start = _addLength;
+        while (!bytes.IsEmpty)
+        {
+            int inBlock = (int)(_addLength % AddBlockSize);
+            if (inBlock == 0 && _addLength / AddBlockSize == _addBlocks.Count)
+                _addBlocks.Add(new byte[AddBlockSize]);
+
+            int take = Math.Min(bytes.Length, AddBlockSize - inBlock);
+            bytes[..take].CopyTo(_addBlocks[(int)(_addLength / AddBlockSize)].AsSpan(inBlock, take));
+            bytes = bytes[take..];
+            _addLength += take;
+        }
+        return start;
+    }
+
+    private void CopyFromPiece(Piece piece, long offsetInPiece, Span<byte> destination)
+    {
+        long start = piece.Start + offsetInPiece;
+        if (piece.BufferType == BufferType.Original)
+        {
+            _original.CopyTo(start, destination);
+            return;
+        }
+
+        while (!destination.IsEmpty)
+        {
+            int inBlock = (int)(start % AddBlockSize);
+            int take = Math.Min(destination.Length, AddBlockSize - inBlock);
+            _addBlocks[(int)(start / AddBlockSize)].AsSpan(inBlock, take).CopyTo(destination);
+            destination = destination[take..];
+            start += take;
+        }
+    }
+
+    private void WriteAddRange(Stream destination, long start, long length)
+    {
+        while (length > 0)
+        {
+            int inBlock = (int)(start % AddBlockSize);
+            int take = (int)Math.Min(length, AddBlockSize - inBlock);
+            destination.Write(_addBlocks[(int)(start / AddBlockSize)], inBlock, take);
+            start += take;
+            length -= take;
+        }
+    }
+}
@@ -0,0 +1,20 @@
+namespace Bascanka.Core.Buffer;
+
+/// <summary>
+/// Abstraction over a read-only byte store.  The binary counterpart of
+/// <see cref="ITextSource"/>: implementations may be backed by an in-memory
+/// array or a memory-mapped file, and are only ever read in ranges.
+/// </summary>
+public interface IByteSource
+{
+    /// <summary>Total number of bytes in the source.</summary>
+    long Length { get; }
+
+    /// <summary>
+    /// Copies <c>destination.Length</c> bytes starting at
+    /// <paramref name="offset"/> into <paramref name="destination"/>.
+    /// </summary>
+    /// <param name="offset">Zero-based start offset (inclusive).</param>
+    /// <param name="destination">Buffer receiving the bytes.</param>
+    void CopyTo(long offset, Span<byte> destination);
+}
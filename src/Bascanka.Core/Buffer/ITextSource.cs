@@ -24,6 +24,21 @@ public interface IPrecomputedLineFeeds
     long[]? LineOffsets { get; }
 }
 
+/// <summary>
+/// Implemented by <see cref="ITextSource"/> instances that find the start
+/// of a line themselves, such as a view of lines indexed elsewhere.  While
+/// a <see cref="PieceTable"/> still reads as the start of its original
+/// source, it asks the source instead of building a table of every line.
+/// </summary>
+public interface ILineLookup
+{
+    /// <summary>Returns the character offset where zero-based line <paramref name="lineIndex"/> starts.</summary>
+    long GetLineStart(long lineIndex);
+
+    /// <summary>Returns the zero-based line that holds the character at <paramref name="offset"/>.</summary>
+    long GetLineAt(long offset);
+}
+
 /// <summary>
 /// Abstraction over a read-only text store.  Implementations may be backed by
 /// a plain <see cref="string"/>, a memory-mapped file, or any other source
@@ -44,6 +59,17 @@ public interface ITextSource
     /// <param name="length">Number of characters to copy.</param>
     string GetText(long start, long length);
 
+    /// <summary>
+    /// Copies <c>destination.Length</c> characters starting at
+    /// <paramref name="start"/> into <paramref name="destination"/> without
+    /// allocating an intermediate string.  The default implementation falls
+    /// back to <see cref="GetText"/>.
+    /// </summary>
+    /// <param name="start">Zero-based start index (inclusive).</param>
+    /// <param name="destination">Buffer receiving the characters.</param>
+    void CopyTo(long start, Span<char> destination)
+        => GetText(start, destination.Length).AsSpan().CopyTo(destination);
+
     /// <summary>
     /// Counts the number of <c>'\n'</c> characters in the given range.
     /// </summary>
@@ -0,0 +1,212 @@
+using System.Buffers;
+using System.Numerics;
+
+namespace Bascanka.Core.Buffer;
+
+/// <summary>
+/// Keeps the text of recently displayed lines between paints so that a
+/// steady-state frame — or a scroll that exposes only a few new lines —
+/// retrieves lines without allocating.  Only lines missing from the cache
+/// are read, with <see cref="PieceTable.CopyTo"/> into a pooled buffer and
+/// one string per new line.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Slots are direct-mapped by line number, so lookups and eviction are O(1)
+/// and a window that slides by a few lines only replaces the slots it
+/// leaves behind.  Any edit clears the cache, because line start offsets
+/// after the edit point shift.
+/// </para>
+/// <para>This class is <b>not</b> thread-safe; callers must synchronize
+/// externally if they access it from multiple threads.</para>
+/// </remarks>
+public sealed class LineSnapshotCache
+{
+    /// <summary>
+    /// Total characters retained across all slots.  Lines that would exceed
+    /// the budget are returned but not kept.
+    /// </summary>
+    public const int MaxRetainedChars = 4 * 1024 * 1024;
+
+    /// <summary>
+    /// Largest run of text read into one pooled buffer.  Runs of missing
+    /// lines longer than this are read a line at a time.
+    /// </summary>
+    private const int MaxBatchChars = 256 * 1024;
+
+    private struct Slot
+    {
+        public long Line;
+        public long StartOffset;
+        public string? Text;
+    }
+
+    private PieceTable? _document;
+    private Slot[] _slots = [];
+    private long _retainedChars;
+
+    /// <summary>
+    /// The document lines are read from.  Setting it clears the cache and
+    /// subscribes to <see cref="PieceTable.TextChanged"/>.
+    /// </summary>
+    public PieceTable? Document
+    {
+        get => _document;
+        set
+        {
+            if (ReferenceEquals(_document, value)) return;
+            if (_document is not null)
+                _document.TextChanged -= OnDocumentTextChanged;
+            _document = value;
+            if (_document is not null)
+                _document.TextChanged += OnDocumentTextChanged;
+            Invalidate();
+        }
+    }
+
+    /// <summary>Lines served from the cache.</summary>
+    public long Hits { get; private set; }
+
+    /// <summary>Lines read from the document.</summary>
+    public long Misses { get; private set; }
+
+    /// <summary>Drops every cached line.</summary>
+    public void Invalidate()
+    {
+        Array.Clear(_slots);
+        _retainedChars = 0;
+    }
+
+    /// <summary>
+    /// Fills <paramref name="destination"/> with up to <c>destination.Length</c>
+    /// consecutive lines starting at <paramref name="startLine"/>, with the
+    /// same contents as <see cref="PieceTable.GetLineRange"/>.
+    /// </summary>
+    /// <returns>The number of lines written.</returns>
+    public int GetLines(long startLine, Span<(string Text, long StartOffset)> destination)
+    {
+        PieceTable? doc = _document;
+        if (doc is null || destination.IsEmpty || startLine < 0 || startLine >= doc.LineCount)
+            return 0;
+
+        int count = (int)Math.Min(destination.Length, doc.LineCount - startLine);
+        EnsureCapacity(count);
+        int mask = _slots.Length - 1;
+
+        int i = 0;
+        while (i < count)
+        {
+            ref Slot slot = ref _slots[(int)((startLine + i) & mask)];
+            if (slot.Line == startLine + i && slot.Text is not null)
+            {
+                destination[i] = (slot.Text, slot.StartOffset);
+                Hits++;
+                i++;
+                continue;
+            }
+
+            // Read the whole run of missing lines in one pass.
+            int runEnd = i + 1;
+            while (runEnd < count)
+            {
+                ref Slot next = ref _slots[(int)((startLine + runEnd) & mask)];
+                if (next.Line == startLine + runEnd && next.Text is not null) break;
+                runEnd++;
+            }
+
+            ReadLines(doc, startLine + i, runEnd - i, destination[i..runEnd]);
+            Misses += runEnd - i;
+            i = runEnd;
+        }
+
+        return count;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Internals
+    // ────────────────────────────────────────────────────────────────────
+
+    private void ReadLines(PieceTable doc, long firstLine, int count, Span<(string Text, long StartOffset)> destination)
+    {
+        long firstOffset = doc.GetLineStartOffset(firstLine);
+        long endLine = firstLine + count;
+        long lastOffset = endLine < doc.LineCount ? doc.GetLineStartOffset(endLine) : doc.Length;
+        if (lastOffset - firstOffset > MaxBatchChars)
+        {
+            for (int i = 0; i < count; i++)
+                destination[i] = ReadLine(doc, firstLine + i);
+            return;
+        }
+        int totalLen = (int)(lastOffset - firstOffset);
+
+        char[] buffer = ArrayPool<char>.Shared.Rent(Math.Max(1, totalLen));
+        try
+        {
+            Span<char> chunk = buffer.AsSpan(0, totalLen);
+            doc.CopyTo(firstOffset, chunk);
+
+            long offset = firstOffset;
+            int pos = 0;
+            for (int i = 0; i < count; i++)
+            {
+                int lf = pos < chunk.Length ? chunk[pos..].IndexOf('\n') : -1;
+                int len = lf >= 0 ? lf : chunk.Length - pos;
+                string text = len == 0 ? string.Empty : new string(chunk.Slice(pos, len));
+
+                destination[i] = (text, offset);
+                Store(firstLine + i, offset, text);
+
+                offset += len + 1;
+                pos += len + 1;
+            }
+        }
+        finally
+        {
+            ArrayPool<char>.Shared.Return(buffer);
+        }
+    }
+
+    /// <summary>
+    /// Reads a single line straight into its string, for lines too long to
+    /// batch.
+    /// </summary>
+    private (string Text, long StartOffset) ReadLine(PieceTable doc, long line)
+    {
+        long offset = doc.GetLineStartOffset(line);
+        int len = checked((int)doc.GetLineLength(line));
+        string text = len == 0
+            ? string.Empty
+            : string.Create(len, (Doc: doc, Offset: offset), static (span, s) => s.Doc.CopyTo(s.Offset, span));
+
+        Store(line, offset, text);
+        return (text, offset);
+    }
+
+    private void Store(long line, long startOffset, string text)
+    {
+        ref Slot slot = ref _slots[(int)(line & (_slots.Length - 1))];
+        if (slot.Text is not null)
+            _retainedChars -= slot.Text.Length;
+
+        if (_retainedChars + text.Length > MaxRetainedChars)
+        {
+            slot = default;
+            return;
+        }
+
+        slot = new Slot { Line = line, StartOffset = startOffset, Text = text };
+        _retainedChars += text.Length;
+    }
+
+    private void EnsureCapacity(int visibleCount)
+    {
+        // Twice the window keeps the lines scrolled past in either direction.
+        int needed = (int)Math.Min(1 << 20, BitOperations.RoundUpToPowerOf2((uint)Math.Max(16, visibleCount * 2)));
+        if (_slots.Length >= needed) return;
+
+        _slots = new Slot[needed];
+        _retainedChars = 0;
+    }
+
+    private void OnDocumentTextChanged(object? sender, TextChangedEventArgs e) => Invalidate();
+}
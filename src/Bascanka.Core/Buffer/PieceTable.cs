@@ -40,9 +40,16 @@ public sealed class TextChangedEventArgs(long offset, long oldLength, long newLe
 /// </summary>
 public sealed class PieceTable : IDisposable
 {
+    /// <summary>
+    /// Batches of at least this many pieces that are also large relative to
+    /// the document are applied by rebuilding the tree.
+    /// </summary>
+    private const int BulkRebuildMinPieces = 1024;
+
     private readonly ITextSource _original;
     private readonly StringBuilder _addBuffer;
     private readonly RedBlackTree _tree;
+    private readonly bool _ownsOriginal = true;
     private bool _disposed;
 
     // ── Line-offset cache ────────────────────────────────────────────
@@ -62,6 +69,12 @@ public sealed class PieceTable : IDisposable
     private long _pendingDeltaLine = -1; // -1 = no pending delta
     private long _pendingDeltaAmount;
 
+    // Whether the document still reads as the start of the original
+    // source; until the first edit, a source that can look up lines itself
+    // is asked instead of the cache.
+    private bool _readsAsOriginal;
+    private ILineLookup? _lineLookup;
+
     /// <summary>
     /// Raised after every <see cref="Insert"/> or <see cref="Delete"/>
     /// operation.
@@ -82,6 +95,8 @@ public sealed class PieceTable : IDisposable
         _original = original ?? throw new ArgumentNullException(nameof(original));
         _addBuffer = new StringBuilder();
         _tree = new RedBlackTree();
+        _readsAsOriginal = true;
+        _lineLookup = original as ILineLookup;
 
         if (_original.Length > 0)
         {
@@ -157,6 +172,7 @@ public sealed class PieceTable : IDisposable
         var piece = new Piece(BufferType.Add, addStart, text.Length, lf);
 
         _tree.InsertAtOffset(offset, piece);
+        StopReadingAsOriginal();
 
         // After tree mutations the split pieces may have LineFeeds == -1.
         FixupLineFeeds();
@@ -181,6 +197,7 @@ public sealed class PieceTable : IDisposable
         // so we can incrementally update the cache.
         // (UpdateLineOffsetCache will use the cache itself to count removed lines.)
         _tree.DeleteRange(offset, length);
+        StopReadingAsOriginal();
 
         FixupLineFeeds();
 
@@ -190,6 +207,198 @@ public sealed class PieceTable : IDisposable
         TextChanged?.Invoke(this, new TextChangedEventArgs(offset, length, 0));
     }
 
+    /// <summary>
+    /// Appends the text the original source gained at its end since this
+    /// table last read it, for a source that grows, such as a view that
+    /// fills in while its lines are found.  The table must not have been
+    /// edited.  <see cref="TextChanged"/> is raised for the appended range.
+    /// </summary>
+    /// <exception cref="InvalidOperationException">The table has been edited.</exception>
+    public void AppendFromOriginal()
+    {
+        if (!_readsAsOriginal)
+            throw new InvalidOperationException("Only an unedited table can grow with its source.");
+
+        long offset = Length;
+        long added = _original.Length - offset;
+        if (added <= 0) return;
+
+        var piece = new Piece(BufferType.Original, offset, added, _original.CountLineFeeds(offset, added));
+        _tree.InsertAtOffset(offset, piece);
+
+        // The cache is rebuilt on next use when the source cannot look up
+        // lines itself.
+        _lineOffsetCache = null;
+        _lineOffsetCacheValidCount = 0;
+        _pendingDeltaLine = -1;
+        _pendingDeltaAmount = 0;
+
+        TextChanged?.Invoke(this, new TextChangedEventArgs(offset, 0, added));
+    }
+
+    private void StopReadingAsOriginal()
+    {
+        _readsAsOriginal = false;
+        _lineLookup = null;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Bulk edits
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Returns descriptors for the pieces covering <paramref name="length"/>
+    /// characters at <paramref name="offset"/>, trimmed to the range.  The
+    /// descriptors stay valid across later edits (both buffers are
+    /// append-only) and can be put back with <see cref="ReplacePieces"/>,
+    /// which is how bulk edits are undone without copying text.
+    /// </summary>
+    public List<Piece> GetPieces(long offset, long length)
+    {
+        if (offset < 0 || length < 0 || offset + length > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+
+        var pieces = new List<Piece>();
+        if (length == 0) return pieces;
+
+        var (node, offInNode) = _tree.FindByOffset(offset);
+        while (length > 0 && node != _tree.Nil)
+        {
+            Piece p = node.Piece;
+            long take = Math.Min(p.Length - offInNode, length);
+
+            // A trimmed piece's line-feed count is unknown until fixed up.
+            int lf = take == p.Length ? p.LineFeeds : -1;
+            pieces.Add(new Piece(p.BufferType, p.Start + offInNode, take, lf));
+
+            length -= take;
+            node = _tree.Successor(node);
+            offInNode = 0;
+        }
+        return pieces;
+    }
+
+    /// <summary>
+    /// Builds the pieces for the range spanned by <paramref name="edits"/>
+    /// as it reads with every edit applied.  Text between edits keeps its
+    /// existing pieces and replacement text is appended to the add buffer,
+    /// so the cost is proportional to the number of edits, not the size of
+    /// the range.  The document itself is not changed; pass the result to
+    /// <see cref="ReplacePieces"/> for the range
+    /// <c>[edits[0].Offset, edits[^1].Offset + edits[^1].Length)</c>.
+    /// </summary>
+    /// <param name="edits">
+    /// Edits against the current document, sorted by offset and
+    /// non-overlapping.
+    /// </param>
+    public List<Piece> CreateEditedPieces(IReadOnlyList<TextEdit> edits)
+    {
+        ArgumentNullException.ThrowIfNull(edits);
+
+        long previousEnd = edits.Count > 0 ? edits[0].Offset : 0;
+        foreach (TextEdit edit in edits)
+        {
+            if (edit.Text is null || edit.Length < 0 || edit.Offset < previousEnd ||
+                edit.Offset + edit.Length > Length)
+                throw new ArgumentException("Edits must be sorted, non-overlapping and inside the document.", nameof(edits));
+            previousEnd = edit.Offset + edit.Length;
+        }
+
+        var pieces = new List<Piece>();
+        long position = edits.Count > 0 ? edits[0].Offset : 0;
+        foreach (TextEdit edit in edits)
+        {
+            if (edit.Offset > position)
+                pieces.AddRange(GetPieces(position, edit.Offset - position));
+
+            if (edit.Text.Length > 0)
+            {
+                string text = edit.Text.Contains('\r')
+                    ? edit.Text.Replace("\r\n", "\n").Replace("\r", "\n")
+                    : edit.Text;
+                long addStart = _addBuffer.Length;
+                _addBuffer.Append(text);
+                pieces.Add(new Piece(BufferType.Add, addStart, text.Length, CountLineFeedsInString(text)));
+            }
+
+            position = edit.Offset + edit.Length;
+        }
+        return pieces;
+    }
+
+    /// <summary>
+    /// Replaces <paramref name="length"/> characters at
+    /// <paramref name="offset"/> with the text described by
+    /// <paramref name="pieces"/> (from <see cref="GetPieces"/> or
+    /// <see cref="CreateEditedPieces"/>) as a single change: the tree is
+    /// fixed up once, the line-offset cache is rebuilt lazily and
+    /// <see cref="TextChanged"/> is raised once for the whole range.
+    /// </summary>
+    public void ReplacePieces(long offset, long length, IReadOnlyList<Piece> pieces)
+    {
+        ArgumentNullException.ThrowIfNull(pieces);
+        if (offset < 0 || length < 0 || offset + length > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+
+        foreach (Piece p in pieces)
+        {
+            long limit = p.BufferType == BufferType.Add ? _addBuffer.Length : _original.Length;
+            if (p.Start < 0 || p.Length <= 0 || p.Start + p.Length > limit)
+                throw new ArgumentException("Piece does not belong to this table.", nameof(pieces));
+        }
+
+        long newLength = 0;
+        foreach (Piece p in pieces)
+            newLength += p.Length;
+
+        if ((pieces.Count > BulkRebuildMinPieces && pieces.Count > _tree.Count / 4) ||
+            (_tree.Count > BulkRebuildMinPieces && length >= Length / 2))
+        {
+            // A large batch, or a range covering most of the document:
+            // rebuilding the whole tree balanced is O(n), where inserting or
+            // deleting piece by piece would rebalance every time.
+            long totalLength = Length;
+            var all = GetPieces(0, offset);
+            all.AddRange(pieces);
+            all.AddRange(GetPieces(offset + length, totalLength - offset - length));
+            _tree.Rebuild(all);
+        }
+        else
+        {
+            if (length > 0)
+                _tree.DeleteRange(offset, length);
+
+            // Only the first piece needs an offset lookup; the rest are
+            // chained after it.
+            RBNode? previous = null;
+            foreach (Piece p in pieces)
+            {
+                if (previous is null)
+                {
+                    previous = _tree.InsertAtOffset(offset, p);
+                }
+                else
+                {
+                    var node = new RBNode(p, NodeColor.Red);
+                    _tree.InsertAfter(previous, node);
+                    previous = node;
+                }
+            }
+        }
+
+        StopReadingAsOriginal();
+        FixupLineFeeds();
+
+        // A bulk change may touch lines all over the document; one lazy
+        // rebuild is cheaper than patching the cache per piece.
+        _lineOffsetCache = null;
+        _lineOffsetCacheValidCount = 0;
+        _pendingDeltaLine = -1;
+        _pendingDeltaAmount = 0;
+
+        TextChanged?.Invoke(this, new TextChangedEventArgs(offset, length, newLength));
+    }
+
     // ────────────────────────────────────────────────────────────────────
     //  Read operations
     // ────────────────────────────────────────────────────────────────────
@@ -204,25 +413,35 @@ public sealed class PieceTable : IDisposable
         if (offset < 0 || length < 0 || offset + length > Length)
             throw new ArgumentOutOfRangeException(nameof(offset));
 
-        var sb = new StringBuilder((int)Math.Min(length, int.MaxValue));
-        long remaining = length;
-        long pos = offset;
+        return string.Create((int)length, (Table: this, Offset: offset),
+            static (destination, state) => state.Table.CopyTo(state.Offset, destination));
+    }
 
-        while (remaining > 0)
-        {
-            var (node, offInNode) = _tree.FindByOffset(pos);
-            if (node == _tree.Nil) break;
+    /// <summary>
+    /// Copies <c>destination.Length</c> characters starting at
+    /// <paramref name="offset"/> into <paramref name="destination"/>.  Used by
+    /// callers that reuse buffers across calls (e.g. painting) to avoid a
+    /// string per request.
+    /// </summary>
+    public void CopyTo(long offset, Span<char> destination)
+    {
+        if (offset < 0 || offset + destination.Length > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
 
-            long charsAvail = node.Piece.Length - offInNode;
-            long take = Math.Min(charsAvail, remaining);
+        int written = 0;
+        long pos = offset;
 
-            AppendPieceText(sb, node.Piece, offInNode, take);
+        var (node, offInNode) = _tree.FindByOffset(pos);
+        while (written < destination.Length && node != _tree.Nil)
+        {
+            int take = (int)Math.Min(node.Piece.Length - offInNode, destination.Length - written);
+            CopyPieceText(node.Piece, offInNode, destination.Slice(written, take));
 
             pos += take;
-            remaining -= take;
+            written += take;
+            node = _tree.Successor(node);
+            offInNode = 0;
         }
-
-        return sb.ToString();
     }
 
     /// <summary>
@@ -291,6 +510,7 @@ public sealed class PieceTable : IDisposable
             throw new ArgumentOutOfRangeException(nameof(lineIndex));
 
         if (lineIndex == 0) return 0;
+        if (_lineLookup is not null) return _lineLookup.GetLineStart(lineIndex);
 
         EnsureLineOffsetCache();
         return GetCacheOffset(lineIndex);
@@ -408,6 +628,12 @@ public sealed class PieceTable : IDisposable
 
         if (offset == 0) return (0, 0);
 
+        if (_lineLookup is not null)
+        {
+            long lineAt = _lineLookup.GetLineAt(offset);
+            return (lineAt, offset - _lineLookup.GetLineStart(lineAt));
+        }
+
         EnsureLineOffsetCache();
 
         // Binary search: find the largest line whose start offset <= offset.
@@ -466,22 +692,16 @@ public sealed class PieceTable : IDisposable
     }
 
     /// <summary>
-    /// Appends characters from a piece to a <see cref="StringBuilder"/>.
+    /// Copies characters from a piece into <paramref name="destination"/>.
     /// </summary>
-    private void AppendPieceText(StringBuilder sb, Piece piece, long offsetInPiece, long count)
+    private void CopyPieceText(Piece piece, long offsetInPiece, Span<char> destination)
     {
         long start = piece.Start + offsetInPiece;
 
         if (piece.BufferType == BufferType.Original)
-        {
-            // ITextSource.GetText returns a string.
-            sb.Append(_original.GetText(start, count));
-        }
+            _original.CopyTo(start, destination);
         else
-        {
-            // Read from the add buffer.
-            sb.Append(_addBuffer.ToString((int)start, (int)count));
-        }
+            _addBuffer.CopyTo((int)start, destination, destination.Length);
     }
 
     /// <summary>
@@ -935,6 +1155,29 @@ public sealed class PieceTable : IDisposable
     /// </summary>
     public string GetAddBufferContents() => _addBuffer.ToString();
 
+    /// <summary>
+    /// Number of characters in the add buffer.  The buffer only grows, so
+    /// text below this length never changes.
+    /// </summary>
+    public long AddBufferLength => _addBuffer.Length;
+
+    /// <summary>
+    /// Returns part of the add buffer, so that the recovery journal can
+    /// write only what was appended since its last write.
+    /// </summary>
+    public string GetAddBufferText(long start, long length)
+    {
+        if (start < 0 || length < 0 || start + length > _addBuffer.Length)
+            throw new ArgumentOutOfRangeException(nameof(start));
+        return _addBuffer.ToString((int)start, (int)length);
+    }
+
+    /// <summary>
+    /// The immutable source that <see cref="BufferType.Original"/> pieces
+    /// refer to.
+    /// </summary>
+    public ITextSource OriginalSource => _original;
+
     /// <summary>
     /// Returns all pieces in document order (in-order tree traversal).
     /// Used by the recovery system to serialize the piece table state.
@@ -974,6 +1217,33 @@ public sealed class PieceTable : IDisposable
         FixupLineFeeds();
     }
 
+    /// <summary>
+    /// Snapshot constructor: adopts the pieces as they are, line-feed counts
+    /// included, and reads <paramref name="original"/> without owning it.
+    /// </summary>
+    private PieceTable(ITextSource original, string addBufferContents, IReadOnlyList<Piece> pieces, bool ownsOriginal)
+    {
+        _original = original;
+        _addBuffer = new StringBuilder(addBufferContents);
+        _tree = new RedBlackTree();
+        _tree.Rebuild(pieces);
+        _ownsOriginal = ownsOriginal;
+    }
+
+    /// <summary>
+    /// Returns an unchanging copy of the document as it is now, so that it
+    /// can be read on a background thread while this table goes on being
+    /// edited.  The copy shares the original source, which stays owned by
+    /// this table, and copies only the add buffer and the piece list.  It
+    /// cannot be read once this table is disposed.
+    /// </summary>
+    public PieceTable CreateSnapshot()
+        => new(_original, _addBuffer.ToString(), GetPiecesInOrder(), ownsOriginal: false)
+        {
+            _readsAsOriginal = _readsAsOriginal,
+            _lineLookup = _lineLookup,
+        };
+
     /// <summary>
     /// Sets a pre-computed line-offset cache, avoiding the lazy O(N) scan in
     /// <see cref="EnsureLineOffsetCache"/>.  The array must have exactly
@@ -1071,6 +1341,7 @@ public sealed class PieceTable : IDisposable
     {
         if (_disposed) return;
         _disposed = true;
-        (_original as IDisposable)?.Dispose();
+        if (_ownsOriginal)
+            (_original as IDisposable)?.Dispose();
     }
 }
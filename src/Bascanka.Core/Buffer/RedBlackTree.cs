@@ -1,5 +1,6 @@
 using System.Collections;
 using System.Diagnostics;
+using System.Numerics;
 using System.Runtime.CompilerServices;
 
 namespace Bascanka.Core.Buffer;
@@ -307,6 +308,56 @@ public sealed class RedBlackTree : IEnumerable<Piece>
         return inserted;
     }
 
+    /// <summary>
+    /// Replaces the whole tree with <paramref name="pieces"/>, in order, in
+    /// O(n).  Nodes are laid out as a minimum-height tree: every level is
+    /// black except an incomplete bottom level, which is red, so all
+    /// root-to-leaf paths have the same black height.
+    /// </summary>
+    public void Rebuild(IReadOnlyList<Piece> pieces)
+    {
+        ArgumentNullException.ThrowIfNull(pieces);
+
+        Count = pieces.Count;
+        if (pieces.Count == 0)
+        {
+            Root = Nil;
+            return;
+        }
+
+        int bottom = BitOperations.Log2((uint)pieces.Count);
+        bool bottomComplete = pieces.Count == (1 << (bottom + 1)) - 1;
+        int redDepth = bottomComplete ? -1 : bottom;
+
+        Root = BuildBalanced(pieces, 0, pieces.Count - 1, 0, redDepth, Nil, out _, out _);
+        Root.Color = NodeColor.Black;
+    }
+
+    private RBNode BuildBalanced(IReadOnlyList<Piece> pieces, int lo, int hi, int depth, int redDepth,
+        RBNode parent, out long length, out long lineFeeds)
+    {
+        if (lo > hi)
+        {
+            length = 0;
+            lineFeeds = 0;
+            return Nil;
+        }
+
+        int mid = lo + (hi - lo) / 2;
+        var node = new RBNode(pieces[mid], depth == redDepth ? NodeColor.Red : NodeColor.Black)
+        {
+            Parent = parent,
+        };
+        node.Left = BuildBalanced(pieces, lo, mid - 1, depth + 1, redDepth, node, out long leftLength, out long leftLineFeeds);
+        node.Right = BuildBalanced(pieces, mid + 1, hi, depth + 1, redDepth, node, out long rightLength, out long rightLineFeeds);
+        node.LeftSubtreeLength = leftLength;
+        node.LeftSubtreeLineFeeds = leftLineFeeds;
+
+        length = leftLength + node.Piece.Length + rightLength;
+        lineFeeds = leftLineFeeds + node.Piece.LineFeeds + rightLineFeeds;
+        return node;
+    }
+
     // ════════════════════════════════════════════════════════════════════
     //  Deletion
     // ════════════════════════════════════════════════════════════════════
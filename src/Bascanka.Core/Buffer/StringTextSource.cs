@@ -40,6 +40,13 @@ public sealed class StringTextSource : ITextSource
         return _data.Substring((int)start, (int)length);
     }
 
+    /// <inheritdoc />
+    public void CopyTo(long start, Span<char> destination)
+    {
+        ValidateRange(start, destination.Length);
+        _data.AsSpan((int)start, destination.Length).CopyTo(destination);
+    }
+
     /// <inheritdoc />
     public int CountLineFeeds(long start, long length)
     {
@@ -0,0 +1,12 @@
+namespace Bascanka.Core.Buffer;
+
+/// <summary>
+/// A replacement of <paramref name="Length"/> characters at
+/// <paramref name="Offset"/> with <paramref name="Text"/>.  Lists of edits
+/// passed to <see cref="PieceTable.CreateEditedPieces"/> refer to offsets in
+/// the unedited document and must be sorted and non-overlapping.
+/// </summary>
+/// <param name="Offset">Start of the replaced range.</param>
+/// <param name="Length">Number of characters removed; zero for a pure insert.</param>
+/// <param name="Text">Replacement text; empty for a pure delete.</param>
+public readonly record struct TextEdit(long Offset, long Length, string Text);
@@ -0,0 +1,116 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Commands;
+
+/// <summary>
+/// Applies a batch of <see cref="TextEdit"/>s to a <see cref="PieceTable"/>
+/// as one piece-level update and one undo step.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Where a <see cref="CompositeCommand"/> of <see cref="ReplaceCommand"/>s
+/// performs two tree edits, two line-cache updates and two change
+/// notifications per replacement, this command rewrites the spanned range
+/// once: the replacement text is appended to the add buffer, the text
+/// between edits keeps its existing pieces, and
+/// <see cref="PieceTable.TextChanged"/> fires a single time.
+/// </para>
+/// <para>
+/// Undo and redo swap piece descriptors rather than text, so they cost
+/// O(k log n) for k pieces however many characters the batch touched.
+/// </para>
+/// </remarks>
+public sealed class BulkEditCommand : ICommand
+{
+    private readonly PieceTable _table;
+    private readonly string _description;
+    private IReadOnlyList<TextEdit>? _edits;      // released after the first Execute
+    private readonly long _offset;
+    private readonly long _removedLength;
+    private long _insertedLength;
+    private List<Piece> _removed = [];
+    private List<Piece> _inserted = [];
+
+    /// <summary>
+    /// Creates a bulk edit.
+    /// </summary>
+    /// <param name="table">The piece table to modify.</param>
+    /// <param name="edits">
+    /// Edits against the document as it is when the command first executes,
+    /// sorted by offset and non-overlapping.  The list must not be modified
+    /// afterwards.
+    /// </param>
+    /// <param name="description">Undo-menu description of the operation.</param>
+    public BulkEditCommand(PieceTable table, IReadOnlyList<TextEdit> edits, string description = "Edit")
+    {
+        _table = table ?? throw new ArgumentNullException(nameof(table));
+        _edits = edits ?? throw new ArgumentNullException(nameof(edits));
+        _description = description ?? throw new ArgumentNullException(nameof(description));
+
+        if (edits.Count > 0)
+        {
+            _offset = edits[0].Offset;
+            _removedLength = edits[^1].Offset + edits[^1].Length - _offset;
+        }
+        EditCount = edits.Count;
+    }
+
+    /// <inheritdoc />
+    public string Description => _description;
+
+    /// <summary>Number of edits in the batch.</summary>
+    public int EditCount { get; }
+
+    /// <summary>Start of the range the batch spans.</summary>
+    public long Offset => _offset;
+
+    /// <summary>Length of the spanned range before the edits.</summary>
+    public long RemovedLength => _removedLength;
+
+    /// <summary>Length of the spanned range after the edits.</summary>
+    public long InsertedLength => _insertedLength;
+
+    /// <inheritdoc />
+    public void Execute()
+    {
+        if (_edits is { } edits)
+        {
+            if (edits.Count == 0)
+                return;
+
+            // First run: remember what the span held, then build its new
+            // pieces from the edits.
+            _removed = _table.GetPieces(_offset, _removedLength);
+            _inserted = _table.CreateEditedPieces(edits);
+            foreach (Piece p in _inserted)
+                _insertedLength += p.Length;
+            _edits = null;
+        }
+        else if (EditCount == 0)
+        {
+            return;
+        }
+
+        _table.ReplacePieces(_offset, _removedLength, _inserted);
+    }
+
+    /// <inheritdoc />
+    public void Undo()
+    {
+        if (EditCount == 0) return;
+        _table.ReplacePieces(_offset, _insertedLength, _removed);
+    }
+
+    /// <inheritdoc />
+    /// <remarks>
+    /// Bulk edits are deliberate, self-contained operations and are never
+    /// merged with neighbouring commands.
+    /// </remarks>
+    public bool CanMergeWith(ICommand other) => false;
+
+    /// <inheritdoc />
+    public void MergeWith(ICommand other)
+    {
+        throw new NotSupportedException("BulkEditCommand does not support merging.");
+    }
+}
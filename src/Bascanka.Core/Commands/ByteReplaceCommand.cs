@@ -0,0 +1,160 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Commands;
+
+/// <summary>
+/// Replaces a range of a <see cref="BytePieceTable"/> with new bytes.
+/// Covers every hex-editor edit: an overwrite replaces N bytes with N, an
+/// insert replaces zero bytes and a delete inserts none.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The command stores piece descriptors, not bytes: the removed range is
+/// remembered as the pieces that covered it and the inserted bytes as the
+/// add-buffer pieces they were written to.  Undo and redo therefore cost
+/// O(k log n) for k pieces however large the range is, and a 10 MB paste
+/// keeps no second copy of its data once executed.
+/// </para>
+/// <para>
+/// Consecutive edits within a short time window merge into one undo step
+/// when they continue each other — typing or overwriting forwards, or
+/// deleting with Backspace or Delete — and adjacent pieces are coalesced
+/// so a long run of keystrokes stays a handful of descriptors.
+/// </para>
+/// </remarks>
+public sealed class ByteReplaceCommand : ICommand
+{
+    /// <summary>
+    /// Maximum elapsed time between two edits that still allows merging.
+    /// </summary>
+    private static readonly TimeSpan MergeWindow = TimeSpan.FromMilliseconds(500);
+
+    private readonly BytePieceTable _table;
+    private long _offset;
+    private long _removeLength;
+    private byte[]? _bytes;             // released after the first Execute
+    private List<Piece> _removed = [];
+    private List<Piece> _inserted = [];
+    private long _insertedLength;
+    private DateTime _timestamp;
+
+    /// <summary>
+    /// Creates a command replacing <paramref name="removeLength"/> bytes at
+    /// <paramref name="offset"/> with <paramref name="bytes"/>.  The array
+    /// is not copied and must not be modified afterwards.
+    /// </summary>
+    public ByteReplaceCommand(BytePieceTable table, long offset, long removeLength, byte[] bytes)
+    {
+        _table = table ?? throw new ArgumentNullException(nameof(table));
+        _bytes = bytes ?? throw new ArgumentNullException(nameof(bytes));
+        ArgumentOutOfRangeException.ThrowIfNegative(offset);
+        ArgumentOutOfRangeException.ThrowIfNegative(removeLength);
+        _offset = offset;
+        _removeLength = removeLength;
+        _insertedLength = bytes.Length;
+        _timestamp = DateTime.UtcNow;
+    }
+
+    /// <inheritdoc />
+    public string Description =>
+        _removeLength == 0 ? "Insert bytes" :
+        _insertedLength == 0 ? "Delete bytes" : "Overwrite bytes";
+
+    /// <summary>Offset at which the edit starts.</summary>
+    public long Offset => _offset;
+
+    /// <summary>Number of bytes the edit removes.</summary>
+    public long RemovedLength => _removeLength;
+
+    /// <summary>Number of bytes the edit inserts.</summary>
+    public long InsertedLength => _insertedLength;
+
+    /// <inheritdoc />
+    public void Execute()
+    {
+        if (_bytes is { } bytes)
+        {
+            // First run: capture what is being replaced, then write.
+            _removed = _table.GetPieces(_offset, _removeLength);
+            _table.Delete(_offset, _removeLength);
+            _table.Insert(_offset, bytes);
+            _inserted = _table.GetPieces(_offset, bytes.Length);
+            _bytes = null;
+        }
+        else
+        {
+            _table.Delete(_offset, _removeLength);
+            _table.InsertPieces(_offset, _inserted);
+        }
+        _timestamp = DateTime.UtcNow;
+    }
+
+    /// <inheritdoc />
+    public void Undo()
+    {
+        _table.Delete(_offset, _insertedLength);
+        _table.InsertPieces(_offset, _removed);
+    }
+
+    /// <inheritdoc />
+    public bool CanMergeWith(ICommand other)
+    {
+        if (other is not ByteReplaceCommand next || !ReferenceEquals(next._table, _table))
+            return false;
+        if (next._timestamp - _timestamp > MergeWindow)
+            return false;
+
+        // Continues forwards from where this edit's bytes end
+        // (typing, overwriting, or Delete at a fixed caret).
+        if (next._offset == _offset + _insertedLength)
+            return true;
+
+        // Backspace: a pure delete ending where this pure delete began.
+        return _insertedLength == 0 && next._insertedLength == 0 &&
+               next._offset + next._removeLength == _offset;
+    }
+
+    /// <inheritdoc />
+    public void MergeWith(ICommand other)
+    {
+        if (other is not ByteReplaceCommand next)
+            throw new ArgumentException("Cannot merge with a non-ByteReplaceCommand.", nameof(other));
+
+        if (next._offset == _offset + _insertedLength)
+        {
+            // Removed ranges are contiguous in the pre-edit document:
+            // [offset, offset + removeLength) then the bytes after it.
+            AppendPieces(_removed, next._removed);
+            AppendPieces(_inserted, next._inserted);
+        }
+        else
+        {
+            var removed = new List<Piece>(next._removed);
+            AppendPieces(removed, _removed);
+            _removed = removed;
+            _offset = next._offset;
+        }
+
+        _removeLength += next._removeLength;
+        _insertedLength += next._insertedLength;
+        _timestamp = next._timestamp;
+    }
+
+    /// <summary>Appends pieces, joining each with its predecessor when contiguous.</summary>
+    private static void AppendPieces(List<Piece> target, List<Piece> pieces)
+    {
+        foreach (Piece p in pieces)
+        {
+            if (target.Count > 0)
+            {
+                Piece last = target[^1];
+                if (last.BufferType == p.BufferType && last.Start + last.Length == p.Start)
+                {
+                    target[^1] = new Piece(p.BufferType, last.Start, last.Length + p.Length, 0);
+                    continue;
+                }
+            }
+            target.Add(p);
+        }
+    }
+}
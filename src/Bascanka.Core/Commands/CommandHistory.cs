@@ -94,6 +94,18 @@ public sealed class CommandHistory
     /// </summary>
     public string? RedoDescription => _redoStack.Count > 0 ? _redoStack.Peek().Description : null;
 
+    /// <summary>
+    /// The command that <see cref="Undo"/> would reverse next, or
+    /// <see langword="null"/> if the undo stack is empty.
+    /// </summary>
+    public ICommand? NextUndo => _undoStack.Last?.Value;
+
+    /// <summary>
+    /// The command that <see cref="Redo"/> would re-execute next, or
+    /// <see langword="null"/> if the redo stack is empty.
+    /// </summary>
+    public ICommand? NextRedo => _redoStack.Count > 0 ? _redoStack.Peek() : null;
+
     /// <summary>
     /// Executes a command and pushes it onto the undo stack.
     /// If the command can be merged with the most recent undo entry, it is merged
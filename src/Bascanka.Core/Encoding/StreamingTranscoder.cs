@@ -0,0 +1,401 @@
+using System.Buffers;
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Encoding;
+
+/// <summary>
+/// Converts text between encodings in bounded memory, for files and
+/// documents of any size: bytes from a stream to another encoding, and the
+/// text of a document to bytes for saving.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Input is read in batches of blocks of about 1 MB.  When a block can be
+/// cut at a character boundary by looking at its bytes alone — UTF-8,
+/// UTF-16, UTF-32 and single-byte encodings, and always for the text of a
+/// document — the blocks of a batch are converted in parallel and written
+/// in order.  Other encodings, such as GB18030 or Shift JIS, where a byte
+/// may start or continue a character depending on what precedes it, are
+/// converted block by block with one <see cref="System.Text.Decoder"/>
+/// and <see cref="System.Text.Encoder"/>, which carry incomplete
+/// characters from one block to the next.
+/// </para>
+/// <para>All buffers are rented from <see cref="ArrayPool{T}.Shared"/>.</para>
+/// </remarks>
+public static class StreamingTranscoder
+{
+    /// <summary>Bytes, or characters, converted per block.</summary>
+    public const int BlockSize = 1024 * 1024;
+
+    /// <summary>
+    /// Bytes held back at the end of a batch so that the cut can be moved
+    /// back to a character boundary: the longest character, 4 bytes, plus
+    /// the bytes examined to find where it starts.
+    /// </summary>
+    private const int MaxCarry = 8;
+
+    /// <summary>How the bytes of an encoding can be cut at a character boundary.</summary>
+    private enum Split
+    {
+        None,
+        SingleByte,
+        Utf8,
+        Utf16LittleEndian,
+        Utf16BigEndian,
+        Utf32,
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Bytes to bytes
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Reads <paramref name="source"/> to its end in
+    /// <paramref name="sourceEncoding"/> and writes the same text to
+    /// <paramref name="destination"/> in <paramref name="targetEncoding"/>.
+    /// A byte order mark at the start of the source is skipped.  Line
+    /// endings are kept as they are.
+    /// </summary>
+    /// <param name="writePreamble">Writes the byte order mark of <paramref name="targetEncoding"/> first.</param>
+    /// <param name="progress">Receives the number of source bytes read so far.</param>
+    /// <param name="cancellationToken">Cancels the conversion between batches.</param>
+    /// <exception cref="OperationCanceledException">The conversion was cancelled.</exception>
+    public static void Transcode(Stream source, System.Text.Encoding sourceEncoding, Stream destination,
+        System.Text.Encoding targetEncoding, bool writePreamble = false, IProgress<long>? progress = null,
+        CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(source);
+        ArgumentNullException.ThrowIfNull(sourceEncoding);
+        ArgumentNullException.ThrowIfNull(destination);
+        ArgumentNullException.ThrowIfNull(targetEncoding);
+
+        if (writePreamble)
+            destination.Write(targetEncoding.GetPreamble());
+
+        // Bytes read to look for a byte order mark that turn out to be text
+        // are handed on as the start of the text.
+        byte[] preamble = GetSourcePreamble(sourceEncoding);
+        Span<byte> head = stackalloc byte[preamble.Length];
+        int headLength = ReadFully(source, head);
+        ReadOnlySpan<byte> initial = headLength == preamble.Length && head.SequenceEqual(preamble)
+            ? []
+            : head[..headLength];
+
+        Split split = GetSplit(sourceEncoding);
+        if (split == Split.None)
+            TranscodeSequential(source, sourceEncoding, destination, targetEncoding, initial, headLength,
+                progress, cancellationToken);
+        else
+            TranscodeParallel(source, sourceEncoding, destination, targetEncoding, split, initial, headLength,
+                progress, cancellationToken);
+    }
+
+    private static void TranscodeSequential(Stream source, System.Text.Encoding sourceEncoding,
+        Stream destination, System.Text.Encoding targetEncoding, ReadOnlySpan<byte> initial, long read,
+        IProgress<long>? progress, CancellationToken cancellationToken)
+    {
+        System.Text.Decoder decoder = sourceEncoding.GetDecoder();
+        System.Text.Encoder encoder = targetEncoding.GetEncoder();
+        byte[] input = ArrayPool<byte>.Shared.Rent(BlockSize);
+        char[] chars = ArrayPool<char>.Shared.Rent(sourceEncoding.GetMaxCharCount(BlockSize + MaxCarry));
+        byte[] output = ArrayPool<byte>.Shared.Rent(targetEncoding.GetMaxByteCount(chars.Length + 2));
+        try
+        {
+            initial.CopyTo(input);
+            int filled = initial.Length;
+            while (true)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+                int n = ReadFully(source, input.AsSpan(filled, BlockSize - filled));
+                read += n;
+                filled += n;
+                bool end = filled < BlockSize;
+
+                int charCount = decoder.GetChars(input.AsSpan(0, filled), chars, flush: end);
+                int byteCount = encoder.GetBytes(chars.AsSpan(0, charCount), output, flush: end);
+                destination.Write(output, 0, byteCount);
+                progress?.Report(read);
+
+                if (end) break;
+                filled = 0;
+            }
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(input);
+            ArrayPool<char>.Shared.Return(chars);
+            ArrayPool<byte>.Shared.Return(output);
+        }
+    }
+
+    private static void TranscodeParallel(Stream source, System.Text.Encoding sourceEncoding,
+        Stream destination, System.Text.Encoding targetEncoding, Split split, ReadOnlySpan<byte> initial,
+        long read, IProgress<long>? progress, CancellationToken cancellationToken)
+    {
+        int blocks = Environment.ProcessorCount;
+        int batchSize = blocks * BlockSize;
+        var options = new ParallelOptions { CancellationToken = cancellationToken };
+        var bounds = new int[blocks + 1];
+        var outputs = new (byte[] Bytes, int Count)[blocks];
+        byte[] input = ArrayPool<byte>.Shared.Rent(batchSize + MaxCarry);
+        try
+        {
+            initial.CopyTo(input);
+            int filled = initial.Length;
+            while (true)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+                int n = ReadFully(source, input.AsSpan(filled, batchSize + MaxCarry - filled));
+                read += n;
+                filled += n;
+                bool end = filled < batchSize + MaxCarry;
+
+                // Cut the batch into blocks at character boundaries; the
+                // bytes after the last cut start the next batch.  Cuts moved
+                // back leave a few more bytes for the last block.
+                int last = end ? filled : AlignBack(input, filled - MaxCarry, split);
+                int count = 0;
+                bounds[0] = 0;
+                while (bounds[count] < last)
+                {
+                    int cut = bounds[count] + BlockSize;
+                    bounds[++count] = cut >= last || count == blocks ? last : AlignBack(input, cut, split);
+                }
+
+                Parallel.For(0, count, options, i =>
+                {
+                    ReadOnlySpan<byte> block = input.AsSpan(bounds[i], bounds[i + 1] - bounds[i]);
+                    char[] chars = ArrayPool<char>.Shared.Rent(sourceEncoding.GetMaxCharCount(block.Length));
+                    try
+                    {
+                        int charCount = sourceEncoding.GetChars(block, chars);
+                        byte[] bytes = ArrayPool<byte>.Shared.Rent(targetEncoding.GetMaxByteCount(charCount));
+                        outputs[i] = (bytes, targetEncoding.GetBytes(chars.AsSpan(0, charCount), bytes));
+                    }
+                    finally
+                    {
+                        ArrayPool<char>.Shared.Return(chars);
+                    }
+                });
+
+                for (int i = 0; i < count; i++)
+                {
+                    destination.Write(outputs[i].Bytes, 0, outputs[i].Count);
+                    ArrayPool<byte>.Shared.Return(outputs[i].Bytes);
+                    outputs[i] = default;
+                }
+                progress?.Report(read);
+
+                if (end) break;
+                input.AsSpan(last, filled - last).CopyTo(input);
+                filled -= last;
+            }
+        }
+        finally
+        {
+            foreach (var (bytes, _) in outputs)
+            {
+                if (bytes is not null)
+                    ArrayPool<byte>.Shared.Return(bytes);
+            }
+            ArrayPool<byte>.Shared.Return(input);
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Document to bytes
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Writes <c>document[start, start + length)</c> to
+    /// <paramref name="destination"/> in <paramref name="encoding"/>,
+    /// converting every line break to <paramref name="lineEnding"/>.  Safe
+    /// to call from a background thread when no concurrent writes are
+    /// happening to the document.
+    /// </summary>
+    /// <param name="lineEnding"><c>"CRLF"</c>, <c>"LF"</c> or <c>"CR"</c>.</param>
+    /// <param name="progress">Receives the number of characters written so far.</param>
+    /// <param name="cancellationToken">Cancels the conversion between batches.</param>
+    /// <exception cref="OperationCanceledException">The conversion was cancelled.</exception>
+    public static void Encode(PieceTable document, long start, long length, Stream destination,
+        System.Text.Encoding encoding, string lineEnding, IProgress<long>? progress = null,
+        CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+        ArgumentNullException.ThrowIfNull(destination);
+        ArgumentNullException.ThrowIfNull(encoding);
+
+        string lineBreak = lineEnding switch
+        {
+            "CRLF" => "\r\n",
+            "CR" => "\r",
+            _ => "\n",
+        };
+        int blocks = Environment.ProcessorCount;
+        var options = new ParallelOptions { CancellationToken = cancellationToken };
+        var inputs = new char[blocks][];
+        var lengths = new int[blocks];
+        var outputs = new (byte[] Bytes, int Count)[blocks];
+        long end = start + length;
+        long offset = start;
+        try
+        {
+            while (offset < end)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+
+                // The document is read on this thread; it is not thread-safe.
+                // A block never ends between a carriage return and a line
+                // feed, or between the two halves of a surrogate pair.
+                int count = 0;
+                while (count < blocks && offset < end)
+                {
+                    char[] chars = inputs[count] ??= ArrayPool<char>.Shared.Rent(BlockSize);
+                    int take = (int)Math.Min(BlockSize, end - offset);
+                    document.CopyTo(offset, chars.AsSpan(0, take));
+                    if (offset + take < end)
+                    {
+                        while (take > 1 && (chars[take - 1] == '\r' || char.IsHighSurrogate(chars[take - 1])))
+                            take--;
+                    }
+                    lengths[count++] = take;
+                    offset += take;
+                }
+
+                Parallel.For(0, count, options, i =>
+                {
+                    ReadOnlySpan<char> block = inputs[i].AsSpan(0, lengths[i]);
+                    char[] converted = ArrayPool<char>.Shared.Rent(block.Length * lineBreak.Length);
+                    try
+                    {
+                        int charCount = ConvertLineBreaks(block, converted, lineBreak);
+                        byte[] bytes = ArrayPool<byte>.Shared.Rent(encoding.GetMaxByteCount(charCount));
+                        outputs[i] = (bytes, encoding.GetBytes(converted.AsSpan(0, charCount), bytes));
+                    }
+                    finally
+                    {
+                        ArrayPool<char>.Shared.Return(converted);
+                    }
+                });
+
+                for (int i = 0; i < count; i++)
+                {
+                    destination.Write(outputs[i].Bytes, 0, outputs[i].Count);
+                    ArrayPool<byte>.Shared.Return(outputs[i].Bytes);
+                    outputs[i] = default;
+                }
+                progress?.Report(offset - start);
+            }
+        }
+        finally
+        {
+            foreach (var (bytes, _) in outputs)
+            {
+                if (bytes is not null)
+                    ArrayPool<byte>.Shared.Return(bytes);
+            }
+            foreach (char[]? chars in inputs)
+            {
+                if (chars is not null)
+                    ArrayPool<char>.Shared.Return(chars);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Copies <paramref name="text"/> to <paramref name="destination"/>
+    /// with each <c>\r\n</c>, <c>\r</c> and <c>\n</c> replaced by
+    /// <paramref name="lineBreak"/>, and returns the characters written.
+    /// </summary>
+    private static int ConvertLineBreaks(ReadOnlySpan<char> text, Span<char> destination, string lineBreak)
+    {
+        int written = 0;
+        int pos = 0;
+        while (pos < text.Length)
+        {
+            int brk = text[pos..].IndexOfAny('\r', '\n');
+            int runEnd = brk < 0 ? text.Length : pos + brk;
+            text[pos..runEnd].CopyTo(destination[written..]);
+            written += runEnd - pos;
+            if (brk < 0) break;
+
+            lineBreak.CopyTo(destination[written..]);
+            written += lineBreak.Length;
+            pos = text[runEnd] == '\r' && runEnd + 1 < text.Length && text[runEnd + 1] == '\n'
+                ? runEnd + 2
+                : runEnd + 1;
+        }
+        return written;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Helpers
+    // ────────────────────────────────────────────────────────────────────
+
+    private static Split GetSplit(System.Text.Encoding encoding) => encoding.CodePage switch
+    {
+        65001 => Split.Utf8,
+        1200 => Split.Utf16LittleEndian,
+        1201 => Split.Utf16BigEndian,
+        12000 or 12001 => Split.Utf32,
+        _ => encoding.IsSingleByte ? Split.SingleByte : Split.None,
+    };
+
+    /// <summary>
+    /// The byte order mark to skip at the start of text in
+    /// <paramref name="encoding"/>.  UTF-8 text may start with one even when
+    /// the encoding would not write it.
+    /// </summary>
+    private static byte[] GetSourcePreamble(System.Text.Encoding encoding)
+    {
+        byte[] preamble = encoding.GetPreamble();
+        return preamble.Length == 0 && encoding.CodePage == 65001 ? [0xEF, 0xBB, 0xBF] : preamble;
+    }
+
+    /// <summary>
+    /// Moves <paramref name="pos"/> back to the nearest character boundary
+    /// at or before it.  Positions are relative to the start of the text, so
+    /// multi-byte code units stay aligned.
+    /// </summary>
+    private static int AlignBack(byte[] data, int pos, Split split)
+    {
+        switch (split)
+        {
+            case Split.Utf8:
+                // Continuation bytes look like 10xxxxxx.
+                for (int i = 0; i < 3 && pos > 0 && (data[pos] & 0xC0) == 0x80; i++)
+                    pos--;
+                return pos;
+
+            case Split.Utf16LittleEndian:
+            case Split.Utf16BigEndian:
+            {
+                pos &= ~1;
+                int unit = split == Split.Utf16LittleEndian
+                    ? data[pos] | data[pos + 1] << 8
+                    : data[pos] << 8 | data[pos + 1];
+                // A low surrogate belongs with the high surrogate before it.
+                return unit is >= 0xDC00 and <= 0xDFFF && pos >= 2 ? pos - 2 : pos;
+            }
+
+            case Split.Utf32:
+                return pos & ~3;
+
+            default:
+                return pos;
+        }
+    }
+
+    /// <summary>Reads until <paramref name="buffer"/> is full or the stream ends.</summary>
+    private static int ReadFully(Stream stream, Span<byte> buffer)
+    {
+        int total = 0;
+        while (total < buffer.Length)
+        {
+            int n = stream.Read(buffer[total..]);
+            if (n == 0) break;
+            total += n;
+        }
+        return total;
+    }
+}
@@ -0,0 +1,472 @@
+using System.Buffers.Binary;
+using System.Runtime.InteropServices;
+using Bascanka.Core.Buffer;
+using TextEncoding = System.Text.Encoding;
+
+namespace Bascanka.Core.IO;
+
+/// <summary>
+/// A write-ahead journal of a <see cref="PieceTable"/>'s state for crash
+/// recovery: a checkpoint holding the buffers and piece list, followed by
+/// an append-only log of what changed since.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The add buffer only grows and edits change the piece list locally, so
+/// each <see cref="Write"/> appends one record holding the characters
+/// appended to the add buffer since the previous write and the run of
+/// pieces that differs from the previous piece list.  Typing into a large
+/// document costs a few hundred bytes per write instead of a rewrite of
+/// the document.
+/// </para>
+/// <para>
+/// Once the log grows past the size of the checkpoint (and at least
+/// <see cref="CompactionMinBytes"/>), or the document is replaced, the next
+/// write compacts: a new checkpoint is written to a temporary file and
+/// moved into place, then the log restarts.  Checkpoint and log carry a
+/// generation number, so a log left over from before a compaction that
+/// was interrupted is ignored.  Log records are length-prefixed and
+/// checksummed; <see cref="Read"/> stops at the first torn record.
+/// </para>
+/// <para>This class is <b>not</b> thread-safe; callers must synchronize
+/// externally if they access it from multiple threads.</para>
+/// </remarks>
+public sealed class EditJournal : IDisposable
+{
+    /// <summary>The log is never compacted while smaller than this.</summary>
+    public const long CompactionMinBytes = 1024 * 1024;
+
+    private const uint FormatVersion = 1;
+    private const int TextChunkChars = 64 * 1024;
+    private const int PieceBytes = 1 + 8 + 8 + 4;
+    private const int RecordHeaderBytes = 8;
+
+    private static ReadOnlySpan<byte> CheckpointMagic => "BSJC"u8;
+    private static ReadOnlySpan<byte> LogMagic => "BSJL"u8;
+
+    private delegate void CopyText(long start, Span<char> destination);
+
+    private readonly string _checkpointPath;
+    private readonly string _logPath;
+    private FileStream? _log;
+    private long _checkpointBytes;
+
+    // What the files on disk describe.
+    private PieceTable? _table;
+    private bool _includesOriginal;
+    private long _addWritten;
+    private List<Piece> _pieces = [];
+    private bool _disposed;
+
+    /// <summary>Creates a journal that writes to the given files.</summary>
+    /// <param name="checkpointPath">Path of the checkpoint file.</param>
+    /// <param name="logPath">Path of the append-only log.</param>
+    public EditJournal(string checkpointPath, string logPath)
+    {
+        ArgumentException.ThrowIfNullOrEmpty(checkpointPath);
+        ArgumentException.ThrowIfNullOrEmpty(logPath);
+        _checkpointPath = checkpointPath;
+        _logPath = logPath;
+    }
+
+    /// <summary>Current size of the log, in bytes.</summary>
+    public long LogBytes => _log?.Length ?? 0;
+
+    /// <summary>Bytes written by the last <see cref="Write"/>.</summary>
+    public long LastWriteBytes { get; private set; }
+
+    /// <summary>Whether the last <see cref="Write"/> wrote a checkpoint.</summary>
+    public bool LastWriteWasCheckpoint { get; private set; }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Writing
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Records the current state of <paramref name="table"/>: appends what
+    /// changed since the last write, or writes a checkpoint if this is the
+    /// first write, the table was replaced, or the log is due compaction.
+    /// </summary>
+    /// <param name="table">The document to record.</param>
+    /// <param name="includeOriginal">
+    /// Whether the checkpoint stores the original buffer.  Pass
+    /// <see langword="false"/> when the original is a file on disk that
+    /// recovery reopens; pieces then refer to that file.
+    /// </param>
+    public void Write(PieceTable table, bool includeOriginal)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        ArgumentNullException.ThrowIfNull(table);
+
+        IReadOnlyList<Piece> pieces = table.GetPiecesInOrder();
+        try
+        {
+            if (_log is null || !ReferenceEquals(table, _table) || includeOriginal != _includesOriginal ||
+                _log.Length > Math.Max(CompactionMinBytes, _checkpointBytes))
+            {
+                WriteCheckpoint(table, pieces, includeOriginal);
+            }
+            else
+            {
+                AppendRecord(table, pieces);
+            }
+        }
+        catch
+        {
+            // The files may be half-written; start over with a checkpoint.
+            _table = null;
+            throw;
+        }
+    }
+
+    /// <summary>Closes the log and deletes both files.</summary>
+    public void Delete()
+    {
+        CloseLog();
+        _table = null;
+        TryDelete(_checkpointPath);
+        TryDelete(_checkpointPath + ".tmp");
+        TryDelete(_logPath);
+    }
+
+    /// <inheritdoc />
+    public void Dispose()
+    {
+        if (_disposed) return;
+        _disposed = true;
+        CloseLog();
+    }
+
+    private void AppendRecord(PieceTable table, IReadOnlyList<Piece> pieces)
+    {
+        LastWriteWasCheckpoint = false;
+        LastWriteBytes = 0;
+
+        // The changed run of pieces: everything between the common prefix
+        // and the common suffix of the old and new lists.
+        int oldCount = _pieces.Count, newCount = pieces.Count;
+        int prefix = 0;
+        while (prefix < oldCount && prefix < newCount && _pieces[prefix] == pieces[prefix])
+            prefix++;
+        int suffix = 0;
+        while (suffix < oldCount - prefix && suffix < newCount - prefix &&
+               _pieces[oldCount - 1 - suffix] == pieces[newCount - 1 - suffix])
+            suffix++;
+        int removed = oldCount - prefix - suffix;
+        int inserted = newCount - prefix - suffix;
+
+        long addLength = table.AddBufferLength;
+        if (addLength == _addWritten && removed == 0 && inserted == 0)
+            return;
+
+        // The tail is stored as UTF-16 so that a surrogate pair split
+        // between two writes survives.
+        string tail = table.GetAddBufferText(_addWritten, addLength - _addWritten);
+        ReadOnlySpan<byte> tailBytes = MemoryMarshal.AsBytes(tail.AsSpan());
+
+        int payloadLength = 8 + 4 + tailBytes.Length + 4 + 4 + 4 + inserted * PieceBytes;
+        byte[] record = new byte[RecordHeaderBytes + payloadLength];
+        Span<byte> payload = record.AsSpan(RecordHeaderBytes);
+
+        int at = 0;
+        BinaryPrimitives.WriteInt64LittleEndian(payload[at..], _addWritten); at += 8;
+        BinaryPrimitives.WriteInt32LittleEndian(payload[at..], tail.Length); at += 4;
+        if (BitConverter.IsLittleEndian)
+        {
+            tailBytes.CopyTo(payload[at..]);
+        }
+        else
+        {
+            for (int i = 0; i < tail.Length; i++)
+                BinaryPrimitives.WriteUInt16LittleEndian(payload[(at + 2 * i)..], tail[i]);
+        }
+        at += tailBytes.Length;
+        BinaryPrimitives.WriteInt32LittleEndian(payload[at..], prefix); at += 4;
+        BinaryPrimitives.WriteInt32LittleEndian(payload[at..], removed); at += 4;
+        BinaryPrimitives.WriteInt32LittleEndian(payload[at..], inserted); at += 4;
+        for (int i = prefix; i < prefix + inserted; i++)
+            at += WritePiece(payload[at..], pieces[i]);
+
+        BinaryPrimitives.WriteInt32LittleEndian(record, payloadLength);
+        BinaryPrimitives.WriteUInt32LittleEndian(record.AsSpan(4), Checksum(payload));
+
+        _log!.Write(record);
+        _log.Flush(flushToDisk: true);
+
+        _addWritten = addLength;
+        _pieces = [.. pieces];
+        LastWriteBytes = record.Length;
+    }
+
+    private void WriteCheckpoint(PieceTable table, IReadOnlyList<Piece> pieces, bool includeOriginal)
+    {
+        CloseLog();
+        long generation = Random.Shared.NextInt64();
+        long addLength = table.AddBufferLength;
+        string tmpPath = _checkpointPath + ".tmp";
+
+        long checkpointBytes;
+        using (var fs = new FileStream(tmpPath, FileMode.Create, FileAccess.ReadWrite, FileShare.None))
+        {
+            using (var bw = new BinaryWriter(fs, TextEncoding.UTF8, leaveOpen: true))
+            {
+                bw.Write(CheckpointMagic);
+                bw.Write(FormatVersion);
+                bw.Write(generation);
+                bw.Write(includeOriginal);
+                if (includeOriginal)
+                {
+                    ITextSource original = table.OriginalSource;
+                    WriteText(fs, bw, original.Length, (start, dest) => original.CopyTo(start, dest));
+                }
+                WriteText(fs, bw, addLength,
+                    (start, dest) => table.GetAddBufferText(start, dest.Length).CopyTo(dest));
+
+                bw.Write(pieces.Count);
+                Span<byte> piece = stackalloc byte[PieceBytes];
+                foreach (Piece p in pieces)
+                {
+                    WritePiece(piece, p);
+                    bw.Write(piece);
+                }
+            }
+            fs.Flush(flushToDisk: true);
+            checkpointBytes = fs.Length;
+        }
+        File.Move(tmpPath, _checkpointPath, overwrite: true);
+
+        // A new log for the new generation.  Until it exists, the old log
+        // (if any) has the previous generation and is ignored.
+        _log = new FileStream(_logPath, FileMode.Create, FileAccess.Write, FileShare.Read);
+        Span<byte> header = stackalloc byte[16];
+        LogMagic.CopyTo(header);
+        BinaryPrimitives.WriteUInt32LittleEndian(header[4..], FormatVersion);
+        BinaryPrimitives.WriteInt64LittleEndian(header[8..], generation);
+        _log.Write(header);
+        _log.Flush(flushToDisk: true);
+
+        _checkpointBytes = checkpointBytes;
+        _table = table;
+        _includesOriginal = includeOriginal;
+        _addWritten = addLength;
+        _pieces = [.. pieces];
+        LastWriteWasCheckpoint = true;
+        LastWriteBytes = checkpointBytes + header.Length;
+    }
+
+    /// <summary>
+    /// Writes <paramref name="length"/> characters as UTF-8 in chunks,
+    /// preceded by the character count and the encoded byte count.
+    /// </summary>
+    private static void WriteText(FileStream fs, BinaryWriter bw, long length, CopyText copy)
+    {
+        bw.Write(length);
+        long sizePosition = fs.Position;
+        bw.Write(0L);
+        bw.Flush();
+
+        var encoder = TextEncoding.UTF8.GetEncoder();
+        char[] chars = new char[(int)Math.Min(TextChunkChars, Math.Max(length, 1))];
+        byte[] bytes = new byte[TextEncoding.UTF8.GetMaxByteCount(chars.Length)];
+        long byteCount = 0;
+        for (long start = 0; start < length;)
+        {
+            int take = (int)Math.Min(chars.Length, length - start);
+            copy(start, chars.AsSpan(0, take));
+            start += take;
+            int n = encoder.GetBytes(chars, 0, take, bytes, 0, flush: start == length);
+            fs.Write(bytes, 0, n);
+            byteCount += n;
+        }
+
+        long end = fs.Position;
+        fs.Position = sizePosition;
+        bw.Write(byteCount);
+        bw.Flush();
+        fs.Position = end;
+    }
+
+    private static int WritePiece(Span<byte> destination, Piece piece)
+    {
+        destination[0] = (byte)piece.BufferType;
+        BinaryPrimitives.WriteInt64LittleEndian(destination[1..], piece.Start);
+        BinaryPrimitives.WriteInt64LittleEndian(destination[9..], piece.Length);
+        BinaryPrimitives.WriteInt32LittleEndian(destination[17..], piece.LineFeeds);
+        return PieceBytes;
+    }
+
+    private void CloseLog()
+    {
+        _log?.Dispose();
+        _log = null;
+    }
+
+    private static void TryDelete(string path)
+    {
+        try { if (File.Exists(path)) File.Delete(path); }
+        catch { /* best effort */ }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Reading
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Replays a checkpoint and its log.  Returns <see langword="null"/> if
+    /// the checkpoint is missing or unreadable; log records after the first
+    /// torn or inconsistent one are ignored.
+    /// </summary>
+    public static JournalSnapshot? Read(string checkpointPath, string logPath)
+    {
+        string? original;
+        System.Text.StringBuilder add;
+        List<Piece> pieces;
+        long generation;
+
+        try
+        {
+            using var fs = new FileStream(checkpointPath, FileMode.Open, FileAccess.Read, FileShare.Read);
+            using var br = new BinaryReader(fs);
+
+            if (!br.ReadBytes(4).AsSpan().SequenceEqual(CheckpointMagic) || br.ReadUInt32() != FormatVersion)
+                return null;
+            generation = br.ReadInt64();
+            bool hasOriginal = br.ReadBoolean();
+            original = hasOriginal ? ReadText(br) : null;
+            add = new System.Text.StringBuilder(ReadText(br));
+
+            int count = br.ReadInt32();
+            if (count < 0 || (long)count * PieceBytes > fs.Length - fs.Position)
+                return null;
+            pieces = new List<Piece>(count);
+            for (int i = 0; i < count; i++)
+                pieces.Add(ReadPiece(br.ReadBytes(PieceBytes)));
+        }
+        catch (Exception ex) when (ex is IOException or UnauthorizedAccessException or InvalidDataException)
+        {
+            return null;
+        }
+
+        try
+        {
+            if (File.Exists(logPath))
+                ReplayLog(logPath, generation, add, pieces);
+        }
+        catch (Exception ex) when (ex is IOException or UnauthorizedAccessException)
+        {
+            // Keep what was replayed before the failure.
+        }
+
+        return new JournalSnapshot(original, add.ToString(), pieces);
+    }
+
+    private static void ReplayLog(string logPath, long generation, System.Text.StringBuilder add, List<Piece> pieces)
+    {
+        byte[] log = File.ReadAllBytes(logPath);
+        ReadOnlySpan<byte> span = log;
+        if (span.Length < 16 || !span[..4].SequenceEqual(LogMagic) ||
+            BinaryPrimitives.ReadUInt32LittleEndian(span[4..]) != FormatVersion ||
+            BinaryPrimitives.ReadInt64LittleEndian(span[8..]) != generation)
+            return;
+        span = span[16..];
+
+        while (span.Length >= RecordHeaderBytes)
+        {
+            int length = BinaryPrimitives.ReadInt32LittleEndian(span);
+            if (length < 0 || length > span.Length - RecordHeaderBytes) return;
+            ReadOnlySpan<byte> payload = span.Slice(RecordHeaderBytes, length);
+            if (BinaryPrimitives.ReadUInt32LittleEndian(span[4..]) != Checksum(payload)) return;
+            if (!ApplyRecord(payload, add, pieces)) return;
+            span = span[(RecordHeaderBytes + length)..];
+        }
+    }
+
+    private static bool ApplyRecord(ReadOnlySpan<byte> payload, System.Text.StringBuilder add, List<Piece> pieces)
+    {
+        if (payload.Length < 12) return false;
+        long addStart = BinaryPrimitives.ReadInt64LittleEndian(payload);
+        int tailChars = BinaryPrimitives.ReadInt32LittleEndian(payload[8..]);
+        if (addStart != add.Length || tailChars < 0 || (long)tailChars * 2 > payload.Length - 24)
+            return false;
+        payload = payload[12..];
+
+        for (int i = 0; i < tailChars; i++)
+            add.Append((char)BinaryPrimitives.ReadUInt16LittleEndian(payload[(2 * i)..]));
+        payload = payload[(2 * tailChars)..];
+
+        int prefix = BinaryPrimitives.ReadInt32LittleEndian(payload);
+        int removed = BinaryPrimitives.ReadInt32LittleEndian(payload[4..]);
+        int inserted = BinaryPrimitives.ReadInt32LittleEndian(payload[8..]);
+        payload = payload[12..];
+        if (prefix < 0 || removed < 0 || inserted < 0 || prefix > pieces.Count - removed ||
+            (long)inserted * PieceBytes != payload.Length)
+            return false;
+
+        var replacement = new Piece[inserted];
+        for (int i = 0; i < inserted; i++)
+            replacement[i] = ReadPiece(payload.Slice(i * PieceBytes, PieceBytes));
+        pieces.RemoveRange(prefix, removed);
+        pieces.InsertRange(prefix, replacement);
+        return true;
+    }
+
+    private static string ReadText(BinaryReader br)
+    {
+        long chars = br.ReadInt64();
+        long bytes = br.ReadInt64();
+        if (chars < 0 || bytes < 0 || bytes > int.MaxValue || bytes > br.BaseStream.Length - br.BaseStream.Position)
+            throw new InvalidDataException("Bad text length in recovery checkpoint.");
+
+        string text = TextEncoding.UTF8.GetString(br.ReadBytes((int)bytes));
+        if (text.Length != chars)
+            throw new InvalidDataException("Recovery checkpoint text does not match its length.");
+        return text;
+    }
+
+    private static Piece ReadPiece(ReadOnlySpan<byte> source) =>
+        new((BufferType)source[0],
+            BinaryPrimitives.ReadInt64LittleEndian(source[1..]),
+            BinaryPrimitives.ReadInt64LittleEndian(source[9..]),
+            BinaryPrimitives.ReadInt32LittleEndian(source[17..]));
+
+    /// <summary>FNV-1a, enough to tell a torn record from a complete one.</summary>
+    private static uint Checksum(ReadOnlySpan<byte> data)
+    {
+        uint hash = 2166136261;
+        foreach (byte b in data)
+            hash = (hash ^ b) * 16777619;
+        return hash;
+    }
+}
+
+/// <summary>
+/// A piece table's state as recovered by <see cref="EditJournal.Read"/>.
+/// </summary>
+/// <param name="OriginalText">
+/// The original buffer, or <see langword="null"/> if the journal refers to
+/// the file on disk instead.
+/// </param>
+/// <param name="AddBuffer">The add buffer.</param>
+/// <param name="Pieces">The pieces in document order.</param>
+public sealed record JournalSnapshot(string? OriginalText, string AddBuffer, IReadOnlyList<Piece> Pieces)
+{
+    /// <summary>
+    /// Assembles the document text.  Requires <see cref="OriginalText"/>
+    /// if any piece refers to the original buffer.
+    /// </summary>
+    /// <exception cref="InvalidDataException">A piece lies outside its buffer.</exception>
+    public string BuildText()
+    {
+        var sb = new System.Text.StringBuilder();
+        foreach (Piece p in Pieces)
+        {
+            string buffer = p.BufferType == BufferType.Add
+                ? AddBuffer
+                : OriginalText ?? throw new InvalidDataException("The journal does not include the original text.");
+            if (p.Start < 0 || p.Length < 0 || p.Start + p.Length > buffer.Length)
+                throw new InvalidDataException("Recovery piece lies outside its buffer.");
+            sb.Append(buffer, (int)p.Start, (int)p.Length);
+        }
+        return sb.ToString();
+    }
+}
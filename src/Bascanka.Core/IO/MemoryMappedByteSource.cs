@@ -0,0 +1,95 @@
+using System.IO.MemoryMappedFiles;
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.IO;
+
+/// <summary>
+/// An <see cref="IByteSource"/> backed by a read-only
+/// <see cref="MemoryMappedFile"/>.  The whole file is mapped as a single
+/// view, so nothing is read up front: the operating system pages bytes in
+/// as ranges are copied and evicts them under memory pressure.  Opening a
+/// multi-gigabyte file therefore costs the same as opening a small one.
+/// </summary>
+/// <remarks>
+/// The file is opened with <see cref="FileShare.ReadWrite"/> and
+/// <see cref="FileShare.Delete"/>, so other programs can keep writing,
+/// renaming or deleting it while it is open, as they could when hex mode
+/// read the whole file into memory.  The operating system still refuses
+/// to replace a file that is mapped, so saving over it requires writing to
+/// a temporary file and swapping after <see cref="Dispose"/>.
+/// </remarks>
+public sealed unsafe class MemoryMappedByteSource : IByteSource, IDisposable
+{
+    private readonly MemoryMappedFile? _mmf;
+    private readonly MemoryMappedViewAccessor? _view;
+    private readonly byte* _base;
+    private bool _disposed;
+
+    /// <summary>Maps <paramref name="path"/> for reading.</summary>
+    public MemoryMappedByteSource(string path)
+    {
+        ArgumentException.ThrowIfNullOrWhiteSpace(path);
+
+        FilePath = path;
+        Length = new FileInfo(path).Length;
+
+        // Zero-length files cannot be mapped.
+        if (Length == 0) return;
+
+        var stream = new FileStream(path, FileMode.Open, FileAccess.Read,
+            FileShare.ReadWrite | FileShare.Delete);
+        try
+        {
+            _mmf = MemoryMappedFile.CreateFromFile(stream, null, 0, MemoryMappedFileAccess.Read,
+                HandleInheritability.None, leaveOpen: false);
+        }
+        catch
+        {
+            stream.Dispose();
+            throw;
+        }
+        try
+        {
+            _view = _mmf.CreateViewAccessor(0, Length, MemoryMappedFileAccess.Read);
+            byte* pointer = null;
+            _view.SafeMemoryMappedViewHandle.AcquirePointer(ref pointer);
+            _base = pointer + _view.PointerOffset;
+        }
+        catch
+        {
+            _view?.Dispose();
+            _mmf.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>Full path to the mapped file.</summary>
+    public string FilePath { get; }
+
+    /// <inheritdoc />
+    public long Length { get; }
+
+    /// <inheritdoc />
+    public void CopyTo(long offset, Span<byte> destination)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        if (offset < 0 || offset + destination.Length > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+        if (destination.IsEmpty) return;
+
+        new ReadOnlySpan<byte>(_base + offset, destination.Length).CopyTo(destination);
+    }
+
+    public void Dispose()
+    {
+        if (_disposed) return;
+        _disposed = true;
+
+        if (_view is not null)
+        {
+            _view.SafeMemoryMappedViewHandle.ReleasePointer();
+            _view.Dispose();
+        }
+        _mmf?.Dispose();
+    }
+}
@@ -49,6 +49,12 @@ public sealed class MemoryMappedFileSource : ITextSource, IPrecomputedLineFeeds,
     /// <summary>Full path to the file on disk.</summary>
     public string FilePath { get; }
 
+    /// <summary>
+    /// Whether the file is temporary and is deleted when the source is
+    /// disposed, rather than a file the user opened.
+    /// </summary>
+    public bool DeleteOnDispose { get; }
+
     /// <summary>Size of the file in bytes.</summary>
     public long FileSize { get; }
 
@@ -99,8 +105,12 @@ public sealed class MemoryMappedFileSource : ITextSource, IPrecomputedLineFeeds,
     /// scanning the file.  Call <see cref="ScanNextBatch"/> to process chunks
     /// incrementally.
     /// </param>
+    /// <param name="deleteOnDispose">
+    /// When <see langword="true"/>, the file is deleted when the source is
+    /// disposed.  Used for temporary files that hold generated text.
+    /// </param>
     public MemoryMappedFileSource(string filePath, TextEncoding? encoding = null,
-        bool normalizeLineEndings = false, bool deferScan = false)
+        bool normalizeLineEndings = false, bool deferScan = false, bool deleteOnDispose = false)
     {
         if (string.IsNullOrWhiteSpace(filePath))
             throw new ArgumentException("File path must not be empty.", nameof(filePath));
@@ -109,6 +119,7 @@ public sealed class MemoryMappedFileSource : ITextSource, IPrecomputedLineFeeds,
             throw new FileNotFoundException("File not found.", filePath);
 
         FilePath = Path.GetFullPath(filePath);
+        DeleteOnDispose = deleteOnDispose;
         FileSize = new FileInfo(FilePath).Length;
 
         // Detect encoding if not provided.
@@ -229,6 +240,28 @@ public sealed class MemoryMappedFileSource : ITextSource, IPrecomputedLineFeeds,
         return sb.ToString();
     }
 
+    /// <inheritdoc />
+    public void CopyTo(long start, Span<char> destination)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        ValidateRange(start, destination.Length);
+
+        if (destination.IsEmpty)
+            return;
+
+        int ci = FindChunkIndex(start);
+        int written = 0;
+        while (written < destination.Length && ci < _scannedChunks)
+        {
+            string chunk = _cache.GetChunk((long)ci * ChunkCache.ChunkSizeBytes);
+            int localStart = (int)Math.Max(start + written - _chunkCharOffsets[ci], 0);
+            int toCopy = Math.Min(chunk.Length - localStart, destination.Length - written);
+            chunk.AsSpan(localStart, toCopy).CopyTo(destination[written..]);
+            written += toCopy;
+            ci++;
+        }
+    }
+
     /// <inheritdoc />
     public int CountLineFeeds(long start, long length)
     {
@@ -326,6 +359,13 @@ public sealed class MemoryMappedFileSource : ITextSource, IPrecomputedLineFeeds,
 
         _cache?.Dispose();
         _mmf?.Dispose();
+
+        if (DeleteOnDispose)
+        {
+            try { File.Delete(FilePath); }
+            catch (IOException) { /* best effort; the temp directory is cleaned eventually */ }
+            catch (UnauthorizedAccessException) { }
+        }
     }
 
     /// <summary>
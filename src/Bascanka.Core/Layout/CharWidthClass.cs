@@ -0,0 +1,34 @@
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// Width category of a character as laid out in a monospace editor.  The
+/// categories map one-to-one onto the glyph widths the renderer measures
+/// (see <see cref="CharWidthMetrics"/>).
+/// </summary>
+public enum CharWidthClass : byte
+{
+    /// <summary>A single-cell character (ASCII, Latin, Cyrillic, ...).</summary>
+    Narrow = 0,
+
+    /// <summary>A double-cell BMP character (CJK ideographs, kana, Hangul, fullwidth forms).</summary>
+    Wide,
+
+    /// <summary>A double-cell BMP emoji (default emoji presentation or a keycap sequence base).</summary>
+    Emoji,
+
+    /// <summary>A double-cell supplementary-plane character (CJK extensions B–I).</summary>
+    SupplementaryWide,
+
+    /// <summary>A double-cell supplementary-plane emoji (U+1F1E0–U+1FAFF).</summary>
+    SupplementaryEmoji,
+
+    /// <summary>
+    /// A character that does not advance the pen: combining marks, joiners,
+    /// variation selectors, skin-tone modifiers, the trailing half of a
+    /// surrogate pair, or the second regional indicator of a flag.
+    /// </summary>
+    ZeroWidth,
+
+    /// <summary>A horizontal tab; its width depends on the column it starts at.</summary>
+    Tab,
+}
@@ -0,0 +1,34 @@
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// Measured advance widths for each <see cref="CharWidthClass"/>, in layout
+/// units (pixels for the editor surface, cells for headless callers).
+/// </summary>
+/// <param name="Narrow">Width of a narrow cell; tabs expand to runs of this width.</param>
+/// <param name="Wide">Width of a BMP wide (CJK) glyph.</param>
+/// <param name="Emoji">Width of a BMP emoji glyph.</param>
+/// <param name="SupplementaryWide">Width of a supplementary-plane CJK glyph.</param>
+/// <param name="SupplementaryEmoji">Width of a supplementary-plane emoji glyph.</param>
+public readonly record struct CharWidthMetrics(
+    int Narrow, int Wide, int Emoji, int SupplementaryWide, int SupplementaryEmoji)
+{
+    /// <summary>Metrics in monospace cells: narrow = 1, everything wide = 2.</summary>
+    public static CharWidthMetrics Cells { get; } = new(1, 2, 2, 2, 2);
+
+    /// <summary>The widest single-character advance.</summary>
+    public int Max => Math.Max(Narrow, Math.Max(Wide, Math.Max(Emoji, Math.Max(SupplementaryWide, SupplementaryEmoji))));
+
+    /// <summary>
+    /// Returns the advance for <paramref name="widthClass"/>.  Tabs report a
+    /// single narrow cell; callers expanding tab stops handle them separately.
+    /// </summary>
+    public int GetWidth(CharWidthClass widthClass) => widthClass switch
+    {
+        CharWidthClass.Narrow or CharWidthClass.Tab => Narrow,
+        CharWidthClass.Wide => Wide,
+        CharWidthClass.Emoji => Emoji,
+        CharWidthClass.SupplementaryWide => SupplementaryWide,
+        CharWidthClass.SupplementaryEmoji => SupplementaryEmoji,
+        _ => 0,
+    };
+}
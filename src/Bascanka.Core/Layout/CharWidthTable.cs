@@ -0,0 +1,270 @@
+using System.Runtime.CompilerServices;
+
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// Precomputed Unicode width classification for monospace layout.  Every BMP
+/// code unit is classified once into a 64 KB lookup table; context-dependent
+/// cases (surrogate pairs, keycap sequences, regional-indicator flags) are
+/// resolved by <see cref="Classify(ReadOnlySpan{char}, int)"/>.
+/// </summary>
+public static class CharWidthTable
+{
+    private static readonly CharWidthClass[] s_bmpTable = BuildBmpTable();
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Classification
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Classifies a single UTF-16 code unit without looking at its neighbours.
+    /// High surrogates report <see cref="CharWidthClass.SupplementaryWide"/>
+    /// (most supplementary characters are wide); use the span overload when
+    /// the full sequence is available.
+    /// </summary>
+    [MethodImpl(MethodImplOptions.AggressiveInlining)]
+    public static CharWidthClass Classify(char c) => s_bmpTable[c];
+
+    /// <summary>
+    /// Classifies the character at <paramref name="index"/> in
+    /// <paramref name="text"/>, decoding surrogate pairs and recognising
+    /// keycap sequences and regional-indicator flag pairs.
+    /// </summary>
+    public static CharWidthClass Classify(ReadOnlySpan<char> text, int index)
+    {
+        char c = text[index];
+
+        // Low surrogate — already counted with its high surrogate.
+        if (char.IsLowSurrogate(c)) return CharWidthClass.ZeroWidth;
+
+        if (!char.IsHighSurrogate(c))
+        {
+            // Keycap sequence: digit/#/* + (optional FE0F) + U+20E3 → wide emoji.
+            if (IsKeycapBase(c) && HasKeycapSuffix(text, index + 1))
+                return CharWidthClass.Emoji;
+            return s_bmpTable[c];
+        }
+
+        // Surrogate pair → decode full code point.
+        if (index + 1 < text.Length && char.IsLowSurrogate(text[index + 1]))
+        {
+            int cp = char.ConvertToUtf32(c, text[index + 1]);
+
+            // Second Regional Indicator in a flag pair → zero width.
+            if (cp >= 0x1F1E0 && cp <= 0x1F1FF && IsSecondRegionalIndicator(text, index))
+                return CharWidthClass.ZeroWidth;
+
+            return ClassifySupplementary(cp);
+        }
+
+        // Unpaired high surrogate — treat as narrow.
+        return CharWidthClass.Narrow;
+    }
+
+    /// <summary>
+    /// Returns the width of <paramref name="widthClass"/> in monospace cells:
+    /// 0 for zero-width, 2 for any wide or emoji class, 1 otherwise (a tab
+    /// counts as one cell before tab-stop expansion).
+    /// </summary>
+    [MethodImpl(MethodImplOptions.AggressiveInlining)]
+    public static int GetCellWidth(CharWidthClass widthClass) => widthClass switch
+    {
+        CharWidthClass.Narrow or CharWidthClass.Tab => 1,
+        CharWidthClass.ZeroWidth => 0,
+        _ => 2,
+    };
+
+    /// <summary>Cell width of a single code unit (see <see cref="Classify(char)"/>).</summary>
+    public static int GetCellWidth(char c) => GetCellWidth(s_bmpTable[c]);
+
+    /// <summary>Cell width of the character at <paramref name="index"/> in <paramref name="text"/>.</summary>
+    public static int GetCellWidth(ReadOnlySpan<char> text, int index) => GetCellWidth(Classify(text, index));
+
+    /// <summary>
+    /// Returns <see langword="true"/> when every character of
+    /// <paramref name="text"/> is a narrow, context-free character and none
+    /// is a tab — i.e. its layout width is simply <c>Length × narrow width</c>.
+    /// Covers ASCII and the Latin ranges below U+0300; uses the vectorised
+    /// <see cref="MemoryExtensions.IndexOfAnyExceptInRange{T}(ReadOnlySpan{T}, T, T)"/>.
+    /// </summary>
+    public static bool IsNarrowWithoutTabs(ReadOnlySpan<char> text)
+        => text.IndexOfAnyExceptInRange(' ', '\u02FF') < 0;
+
+    /// <summary>
+    /// Returns <see langword="true"/> if <paramref name="index"/> starts a
+    /// keycap emoji sequence (0-9, # or * followed by optional U+FE0F and U+20E3).
+    /// </summary>
+    public static bool IsKeycapSequence(ReadOnlySpan<char> text, int index)
+        => index < text.Length && IsKeycapBase(text[index]) && HasKeycapSuffix(text, index + 1);
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Table construction
+    // ────────────────────────────────────────────────────────────────────
+
+    private static CharWidthClass[] BuildBmpTable()
+    {
+        var table = new CharWidthClass[0x10000];
+        for (int cp = 0; cp < table.Length; cp++)
+            table[cp] = ClassifyBmp((char)cp);
+        return table;
+    }
+
+    private static CharWidthClass ClassifyBmp(char c)
+    {
+        if (c == '\t') return CharWidthClass.Tab;
+
+        // ASCII + Latin-1 Supplement + Latin Extended-A/B.
+        if (c < 0x0300) return CharWidthClass.Narrow;
+
+        // Combining diacritical marks — zero width (accents, Zalgo text, etc.)
+        if (c <= 0x036F) return CharWidthClass.ZeroWidth;                // U+0300–U+036F Combining Diacritical Marks
+        if (c >= 0x0483 && c <= 0x0489) return CharWidthClass.ZeroWidth; // Combining Cyrillic
+
+        // Rest of BMP below CJK/wide ranges.
+        if (c < 0x1100) return CharWidthClass.Narrow;
+
+        if (char.IsLowSurrogate(c)) return CharWidthClass.ZeroWidth;
+
+        // Zero-width characters: ZWJ, variation selectors, etc.
+        if (c == '\u200B' || c == '\u200C' || c == '\u200D' ||  // ZWS, ZWNJ, ZWJ
+            c == '\uFE0E' || c == '\uFE0F' ||                   // variation selectors
+            c == '\u2060' || c == '\uFEFF' ||                    // word joiner, BOM
+            c == '\u20E3')                                       // combining enclosing keycap
+            return CharWidthClass.ZeroWidth;
+
+        // Combining mark ranges above U+1100.
+        if (c >= 0x1AB0 && c <= 0x1AFF) return CharWidthClass.ZeroWidth; // Combining Diacritical Marks Extended
+        if (c >= 0x1DC0 && c <= 0x1DFF) return CharWidthClass.ZeroWidth; // Combining Diacritical Marks Supplement
+        if (c >= 0x20D0 && c <= 0x20FF) return CharWidthClass.ZeroWidth; // Combining Diacritical Marks for Symbols
+        if (c >= 0xFE20 && c <= 0xFE2F) return CharWidthClass.ZeroWidth; // Combining Half Marks
+
+        // BMP characters with default emoji presentation render via the
+        // emoji fallback font at their own advance width.
+        if (IsDefaultEmojiPresentation(c)) return CharWidthClass.Emoji;
+        if (IsBmpEastAsianWide(c)) return CharWidthClass.Wide;
+
+        // High surrogate on its own: assume wide (most supplementary CJK/emoji are).
+        if (char.IsHighSurrogate(c)) return CharWidthClass.SupplementaryWide;
+
+        return CharWidthClass.Narrow;
+    }
+
+    /// <summary>East Asian Fullwidth/Wide BMP ranges (UAX #11 subset).</summary>
+    private static bool IsBmpEastAsianWide(char c) => c switch
+    {
+        >= '\u1100' and <= '\u115F' => true, // Hangul Jamo
+        >= '\u2E80' and <= '\u303E' => true, // CJK Radicals/Kangxi/Ideographic/CJK Symbols
+        >= '\u3041' and <= '\u33BF' => true, // Hiragana/Katakana/Bopomofo/etc.
+        >= '\u3400' and <= '\u4DBF' => true, // CJK Unified Ideographs Extension A
+        >= '\u4E00' and <= '\u9FFF' => true, // CJK Unified Ideographs
+        >= '\uA000' and <= '\uA4CF' => true, // Yi
+        >= '\uAC00' and <= '\uD7AF' => true, // Hangul Syllables
+        >= '\uF900' and <= '\uFAFF' => true, // CJK Compatibility Ideographs
+        >= '\uFE30' and <= '\uFE6F' => true, // CJK Compatibility Forms/Small Form Variants
+        >= '\uFF01' and <= '\uFF60' => true, // Fullwidth forms
+        >= '\uFFE0' and <= '\uFFE6' => true, // Fullwidth signs
+        _ => false,
+    };
+
+    /// <summary>
+    /// Classifies a supplementary-plane code point (U+10000 and above).
+    /// </summary>
+    private static CharWidthClass ClassifySupplementary(int codePoint)
+    {
+        // Skin tone modifiers — zero-width, they modify the preceding emoji.
+        if (codePoint >= 0x1F3FB && codePoint <= 0x1F3FF) return CharWidthClass.ZeroWidth;
+
+        // Emoji ranges in supplementary planes.
+        if (codePoint >= 0x1F1E0 && codePoint <= 0x1F1FF) return CharWidthClass.SupplementaryEmoji; // Regional Indicator Symbols (flags)
+        if (codePoint >= 0x1F300 && codePoint <= 0x1F5FF) return CharWidthClass.SupplementaryEmoji; // Misc Symbols and Pictographs
+        if (codePoint >= 0x1F600 && codePoint <= 0x1F64F) return CharWidthClass.SupplementaryEmoji; // Emoticons
+        if (codePoint >= 0x1F680 && codePoint <= 0x1F6FF) return CharWidthClass.SupplementaryEmoji; // Transport and Map Symbols
+        if (codePoint >= 0x1F900 && codePoint <= 0x1F9FF) return CharWidthClass.SupplementaryEmoji; // Supplemental Symbols and Pictographs
+        if (codePoint >= 0x1FA70 && codePoint <= 0x1FAFF) return CharWidthClass.SupplementaryEmoji; // Symbols and Pictographs Extended-A
+
+        // Supplementary CJK / East Asian wide ranges (UAX #11).
+        if (codePoint >= 0x20000 && codePoint <= 0x2A6DF) return CharWidthClass.SupplementaryWide; // CJK Unified Ideographs Extension B
+        if (codePoint >= 0x2A700 && codePoint <= 0x2B73F) return CharWidthClass.SupplementaryWide; // Extension C
+        if (codePoint >= 0x2B740 && codePoint <= 0x2B81F) return CharWidthClass.SupplementaryWide; // Extension D
+        if (codePoint >= 0x2B820 && codePoint <= 0x2CEAF) return CharWidthClass.SupplementaryWide; // Extension E
+        if (codePoint >= 0x2CEB0 && codePoint <= 0x2EBEF) return CharWidthClass.SupplementaryWide; // Extension F
+        if (codePoint >= 0x2EBF0 && codePoint <= 0x2F7FF) return CharWidthClass.SupplementaryWide; // Extension I
+        if (codePoint >= 0x2F800 && codePoint <= 0x2FA1F) return CharWidthClass.SupplementaryWide; // CJK Compat Ideographs Supplement
+        if (codePoint >= 0x30000 && codePoint <= 0x3134F) return CharWidthClass.SupplementaryWide; // Extension G
+        if (codePoint >= 0x31350 && codePoint <= 0x323AF) return CharWidthClass.SupplementaryWide; // Extension H
+
+        return CharWidthClass.Narrow;
+    }
+
+    /// <summary>
+    /// Returns true if the BMP character has default emoji presentation
+    /// (Emoji_Presentation=Yes in Unicode), meaning it renders as a wide
+    /// emoji glyph even without a trailing U+FE0F variation selector.
+    /// </summary>
+    private static bool IsDefaultEmojiPresentation(char c)
+    {
+        return c switch
+        {
+            '\u231A' or '\u231B' => true,
+            >= '\u23E9' and <= '\u23F3' => true,
+            >= '\u23F8' and <= '\u23FA' => true,
+            >= '\u25FD' and <= '\u25FE' => true,
+            >= '\u2614' and <= '\u2615' => true,
+            >= '\u2648' and <= '\u2653' => true,
+            '\u267F' or '\u2693' or '\u26A1' => true,
+            >= '\u26AA' and <= '\u26AB' => true,
+            >= '\u26BD' and <= '\u26BE' => true,
+            >= '\u26C4' and <= '\u26C5' => true,
+            '\u26CE' or '\u26D4' or '\u26EA' => true,
+            >= '\u26F2' and <= '\u26F3' => true,
+            '\u26F5' or '\u26FA' or '\u26FD' => true,
+            '\u2702' or '\u2705' => true,
+            >= '\u2708' and <= '\u270D' => true,
+            '\u270F' or '\u2712' or '\u2714' or '\u2716' => true,
+            '\u271D' or '\u2721' or '\u2728' => true,
+            >= '\u2733' and <= '\u2734' => true,
+            '\u2744' or '\u2747' or '\u274C' or '\u274E' => true,
+            >= '\u2753' and <= '\u2755' => true,
+            '\u2757' => true,
+            >= '\u2763' and <= '\u2764' => true,
+            >= '\u2795' and <= '\u2797' => true,
+            '\u27A1' or '\u27B0' or '\u27BF' => true,
+            >= '\u2934' and <= '\u2935' => true,
+            >= '\u2B05' and <= '\u2B07' => true,
+            >= '\u2B1B' and <= '\u2B1C' => true,
+            '\u2B50' or '\u2B55' => true,
+            '\u3030' or '\u303D' or '\u3297' or '\u3299' => true,
+            _ => false,
+        };
+    }
+
+    /// <summary>
+    /// Returns true if the Regional Indicator surrogate pair at <paramref name="index"/>
+    /// is the second in a flag pair (e.g. 🇧 in 🇬🇧), by counting consecutive
+    /// preceding Regional Indicators.
+    /// </summary>
+    private static bool IsSecondRegionalIndicator(ReadOnlySpan<char> text, int index)
+    {
+        int riCount = 0;
+        int j = index;
+        while (j >= 2)
+        {
+            j -= 2;
+            if (!char.IsHighSurrogate(text[j]) || !char.IsLowSurrogate(text[j + 1])) break;
+            int prevCp = char.ConvertToUtf32(text[j], text[j + 1]);
+            if (prevCp < 0x1F1E0 || prevCp > 0x1F1FF) break;
+            riCount++;
+        }
+        return riCount % 2 == 1;
+    }
+
+    private static bool IsKeycapBase(char c) =>
+        (c >= '0' && c <= '9') || c == '#' || c == '*';
+
+    private static bool HasKeycapSuffix(ReadOnlySpan<char> text, int i)
+    {
+        if (i >= text.Length) return false;
+        if (text[i] == '\uFE0F') i++;
+        return i < text.Length && text[i] == '\u20E3';
+    }
+}
@@ -0,0 +1,53 @@
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// Shares the strings of short glyph clusters — single characters and
+/// surrogate pairs, by far the common case — between the runs of one
+/// <see cref="GlyphRunCache"/>, so that identical glyphs across runs are
+/// one string.
+/// </summary>
+/// <remarks>
+/// Unlike <see cref="string.Intern"/>, whose strings live as long as the
+/// process, the pool is bounded: it starts over once it holds
+/// <see cref="MaxCount"/> strings, and is dropped with its cache.  Runs
+/// keep the strings they were given.
+/// <para>This class is <b>not</b> thread-safe.</para>
+/// </remarks>
+internal sealed class ClusterTextPool
+{
+    /// <summary>Most strings the pool holds before it starts over.</summary>
+    public const int MaxCount = 4096;
+
+    /// <summary>Longest cluster that is pooled.</summary>
+    public const int MaxLength = 2;
+
+    private readonly Dictionary<long, string> _strings = [];
+
+    /// <summary>Number of pooled strings.</summary>
+    public int Count => _strings.Count;
+
+    /// <summary>
+    /// Returns <c>text[index, index + length)</c>, pooled when it is no
+    /// longer than <see cref="MaxLength"/>.
+    /// </summary>
+    public string Get(string text, int index, int length)
+    {
+        if (length > MaxLength)
+            return text.Substring(index, length);
+
+        // The length and both code units make the key, so "\0" and "\0\0"
+        // stay apart.
+        long key = (long)length << 32 | (uint)text[index] | (length == 2 ? (uint)text[index + 1] << 16 : 0);
+        if (_strings.TryGetValue(key, out string? pooled))
+            return pooled;
+
+        if (_strings.Count >= MaxCount)
+            _strings.Clear();
+        string glyph = text.Substring(index, length);
+        _strings.Add(key, glyph);
+        return glyph;
+    }
+
+    /// <summary>Drops every pooled string.</summary>
+    public void Clear() => _strings.Clear();
+}
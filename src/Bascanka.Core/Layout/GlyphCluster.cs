@@ -0,0 +1,18 @@
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// One positioned render unit inside a <see cref="GlyphRun"/>: a visible
+/// character together with any zero-width marks that follow it (variation
+/// selectors, ZWJ, skin-tone modifiers, combining keycap).
+/// </summary>
+/// <param name="Text">The characters drawn as one unit.</param>
+/// <param name="Offset">Index of the first character within <see cref="GlyphRun.Text"/>.</param>
+/// <param name="X">Left edge of the cluster relative to the start of the run.</param>
+/// <param name="Advance">Horizontal advance of the cluster.</param>
+/// <param name="WidthClass">Classification of the cluster's base character.</param>
+public readonly record struct GlyphCluster(
+    string Text, int Offset, int X, int Advance, CharWidthClass WidthClass)
+{
+    /// <summary>Whether the cluster occupies two cells.</summary>
+    public bool IsWide => CharWidthTable.GetCellWidth(WidthClass) >= 2;
+}
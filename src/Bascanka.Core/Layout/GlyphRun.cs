@@ -0,0 +1,124 @@
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// A shaped run of text: the string to draw, its total advance and, when the
+/// run cannot be drawn as a single batch, the individually positioned
+/// clusters.  Runs are immutable and shared between every occurrence of the
+/// same text, font and style through <see cref="GlyphRunCache"/>.
+/// </summary>
+public sealed class GlyphRun
+{
+    // Rough managed overhead of a run, its string and cluster array headers.
+    private const int BaseBytes = 96;
+    // GlyphCluster struct plus the header of its (usually pooled) string.
+    private const int ClusterBytes = 48;
+
+    private GlyphRun(string text, int width, GlyphCluster[] clusters)
+    {
+        Text = text;
+        Width = width;
+        Clusters = clusters;
+        EstimatedBytes = BaseBytes + text.Length * sizeof(char) + clusters.Length * ClusterBytes;
+    }
+
+    /// <summary>The text of the run.</summary>
+    public string Text { get; }
+
+    /// <summary>Total advance of the run.</summary>
+    public int Width { get; }
+
+    /// <summary>
+    /// Whether every character is a single narrow cell, so the run can be
+    /// drawn with one text call at its origin.
+    /// </summary>
+    public bool IsSimple => Clusters.Length == 0;
+
+    /// <summary>
+    /// Positioned clusters for runs containing wide, emoji or zero-width
+    /// characters; empty for simple runs.
+    /// </summary>
+    public GlyphCluster[] Clusters { get; }
+
+    /// <summary>Approximate managed memory held by the run, in bytes.</summary>
+    public int EstimatedBytes { get; }
+
+    /// <summary>
+    /// Shapes <paramref name="text"/> using <paramref name="metrics"/>.
+    /// Zero-width characters are folded into the preceding cluster; a
+    /// zero-width character at the very start of the run has nothing to
+    /// attach to and is dropped.
+    /// </summary>
+    public static GlyphRun Shape(ReadOnlySpan<char> text, CharWidthMetrics metrics)
+        => Shape(text, metrics, null, null);
+
+    /// <inheritdoc cref="Shape(ReadOnlySpan{char}, CharWidthMetrics)"/>
+    public static GlyphRun Shape(string text, CharWidthMetrics metrics)
+    {
+        ArgumentNullException.ThrowIfNull(text);
+        return Shape(text, metrics, text, null);
+    }
+
+    /// <summary>
+    /// Shapes the run, taking the strings of short clusters from
+    /// <paramref name="pool"/> when one is given.
+    /// </summary>
+    internal static GlyphRun Shape(ReadOnlySpan<char> text, CharWidthMetrics metrics, string? textString,
+        ClusterTextPool? pool)
+    {
+        if (IsSimpleText(text))
+            return new GlyphRun(textString ?? text.ToString(), text.Length * metrics.Narrow, []);
+
+        string owned = textString ?? text.ToString();
+        var clusters = new List<GlyphCluster>(text.Length);
+        int x = 0;
+        for (int i = 0; i < text.Length;)
+        {
+            CharWidthClass cls = CharWidthTable.Classify(text, i);
+            if (CharWidthTable.GetCellWidth(cls) == 0)
+            {
+                i++;
+                continue;
+            }
+
+            int len = IsSurrogatePairAt(text, i) ? 2 : 1;
+            while (i + len < text.Length && CharWidthTable.GetCellWidth(text, i + len) == 0)
+                len += IsSurrogatePairAt(text, i + len) ? 2 : 1;
+
+            int advance = metrics.GetWidth(cls);
+            clusters.Add(new GlyphCluster(ClusterText(owned, i, len, pool), i, x, advance, cls));
+            x += advance;
+            i += len;
+        }
+
+        return new GlyphRun(owned, x, [.. clusters]);
+    }
+
+    /// <summary>
+    /// Returns true when every character of <paramref name="text"/> is one
+    /// narrow cell wide, i.e. the run can be drawn in a single batch.
+    /// </summary>
+    public static bool IsSimpleText(ReadOnlySpan<char> text)
+    {
+        if (CharWidthTable.IsNarrowWithoutTabs(text))
+            return true;
+
+        for (int i = 0; i < text.Length; i++)
+        {
+            if (CharWidthTable.GetCellWidth(text, i) != 1)
+                return false;
+            if (IsSurrogatePairAt(text, i))
+                i++;
+        }
+        return true;
+    }
+
+    private static bool IsSurrogatePairAt(ReadOnlySpan<char> text, int index)
+        => char.IsHighSurrogate(text[index]) && index + 1 < text.Length && char.IsLowSurrogate(text[index + 1]);
+
+    private static string ClusterText(string text, int index, int length, ClusterTextPool? pool)
+    {
+        if (length == text.Length)
+            return text;
+        return pool is not null ? pool.Get(text, index, length) : text.Substring(index, length);
+    }
+}
@@ -0,0 +1,284 @@
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// A memory-bounded LRU cache of <see cref="GlyphRun"/>s keyed by text, font
+/// and style.  Identical tokens and identical lines — timestamps, log levels,
+/// keywords, repeated log lines — resolve to one shared run no matter where
+/// they appear, so scrolling, selection and colour changes never invalidate
+/// anything.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Lookups take a <see cref="ReadOnlySpan{T}"/> so a hit costs a hash and a
+/// compare, with no substring allocation.  The font key is an opaque integer
+/// chosen by the caller (the editor derives one per font and measured widths);
+/// the style key lets bold or italic text shape separately from regular text.
+/// Colour is deliberately not part of the key.
+/// </para>
+/// <para>
+/// Runs longer than <see cref="MaxRunLength"/>, or costing more than an
+/// eighth of the budget, are shaped but not stored, so a single huge line
+/// cannot flush the cache.
+/// </para>
+/// <para>
+/// The strings of single-character and surrogate-pair clusters are shared
+/// between the cache's runs through a bounded pool that lives and dies with
+/// the cache.
+/// </para>
+/// <para>This class is <b>not</b> thread-safe; callers must synchronize
+/// externally if they access it from multiple threads.</para>
+/// </remarks>
+public sealed class GlyphRunCache
+{
+    /// <summary>Default memory budget: 4 MB.</summary>
+    public const long DefaultMaxBytes = 4L * 1024 * 1024;
+
+    /// <summary>Longest run that is stored in the cache.</summary>
+    public const int MaxRunLength = 4096;
+
+    // Per-entry bookkeeping on top of the run itself.
+    private const int EntryOverheadBytes = 64;
+
+    private sealed class Entry(GlyphRun run, int fontKey, int style, int hash)
+    {
+        public readonly GlyphRun Run = run;
+        public readonly int FontKey = fontKey;
+        public readonly int Style = style;
+        public readonly int Hash = hash;
+        public Entry? NextInBucket;
+        public Entry? Prev;
+        public Entry? Next;
+    }
+
+    private readonly ClusterTextPool _clusterTexts = new();
+    private Entry?[] _buckets = new Entry?[256];
+    private Entry? _head; // most recently used
+    private Entry? _tail; // least recently used
+    private long _maxBytes;
+
+    /// <summary>
+    /// Creates a cache bounded to <paramref name="maxBytes"/> of estimated
+    /// managed memory.
+    /// </summary>
+    public GlyphRunCache(long maxBytes = DefaultMaxBytes)
+    {
+        MaxBytes = maxBytes;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Statistics
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>Number of runs currently cached.</summary>
+    public int Count { get; private set; }
+
+    /// <summary>Estimated bytes held by cached runs.</summary>
+    public long Bytes { get; private set; }
+
+    /// <summary>Lookups satisfied from the cache.</summary>
+    public long Hits { get; private set; }
+
+    /// <summary>Lookups that had to shape the run.</summary>
+    public long Misses { get; private set; }
+
+    /// <summary>Runs dropped to stay within <see cref="MaxBytes"/>.</summary>
+    public long Evictions { get; private set; }
+
+    /// <summary>Fraction of lookups that were hits, or 0 before any lookup.</summary>
+    public double HitRatio => Hits + Misses == 0 ? 0 : (double)Hits / (Hits + Misses);
+
+    /// <summary>Resets the hit, miss and eviction counters.</summary>
+    public void ResetCounters()
+    {
+        Hits = 0;
+        Misses = 0;
+        Evictions = 0;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Capacity
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Memory budget in bytes.  Lowering it evicts immediately.
+    /// </summary>
+    public long MaxBytes
+    {
+        get => _maxBytes;
+        set
+        {
+            _maxBytes = Math.Max(1024, value);
+            Evict();
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Lookup
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Returns the cached run for <paramref name="text"/> in the given font
+    /// and style, shaping it with <paramref name="metrics"/> on a miss.
+    /// </summary>
+    public GlyphRun GetOrAdd(ReadOnlySpan<char> text, int fontKey, int style, CharWidthMetrics metrics)
+        => GetOrAdd(text, null, fontKey, style, metrics);
+
+    /// <inheritdoc cref="GetOrAdd(ReadOnlySpan{char}, int, int, CharWidthMetrics)"/>
+    /// <remarks>On a miss the run keeps a reference to <paramref name="text"/> instead of copying it.</remarks>
+    public GlyphRun GetOrAdd(string text, int fontKey, int style, CharWidthMetrics metrics)
+    {
+        ArgumentNullException.ThrowIfNull(text);
+        return GetOrAdd(text, text, fontKey, style, metrics);
+    }
+
+    /// <summary>
+    /// Returns the cached run without shaping, or <c>null</c>.  Does not
+    /// affect the hit and miss counters.
+    /// </summary>
+    public GlyphRun? Peek(ReadOnlySpan<char> text, int fontKey, int style)
+    {
+        int hash = ComputeHash(text, fontKey, style);
+        return Find(text, fontKey, style, hash)?.Run;
+    }
+
+    /// <summary>Removes every cached run.  Counters are kept.</summary>
+    public void Clear()
+    {
+        _clusterTexts.Clear();
+        Array.Clear(_buckets);
+        _head = null;
+        _tail = null;
+        Count = 0;
+        Bytes = 0;
+    }
+
+    /// <summary>Removes every run cached for <paramref name="fontKey"/>.</summary>
+    public void RemoveFont(int fontKey)
+    {
+        for (Entry? e = _head; e is not null;)
+        {
+            Entry? next = e.Next;
+            if (e.FontKey == fontKey)
+                Remove(e);
+            e = next;
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Internals
+    // ────────────────────────────────────────────────────────────────────
+
+    private GlyphRun GetOrAdd(ReadOnlySpan<char> text, string? textString, int fontKey, int style, CharWidthMetrics metrics)
+    {
+        if (text.Length > MaxRunLength)
+        {
+            Misses++;
+            return GlyphRun.Shape(text, metrics, textString, _clusterTexts);
+        }
+
+        int hash = ComputeHash(text, fontKey, style);
+        Entry? entry = Find(text, fontKey, style, hash);
+        if (entry is not null)
+        {
+            Hits++;
+            MoveToFront(entry);
+            return entry.Run;
+        }
+
+        Misses++;
+        GlyphRun run = GlyphRun.Shape(text, metrics, textString, _clusterTexts);
+        if (EntryOverheadBytes + run.EstimatedBytes <= _maxBytes / 8)
+            Add(new Entry(run, fontKey, style, hash));
+        return run;
+    }
+
+    private static int ComputeHash(ReadOnlySpan<char> text, int fontKey, int style)
+        => HashCode.Combine(string.GetHashCode(text), fontKey, style);
+
+    private Entry? Find(ReadOnlySpan<char> text, int fontKey, int style, int hash)
+    {
+        for (Entry? e = _buckets[hash & (_buckets.Length - 1)]; e is not null; e = e.NextInBucket)
+        {
+            if (e.Hash == hash && e.FontKey == fontKey && e.Style == style &&
+                text.SequenceEqual(e.Run.Text))
+                return e;
+        }
+        return null;
+    }
+
+    private void Add(Entry entry)
+    {
+        if (Count >= _buckets.Length)
+            Rehash(_buckets.Length * 2);
+
+        ref Entry? bucket = ref _buckets[entry.Hash & (_buckets.Length - 1)];
+        entry.NextInBucket = bucket;
+        bucket = entry;
+
+        entry.Next = _head;
+        if (_head is not null) _head.Prev = entry;
+        _head = entry;
+        _tail ??= entry;
+
+        Count++;
+        Bytes += Cost(entry);
+        Evict();
+    }
+
+    private void Remove(Entry entry)
+    {
+        ref Entry? link = ref _buckets[entry.Hash & (_buckets.Length - 1)];
+        while (link is not null && link != entry)
+            link = ref link.NextInBucket;
+        if (link is not null)
+            link = entry.NextInBucket;
+
+        if (entry.Prev is not null) entry.Prev.Next = entry.Next;
+        else _head = entry.Next;
+        if (entry.Next is not null) entry.Next.Prev = entry.Prev;
+        else _tail = entry.Prev;
+
+        entry.Prev = null;
+        entry.Next = null;
+        entry.NextInBucket = null;
+        Count--;
+        Bytes -= Cost(entry);
+    }
+
+    private void MoveToFront(Entry entry)
+    {
+        if (entry == _head) return;
+
+        entry.Prev!.Next = entry.Next;
+        if (entry.Next is not null) entry.Next.Prev = entry.Prev;
+        else _tail = entry.Prev;
+
+        entry.Prev = null;
+        entry.Next = _head;
+        _head!.Prev = entry;
+        _head = entry;
+    }
+
+    private void Evict()
+    {
+        while (Bytes > _maxBytes && _tail is not null)
+        {
+            Remove(_tail);
+            Evictions++;
+        }
+    }
+
+    private void Rehash(int size)
+    {
+        var buckets = new Entry?[size];
+        for (Entry? e = _head; e is not null; e = e.Next)
+        {
+            ref Entry? bucket = ref buckets[e.Hash & (size - 1)];
+            e.NextInBucket = bucket;
+            bucket = e;
+        }
+        _buckets = buckets;
+    }
+
+    private static long Cost(Entry entry) => EntryOverheadBytes + entry.Run.EstimatedBytes;
+}
@@ -0,0 +1,62 @@
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// Supplies glyph widths to the <see cref="WrapLayoutEngine"/>.  Widths are
+/// expressed in abstract layout units — the editor surface reports pixels,
+/// headless callers (tests, benchmarks) can report monospace cells.
+/// </summary>
+public interface ITextMeasurer
+{
+    /// <summary>
+    /// Width of a single narrow character cell.  Tab stops expand to
+    /// runs of cells of this width.
+    /// </summary>
+    int CellWidth { get; }
+
+    /// <summary>
+    /// Upper bound for the width of any single character.  A line whose
+    /// length multiplied by this value (or by a full tab stop, if wider) fits
+    /// the wrap width is known to occupy one row without reading its text.
+    /// </summary>
+    int MaxCharWidth { get; }
+
+    /// <summary>Number of cells per tab stop.</summary>
+    int TabSize { get; }
+
+    /// <summary>
+    /// Returns the width of the character at <paramref name="index"/> in
+    /// <paramref name="text"/>, or zero when it does not advance the pen
+    /// (combining marks, the trailing half of a surrogate pair, joiners).
+    /// Never called for tab characters.
+    /// </summary>
+    int MeasureChar(string text, int index);
+}
+
+/// <summary>
+/// Headless <see cref="ITextMeasurer"/> that treats every UTF-16 code unit as
+/// one cell (low surrogates as zero).  Intended for tests and benchmarks
+/// where no font is available.
+/// </summary>
+public sealed class MonospaceTextMeasurer : ITextMeasurer
+{
+    public MonospaceTextMeasurer(int cellWidth = 1, int tabSize = 4)
+    {
+        ArgumentOutOfRangeException.ThrowIfLessThan(cellWidth, 1);
+        ArgumentOutOfRangeException.ThrowIfLessThan(tabSize, 1);
+        CellWidth = cellWidth;
+        TabSize = tabSize;
+    }
+
+    /// <inheritdoc/>
+    public int CellWidth { get; }
+
+    /// <inheritdoc/>
+    public int MaxCharWidth => CellWidth;
+
+    /// <inheritdoc/>
+    public int TabSize { get; }
+
+    /// <inheritdoc/>
+    public int MeasureChar(string text, int index)
+        => char.IsLowSurrogate(text[index]) ? 0 : CellWidth;
+}
@@ -0,0 +1,151 @@
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// Prefix sums of character advances for one line of text, so that
+/// index → x and x → index conversions are O(1) and O(log n) instead of
+/// re-classifying every character from the start of the line.
+/// <para>
+/// Tabs expand to the next tab stop in narrow cells; lines that are entirely
+/// narrow and tab-free (<see cref="CharWidthTable.IsNarrowWithoutTabs"/>)
+/// store no array at all — every position is a multiplication.
+/// </para>
+/// </summary>
+public sealed class LineWidthMap
+{
+    // _x[i] is the x of character i; _x[Length] is the total width.
+    // Null when the line is uniformly narrow.
+    private readonly int[]? _x;
+    private readonly int _narrow;
+
+    private LineWidthMap(string text, CharWidthMetrics metrics, int tabSize, int[]? x)
+    {
+        Text = text;
+        Metrics = metrics;
+        TabSize = tabSize;
+        _x = x;
+        _narrow = metrics.Narrow;
+    }
+
+    /// <summary>The text this map was built for.</summary>
+    public string Text { get; }
+
+    /// <summary>Metrics the map was built with.</summary>
+    public CharWidthMetrics Metrics { get; }
+
+    /// <summary>Tab size the map was built with.</summary>
+    public int TabSize { get; }
+
+    /// <summary>Number of characters in <see cref="Text"/>.</summary>
+    public int Length => Text.Length;
+
+    /// <summary>Whether every character is narrow and there are no tabs.</summary>
+    public bool IsUniformNarrow => _x is null;
+
+    /// <summary>Total advance width of the line.</summary>
+    public int TotalWidth => _x is null ? Text.Length * _narrow : _x[^1];
+
+    /// <summary>
+    /// Builds the map for <paramref name="text"/>.  Cost is a single
+    /// vectorised scan for plain lines and one table lookup per character
+    /// otherwise.
+    /// </summary>
+    public static LineWidthMap Build(string text, CharWidthMetrics metrics, int tabSize)
+    {
+        ArgumentNullException.ThrowIfNull(text);
+        tabSize = Math.Max(1, tabSize);
+
+        if (CharWidthTable.IsNarrowWithoutTabs(text))
+            return new LineWidthMap(text, metrics, tabSize, null);
+
+        var x = new int[text.Length + 1];
+        int px = 0;
+        int col = 0;
+        for (int i = 0; i < text.Length; i++)
+        {
+            x[i] = px;
+            CharWidthClass cls = CharWidthTable.Classify(text, i);
+            if (cls == CharWidthClass.Tab)
+            {
+                int spaces = tabSize - (col % tabSize);
+                px += spaces * metrics.Narrow;
+                col += spaces;
+                continue;
+            }
+            px += metrics.GetWidth(cls);
+            col++;
+        }
+        x[text.Length] = px;
+        return new LineWidthMap(text, metrics, tabSize, x);
+    }
+
+    /// <summary>Returns the x position where character <paramref name="index"/> starts.</summary>
+    public int GetX(int index)
+    {
+        index = Math.Clamp(index, 0, Text.Length);
+        return _x is null ? index * _narrow : _x[index];
+    }
+
+    /// <summary>Returns the advance of character <paramref name="index"/> (0 for zero-width).</summary>
+    public int GetAdvance(int index)
+        => _x is null ? _narrow : _x[index + 1] - _x[index];
+
+    /// <summary>
+    /// Returns the index of the first visible character whose right edge
+    /// lies past <paramref name="x"/>, or <see cref="Length"/> if none does.
+    /// </summary>
+    public int IndexAtOrAfterX(int x)
+    {
+        if (_x is null)
+        {
+            if (_narrow <= 0 || x < 0) return 0;
+            return Math.Min(Text.Length, x / _narrow);
+        }
+
+        // Smallest i with _x[i + 1] > x.
+        int lo = 0, hi = Text.Length;
+        while (lo < hi)
+        {
+            int mid = (lo + hi) >>> 1;
+            if (_x[mid + 1] > x) hi = mid;
+            else lo = mid + 1;
+        }
+        return SkipZeroWidth(lo);
+    }
+
+    /// <summary>
+    /// Returns the caret index nearest to <paramref name="x"/> measured from
+    /// character <paramref name="startIndex"/>: the first visible character
+    /// at or after <paramref name="startIndex"/> whose midpoint lies past it.
+    /// </summary>
+    public int NearestIndex(int startIndex, int x)
+    {
+        startIndex = Math.Clamp(startIndex, 0, Text.Length);
+        if (_x is null)
+        {
+            if (_narrow <= 0) return startIndex;
+            // Midpoint of char i (relative): (i - start) * n + n / 2 > x.
+            long rel = x - _narrow / 2;
+            int offset = rel < 0 ? 0 : (int)Math.Min(Text.Length, rel / _narrow + 1);
+            return Math.Min(Text.Length, startIndex + offset);
+        }
+
+        // f(i) = _x[i] + advance(i) / 2 is non-decreasing in i.
+        int target = _x[startIndex] + x;
+        int lo = startIndex, hi = Text.Length;
+        while (lo < hi)
+        {
+            int mid = (lo + hi) >>> 1;
+            int mid2 = _x[mid] + (_x[mid + 1] - _x[mid]) / 2;
+            if (mid2 > target) hi = mid;
+            else lo = mid + 1;
+        }
+        return SkipZeroWidth(lo);
+    }
+
+    private int SkipZeroWidth(int index)
+    {
+        while (index < Text.Length && _x![index + 1] == _x[index])
+            index++;
+        return index;
+    }
+}
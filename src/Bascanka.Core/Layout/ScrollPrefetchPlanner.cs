@@ -0,0 +1,115 @@
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// Tracks scroll velocity and direction from successive viewport positions
+/// and decides which lines are worth warming ahead of the viewport.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Velocity is an exponential moving average of lines per second, so a
+/// single jump (Go To Line, scrollbar drag to a distant point) does not
+/// look like a sustained flick.  The look-ahead window grows with velocity
+/// — enough lines to cover <see cref="HorizonMilliseconds"/> of scrolling —
+/// between one and <see cref="MaxLookaheadScreens"/> screens.
+/// </para>
+/// <para>
+/// The planner is pure bookkeeping: it does not fetch or lex anything, so
+/// callers decide where and how the prefetch work runs.
+/// </para>
+/// </remarks>
+public sealed class ScrollPrefetchPlanner
+{
+    /// <summary>How far ahead, in time, the look-ahead window should reach.</summary>
+    public const int HorizonMilliseconds = 300;
+
+    /// <summary>Upper bound on the look-ahead window, in screens.</summary>
+    public const int MaxLookaheadScreens = 16;
+
+    // Weight of the newest sample in the velocity average.
+    private const double Smoothing = 0.5;
+
+    // Samples further apart than this start a fresh gesture.
+    private const long GestureTimeoutMilliseconds = 500;
+
+    private long _lastLine = -1;
+    private long _lastTimestamp;
+
+    /// <summary>
+    /// Scroll direction of the current gesture: <c>1</c> towards the end of
+    /// the document, <c>-1</c> towards the start, <c>0</c> when idle.
+    /// </summary>
+    public int Direction { get; private set; }
+
+    /// <summary>Smoothed signed scroll velocity in lines per second.</summary>
+    public double Velocity { get; private set; }
+
+    /// <summary>Forgets the current gesture.</summary>
+    public void Reset()
+    {
+        _lastLine = -1;
+        _lastTimestamp = 0;
+        Direction = 0;
+        Velocity = 0;
+    }
+
+    /// <summary>
+    /// Records the viewport's first visible line at <paramref name="timestampMs"/>
+    /// (e.g. <see cref="Environment.TickCount64"/>).
+    /// </summary>
+    /// <returns>
+    /// <c>true</c> when this sample reverses the direction of the current
+    /// gesture, meaning any work queued for the old direction is wasted.
+    /// </returns>
+    public bool Observe(long firstVisibleLine, long timestampMs)
+    {
+        if (_lastLine < 0 || timestampMs - _lastTimestamp > GestureTimeoutMilliseconds)
+        {
+            bool hadDirection = Direction != 0;
+            _lastLine = firstVisibleLine;
+            _lastTimestamp = timestampMs;
+            Velocity = 0;
+            Direction = 0;
+            return hadDirection;
+        }
+
+        long delta = firstVisibleLine - _lastLine;
+        if (delta == 0) return false;
+
+        long elapsed = Math.Max(1, timestampMs - _lastTimestamp);
+        double sample = delta * 1000.0 / elapsed;
+        int newDirection = Math.Sign(delta);
+        bool reversed = Direction != 0 && newDirection != Direction;
+
+        Velocity = reversed ? sample : Velocity + Smoothing * (sample - Velocity);
+        Direction = newDirection;
+        _lastLine = firstVisibleLine;
+        _lastTimestamp = timestampMs;
+        return reversed;
+    }
+
+    /// <summary>
+    /// Returns the half-open line range <c>[Start, End)</c> to warm next,
+    /// just beyond the viewport in the scroll direction.  When idle the
+    /// screen below the viewport is suggested.
+    /// </summary>
+    public (long Start, long End) GetPrefetchRange(long firstVisibleLine, int visibleLines, long lineCount)
+    {
+        visibleLines = Math.Max(1, visibleLines);
+        long maxLookahead = (long)visibleLines * MaxLookaheadScreens;
+        long lookahead = Math.Clamp((long)(Math.Abs(Velocity) * HorizonMilliseconds / 1000), visibleLines, maxLookahead);
+
+        long start, end;
+        if (Direction < 0)
+        {
+            end = Math.Max(0, firstVisibleLine);
+            start = Math.Max(0, end - lookahead);
+        }
+        else
+        {
+            start = Math.Max(0, firstVisibleLine + visibleLines);
+            end = start + lookahead;
+        }
+
+        return (Math.Min(start, lineCount), Math.Min(end, lineCount));
+    }
+}
@@ -0,0 +1,508 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Layout;
+
+/// <summary>
+/// UI-independent word-wrap layout.  Caches the number of visual rows each
+/// document line occupies and keeps a Fenwick (binary indexed) tree of those
+/// counts so that visual-row ↔ document-line mapping is O(log n).
+/// <para>
+/// The owner forwards each <see cref="PieceTable.TextChanged"/> to
+/// <see cref="ApplyTextChange"/>: an edit only marks the touched lines for
+/// re-measurement, and inserted or removed lines shift the cached counts
+/// instead of discarding them.  The engine does not subscribe itself, so
+/// the owner decides when the layout catches up with an edit.  Widths come
+/// from a pluggable <see cref="ITextMeasurer"/>.
+/// </para>
+/// <para>
+/// Not thread-safe; intended to be driven from the UI thread that owns
+/// the document.
+/// </para>
+/// </summary>
+public sealed class WrapLayoutEngine
+{
+    /// <summary>
+    /// Lines longer than this are never materialised for measuring; their
+    /// row count is estimated from <see cref="ITextMeasurer.CellWidth"/>.
+    /// </summary>
+    public const long UltraLongLineThreshold = 1_000_000;
+
+    private readonly ITextMeasurer _measurer;
+    private PieceTable? _document;
+    private int _wrapWidth;
+    private Func<long, bool>? _isLineVisible;
+
+    // Per-line row counts; 0 means "not measured yet".
+    private int[] _rows = [];
+    // Per-line hidden flags (folded lines); null when every line is visible.
+    private bool[]? _hidden;
+    // Fenwick tree over visible row counts, 1-based, length _rows.Length + 1.
+    private long[] _tree = [0];
+    private int _lineCount;
+
+    private bool _needsReset = true;
+    private bool _visibilityValid;
+    // Fenwick nodes [1, _treeValidCount] are up to date.  Nodes at or below
+    // an edited line only cover lines before it, so a structural edit only
+    // invalidates the suffix of the tree.
+    private int _treeValidCount;
+
+    // Lines in [_dirtyStart, _dirtyEnd) may contain unmeasured entries.
+    private int _dirtyStart = int.MaxValue;
+    private int _dirtyEnd;
+
+    public WrapLayoutEngine(ITextMeasurer measurer)
+    {
+        ArgumentNullException.ThrowIfNull(measurer);
+        _measurer = measurer;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Configuration
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// The document to lay out.  Edits to it must be reported through
+    /// <see cref="ApplyTextChange"/>.
+    /// </summary>
+    public PieceTable? Document
+    {
+        get => _document;
+        set
+        {
+            if (ReferenceEquals(_document, value)) return;
+            _document = value;
+            InvalidateMeasurements();
+        }
+    }
+
+    /// <summary>
+    /// Available width of a visual row in measurer units.  Changing it
+    /// re-measures every line on the next query.
+    /// </summary>
+    public int WrapWidth
+    {
+        get => _wrapWidth;
+        set
+        {
+            if (_wrapWidth == value) return;
+            _wrapWidth = value;
+            InvalidateMeasurements();
+        }
+    }
+
+    /// <summary>
+    /// Optional visibility predicate (e.g. folding).  Hidden lines keep their
+    /// cached row count but contribute no rows to the layout.
+    /// </summary>
+    public Func<long, bool>? IsLineVisible
+    {
+        get => _isLineVisible;
+        set
+        {
+            _isLineVisible = value;
+            InvalidateVisibility();
+        }
+    }
+
+    /// <summary>
+    /// Discards every cached row count.  Call when glyph metrics change
+    /// (font, zoom, tab size).
+    /// </summary>
+    public void InvalidateMeasurements()
+    {
+        _needsReset = true;
+    }
+
+    /// <summary>
+    /// Re-evaluates <see cref="IsLineVisible"/> for every line on the next
+    /// query without re-measuring any text.  Call after folds change.
+    /// </summary>
+    public void InvalidateVisibility()
+    {
+        _visibilityValid = false;
+        _treeValidCount = 0;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Queries
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>Total number of visual rows across all visible lines (at least 1).</summary>
+    public long TotalRows
+    {
+        get
+        {
+            EnsureLayout();
+            return Math.Max(1, Prefix(_lineCount));
+        }
+    }
+
+    /// <summary>
+    /// Returns the number of visual rows <paramref name="line"/> occupies,
+    /// measuring only that line if it is not cached yet.
+    /// </summary>
+    public int GetRowCount(long line)
+    {
+        if (_needsReset) Reset();
+        if (line < 0 || line >= _lineCount) return 1;
+
+        int i = (int)line;
+        if (_rows[i] == 0)
+        {
+            _rows[i] = Measure(i);
+            if (i < _treeValidCount && !IsHidden(i))
+                Add(i, _rows[i]);
+        }
+        return _rows[i];
+    }
+
+    /// <summary>
+    /// Maps a global visual row to the document line containing it and the
+    /// row offset within that line.  Rows past the end map to the last row
+    /// of the last visible line.
+    /// </summary>
+    public (long Line, int RowOffset) RowToLine(long row)
+    {
+        EnsureLayout();
+        if (_lineCount == 0) return (0, 0);
+
+        if (row < 0) row = 0;
+        if (row >= Prefix(_lineCount))
+        {
+            int last = _lineCount - 1;
+            while (last > 0 && IsHidden(last))
+                last--;
+            return (last, Math.Max(0, _rows[last] - 1));
+        }
+
+        // Fenwick lower bound: the first line whose cumulative rows exceed `row`.
+        int pos = 0;
+        long remaining = row;
+        for (int step = HighestPowerOfTwo(_lineCount); step > 0; step >>= 1)
+        {
+            int next = pos + step;
+            if (next <= _lineCount && _tree[next] <= remaining)
+            {
+                pos = next;
+                remaining -= _tree[next];
+            }
+        }
+        return (pos, (int)remaining);
+    }
+
+    /// <summary>
+    /// Maps a document line and a row offset within it to a global visual
+    /// row.  The offset is clamped to the line's row count; a hidden line
+    /// maps to the row of the next visible line.
+    /// </summary>
+    public long LineToRow(long line, int rowOffset = 0)
+    {
+        EnsureLayout();
+        if (line <= 0 && _lineCount == 0) return 0;
+        if (line >= _lineCount) return Prefix(_lineCount);
+        if (line < 0) line = 0;
+
+        int i = (int)line;
+        long start = Prefix(i);
+        if (IsHidden(i)) return start;
+        return start + Math.Clamp(rowOffset, 0, Math.Max(0, _rows[i] - 1));
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Measuring
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Counts the visual rows <paramref name="text"/> needs at
+    /// <paramref name="wrapWidth"/>, expanding tabs to cell runs.  A row
+    /// breaks before the first character that would overflow it.
+    /// </summary>
+    public static int CountWrapRows(string text, ITextMeasurer measurer, int wrapWidth)
+    {
+        ArgumentNullException.ThrowIfNull(text);
+        ArgumentNullException.ThrowIfNull(measurer);
+        if (text.Length == 0 || wrapWidth <= 0) return 1;
+
+        int tabSize = Math.Max(1, measurer.TabSize);
+        int cell = measurer.CellWidth;
+        int rows = 1;
+        int width = 0;
+        int col = 0;
+
+        for (int i = 0; i < text.Length; i++)
+        {
+            if (text[i] == '\t')
+            {
+                int spaces = tabSize - (col % tabSize);
+                col += spaces;
+                for (int s = 0; s < spaces; s++)
+                    Advance(ref rows, ref width, cell, wrapWidth);
+                continue;
+            }
+
+            col++;
+            int w = measurer.MeasureChar(text, i);
+            if (w > 0)
+                Advance(ref rows, ref width, w, wrapWidth);
+        }
+        return rows;
+    }
+
+    private static void Advance(ref int rows, ref int width, int charWidth, int wrapWidth)
+    {
+        if (width + charWidth > wrapWidth)
+        {
+            rows++;
+            width = charWidth;
+        }
+        else
+        {
+            width += charWidth;
+        }
+    }
+
+    private int Measure(int line)
+    {
+        if (_document is null || _wrapWidth <= 0) return 1;
+
+        // Fast path: even if every char uses the widest glyph (or is a tab
+        // expanding to a full tab stop), it still fits.
+        long len = _document.GetLineLength(line);
+        long widestChar = Math.Max(_measurer.MaxCharWidth, (long)_measurer.CellWidth * _measurer.TabSize);
+        if (len * widestChar <= _wrapWidth)
+            return 1;
+
+        // Ultra-long line fast path: avoid materializing the full line text.
+        if (len > UltraLongLineThreshold)
+        {
+            long cols = Math.Max(1, _wrapWidth / Math.Max(1, _measurer.CellWidth));
+            long rowsFast = (len + cols - 1) / cols;
+            return (int)Math.Clamp(rowsFast, 1, int.MaxValue);
+        }
+
+        return CountWrapRows(_document.GetLine(line), _measurer, _wrapWidth);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Edit tracking
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Updates the cached layout for an edit to <see cref="Document"/>.  Call
+    /// once per <see cref="PieceTable.TextChanged"/>, before anything queries
+    /// the layout for the edited document.
+    /// </summary>
+    public void ApplyTextChange(TextChangedEventArgs e)
+    {
+        ArgumentNullException.ThrowIfNull(e);
+
+        if (_needsReset || _document is null) return;
+        if (_lineCount == 0)
+        {
+            _needsReset = true;
+            return;
+        }
+
+        long newLineCount = _document.LineCount;
+        if (newLineCount > Array.MaxLength - 1)
+        {
+            _needsReset = true;
+            return;
+        }
+
+        long changeLine = 0;
+        if (e.Offset > 0 && e.Offset <= _document.Length)
+            (changeLine, _) = _document.OffsetToLineColumn(e.Offset);
+
+        // The changed range now spans 1 + (line feeds in the new text)
+        // lines; the line-count delta tells how many it spanned before.
+        // This holds for inserts, deletes and bulk replacements that do
+        // both at once.
+        int delta = (int)(newLineCount - _lineCount);
+        int newSpan = 1 + (e.NewLength > 0 ? _document.CountLineFeedsInRange(e.Offset, e.NewLength) : 0);
+        int oldSpan = newSpan - delta;
+        if (oldSpan < 1)
+        {
+            _needsReset = true;
+            return;
+        }
+        int line = (int)Math.Min(changeLine, _lineCount - 1);
+        Splice(line, oldSpan, newSpan);
+        if (_lineCount != newLineCount)
+            _needsReset = true;
+    }
+
+    /// <summary>
+    /// Replaces <paramref name="oldSpan"/> cached lines at <paramref name="line"/>
+    /// with <paramref name="newSpan"/> unmeasured ones.
+    /// </summary>
+    private void Splice(int line, int oldSpan, int newSpan)
+    {
+        oldSpan = Math.Min(oldSpan, _lineCount - line);
+        int delta = newSpan - oldSpan;
+
+        if (delta == 0)
+        {
+            for (int i = line; i < line + newSpan; i++)
+            {
+                if (i < _treeValidCount && _rows[i] != 0 && !IsHidden(i))
+                    Add(i, -_rows[i]);
+                _rows[i] = 0;
+            }
+        }
+        else
+        {
+            EnsureCapacity(_lineCount + delta);
+            int tail = _lineCount - line - oldSpan;
+            Array.Copy(_rows, line + oldSpan, _rows, line + newSpan, tail);
+            Array.Clear(_rows, line, newSpan);
+            if (delta < 0)
+                Array.Clear(_rows, _lineCount + delta, -delta);
+
+            // Fold regions are line-based, so let the visibility predicate
+            // decide again rather than shifting hidden flags.
+            if (_hidden is not null)
+            {
+                _hidden = null;
+                _visibilityValid = false;
+            }
+            _lineCount += delta;
+            _treeValidCount = Math.Min(_treeValidCount, line);
+
+            // Shift the pending dirty range along with the lines behind the edit.
+            if (_dirtyEnd > line + oldSpan)
+                _dirtyEnd += delta;
+            if (_dirtyStart > line + oldSpan && _dirtyStart != int.MaxValue)
+                _dirtyStart += delta;
+        }
+
+        _dirtyStart = Math.Min(_dirtyStart, line);
+        _dirtyEnd = Math.Max(_dirtyEnd, line + newSpan);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Layout maintenance
+    // ────────────────────────────────────────────────────────────────────
+
+    private void Reset()
+    {
+        _needsReset = false;
+        long count = _document?.LineCount ?? 0;
+        if (count > Array.MaxLength - 1)
+            throw new InvalidOperationException("The document has too many lines for wrap layout.");
+
+        _lineCount = (int)count;
+        _rows = new int[_lineCount];
+        _tree = new long[_lineCount + 1];
+        _hidden = null;
+        _visibilityValid = false;
+        _treeValidCount = 0;
+        _dirtyStart = 0;
+        _dirtyEnd = _lineCount;
+    }
+
+    private void EnsureLayout()
+    {
+        if (_needsReset) Reset();
+
+        if (!_visibilityValid)
+            RecomputeVisibility();
+
+        if (_dirtyStart < _dirtyEnd)
+        {
+            int end = Math.Min(_dirtyEnd, _lineCount);
+            for (int i = _dirtyStart; i < end; i++)
+            {
+                if (_rows[i] != 0) continue;
+                _rows[i] = Measure(i);
+                if (i < _treeValidCount && !IsHidden(i))
+                    Add(i, _rows[i]);
+            }
+        }
+        _dirtyStart = int.MaxValue;
+        _dirtyEnd = 0;
+
+        if (_treeValidCount < _lineCount)
+            BuildTree(_treeValidCount);
+    }
+
+    private void RecomputeVisibility()
+    {
+        _visibilityValid = true;
+        _treeValidCount = 0;
+        _hidden = null;
+        if (_isLineVisible is null) return;
+
+        for (int i = 0; i < _lineCount; i++)
+        {
+            if (_isLineVisible(i)) continue;
+            _hidden ??= new bool[_rows.Length];
+            _hidden[i] = true;
+        }
+    }
+
+    private bool IsHidden(int line) => _hidden is not null && _hidden[line];
+
+    private void EnsureCapacity(int lineCount)
+    {
+        if (lineCount <= _rows.Length) return;
+
+        int capacity = (int)Math.Min(Array.MaxLength - 1, Math.Max(lineCount, (long)_rows.Length * 2));
+        Array.Resize(ref _rows, capacity);
+        if (_hidden is not null)
+            Array.Resize(ref _hidden, capacity);
+        Array.Resize(ref _tree, capacity + 1);
+    }
+
+    /// <summary>
+    /// Rebuilds Fenwick nodes (<paramref name="validCount"/>, n] from the row
+    /// counts in O(n − validCount), reusing the still-valid prefix nodes.
+    /// </summary>
+    private void BuildTree(int validCount)
+    {
+        int from = validCount + 1;
+        for (int i = from; i <= _lineCount; i++)
+            _tree[i] = IsHidden(i - 1) ? 0 : _rows[i - 1];
+
+        // Valid nodes whose parent lies in the rebuilt suffix are exactly the
+        // nodes on the prefix-sum path of validCount.
+        for (int j = validCount; j > 0; j -= j & -j)
+        {
+            int parent = j + (j & -j);
+            if (parent <= _lineCount)
+                _tree[parent] += _tree[j];
+        }
+
+        for (int i = from; i <= _lineCount; i++)
+        {
+            int parent = i + (i & -i);
+            if (parent <= _lineCount)
+                _tree[parent] += _tree[i];
+        }
+        _treeValidCount = _lineCount;
+    }
+
+    private void Add(int line, long delta)
+    {
+        for (int i = line + 1; i <= _lineCount; i += i & -i)
+            _tree[i] += delta;
+    }
+
+    /// <summary>Sum of visible row counts of lines [0, <paramref name="count"/>).</summary>
+    private long Prefix(int count)
+    {
+        long sum = 0;
+        for (int i = count; i > 0; i -= i & -i)
+            sum += _tree[i];
+        return sum;
+    }
+
+    private static int HighestPowerOfTwo(int n)
+    {
+        int p = 1;
+        while (p <= n >> 1)
+            p <<= 1;
+        return p;
+    }
+}
@@ -0,0 +1,390 @@
+using System.Buffers;
+using System.Text;
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Macros;
+
+/// <summary>
+/// A writable view over a read-only text snapshot used for headless macro
+/// playback.  The snapshot is never modified; edits are kept as a sorted
+/// list of pending replacements in snapshot coordinates and read through
+/// when the view is queried.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Macros walk through a document, so edits cluster around the caret.  A
+/// finger (the index of the edit nearest the last access plus the length
+/// delta of every edit before it) makes locating a position O(1) for
+/// nearby accesses, and an edit that touches or overlaps a pending one is
+/// folded into it rather than added, so typing a word is one entry.
+/// </para>
+/// <para>
+/// <see cref="ToEdits"/> returns the pending replacements in the form
+/// <see cref="PieceTable.CreateEditedPieces"/> expects, which is how a
+/// whole playback becomes one bulk update.
+/// </para>
+/// <para>This class is <b>not</b> thread-safe; callers must synchronize
+/// externally if they access it from multiple threads.</para>
+/// </remarks>
+internal sealed class MacroEditBuffer
+{
+    // Line scans start small (most lines are short) and double up to the
+    // maximum, so a caret move reads little more than the lines it crosses.
+    private const int MinScanChunkSize = 128;
+    private const int ScanChunkSize = 4096;
+    private const int SearchChunkSize = 64 * 1024;
+
+    private readonly PieceTable? _table;
+    private readonly string? _text;
+    private readonly long _snapshotLength;
+    private readonly List<PendingEdit> _edits = [];
+    private long _delta;
+
+    // Finger: _edits[_finger] is the first edit that ends at or after the
+    // last sought position; _fingerDelta is the delta of all edits before it.
+    private int _finger;
+    private long _fingerDelta;
+
+    /// <summary>Creates a view over a piece table that must not change while the view is in use.</summary>
+    public MacroEditBuffer(PieceTable snapshot)
+    {
+        _table = snapshot ?? throw new ArgumentNullException(nameof(snapshot));
+        _snapshotLength = snapshot.Length;
+    }
+
+    /// <summary>Creates a view over a string.</summary>
+    public MacroEditBuffer(string snapshot)
+    {
+        _text = snapshot ?? throw new ArgumentNullException(nameof(snapshot));
+        _snapshotLength = snapshot.Length;
+    }
+
+    /// <summary>Length of the text with all pending edits applied.</summary>
+    public long Length => _snapshotLength + _delta;
+
+    /// <summary>Number of pending replacements.</summary>
+    public int EditCount => _edits.Count;
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Editing
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Replaces <paramref name="length"/> characters at
+    /// <paramref name="offset"/> (in current coordinates) with
+    /// <paramref name="text"/>.
+    /// </summary>
+    public void Replace(long offset, long length, string text)
+    {
+        if (offset < 0 || length < 0 || offset + length > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+        if (length == 0 && text.Length == 0)
+            return;
+
+        long end = offset + length;
+        Seek(offset);
+        int first = _finger;
+        long deltaBefore = _fingerDelta;
+
+        // Every pending edit overlapping or touching [offset, end) is folded
+        // into one.  Seek guarantees earlier edits end before offset.
+        int last = first;
+        long deltaAfter = deltaBefore;
+        while (last < _edits.Count && _edits[last].Start + deltaAfter <= end)
+        {
+            deltaAfter += _edits[last].Delta;
+            last++;
+        }
+
+        if (last == first)
+        {
+            _edits.Insert(first, new PendingEdit(offset - deltaBefore, length, new StringBuilder(text)));
+        }
+        else
+        {
+            PendingEdit head = _edits[first];
+            PendingEdit tail = _edits[last - 1];
+            long headStart = head.Start + deltaBefore;
+            long tailEnd = tail.Start + tail.Length + deltaAfter;
+
+            if (last == first + 1 && offset >= headStart && end <= tailEnd)
+            {
+                // Entirely inside one pending edit: patch its text in place.
+                int at = (int)(offset - headStart);
+                head.Text.Remove(at, (int)length).Insert(at, text);
+            }
+            else
+            {
+                long mergedStart = Math.Min(offset, headStart);
+                long mergedEnd = Math.Max(end, tailEnd);
+
+                var merged = new StringBuilder((int)(offset - mergedStart) + text.Length + (int)(mergedEnd - end));
+                AppendRange(merged, mergedStart, offset - mergedStart);
+                merged.Append(text);
+                AppendRange(merged, end, mergedEnd - end);
+
+                long snapshotStart = Math.Min(head.Start, offset - deltaBefore);
+                long snapshotEnd = end > tailEnd ? end - deltaAfter : tail.Start + tail.Length;
+
+                _edits.RemoveRange(first + 1, last - first - 1);
+                _edits[first] = new PendingEdit(snapshotStart, snapshotEnd - snapshotStart, merged);
+            }
+        }
+
+        // Drop edits that cancelled out (e.g. typed then backspaced).
+        if (_edits[first].Length == 0 && _edits[first].Text.Length == 0)
+            _edits.RemoveAt(first);
+
+        // Reading the merged range may have moved the finger; edits before
+        // `first` are untouched, so this pair is still consistent.
+        _finger = first;
+        _fingerDelta = deltaBefore;
+        _delta += text.Length - length;
+    }
+
+    /// <summary>
+    /// Returns the pending replacements in snapshot coordinates, sorted and
+    /// non-overlapping.
+    /// </summary>
+    public List<TextEdit> ToEdits()
+    {
+        var result = new List<TextEdit>(_edits.Count);
+        foreach (PendingEdit e in _edits)
+            result.Add(new TextEdit(e.Start, e.Length, e.Text.ToString()));
+        return result;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Reading
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Copies <c>destination.Length</c> characters starting at
+    /// <paramref name="offset"/> (in current coordinates).
+    /// </summary>
+    public void CopyTo(long offset, Span<char> destination)
+    {
+        if (offset < 0 || offset + destination.Length > Length)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+        if (destination.IsEmpty)
+            return;
+
+        Seek(offset);
+        int i = _finger;
+        long delta = _fingerDelta;
+        long position = offset;
+
+        while (!destination.IsEmpty)
+        {
+            if (i < _edits.Count)
+            {
+                PendingEdit e = _edits[i];
+                long start = e.Start + delta;
+                if (position >= start)
+                {
+                    long inEdit = position - start;
+                    if (inEdit < e.Text.Length)
+                    {
+                        int take = (int)Math.Min(e.Text.Length - inEdit, destination.Length);
+                        e.Text.CopyTo((int)inEdit, destination[..take], take);
+                        destination = destination[take..];
+                        position += take;
+                    }
+                    else
+                    {
+                        delta += e.Delta;
+                        i++;
+                    }
+                    continue;
+                }
+
+                int gap = (int)Math.Min(start - position, destination.Length);
+                ReadSnapshot(position - delta, destination[..gap]);
+                destination = destination[gap..];
+                position += gap;
+            }
+            else
+            {
+                ReadSnapshot(position - delta, destination);
+                return;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Returns the offset of the first <c>'\n'</c> at or after
+    /// <paramref name="offset"/>, or -1.
+    /// </summary>
+    public long IndexOfLineFeed(long offset)
+    {
+        char[] buffer = ArrayPool<char>.Shared.Rent(ScanChunkSize);
+        try
+        {
+            long length = Length;
+            int chunk = MinScanChunkSize;
+            while (offset < length)
+            {
+                int take = (int)Math.Min(chunk, length - offset);
+                chunk = Math.Min(chunk * 2, ScanChunkSize);
+                CopyTo(offset, buffer.AsSpan(0, take));
+                int idx = buffer.AsSpan(0, take).IndexOf('\n');
+                if (idx >= 0)
+                    return offset + idx;
+                offset += take;
+            }
+            return -1;
+        }
+        finally
+        {
+            ArrayPool<char>.Shared.Return(buffer);
+        }
+    }
+
+    /// <summary>
+    /// Returns the offset of the last <c>'\n'</c> before
+    /// <paramref name="offset"/>, or -1.
+    /// </summary>
+    public long LastIndexOfLineFeed(long offset)
+    {
+        char[] buffer = ArrayPool<char>.Shared.Rent(ScanChunkSize);
+        try
+        {
+            int chunk = MinScanChunkSize;
+            while (offset > 0)
+            {
+                int take = (int)Math.Min(chunk, offset);
+                chunk = Math.Min(chunk * 2, ScanChunkSize);
+                offset -= take;
+                CopyTo(offset, buffer.AsSpan(0, take));
+                int idx = buffer.AsSpan(0, take).LastIndexOf('\n');
+                if (idx >= 0)
+                    return offset + idx;
+            }
+            return -1;
+        }
+        finally
+        {
+            ArrayPool<char>.Shared.Return(buffer);
+        }
+    }
+
+    /// <summary>
+    /// Returns the offset of the first ordinal occurrence of
+    /// <paramref name="value"/> at or after <paramref name="offset"/>, or -1.
+    /// Only the text from <paramref name="offset"/> up to the match is read,
+    /// in fixed-size windows.
+    /// </summary>
+    public long IndexOf(string value, long offset)
+    {
+        if (value.Length == 0)
+            return offset;
+
+        // Windows start small, since a macro's next match is usually close,
+        // and grow to the full size for long searches.
+        int maxChunk = Math.Max(SearchChunkSize, value.Length * 2);
+        int chunk = Math.Max(MinScanChunkSize * 2, value.Length * 2);
+        char[] buffer = ArrayPool<char>.Shared.Rent(maxChunk);
+        try
+        {
+            long length = Length;
+            while (length - offset >= value.Length)
+            {
+                int take = (int)Math.Min(chunk, length - offset);
+                chunk = Math.Min(chunk * 2, maxChunk);
+                CopyTo(offset, buffer.AsSpan(0, take));
+                int idx = new ReadOnlySpan<char>(buffer, 0, take).IndexOf(value.AsSpan(), StringComparison.Ordinal);
+                if (idx >= 0)
+                    return offset + idx;
+                if (offset + take >= length)
+                    break;
+
+                // Overlap windows so a match straddling the boundary is seen.
+                offset += take - value.Length + 1;
+            }
+            return -1;
+        }
+        finally
+        {
+            ArrayPool<char>.Shared.Return(buffer);
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Internals
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Moves the finger to the first edit whose current end is at or after
+    /// <paramref name="offset"/>.
+    /// </summary>
+    private void Seek(long offset)
+    {
+        if (offset == 0)
+        {
+            _finger = 0;
+            _fingerDelta = 0;
+        }
+
+        while (_finger > 0)
+        {
+            PendingEdit previous = _edits[_finger - 1];
+            long previousDelta = _fingerDelta - previous.Delta;
+            if (previous.Start + previousDelta + previous.Text.Length < offset)
+                break;
+            _finger--;
+            _fingerDelta = previousDelta;
+        }
+
+        while (_finger < _edits.Count)
+        {
+            PendingEdit e = _edits[_finger];
+            if (e.Start + _fingerDelta + e.Text.Length >= offset)
+                break;
+            _fingerDelta += e.Delta;
+            _finger++;
+        }
+    }
+
+    private void AppendRange(StringBuilder target, long offset, long length)
+    {
+        if (length <= 0) return;
+        char[] buffer = ArrayPool<char>.Shared.Rent((int)Math.Min(length, SearchChunkSize));
+        try
+        {
+            while (length > 0)
+            {
+                int take = (int)Math.Min(length, buffer.Length);
+                CopyTo(offset, buffer.AsSpan(0, take));
+                target.Append(buffer, 0, take);
+                offset += take;
+                length -= take;
+            }
+        }
+        finally
+        {
+            ArrayPool<char>.Shared.Return(buffer);
+        }
+    }
+
+    private void ReadSnapshot(long offset, Span<char> destination)
+    {
+        if (_table is not null)
+            _table.CopyTo(offset, destination);
+        else
+            _text.AsSpan((int)offset, destination.Length).CopyTo(destination);
+    }
+
+    /// <summary>
+    /// A pending replacement of <see cref="Length"/> snapshot characters at
+    /// <see cref="Start"/> with <see cref="Text"/>.
+    /// </summary>
+    private sealed class PendingEdit(long start, long length, StringBuilder text)
+    {
+        public long Start { get; } = start;
+        public long Length { get; } = length;
+        public StringBuilder Text { get; } = text;
+
+        /// <summary>Change in document length this edit causes.</summary>
+        public long Delta => Text.Length - Length;
+    }
+}
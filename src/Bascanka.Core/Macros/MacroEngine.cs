@@ -0,0 +1,470 @@
+using System.Runtime.ExceptionServices;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Search;
+
+namespace Bascanka.Core.Macros;
+
+/// <summary>
+/// Executes a compiled macro headlessly against a snapshot of a document
+/// and returns every change it made as one batch of <see cref="TextEdit"/>s.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The engine never writes to the document it reads.  Edits go to a
+/// <see cref="MacroEditBuffer"/> overlay, movement and search read only the
+/// text around the caret, and nothing is reported per operation — progress
+/// is a percentage raised when it changes.  The caller commits the result
+/// with a single <see cref="Commands.BulkEditCommand"/>, so a playback of any
+/// length is one document change and one undo step.
+/// </para>
+/// <para>
+/// Operations are folded when the engine is built: runs of inserts are
+/// joined, same-direction moves and repeated deletes are summed, and a
+/// <see cref="MacroOpKind.MoveTo"/> discards the moves before it.
+/// </para>
+/// <para>Instances are immutable and may be run concurrently against
+/// different snapshots.</para>
+/// </remarks>
+public sealed class MacroEngine
+{
+    // Line mode reads the document in windows of about this many characters
+    // and hands lines to workers in batches of LineBatchSize.
+    private const int LineWindowSize = 1024 * 1024;
+    private const int LineBatchSize = 256;
+
+    private readonly MacroOp[] _ops;
+
+    /// <summary>Compiles a sequence of operations.</summary>
+    public MacroEngine(IEnumerable<MacroOp> operations)
+    {
+        ArgumentNullException.ThrowIfNull(operations);
+        _ops = Fold(operations);
+    }
+
+    /// <summary>The operations after folding.</summary>
+    public IReadOnlyList<MacroOp> Operations => _ops;
+
+    /// <summary>
+    /// Whether the macro changes text (as opposed to only moving the caret).
+    /// </summary>
+    public bool HasEdits => Array.Exists(_ops, op => op.Kind is MacroOpKind.Insert or
+        MacroOpKind.Delete or MacroOpKind.Backspace or MacroOpKind.Replace);
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Running
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Plays the macro <paramref name="times"/> times starting at
+    /// <paramref name="caret"/>.
+    /// </summary>
+    /// <param name="snapshot">
+    /// The document to read.  It is not modified and must not be modified
+    /// by anyone else until the run completes.
+    /// </param>
+    /// <param name="caret">Starting caret offset.</param>
+    /// <param name="times">Number of repetitions (at least 1).</param>
+    /// <param name="progress">Receives the completed percentage when it changes.</param>
+    /// <param name="cancellationToken">Cancels the run; no edits are returned.</param>
+    /// <exception cref="OperationCanceledException">The run was cancelled.</exception>
+    public MacroRunResult Run(PieceTable snapshot, long caret, int times,
+        IProgress<int>? progress = null, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(snapshot);
+        ArgumentOutOfRangeException.ThrowIfLessThan(times, 1);
+
+        var buffer = new MacroEditBuffer(snapshot);
+        caret = Math.Clamp(caret, 0, buffer.Length);
+        int lastPercent = -1;
+        int iterations = 0;
+
+        while (iterations < times && _ops.Length > 0)
+        {
+            cancellationToken.ThrowIfCancellationRequested();
+            caret = Execute(buffer, caret, out _);
+            iterations++;
+            Report(progress, (int)(iterations * 100L / times), ref lastPercent);
+        }
+
+        return new MacroRunResult(buffer.ToEdits(), caret, iterations);
+    }
+
+    /// <summary>
+    /// Plays the macro repeatedly from <paramref name="caret"/> until the
+    /// caret reaches the end of the document, an iteration fails to bring
+    /// the caret closer to the end (it would loop forever), or a
+    /// <see cref="MacroOpKind.Replace"/> finds nothing more to replace.
+    /// </summary>
+    /// <inheritdoc cref="Run" path="/param[@name='snapshot']"/>
+    /// <inheritdoc cref="Run" path="/param[@name='caret']"/>
+    /// <inheritdoc cref="Run" path="/param[@name='progress']"/>
+    /// <inheritdoc cref="Run" path="/param[@name='cancellationToken']"/>
+    /// <exception cref="OperationCanceledException">The run was cancelled.</exception>
+    public MacroRunResult RunToEnd(PieceTable snapshot, long caret,
+        IProgress<int>? progress = null, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(snapshot);
+
+        var buffer = new MacroEditBuffer(snapshot);
+        caret = Math.Clamp(caret, 0, buffer.Length);
+        int lastPercent = -1;
+        int iterations = 0;
+
+        while (_ops.Length > 0 && caret < buffer.Length)
+        {
+            cancellationToken.ThrowIfCancellationRequested();
+
+            long remainingBefore = buffer.Length - caret;
+            long next = Execute(buffer, caret, out bool searchFailed);
+            if (searchFailed)
+            {
+                // The failed iteration's other edits are kept, as they would
+                // be if the macro were played by hand.
+                caret = next;
+                iterations++;
+                break;
+            }
+
+            caret = next;
+            iterations++;
+            // Text left after the caret must shrink every iteration, or
+            // a macro that inserts faster than it advances never ends.
+            if (buffer.Length - caret >= remainingBefore)
+                break;
+
+            Report(progress, buffer.Length == 0 ? 100 : (int)(caret * 100 / buffer.Length), ref lastPercent);
+        }
+
+        Report(progress, 100, ref lastPercent);
+        return new MacroRunResult(buffer.ToEdits(), caret, iterations);
+    }
+
+    /// <summary>
+    /// Plays the macro once on every line selected by
+    /// <paramref name="lineFilter"/>, each line in isolation: the macro sees
+    /// only that line's text (without its line feed), starts with the caret
+    /// at the line start, and offsets and line moves are relative to it.
+    /// </summary>
+    /// <remarks>
+    /// Lines are read from the snapshot on the calling thread in large
+    /// windows; the lines of each window are filtered and played in parallel.
+    /// Each changed line becomes one <see cref="TextEdit"/>, and results are
+    /// gathered by line index, so the output is the same whatever the
+    /// scheduling.
+    /// </remarks>
+    /// <inheritdoc cref="Run" path="/param[@name='snapshot']"/>
+    /// <param name="lineFilter">Selects the lines to play the macro on.</param>
+    /// <param name="caret">
+    /// A caret offset in the snapshot; the result reports where it lands
+    /// after the edits.
+    /// </param>
+    /// <inheritdoc cref="Run" path="/param[@name='progress']"/>
+    /// <inheritdoc cref="Run" path="/param[@name='cancellationToken']"/>
+    /// <returns>
+    /// The line replacements, the mapped caret, and the number of lines the
+    /// macro was played on.
+    /// </returns>
+    /// <exception cref="OperationCanceledException">The run was cancelled.</exception>
+    /// <exception cref="System.Text.RegularExpressions.RegexMatchTimeoutException">
+    /// The filter's pattern timed out on a line.  Failures of the filter or
+    /// of a line's playback are rethrown as themselves, not wrapped.
+    /// </exception>
+    public MacroRunResult RunOnMatchingLines(PieceTable snapshot, LinePredicate lineFilter, long caret = 0,
+        IProgress<int>? progress = null, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(snapshot);
+        ArgumentNullException.ThrowIfNull(lineFilter);
+
+        var edits = new List<TextEdit>();
+        long length = snapshot.Length;
+        caret = Math.Clamp(caret, 0, length);
+        if (_ops.Length == 0)
+            return new MacroRunResult(edits, caret, 0);
+
+        int lastPercent = -1;
+        int iterations = 0;
+        long offset = 0;
+        int window = LineWindowSize;
+        var parallelOptions = new ParallelOptions { CancellationToken = cancellationToken };
+
+        while (true)
+        {
+            cancellationToken.ThrowIfCancellationRequested();
+
+            // Read whole lines only: the window must end in a line feed
+            // unless it reaches the end of the document.
+            int take = (int)Math.Min(window, length - offset);
+            string text = snapshot.GetText(offset, take);
+            bool last = offset + take >= length;
+            int end = last ? text.Length : text.LastIndexOf('\n');
+            if (end < 0)
+            {
+                window = (int)Math.Min((long)window * 2, Array.MaxLength);
+                continue;
+            }
+
+            List<int> starts = FindLineStarts(text, end);
+            var replaced = new string?[starts.Count];
+            int played = 0;
+
+            try
+            {
+                Parallel.For(0, (starts.Count + LineBatchSize - 1) / LineBatchSize, parallelOptions, batch =>
+                {
+                    int first = batch * LineBatchSize;
+                    int stop = Math.Min(first + LineBatchSize, starts.Count);
+                    int count = 0;
+                    for (int i = first; i < stop; i++)
+                    {
+                        int lineEnd = i + 1 < starts.Count ? starts[i + 1] - 1 : end;
+                        ReadOnlySpan<char> line = text.AsSpan(starts[i], lineEnd - starts[i]);
+                        if (!lineFilter(line)) continue;
+
+                        count++;
+                        replaced[i] = PlayOnLine(line);
+                    }
+                    Interlocked.Add(ref played, count);
+                });
+            }
+            catch (AggregateException ex)
+            {
+                // Surface the first failure, e.g. a regex timeout, as itself.
+                ExceptionDispatchInfo.Capture(ex.Flatten().InnerExceptions[0]).Throw();
+                throw;
+            }
+
+            for (int i = 0; i < starts.Count; i++)
+            {
+                if (replaced[i] is not { } newText) continue;
+                int lineEnd = i + 1 < starts.Count ? starts[i + 1] - 1 : end;
+                edits.Add(new TextEdit(offset + starts[i], lineEnd - starts[i], newText));
+            }
+            iterations += played;
+
+            if (last) break;
+            offset += end + 1;
+            window = LineWindowSize;
+            Report(progress, (int)(offset * 100 / length), ref lastPercent);
+        }
+
+        Report(progress, 100, ref lastPercent);
+        return new MacroRunResult(edits, MapOffset(edits, caret), iterations);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Execution
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Plays the macro once on a single line and returns its new text, or
+    /// <see langword="null"/> if the line is unchanged.
+    /// </summary>
+    private string? PlayOnLine(ReadOnlySpan<char> line)
+    {
+        var buffer = new MacroEditBuffer(line.ToString());
+        Execute(buffer, 0, out _);
+        if (buffer.EditCount == 0)
+            return null;
+
+        string result = string.Create((int)buffer.Length, buffer, static (span, b) => b.CopyTo(0, span));
+        return line.SequenceEqual(result) ? null : result;
+    }
+
+    /// <summary>Start offsets of the lines in <c>text[..end]</c>.</summary>
+    private static List<int> FindLineStarts(string text, int end)
+    {
+        var starts = new List<int> { 0 };
+        int pos = 0;
+        while (true)
+        {
+            int lf = text.AsSpan(pos, end - pos).IndexOf('\n');
+            if (lf < 0) return starts;
+            pos += lf + 1;
+            starts.Add(pos);
+        }
+    }
+
+    /// <summary>
+    /// Maps a snapshot offset through sorted edits.  An offset inside a
+    /// replaced line keeps its column, clamped to the new line length.
+    /// </summary>
+    private static long MapOffset(List<TextEdit> edits, long offset)
+    {
+        long delta = 0;
+        foreach (TextEdit e in edits)
+        {
+            if (e.Offset >= offset) break;
+            if (e.Offset + e.Length > offset)
+                return e.Offset + delta + Math.Min(offset - e.Offset, e.Text.Length);
+            delta += e.Text.Length - e.Length;
+        }
+        return offset + delta;
+    }
+
+    /// <summary>Runs every operation once and returns the new caret.</summary>
+    private long Execute(MacroEditBuffer buffer, long caret, out bool searchFailed)
+    {
+        searchFailed = false;
+        foreach (MacroOp op in _ops)
+        {
+            switch (op.Kind)
+            {
+                case MacroOpKind.Insert:
+                    buffer.Replace(caret, 0, op.Text!);
+                    caret += op.Text!.Length;
+                    break;
+
+                case MacroOpKind.Delete:
+                    buffer.Replace(caret, Math.Min(op.Count, buffer.Length - caret), string.Empty);
+                    break;
+
+                case MacroOpKind.Backspace:
+                {
+                    long count = Math.Min(op.Count, caret);
+                    caret -= count;
+                    buffer.Replace(caret, count, string.Empty);
+                    break;
+                }
+
+                case MacroOpKind.MoveTo:
+                    caret = Math.Clamp(op.Count, 0, buffer.Length);
+                    break;
+
+                case MacroOpKind.MoveBy:
+                    caret = Math.Clamp(caret + op.Count, 0, buffer.Length);
+                    break;
+
+                case MacroOpKind.MoveToDocumentStart:
+                    caret = 0;
+                    break;
+
+                case MacroOpKind.MoveToDocumentEnd:
+                    caret = buffer.Length;
+                    break;
+
+                case MacroOpKind.MoveLineUp:
+                    caret = MoveLineUp(buffer, caret);
+                    break;
+
+                case MacroOpKind.MoveLineDown:
+                    caret = MoveLineDown(buffer, caret);
+                    break;
+
+                case MacroOpKind.Replace:
+                {
+                    long index = buffer.IndexOf(op.Text!, caret);
+                    if (index < 0)
+                    {
+                        searchFailed = true;
+                        break;
+                    }
+                    buffer.Replace(index, op.Text!.Length, op.Replacement!);
+                    caret = index + op.Replacement!.Length;
+                    break;
+                }
+            }
+        }
+        return caret;
+    }
+
+    /// <summary>Moves up one line, keeping the column where the line is long enough.</summary>
+    private static long MoveLineUp(MacroEditBuffer buffer, long caret)
+    {
+        long lineStart = buffer.LastIndexOfLineFeed(caret) + 1;
+        if (lineStart == 0)
+            return 0;
+
+        long column = caret - lineStart;
+        long previousStart = buffer.LastIndexOfLineFeed(lineStart - 1) + 1;
+        long previousLength = lineStart - 1 - previousStart;
+        return previousStart + Math.Min(column, previousLength);
+    }
+
+    /// <summary>Moves down one line, keeping the column where the line is long enough.</summary>
+    private static long MoveLineDown(MacroEditBuffer buffer, long caret)
+    {
+        long column = caret - (buffer.LastIndexOfLineFeed(caret) + 1);
+        long lineEnd = buffer.IndexOfLineFeed(caret);
+        if (lineEnd < 0)
+            return buffer.Length;
+
+        long nextStart = lineEnd + 1;
+        long nextEnd = buffer.IndexOfLineFeed(nextStart);
+        long nextLength = (nextEnd < 0 ? buffer.Length : nextEnd) - nextStart;
+        return nextStart + Math.Min(column, nextLength);
+    }
+
+    private static void Report(IProgress<int>? progress, int percent, ref int lastPercent)
+    {
+        if (progress is null || percent == lastPercent) return;
+        lastPercent = percent;
+        progress.Report(percent);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Folding
+    // ────────────────────────────────────────────────────────────────────
+
+    private static MacroOp[] Fold(IEnumerable<MacroOp> operations)
+    {
+        var ops = new List<MacroOp>();
+        foreach (MacroOp op in operations)
+        {
+            if (op.Kind == MacroOpKind.Insert && string.IsNullOrEmpty(op.Text))
+                continue;
+            if ((op.Kind is MacroOpKind.Delete or MacroOpKind.Backspace) && op.Count <= 0)
+                continue;
+            if (op.Kind == MacroOpKind.MoveBy && op.Count == 0)
+                continue;
+
+            if (ops.Count > 0)
+            {
+                MacroOp prev = ops[^1];
+                MacroOp? folded = (prev.Kind, op.Kind) switch
+                {
+                    (MacroOpKind.Insert, MacroOpKind.Insert) =>
+                        prev with { Text = prev.Text + op.Text },
+                    (MacroOpKind.Delete, MacroOpKind.Delete) or
+                    (MacroOpKind.Backspace, MacroOpKind.Backspace) =>
+                        prev with { Count = prev.Count + op.Count },
+                    // Clamping makes opposite moves order-dependent, so only
+                    // moves in the same direction are summed.
+                    (MacroOpKind.MoveBy, MacroOpKind.MoveBy) when Math.Sign(prev.Count) == Math.Sign(op.Count) =>
+                        prev with { Count = prev.Count + op.Count },
+                    _ => null,
+                };
+
+                if (folded is { } f)
+                {
+                    ops[^1] = f;
+                    continue;
+                }
+
+                // An absolute move makes any caret-only moves before it moot.
+                if (op.Kind is MacroOpKind.MoveTo or MacroOpKind.MoveToDocumentStart or MacroOpKind.MoveToDocumentEnd)
+                {
+                    while (ops.Count > 0 && IsMove(ops[^1].Kind))
+                        ops.RemoveAt(ops.Count - 1);
+                }
+            }
+
+            ops.Add(op);
+        }
+        return [.. ops];
+    }
+
+    private static bool IsMove(MacroOpKind kind) => kind is MacroOpKind.MoveTo or MacroOpKind.MoveBy or
+        MacroOpKind.MoveToDocumentStart or MacroOpKind.MoveToDocumentEnd or
+        MacroOpKind.MoveLineUp or MacroOpKind.MoveLineDown;
+}
+
+/// <summary>
+/// The outcome of a <see cref="MacroEngine"/> run.
+/// </summary>
+/// <param name="Edits">
+/// Every change the run made, in snapshot coordinates, sorted and
+/// non-overlapping — ready for <see cref="Commands.BulkEditCommand"/>.
+/// </param>
+/// <param name="Caret">Caret offset after the run, in edited coordinates.</param>
+/// <param name="Iterations">How many times the macro was played.</param>
+public sealed record MacroRunResult(IReadOnlyList<TextEdit> Edits, long Caret, int Iterations);
@@ -0,0 +1,98 @@
+namespace Bascanka.Core.Macros;
+
+/// <summary>
+/// The buffer operations a compiled macro is made of.
+/// </summary>
+public enum MacroOpKind
+{
+    /// <summary>Inserts <see cref="MacroOp.Text"/> at the caret and moves past it.</summary>
+    Insert,
+
+    /// <summary>Deletes up to <see cref="MacroOp.Count"/> characters after the caret.</summary>
+    Delete,
+
+    /// <summary>Deletes up to <see cref="MacroOp.Count"/> characters before the caret.</summary>
+    Backspace,
+
+    /// <summary>Moves the caret to the absolute offset <see cref="MacroOp.Count"/>.</summary>
+    MoveTo,
+
+    /// <summary>Moves the caret by the signed amount <see cref="MacroOp.Count"/>.</summary>
+    MoveBy,
+
+    /// <summary>Moves the caret to the start of the document.</summary>
+    MoveToDocumentStart,
+
+    /// <summary>Moves the caret to the end of the document.</summary>
+    MoveToDocumentEnd,
+
+    /// <summary>Moves the caret up one line, keeping its column where possible.</summary>
+    MoveLineUp,
+
+    /// <summary>Moves the caret down one line, keeping its column where possible.</summary>
+    MoveLineDown,
+
+    /// <summary>
+    /// Replaces the next occurrence of <see cref="MacroOp.Text"/> at or after
+    /// the caret with <see cref="MacroOp.Replacement"/> and moves past it.
+    /// </summary>
+    Replace,
+}
+
+/// <summary>
+/// A single compiled macro operation.  Use the factory methods rather than
+/// the constructor so that each kind carries the operands it expects.
+/// </summary>
+/// <param name="Kind">What the operation does.</param>
+/// <param name="Count">Offset, distance or repeat count, depending on <paramref name="Kind"/>.</param>
+/// <param name="Text">Inserted text, or the text searched for by <see cref="MacroOpKind.Replace"/>.</param>
+/// <param name="Replacement">Replacement text for <see cref="MacroOpKind.Replace"/>.</param>
+public readonly record struct MacroOp(MacroOpKind Kind, long Count = 0, string? Text = null, string? Replacement = null)
+{
+    /// <summary>Inserts text at the caret.  Line endings are normalized to <c>\n</c>.</summary>
+    public static MacroOp Insert(string text) =>
+        new(MacroOpKind.Insert, Text: NormalizeLineEndings(text ?? throw new ArgumentNullException(nameof(text))));
+
+    /// <summary>Deletes <paramref name="count"/> characters after the caret.</summary>
+    public static MacroOp Delete(long count = 1) => new(MacroOpKind.Delete, count);
+
+    /// <summary>Deletes <paramref name="count"/> characters before the caret.</summary>
+    public static MacroOp Backspace(long count = 1) => new(MacroOpKind.Backspace, count);
+
+    /// <summary>Moves the caret to an absolute offset, clamped to the document.</summary>
+    public static MacroOp MoveTo(long offset) => new(MacroOpKind.MoveTo, offset);
+
+    /// <summary>Moves the caret by a signed distance, clamped to the document.</summary>
+    public static MacroOp MoveBy(long distance) => new(MacroOpKind.MoveBy, distance);
+
+    /// <summary>Moves the caret to the start of the document.</summary>
+    public static MacroOp MoveToDocumentStart() => new(MacroOpKind.MoveToDocumentStart);
+
+    /// <summary>Moves the caret to the end of the document.</summary>
+    public static MacroOp MoveToDocumentEnd() => new(MacroOpKind.MoveToDocumentEnd);
+
+    /// <summary>Moves the caret up one line.</summary>
+    public static MacroOp MoveLineUp() => new(MacroOpKind.MoveLineUp);
+
+    /// <summary>Moves the caret down one line.</summary>
+    public static MacroOp MoveLineDown() => new(MacroOpKind.MoveLineDown);
+
+    /// <summary>
+    /// Replaces the next ordinal occurrence of <paramref name="search"/> at or
+    /// after the caret with <paramref name="replacement"/>.
+    /// </summary>
+    public static MacroOp Replace(string search, string replacement)
+    {
+        ArgumentException.ThrowIfNullOrEmpty(search);
+        ArgumentNullException.ThrowIfNull(replacement);
+        return new(MacroOpKind.Replace, Text: NormalizeLineEndings(search),
+            Replacement: NormalizeLineEndings(replacement));
+    }
+
+    /// <summary>
+    /// Converts <c>\r\n</c> and bare <c>\r</c> to <c>\n</c>, matching what
+    /// <see cref="Buffer.PieceTable.Insert"/> stores.
+    /// </summary>
+    private static string NormalizeLineEndings(string text) =>
+        text.Contains('\r') ? text.Replace("\r\n", "\n").Replace("\r", "\n") : text;
+}
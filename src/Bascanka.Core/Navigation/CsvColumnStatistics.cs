@@ -0,0 +1,266 @@
+using System.Globalization;
+using System.Numerics;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Transforms;
+
+namespace Bascanka.Core.Navigation;
+
+/// <summary>
+/// Summary statistics of one column of a CSV or TSV document: how many
+/// values it has, how many are distinct, and the smallest and largest.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Blocks of lines are read in order and summarised in parallel; the
+/// partial results are merged.  Distinct values are counted exactly by
+/// their 128-bit hashes up to <see cref="MaxExactDistinct"/>, and estimated
+/// with a HyperLogLog sketch (about 1% error) beyond that, so memory stays
+/// bounded on documents of any size.
+/// </para>
+/// <para>
+/// A record with a quoted line break contributes the part of the value on
+/// its first line, and the lines that continue it are skipped.
+/// </para>
+/// </remarks>
+public sealed class CsvColumnStatistics
+{
+    /// <summary>Distinct values counted exactly before switching to an estimate.</summary>
+    public const int MaxExactDistinct = 1 << 20;
+
+    private CsvColumnStatistics(int column)
+    {
+        Column = column;
+    }
+
+    /// <summary>Zero-based column the statistics describe.</summary>
+    public int Column { get; }
+
+    /// <summary>Number of records that have the column, empty or not.</summary>
+    public long Count { get; private set; }
+
+    /// <summary>Number of records whose value in the column is empty.</summary>
+    public long EmptyCount { get; private set; }
+
+    /// <summary>Number of distinct non-empty values.</summary>
+    public long DistinctCount { get; private set; }
+
+    /// <summary>Whether <see cref="DistinctCount"/> is exact rather than estimated.</summary>
+    public bool IsDistinctCountExact { get; private set; } = true;
+
+    /// <summary>Smallest non-empty value by ordinal comparison.</summary>
+    public string? Min { get; private set; }
+
+    /// <summary>Largest non-empty value by ordinal comparison.</summary>
+    public string? Max { get; private set; }
+
+    /// <summary>
+    /// Whether every non-empty value is a number, in which case
+    /// <see cref="NumericMin"/> and <see cref="NumericMax"/> are set.
+    /// </summary>
+    public bool IsNumeric => NumericMin.HasValue;
+
+    /// <summary>Smallest value, when every non-empty value is a number.</summary>
+    public double? NumericMin { get; private set; }
+
+    /// <summary>Largest value, when every non-empty value is a number.</summary>
+    public double? NumericMax { get; private set; }
+
+    /// <summary>
+    /// Computes the statistics of column <paramref name="column"/>.
+    /// </summary>
+    /// <param name="document">The document to read; it must not change during the computation.</param>
+    /// <param name="index">The field index of <paramref name="document"/>.</param>
+    /// <param name="column">Zero-based column.</param>
+    /// <param name="skipHeader">Leaves out the first record, which holds the column names.</param>
+    /// <param name="progress">Receives the percentage of the document read.</param>
+    /// <param name="cancellationToken">Cancels the computation between batches of blocks.</param>
+    /// <exception cref="OperationCanceledException">The computation was cancelled.</exception>
+    public static CsvColumnStatistics Compute(PieceTable document, CsvFieldIndex index, int column,
+        bool skipHeader = false, IProgress<int>? progress = null, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+        ArgumentNullException.ThrowIfNull(index);
+        ArgumentOutOfRangeException.ThrowIfNegative(column);
+
+        long length = document.Length;
+        var partials = new Partial[Environment.ProcessorCount];
+        var total = new Partial();
+        var options = new ParallelOptions { CancellationToken = cancellationToken };
+        using var windows = LineWindows.Enumerate(document, 0, length, cancellationToken).GetEnumerator();
+        var batch = new List<(long FirstLine, ReadOnlyMemory<char> Text)>(partials.Length);
+        long nextLine = 0;
+        long done = 0;
+        int lastPercent = -1;
+        bool more = true;
+        while (more)
+        {
+            batch.Clear();
+            while (batch.Count < partials.Length && (more = windows.MoveNext()))
+            {
+                var (_, text) = windows.Current;
+                batch.Add((nextLine, text));
+                nextLine += text.Span.Count('\n');
+                done += text.Length;
+            }
+            if (batch.Count == 0) break;
+
+            Parallel.For(0, batch.Count, options, i =>
+            {
+                var partial = new Partial();
+                var (firstLine, text) = batch[i];
+                partial.Add(text.Span, firstLine, index, column, skipHeader);
+                partials[i] = partial;
+            });
+            for (int i = 0; i < batch.Count; i++)
+                total.Merge(partials[i]);
+
+            LineWindows.Report(progress, (int)(done * 100 / Math.Max(length, 1)), ref lastPercent);
+        }
+
+        var statistics = new CsvColumnStatistics(column)
+        {
+            Count = total.Count,
+            EmptyCount = total.EmptyCount,
+            Min = total.Min,
+            Max = total.Max,
+        };
+        if (total.Sketch is { } sketch)
+        {
+            statistics.DistinctCount = sketch.Estimate();
+            statistics.IsDistinctCountExact = false;
+        }
+        else
+        {
+            statistics.DistinctCount = total.Distinct.Count;
+        }
+        if (total.AllNumeric && total.Count > total.EmptyCount)
+        {
+            statistics.NumericMin = total.NumericMin;
+            statistics.NumericMax = total.NumericMax;
+        }
+        return statistics;
+    }
+
+    /// <summary>Statistics of one block, merged into the total.</summary>
+    private sealed class Partial
+    {
+        public long Count;
+        public long EmptyCount;
+        public string? Min;
+        public string? Max;
+        public bool AllNumeric = true;
+        public double NumericMin = double.PositiveInfinity;
+        public double NumericMax = double.NegativeInfinity;
+        public HashSet<UInt128> Distinct = [];
+        public HyperLogLog? Sketch;
+
+        public void Add(ReadOnlySpan<char> text, long firstLine, CsvFieldIndex index, int column, bool skipHeader)
+        {
+            CsvDialect dialect = index.Dialect;
+            long line = firstLine;
+            foreach (Range range in new CsvDialect.LineRanges(text))
+            {
+                long current = line++;
+                if (index.StartsInQuotes(current) || (skipHeader && current == 0))
+                    continue;
+                ReadOnlySpan<char> record = text[range];
+                if (!dialect.TryGetField(record, column, out Range fieldRange))
+                    continue;
+
+                Count++;
+                ReadOnlySpan<char> value = record[fieldRange].Trim();
+                if (value.IsEmpty)
+                {
+                    EmptyCount++;
+                    continue;
+                }
+
+                Distinct.Add(LineHash.Compute(value));
+                if (Min is null || value.SequenceCompareTo(Min) < 0)
+                    Min = dialect.CollapseQuotes(value);
+                if (Max is null || value.SequenceCompareTo(Max) > 0)
+                    Max = dialect.CollapseQuotes(value);
+
+                if (AllNumeric)
+                {
+                    if (double.TryParse(value, NumberStyles.Float, CultureInfo.InvariantCulture, out double number))
+                    {
+                        NumericMin = Math.Min(NumericMin, number);
+                        NumericMax = Math.Max(NumericMax, number);
+                    }
+                    else
+                    {
+                        AllNumeric = false;
+                    }
+                }
+            }
+        }
+
+        public void Merge(Partial other)
+        {
+            Count += other.Count;
+            EmptyCount += other.EmptyCount;
+            if (other.Min is not null && (Min is null || string.CompareOrdinal(other.Min, Min) < 0))
+                Min = other.Min;
+            if (other.Max is not null && (Max is null || string.CompareOrdinal(other.Max, Max) > 0))
+                Max = other.Max;
+            AllNumeric &= other.AllNumeric;
+            NumericMin = Math.Min(NumericMin, other.NumericMin);
+            NumericMax = Math.Max(NumericMax, other.NumericMax);
+
+            if (Sketch is null)
+            {
+                Distinct.UnionWith(other.Distinct);
+                if (Distinct.Count <= MaxExactDistinct) return;
+
+                Sketch = new HyperLogLog();
+                foreach (UInt128 hash in Distinct)
+                    Sketch.Add(hash);
+                Distinct = [];
+            }
+            else
+            {
+                foreach (UInt128 hash in other.Distinct)
+                    Sketch.Add(hash);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Estimates the number of distinct hashes in fixed memory
+    /// (Flajolet et al., 2007), with the small-range correction.
+    /// </summary>
+    private sealed class HyperLogLog
+    {
+        private const int Bits = 14;
+        private const int Registers = 1 << Bits;
+
+        private readonly byte[] _registers = new byte[Registers];
+
+        public void Add(UInt128 hash)
+        {
+            ulong high = (ulong)(hash >> 64);
+            int register = (int)(high >> (64 - Bits));
+            int rank = Math.Min(BitOperations.LeadingZeroCount((ulong)hash) + 1, 64);
+            if (rank > _registers[register])
+                _registers[register] = (byte)rank;
+        }
+
+        public long Estimate()
+        {
+            double sum = 0;
+            int zeros = 0;
+            foreach (byte value in _registers)
+            {
+                sum += Math.ScaleB(1, -value);
+                if (value == 0) zeros++;
+            }
+
+            double alpha = 0.7213 / (1 + 1.079 / Registers);
+            double estimate = alpha * Registers * Registers / sum;
+            if (estimate <= 2.5 * Registers && zeros > 0)
+                estimate = Registers * Math.Log((double)Registers / zeros);
+            return (long)Math.Round(estimate);
+        }
+    }
+}
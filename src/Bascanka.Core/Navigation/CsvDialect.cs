@@ -0,0 +1,273 @@
+using System.Buffers;
+using Bascanka.Core.Search;
+
+namespace Bascanka.Core.Navigation;
+
+/// <summary>
+/// The separator and quote characters of a CSV or TSV file, and the
+/// quote-aware splitting of lines into fields.
+/// </summary>
+/// <remarks>
+/// Fields follow RFC 4180 leniently: a quote opens a quoted field only at
+/// the start of a field, a doubled quote inside a quoted field stands for
+/// one quote, and a quoted field may contain separators and line breaks.
+/// Any other quote is part of the field's text.
+/// </remarks>
+public sealed class CsvDialect
+{
+    /// <summary>Comma-separated values.</summary>
+    public static CsvDialect Comma { get; } = new(',');
+
+    /// <summary>Tab-separated values.</summary>
+    public static CsvDialect Tab { get; } = new('\t');
+
+    /// <summary>Separators tried by <see cref="Detect"/>, most likely first.</summary>
+    private static readonly char[] CandidateSeparators = [',', '\t', ';', '|'];
+
+    private readonly SearchValues<char> _fieldSpecials;
+    private readonly string _doubledQuote;
+
+    /// <summary>Creates a dialect with the given separator and quote.</summary>
+    /// <exception cref="ArgumentException">
+    /// The separator and quote are the same character, or one of them is a line break.
+    /// </exception>
+    public CsvDialect(char separator, char quote = '"')
+    {
+        if (separator == quote || separator is '\r' or '\n' || quote is '\r' or '\n')
+            throw new ArgumentException("The separator and quote must be distinct and not line breaks.");
+
+        Separator = separator;
+        Quote = quote;
+        _fieldSpecials = SearchValues.Create([separator, quote]);
+        _doubledQuote = new string(quote, 2);
+    }
+
+    /// <summary>The character between fields.</summary>
+    public char Separator { get; }
+
+    /// <summary>The character that encloses fields containing separators, quotes or line breaks.</summary>
+    public char Quote { get; }
+
+    /// <summary>
+    /// Guesses the dialect of a file from the first lines of its text: the
+    /// candidate separator that appears outside quotes the same number of
+    /// times on the most lines wins.  Falls back to <see cref="Comma"/>.
+    /// </summary>
+    public static CsvDialect Detect(ReadOnlySpan<char> sample)
+    {
+        // Drop a trailing partial line.
+        int lastBreak = sample.LastIndexOf('\n');
+        if (lastBreak > 0)
+            sample = sample[..lastBreak];
+
+        CsvDialect best = Comma;
+        int bestScore = 0;
+        var fields = new List<Range>();
+        foreach (char separator in CandidateSeparators)
+        {
+            var dialect = separator switch { ',' => Comma, '\t' => Tab, _ => new CsvDialect(separator) };
+            int score = 0, firstCount = -1, lines = 0;
+            bool inQuotes = false;
+            foreach (Range range in new LineRanges(sample))
+            {
+                if (++lines > 100) break;
+                bool startsInQuotes = inQuotes;
+                fields.Clear();
+                inQuotes = dialect.SplitFields(sample[range], startsInQuotes, fields);
+                if (startsInQuotes) continue;
+
+                if (firstCount < 0) firstCount = fields.Count;
+                if (fields.Count > 1 && fields.Count == firstCount) score++;
+            }
+
+            if (score > bestScore)
+            {
+                best = dialect;
+                bestScore = score;
+            }
+        }
+        return best;
+    }
+
+    /// <summary>
+    /// Appends the ranges of the fields of one line to
+    /// <paramref name="fields"/>.  The ranges include any enclosing quotes;
+    /// <see cref="Unquote"/> turns a field into its value.
+    /// </summary>
+    /// <param name="line">The line, without its line break.</param>
+    /// <param name="startsInQuotes">
+    /// Whether the line continues a quoted field from the line before it.
+    /// </param>
+    /// <param name="fields">Receives the field ranges.</param>
+    /// <returns>Whether the line ends inside a quoted field.</returns>
+    public bool SplitFields(ReadOnlySpan<char> line, bool startsInQuotes, List<Range> fields)
+    {
+        ArgumentNullException.ThrowIfNull(fields);
+
+        bool inQuotes = startsInQuotes;
+        int fieldStart = 0;
+        int i = 0;
+        while (i < line.Length)
+        {
+            if (inQuotes)
+            {
+                int close = line[i..].IndexOf(Quote);
+                if (close < 0) break;
+                i += close + 1;
+                if (i < line.Length && line[i] == Quote)
+                    i++;  // A doubled quote stays inside the field.
+                else
+                    inQuotes = false;
+                continue;
+            }
+
+            int next = line[i..].IndexOfAny(_fieldSpecials);
+            if (next < 0) break;
+            i += next;
+            if (line[i] == Separator)
+            {
+                fields.Add(fieldStart..i);
+                fieldStart = i + 1;
+            }
+            else if (i == fieldStart)
+            {
+                inQuotes = true;
+            }
+            i++;
+        }
+
+        fields.Add(fieldStart..line.Length);
+        return inQuotes;
+    }
+
+    /// <summary>
+    /// Finds field <paramref name="column"/> (zero-based) of a line that
+    /// does not start inside a quoted field, without its enclosing quotes.
+    /// </summary>
+    /// <returns>
+    /// Whether the line has that many fields.  <paramref name="value"/> may
+    /// still contain doubled quotes.
+    /// </returns>
+    public bool TryGetField(ReadOnlySpan<char> line, int column, out Range value)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegative(column);
+
+        int fieldStart = 0;
+        int i = 0;
+        int current = 0;
+        while (true)
+        {
+            // Skip a quoted section at the start of the field.
+            bool quoted = i == fieldStart && i < line.Length && line[i] == Quote;
+            if (quoted)
+            {
+                i++;
+                while (true)
+                {
+                    int close = line[i..].IndexOf(Quote);
+                    if (close < 0) { i = line.Length; break; }
+                    i += close + 1;
+                    if (i < line.Length && line[i] == Quote) { i++; continue; }
+                    break;
+                }
+            }
+
+            int next = i < line.Length ? line[i..].IndexOf(Separator) : -1;
+            int fieldEnd = next < 0 ? line.Length : i + next;
+            if (current == column)
+            {
+                value = quoted ? InsideQuotes(line, fieldStart, fieldEnd) : fieldStart..fieldEnd;
+                return true;
+            }
+            if (next < 0)
+            {
+                value = default;
+                return false;
+            }
+
+            current++;
+            fieldStart = i = fieldEnd + 1;
+        }
+    }
+
+    /// <summary>
+    /// Returns the value of a field: without its enclosing quotes and with
+    /// doubled quotes collapsed.
+    /// </summary>
+    public string Unquote(ReadOnlySpan<char> field)
+    {
+        if (field.IsEmpty || field[0] != Quote)
+            return field.ToString();
+
+        Range inner = InsideQuotes(field, 0, field.Length);
+        return CollapseQuotes(field[inner]);
+    }
+
+    /// <summary>Replaces doubled quotes with single ones.</summary>
+    internal string CollapseQuotes(ReadOnlySpan<char> value)
+    {
+        if (value.IndexOf(_doubledQuote) < 0)
+            return value.ToString();
+        return value.ToString().Replace(_doubledQuote, Quote.ToString(), StringComparison.Ordinal);
+    }
+
+    /// <summary>
+    /// Returns a predicate that selects lines whose field
+    /// <paramref name="column"/> (zero-based) equals <paramref name="value"/>.
+    /// Lines are split as if each starts a record.  The predicate is
+    /// thread-safe and allocates only for values with doubled quotes.
+    /// </summary>
+    public LinePredicate CreateFieldPredicate(int column, string value, bool ignoreCase = false)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegative(column);
+        ArgumentNullException.ThrowIfNull(value);
+
+        StringComparison comparison = ignoreCase ? StringComparison.OrdinalIgnoreCase : StringComparison.Ordinal;
+        return line =>
+        {
+            if (!TryGetField(line, column, out Range range))
+                return value.Length == 0;
+
+            ReadOnlySpan<char> field = line[range];
+            return field.IndexOf(_doubledQuote) < 0
+                ? field.Equals(value, comparison)
+                : CollapseQuotes(field).Equals(value, comparison);
+        };
+    }
+
+    /// <summary>
+    /// The range between the opening quote at <paramref name="start"/> and
+    /// its closing quote, if the field ends with one.
+    /// </summary>
+    private Range InsideQuotes(ReadOnlySpan<char> line, int start, int end)
+    {
+        int innerEnd = end - start >= 2 && line[end - 1] == Quote ? end - 1 : end;
+        return (start + 1)..innerEnd;
+    }
+
+    public override string ToString() => Separator == '\t' ? "TSV" : $"CSV ({Separator})";
+
+    /// <summary>Enumerates the line ranges of a span, without line breaks.</summary>
+    internal ref struct LineRanges(ReadOnlySpan<char> text)
+    {
+        private readonly ReadOnlySpan<char> _text = text;
+        private int _position;
+
+        public Range Current { get; private set; }
+
+        public readonly LineRanges GetEnumerator() => this;
+
+        public bool MoveNext()
+        {
+            if (_position > _text.Length || (_position == _text.Length && _position > 0 && _text[^1] == '\n'))
+                return false;
+
+            int lf = _text[_position..].IndexOf('\n');
+            int end = lf < 0 ? _text.Length : _position + lf;
+            int contentEnd = end > _position && _text[end - 1] == '\r' ? end - 1 : end;
+            Current = _position..contentEnd;
+            _position = end + 1;
+            return true;
+        }
+    }
+}
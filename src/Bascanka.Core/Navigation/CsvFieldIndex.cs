@@ -0,0 +1,330 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Transforms;
+
+namespace Bascanka.Core.Navigation;
+
+/// <summary>
+/// A sparse index of the fields of a CSV or TSV document: for every block
+/// of about 1M characters of whole lines, its first line and the widest
+/// value of each column, plus the few lines that start inside a quoted
+/// field.  With it, any line can be split into fields on its own, records
+/// can be found by number and visible rows can be laid out in aligned
+/// columns, without reading the rest of the document.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Blocks are read in order and scanned in parallel, each assuming that it
+/// starts outside a quoted field.  Stitching them in order checks that
+/// assumption: a block that follows one ending inside a quoted field, which
+/// only happens when a field with a line break straddles the boundary, is
+/// scanned again from the right state.
+/// </para>
+/// <para>
+/// The index describes the text it was built from and must be rebuilt after
+/// an edit.  Instances are immutable once built and may be queried from any
+/// thread.
+/// </para>
+/// </remarks>
+public sealed class CsvFieldIndex
+{
+    /// <summary>Columns beyond this many are split but their widths are not tracked.</summary>
+    public const int MaxTrackedColumns = 1024;
+
+    /// <summary>Widths are tracked up to this many characters.</summary>
+    public const int MaxTrackedWidth = 1000;
+
+    private readonly List<Block> _blocks = [];
+    private readonly List<long> _continuationLines = [];
+    private int[] _columnWidths = [];
+
+    private CsvFieldIndex(CsvDialect dialect, long documentLength)
+    {
+        Dialect = dialect;
+        DocumentLength = documentLength;
+    }
+
+    /// <summary>The dialect the document was split with.</summary>
+    public CsvDialect Dialect { get; }
+
+    /// <summary>Length of the document the index was built from.</summary>
+    public long DocumentLength { get; }
+
+    /// <summary>
+    /// Number of lines, not counting the empty line after a final line break.
+    /// </summary>
+    public long LineCount { get; private set; }
+
+    /// <summary>Number of records, counting a record that spans lines once.</summary>
+    public long RecordCount => LineCount - _continuationLines.Count;
+
+    /// <summary>Most fields on any line.</summary>
+    public int ColumnCount { get; private set; }
+
+    /// <summary>Whether some quoted field contains a line break.</summary>
+    public bool HasMultilineRecords => _continuationLines.Count > 0;
+
+    /// <summary>
+    /// The widest value, in characters, of each of the first
+    /// <see cref="MaxTrackedColumns"/> columns over the whole document.
+    /// </summary>
+    public IReadOnlyList<int> ColumnWidths => _columnWidths;
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Building
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Builds the index of <paramref name="document"/>.
+    /// </summary>
+    /// <param name="document">The document to index; it must not change during the build.</param>
+    /// <param name="dialect">How lines are split into fields.</param>
+    /// <param name="progress">Receives the percentage of the document scanned.</param>
+    /// <param name="cancellationToken">Cancels the build between batches of blocks.</param>
+    /// <exception cref="OperationCanceledException">The build was cancelled.</exception>
+    public static CsvFieldIndex Build(PieceTable document, CsvDialect dialect, IProgress<int>? progress = null,
+        CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+        ArgumentNullException.ThrowIfNull(dialect);
+
+        long length = document.Length;
+        var index = new CsvFieldIndex(dialect, length);
+        var scans = new BlockScan[Environment.ProcessorCount];
+        for (int i = 0; i < scans.Length; i++)
+            scans[i] = new BlockScan(dialect);
+
+        var options = new ParallelOptions { CancellationToken = cancellationToken };
+        using var windows = LineWindows.Enumerate(document, 0, length, cancellationToken).GetEnumerator();
+        bool inQuotes = false;
+        bool more = true;
+        int lastPercent = -1;
+        while (more)
+        {
+            // Reads stay on this thread; only the scanning runs in parallel.
+            int count = 0;
+            while (count < scans.Length && (more = windows.MoveNext()))
+            {
+                var (offset, text) = windows.Current;
+                scans[count++].Load(offset, text);
+            }
+            if (count == 0) break;
+
+            Parallel.For(0, count, options, i => scans[i].Scan(startsInQuotes: false));
+            for (int i = 0; i < count; i++)
+            {
+                if (inQuotes)
+                    scans[i].Scan(startsInQuotes: true);
+                index.Add(scans[i]);
+                inQuotes = scans[i].EndsInQuotes;
+            }
+
+            long done = scans[count - 1].Offset + scans[count - 1].Length;
+            LineWindows.Report(progress, (int)(done * 100 / Math.Max(length, 1)), ref lastPercent);
+        }
+
+        return index;
+    }
+
+    private void Add(BlockScan scan)
+    {
+        long firstLine = LineCount;
+        foreach (int line in scan.ContinuationLines)
+            _continuationLines.Add(firstLine + line);
+
+        int[] widths = scan.Widths[..Math.Min(scan.ColumnCount, MaxTrackedColumns)];
+        _blocks.Add(new Block(scan.Offset, firstLine, widths));
+        LineCount += scan.LineCount;
+        ColumnCount = Math.Max(ColumnCount, scan.ColumnCount);
+
+        if (widths.Length > _columnWidths.Length)
+            Array.Resize(ref _columnWidths, widths.Length);
+        for (int c = 0; c < widths.Length; c++)
+            _columnWidths[c] = Math.Max(_columnWidths[c], widths[c]);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Queries
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>Whether <paramref name="line"/> continues a quoted field from the line before it.</summary>
+    public bool StartsInQuotes(long line) => _continuationLines.BinarySearch(line) >= 0;
+
+    /// <summary>
+    /// Returns the line on which record <paramref name="record"/>
+    /// (zero-based) starts.
+    /// </summary>
+    public long GetRecordLine(long record)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegative(record);
+        ArgumentOutOfRangeException.ThrowIfGreaterThanOrEqual(record, RecordCount);
+
+        // The record starts on the line whose number, less the continuation
+        // lines before it, is the record number.  Iterating converges in a
+        // few steps since continuation lines are sparse.
+        long line = record;
+        while (true)
+        {
+            long next = record + CountContinuationLinesUpTo(line);
+            if (next == line) break;
+            line = next;
+        }
+        while (StartsInQuotes(line))
+            line++;
+        return line;
+    }
+
+    /// <summary>Returns the number of lines of record <paramref name="record"/>.</summary>
+    public int GetRecordLineCount(long record)
+    {
+        long line = GetRecordLine(record);
+        long end = line + 1;
+        while (end < LineCount && StartsInQuotes(end))
+            end++;
+        return (int)Math.Min(end - line, int.MaxValue);
+    }
+
+    /// <summary>
+    /// Returns the widest value of each column on the lines from
+    /// <paramref name="firstLine"/> to <paramref name="lastLine"/>, taken
+    /// from the blocks that hold them, for aligning just the visible rows.
+    /// </summary>
+    public int[] GetColumnWidths(long firstLine, long lastLine)
+    {
+        var widths = new int[_columnWidths.Length];
+        for (int b = FindBlock(firstLine); b < _blocks.Count && _blocks[b].FirstLine <= lastLine; b++)
+        {
+            int[] blockWidths = _blocks[b].Widths;
+            for (int c = 0; c < blockWidths.Length; c++)
+                widths[c] = Math.Max(widths[c], blockWidths[c]);
+        }
+        return widths;
+    }
+
+    /// <summary>
+    /// Reads record <paramref name="record"/> from <paramref name="document"/>
+    /// and returns the values of its fields.
+    /// </summary>
+    /// <param name="document">The document the index was built from.</param>
+    /// <param name="record">Zero-based record number.</param>
+    public string[] ReadRecord(PieceTable document, long record)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        long line = GetRecordLine(record);
+        int lineCount = GetRecordLineCount(record);
+        var fields = new List<string>();
+        var ranges = new List<Range>();
+        bool inQuotes = false;
+        string pending = string.Empty;
+        for (int i = 0; i < lineCount; i++)
+        {
+            string text = document.GetLine(line + i).TrimEnd('\r');
+            ranges.Clear();
+            bool startsInQuotes = inQuotes;
+            inQuotes = Dialect.SplitFields(text, startsInQuotes, ranges);
+
+            for (int f = 0; f < ranges.Count; f++)
+            {
+                string raw = text[ranges[f]];
+                if (f == 0 && startsInQuotes)
+                    raw = pending + "\n" + raw;
+                if (f == ranges.Count - 1 && inQuotes)
+                    pending = raw;
+                else
+                    fields.Add(Dialect.Unquote(raw));
+            }
+        }
+        if (inQuotes)
+            fields.Add(Dialect.Unquote(pending));
+        return [.. fields];
+    }
+
+    private int CountContinuationLinesUpTo(long line)
+    {
+        int i = _continuationLines.BinarySearch(line);
+        return i >= 0 ? i + 1 : ~i;
+    }
+
+    /// <summary>Index of the block that holds <paramref name="line"/>.</summary>
+    private int FindBlock(long line)
+    {
+        int lo = 0, hi = _blocks.Count - 1;
+        while (lo < hi)
+        {
+            int mid = (lo + hi + 1) >>> 1;
+            if (_blocks[mid].FirstLine <= line) lo = mid;
+            else hi = mid - 1;
+        }
+        return lo;
+    }
+
+    /// <summary>A block of whole lines and the widest value of each of its columns.</summary>
+    private readonly record struct Block(long Offset, long FirstLine, int[] Widths);
+
+    /// <summary>One block of the document and the result of scanning it.</summary>
+    private sealed class BlockScan(CsvDialect dialect)
+    {
+        private readonly List<Range> _fields = [];
+        private ReadOnlyMemory<char> _text;
+
+        public long Offset { get; private set; }
+        public int Length => _text.Length;
+        public int LineCount { get; private set; }
+        public int ColumnCount { get; private set; }
+        public int[] Widths { get; private set; } = new int[16];
+        public bool EndsInQuotes { get; private set; }
+
+        /// <summary>Block-relative numbers of lines that start inside a quoted field.</summary>
+        public List<int> ContinuationLines { get; } = [];
+
+        public void Load(long offset, ReadOnlyMemory<char> text)
+        {
+            Offset = offset;
+            _text = text;
+        }
+
+        public void Scan(bool startsInQuotes)
+        {
+            LineCount = 0;
+            ColumnCount = 0;
+            Array.Clear(Widths);
+            ContinuationLines.Clear();
+
+            ReadOnlySpan<char> text = _text.Span;
+            bool inQuotes = startsInQuotes;
+            foreach (Range range in new CsvDialect.LineRanges(text))
+            {
+                ReadOnlySpan<char> line = text[range];
+                if (inQuotes)
+                    ContinuationLines.Add(LineCount);
+                LineCount++;
+
+                _fields.Clear();
+                bool lineStartsInQuotes = inQuotes;
+                inQuotes = dialect.SplitFields(line, inQuotes, _fields);
+
+                // The fields of a continuation line belong to columns of an
+                // earlier line, so they do not count toward the widths.
+                if (lineStartsInQuotes) continue;
+
+                ColumnCount = Math.Max(ColumnCount, _fields.Count);
+                if (_fields.Count > Widths.Length && Widths.Length < MaxTrackedColumns)
+                {
+                    int[] grown = new int[Math.Min(Math.Max(_fields.Count, Widths.Length * 2), MaxTrackedColumns)];
+                    Widths.CopyTo(grown, 0);
+                    Widths = grown;
+                }
+
+                int tracked = Math.Min(_fields.Count, Widths.Length);
+                for (int f = 0; f < tracked; f++)
+                {
+                    var (start, length) = _fields[f].GetOffsetAndLength(line.Length);
+                    if (length >= 2 && line[start] == dialect.Quote)
+                        length -= 2;
+                    Widths[f] = Math.Max(Widths[f], Math.Min(length, MaxTrackedWidth));
+                }
+            }
+            EndsInQuotes = inQuotes;
+        }
+    }
+}
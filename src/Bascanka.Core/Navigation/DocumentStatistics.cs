@@ -0,0 +1,278 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Transforms;
+
+namespace Bascanka.Core.Navigation;
+
+/// <summary>
+/// The <see cref="TextStatistics"/> of a document, kept per chunk of about
+/// 1M characters of whole lines so that the totals of a document of any
+/// size stay exact through edits at the cost of a few counts per chunk.
+/// </summary>
+/// <remarks>
+/// <para>
+/// <see cref="CountRemaining"/> reads chunks in order and counts them in
+/// parallel, continuing from where the counts end.  <see cref="Update"/>
+/// applies an edit by counting again only the chunks the edit touched.
+/// <see cref="GetRange"/> counts a range, such as a selection, from the
+/// chunks inside it and reads only the text at its two ends.
+/// </para>
+/// <para>
+/// Queries may run on any thread while a count is in progress; counts and
+/// updates must not run at the same time.
+/// </para>
+/// </remarks>
+public sealed class DocumentStatistics
+{
+    private readonly object _lock = new();
+    private readonly List<Chunk> _chunks = [];
+    private TextStatistics _total;
+
+    /// <summary>Creates empty statistics.</summary>
+    /// <param name="encoding">
+    /// The encoding of <see cref="TextStatistics.EncodedBytes"/>, usually
+    /// the document's; UTF-8 when <see langword="null"/>.
+    /// </param>
+    public DocumentStatistics(System.Text.Encoding? encoding = null)
+    {
+        Encoding = encoding ?? new System.Text.UTF8Encoding(false);
+    }
+
+    /// <summary>The encoding of <see cref="TextStatistics.EncodedBytes"/>.</summary>
+    public System.Text.Encoding Encoding { get; }
+
+    /// <summary>Characters of the document counted so far, from its start.</summary>
+    public long CountedLength
+    {
+        get
+        {
+            lock (_lock)
+                return _chunks.Count > 0 ? _chunks[^1].End : 0;
+        }
+    }
+
+    /// <summary>The counts of the text counted so far.</summary>
+    public TextStatistics Total
+    {
+        get
+        {
+            lock (_lock)
+                return _total;
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Counting
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Counts <paramref name="document"/> from the end of the counted text
+    /// to the end of the document.
+    /// </summary>
+    /// <param name="document">
+    /// The document to read, usually a snapshot; it must not change during
+    /// the count, and must start with the text already counted.
+    /// </param>
+    /// <param name="progress">Receives the percentage of the document counted.</param>
+    /// <param name="cancellationToken">Cancels the count between batches of chunks.</param>
+    /// <exception cref="OperationCanceledException">The count was cancelled.</exception>
+    public void CountRemaining(PieceTable document, IProgress<int>? progress = null,
+        CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        long start;
+        lock (_lock)
+        {
+            // A last chunk without a final line break may have a longer last
+            // line now, so it is counted again.
+            if (_chunks.Count > 0 && !_chunks[^1].EndsWithLineBreak)
+            {
+                _chunks.RemoveAt(_chunks.Count - 1);
+                _total = Sum(_chunks);
+            }
+            start = _chunks.Count > 0 ? _chunks[^1].End : 0;
+        }
+
+        long length = document.Length;
+        int lastPercent = -1;
+        foreach (List<Chunk> batch in Scan(document, start, length - start, cancellationToken))
+        {
+            lock (_lock)
+            {
+                _chunks.AddRange(batch);
+                foreach (Chunk chunk in batch)
+                    _total += chunk.Statistics;
+            }
+            LineWindows.Report(progress, (int)(batch[^1].End * 100 / Math.Max(length, 1)), ref lastPercent);
+        }
+    }
+
+    /// <summary>
+    /// Brings the counts up to date with an edit of <paramref name="document"/>
+    /// by counting again the chunks the edit touched.
+    /// </summary>
+    /// <param name="document">The document after the edit.</param>
+    /// <param name="offset">Where the edit starts.</param>
+    /// <param name="oldLength">Characters the edit removed.</param>
+    /// <param name="newLength">Characters the edit inserted.</param>
+    public void Update(PieceTable document, long offset, long oldLength, long newLength)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        lock (_lock)
+        {
+            long oldEnd = offset + oldLength;
+            long countedEnd = _chunks.Count > 0 ? _chunks[^1].End : 0;
+            if (offset > countedEnd) return;  // Beyond the counts; a count will reach it.
+
+            // The first chunk the edit touches: one that contains the edit
+            // start, or ends there without a line break.
+            int first = 0;
+            while (first < _chunks.Count && _chunks[first].End < offset)
+                first++;
+            if (first < _chunks.Count && _chunks[first].End == offset && _chunks[first].EndsWithLineBreak)
+                first++;
+
+            // The last chunk the edit touches, including one that starts right
+            // at the end of a removal, whose first line may have joined the
+            // line before it.
+            int last = first - 1;
+            while (last + 1 < _chunks.Count && _chunks[last + 1].Offset <= oldEnd)
+                last++;
+
+            long start = first < _chunks.Count ? _chunks[first].Offset : countedEnd;
+            long end = Math.Max(last >= first ? _chunks[last].End : start, oldEnd);
+            long delta = newLength - oldLength;
+
+            var replacement = new List<Chunk>();
+            foreach (List<Chunk> batch in Scan(document, start, end + delta - start, CancellationToken.None))
+                replacement.AddRange(batch);
+
+            for (int i = last + 1; i < _chunks.Count; i++)
+                _chunks[i] = _chunks[i] with { Offset = _chunks[i].Offset + delta };
+            _chunks.RemoveRange(first, last - first + 1);
+            _chunks.InsertRange(first, replacement);
+            _total = Sum(_chunks);
+        }
+    }
+
+    /// <summary>Drops all counts, for a document that was replaced.</summary>
+    public void Clear()
+    {
+        lock (_lock)
+        {
+            _chunks.Clear();
+            _total = default;
+        }
+    }
+
+    /// <summary>
+    /// Counts <paramref name="length"/> characters of
+    /// <paramref name="document"/> from <paramref name="start"/>, the first
+    /// line of the range counting from <paramref name="start"/>.
+    /// </summary>
+    /// <param name="document">The document the counts describe, as it is now.</param>
+    public TextStatistics GetRange(PieceTable document, long start, long length)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        long end = start + length;
+        int first, last;
+        TextStatistics inner = default;
+        long innerStart, innerEnd;
+        lock (_lock)
+        {
+            // The chunks that lie wholly inside the range.
+            first = LowerBound(start);
+            last = first - 1;
+            while (last + 1 < _chunks.Count && _chunks[last + 1].End <= end)
+                last++;
+            if (last < first)
+                return CountText(document, start, length);
+
+            for (int i = first; i <= last; i++)
+                inner += _chunks[i].Statistics;
+            innerStart = _chunks[first].Offset;
+            innerEnd = _chunks[last].End;
+        }
+
+        // Chunks start at line starts, so the three parts add up.
+        return CountText(document, start, innerStart - start)
+            + inner
+            + CountText(document, innerEnd, end - innerEnd);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Scanning
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Reads the range in windows of whole lines and counts the windows of
+    /// each batch in parallel, yielding the batches in order.
+    /// </summary>
+    private IEnumerable<List<Chunk>> Scan(PieceTable document, long start, long length,
+        CancellationToken cancellationToken)
+    {
+        var options = new ParallelOptions { CancellationToken = cancellationToken };
+        var windows = new List<(long Offset, ReadOnlyMemory<char> Text)>(Environment.ProcessorCount);
+        using var enumerator = LineWindows.Enumerate(document, start, length, cancellationToken).GetEnumerator();
+        bool more = true;
+        while (more)
+        {
+            windows.Clear();
+            while (windows.Count < Environment.ProcessorCount && (more = enumerator.MoveNext()))
+                windows.Add(enumerator.Current);
+            if (windows.Count == 0) yield break;
+
+            var chunks = new Chunk[windows.Count];
+            Parallel.For(0, windows.Count, options, i =>
+            {
+                ReadOnlySpan<char> text = windows[i].Text.Span;
+                chunks[i] = new Chunk(windows[i].Offset, text.Length, TextStatistics.Count(text, Encoding),
+                    text.Length > 0 && text[^1] == '\n');
+            });
+            yield return [.. chunks];
+        }
+    }
+
+    private TextStatistics CountText(PieceTable document, long start, long length)
+    {
+        TextStatistics total = default;
+        foreach (var (_, text) in LineWindows.Enumerate(document, start, length, CancellationToken.None))
+            total += TextStatistics.Count(text.Span, Encoding);
+        return total;
+    }
+
+    /// <summary>Index of the first chunk that starts at or after <paramref name="offset"/>.</summary>
+    private int LowerBound(long offset)
+    {
+        int lo = 0, hi = _chunks.Count;
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            if (_chunks[mid].Offset < offset)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    private static TextStatistics Sum(List<Chunk> chunks)
+    {
+        TextStatistics total = default;
+        foreach (Chunk chunk in chunks)
+            total += chunk.Statistics;
+        return total;
+    }
+
+    /// <summary>A chunk of whole lines and its counts.</summary>
+    /// <param name="Offset">Where the chunk starts in the document.</param>
+    /// <param name="Length">Characters in the chunk.</param>
+    /// <param name="Statistics">The chunk's counts.</param>
+    /// <param name="EndsWithLineBreak">Whether the chunk ends with a line feed.</param>
+    private readonly record struct Chunk(long Offset, int Length, TextStatistics Statistics, bool EndsWithLineBreak)
+    {
+        public long End => Offset + Length;
+    }
+}
@@ -0,0 +1,23 @@
+namespace Bascanka.Core.Navigation;
+
+/// <summary>
+/// One object or array recorded by a <see cref="JsonStructureIndex"/>.
+/// </summary>
+/// <param name="Index">Position of the container in document order.</param>
+/// <param name="Start">Offset of the opening <c>{</c> or <c>[</c>.</param>
+/// <param name="End">
+/// Offset of the closing <c>}</c> or <c>]</c>, or <c>-1</c> when the
+/// document ends before the container is closed.
+/// </param>
+/// <param name="Parent">Index of the enclosing container, or <c>-1</c> at the top level.</param>
+/// <param name="Ordinal">
+/// Position of the container among the members of its parent (the array
+/// index, or the number of members before it in an object), or among the
+/// top-level values.
+/// </param>
+/// <param name="IsObject">Whether the container is an object rather than an array.</param>
+public readonly record struct JsonContainer(int Index, long Start, long End, int Parent, int Ordinal, bool IsObject)
+{
+    /// <summary>Whether the container was closed.</summary>
+    public bool IsClosed => End >= 0;
+}
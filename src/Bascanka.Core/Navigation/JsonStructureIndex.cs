@@ -0,0 +1,650 @@
+using System.Buffers;
+using System.Text;
+using System.Text.Json;
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Navigation;
+
+/// <summary>
+/// A structural index of a JSON document: the opening and closing offsets
+/// of every object and array, in document order, with each container's
+/// parent and its position within that parent.  Once built, bracket
+/// matching, the innermost container at an offset and the path to it are
+/// answered by binary search instead of by scanning text.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The document is read in 1M-character chunks that are scanned in
+/// parallel.  A scan cannot know whether its chunk starts inside a string,
+/// so it records every bracket and comma together with whether it would be
+/// inside a string if the chunk started outside one; the odd or even
+/// number of quotes in the chunk says which case applies to the next one.
+/// Stitching the chunks in order then keeps the structural characters and
+/// discards those in strings.  A chunk that starts just after a backslash
+/// is scanned again when the escape changes its result.
+/// </para>
+/// <para>
+/// The index is lenient: it does not validate the document, unbalanced
+/// closing brackets are ignored and containers still open at the end of
+/// the document have an <see cref="JsonContainer.End"/> of <c>-1</c>.  It
+/// describes the text it was built from and must be rebuilt after an edit.
+/// </para>
+/// <para>Instances are immutable once built and may be queried from any thread.</para>
+/// </remarks>
+public sealed class JsonStructureIndex
+{
+    /// <summary>Characters scanned per chunk.</summary>
+    private const int ChunkSize = 1024 * 1024;
+
+    /// <summary>Keys longer than this are not shown in paths.</summary>
+    private const int MaxKeyLength = 4096;
+
+    private static readonly SearchValues<char> Specials = SearchValues.Create("{}[],\"\\");
+
+    private long[] _starts = new long[256];
+    private long[] _ends = new long[256];
+    private int[] _parents = new int[256];
+    private int[] _ordinals = new int[256];
+    private bool[] _isObject = new bool[256];
+    private int _count;
+
+    private JsonStructureIndex(long documentLength)
+    {
+        DocumentLength = documentLength;
+    }
+
+    /// <summary>Length of the document the index was built from.</summary>
+    public long DocumentLength { get; }
+
+    /// <summary>Number of objects and arrays in the document.</summary>
+    public int Count => _count;
+
+    /// <summary>Returns the container at <paramref name="index"/> in document order.</summary>
+    public JsonContainer this[int index]
+    {
+        get
+        {
+            ArgumentOutOfRangeException.ThrowIfNegative(index);
+            ArgumentOutOfRangeException.ThrowIfGreaterThanOrEqual(index, _count);
+            return new JsonContainer(index, _starts[index], _ends[index], _parents[index],
+                _ordinals[index], _isObject[index]);
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Building
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Builds the index of <paramref name="document"/>.
+    /// </summary>
+    /// <param name="document">The document to index; it must not change during the build.</param>
+    /// <param name="progress">Receives the percentage of the document scanned.</param>
+    /// <param name="cancellationToken">Cancels the build between batches of chunks.</param>
+    /// <exception cref="OperationCanceledException">The build was cancelled.</exception>
+    public static JsonStructureIndex Build(PieceTable document, IProgress<int>? progress = null,
+        CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        long length = document.Length;
+        var index = new JsonStructureIndex(length);
+        var builder = new Builder(index);
+        var chunks = new ChunkScan[Environment.ProcessorCount];
+        for (int i = 0; i < chunks.Length; i++)
+            chunks[i] = new ChunkScan();
+
+        var options = new ParallelOptions { CancellationToken = cancellationToken };
+        int lastPercent = -1;
+        long offset = 0;
+        while (offset < length)
+        {
+            cancellationToken.ThrowIfCancellationRequested();
+
+            // Reads stay on this thread; only the scanning runs in parallel.
+            int count = 0;
+            for (; count < chunks.Length && offset < length; count++)
+            {
+                int take = (int)Math.Min(ChunkSize, length - offset);
+                chunks[count].Load(document, offset, take);
+                offset += take;
+            }
+
+            Parallel.For(0, count, options, i => chunks[i].Scan(escaped: false));
+            for (int i = 0; i < count; i++)
+                builder.Add(chunks[i]);
+
+            int percent = (int)(offset * 100 / length);
+            if (percent != lastPercent)
+            {
+                lastPercent = percent;
+                progress?.Report(percent);
+            }
+        }
+
+        return index;
+    }
+
+    private int Append(long start, int parent, int ordinal, bool isObject)
+    {
+        if (_count == _starts.Length)
+        {
+            int size = (int)Math.Min((long)_count * 2, Array.MaxLength);
+            Array.Resize(ref _starts, size);
+            Array.Resize(ref _ends, size);
+            Array.Resize(ref _parents, size);
+            Array.Resize(ref _ordinals, size);
+            Array.Resize(ref _isObject, size);
+        }
+
+        _starts[_count] = start;
+        _ends[_count] = -1;
+        _parents[_count] = parent;
+        _ordinals[_count] = ordinal;
+        _isObject[_count] = isObject;
+        return _count++;
+    }
+
+    /// <summary>A bracket or comma found by a chunk scan.</summary>
+    /// <param name="InString">
+    /// Whether the character is inside a string, assuming the chunk starts
+    /// outside one.
+    /// </param>
+    private readonly record struct StructuralChar(int Position, char Char, bool InString);
+
+    /// <summary>One chunk of the document and the result of scanning it.</summary>
+    private sealed class ChunkScan
+    {
+        private char[] _text = [];
+
+        public long Offset { get; private set; }
+        public int Length { get; private set; }
+        public List<StructuralChar> Found { get; } = [];
+
+        /// <summary>Whether the chunk has an odd number of unescaped quotes.</summary>
+        public bool TogglesString { get; private set; }
+
+        /// <summary>Whether the chunk ends with a backslash that escapes the next chunk's first character.</summary>
+        public bool EndsEscaped { get; private set; }
+
+        /// <summary>
+        /// Whether an escape carried in from the previous chunk changes this
+        /// scan: it does only when the first character is a quote or a
+        /// backslash.
+        /// </summary>
+        public bool DependsOnEscape => Length > 0 && _text[0] is '"' or '\\';
+
+        public void Load(PieceTable document, long offset, int length)
+        {
+            if (_text.Length < length)
+                _text = new char[length];
+            document.CopyTo(offset, _text.AsSpan(0, length));
+            Offset = offset;
+            Length = length;
+        }
+
+        public void Scan(bool escaped)
+        {
+            Found.Clear();
+            EndsEscaped = false;
+
+            ReadOnlySpan<char> text = _text.AsSpan(0, Length);
+            bool inString = false;
+            int i = escaped ? 1 : 0;
+            while (i < text.Length)
+            {
+                int next = text[i..].IndexOfAny(Specials);
+                if (next < 0) break;
+                i += next;
+
+                char c = text[i];
+                if (c == '\\')
+                {
+                    EndsEscaped = i + 1 == text.Length;
+                    i += 2;
+                    continue;
+                }
+
+                if (c == '"')
+                    inString = !inString;
+                else
+                    Found.Add(new StructuralChar(i, c, inString));
+                i++;
+            }
+
+            TogglesString = inString;
+        }
+    }
+
+    /// <summary>Stitches chunk scans, in document order, into the index.</summary>
+    private sealed class Builder(JsonStructureIndex index)
+    {
+        private readonly List<int> _open = [];
+        private readonly List<int> _members = [];
+        private int _topLevel;
+        private bool _inString;
+        private bool _escaped;
+
+        public void Add(ChunkScan chunk)
+        {
+            if (_escaped && chunk.DependsOnEscape)
+                chunk.Scan(escaped: true);
+
+            foreach (var found in chunk.Found)
+            {
+                if (found.InString != _inString)
+                    continue;
+
+                long position = chunk.Offset + found.Position;
+                switch (found.Char)
+                {
+                    case '{' or '[':
+                        int parent = _open.Count > 0 ? _open[^1] : -1;
+                        int ordinal = parent >= 0 ? _members[^1] : _topLevel++;
+                        _open.Add(index.Append(position, parent, ordinal, found.Char == '{'));
+                        _members.Add(0);
+                        break;
+
+                    case '}' or ']':
+                        if (_open.Count > 0)
+                        {
+                            index._ends[_open[^1]] = position;
+                            _open.RemoveAt(_open.Count - 1);
+                            _members.RemoveAt(_members.Count - 1);
+                        }
+                        break;
+
+                    default:
+                        if (_members.Count > 0)
+                            _members[^1]++;
+                        break;
+                }
+            }
+
+            _inString ^= chunk.TogglesString;
+            _escaped = chunk.EndsEscaped;
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Queries
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Returns the index of the innermost container whose brackets enclose
+    /// or are at <paramref name="offset"/>, or <c>-1</c> when the offset is
+    /// outside every container.
+    /// </summary>
+    public int FindInnermost(long offset)
+    {
+        int i = LastStartAtOrBefore(offset);
+        while (i >= 0 && _ends[i] >= 0 && _ends[i] < offset)
+            i = _parents[i];
+        return i;
+    }
+
+    /// <summary>
+    /// When <paramref name="offset"/> is at the opening or closing bracket
+    /// of a closed container, returns the offsets of both brackets.
+    /// </summary>
+    public (long Open, long Close)? FindMatchingBracket(long offset)
+    {
+        int i = FindInnermost(offset);
+        if (i < 0 || _ends[i] < 0 || (offset != _starts[i] && offset != _ends[i]))
+            return null;
+        return (_starts[i], _ends[i]);
+    }
+
+    /// <summary>
+    /// Returns the deepest nesting level such that the containers at that
+    /// level and above number at most <paramref name="maxCount"/>, or
+    /// <c>-1</c> when even the top-level containers are too many.
+    /// Top-level containers are at level 0.
+    /// </summary>
+    public int GetMaxDepthWithin(int maxCount)
+    {
+        var perDepth = new List<int>();
+        foreach (var (_, depth) in EnumerateWithDepth())
+        {
+            while (perDepth.Count <= depth)
+                perDepth.Add(0);
+            perDepth[depth]++;
+        }
+
+        long total = 0;
+        for (int depth = 0; depth < perDepth.Count; depth++)
+        {
+            total += perDepth[depth];
+            if (total > maxCount)
+                return depth - 1;
+        }
+        return perDepth.Count - 1;
+    }
+
+    /// <summary>
+    /// Enumerates, in document order, the containers nested at most
+    /// <paramref name="maxDepth"/> levels deep.
+    /// </summary>
+    public IEnumerable<JsonContainer> EnumerateToDepth(int maxDepth)
+    {
+        foreach (var (i, depth) in EnumerateWithDepth())
+        {
+            if (depth <= maxDepth)
+                yield return this[i];
+        }
+    }
+
+    private IEnumerable<(int Index, int Depth)> EnumerateWithDepth()
+    {
+        // Containers are in document order, so the ancestors of each one
+        // are exactly the open containers left on the stack.
+        var ancestors = new List<int>();
+        for (int i = 0; i < _count; i++)
+        {
+            while (ancestors.Count > 0 && ancestors[^1] != _parents[i])
+                ancestors.RemoveAt(ancestors.Count - 1);
+            yield return (i, ancestors.Count);
+            ancestors.Add(i);
+        }
+    }
+
+    private int LastStartAtOrBefore(long offset)
+    {
+        int i = Array.BinarySearch(_starts, 0, _count, offset);
+        return i >= 0 ? i : ~i - 1;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Paths
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Returns the path of the innermost container at
+    /// <paramref name="offset"/>, such as <c>$.store.book[3]</c>, or an
+    /// empty string outside every container.  Member names are read from
+    /// <paramref name="document"/>, which must be the indexed text.
+    /// </summary>
+    public string GetPath(long offset, PieceTable document)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        int i = FindInnermost(offset);
+        if (i < 0) return string.Empty;
+
+        var segments = new List<string>();
+        for (; _parents[i] >= 0; i = _parents[i])
+        {
+            if (!_isObject[_parents[i]])
+                segments.Add($"[{_ordinals[i]}]");
+            else
+                segments.Add(FormatKey(ReadKeyBefore(document, _starts[i]) ?? "?"));
+        }
+
+        segments.Reverse();
+        return "$" + string.Concat(segments);
+    }
+
+    /// <summary>
+    /// Finds the value at <paramref name="path"/> in the first top-level
+    /// value and returns its offset, or <c>-1</c> when there is no such
+    /// value.  Paths are written as in <see cref="GetPath"/>:
+    /// <c>$.name</c>, <c>$['name']</c> and <c>$[index]</c>, and the
+    /// leading <c>$</c> may be left out.
+    /// </summary>
+    /// <exception cref="FormatException">The path is malformed.</exception>
+    public long FindPath(string path, PieceTable document)
+    {
+        ArgumentNullException.ThrowIfNull(path);
+        ArgumentNullException.ThrowIfNull(document);
+
+        var segments = ParsePath(path);
+        if (_count == 0) return -1;
+
+        int container = 0;
+        long value = _starts[0];
+        foreach (var segment in segments)
+        {
+            if (container < 0 || _isObject[container] != (segment.Key is not null))
+                return -1;
+
+            value = FindMember(document, container, segment);
+            if (value < 0) return -1;
+
+            int child = Array.BinarySearch(_starts, 0, _count, value);
+            container = child >= 0 ? child : -1;
+        }
+        return value;
+    }
+
+    /// <summary>A member name, or an array index when <c>Key</c> is <see langword="null"/>.</summary>
+    private readonly record struct PathSegment(string? Key, int Index);
+
+    private static List<PathSegment> ParsePath(string path)
+    {
+        var segments = new List<PathSegment>();
+        int i = path.StartsWith('$') ? 1 : 0;
+        while (i < path.Length)
+        {
+            if (path[i] == '[')
+            {
+                i++;
+                if (i < path.Length && path[i] is '\'' or '"')
+                {
+                    char quote = path[i++];
+                    var key = new StringBuilder();
+                    while (i < path.Length && path[i] != quote)
+                    {
+                        if (path[i] == '\\' && i + 1 < path.Length)
+                            i++;
+                        key.Append(path[i++]);
+                    }
+                    if (i + 1 >= path.Length || path[i + 1] != ']')
+                        throw new FormatException($"Unterminated member name in '{path}'.");
+                    segments.Add(new PathSegment(key.ToString(), 0));
+                    i += 2;
+                }
+                else
+                {
+                    int close = path.IndexOf(']', i);
+                    if (close < 0 || !int.TryParse(path.AsSpan(i, close - i), out int index) || index < 0)
+                        throw new FormatException($"Invalid array index in '{path}'.");
+                    segments.Add(new PathSegment(null, index));
+                    i = close + 1;
+                }
+            }
+            else
+            {
+                if (path[i] == '.')
+                    i++;
+                else if (i > 0 && path[i - 1] != '$')
+                    throw new FormatException($"Unexpected '{path[i]}' in '{path}'.");
+
+                int end = path.IndexOfAny(['.', '['], i);
+                if (end < 0) end = path.Length;
+                if (end == i)
+                    throw new FormatException($"Empty member name in '{path}'.");
+                segments.Add(new PathSegment(path[i..end], 0));
+                i = end;
+            }
+        }
+        return segments;
+    }
+
+    /// <summary>
+    /// Walks the members of <paramref name="container"/>, jumping over
+    /// nested containers by their recorded ends, and returns the offset of
+    /// the value that <paramref name="segment"/> names, or <c>-1</c>.
+    /// </summary>
+    private long FindMember(PieceTable document, int container, PathSegment segment)
+    {
+        long end = _ends[container] >= 0 ? _ends[container] : document.Length;
+        var cursor = new TextCursor(document, _starts[container] + 1, end);
+        bool isObject = _isObject[container];
+
+        for (int ordinal = 0; ; ordinal++)
+        {
+            cursor.SkipWhitespace();
+            if (cursor.AtEnd) return -1;
+
+            string? key = null;
+            if (isObject)
+            {
+                if (cursor.Peek() != '"') return -1;
+                key = Unescape(cursor.ReadString());
+                cursor.SkipWhitespace();
+                if (cursor.AtEnd || cursor.Peek() != ':') return -1;
+                cursor.Advance();
+                cursor.SkipWhitespace();
+                if (cursor.AtEnd) return -1;
+            }
+
+            long value = cursor.Position;
+            if (isObject ? key == segment.Key : ordinal == segment.Index)
+                return value;
+
+            char first = cursor.Peek();
+            if (first is '{' or '[')
+            {
+                int child = Array.BinarySearch(_starts, 0, _count, value);
+                if (child < 0 || _ends[child] < 0) return -1;
+                cursor.Seek(_ends[child] + 1);
+            }
+            else if (first == '"')
+            {
+                cursor.ReadString();
+            }
+            else
+            {
+                cursor.SkipScalar();
+            }
+
+            cursor.SkipWhitespace();
+            if (cursor.AtEnd || cursor.Peek() != ',') return -1;
+            cursor.Advance();
+        }
+    }
+
+    /// <summary>
+    /// Reads the member name in front of the value at
+    /// <paramref name="valueStart"/>: <c>"name" :</c>.
+    /// </summary>
+    private static string? ReadKeyBefore(PieceTable document, long valueStart)
+    {
+        long p = SkipWhitespaceBackward(document, valueStart - 1);
+        if (p < 0 || document.GetCharAt(p) != ':') return null;
+        p = SkipWhitespaceBackward(document, p - 1);
+        if (p < 0 || document.GetCharAt(p) != '"') return null;
+
+        long from = Math.Max(0, p - MaxKeyLength);
+        string text = document.GetText(from, p - from);
+        for (int j = text.Length - 1; j >= 0; j--)
+        {
+            if (text[j] != '"') continue;
+
+            int backslashes = 0;
+            while (j - 1 - backslashes >= 0 && text[j - 1 - backslashes] == '\\')
+                backslashes++;
+            if (backslashes % 2 == 0)
+                return Unescape(text[(j + 1)..]);
+        }
+        return null;
+    }
+
+    private static long SkipWhitespaceBackward(PieceTable document, long p)
+    {
+        while (p >= 0 && document.GetCharAt(p) is ' ' or '\t' or '\r' or '\n')
+            p--;
+        return p;
+    }
+
+    /// <summary>Decodes the escapes in the text between a string's quotes.</summary>
+    private static string Unescape(string raw)
+    {
+        if (!raw.Contains('\\')) return raw;
+        try
+        {
+            return JsonSerializer.Deserialize<string>("\"" + raw + "\"") ?? raw;
+        }
+        catch (JsonException)
+        {
+            return raw;
+        }
+    }
+
+    private static string FormatKey(string key)
+    {
+        bool identifier = key.Length > 0 && !char.IsDigit(key[0]);
+        foreach (char c in key)
+        {
+            if (!char.IsLetterOrDigit(c) && c is not ('_' or '$'))
+            {
+                identifier = false;
+                break;
+            }
+        }
+
+        return identifier
+            ? "." + key
+            : "['" + key.Replace("\\", "\\\\").Replace("'", "\\'") + "']";
+    }
+
+    /// <summary>Reads a document forward through a small buffer.</summary>
+    private sealed class TextCursor(PieceTable document, long position, long end)
+    {
+        private readonly char[] _buffer = new char[64 * 1024];
+        private long _bufferStart;
+        private int _bufferLength;
+
+        public long Position { get; private set; } = position;
+
+        public bool AtEnd => Position >= end;
+
+        public char Peek()
+        {
+            if (Position < _bufferStart || Position >= _bufferStart + _bufferLength)
+            {
+                _bufferStart = Position;
+                _bufferLength = (int)Math.Min(_buffer.Length, end - Position);
+                document.CopyTo(Position, _buffer.AsSpan(0, _bufferLength));
+            }
+            return _buffer[Position - _bufferStart];
+        }
+
+        public void Advance() => Position++;
+
+        public void Seek(long position) => Position = position;
+
+        public void SkipWhitespace()
+        {
+            while (!AtEnd && Peek() is ' ' or '\t' or '\r' or '\n')
+                Position++;
+        }
+
+        public void SkipScalar()
+        {
+            while (!AtEnd && Peek() is not (',' or '}' or ']' or ' ' or '\t' or '\r' or '\n'))
+                Position++;
+        }
+
+        /// <summary>
+        /// Reads the string at the cursor and returns the raw text between
+        /// its quotes, escapes included.
+        /// </summary>
+        public string ReadString()
+        {
+            var text = new StringBuilder();
+            bool escaped = false;
+            Position++;
+            while (!AtEnd)
+            {
+                char c = Peek();
+                Position++;
+                if (!escaped && c == '"')
+                    break;
+                escaped = !escaped && c == '\\';
+                text.Append(c);
+            }
+            return text.ToString();
+        }
+    }
+}
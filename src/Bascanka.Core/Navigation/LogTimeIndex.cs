@@ -0,0 +1,278 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Navigation;
+
+/// <summary>
+/// A sparse index of the timestamps of a time-ordered log: the timestamp
+/// of one line in every few thousand, enough to find the line at a given
+/// time with a binary search instead of a scan.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Lookups binary-search the samples, then the lines between the two
+/// bracketing samples, reading only the start of each line probed.  Lines
+/// without a timestamp, such as the continuation lines of a stack trace,
+/// belong to the stamped line before them.  Logs written by several
+/// threads are often slightly out of order, so the lines just before the
+/// line found are scanned for an earlier one that already reached the
+/// time.  A lookup thus reads O(log n) line starts plus
+/// <see cref="LocalScanLines"/>, on documents of any size.
+/// </para>
+/// <para>
+/// Time-only and syslog timestamps wrap around at midnight or new year.
+/// Each sample records how many times the clock wrapped before it, counted
+/// whenever a timestamp falls more than half a day (half a year) behind the
+/// previous sample; a probed line takes the count of the sample before it.
+/// Such logs are sampled more densely so that no two samples are a day apart.
+/// </para>
+/// <para>
+/// Line starts come from the document's line-offset cache, which for a
+/// memory-mapped file is built once when the file is opened.  The index
+/// describes the text it was built from and must be rebuilt after an edit.
+/// </para>
+/// </remarks>
+public sealed class LogTimeIndex
+{
+    /// <summary>Lines before a found line that are checked for out-of-order timestamps.</summary>
+    public const int LocalScanLines = 256;
+
+    // At most this many samples, taken at least this many lines apart.
+    private const int MaxSamples = 65536;
+    private const int MinSampleStride = 1024;
+
+    // Unstamped lines skipped when probing before a probe gives up.
+    private const int MaxProbeLines = 4096;
+
+    private readonly long[] _sampleLines;
+    private readonly long[] _sampleTicks;
+    // The timestamps of the samples as written, and the wraps before them.
+    private readonly long[] _sampleStamps;
+    private readonly int[] _sampleWraps;
+
+    private LogTimeIndex(LogTimestampFormat format, long lineCount, long documentLength,
+        long[] sampleLines, long[] sampleTicks, long[] sampleStamps, int[] sampleWraps)
+    {
+        Format = format;
+        LineCount = lineCount;
+        DocumentLength = documentLength;
+        _sampleLines = sampleLines;
+        _sampleTicks = sampleTicks;
+        _sampleStamps = sampleStamps;
+        _sampleWraps = sampleWraps;
+    }
+
+    /// <summary>The format of the timestamps at the start of the lines.</summary>
+    public LogTimestampFormat Format { get; }
+
+    /// <summary>Number of lines of the document the index was built from.</summary>
+    public long LineCount { get; }
+
+    /// <summary>Length of the document the index was built from.</summary>
+    public long DocumentLength { get; }
+
+    /// <summary>The timestamp of the first stamped line.</summary>
+    public long FirstTicks => _sampleTicks[0];
+
+    /// <summary>The latest timestamp among the sampled lines.</summary>
+    public long LastTicks => _sampleTicks[^1];
+
+    /// <summary>
+    /// Builds the index of <paramref name="document"/>, or returns
+    /// <see langword="null"/> when its lines do not start with timestamps.
+    /// </summary>
+    /// <param name="document">The document to index; it must not change during the build.</param>
+    /// <param name="format">The timestamp format, or <see langword="null"/> to detect it from the first lines.</param>
+    /// <param name="progress">Receives the percentage of lines sampled.</param>
+    /// <param name="cancellationToken">Cancels the build between samples.</param>
+    /// <exception cref="OperationCanceledException">The build was cancelled.</exception>
+    public static LogTimeIndex? Build(PieceTable document, LogTimestampFormat? format = null,
+        IProgress<int>? progress = null, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        format ??= LogTimestampFormat.Detect(document);
+        if (format is null) return null;
+
+        long lineCount = document.LineCount;
+        long stride = Math.Max(format.Wraps ? 1 : MinSampleStride, (lineCount + MaxSamples - 1) / MaxSamples);
+        var lines = new List<long>();
+        var ticks = new List<long>();
+        var stamps = new List<long>();
+        var wraps = new List<int>();
+        long latest = long.MinValue;
+        int wrapped = 0, lastPercent = -1;
+        for (long start = 0; start < lineCount; start += stride)
+        {
+            cancellationToken.ThrowIfCancellationRequested();
+            int percent = (int)(start * 100 / lineCount);
+            if (percent != lastPercent)
+            {
+                progress?.Report(percent);
+                lastPercent = percent;
+            }
+
+            if (!TryFindStamp(document, format, start, Math.Min(start + stride, lineCount), 1,
+                    out long line, out long stamp))
+                continue;
+
+            if (stamps.Count > 0 && format.HasWrapped(stamps[^1], stamp))
+                wrapped++;
+
+            // Samples keep the latest time seen so far, so that they stay
+            // sorted when a sampled line is out of order.
+            latest = Math.Max(latest, format.AddWraps(stamp, wrapped));
+            lines.Add(line);
+            ticks.Add(latest);
+            stamps.Add(stamp);
+            wraps.Add(wrapped);
+        }
+
+        if (lines.Count == 0) return null;
+        return new LogTimeIndex(format, lineCount, document.Length,
+            [.. lines], [.. ticks], [.. stamps], [.. wraps]);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Queries
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Returns the first line whose timestamp is at or after
+    /// <paramref name="ticks"/>, or <see cref="LineCount"/> if there is none.
+    /// </summary>
+    /// <param name="document">The document the index was built from.</param>
+    /// <param name="ticks">The time, on the scale of <see cref="LogTimestampFormat.TryParse"/>.</param>
+    public long FindFirstLineAtOrAfter(PieceTable document, long ticks) =>
+        Find(document, ticks, inclusive: true);
+
+    /// <summary>
+    /// Returns the first line whose timestamp is after
+    /// <paramref name="ticks"/>, or <see cref="LineCount"/> if there is none.
+    /// </summary>
+    /// <param name="document">The document the index was built from.</param>
+    /// <param name="ticks">The time, on the scale of <see cref="LogTimestampFormat.TryParse"/>.</param>
+    public long FindFirstLineAfter(PieceTable document, long ticks) =>
+        Find(document, ticks, inclusive: false);
+
+    /// <summary>
+    /// Returns the character range of the lines stamped from
+    /// <paramref name="fromTicks"/> to <paramref name="toTicks"/> inclusive,
+    /// with the unstamped lines that follow them.
+    /// </summary>
+    /// <param name="document">The document the index was built from.</param>
+    /// <param name="fromTicks">The start of the time range.</param>
+    /// <param name="toTicks">
+    /// The last tick of the time range; see
+    /// <see cref="LogTimestampFormat.TryParseInputEnd"/> for a typed end time.
+    /// </param>
+    public (long Start, long Length) GetRange(PieceTable document, long fromTicks, long toTicks)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        long firstLine = FindFirstLineAtOrAfter(document, fromTicks);
+        long endLine = Math.Max(firstLine, FindFirstLineAfter(document, toTicks));
+        long start = LineStart(document, firstLine);
+        return (start, LineStart(document, endLine) - start);
+    }
+
+    /// <summary>
+    /// Gets the timestamp of <paramref name="line"/>, or of the nearest
+    /// stamped line before it within a few thousand lines.
+    /// </summary>
+    public bool TryGetTimestamp(PieceTable document, long line, out long ticks)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+        ArgumentOutOfRangeException.ThrowIfNegative(line);
+
+        line = Math.Min(line, LineCount - 1);
+        if (!TryFindStamp(document, Format, line, Math.Max(-1, line - MaxProbeLines), -1,
+                out long stamped, out ticks))
+            return false;
+        ticks = Unwrap(stamped, ticks);
+        return true;
+    }
+
+    private long Find(PieceTable document, long target, bool inclusive)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        // The bracketing samples: the sample before the first one that
+        // reaches the target has not reached it, since samples only grow.
+        int i = 0, end = _sampleTicks.Length;
+        while (i < end)
+        {
+            int mid = (i + end) >>> 1;
+            if (Reaches(_sampleTicks[mid], target, inclusive)) end = mid;
+            else i = mid + 1;
+        }
+
+        long lo = i > 0 ? _sampleLines[i - 1] : -1;
+        long hi = i < _sampleLines.Length ? _sampleLines[i] : LineCount;
+
+        // Binary search over the stamped lines between them: lo has not
+        // reached the target and hi has, or is the end.
+        while (hi - lo > 1)
+        {
+            long mid = lo + (hi - lo) / 2;
+            if (!TryFindStamp(document, Format, mid, hi, 1, out long line, out long stamp) &&
+                !TryFindStamp(document, Format, mid - 1, lo, -1, out line, out stamp))
+                break;
+
+            if (Reaches(Unwrap(line, stamp), target, inclusive)) hi = line;
+            else lo = line;
+        }
+
+        // An earlier line may have reached the target out of order.
+        long found = hi;
+        for (long line = hi - 1; line >= 0 && line >= hi - LocalScanLines; line--)
+        {
+            if (Format.TryParse(LogTimestampFormat.ReadPrefix(document, line), out long stamp) &&
+                Reaches(Unwrap(line, stamp), target, inclusive))
+                found = line;
+        }
+        return found;
+    }
+
+    /// <summary>
+    /// Adds to the timestamp written on <paramref name="line"/> the days or
+    /// years the clock wrapped before it, taken from the nearest sample at or
+    /// before the line and adjusted by one if the line is on the other side
+    /// of a wrap than that sample.
+    /// </summary>
+    private long Unwrap(long line, long stamp)
+    {
+        if (!Format.Wraps) return stamp;
+
+        int i = Array.BinarySearch(_sampleLines, line);
+        if (i < 0) i = Math.Max(0, ~i - 1);
+
+        int wraps = _sampleWraps[i];
+        if (Format.HasWrapped(_sampleStamps[i], stamp)) wraps++;
+        else if (Format.HasWrapped(stamp, _sampleStamps[i]) && wraps > 0) wraps--;
+        return Format.AddWraps(stamp, wraps);
+    }
+
+    private static bool Reaches(long stamp, long target, bool inclusive) =>
+        inclusive ? stamp >= target : stamp > target;
+
+    /// <summary>
+    /// Finds the first stamped line from <paramref name="from"/> towards
+    /// <paramref name="limit"/> (exclusive) in <paramref name="step"/>
+    /// direction, looking at no more than <see cref="MaxProbeLines"/> lines.
+    /// </summary>
+    private static bool TryFindStamp(PieceTable document, LogTimestampFormat format, long from, long limit,
+        int step, out long line, out long ticks)
+    {
+        int probed = 0;
+        for (line = from; line != limit && probed < MaxProbeLines; line += step, probed++)
+        {
+            if (format.TryParse(LogTimestampFormat.ReadPrefix(document, line), out ticks))
+                return true;
+        }
+        ticks = 0;
+        return false;
+    }
+
+    private static long LineStart(PieceTable document, long line) =>
+        line < document.LineCount ? document.GetLineStartOffset(line) : document.Length;
+}
@@ -0,0 +1,408 @@
+using System.Globalization;
+using System.Text.RegularExpressions;
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Navigation;
+
+/// <summary>
+/// A timestamp format found at the start of log lines, and its parser.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Leading whitespace and an opening <c>[</c> are skipped, so
+/// <c>[2024-03-01 14:32:05.123]</c> parses like the bare form.  Fractions
+/// of a second may follow a <c>.</c> or <c>,</c>; anything after the time,
+/// such as a <c>Z</c> or UTC offset, is ignored.
+/// </para>
+/// <para>
+/// Timestamps are compared as written, in ticks of the wall-clock time on
+/// the line.  Syslog timestamps carry no year and are placed in a leap year
+/// so that February 29 parses; time-only timestamps count from midnight.
+/// Such timestamps wrap around at new year or midnight; a
+/// <see cref="LogTimeIndex"/> counts the wraps so that a log spanning
+/// several years or days stays in order.
+/// </para>
+/// </remarks>
+public sealed class LogTimestampFormat
+{
+    /// <summary>ISO 8601 dates: <c>yyyy-MM-dd HH:mm:ss</c> or <c>yyyy-MM-ddTHH:mm:ss</c>.</summary>
+    public static LogTimestampFormat IsoDate { get; } = new("yyyy-MM-dd HH:mm:ss", DateStyle.Iso);
+
+    /// <summary>Slash-separated dates: <c>yyyy/MM/dd HH:mm:ss</c>.</summary>
+    public static LogTimestampFormat SlashDate { get; } = new("yyyy/MM/dd HH:mm:ss", DateStyle.Slash);
+
+    /// <summary>BSD syslog: <c>MMM d HH:mm:ss</c>, without a year.</summary>
+    public static LogTimestampFormat Syslog { get; } = new("MMM d HH:mm:ss", DateStyle.Syslog);
+
+    /// <summary>A time of day without a date: <c>HH:mm:ss</c>.</summary>
+    public static LogTimestampFormat TimeOfDay { get; } = new("HH:mm:ss", DateStyle.None);
+
+    /// <summary>The formats <see cref="Detect(IEnumerable{string})"/> chooses from.</summary>
+    public static IReadOnlyList<LogTimestampFormat> All { get; } = [IsoDate, SlashDate, Syslog, TimeOfDay];
+
+    /// <summary>Characters of a line read to find its timestamp.</summary>
+    public const int MaxPrefixLength = 64;
+
+    // Syslog timestamps are placed in a leap year.
+    private const int SyslogYear = 2000;
+
+    // A timestamp this far before the previous one means the clock wrapped.
+    private const long HalfDay = TimeSpan.TicksPerDay / 2;
+    private const long HalfYear = 183 * TimeSpan.TicksPerDay;
+
+    private static readonly Regex InputTimePattern =
+        new(@"(\d{1,2}):(\d{2})(?::(\d{2})(?:[.,](\d+))?)?", RegexOptions.CultureInvariant);
+
+    private static readonly string[] MonthNames =
+        ["jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec"];
+
+    private static readonly string[] InputTimeFormats =
+        [@"h\:mm\:ss\.FFFFFFF", @"h\:mm\:ss\,FFFFFFF", @"h\:mm\:ss", @"h\:mm"];
+
+    private readonly DateStyle _style;
+
+    private LogTimestampFormat(string pattern, DateStyle style)
+    {
+        Pattern = pattern;
+        _style = style;
+    }
+
+    private enum DateStyle { Iso, Slash, Syslog, None }
+
+    /// <summary>A description of the format, such as <c>yyyy-MM-dd HH:mm:ss</c>.</summary>
+    public string Pattern { get; }
+
+    /// <summary>Whether the timestamps include a date.</summary>
+    public bool HasDate => _style != DateStyle.None;
+
+    /// <summary>
+    /// Whether the timestamps start over during a log: a time of day at
+    /// midnight, a syslog date at new year.
+    /// </summary>
+    public bool Wraps => _style is DateStyle.None or DateStyle.Syslog;
+
+    /// <inheritdoc/>
+    public override string ToString() => Pattern;
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Parsing
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Parses the timestamp at the start of <paramref name="line"/>.
+    /// </summary>
+    /// <param name="line">The line, or at least its first <see cref="MaxPrefixLength"/> characters.</param>
+    /// <param name="ticks">The timestamp, in <see cref="DateTime.Ticks"/> of the time as written.</param>
+    /// <returns><see langword="true"/> if the line starts with a timestamp in this format.</returns>
+    public bool TryParse(ReadOnlySpan<char> line, out long ticks)
+    {
+        ticks = 0;
+        int p = 0;
+        while (p < line.Length && line[p] is ' ' or '\t') p++;
+        if (p < line.Length && line[p] == '[') p++;
+
+        long dateTicks = 0;
+        if (_style != DateStyle.None)
+        {
+            if (!TryParseDate(line, ref p, out dateTicks)) return false;
+        }
+
+        if (!TryParseTime(line, ref p, out long timeTicks)) return false;
+        ticks = dateTicks + timeTicks;
+        return true;
+    }
+
+    private bool TryParseDate(ReadOnlySpan<char> line, ref int p, out long ticks)
+    {
+        ticks = 0;
+        int year, month, day;
+        if (_style == DateStyle.Syslog)
+        {
+            // "Mar  3 14:32:05": the day is padded with a space, not a zero.
+            if (p + 4 > line.Length) return false;
+            ReadOnlySpan<char> name = line.Slice(p, 3);
+            month = 0;
+            for (int m = 0; m < MonthNames.Length && month == 0; m++)
+            {
+                if (name.Equals(MonthNames[m], StringComparison.OrdinalIgnoreCase))
+                    month = m + 1;
+            }
+            if (month == 0 || line[p + 3] != ' ') return false;
+            p += 4;
+            if (p < line.Length && line[p] == ' ') p++;
+            if (!TryReadNumber(line, ref p, 1, 2, out day)) return false;
+            year = SyslogYear;
+        }
+        else
+        {
+            char separator = _style == DateStyle.Iso ? '-' : '/';
+            if (!TryReadNumber(line, ref p, 4, 4, out year) || !TryExpect(line, ref p, separator) ||
+                !TryReadNumber(line, ref p, 2, 2, out month) || !TryExpect(line, ref p, separator) ||
+                !TryReadNumber(line, ref p, 2, 2, out day))
+                return false;
+        }
+
+        // ISO dates may be joined to the time with a 'T'.
+        if (!TryExpect(line, ref p, ' ') && !(_style == DateStyle.Iso && TryExpect(line, ref p, 'T')))
+            return false;
+        if (year < 1 || month is < 1 or > 12 || day < 1 || day > DateTime.DaysInMonth(year, month))
+            return false;
+        ticks = new DateTime(year, month, day).Ticks;
+        return true;
+    }
+
+    private static bool TryParseTime(ReadOnlySpan<char> line, ref int p, out long ticks)
+    {
+        ticks = 0;
+        if (!TryReadNumber(line, ref p, 2, 2, out int hour) || !TryExpect(line, ref p, ':') ||
+            !TryReadNumber(line, ref p, 2, 2, out int minute) || !TryExpect(line, ref p, ':') ||
+            !TryReadNumber(line, ref p, 2, 2, out int second))
+            return false;
+        if (hour > 23 || minute > 59 || second > 60) return false;
+
+        // A leap second sorts with the second before it.
+        ticks = hour * TimeSpan.TicksPerHour + minute * TimeSpan.TicksPerMinute +
+                Math.Min(second, 59) * TimeSpan.TicksPerSecond;
+
+        if (p + 1 < line.Length && line[p] is '.' or ',' && char.IsAsciiDigit(line[p + 1]))
+        {
+            p++;
+            long fraction = 0;
+            int digits = 0;
+            while (p < line.Length && char.IsAsciiDigit(line[p]))
+            {
+                if (digits < 7)
+                {
+                    fraction = fraction * 10 + (line[p] - '0');
+                    digits++;
+                }
+                p++;
+            }
+            for (; digits < 7; digits++)
+                fraction *= 10;
+            ticks += fraction;
+        }
+        return true;
+    }
+
+    private static bool TryReadNumber(ReadOnlySpan<char> text, ref int p, int minDigits, int maxDigits,
+        out int value)
+    {
+        value = 0;
+        int start = p;
+        while (p < text.Length && p - start < maxDigits && char.IsAsciiDigit(text[p]))
+            value = value * 10 + (text[p++] - '0');
+        return p - start >= minDigits;
+    }
+
+    private static bool TryExpect(ReadOnlySpan<char> text, ref int p, char c)
+    {
+        if (p >= text.Length || text[p] != c) return false;
+        p++;
+        return true;
+    }
+
+    /// <summary>
+    /// Parses a time typed by the user into the scale of this format: a
+    /// timestamp as it would appear in the log, a general date and time, or
+    /// a bare time of day (<c>14:32</c>, <c>14:32:05.250</c>), which is
+    /// taken on the date of <paramref name="referenceTicks"/>.  Timestamps
+    /// without a date or year take the day or year that puts them nearest to
+    /// <paramref name="referenceTicks"/>.
+    /// </summary>
+    /// <param name="text">The text to parse.</param>
+    /// <param name="referenceTicks">A timestamp from the log whose date completes a bare time.</param>
+    /// <param name="ticks">The parsed time, comparable with timestamps from <see cref="TryParse"/>.</param>
+    public bool TryParseInput(string text, long referenceTicks, out long ticks)
+    {
+        ArgumentNullException.ThrowIfNull(text);
+        text = text.Trim();
+
+        if (TryParse(text, out ticks))
+        {
+            ticks = Nearest(AddWraps(ticks, WrapsOf(referenceTicks)), referenceTicks);
+            return true;
+        }
+
+        if (TimeSpan.TryParseExact(text, InputTimeFormats, CultureInfo.InvariantCulture, out TimeSpan time) &&
+            time < TimeSpan.FromDays(1))
+        {
+            ticks = referenceTicks - referenceTicks % TimeSpan.TicksPerDay + time.Ticks;
+            if (_style == DateStyle.None)
+                ticks = Nearest(ticks, referenceTicks);
+            return true;
+        }
+
+        if (HasDate && DateTime.TryParse(text, CultureInfo.InvariantCulture,
+                DateTimeStyles.AllowWhiteSpaces | DateTimeStyles.NoCurrentDateDefault, out DateTime dateTime))
+        {
+            if (_style == DateStyle.Syslog)
+            {
+                int year = new DateTime(referenceTicks).Year;
+                int day = Math.Min(dateTime.Day, DateTime.DaysInMonth(year, dateTime.Month));
+                dateTime = new DateTime(year, dateTime.Month, day).Add(dateTime.TimeOfDay);
+                ticks = Nearest(dateTime.Ticks, referenceTicks);
+                return true;
+            }
+            ticks = dateTime.Ticks;
+            return true;
+        }
+
+        ticks = 0;
+        return false;
+    }
+
+    /// <summary>
+    /// Parses a time typed as the end of a range, like
+    /// <see cref="TryParseInput"/>, and moves it to the last tick of the
+    /// precision typed: <c>14:32:05</c> covers the whole second,
+    /// <c>14:32</c> the whole minute and a bare date the whole day.
+    /// </summary>
+    public bool TryParseInputEnd(string text, long referenceTicks, out long ticks)
+    {
+        if (!TryParseInput(text, referenceTicks, out ticks))
+            return false;
+
+        Match time = InputTimePattern.Match(text);
+        long precision =
+            !time.Success ? TimeSpan.TicksPerDay :
+            time.Groups[4].Success ? (long)Math.Pow(10, Math.Max(0, 7 - time.Groups[4].Length)) :
+            time.Groups[3].Success ? TimeSpan.TicksPerSecond :
+            TimeSpan.TicksPerMinute;
+        ticks += precision - ticks % precision - 1;
+        return true;
+    }
+
+    /// <summary>
+    /// Formats <paramref name="ticks"/> the way this format writes
+    /// timestamps, for pre-filling prompts.
+    /// </summary>
+    public string Format(long ticks)
+    {
+        var time = new DateTime(ticks);
+        string format = _style switch
+        {
+            DateStyle.Iso => "yyyy-MM-dd HH:mm:ss",
+            DateStyle.Slash => "yyyy/MM/dd HH:mm:ss",
+            DateStyle.Syslog => "MMM d HH:mm:ss",
+            _ => "HH:mm:ss",
+        };
+        if (time.Ticks % TimeSpan.TicksPerSecond != 0)
+            format += ".fff";
+        return time.ToString(format, CultureInfo.InvariantCulture);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Wrap-around
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Whether <paramref name="ticks"/>, written after
+    /// <paramref name="previousTicks"/>, is so much earlier that the clock
+    /// must have wrapped: by more than half a day for a time of day, half a
+    /// year for a syslog date.  Both are as returned by <see cref="TryParse"/>.
+    /// </summary>
+    internal bool HasWrapped(long previousTicks, long ticks) => _style switch
+    {
+        DateStyle.None => ticks < previousTicks - HalfDay,
+        DateStyle.Syslog => ticks < previousTicks - HalfYear,
+        _ => false,
+    };
+
+    /// <summary>
+    /// Moves a timestamp from <see cref="TryParse"/> forward by
+    /// <paramref name="wraps"/> days or years.
+    /// </summary>
+    internal long AddWraps(long ticks, int wraps) => wraps == 0 ? ticks : _style switch
+    {
+        DateStyle.None => ticks + wraps * TimeSpan.TicksPerDay,
+        DateStyle.Syslog => new DateTime(ticks).AddYears(wraps).Ticks,
+        _ => ticks,
+    };
+
+    /// <summary>
+    /// Moves <paramref name="ticks"/> a day or year either way when that
+    /// brings it within half a day or year of <paramref name="referenceTicks"/>.
+    /// </summary>
+    private long Nearest(long ticks, long referenceTicks)
+    {
+        if (HasWrapped(referenceTicks, ticks))
+            return AddWraps(ticks, 1);
+        if (HasWrapped(ticks, referenceTicks) && WrapsOf(ticks) > 0)
+            return AddWraps(ticks, -1);
+        return ticks;
+    }
+
+    /// <summary>The number of wraps <see cref="AddWraps"/> applied to <paramref name="ticks"/>.</summary>
+    private int WrapsOf(long ticks) => _style switch
+    {
+        DateStyle.None => (int)(ticks / TimeSpan.TicksPerDay),
+        DateStyle.Syslog => new DateTime(ticks).Year - SyslogYear,
+        _ => 0,
+    };
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Detection
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Chooses the format that the most sample lines start with, or returns
+    /// <see langword="null"/> when fewer than a quarter of the non-empty
+    /// lines (and fewer than two) start with any.  Lines without a
+    /// timestamp, such as stack traces, are expected between stamped ones.
+    /// </summary>
+    public static LogTimestampFormat? Detect(IEnumerable<string> lines)
+    {
+        ArgumentNullException.ThrowIfNull(lines);
+
+        var counts = new int[All.Count];
+        int sampled = 0;
+        foreach (string line in lines)
+        {
+            if (string.IsNullOrWhiteSpace(line)) continue;
+            sampled++;
+            for (int f = 0; f < All.Count; f++)
+            {
+                if (All[f].TryParse(line, out _))
+                    counts[f]++;
+            }
+        }
+
+        int best = -1;
+        for (int f = 0; f < counts.Length; f++)
+        {
+            if (counts[f] > 0 && (best < 0 || counts[f] > counts[best]))
+                best = f;
+        }
+        if (best < 0 || counts[best] < 2 || counts[best] * 4 < sampled)
+            return null;
+        return All[best];
+    }
+
+    /// <summary>
+    /// Chooses the format of <paramref name="document"/> from the start of
+    /// its first <paramref name="sampleLines"/> lines.
+    /// </summary>
+    public static LogTimestampFormat? Detect(PieceTable document, int sampleLines = 200)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        long count = Math.Min(document.LineCount, sampleLines);
+        var prefixes = new List<string>((int)count);
+        for (long line = 0; line < count; line++)
+            prefixes.Add(ReadPrefix(document, line));
+        return Detect(prefixes);
+    }
+
+    /// <summary>
+    /// Reads up to <see cref="MaxPrefixLength"/> characters from the start
+    /// of <paramref name="line"/>, so that long lines cost no more than
+    /// short ones.
+    /// </summary>
+    internal static string ReadPrefix(PieceTable document, long line)
+    {
+        long start = document.GetLineStartOffset(line);
+        long end = line + 1 < document.LineCount ? document.GetLineStartOffset(line + 1) : document.Length;
+        return document.GetText(start, Math.Min(end - start, MaxPrefixLength));
+    }
+}
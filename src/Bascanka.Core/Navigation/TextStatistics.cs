@@ -0,0 +1,90 @@
+namespace Bascanka.Core.Navigation;
+
+/// <summary>
+/// Counts describing a stretch of text: characters, words, lines and the
+/// bytes it takes in a few encodings.  Counts of consecutive stretches that
+/// meet at the start of a line add up with <see cref="op_Addition"/>.
+/// </summary>
+/// <param name="Characters">UTF-16 code units, line breaks included.</param>
+/// <param name="Words">Runs of characters other than white space.</param>
+/// <param name="LineFeeds">Line feeds; the text has one more line than this.</param>
+/// <param name="NonBlankLines">Lines with at least one character other than white space.</param>
+/// <param name="MaxLineLength">Characters in the longest line, without its line break.</param>
+/// <param name="Utf8Bytes">Bytes of the text in UTF-8, without a byte order mark.</param>
+/// <param name="EncodedBytes">
+/// Bytes of the text in the encoding it was counted for, without a byte
+/// order mark.
+/// </param>
+public readonly record struct TextStatistics(long Characters, long Words, long LineFeeds,
+    long NonBlankLines, long MaxLineLength, long Utf8Bytes, long EncodedBytes)
+{
+    /// <summary>Number of lines, counting the one after the last line feed.</summary>
+    public long Lines => LineFeeds + 1;
+
+    /// <summary>Bytes of the text in UTF-16, without a byte order mark.</summary>
+    public long Utf16Bytes => Characters * 2;
+
+    /// <summary>
+    /// Counts <paramref name="text"/>, which must start at the start of a
+    /// line; a line at its end without a line feed is counted as complete.
+    /// </summary>
+    /// <param name="text">The text to count.</param>
+    /// <param name="encoding">The encoding of <see cref="EncodedBytes"/>; UTF-8 when <see langword="null"/>.</param>
+    public static TextStatistics Count(ReadOnlySpan<char> text, System.Text.Encoding? encoding = null)
+    {
+        long words = 0, lineFeeds = 0, nonBlank = 0, maxLine = 0;
+        bool inWord = false, lineHasText = false;
+        int lineStart = 0;
+
+        for (int i = 0; i < text.Length; i++)
+        {
+            char c = text[i];
+            if (c == '\n')
+            {
+                int length = i - lineStart;
+                if (length > 0 && text[i - 1] == '\r')
+                    length--;
+                maxLine = Math.Max(maxLine, length);
+                if (lineHasText)
+                    nonBlank++;
+                lineFeeds++;
+                lineStart = i + 1;
+                inWord = lineHasText = false;
+            }
+            else if (char.IsWhiteSpace(c))
+            {
+                inWord = false;
+            }
+            else
+            {
+                if (!inWord)
+                    words++;
+                inWord = lineHasText = true;
+            }
+        }
+
+        if (lineStart < text.Length)
+        {
+            maxLine = Math.Max(maxLine, text.Length - lineStart);
+            if (lineHasText)
+                nonBlank++;
+        }
+
+        long utf8 = System.Text.Encoding.UTF8.GetByteCount(text);
+        long encoded = encoding is null || encoding.CodePage == 65001 ? utf8 : encoding.GetByteCount(text);
+        return new TextStatistics(text.Length, words, lineFeeds, nonBlank, maxLine, utf8, encoded);
+    }
+
+    /// <summary>
+    /// Combines the counts of two stretches of text, the second starting at
+    /// the start of a line right after the first.
+    /// </summary>
+    public static TextStatistics operator +(TextStatistics a, TextStatistics b) => new(
+        a.Characters + b.Characters,
+        a.Words + b.Words,
+        a.LineFeeds + b.LineFeeds,
+        a.NonBlankLines + b.NonBlankLines,
+        Math.Max(a.MaxLineLength, b.MaxLineLength),
+        a.Utf8Bytes + b.Utf8Bytes,
+        a.EncodedBytes + b.EncodedBytes);
+}
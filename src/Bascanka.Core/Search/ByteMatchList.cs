@@ -0,0 +1,86 @@
+using System.Collections;
+
+namespace Bascanka.Core.Search;
+
+/// <summary>
+/// Sorted match offsets produced by <see cref="BytePatternSearcher.FindAll"/>,
+/// stored compactly: offsets are grouped by the search chunk they fall in
+/// and kept as 32-bit deltas from the chunk start, so each match costs four
+/// bytes regardless of file size.
+/// </summary>
+/// <remarks>Instances are immutable and safe to share between threads.</remarks>
+public sealed class ByteMatchList : IReadOnlyList<long>
+{
+    /// <summary>An empty list.</summary>
+    public static ByteMatchList Empty { get; } = new([], [], [], isTruncated: false);
+
+    // Segment s covers _deltas[_segmentStarts[s] .. _segmentStarts[s + 1])
+    // and its offsets are _segmentBases[s] + delta.  Only non-empty
+    // segments are stored.
+    private readonly long[] _segmentBases;
+    private readonly int[] _segmentStarts;
+    private readonly uint[] _deltas;
+
+    internal ByteMatchList(long[] segmentBases, int[] segmentStarts, uint[] deltas, bool isTruncated)
+    {
+        _segmentBases = segmentBases;
+        _segmentStarts = segmentStarts;
+        _deltas = deltas;
+        IsTruncated = isTruncated;
+    }
+
+    /// <summary>Number of matches.</summary>
+    public int Count => _deltas.Length;
+
+    /// <summary>
+    /// Whether the search stopped at its result limit, so matches after the
+    /// last one in the list were not collected.
+    /// </summary>
+    public bool IsTruncated { get; }
+
+    /// <summary>Returns the offset of match <paramref name="index"/>.</summary>
+    public long this[int index]
+    {
+        get
+        {
+            if ((uint)index >= (uint)_deltas.Length)
+                throw new ArgumentOutOfRangeException(nameof(index));
+            return _segmentBases[SegmentOf(index)] + _deltas[index];
+        }
+    }
+
+    /// <summary>
+    /// Index of the first match at or after <paramref name="offset"/>, or
+    /// <see cref="Count"/> when there is none.
+    /// </summary>
+    public int IndexOfFirstAtOrAfter(long offset)
+    {
+        int lo = 0, hi = _deltas.Length;
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if (this[mid] < offset) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    public IEnumerator<long> GetEnumerator()
+    {
+        for (int s = 0; s < _segmentBases.Length; s++)
+        {
+            int end = s + 1 < _segmentStarts.Length ? _segmentStarts[s + 1] : _deltas.Length;
+            for (int i = _segmentStarts[s]; i < end; i++)
+                yield return _segmentBases[s] + _deltas[i];
+        }
+    }
+
+    IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
+
+    /// <summary>The last segment starting at or before <paramref name="index"/>.</summary>
+    private int SegmentOf(int index)
+    {
+        int s = Array.BinarySearch(_segmentStarts, index);
+        return s >= 0 ? s : ~s - 1;
+    }
+}
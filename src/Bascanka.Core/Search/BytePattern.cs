@@ -0,0 +1,307 @@
+using System.Text;
+using TextEncoding = System.Text.Encoding;
+
+namespace Bascanka.Core.Search;
+
+/// <summary>
+/// A byte sequence to search for in binary data, where each position may be
+/// partially or fully masked out.  Byte <c>i</c> of the input matches when
+/// <c>(input &amp; Masks[i]) == Values[i]</c>; a mask of <c>0x00</c> is a
+/// byte wildcard and <c>0xF0</c> / <c>0x0F</c> are nibble wildcards.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Patterns are built from hex text (<see cref="Parse"/>), e.g.
+/// <c>"4D 5A ?? 00"</c> or <c>"E8 ?? ?? ?? ?F"</c>, or from text encoded as
+/// ASCII or UTF-16LE (<see cref="FromText"/>).  Case-insensitive text
+/// patterns are expressed with masks: ASCII letters are compared with bit
+/// 5 masked out.
+/// </para>
+/// <para>Instances are immutable and safe to share between threads.</para>
+/// </remarks>
+public sealed class BytePattern
+{
+    private readonly byte[] _values;
+    private readonly byte[] _masks;
+
+    /// <summary>
+    /// Creates a pattern from explicit values and masks of equal length.
+    /// Value bits outside the mask are ignored.
+    /// </summary>
+    public BytePattern(byte[] values, byte[]? masks = null)
+    {
+        ArgumentNullException.ThrowIfNull(values);
+        if (values.Length == 0)
+            throw new ArgumentException("Pattern must not be empty.", nameof(values));
+        if (masks is not null && masks.Length != values.Length)
+            throw new ArgumentException("Mask length must equal pattern length.", nameof(masks));
+
+        _masks = masks is null ? CreateFilled(values.Length, 0xFF) : (byte[])masks.Clone();
+        _values = new byte[values.Length];
+        for (int i = 0; i < values.Length; i++)
+            _values[i] = (byte)(values[i] & _masks[i]);
+
+        ChooseAnchors(out int anchor, out int secondAnchor);
+        AnchorIndex = anchor;
+        SecondAnchorIndex = secondAnchor;
+    }
+
+    /// <summary>Number of bytes the pattern spans.</summary>
+    public int Length => _values.Length;
+
+    /// <summary>Expected values, already masked.</summary>
+    public ReadOnlySpan<byte> Values => _values;
+
+    /// <summary>Per-byte masks; <c>0xFF</c> for an exact byte.</summary>
+    public ReadOnlySpan<byte> Masks => _masks;
+
+    /// <summary>
+    /// Position of the byte used to find candidate matches: the rarest
+    /// exact byte, or the most constrained one when none is exact.  -1 when
+    /// every byte is a full wildcard.
+    /// </summary>
+    public int AnchorIndex { get; }
+
+    /// <summary>
+    /// Position of a second byte checked together with the anchor to thin
+    /// out candidates, or -1 when the pattern has only one usable byte.
+    /// </summary>
+    public int SecondAnchorIndex { get; }
+
+    /// <summary>Whether every byte of the pattern is exact (no masks).</summary>
+    public bool IsExact => _masks.AsSpan().IndexOfAnyExcept((byte)0xFF) < 0;
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Factories
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Parses a hex pattern.  Whitespace between bytes is optional; each
+    /// nibble is a hex digit or <c>?</c> (wildcard), so <c>??</c> matches
+    /// any byte and <c>4?</c> any byte whose high nibble is 4.
+    /// </summary>
+    /// <param name="hex">The hex pattern.</param>
+    /// <param name="mask">
+    /// Optional hex mask, one byte per pattern byte, ANDed with the
+    /// wildcard mask (e.g. <c>"FF FF 7F"</c>).
+    /// </param>
+    /// <exception cref="FormatException">The text is not a valid pattern.</exception>
+    public static BytePattern Parse(string hex, string? mask = null)
+    {
+        ArgumentNullException.ThrowIfNull(hex);
+
+        var (values, masks) = ParseNibbles(hex, allowWildcards: true);
+        if (values.Count == 0)
+            throw new FormatException("Hex pattern is empty.");
+
+        if (mask is not null)
+        {
+            var (explicitMask, _) = ParseNibbles(mask, allowWildcards: false);
+            if (explicitMask.Count != values.Count)
+                throw new FormatException("Mask length must equal pattern length.");
+            for (int i = 0; i < masks.Count; i++)
+                masks[i] &= explicitMask[i];
+        }
+
+        return new BytePattern([.. values], [.. masks]);
+    }
+
+    /// <summary>
+    /// Parses a hex pattern, returning <see langword="false"/> instead of
+    /// throwing when it is malformed.
+    /// </summary>
+    public static bool TryParse(string hex, out BytePattern? pattern)
+    {
+        try
+        {
+            pattern = Parse(hex);
+            return true;
+        }
+        catch (FormatException)
+        {
+            pattern = null;
+            return false;
+        }
+    }
+
+    /// <summary>
+    /// Creates a pattern matching <paramref name="text"/> encoded with
+    /// <paramref name="encoding"/> (typically ASCII, Latin-1 or
+    /// <see cref="TextEncoding.Unicode"/> for UTF-16LE).
+    /// </summary>
+    /// <param name="text">The text to find.</param>
+    /// <param name="encoding">Encoding of the bytes being searched.</param>
+    /// <param name="ignoreAsciiCase">
+    /// When set, ASCII letters match in either case.  Only single-byte and
+    /// UTF-16LE encodings are supported in this mode.
+    /// </param>
+    public static BytePattern FromText(string text, TextEncoding encoding, bool ignoreAsciiCase = false)
+    {
+        ArgumentException.ThrowIfNullOrEmpty(text);
+        ArgumentNullException.ThrowIfNull(encoding);
+
+        byte[] bytes = encoding.GetBytes(text);
+        if (!ignoreAsciiCase)
+            return new BytePattern(bytes);
+
+        int charSize;
+        if (encoding.IsSingleByte)
+            charSize = 1;
+        else if (encoding.CodePage == TextEncoding.Unicode.CodePage)
+            charSize = 2;
+        else
+            throw new ArgumentException("Case-insensitive search requires a single-byte or UTF-16LE encoding.", nameof(encoding));
+
+        byte[] masks = CreateFilled(bytes.Length, 0xFF);
+        for (int i = 0; i + charSize <= bytes.Length; i += charSize)
+        {
+            // The low byte comes first in both encodings; a UTF-16 code unit
+            // is an ASCII letter only when its high byte is zero.
+            if (charSize == 2 && bytes[i + 1] != 0) continue;
+            if (char.IsAsciiLetter((char)bytes[i]))
+                masks[i] = 0xDF;
+        }
+        return new BytePattern(bytes, masks);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Matching
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Whether the pattern matches at the start of <paramref name="data"/>,
+    /// which must be at least <see cref="Length"/> bytes long.
+    /// </summary>
+    public bool MatchesAt(ReadOnlySpan<byte> data)
+    {
+        ReadOnlySpan<byte> values = _values;
+        ReadOnlySpan<byte> masks = _masks;
+        data = data[..values.Length];
+        for (int i = 0; i < values.Length; i++)
+        {
+            if ((data[i] & masks[i]) != values[i])
+                return false;
+        }
+        return true;
+    }
+
+    public override string ToString()
+    {
+        var sb = new StringBuilder(_values.Length * 3);
+        for (int i = 0; i < _values.Length; i++)
+        {
+            if (i > 0) sb.Append(' ');
+            sb.Append(FormatNibble(_values[i] >> 4, _masks[i] >> 4));
+            sb.Append(FormatNibble(_values[i] & 0xF, _masks[i] & 0xF));
+        }
+        return sb.ToString();
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Internals
+    // ────────────────────────────────────────────────────────────────────
+
+    private static (List<byte> Values, List<byte> Masks) ParseNibbles(string text, bool allowWildcards)
+    {
+        var values = new List<byte>();
+        var masks = new List<byte>();
+        int value = 0, mask = 0, nibbles = 0;
+
+        foreach (char c in text)
+        {
+            if (char.IsWhiteSpace(c))
+            {
+                if (nibbles == 1)
+                    throw new FormatException("Each byte needs two hex digits.");
+                continue;
+            }
+
+            int nibbleValue, nibbleMask;
+            if (c == '?' && allowWildcards)
+            {
+                nibbleValue = 0;
+                nibbleMask = 0;
+            }
+            else if (char.IsAsciiHexDigit(c))
+            {
+                nibbleValue = Convert.ToInt32(c.ToString(), 16);
+                nibbleMask = 0xF;
+            }
+            else
+            {
+                throw new FormatException($"Invalid character '{c}' in hex pattern.");
+            }
+
+            value = (value << 4) | nibbleValue;
+            mask = (mask << 4) | nibbleMask;
+            if (++nibbles == 2)
+            {
+                values.Add((byte)value);
+                masks.Add((byte)mask);
+                value = mask = nibbles = 0;
+            }
+        }
+
+        if (nibbles != 0)
+            throw new FormatException("Each byte needs two hex digits.");
+        return (values, masks);
+    }
+
+    private static string FormatNibble(int value, int mask) =>
+        mask == 0xF ? value.ToString("X") : "?";
+
+    private static byte[] CreateFilled(int length, byte value)
+    {
+        byte[] result = new byte[length];
+        result.AsSpan().Fill(value);
+        return result;
+    }
+
+    /// <summary>
+    /// Picks the two most selective positions.  A byte's score combines how
+    /// many bits its mask fixes with how rare its value tends to be in
+    /// binary files, so <c>00</c> and <c>FF</c> padding are avoided in
+    /// favour of, say, an opcode or a magic-number byte.
+    /// </summary>
+    private void ChooseAnchors(out int anchor, out int secondAnchor)
+    {
+        anchor = secondAnchor = -1;
+        int best = int.MinValue, second = int.MinValue;
+        for (int i = 0; i < _values.Length; i++)
+        {
+            if (_masks[i] == 0) continue;
+
+            int score = Score(_values[i], _masks[i]);
+            if (score > best)
+            {
+                secondAnchor = anchor;
+                second = best;
+                anchor = i;
+                best = score;
+            }
+            else if (score > second)
+            {
+                secondAnchor = i;
+                second = score;
+            }
+        }
+    }
+
+    private static int Score(byte value, byte mask)
+    {
+        // Fixed bits dominate: an exact byte always beats a masked one.
+        int score = System.Numerics.BitOperations.PopCount(mask) * 16;
+        if (mask != 0xFF) return score;
+
+        return score + value switch
+        {
+            0x00 => 0,
+            0xFF => 2,
+            0x20 or (>= (byte)'a' and <= (byte)'z') => 6,
+            0x01 or 0x02 or 0x04 or 0x08 or 0x10 or 0x40 or 0x80 => 8,
+            >= (byte)'0' and <= (byte)'9' => 9,
+            >= (byte)'A' and <= (byte)'Z' => 10,
+            _ => 12,
+        };
+    }
+}
@@ -0,0 +1,398 @@
+using System.Buffers;
+using System.Numerics;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Runtime.Intrinsics;
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Search;
+
+/// <summary>
+/// Finds <see cref="BytePattern"/> occurrences in a <see cref="BytePieceTable"/>.
+/// The document is searched in fixed-size chunks that are read and scanned
+/// in parallel, so throughput scales with cores and memory bandwidth rather
+/// than being bound to a single thread.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Within a chunk, candidates are found with SIMD: the pattern's two most
+/// selective bytes (see <see cref="BytePattern.AnchorIndex"/>) are compared
+/// 32 positions at a time, and only positions where both agree are checked
+/// against the full masked pattern.  Without 256-bit vector support the
+/// runtime's vectorised <c>IndexOf</c> on the anchor byte is used instead.
+/// </para>
+/// <para>
+/// <see cref="FindNext"/> and <see cref="FindPrevious"/> scan outward from
+/// the start offset one batch of chunks at a time and stop at the first
+/// batch with a hit, so a nearby match is found without touching the rest
+/// of the file.  Chunks overlap by the pattern length, so matches spanning
+/// a chunk boundary are found exactly once.
+/// </para>
+/// <para>
+/// The buffer is only read.  Callers must not edit it while a search is
+/// running.
+/// </para>
+/// </remarks>
+public static class BytePatternSearcher
+{
+    /// <summary>Bytes of match starts covered by one parallel work item.</summary>
+    public const int ChunkSize = 4 * 1024 * 1024;
+
+    /// <summary>Default limit on the number of offsets <see cref="FindAll"/> collects.</summary>
+    public const int MaxResults = 10_000_000;
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Document search
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Returns the first match starting at or after <paramref name="startOffset"/>,
+    /// or -1.  With <paramref name="wrapAround"/>, a search that reaches the
+    /// end of the document continues from its start.
+    /// </summary>
+    public static long FindNext(BytePieceTable buffer, BytePattern pattern, long startOffset,
+        bool wrapAround = false, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(buffer);
+        ArgumentNullException.ThrowIfNull(pattern);
+
+        long hit = FindForward(buffer, pattern, startOffset, cancellationToken);
+        if (hit < 0 && wrapAround && startOffset > 0)
+            hit = FindForward(buffer, pattern, 0, cancellationToken);
+        return hit;
+    }
+
+    /// <summary>
+    /// Returns the last match starting before <paramref name="beforeOffset"/>,
+    /// or -1.  With <paramref name="wrapAround"/>, a search that reaches the
+    /// start of the document continues from its end.
+    /// </summary>
+    public static long FindPrevious(BytePieceTable buffer, BytePattern pattern, long beforeOffset,
+        bool wrapAround = false, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(buffer);
+        ArgumentNullException.ThrowIfNull(pattern);
+
+        long hit = FindBackward(buffer, pattern, beforeOffset, cancellationToken);
+        if (hit < 0 && wrapAround && beforeOffset < buffer.Length)
+            hit = FindBackward(buffer, pattern, buffer.Length, cancellationToken);
+        return hit;
+    }
+
+    /// <summary>The first match starting at or after <paramref name="startOffset"/>, or -1.</summary>
+    private static long FindForward(BytePieceTable buffer, BytePattern pattern, long startOffset,
+        CancellationToken cancellationToken)
+    {
+        long lastStart = buffer.Length - pattern.Length;   // last possible match start
+        long from = Math.Max(0, startOffset);
+        int batch = 1;                                      // the first chunk is scanned alone
+
+        while (from <= lastStart)
+        {
+            cancellationToken.ThrowIfCancellationRequested();
+
+            long chunks = Math.Min(batch, (lastStart - from) / ChunkSize + 1);
+            long[] hits = new long[chunks];
+            long batchFrom = from;
+            Parallel.For(0, (int)chunks, new ParallelOptions { CancellationToken = cancellationToken }, i =>
+            {
+                long start = batchFrom + i * (long)ChunkSize;
+                long end = Math.Min(start + ChunkSize, lastStart + 1);
+                hits[i] = SearchChunk(buffer, pattern, start, end, forward: true);
+            });
+
+            foreach (long hit in hits)
+            {
+                if (hit >= 0) return hit;
+            }
+
+            from += chunks * ChunkSize;
+            batch = Environment.ProcessorCount;
+        }
+        return -1;
+    }
+
+    /// <summary>The last match starting before <paramref name="beforeOffset"/>, or -1.</summary>
+    private static long FindBackward(BytePieceTable buffer, BytePattern pattern, long beforeOffset,
+        CancellationToken cancellationToken)
+    {
+        // Match starts are searched in [0, end), walking end downwards.
+        long end = Math.Min(beforeOffset, buffer.Length - pattern.Length + 1);
+        int batch = 1;
+
+        while (end > 0)
+        {
+            cancellationToken.ThrowIfCancellationRequested();
+
+            long chunks = Math.Min(batch, (end - 1) / ChunkSize + 1);
+            long[] hits = new long[chunks];
+            long batchEnd = end;
+            Parallel.For(0, (int)chunks, new ParallelOptions { CancellationToken = cancellationToken }, i =>
+            {
+                long chunkEnd = batchEnd - i * (long)ChunkSize;
+                long chunkStart = Math.Max(0, chunkEnd - ChunkSize);
+                hits[i] = SearchChunk(buffer, pattern, chunkStart, chunkEnd, forward: false);
+            });
+
+            foreach (long hit in hits)
+            {
+                if (hit >= 0) return hit;
+            }
+
+            end -= chunks * ChunkSize;
+            batch = Environment.ProcessorCount;
+        }
+        return -1;
+    }
+
+    /// <summary>
+    /// Returns every match in the document, in ascending order, stopping
+    /// once <paramref name="maxResults"/> have been collected.
+    /// </summary>
+    /// <param name="buffer">The document to search.</param>
+    /// <param name="pattern">The pattern to find.</param>
+    /// <param name="maxResults">Limit on the number of offsets returned.</param>
+    /// <param name="progress">Receives the percentage of chunks scanned.</param>
+    /// <param name="cancellationToken">Cancels the search.</param>
+    public static ByteMatchList FindAll(BytePieceTable buffer, BytePattern pattern,
+        int maxResults = MaxResults, IProgress<int>? progress = null,
+        CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(buffer);
+        ArgumentNullException.ThrowIfNull(pattern);
+        ArgumentOutOfRangeException.ThrowIfNegativeOrZero(maxResults);
+
+        long lastStart = buffer.Length - pattern.Length;
+        if (lastStart < 0) return ByteMatchList.Empty;
+
+        long chunkCount = lastStart / ChunkSize + 1;
+        var chunkHits = new List<uint>?[chunkCount];
+        long done = 0;
+        int lastPercent = -1;
+
+        // Chunks finish out of order, so only the matches in the run of
+        // completed chunks from the start count towards the limit: that run
+        // is what Collect returns.
+        object prefixLock = new();
+        long prefixChunks = 0, prefixFound = 0;
+
+        Parallel.For(0, chunkCount, new ParallelOptions { CancellationToken = cancellationToken }, (i, state) =>
+        {
+            long start = i * ChunkSize;
+            long end = Math.Min(start + ChunkSize, lastStart + 1);
+            List<uint> hits = SearchChunkAll(buffer, pattern, start, end);
+            lock (prefixLock)
+            {
+                chunkHits[i] = hits;
+                while (prefixChunks < chunkCount && chunkHits[prefixChunks] is { } completed)
+                {
+                    prefixFound += completed.Count;
+                    prefixChunks++;
+                }
+
+                // The completed prefix already holds enough matches, so no
+                // other chunk can change the result.
+                if (prefixFound >= maxResults)
+                    state.Stop();
+            }
+
+            if (progress is not null)
+            {
+                int percent = (int)(Interlocked.Increment(ref done) * 100 / chunkCount);
+                if (percent > Volatile.Read(ref lastPercent))
+                {
+                    Volatile.Write(ref lastPercent, percent);
+                    progress.Report(percent);
+                }
+            }
+        });
+
+        return Collect(chunkHits, maxResults);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Span search
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Returns the first index in <paramref name="data"/> at or after
+    /// <paramref name="start"/> where <paramref name="pattern"/> matches, or -1.
+    /// </summary>
+    public static int IndexOf(ReadOnlySpan<byte> data, BytePattern pattern, int start = 0)
+    {
+        ArgumentNullException.ThrowIfNull(pattern);
+
+        int last = data.Length - pattern.Length;
+        if (start > last) return -1;
+
+        int a = pattern.AnchorIndex;
+        if (a < 0) return start;    // all wildcards
+
+        int i = start;
+        if (Vector256.IsHardwareAccelerated && last - i + 1 >= Vector256<byte>.Count)
+        {
+            int b = pattern.SecondAnchorIndex >= 0 ? pattern.SecondAnchorIndex : a;
+            var valueA = Vector256.Create(pattern.Values[a]);
+            var maskA = Vector256.Create(pattern.Masks[a]);
+            var valueB = Vector256.Create(pattern.Values[b]);
+            var maskB = Vector256.Create(pattern.Masks[b]);
+            ref byte origin = ref MemoryMarshal.GetReference(data);
+
+            // Loads stay in bounds: i + anchor + 31 <= last + anchor < data.Length.
+            for (; i + Vector256<byte>.Count - 1 <= last; i += Vector256<byte>.Count)
+            {
+                var eq = Vector256.Equals(Vector256.LoadUnsafe(ref origin, (nuint)(i + a)) & maskA, valueA)
+                       & Vector256.Equals(Vector256.LoadUnsafe(ref origin, (nuint)(i + b)) & maskB, valueB);
+                uint bits = eq.ExtractMostSignificantBits();
+                while (bits != 0)
+                {
+                    int candidate = i + BitOperations.TrailingZeroCount(bits);
+                    if (pattern.MatchesAt(data[candidate..]))
+                        return candidate;
+                    bits &= bits - 1;
+                }
+            }
+        }
+        else if (pattern.Masks[a] == 0xFF)
+        {
+            byte anchor = pattern.Values[a];
+            while (i <= last)
+            {
+                int skip = data.Slice(i + a, last - i + 1).IndexOf(anchor);
+                if (skip < 0) return -1;
+                i += skip;
+                if (pattern.MatchesAt(data[i..]))
+                    return i;
+                i++;
+            }
+            return -1;
+        }
+
+        for (; i <= last; i++)
+        {
+            if (AnchorMatches(data, pattern, i, a) && pattern.MatchesAt(data[i..]))
+                return i;
+        }
+        return -1;
+    }
+
+    /// <summary>
+    /// Returns the last index in <paramref name="data"/> where
+    /// <paramref name="pattern"/> matches, or -1.
+    /// </summary>
+    public static int LastIndexOf(ReadOnlySpan<byte> data, BytePattern pattern)
+    {
+        ArgumentNullException.ThrowIfNull(pattern);
+
+        int last = data.Length - pattern.Length;
+        if (last < 0) return -1;
+
+        int a = pattern.AnchorIndex;
+        if (a < 0) return last;
+
+        int i = last;
+        if (pattern.Masks[a] == 0xFF)
+        {
+            byte anchor = pattern.Values[a];
+            while (i >= 0)
+            {
+                i = data.Slice(a, i + 1).LastIndexOf(anchor);
+                if (i < 0) return -1;
+                if (pattern.MatchesAt(data[i..]))
+                    return i;
+                i--;
+            }
+            return -1;
+        }
+
+        for (; i >= 0; i--)
+        {
+            if (AnchorMatches(data, pattern, i, a) && pattern.MatchesAt(data[i..]))
+                return i;
+        }
+        return -1;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Internals
+    // ────────────────────────────────────────────────────────────────────
+
+    [MethodImpl(MethodImplOptions.AggressiveInlining)]
+    private static bool AnchorMatches(ReadOnlySpan<byte> data, BytePattern pattern, int i, int a) =>
+        (data[i + a] & pattern.Masks[a]) == pattern.Values[a];
+
+    /// <summary>
+    /// Reads the bytes needed for match starts in <c>[start, end)</c> into a
+    /// pooled buffer and returns the first (or last) match, or -1.
+    /// </summary>
+    private static long SearchChunk(BytePieceTable buffer, BytePattern pattern, long start, long end, bool forward)
+    {
+        int length = (int)(end - start) + pattern.Length - 1;
+        byte[] rented = ArrayPool<byte>.Shared.Rent(length);
+        try
+        {
+            ReadOnlySpan<byte> data = rented.AsSpan(0, buffer.Read(start, rented.AsSpan(0, length)));
+            int hit = forward ? IndexOf(data, pattern) : LastIndexOf(data, pattern);
+            return hit < 0 ? -1 : start + hit;
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(rented);
+        }
+    }
+
+    private static List<uint> SearchChunkAll(BytePieceTable buffer, BytePattern pattern, long start, long end)
+    {
+        var hits = new List<uint>();
+        int length = (int)(end - start) + pattern.Length - 1;
+        byte[] rented = ArrayPool<byte>.Shared.Rent(length);
+        try
+        {
+            ReadOnlySpan<byte> data = rented.AsSpan(0, buffer.Read(start, rented.AsSpan(0, length)));
+            int i = 0;
+            while ((i = IndexOf(data, pattern, i)) >= 0)
+            {
+                hits.Add((uint)i);
+                i++;
+            }
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(rented);
+        }
+        return hits;
+    }
+
+    /// <summary>Concatenates per-chunk hits in order, up to the first gap or the limit.</summary>
+    private static ByteMatchList Collect(List<uint>?[] chunkHits, int maxResults)
+    {
+        var bases = new List<long>();
+        var starts = new List<int>();
+        var deltas = new List<uint>();
+        bool truncated = false;
+
+        for (long c = 0; c < chunkHits.LongLength; c++)
+        {
+            List<uint>? hits = chunkHits[c];
+            if (hits is null)
+            {
+                // Not scanned: the loop broke after reaching the limit.
+                truncated = true;
+                break;
+            }
+            if (hits.Count == 0) continue;
+
+            int take = Math.Min(hits.Count, maxResults - deltas.Count);
+            bases.Add(c * ChunkSize);
+            starts.Add(deltas.Count);
+            deltas.AddRange(take == hits.Count ? hits : hits.GetRange(0, take));
+            if (deltas.Count >= maxResults)
+            {
+                truncated = take < hits.Count || c + 1 < chunkHits.LongLength;
+                break;
+            }
+        }
+
+        return new ByteMatchList([.. bases], [.. starts], [.. deltas], truncated);
+    }
+}
@@ -0,0 +1,238 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Search;
+
+/// <summary>
+/// A read-only text source made of the lines of a document that a
+/// <see cref="MatchLineIndex"/> selected, joined with line feeds, so that a
+/// <see cref="PieceTable"/> and an editor can show them like any document
+/// without copying them.  Line <c>i</c> of the source is document line
+/// <see cref="GetDocumentLine"/>(<c>i</c>).
+/// </summary>
+/// <remarks>
+/// <para>
+/// Reads find the matching lines with two binary searches, one over the
+/// blocks and one within a block, and copy the text from the document, so
+/// showing a screenful costs about as much as in the document itself.  Line
+/// starts are found the same way, so a <see cref="PieceTable"/> over the
+/// source never builds a table of every line.  Carriage returns before
+/// line feeds are left out.
+/// </para>
+/// <para>
+/// The source describes the document as it was when it was created and
+/// the index as it was when it was created or last extended with
+/// <see cref="MatchLineIndex.TryExtend"/>; extending only adds text at the
+/// end, which <see cref="PieceTable.AppendFromOriginal"/> takes in.  Reads
+/// may run on any thread while the source is extended.
+/// </para>
+/// </remarks>
+public sealed class FilteredTextSource : ITextSource, IPrecomputedLineFeeds, ILineLookup
+{
+    private readonly PieceTable _document;
+    private volatile Layout _layout;
+
+    internal FilteredTextSource(PieceTable document, MatchLineIndex.Block[] blocks, int generation)
+    {
+        _document = document;
+        Generation = generation;
+        _layout = Layout.Empty.Append(blocks);
+    }
+
+    /// <summary>Number of lines, one per match.</summary>
+    public long MatchCount => _layout.MatchCount;
+
+    /// <inheritdoc />
+    public long Length => _layout.Length;
+
+    /// <inheritdoc />
+    public int InitialLineFeedCount => (int)Math.Clamp(MatchCount - 1, 0, int.MaxValue);
+
+    /// <summary>Always <see langword="null"/>: lines are looked up through <see cref="ILineLookup"/>.</summary>
+    public long[]? LineOffsets => null;
+
+    /// <summary>The <see cref="MatchLineIndex"/> generation the blocks belong to.</summary>
+    internal int Generation { get; }
+
+    /// <summary>Number of blocks of the index taken in, with or without matches.</summary>
+    internal int IndexBlockCount => _layout.IndexBlockCount;
+
+    /// <summary>Adds blocks that the index appended after those already taken in.</summary>
+    internal void Append(IReadOnlyList<MatchLineIndex.Block> blocks) => _layout = _layout.Append(blocks);
+
+    /// <summary>
+    /// Returns the zero-based document line shown as line
+    /// <paramref name="line"/> of this source.
+    /// </summary>
+    public long GetDocumentLine(long line)
+    {
+        Layout layout = _layout;
+        if (layout.MatchCount == 0) return 0;
+        line = Math.Clamp(line, 0, layout.MatchCount - 1);
+
+        int b = UpperBound(layout.BlockMatches, line);
+        MatchLineIndex.Block block = layout.Blocks[b];
+        return block.FirstLine + block.Lines[line - layout.BlockMatches[b]];
+    }
+
+    /// <inheritdoc />
+    public long GetLineStart(long lineIndex)
+    {
+        Layout layout = _layout;
+        if (layout.MatchCount == 0 || lineIndex <= 0) return 0;
+        if (lineIndex >= layout.MatchCount) return layout.Length;
+
+        int b = UpperBound(layout.BlockMatches, lineIndex);
+        return layout.BlockStarts[b] + layout.Blocks[b].Starts[lineIndex - layout.BlockMatches[b]];
+    }
+
+    /// <inheritdoc />
+    public long GetLineAt(long offset)
+    {
+        Layout layout = _layout;
+        return layout.MatchCount == 0 ? 0 : MatchIndexAt(layout, offset);
+    }
+
+    /// <inheritdoc />
+    public char this[long index]
+    {
+        get
+        {
+            Span<char> one = stackalloc char[1];
+            CopyTo(index, one);
+            return one[0];
+        }
+    }
+
+    /// <inheritdoc />
+    public string GetText(long start, long length)
+    {
+        if (length == 0) return string.Empty;
+
+        var chars = new char[length];
+        CopyTo(start, chars);
+        return new string(chars);
+    }
+
+    /// <inheritdoc />
+    public void CopyTo(long start, Span<char> destination)
+    {
+        Layout layout = _layout;
+        if (start < 0 || start + destination.Length > layout.Length)
+            throw new ArgumentOutOfRangeException(nameof(start), "Range exceeds source length.");
+
+        int written = 0;
+        var (b, m) = FindMatch(layout, start);
+        long within = start - (layout.BlockStarts[b] + layout.Blocks[b].Starts[m]);
+        while (written < destination.Length)
+        {
+            MatchLineIndex.Block block = layout.Blocks[b];
+            int lineLength = LineLength(block, m);
+
+            if (within < lineLength)
+            {
+                int take = (int)Math.Min(lineLength - within, destination.Length - written);
+                long docOffset = _document.GetLineStartOffset(block.FirstLine + block.Lines[m]) + within;
+                _document.CopyTo(docOffset, destination.Slice(written, take));
+                written += take;
+                within += take;
+                continue;
+            }
+
+            destination[written++] = '\n';
+            within = 0;
+            if (++m == block.Lines.Length)
+            {
+                b++;
+                m = 0;
+            }
+        }
+    }
+
+    /// <inheritdoc />
+    public int CountLineFeeds(long start, long length)
+    {
+        Layout layout = _layout;
+        if (length == 0 || layout.MatchCount == 0) return 0;
+
+        // The line feed after a match is the last character of its line in
+        // this source, so the line feeds in a range are the lines that
+        // start after its first character up to its end.
+        return (int)(MatchIndexAt(layout, start + length) - MatchIndexAt(layout, start));
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Lookup
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>The block and the match in it whose line holds <paramref name="offset"/>.</summary>
+    private static (int Block, int Match) FindMatch(Layout layout, long offset)
+    {
+        int b = UpperBound(layout.BlockStarts, offset);
+        long relative = offset - layout.BlockStarts[b];
+        int[] starts = layout.Blocks[b].Starts;
+        int m = Array.BinarySearch(starts, (int)Math.Min(relative, int.MaxValue));
+        return (b, m >= 0 ? m : ~m - 1);
+    }
+
+    private static long MatchIndexAt(Layout layout, long offset)
+    {
+        var (b, m) = FindMatch(layout, Math.Clamp(offset, 0, layout.Length));
+        return layout.BlockMatches[b] + m;
+    }
+
+    private static int LineLength(MatchLineIndex.Block block, int m) =>
+        (m + 1 < block.Starts.Length ? block.Starts[m + 1] : block.ProjectedLength) - block.Starts[m] - 1;
+
+    /// <summary>
+    /// Index of the last element not greater than <paramref name="value"/>
+    /// in a strictly increasing array.
+    /// </summary>
+    private static int UpperBound(long[] sorted, long value)
+    {
+        int i = Array.BinarySearch(sorted, value);
+        return i >= 0 ? i : Math.Max(0, ~i - 1);
+    }
+
+    /// <summary>
+    /// The blocks with matches and where each starts, replaced as a whole
+    /// when the source is extended so that readers see one consistent set.
+    /// </summary>
+    private sealed class Layout(MatchLineIndex.Block[] blocks, long[] blockStarts, long[] blockMatches,
+        long projectedLength, long matchCount, int indexBlockCount)
+    {
+        public static readonly Layout Empty = new([], [], [], 0, 0, 0);
+
+        public MatchLineIndex.Block[] Blocks { get; } = blocks;
+        public long[] BlockStarts { get; } = blockStarts;    // Offset of each block in the source.
+        public long[] BlockMatches { get; } = blockMatches;  // Matches before each block.
+        public long MatchCount { get; } = matchCount;
+        public int IndexBlockCount { get; } = indexBlockCount;
+
+        // The line feed after the last line is left out.
+        public long Length => Math.Max(0, projectedLength - 1);
+
+        public Layout Append(IReadOnlyList<MatchLineIndex.Block> added)
+        {
+            // Blocks without matches add nothing and are left out.
+            var kept = added.Where(b => b.Lines.Length > 0).ToArray();
+            int count = Blocks.Length + kept.Length;
+            var all = new MatchLineIndex.Block[count];
+            var starts = new long[count];
+            var matches = new long[count];
+            Array.Copy(Blocks, all, Blocks.Length);
+            Array.Copy(BlockStarts, starts, Blocks.Length);
+            Array.Copy(BlockMatches, matches, Blocks.Length);
+
+            long offset = projectedLength, matchTotal = MatchCount;
+            for (int i = 0; i < kept.Length; i++)
+            {
+                all[Blocks.Length + i] = kept[i];
+                starts[Blocks.Length + i] = offset;
+                matches[Blocks.Length + i] = matchTotal;
+                offset += kept[i].ProjectedLength;
+                matchTotal += kept[i].Lines.Length;
+            }
+            return new Layout(all, starts, matches, offset, matchTotal, IndexBlockCount + added.Count);
+        }
+    }
+}
@@ -0,0 +1,8 @@
+namespace Bascanka.Core.Search;
+
+/// <summary>
+/// Decides whether a single line (without its line feed) is selected.
+/// Implementations created by <see cref="SearchEngine.CreateLinePredicate"/>
+/// are thread-safe and do not allocate.
+/// </summary>
+public delegate bool LinePredicate(ReadOnlySpan<char> line);
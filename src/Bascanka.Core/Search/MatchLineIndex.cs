@@ -0,0 +1,399 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Transforms;
+
+namespace Bascanka.Core.Search;
+
+/// <summary>
+/// The numbers of the lines of a document that a predicate selects, kept
+/// compactly per block of about 1M characters of whole lines: each block
+/// stores its first line and, per matching line, the line's position in
+/// the block and in the filtered text, as two 32-bit integers.
+/// </summary>
+/// <remarks>
+/// <para>
+/// <see cref="IndexRemaining"/> reads blocks in order and tests their lines
+/// in parallel, publishing each batch as it completes, so a view built on
+/// the index can show the first matches while the rest of the document is
+/// still being read.  It continues from where the index ends, which also
+/// covers a document that grew at the end.
+/// </para>
+/// <para>
+/// <see cref="Update"/> applies an edit by testing again only the blocks
+/// the edit touched and shifting the blocks after them.  Queries may run
+/// on any thread while a build or an update is running; builds and updates
+/// must not run at the same time.  The index remembers the document it
+/// last read, usually a snapshot, so that <see cref="CreateSource()"/> can
+/// show the lines as they were indexed while the live document is edited.
+/// </para>
+/// </remarks>
+public sealed class MatchLineIndex
+{
+    private readonly object _lock = new();
+    private readonly List<Block> _blocks = [];
+    private int _version;
+    // Incremented by every change other than blocks added at the end.
+    private int _generation;
+    private PieceTable? _document;
+
+    /// <summary>Creates an empty index of the lines <paramref name="match"/> selects.</summary>
+    /// <param name="match">Selects the lines to index; called from several threads at once.</param>
+    public MatchLineIndex(LinePredicate match)
+    {
+        ArgumentNullException.ThrowIfNull(match);
+        Match = match;
+    }
+
+    /// <summary>Selects the indexed lines.</summary>
+    public LinePredicate Match { get; }
+
+    /// <summary>Characters of the document indexed so far, from its start.</summary>
+    public long IndexedLength
+    {
+        get
+        {
+            lock (_lock)
+                return _blocks.Count > 0 ? _blocks[^1].End : 0;
+        }
+    }
+
+    /// <summary>Number of matching lines indexed so far.</summary>
+    public long MatchCount
+    {
+        get
+        {
+            lock (_lock)
+            {
+                long count = 0;
+                foreach (Block block in _blocks)
+                    count += block.Lines.Length;
+                return count;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Incremented whenever the index changes, so that views can tell when
+    /// to refresh.
+    /// </summary>
+    public int Version
+    {
+        get
+        {
+            lock (_lock)
+                return _version;
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Building
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Indexes <paramref name="document"/> from the end of the index to the
+    /// end of the document.
+    /// </summary>
+    /// <param name="document">
+    /// The document to read, usually a snapshot; it must not change during
+    /// the build, and must start with the text already indexed.
+    /// </param>
+    /// <param name="progress">Receives the percentage of the document indexed.</param>
+    /// <param name="cancellationToken">Cancels the build between batches of blocks.</param>
+    /// <exception cref="OperationCanceledException">The build was cancelled.</exception>
+    public void IndexRemaining(PieceTable document, IProgress<int>? progress = null,
+        CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        long start, firstLine;
+        lock (_lock)
+        {
+            SetDocument(document);
+
+            // A last block without a final line break may have a longer last
+            // line now, so it is read again.
+            if (_blocks.Count > 0 && !_blocks[^1].EndsWithLineBreak)
+            {
+                _blocks.RemoveAt(_blocks.Count - 1);
+                _version++;
+                _generation++;
+            }
+            start = _blocks.Count > 0 ? _blocks[^1].End : 0;
+            firstLine = _blocks.Count > 0 ? _blocks[^1].FirstLine + _blocks[^1].LineCount : 0;
+        }
+
+        long length = document.Length;
+        int lastPercent = -1;
+        foreach (List<Block> batch in Scan(document, start, length - start, firstLine, cancellationToken))
+        {
+            lock (_lock)
+            {
+                _blocks.AddRange(batch);
+                _version++;
+            }
+            LineWindows.Report(progress, (int)(batch[^1].End * 100 / Math.Max(length, 1)), ref lastPercent);
+        }
+    }
+
+    /// <summary>
+    /// Brings the index up to date with an edit of <paramref name="document"/>
+    /// by testing again the lines of the blocks the edit touched.
+    /// </summary>
+    /// <param name="document">The document after the edit.</param>
+    /// <param name="offset">Where the edit starts.</param>
+    /// <param name="oldLength">Characters the edit removed.</param>
+    /// <param name="newLength">Characters the edit inserted.</param>
+    public void Update(PieceTable document, long offset, long oldLength, long newLength)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        // Only this method and builds change the blocks, and never at the
+        // same time, so they are read here without the lock and the lines
+        // are tested again outside it; readers wait only for the swap.
+        long oldEnd = offset + oldLength;
+        long indexedEnd = _blocks.Count > 0 ? _blocks[^1].End : 0;
+        if (offset > indexedEnd)
+        {
+            // Beyond the index; a build will reach it.
+            lock (_lock)
+                SetDocument(document);
+            return;
+        }
+
+        // The first block the edit touches: one that contains the edit
+        // start, or ends there without a line break, so that text added
+        // to its last line joins it.
+        int first = 0;
+        while (first < _blocks.Count && _blocks[first].End < offset)
+            first++;
+        if (first < _blocks.Count && _blocks[first].End == offset && _blocks[first].EndsWithLineBreak)
+            first++;
+
+        // The last block the edit touches; a block that starts right at
+        // the end of a removal is included too, since its first line may
+        // have joined the line before it.
+        int last = first - 1;
+        while (last + 1 < _blocks.Count && _blocks[last + 1].Offset <= oldEnd)
+            last++;
+
+        long start = first < _blocks.Count ? _blocks[first].Offset : indexedEnd;
+        long firstLine = first < _blocks.Count
+            ? _blocks[first].FirstLine
+            : _blocks.Count > 0 ? _blocks[^1].FirstLine + _blocks[^1].LineCount : 0;
+        long end = Math.Max(last >= first ? _blocks[last].End : start, oldEnd);
+        long delta = newLength - oldLength;
+
+        long oldLines = 0;
+        for (int i = first; i <= last; i++)
+            oldLines += _blocks[i].LineCount;
+
+        var replacement = new List<Block>();
+        foreach (List<Block> batch in Scan(document, start, end + delta - start, firstLine, CancellationToken.None))
+            replacement.AddRange(batch);
+
+        long newLines = 0;
+        foreach (Block block in replacement)
+            newLines += block.LineCount;
+
+        lock (_lock)
+        {
+            for (int i = last + 1; i < _blocks.Count; i++)
+                _blocks[i] = _blocks[i] with
+                {
+                    Offset = _blocks[i].Offset + delta,
+                    FirstLine = _blocks[i].FirstLine + newLines - oldLines,
+                };
+            _blocks.RemoveRange(first, last - first + 1);
+            _blocks.InsertRange(first, replacement);
+            _version++;
+            _generation++;
+            _document = document;
+        }
+    }
+
+    /// <summary>Empties the index, for a document that was replaced.</summary>
+    public void Clear()
+    {
+        lock (_lock)
+        {
+            _blocks.Clear();
+            _version++;
+            _generation++;
+        }
+    }
+
+    /// <summary>
+    /// Moves the index to <paramref name="document"/>, which replaced the
+    /// one indexed: what was read is kept when it is still the start of the
+    /// new document, as with a reloaded log that grew, and dropped otherwise.
+    /// </summary>
+    public void Rebase(PieceTable document)
+    {
+        bool keep = IsPrefixOf(document);
+        lock (_lock)
+        {
+            if (!keep)
+                _blocks.Clear();
+            SetDocument(document);
+        }
+    }
+
+    /// <summary>
+    /// Returns whether the index still describes the start of
+    /// <paramref name="document"/>, judged by the text of its first and last
+    /// blocks: the check a reloaded log that has grown at the end passes.
+    /// </summary>
+    public bool IsPrefixOf(PieceTable document)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        lock (_lock)
+        {
+            if (_blocks.Count == 0) return true;
+            if (_blocks[^1].End > document.Length) return false;
+            return SameLines(_blocks[0]) && SameLines(_blocks[^1]);
+        }
+
+        bool SameLines(Block block)
+        {
+            string text = document.GetText(block.Offset, block.End - block.Offset);
+            return LineHash.Compute(text) == block.Hash;
+        }
+    }
+
+    /// <summary>
+    /// Returns a read-only view of the matching lines as the index stands
+    /// now, read from the document the index last read.
+    /// </summary>
+    public FilteredTextSource CreateSource()
+    {
+        lock (_lock)
+            return new FilteredTextSource(_document ?? new PieceTable(string.Empty), [.. _blocks], _generation);
+    }
+
+    /// <summary>
+    /// Returns a read-only view of the matching lines of
+    /// <paramref name="document"/>, as the index stands now.
+    /// </summary>
+    /// <param name="document">The document the index describes; read whenever the view is.</param>
+    public FilteredTextSource CreateSource(PieceTable document)
+    {
+        ArgumentNullException.ThrowIfNull(document);
+
+        lock (_lock)
+            return new FilteredTextSource(document, [.. _blocks], _generation);
+    }
+
+    /// <summary>
+    /// Adds to <paramref name="source"/> the blocks indexed since it was
+    /// created or last extended, when the index has only grown at the end
+    /// of the same document since.  Returns <see langword="false"/>, leaving the source as it
+    /// is, when the index changed otherwise and a new source is needed.
+    /// </summary>
+    public bool TryExtend(FilteredTextSource source)
+    {
+        ArgumentNullException.ThrowIfNull(source);
+
+        lock (_lock)
+        {
+            if (source.Generation != _generation) return false;
+
+            int taken = source.IndexBlockCount;
+            if (taken < _blocks.Count)
+                source.Append(_blocks.GetRange(taken, _blocks.Count - taken));
+            return true;
+        }
+    }
+
+    /// <summary>Records the document the blocks describe; called under the lock.</summary>
+    private void SetDocument(PieceTable document)
+    {
+        if (ReferenceEquals(document, _document)) return;
+        _document = document;
+        _version++;
+        _generation++;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Scanning
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Reads the range in windows of whole lines and tests the windows of
+    /// each batch in parallel, yielding the batches in order.
+    /// </summary>
+    private IEnumerable<List<Block>> Scan(PieceTable document, long start, long length, long firstLine,
+        CancellationToken cancellationToken)
+    {
+        var options = new ParallelOptions { CancellationToken = cancellationToken };
+        var windows = new List<(long Offset, ReadOnlyMemory<char> Text)>(Environment.ProcessorCount);
+        using var enumerator = LineWindows.Enumerate(document, start, length, cancellationToken).GetEnumerator();
+        bool more = true;
+        while (more)
+        {
+            windows.Clear();
+            while (windows.Count < Environment.ProcessorCount && (more = enumerator.MoveNext()))
+                windows.Add(enumerator.Current);
+            if (windows.Count == 0) yield break;
+
+            var blocks = new Block[windows.Count];
+            Parallel.For(0, windows.Count, options, i =>
+                blocks[i] = ScanWindow(windows[i].Offset, windows[i].Text.Span));
+
+            var batch = new List<Block>(blocks.Length);
+            foreach (Block block in blocks)
+            {
+                batch.Add(block with { FirstLine = firstLine });
+                firstLine += block.LineCount;
+            }
+            yield return batch;
+        }
+    }
+
+    private Block ScanWindow(long offset, ReadOnlySpan<char> text)
+    {
+        var lines = new List<int>();
+        var starts = new List<int>();
+        int projected = 0;
+        int lineCount = 0;
+        int pos = 0;
+        while (pos < text.Length)
+        {
+            int lf = text[pos..].IndexOf('\n');
+            int next = lf < 0 ? text.Length : pos + lf + 1;
+            ReadOnlySpan<char> line = text[pos..(lf < 0 ? text.Length : pos + lf)];
+            if (line.Length > 0 && line[^1] == '\r')
+                line = line[..^1];
+
+            if (Match(line))
+            {
+                lines.Add(lineCount);
+                starts.Add(projected);
+                projected += line.Length + 1;
+            }
+            lineCount++;
+            pos = next;
+        }
+
+        return new Block(offset, text.Length, 0, lineCount, [.. lines], [.. starts], projected,
+            text.Length > 0 && text[^1] == '\n', LineHash.Compute(text));
+    }
+
+    /// <summary>
+    /// A block of whole lines and its matches.  Each matching line occupies
+    /// its text and one line feed in the filtered text.
+    /// </summary>
+    /// <param name="Offset">Where the block starts in the document.</param>
+    /// <param name="Length">Characters in the block.</param>
+    /// <param name="FirstLine">Document line on which the block starts.</param>
+    /// <param name="LineCount">Lines in the block.</param>
+    /// <param name="Lines">Block-relative line numbers of the matches.</param>
+    /// <param name="Starts">Block-relative offsets of the matches in the filtered text.</param>
+    /// <param name="ProjectedLength">Characters the block adds to the filtered text.</param>
+    /// <param name="EndsWithLineBreak">Whether the block ends with a line feed.</param>
+    /// <param name="Hash">Hash of the block's text, to recognise it after a reload.</param>
+    internal readonly record struct Block(long Offset, int Length, long FirstLine, int LineCount,
+        int[] Lines, int[] Starts, int ProjectedLength, bool EndsWithLineBreak, UInt128 Hash)
+    {
+        public long End => Offset + Length;
+    }
+}
@@ -0,0 +1,148 @@
+using System.Buffers;
+
+namespace Bascanka.Core.Search;
+
+/// <summary>
+/// Finds which of a fixed set of literal strings occur in a text, in a single
+/// left-to-right pass (Aho–Corasick).  The cost of a scan depends on the text
+/// length, not on the number of literals, so it scales to large rule sets.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Matching is ordinal and case-sensitive.  While the automaton is at its
+/// root the scan jumps ahead with a vectorised search for any literal's
+/// first character, so text containing none of the literals is skipped at
+/// memory speed.
+/// </para>
+/// <para>Instances are immutable after construction and safe to share
+/// between threads.</para>
+/// </remarks>
+public sealed class MultiLiteralMatcher
+{
+    // Transitions of node n are _edgeChars[n] (sorted) → _edgeTargets[n].
+    private readonly char[][] _edgeChars;
+    private readonly int[][] _edgeTargets;
+    private readonly int[] _fail;
+    // Literal ids ending at each node, including those reached through failure links.
+    private readonly int[][] _outputs;
+    private readonly SearchValues<char> _firstChars;
+
+    /// <summary>
+    /// Builds the automaton.  Literal <c>i</c> is reported as id <c>i</c>;
+    /// empty literals never match.
+    /// </summary>
+    public MultiLiteralMatcher(IReadOnlyList<string> literals)
+    {
+        ArgumentNullException.ThrowIfNull(literals);
+        Count = literals.Count;
+
+        // Trie.
+        var edges = new List<Dictionary<char, int>> { new() };
+        var outputs = new List<List<int>> { new() };
+        var firstChars = new HashSet<char>();
+        for (int id = 0; id < literals.Count; id++)
+        {
+            string literal = literals[id] ?? throw new ArgumentException("Literals must not be null.", nameof(literals));
+            if (literal.Length == 0) continue;
+
+            firstChars.Add(literal[0]);
+            int node = 0;
+            foreach (char c in literal)
+            {
+                if (!edges[node].TryGetValue(c, out int child))
+                {
+                    child = edges.Count;
+                    edges.Add(new Dictionary<char, int>());
+                    outputs.Add(new List<int>());
+                    edges[node][c] = child;
+                }
+                node = child;
+            }
+            outputs[node].Add(id);
+        }
+
+        // Failure links, breadth first so a node's fail target is complete
+        // before the node itself.
+        var fail = new int[edges.Count];
+        var queue = new Queue<int>();
+        foreach (int child in edges[0].Values)
+            queue.Enqueue(child);
+
+        while (queue.Count > 0)
+        {
+            int node = queue.Dequeue();
+            foreach (var (c, child) in edges[node])
+            {
+                int f = fail[node];
+                while (f != 0 && !edges[f].ContainsKey(c))
+                    f = fail[f];
+                fail[child] = edges[f].TryGetValue(c, out int target) && target != child ? target : 0;
+                outputs[child].AddRange(outputs[fail[child]]);
+                queue.Enqueue(child);
+            }
+        }
+
+        _fail = fail;
+        _edgeChars = new char[edges.Count][];
+        _edgeTargets = new int[edges.Count][];
+        _outputs = new int[edges.Count][];
+        for (int n = 0; n < edges.Count; n++)
+        {
+            char[] chars = [.. edges[n].Keys];
+            Array.Sort(chars);
+            _edgeChars[n] = chars;
+            _edgeTargets[n] = Array.ConvertAll(chars, c => edges[n][c]);
+            _outputs[n] = [.. outputs[n]];
+        }
+        _firstChars = SearchValues.Create([.. firstChars]);
+    }
+
+    /// <summary>Number of literals the matcher was built with.</summary>
+    public int Count { get; }
+
+    /// <summary>
+    /// Sets <c>present[id]</c> for every literal occurring in
+    /// <paramref name="text"/>.  Entries for absent literals are left
+    /// untouched, so callers clear <paramref name="present"/> first.
+    /// </summary>
+    /// <returns>The number of distinct literals newly marked present.</returns>
+    public int FindPresent(ReadOnlySpan<char> text, Span<bool> present)
+    {
+        if (present.Length < Count)
+            throw new ArgumentException("Span is shorter than the number of literals.", nameof(present));
+
+        int found = 0;
+        int state = 0;
+        int i = 0;
+        while (i < text.Length)
+        {
+            if (state == 0)
+            {
+                int skip = text[i..].IndexOfAny(_firstChars);
+                if (skip < 0) break;
+                i += skip;
+            }
+
+            char c = text[i];
+            int next;
+            while ((next = Step(state, c)) < 0 && state != 0)
+                state = _fail[state];
+            state = Math.Max(next, 0);
+
+            foreach (int id in _outputs[state])
+            {
+                if (present[id]) continue;
+                present[id] = true;
+                if (++found == Count) return found;
+            }
+            i++;
+        }
+        return found;
+    }
+
+    private int Step(int state, char c)
+    {
+        int index = _edgeChars[state].AsSpan().BinarySearch(c);
+        return index >= 0 ? _edgeTargets[state][index] : -1;
+    }
+}
@@ -0,0 +1,402 @@
+using System.Globalization;
+using System.Text.RegularExpressions;
+
+namespace Bascanka.Core.Search;
+
+/// <summary>
+/// Derives, from a regular expression pattern, a set of literal strings at
+/// least one of which must occur in any text the pattern matches.  Callers
+/// use the set as a cheap prefilter: if none of the literals is present the
+/// regex cannot match and need not run.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The analysis is deliberately conservative.  Character classes, escapes
+/// such as <c>\d</c>, anchors, lookarounds, back-references and optional
+/// items simply end a literal run; any construct that changes how literals
+/// match (case-insensitive or pattern-whitespace options) disables the
+/// prefilter for the whole pattern.  Top-level and grouped alternations
+/// contribute one literal per branch, e.g. <c>\b(ERROR|FATAL)\b</c> yields
+/// <c>{ "ERROR", "FATAL" }</c>.
+/// </para>
+/// </remarks>
+public static class RegexLiteralExtractor
+{
+    /// <summary>
+    /// Returns literals of which at least one occurs (case-sensitively) in
+    /// every match of <paramref name="pattern"/>, or <see langword="null"/>
+    /// when no such set can be proven.
+    /// </summary>
+    public static string[]? GetRequiredLiterals(string pattern, RegexOptions options = RegexOptions.None)
+    {
+        ArgumentNullException.ThrowIfNull(pattern);
+
+        if ((options & (RegexOptions.IgnoreCase | RegexOptions.IgnorePatternWhitespace)) != 0)
+            return null;
+
+        bool unsupported = false;
+        List<string>? literals = Alternation(pattern, 0, pattern.Length, ref unsupported);
+        if (unsupported || literals is null || literals.Count == 0)
+            return null;
+        return [.. literals.Distinct(StringComparer.Ordinal)];
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Parsing
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Literals required by <c>pattern[start..end)</c>, which may contain
+    /// top-level alternation: one set per branch, all of which must exist.
+    /// </summary>
+    private static List<string>? Alternation(string p, int start, int end, ref bool unsupported)
+    {
+        var result = new List<string>();
+        int branchStart = start;
+        int i = start;
+        while (true)
+        {
+            if (i >= end || p[i] == '|')
+            {
+                List<string>? branch = Sequence(p, branchStart, i, ref unsupported);
+                if (unsupported || branch is null) return null;
+                result.AddRange(branch);
+                if (i >= end) return result;
+                branchStart = ++i;
+                continue;
+            }
+
+            i = SkipAtom(p, i, end, ref unsupported);
+            if (unsupported) return null;
+        }
+    }
+
+    /// <summary>
+    /// Picks the most selective requirement within a branch: the longest
+    /// literal run, or a mandatory group whose own alternatives are longer.
+    /// </summary>
+    private static List<string>? Sequence(string p, int start, int end, ref bool unsupported)
+    {
+        List<string>? best = null;
+        var run = new System.Text.StringBuilder();
+
+        void Consider(List<string> candidate)
+        {
+            if (candidate.Count == 0) return;
+            if (best is null || Score(candidate) > Score(best) ||
+                (Score(candidate) == Score(best) && candidate.Count < best.Count))
+                best = candidate;
+        }
+
+        void Flush()
+        {
+            if (run.Length > 0)
+                Consider([run.ToString()]);
+            run.Clear();
+        }
+
+        int i = start;
+        while (i < end)
+        {
+            char c = p[i];
+            int atomEnd;
+            int literal = -1;           // literal character, or -1
+            (int Start, int End)? group = null;
+
+            switch (c)
+            {
+                case '\\':
+                    atomEnd = ParseEscape(p, i, end, out literal, ref unsupported);
+                    break;
+                case '[':
+                    atomEnd = SkipClass(p, i, end, ref unsupported);
+                    break;
+                case '(':
+                    atomEnd = FindGroupEnd(p, i, end, ref unsupported);
+                    if (unsupported) return null;
+                    group = GroupBody(p, i, atomEnd - 1, ref unsupported);
+                    break;
+                case ')':
+                    unsupported = true;
+                    return null;
+                case '.' or '^' or '$':
+                    atomEnd = i + 1;
+                    break;
+                default:
+                    atomEnd = i + 1;
+                    literal = c;
+                    break;
+            }
+            if (unsupported) return null;
+
+            int next = ParseQuantifier(p, atomEnd, end, out int minCount);
+            bool quantified = next != atomEnd;
+
+            if (literal >= 0)
+            {
+                if (quantified && minCount == 0)
+                {
+                    Flush();
+                }
+                else
+                {
+                    run.Append((char)literal);
+                    if (quantified) Flush();
+                }
+            }
+            else
+            {
+                Flush();
+                if (group is { } body && (!quantified || minCount > 0))
+                {
+                    List<string>? inner = Alternation(p, body.Start, body.End, ref unsupported);
+                    if (unsupported) return null;
+                    if (inner is not null) Consider(inner);
+                }
+            }
+
+            i = next;
+        }
+
+        Flush();
+        return best;
+    }
+
+    private static int Score(List<string> literals)
+    {
+        int min = int.MaxValue;
+        foreach (string s in literals)
+            min = Math.Min(min, s.Length);
+        return min;
+    }
+
+    /// <summary>Advances past one atom and its quantifier without analysing it.</summary>
+    private static int SkipAtom(string p, int i, int end, ref bool unsupported)
+    {
+        int atomEnd = p[i] switch
+        {
+            '\\' => ParseEscape(p, i, end, out _, ref unsupported),
+            '[' => SkipClass(p, i, end, ref unsupported),
+            '(' => FindGroupEnd(p, i, end, ref unsupported),
+            _ => i + 1,
+        };
+        return unsupported ? end : ParseQuantifier(p, atomEnd, end, out _);
+    }
+
+    /// <summary>
+    /// Parses the escape at <paramref name="i"/>.  Sets <paramref name="literal"/>
+    /// to the character it denotes, or -1 for classes, anchors and references.
+    /// </summary>
+    private static int ParseEscape(string p, int i, int end, out int literal, ref bool unsupported)
+    {
+        literal = -1;
+        if (i + 1 >= end)
+        {
+            unsupported = true;
+            return end;
+        }
+
+        char d = p[i + 1];
+        switch (d)
+        {
+            case 't': literal = '\t'; return i + 2;
+            case 'n': literal = '\n'; return i + 2;
+            case 'r': literal = '\r'; return i + 2;
+            case 'f': literal = '\f'; return i + 2;
+            case 'v': literal = '\v'; return i + 2;
+            case 'e': literal = '\u001B'; return i + 2;
+            case 'a': literal = '\u0007'; return i + 2;
+            case 'x': return ParseHexEscape(p, i, end, 2, out literal);
+            case 'u': return ParseHexEscape(p, i, end, 4, out literal);
+            case 'c': return Math.Min(end, i + 3);
+            case 'p' or 'P':
+                return SkipDelimited(p, i + 2, end, '{', '}');
+            case 'k':
+                if (i + 2 < end && p[i + 2] == '<') return SkipDelimited(p, i + 2, end, '<', '>');
+                if (i + 2 < end && p[i + 2] == '\'') return SkipDelimited(p, i + 2, end, '\'', '\'');
+                return i + 2;
+        }
+
+        if (char.IsAsciiDigit(d))
+        {
+            int j = i + 1;
+            while (j < end && char.IsAsciiDigit(p[j])) j++;
+            return j;
+        }
+
+        if (char.IsAsciiLetter(d))
+            return i + 2;    // \d \w \s \b \A \z and friends
+
+        literal = d;
+        return i + 2;
+    }
+
+    private static int ParseHexEscape(string p, int i, int end, int digits, out int literal)
+    {
+        literal = -1;
+        int start = i + 2;
+        if (start + digits <= end &&
+            int.TryParse(p.AsSpan(start, digits), NumberStyles.AllowHexSpecifier, CultureInfo.InvariantCulture, out int value))
+        {
+            literal = value;
+            return start + digits;
+        }
+        return Math.Min(end, start);
+    }
+
+    private static int SkipDelimited(string p, int i, int end, char open, char close)
+    {
+        if (i >= end || p[i] != open) return i;
+        int j = p.IndexOf(close, i + 1, end - i - 1);
+        return j < 0 ? end : j + 1;
+    }
+
+    /// <summary>
+    /// Returns the index just past the character class at <paramref name="i"/>,
+    /// including a trailing .NET class subtraction such as <c>[a-z-[aeiou]]</c>.
+    /// </summary>
+    private static int SkipClass(string p, int i, int end, ref bool unsupported)
+    {
+        int j = i + 1;
+        if (j < end && p[j] == '^') j++;
+        if (j < end && p[j] == ']') j++;     // leading ']' is literal
+        while (j < end)
+        {
+            char c = p[j];
+            if (c == '\\') { j += 2; continue; }
+            if (c == ']') return j + 1;
+            if (c == '-' && j + 1 < end && p[j + 1] == '[')
+            {
+                // Subtraction must be the last item, so the nested class is
+                // followed by the outer ']'.
+                j = SkipClass(p, j + 1, end, ref unsupported);
+                if (!unsupported && j < end && p[j] == ']') return j + 1;
+                break;
+            }
+            j++;
+        }
+        unsupported = true;
+        return end;
+    }
+
+    /// <summary>Returns the index just past the ')' matching the '(' at <paramref name="i"/>.</summary>
+    private static int FindGroupEnd(string p, int i, int end, ref bool unsupported)
+    {
+        int depth = 0;
+        int j = i;
+        while (j < end)
+        {
+            char c = p[j];
+            if (c == '\\') { j += 2; continue; }
+            if (c == '[')
+            {
+                j = SkipClass(p, j, end, ref unsupported);
+                if (unsupported) return end;
+                continue;
+            }
+            if (c == '(') depth++;
+            else if (c == ')' && --depth == 0) return j + 1;
+            j++;
+        }
+        unsupported = true;
+        return end;
+    }
+
+    /// <summary>
+    /// Returns the body range of a capturing, non-capturing, named or atomic
+    /// group, or <see langword="null"/> for lookarounds, conditionals and
+    /// option groups, which are not analysed.
+    /// </summary>
+    private static (int Start, int End)? GroupBody(string p, int open, int close, ref bool unsupported)
+    {
+        int i = open + 1;
+        if (i >= close || p[i] != '?')
+            return (i, close);
+
+        char k = i + 1 < close ? p[i + 1] : '\0';
+        switch (k)
+        {
+            case ':' or '>':
+                return (i + 2, close);
+            case '=' or '!' or '#':
+                return null;
+            case '<' when i + 2 < close && p[i + 2] is '=' or '!':
+                return null;
+            case '<':
+            {
+                int nameEnd = p.IndexOf('>', i + 2, close - i - 2);
+                return nameEnd < 0 ? null : (nameEnd + 1, close);
+            }
+            case '\'':
+            {
+                int nameEnd = p.IndexOf('\'', i + 2, close - i - 2);
+                return nameEnd < 0 ? null : (nameEnd + 1, close);
+            }
+            case '(':
+                return null;
+        }
+
+        // Inline options: (?imnsx-imnsx) or (?imnsx-imnsx:...)
+        int j = i + 1;
+        bool enabling = true, changesLiterals = false;
+        while (j < close && p[j] is not ':' and not ')')
+        {
+            if (p[j] == '-') enabling = false;
+            else if (enabling && p[j] is 'i' or 'x') changesLiterals = true;
+            j++;
+        }
+
+        if (j >= close)
+        {
+            // Options apply to the rest of the enclosing group.
+            if (changesLiterals) unsupported = true;
+            return null;
+        }
+
+        return changesLiterals ? null : (j + 1, close);
+    }
+
+    /// <summary>
+    /// Parses a quantifier at <paramref name="i"/>, if any, returning the
+    /// index past it and its minimum repeat count (1 when absent).
+    /// </summary>
+    private static int ParseQuantifier(string p, int i, int end, out int minCount)
+    {
+        minCount = 1;
+        if (i >= end) return i;
+
+        int j;
+        switch (p[i])
+        {
+            case '*' or '?':
+                minCount = 0;
+                j = i + 1;
+                break;
+            case '+':
+                j = i + 1;
+                break;
+            case '{':
+            {
+                int k = i + 1;
+                int digitsStart = k;
+                while (k < end && char.IsAsciiDigit(p[k])) k++;
+                if (k == digitsStart) return i;
+                int min = int.Parse(p.AsSpan(digitsStart, Math.Min(9, k - digitsStart)), CultureInfo.InvariantCulture);
+                if (k < end && p[k] == ',')
+                {
+                    k++;
+                    while (k < end && char.IsAsciiDigit(p[k])) k++;
+                }
+                if (k >= end || p[k] != '}') return i;   // not a quantifier: '{' is literal
+                minCount = min;
+                j = k + 1;
+                break;
+            }
+            default:
+                return i;
+        }
+
+        if (j < end && p[j] == '?') j++;     // lazy
+        return j;
+    }
+}
@@ -730,6 +730,30 @@ public sealed class SearchEngine
         return new Regex(pattern, regexOptions, TimeSpan.FromSeconds(5));
     }
 
+    /// <summary>
+    /// Returns a predicate that selects the lines containing a match for
+    /// <paramref name="options"/>, with the same literal, case and
+    /// whole-word rules as <see cref="FindAll"/>.  The predicate may be
+    /// called from several threads at once.
+    /// </summary>
+    public static LinePredicate CreateLinePredicate(SearchOptions options)
+    {
+        ArgumentNullException.ThrowIfNull(options);
+        ArgumentException.ThrowIfNullOrEmpty(options.Pattern);
+
+        if (!options.UseRegex && !options.WholeWord)
+        {
+            string pattern = options.Pattern;
+            var comparison = options.MatchCase
+                ? StringComparison.Ordinal
+                : StringComparison.OrdinalIgnoreCase;
+            return line => line.IndexOf(pattern.AsSpan(), comparison) >= 0;
+        }
+
+        Regex regex = BuildPattern(options);
+        return line => regex.IsMatch(line);
+    }
+
     /// <summary>
     /// Searches a sub-range of the buffer for the first forward match,
     /// using windowed 4 MB passes to avoid loading the entire range as
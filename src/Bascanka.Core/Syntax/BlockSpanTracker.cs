@@ -0,0 +1,512 @@
+using System.Text.RegularExpressions;
+
+namespace Bascanka.Core.Syntax;
+
+/// <summary>
+/// A block found by a <see cref="BlockSpanTracker"/>: the lines from one
+/// that matches a rule's begin pattern to the next that matches its end
+/// pattern, both included.
+/// </summary>
+/// <param name="Rule">Index of the rule in the tracker's rule list.</param>
+/// <param name="StartLine">Line that opened the block.</param>
+/// <param name="EndLine">Line that closed the block, or the last line of the document.</param>
+public readonly record struct BlockSpan(int Rule, long StartLine, long EndLine);
+
+/// <summary>
+/// Maintains the spans of line-based begin/end block rules across edits.
+/// The per-rule open/closed state is recorded at line checkpoints, so an edit
+/// re-scans only from the checkpoint before it until the state matches a
+/// checkpoint recorded after it again; everything beyond is reused, shifted
+/// by the number of inserted or deleted lines.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The first scan of a document runs in parallel: line text is read on the
+/// calling thread in chunks of <see cref="ChunkLines"/> lines and each chunk
+/// is matched on the thread pool as if no block were open at its start.  A
+/// sequential fix-up pass then re-scans the beginning of any chunk whose real
+/// incoming state differs, until it converges with that chunk's own
+/// checkpoints.
+/// </para>
+/// <para>This class is <b>not</b> thread-safe; callers must synchronize
+/// externally if they access it from multiple threads.</para>
+/// </remarks>
+public sealed class BlockSpanTracker
+{
+    /// <summary>Distance in lines between recorded state checkpoints.</summary>
+    public const int CheckpointInterval = 128;
+
+    /// <summary>Lines matched per task during the initial parallel scan.</summary>
+    public const int ChunkLines = 16_384;
+
+    // Lines fetched per call to the line provider.
+    private const int BatchLines = 1000;
+
+    // Open-state value for a line that no longer exists after an edit; never
+    // equal to a real state, so convergence is not claimed across it.
+    private const long Vanished = long.MinValue;
+
+    /// <summary>State before <see cref="Line"/>: per rule, the line its open block began on, or -1.</summary>
+    private readonly record struct Checkpoint(long Line, long[] Open);
+
+    /// <summary>Output of one scan: terminated spans per rule, checkpoints and the running state.</summary>
+    private sealed class ScanState
+    {
+        public ScanState(int ruleCount, long[] open)
+        {
+            Open = open;
+            Closed = new List<BlockSpan>[ruleCount];
+            for (int r = 0; r < ruleCount; r++)
+                Closed[r] = [];
+        }
+
+        public long[] Open;
+        public readonly List<BlockSpan>[] Closed;
+        public readonly List<Checkpoint> Checkpoints = [];
+        public long LastCheckpointLine = -CheckpointInterval;
+    }
+
+    private readonly (Regex Begin, Regex End)[] _rules;
+
+    // Terminated spans per rule, ordered by end line (and so by start line).
+    private List<BlockSpan>[] _closed;
+    private List<Checkpoint> _checkpoints = [];
+    private long[] _finalOpen;
+    private long _lineCount;
+    private List<BlockSpan> _spans = [];
+
+    /// <summary>Creates a tracker for <paramref name="rules"/>, with no lines scanned.</summary>
+    /// <param name="rules">
+    /// Begin and end patterns of each rule; a block of rule <c>r</c> is
+    /// reported with <see cref="BlockSpan.Rule"/> <c>r</c>.
+    /// </param>
+    public BlockSpanTracker(IReadOnlyList<(Regex Begin, Regex End)> rules)
+    {
+        ArgumentNullException.ThrowIfNull(rules);
+        _rules = [.. rules];
+        _closed = new ScanState(_rules.Length, []).Closed;
+        _finalOpen = ClosedState();
+    }
+
+    /// <summary>
+    /// All blocks ordered by start line, then rule; blocks still open at the
+    /// end of the document extend to its last line.
+    /// </summary>
+    public IReadOnlyList<BlockSpan> Spans => _spans;
+
+    /// <summary>Number of lines the spans were computed for.</summary>
+    public long LineCount => _lineCount;
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Full scan
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Scans every line, replacing all previous state.
+    /// </summary>
+    /// <param name="getLineRange">Batch line fetcher: (startLine, count) → array of line texts.</param>
+    /// <param name="lineCount">Total number of lines in the document.</param>
+    public void Rebuild(Func<long, int, string[]> getLineRange, long lineCount)
+    {
+        ArgumentNullException.ThrowIfNull(getLineRange);
+
+        _lineCount = Math.Max(0, lineCount);
+        var result = new ScanState(_rules.Length, ClosedState());
+        if (_rules.Length == 0 || _lineCount == 0)
+        {
+            Adopt(result);
+            return;
+        }
+
+        if (_lineCount <= ChunkLines)
+        {
+            ScanSequential(getLineRange, 0, _lineCount, result, null);
+            Adopt(result);
+            return;
+        }
+
+        // Read chunks here, match them in parallel, at most a few in flight.
+        int chunkCount = (int)((_lineCount + ChunkLines - 1) / ChunkLines);
+        var chunks = new Task<ScanState>[chunkCount];
+        int maxInFlight = Math.Max(2, Environment.ProcessorCount);
+        for (int c = 0; c < chunkCount; c++)
+        {
+            if (c >= maxInFlight)
+                chunks[c - maxInFlight].Wait();
+
+            long start = (long)c * ChunkLines;
+            int count = (int)Math.Min(ChunkLines, _lineCount - start);
+            string[] lines = ReadLines(getLineRange, start, count);
+            chunks[c] = Task.Run(() =>
+            {
+                var state = new ScanState(_rules.Length, ClosedState());
+                ScanLines(lines, start, state, null);
+                return state;
+            });
+        }
+        Task.WaitAll(chunks);
+
+        // Fix-up: stitch chunks together, re-scanning where a block was
+        // already open when a chunk started.
+        for (int c = 0; c < chunkCount; c++)
+        {
+            ScanState chunk = chunks[c].Result;
+            long start = (long)c * ChunkLines;
+            long end = Math.Min(start + ChunkLines, _lineCount);
+
+            if (c == 0 || IsClosed(result.Open))
+            {
+                Append(result, chunk, start);
+                continue;
+            }
+
+            long converged = ScanSequential(getLineRange, start, end, result, chunk.Checkpoints);
+            if (converged >= 0)
+                Append(result, chunk, converged);
+        }
+
+        Adopt(result);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Incremental update
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Brings the spans up to date after an edit that replaced some lines.
+    /// </summary>
+    /// <param name="getLineRange">Batch line fetcher over the edited document.</param>
+    /// <param name="lineCount">Line count after the edit.</param>
+    /// <param name="firstChangedLine">First line touched by the edit.</param>
+    /// <param name="lastChangedLine">Last line touched by the edit, after the edit.</param>
+    /// <returns>Whether <see cref="Spans"/> changed.</returns>
+    public bool Update(Func<long, int, string[]> getLineRange, long lineCount,
+        long firstChangedLine, long lastChangedLine)
+    {
+        ArgumentNullException.ThrowIfNull(getLineRange);
+        if (_rules.Length == 0) return false;
+
+        lineCount = Math.Max(0, lineCount);
+        long delta = lineCount - _lineCount;
+        long a = Math.Clamp(firstChangedLine, 0, Math.Max(0, lineCount - 1));
+        long b = Math.Clamp(lastChangedLine, a, Math.Max(0, lineCount - 1));
+        long oldB = b - delta;      // last changed line in old numbering
+
+        if (_checkpoints.Count == 0 || oldB < a - 1)
+        {
+            Rebuild(getLineRange, lineCount);
+            return true;
+        }
+
+        // Resume from the last checkpoint at or before the edit.
+        int cpIndex = FindCheckpoint(a);
+        Checkpoint resume = _checkpoints[cpIndex];
+        long startLine = resume.Line;
+
+        // Checkpoints after the edit, renumbered into the new document.
+        int tailIndex = cpIndex + 1;
+        while (tailIndex < _checkpoints.Count && _checkpoints[tailIndex].Line <= oldB)
+            tailIndex++;
+        var tail = new List<Checkpoint>(_checkpoints.Count - tailIndex);
+        for (int i = tailIndex; i < _checkpoints.Count; i++)
+        {
+            Checkpoint cp = _checkpoints[i];
+            MapState(cp.Open, a, oldB, delta);
+            tail.Add(new Checkpoint(cp.Line + delta, cp.Open));
+        }
+
+        _lineCount = lineCount;
+        var scan = new ScanState(_rules.Length, (long[])resume.Open.Clone());
+        long converged = ScanSequential(getLineRange, startLine, lineCount, scan, tail);
+
+        // Splice: old spans ending before the re-scan, re-scanned spans,
+        // then old spans ending at or after the convergence point.
+        bool changed = false;
+        long oldConverged = converged >= 0 ? converged - delta : long.MaxValue;
+        for (int r = 0; r < _rules.Length; r++)
+        {
+            List<BlockSpan> list = _closed[r];
+            int from = FirstEndingAtOrAfter(list, startLine);
+            int to = converged >= 0 ? FirstEndingAtOrAfter(list, oldConverged) : list.Count;
+
+            List<BlockSpan> fresh = scan.Closed[r];
+            if (!changed && !SameLines(list, from, to, fresh))
+                changed = true;
+            if (delta != 0 && to < list.Count)
+                changed = true;
+
+            var kept = list.GetRange(to, list.Count - to);
+            list.RemoveRange(from, list.Count - from);
+            list.AddRange(fresh);
+            foreach (BlockSpan span in kept)
+            {
+                list.Add(span with
+                {
+                    StartLine = MapLine(span.StartLine, a, oldB, delta),
+                    EndLine = span.EndLine + delta,
+                });
+            }
+        }
+
+        _checkpoints.RemoveRange(cpIndex, _checkpoints.Count - cpIndex);
+        _checkpoints.AddRange(scan.Checkpoints);
+        if (converged >= 0)
+        {
+            int firstKept = 0;
+            while (firstKept < tail.Count && tail[firstKept].Line < converged)
+                firstKept++;
+            _checkpoints.AddRange(tail.Skip(firstKept));
+            MapState(_finalOpen, a, oldB, delta);
+        }
+        else
+        {
+            changed |= !_finalOpen.AsSpan().SequenceEqual(scan.Open);
+            _finalOpen = scan.Open;
+        }
+
+        changed |= delta != 0 && !IsClosed(_finalOpen);
+        if (changed)
+            Materialize();
+        return changed;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Scanning
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Scans <c>[startLine, endLine)</c> through the line provider.  Returns
+    /// the line at which the state matched one of <paramref name="targets"/>
+    /// (the scan stops there), or -1 if it ran to <paramref name="endLine"/>.
+    /// </summary>
+    private long ScanSequential(Func<long, int, string[]> getLineRange, long startLine, long endLine,
+        ScanState state, List<Checkpoint>? targets)
+    {
+        int targetIndex = 0;
+        for (long batchStart = startLine; batchStart < endLine; batchStart += BatchLines)
+        {
+            int count = (int)Math.Min(BatchLines, endLine - batchStart);
+            string[] lines = getLineRange(batchStart, count);
+            long converged = ScanLines(lines, batchStart, state, targets, ref targetIndex);
+            if (converged >= 0) return converged;
+        }
+        return -1;
+    }
+
+    private long ScanLines(string[] lines, long firstLine, ScanState state, List<Checkpoint>? targets)
+    {
+        int targetIndex = 0;
+        return ScanLines(lines, firstLine, state, targets, ref targetIndex);
+    }
+
+    private long ScanLines(string[] lines, long firstLine, ScanState state,
+        List<Checkpoint>? targets, ref int targetIndex)
+    {
+        long[] open = state.Open;
+        for (int i = 0; i < lines.Length; i++)
+        {
+            long line = firstLine + i;
+
+            if (targets is not null)
+            {
+                while (targetIndex < targets.Count && targets[targetIndex].Line < line)
+                    targetIndex++;
+                if (targetIndex < targets.Count && targets[targetIndex].Line == line &&
+                    targets[targetIndex].Open.AsSpan().SequenceEqual(open))
+                    return line;
+            }
+
+            if (line - state.LastCheckpointLine >= CheckpointInterval)
+            {
+                state.Checkpoints.Add(new Checkpoint(line, (long[])open.Clone()));
+                state.LastCheckpointLine = line;
+            }
+
+            string text = lines[i].TrimEnd('\r');
+            for (int r = 0; r < _rules.Length; r++)
+            {
+                try
+                {
+                    if (open[r] < 0)
+                    {
+                        // Not in block — test begin pattern.
+                        if (_rules[r].Begin.IsMatch(text))
+                            open[r] = line;
+                    }
+                    else if (_rules[r].End.IsMatch(text))
+                    {
+                        // In block — end pattern closes it.
+                        state.Closed[r].Add(CreateSpan(r, open[r], line));
+                        open[r] = -1;
+                    }
+                }
+                catch (RegexMatchTimeoutException)
+                {
+                    // Skip slow patterns.
+                }
+            }
+        }
+        return -1;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Internals
+    // ────────────────────────────────────────────────────────────────────
+
+    private static BlockSpan CreateSpan(int rule, long startLine, long endLine) => new(rule, startLine, endLine);
+
+    private long[] ClosedState()
+    {
+        var open = new long[_rules.Length];
+        Array.Fill(open, -1L);
+        return open;
+    }
+
+    private static bool IsClosed(long[] open)
+    {
+        foreach (long start in open)
+        {
+            if (start >= 0) return false;
+        }
+        return true;
+    }
+
+    private static string[] ReadLines(Func<long, int, string[]> getLineRange, long start, int count)
+    {
+        if (count <= BatchLines)
+            return getLineRange(start, count);
+
+        var lines = new string[count];
+        for (int offset = 0; offset < count; offset += BatchLines)
+        {
+            string[] batch = getLineRange(start + offset, Math.Min(BatchLines, count - offset));
+            batch.CopyTo(lines, offset);
+        }
+        return lines;
+    }
+
+    /// <summary>
+    /// Appends the part of a speculatively scanned chunk from
+    /// <paramref name="fromLine"/> on, where its state is known to be right.
+    /// </summary>
+    private static void Append(ScanState target, ScanState chunk, long fromLine)
+    {
+        for (int r = 0; r < target.Closed.Length; r++)
+        {
+            List<BlockSpan> spans = chunk.Closed[r];
+            int from = FirstEndingAtOrAfter(spans, fromLine);
+            target.Closed[r].AddRange(spans.GetRange(from, spans.Count - from));
+        }
+        foreach (Checkpoint cp in chunk.Checkpoints)
+        {
+            if (cp.Line >= fromLine)
+                target.Checkpoints.Add(cp);
+        }
+        target.Open = chunk.Open;
+        target.LastCheckpointLine = chunk.LastCheckpointLine;
+    }
+
+    private void Adopt(ScanState state)
+    {
+        _closed = state.Closed;
+        _checkpoints = state.Checkpoints;
+        _finalOpen = state.Open;
+        if (_checkpoints.Count == 0)
+            _checkpoints.Add(new Checkpoint(0, ClosedState()));
+        Materialize();
+    }
+
+    /// <summary>Rebuilds <see cref="Spans"/> by merging the per-rule lists by start line.</summary>
+    private void Materialize()
+    {
+        int total = 0;
+        foreach (var list in _closed) total += list.Count;
+        var merged = new List<BlockSpan>(total + _rules.Length);
+
+        var next = new int[_rules.Length];
+        while (true)
+        {
+            int best = -1;
+            for (int r = 0; r < _rules.Length; r++)
+            {
+                if (next[r] < _closed[r].Count &&
+                    (best < 0 || _closed[r][next[r]].StartLine < _closed[best][next[best]].StartLine))
+                    best = r;
+            }
+            if (best < 0) break;
+            merged.Add(_closed[best][next[best]++]);
+        }
+
+        // Unterminated blocks extend to end of document.
+        bool appendedOpen = false;
+        for (int r = 0; r < _rules.Length; r++)
+        {
+            if (_finalOpen[r] >= 0)
+            {
+                merged.Add(CreateSpan(r, _finalOpen[r], _lineCount - 1));
+                appendedOpen = true;
+            }
+        }
+        if (appendedOpen)
+            merged.Sort((x, y) => x.StartLine != y.StartLine
+                ? x.StartLine.CompareTo(y.StartLine)
+                : x.Rule.CompareTo(y.Rule));
+
+        _spans = merged;
+    }
+
+    private int FindCheckpoint(long line)
+    {
+        int lo = 0, hi = _checkpoints.Count - 1;
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo + 1) / 2;
+            if (_checkpoints[mid].Line <= line) lo = mid;
+            else hi = mid - 1;
+        }
+        return lo;
+    }
+
+    private static bool SameLines(List<BlockSpan> list, int from, int to, List<BlockSpan> other)
+    {
+        if (to - from != other.Count) return false;
+        for (int i = 0; i < other.Count; i++)
+        {
+            if (list[from + i].StartLine != other[i].StartLine || list[from + i].EndLine != other[i].EndLine)
+                return false;
+        }
+        return true;
+    }
+
+    private static int FirstEndingAtOrAfter(List<BlockSpan> spans, long line)
+    {
+        int lo = 0, hi = spans.Count;
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if (spans[mid].EndLine < line) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    /// <summary>
+    /// Renumbers an old line into the edited document, where old lines
+    /// <c>[a, oldB]</c> were replaced and later lines moved by <paramref name="delta"/>.
+    /// </summary>
+    private static long MapLine(long line, long a, long oldB, long delta)
+    {
+        if (line < a) return line;
+        if (line > oldB) return line + delta;
+        return line <= oldB + delta ? line : Vanished;
+    }
+
+    private static void MapState(long[] open, long a, long oldB, long delta)
+    {
+        for (int r = 0; r < open.Length; r++)
+        {
+            if (open[r] >= 0)
+                open[r] = MapLine(open[r], a, oldB, delta);
+        }
+    }
+}
@@ -19,6 +19,17 @@ public sealed class TokenCache
 
     private readonly List<LineCacheEntry> _entries = new();
     private readonly object _lock = new();
+    private long _generation;
+
+    /// <summary>
+    /// Incremented whenever entries are invalidated, shifted or cleared.
+    /// Work computed against an older generation (e.g. a background
+    /// prefetch) must not be stored.
+    /// </summary>
+    public long Generation
+    {
+        get { lock (_lock) return _generation; }
+    }
 
     /// <summary>
     /// Invalidates cached data for <paramref name="count"/> lines starting at
@@ -29,6 +40,7 @@ public sealed class TokenCache
     {
         lock (_lock)
         {
+            _generation++;
             long end = Math.Min(startLine + count, _entries.Count);
             for (long i = startLine; i < end; i++)
             {
@@ -45,6 +57,7 @@ public sealed class TokenCache
     {
         lock (_lock)
         {
+            _generation++;
             int idx = (int)Math.Min(line, _entries.Count);
             for (long i = 0; i < count; i++)
             {
@@ -61,6 +74,7 @@ public sealed class TokenCache
     {
         lock (_lock)
         {
+            _generation++;
             int idx = (int)line;
             int toRemove = (int)Math.Min(count, _entries.Count - idx);
             if (toRemove > 0)
@@ -102,6 +116,50 @@ public sealed class TokenCache
         }
     }
 
+    /// <summary>
+    /// Returns the first line in <c>[firstLine, endLine)</c> without valid
+    /// cached tokens, or <paramref name="endLine"/> if all are cached.
+    /// </summary>
+    public long FindFirstUncached(long firstLine, long endLine)
+    {
+        lock (_lock)
+        {
+            for (long line = Math.Max(0, firstLine); line < endLine; line++)
+            {
+                if (line >= _entries.Count || !_entries[(int)line].IsValid)
+                    return line;
+            }
+            return endLine;
+        }
+    }
+
+    /// <summary>
+    /// Finds where lexing must start so that <paramref name="line"/> is
+    /// tokenized with the correct inherited state: the line after the
+    /// nearest cached end-state, looking back at most
+    /// <paramref name="maxBacktrack"/> lines.
+    /// </summary>
+    /// <returns>
+    /// The start line and its start state, or <see langword="null"/> when no
+    /// cached state is close enough (and <paramref name="line"/> is not the
+    /// first line of the document).
+    /// </returns>
+    public (long Line, LexerState State)? FindLexStart(long line, int maxBacktrack)
+    {
+        if (line <= 0) return (0, LexerState.Normal);
+
+        lock (_lock)
+        {
+            long stop = Math.Max(0, line - maxBacktrack);
+            for (long prev = line - 1; prev >= stop; prev--)
+            {
+                if (prev < _entries.Count && _entries[(int)prev].IsValid)
+                    return (prev + 1, _entries[(int)prev].EndState);
+            }
+            return stop == 0 ? (0, LexerState.Normal) : null;
+        }
+    }
+
     /// <summary>
     /// Stores the tokenization result for <paramref name="lineIndex"/>.
     /// </summary>
@@ -195,6 +253,7 @@ public sealed class TokenCache
     {
         lock (_lock)
         {
+            _generation++;
             _entries.Clear();
         }
     }
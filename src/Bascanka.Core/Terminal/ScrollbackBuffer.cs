@@ -0,0 +1,129 @@
+namespace Bascanka.Core.Terminal;
+
+/// <summary>
+/// Lines scrolled off the top of a terminal screen, kept in a fixed-size
+/// ring of cells.  Memory use is bounded by the cell budget however much
+/// output passes through: once the ring is full, each new line evicts the
+/// oldest lines it overwrites.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Lines are stored back to back without their trailing blank cells, so
+/// the short lines typical of build output cost only their visible width
+/// and an empty line costs nothing but its row entry.  A line may wrap
+/// around the end of the ring.
+/// </para>
+/// <para>This class is <b>not</b> thread-safe; callers must synchronize
+/// externally if they access it from multiple threads.</para>
+/// </remarks>
+public sealed class ScrollbackBuffer
+{
+    private readonly TerminalCell[] _cells;
+
+    // Row ring: _rowStarts holds each row's position in the cell stream
+    // (total cells appended before it), which maps to _cells modulo its
+    // length.
+    private readonly long[] _rowStarts;
+    private readonly int[] _rowLengths;
+    private int _firstRow;
+    private int _count;
+    private long _written;
+
+    /// <summary>Creates an empty scrollback.</summary>
+    /// <param name="cellBudget">Total cells retained across all lines.</param>
+    /// <param name="maxLines">Most lines retained, however short.</param>
+    public ScrollbackBuffer(int cellBudget, int maxLines)
+    {
+        ArgumentOutOfRangeException.ThrowIfLessThan(cellBudget, 1);
+        ArgumentOutOfRangeException.ThrowIfLessThan(maxLines, 1);
+        _cells = new TerminalCell[cellBudget];
+        _rowStarts = new long[maxLines];
+        _rowLengths = new int[maxLines];
+    }
+
+    /// <summary>Number of lines held.</summary>
+    public int Count => _count;
+
+    /// <summary>Total cells retained across all lines.</summary>
+    public int CellBudget => _cells.Length;
+
+    /// <summary>Most lines retained.</summary>
+    public int MaxLines => _rowStarts.Length;
+
+    /// <summary>
+    /// Appends a line, evicting the oldest lines as needed.  Trailing blank
+    /// cells are not stored; a line longer than the whole budget keeps only
+    /// its first <see cref="CellBudget"/> cells.
+    /// </summary>
+    public void Append(ReadOnlySpan<TerminalCell> line)
+    {
+        TerminalCell blank = TerminalCell.Blank;
+        int length = line.Length;
+        while (length > 0 && line[length - 1] == blank)
+            length--;
+        length = Math.Min(length, _cells.Length);
+
+        if (_count == _rowStarts.Length)
+            DropOldest();
+
+        // Any line that starts before this point would be overwritten.
+        long keepFrom = _written + length - _cells.Length;
+        while (_count > 0 && _rowStarts[_firstRow] < keepFrom)
+            DropOldest();
+
+        int at = (int)(_written % _cells.Length);
+        int head = Math.Min(length, _cells.Length - at);
+        line[..head].CopyTo(_cells.AsSpan(at));
+        line[head..length].CopyTo(_cells);
+
+        int slot = (_firstRow + _count) % _rowStarts.Length;
+        _rowStarts[slot] = _written;
+        _rowLengths[slot] = length;
+        _count++;
+        _written += length;
+    }
+
+    /// <summary>Stored length of a line, excluding trailing blanks.</summary>
+    /// <param name="index">0 for the oldest line.</param>
+    public int GetLineLength(int index)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegative(index);
+        ArgumentOutOfRangeException.ThrowIfGreaterThanOrEqual(index, _count);
+        return _rowLengths[(_firstRow + index) % _rowStarts.Length];
+    }
+
+    /// <summary>
+    /// Copies a line into <paramref name="destination"/>, padding it with
+    /// blank cells or truncating it to fit.
+    /// </summary>
+    /// <param name="index">0 for the oldest line.</param>
+    /// <param name="destination">Receives the line's cells.</param>
+    public void CopyLine(int index, Span<TerminalCell> destination)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegative(index);
+        ArgumentOutOfRangeException.ThrowIfGreaterThanOrEqual(index, _count);
+
+        int slot = (_firstRow + index) % _rowStarts.Length;
+        int length = Math.Min(_rowLengths[slot], destination.Length);
+        int at = (int)(_rowStarts[slot] % _cells.Length);
+        int head = Math.Min(length, _cells.Length - at);
+
+        _cells.AsSpan(at, head).CopyTo(destination);
+        _cells.AsSpan(0, length - head).CopyTo(destination[head..]);
+        destination[length..].Fill(TerminalCell.Blank);
+    }
+
+    /// <summary>Removes every line.</summary>
+    public void Clear()
+    {
+        _firstRow = 0;
+        _count = 0;
+        _written = 0;
+    }
+
+    private void DropOldest()
+    {
+        _firstRow = (_firstRow + 1) % _rowStarts.Length;
+        _count--;
+    }
+}
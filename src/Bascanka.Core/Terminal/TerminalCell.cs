@@ -0,0 +1,64 @@
+using System.Runtime.InteropServices;
+
+namespace Bascanka.Core.Terminal;
+
+/// <summary>
+/// Rendition flags set by SGR escape sequences.
+/// </summary>
+[Flags]
+public enum CellFlags : byte
+{
+    /// <summary>No rendition flags.</summary>
+    None = 0,
+
+    /// <summary>Bold (rendered as the bright variant of the colour).</summary>
+    Bold = 1,
+
+    /// <summary>Underlined.</summary>
+    Underline = 2,
+
+    /// <summary>Foreground and background swapped.</summary>
+    Reverse = 4,
+}
+
+/// <summary>
+/// Colours and rendition of a terminal cell.  Colours are indexes into the
+/// 16-colour palette; 256-colour values are mapped onto it.
+/// </summary>
+/// <param name="Foreground">Foreground palette index (0–15).</param>
+/// <param name="Background">Background palette index (0–15).</param>
+/// <param name="Flags">Bold, underline and reverse flags.</param>
+public readonly record struct CellAttributes(byte Foreground, byte Background, CellFlags Flags = CellFlags.None)
+{
+    /// <summary>Light grey on black with no flags, as after an SGR reset.</summary>
+    public static CellAttributes Default => new(7, 0);
+
+    /// <summary>Whether <see cref="CellFlags.Bold"/> is set.</summary>
+    public bool Bold => (Flags & CellFlags.Bold) != 0;
+
+    /// <summary>Whether <see cref="CellFlags.Underline"/> is set.</summary>
+    public bool Underline => (Flags & CellFlags.Underline) != 0;
+
+    /// <summary>Whether <see cref="CellFlags.Reverse"/> is set.</summary>
+    public bool Reverse => (Flags & CellFlags.Reverse) != 0;
+}
+
+/// <summary>
+/// One character cell of a terminal grid.  Six bytes, so a screen or a
+/// scrollback row is a single compact array rather than parallel character
+/// and attribute arrays.
+/// </summary>
+/// <param name="Char">
+/// The UTF-16 unit shown in the cell, or <see cref="WideContinuation"/> for
+/// the trailing half of a double-width character.
+/// </param>
+/// <param name="Attributes">Colours and rendition.</param>
+[StructLayout(LayoutKind.Sequential, Pack = 2)]
+public readonly record struct TerminalCell(char Char, CellAttributes Attributes)
+{
+    /// <summary>Placed in the cell after a double-width character.</summary>
+    public const char WideContinuation = '\uFFFF';
+
+    /// <summary>A space with default attributes.</summary>
+    public static TerminalCell Blank => new(' ', CellAttributes.Default);
+}
@@ -0,0 +1,539 @@
+namespace Bascanka.Core.Terminal;
+
+/// <summary>
+/// A VT100/ANSI terminal screen: parses the output stream of a console
+/// program and maintains the character grid, cursor, scroll region and
+/// scrollback it describes.  Platform-neutral; a view renders
+/// <see cref="GetRow"/> and <see cref="Scrollback"/>.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Output is mostly printable ASCII, so <see cref="Write"/> finds each run
+/// of characters in <c>' '</c>..<c>'~'</c> with one vectorized scan and
+/// writes it a row segment at a time; only control characters, escape
+/// sequences and non-ASCII text go through the per-character state machine.
+/// CSI parameters are parsed into a fixed array, so no sequence allocates.
+/// </para>
+/// <para>
+/// Lines scrolled off the top of the screen go to a
+/// <see cref="ScrollbackBuffer"/> with a fixed cell budget.
+/// </para>
+/// <para>This class is <b>not</b> thread-safe; callers must synchronize
+/// externally if they access it from multiple threads.</para>
+/// </remarks>
+public sealed class TerminalEmulator
+{
+    /// <summary>Default scrollback cell budget (about 12 MB of cells).</summary>
+    public const int DefaultScrollbackCells = 2 * 1024 * 1024;
+
+    /// <summary>Default maximum number of scrollback lines.</summary>
+    public const int DefaultScrollbackLines = 50_000;
+
+    private const int MaxParams = 32;
+    private const int MaxParamValue = 65535;
+
+    private enum VtState { Normal, Escape, Csi, Osc, OscEsc }
+
+    private TerminalCell[] _cells = [];
+    private int _cols, _rows;
+
+    // Cursor & scroll region
+    private int _cursorRow, _cursorCol;
+    private CellAttributes _currentAttr = CellAttributes.Default;
+    private int _savedCursorRow, _savedCursorCol;
+    private int _scrollTop, _scrollBottom;
+
+    // Parser
+    private VtState _state;
+    private readonly int[] _params = new int[MaxParams];
+    private int _paramCount;
+    private bool _csiPrivate;
+
+    /// <summary>Creates a blank screen.</summary>
+    /// <param name="columns">Screen width in cells.</param>
+    /// <param name="rows">Screen height in cells.</param>
+    /// <param name="scrollbackCells">Cell budget of <see cref="Scrollback"/>.</param>
+    /// <param name="scrollbackLines">Line limit of <see cref="Scrollback"/>.</param>
+    public TerminalEmulator(int columns, int rows,
+        int scrollbackCells = DefaultScrollbackCells, int scrollbackLines = DefaultScrollbackLines)
+    {
+        ArgumentOutOfRangeException.ThrowIfLessThan(columns, 1);
+        ArgumentOutOfRangeException.ThrowIfLessThan(rows, 1);
+
+        _cols = columns;
+        _rows = rows;
+        _scrollBottom = rows - 1;
+        Scrollback = new ScrollbackBuffer(scrollbackCells, scrollbackLines);
+        InitBuffer();
+    }
+
+    /// <summary>Screen width in cells.</summary>
+    public int Columns => _cols;
+
+    /// <summary>Screen height in cells.</summary>
+    public int Rows => _rows;
+
+    /// <summary>Cursor row, 0-based.</summary>
+    public int CursorRow => _cursorRow;
+
+    /// <summary>
+    /// Cursor column, 0-based.  Equals <see cref="Columns"/> after a write
+    /// to the last column, until the next character wraps.
+    /// </summary>
+    public int CursorColumn => _cursorCol;
+
+    /// <summary>Whether the program has the cursor shown (DECTCEM).</summary>
+    public bool CursorVisible { get; private set; } = true;
+
+    /// <summary>Lines scrolled off the top of the screen, oldest first.</summary>
+    public ScrollbackBuffer Scrollback { get; }
+
+    /// <summary>Total characters passed to <see cref="Write"/>.</summary>
+    public long CharactersProcessed { get; private set; }
+
+    /// <summary>The cells of a screen row.</summary>
+    public ReadOnlySpan<TerminalCell> GetRow(int row)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegative(row);
+        ArgumentOutOfRangeException.ThrowIfGreaterThanOrEqual(row, _rows);
+        return _cells.AsSpan(row * _cols, _cols);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Input
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Processes program output.  Escape sequences may be split across
+    /// calls; the parser state carries over.
+    /// </summary>
+    public void Write(ReadOnlySpan<char> text)
+    {
+        CharactersProcessed += text.Length;
+
+        while (!text.IsEmpty)
+        {
+            if (_state == VtState.Normal)
+            {
+                int run = text.IndexOfAnyExceptInRange(' ', '~');
+                if (run < 0) run = text.Length;
+                if (run > 0)
+                {
+                    PutAsciiRun(text[..run]);
+                    text = text[run..];
+                    continue;
+                }
+            }
+
+            char c = text[0];
+            text = text[1..];
+            switch (_state)
+            {
+                case VtState.Normal:  HandleNormal(c); break;
+                case VtState.Escape:  HandleEscape(c); break;
+                case VtState.Csi:     HandleCsi(c);    break;
+                case VtState.Osc:     HandleOsc(c);    break;
+                case VtState.OscEsc:  _state = VtState.Normal; break; // ST
+            }
+        }
+    }
+
+    /// <summary>
+    /// Changes the screen size, keeping the top-left part of the grid.
+    /// The scroll region is reset to the whole screen.
+    /// </summary>
+    public void Resize(int columns, int rows)
+    {
+        ArgumentOutOfRangeException.ThrowIfLessThan(columns, 1);
+        ArgumentOutOfRangeException.ThrowIfLessThan(rows, 1);
+        if (columns == _cols && rows == _rows) return;
+
+        int oldCols = _cols, oldRows = _rows;
+        TerminalCell[] old = _cells;
+        _cols = columns;
+        _rows = rows;
+        InitBuffer();
+
+        int copyRows = Math.Min(oldRows, _rows), copyCols = Math.Min(oldCols, _cols);
+        for (int r = 0; r < copyRows; r++)
+            Array.Copy(old, r * oldCols, _cells, r * _cols, copyCols);
+
+        _cursorRow = Math.Min(_cursorRow, _rows - 1);
+        _cursorCol = Math.Min(_cursorCol, _cols - 1);
+        _scrollTop = 0;
+        _scrollBottom = _rows - 1;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Parser
+    // ────────────────────────────────────────────────────────────────────
+
+    private void HandleNormal(char c)
+    {
+        switch (c)
+        {
+            case '\x1B': _state = VtState.Escape; break;
+            case '\r':   _cursorCol = 0; break;
+            case '\n':   LineFeed(); break;
+            case '\b':   if (_cursorCol > 0) _cursorCol--; break;
+            case '\t':   _cursorCol = Math.Min((_cursorCol / 8 + 1) * 8, _cols - 1); break;
+            case '\x07': break; // BEL
+            default:
+                if (c >= ' ') PutChar(c);
+                break;
+        }
+    }
+
+    private void HandleEscape(char c)
+    {
+        _state = VtState.Normal;
+        switch (c)
+        {
+            case '[':
+                _state = VtState.Csi;
+                _paramCount = 0;
+                _csiPrivate = false;
+                break;
+            case ']': _state = VtState.Osc; break;
+            case '7': _savedCursorRow = _cursorRow; _savedCursorCol = _cursorCol; break;
+            case '8': _cursorRow = _savedCursorRow; _cursorCol = _savedCursorCol; break;
+            case 'M': // Reverse index
+                if (_cursorRow == _scrollTop) ScrollDown();
+                else if (_cursorRow > 0) _cursorRow--;
+                break;
+            case 'D': LineFeed(); break;
+            case 'E': _cursorCol = 0; LineFeed(); break;
+            case 'c': ResetTerminal(); break;
+        }
+    }
+
+    private void HandleCsi(char c)
+    {
+        if (c == '?') { _csiPrivate = true; return; }
+        if (c is >= '0' and <= '9')
+        {
+            if (_paramCount == 0) _params[_paramCount++] = 0;
+            ref int p = ref _params[_paramCount - 1];
+            p = Math.Min(p * 10 + (c - '0'), MaxParamValue);
+            return;
+        }
+        if (c == ';')
+        {
+            if (_paramCount == 0) _params[_paramCount++] = 0;
+            if (_paramCount < MaxParams) _params[_paramCount++] = 0;
+            return;
+        }
+        ExecuteCsi(c, _params.AsSpan(0, _paramCount));
+        _state = VtState.Normal;
+    }
+
+    private void HandleOsc(char c)
+    {
+        if (c == '\x07') _state = VtState.Normal;        // BEL terminates
+        else if (c == '\x1B') _state = VtState.OscEsc;   // ESC \ terminates
+    }
+
+    private void ExecuteCsi(char cmd, ReadOnlySpan<int> p)
+    {
+        int p0 = p.Length > 0 && p[0] > 0 ? p[0] : 1;
+        int p1 = p.Length > 1 && p[1] > 0 ? p[1] : 1;
+
+        if (_csiPrivate)
+        {
+            int v = p.Length > 0 ? p[0] : 0;
+            if (cmd == 'h' && v == 25) CursorVisible = true;
+            if (cmd == 'l' && v == 25) CursorVisible = false;
+            return;
+        }
+
+        switch (cmd)
+        {
+            case 'A': _cursorRow = Math.Max(_scrollTop, _cursorRow - p0); break;
+            case 'B': _cursorRow = Math.Min(_scrollBottom, _cursorRow + p0); break;
+            case 'C': _cursorCol = Math.Min(_cols - 1, _cursorCol + p0); break;
+            case 'D': _cursorCol = Math.Max(0, _cursorCol - p0); break;
+            case 'E': _cursorCol = 0; _cursorRow = Math.Min(_scrollBottom, _cursorRow + p0); break;
+            case 'F': _cursorCol = 0; _cursorRow = Math.Max(_scrollTop, _cursorRow - p0); break;
+            case 'G': _cursorCol = Math.Clamp(p0 - 1, 0, _cols - 1); break;
+            case 'H' or 'f':
+                _cursorRow = Math.Clamp(p0 - 1, 0, _rows - 1);
+                _cursorCol = Math.Clamp(p1 - 1, 0, _cols - 1);
+                break;
+            case 'J': EraseDisplay(p.Length > 0 ? p[0] : 0); break;
+            case 'K': EraseLine(p.Length > 0 ? p[0] : 0); break;
+            case 'L': InsertLines(p0); break;
+            case 'M': DeleteLines(p0); break;
+            case 'P': DeleteChars(p0); break;
+            case '@': InsertChars(p0); break;
+            case 'S': for (int i = 0; i < Math.Min(p0, _rows); i++) ScrollUp(); break;
+            case 'T': for (int i = 0; i < Math.Min(p0, _rows); i++) ScrollDown(); break;
+            case 'd': _cursorRow = Math.Clamp(p0 - 1, 0, _rows - 1); break;
+            case 'm': ExecuteSgr(p); break;
+            case 'r':
+                _scrollTop = Math.Clamp(p0 - 1, 0, _rows - 1);
+                _scrollBottom = Math.Clamp((p.Length > 1 && p[1] > 0 ? p[1] : _rows) - 1, 0, _rows - 1);
+                _cursorRow = _scrollTop; _cursorCol = 0;
+                break;
+            case 's': _savedCursorRow = _cursorRow; _savedCursorCol = _cursorCol; break;
+            case 'u': _cursorRow = _savedCursorRow; _cursorCol = _savedCursorCol; break;
+            case 'X': // Erase characters
+                if (_cursorCol < _cols)
+                {
+                    int n = Math.Min(p0, _cols - _cursorCol);
+                    _cells.AsSpan(_cursorRow * _cols + _cursorCol, n).Fill(new TerminalCell(' ', _currentAttr));
+                }
+                break;
+        }
+    }
+
+    private void ExecuteSgr(ReadOnlySpan<int> p)
+    {
+        if (p.Length == 0) { _currentAttr = CellAttributes.Default; return; }
+
+        byte fg = _currentAttr.Foreground, bg = _currentAttr.Background;
+        CellFlags flags = _currentAttr.Flags;
+
+        for (int i = 0; i < p.Length; i++)
+        {
+            switch (p[i])
+            {
+                case 0:  fg = 7; bg = 0; flags = CellFlags.None; break;
+                case 1:  flags |= CellFlags.Bold; break;
+                case 4:  flags |= CellFlags.Underline; break;
+                case 7:  flags |= CellFlags.Reverse; break;
+                case 22: flags &= ~CellFlags.Bold; break;
+                case 24: flags &= ~CellFlags.Underline; break;
+                case 27: flags &= ~CellFlags.Reverse; break;
+                case >= 30 and <= 37: fg = (byte)(p[i] - 30); break;
+                case 38:
+                    if (i + 2 < p.Length && p[i + 1] == 5) { fg = Map256(p[i + 2]); i += 2; }
+                    else if (i + 4 < p.Length && p[i + 1] == 2) i += 4;
+                    break;
+                case 39: fg = 7; break;
+                case >= 40 and <= 47: bg = (byte)(p[i] - 40); break;
+                case 48:
+                    if (i + 2 < p.Length && p[i + 1] == 5) { bg = Map256(p[i + 2]); i += 2; }
+                    else if (i + 4 < p.Length && p[i + 1] == 2) i += 4;
+                    break;
+                case 49: bg = 0; break;
+                case >= 90 and <= 97:   fg = (byte)(p[i] - 90 + 8); break;
+                case >= 100 and <= 107: bg = (byte)(p[i] - 100 + 8); break;
+            }
+        }
+
+        _currentAttr = new CellAttributes(fg, bg, flags);
+    }
+
+    private static byte Map256(int c)
+    {
+        if (c < 16) return (byte)c;
+        if (c >= 232) { int g = (c - 232) * 10 + 8; return g < 128 ? (byte)0 : (byte)7; }
+        return (byte)(c < 128 ? 0 : 7);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Buffer operations
+    // ────────────────────────────────────────────────────────────────────
+
+    private void InitBuffer()
+    {
+        _cells = new TerminalCell[_rows * _cols];
+        Array.Fill(_cells, TerminalCell.Blank);
+    }
+
+    /// <summary>
+    /// Writes a run of printable ASCII characters, one row segment at a
+    /// time.  Equivalent to <see cref="PutChar"/> for each character: only
+    /// the cells at either end of a segment can split a wide character.
+    /// </summary>
+    private void PutAsciiRun(ReadOnlySpan<char> run)
+    {
+        CellAttributes attr = _currentAttr;
+        while (!run.IsEmpty)
+        {
+            if (_cursorCol >= _cols)
+            {
+                _cursorCol = 0; LineFeed();
+            }
+
+            int n = Math.Min(run.Length, _cols - _cursorCol);
+            int idx = _cursorRow * _cols + _cursorCol;
+
+            if (_cells[idx].Char == TerminalCell.WideContinuation && _cursorCol > 0)
+                _cells[idx - 1] = _cells[idx - 1] with { Char = ' ' };
+            if (_cursorCol + n < _cols && _cells[idx + n].Char == TerminalCell.WideContinuation)
+                _cells[idx + n] = _cells[idx + n] with { Char = ' ' };
+
+            Span<TerminalCell> target = _cells.AsSpan(idx, n);
+            for (int i = 0; i < target.Length; i++)
+                target[i] = new TerminalCell(run[i], attr);
+
+            _cursorCol += n;
+            run = run[n..];
+        }
+    }
+
+    private void PutChar(char c)
+    {
+        bool wide = IsFullWidth(c);
+
+        if (wide && _cursorCol >= _cols - 1)
+        {
+            // Wide char won't fit on the remainder of this line — blank
+            // the last cell (if any) and wrap to the next line.
+            if (_cursorCol < _cols)
+                _cells[_cursorRow * _cols + _cursorCol] = new TerminalCell(' ', _currentAttr);
+            _cursorCol = 0; LineFeed();
+        }
+        else if (_cursorCol >= _cols)
+        {
+            _cursorCol = 0; LineFeed();
+        }
+
+        int idx = _cursorRow * _cols + _cursorCol;
+
+        // If we're overwriting the trailing half of a previous wide char,
+        // blank its leading half so it doesn't render as a partial glyph.
+        if (_cells[idx].Char == TerminalCell.WideContinuation && _cursorCol > 0)
+            _cells[idx - 1] = _cells[idx - 1] with { Char = ' ' };
+
+        // If we're overwriting the leading half of a wide char, blank
+        // its trailing continuation cell.
+        if (_cursorCol + 1 < _cols && _cells[idx + 1].Char == TerminalCell.WideContinuation)
+            _cells[idx + 1] = _cells[idx + 1] with { Char = ' ' };
+
+        _cells[idx] = new TerminalCell(c, _currentAttr);
+        _cursorCol++;
+
+        if (wide && _cursorCol < _cols)
+        {
+            int idx2 = _cursorRow * _cols + _cursorCol;
+            // Same cleanup for the continuation cell.
+            if (_cursorCol + 1 < _cols && _cells[idx2 + 1].Char == TerminalCell.WideContinuation)
+                _cells[idx2 + 1] = _cells[idx2 + 1] with { Char = ' ' };
+            _cells[idx2] = new TerminalCell(TerminalCell.WideContinuation, _currentAttr);
+            _cursorCol++;
+        }
+    }
+
+    /// <summary>
+    /// Returns true for characters that occupy two columns in a terminal
+    /// (CJK ideographs, Hangul syllables, fullwidth forms, etc.).
+    /// Based on Unicode East Asian Width categories W and F.
+    /// </summary>
+    public static bool IsFullWidth(char c)
+    {
+        if (c < 0x1100) return false;
+        return (c <= 0x115F) ||                          // Hangul Jamo
+               (c >= 0x2E80 && c <= 0x303E) ||           // CJK Radicals, Kangxi, Symbols & Punctuation
+               (c >= 0x3041 && c <= 0x33BF) ||           // Hiragana, Katakana, Bopomofo, Hangul Compat Jamo, Kanbun
+               (c >= 0x3400 && c <= 0x4DBF) ||           // CJK Extension A
+               (c >= 0x4E00 && c <= 0xA4CF) ||           // CJK Unified Ideographs, Yi Syllables/Radicals
+               (c >= 0xA960 && c <= 0xA97F) ||           // Hangul Jamo Extended-A
+               (c >= 0xAC00 && c <= 0xD7AF) ||           // Hangul Syllables
+               (c >= 0xF900 && c <= 0xFAFF) ||           // CJK Compatibility Ideographs
+               (c >= 0xFE10 && c <= 0xFE6F) ||           // CJK Compatibility Forms, Small Form Variants
+               (c >= 0xFF01 && c <= 0xFF60) ||           // Fullwidth Forms
+               (c >= 0xFFE0 && c <= 0xFFE6);            // Fullwidth Signs
+    }
+
+    private void LineFeed()
+    {
+        if (_cursorRow == _scrollBottom) ScrollUp();
+        else if (_cursorRow < _rows - 1) _cursorRow++;
+    }
+
+    private void ScrollUp()
+    {
+        if (_scrollTop == 0)
+            Scrollback.Append(_cells.AsSpan(0, _cols));
+
+        int start = _scrollTop * _cols, end = _scrollBottom * _cols;
+        Array.Copy(_cells, start + _cols, _cells, start, end - start);
+        Array.Fill(_cells, TerminalCell.Blank, end, _cols);
+    }
+
+    private void ScrollDown()
+    {
+        int start = _scrollTop * _cols, end = _scrollBottom * _cols;
+        Array.Copy(_cells, start, _cells, start + _cols, end - start);
+        Array.Fill(_cells, TerminalCell.Blank, start, _cols);
+    }
+
+    private void EraseDisplay(int mode)
+    {
+        switch (mode)
+        {
+            case 0:
+                int s0 = _cursorRow * _cols + Math.Min(_cursorCol, _cols);
+                Array.Fill(_cells, TerminalCell.Blank, s0, _cells.Length - s0);
+                break;
+            case 1:
+                int c1 = Math.Min(_cursorRow * _cols + _cursorCol + 1, _cells.Length);
+                Array.Fill(_cells, TerminalCell.Blank, 0, c1);
+                break;
+            case 2 or 3:
+                Array.Fill(_cells, TerminalCell.Blank);
+                if (mode == 3) Scrollback.Clear();
+                break;
+        }
+    }
+
+    private void EraseLine(int mode)
+    {
+        int rs = _cursorRow * _cols;
+        int col = Math.Min(_cursorCol, _cols);
+        switch (mode)
+        {
+            case 0: Array.Fill(_cells, TerminalCell.Blank, rs + col, _cols - col); break;
+            case 1: Array.Fill(_cells, TerminalCell.Blank, rs, Math.Min(col + 1, _cols)); break;
+            case 2: Array.Fill(_cells, TerminalCell.Blank, rs, _cols); break;
+        }
+    }
+
+    private void InsertLines(int n)
+    {
+        if (_cursorRow < _scrollTop || _cursorRow > _scrollBottom) return;
+        n = Math.Min(n, _scrollBottom - _cursorRow + 1);
+        int from = _cursorRow * _cols, to = (_scrollBottom + 1) * _cols;
+        int shift = n * _cols;
+        Array.Copy(_cells, from, _cells, from + shift, to - from - shift);
+        Array.Fill(_cells, TerminalCell.Blank, from, shift);
+    }
+
+    private void DeleteLines(int n)
+    {
+        if (_cursorRow < _scrollTop || _cursorRow > _scrollBottom) return;
+        n = Math.Min(n, _scrollBottom - _cursorRow + 1);
+        int from = _cursorRow * _cols, to = (_scrollBottom + 1) * _cols;
+        int shift = n * _cols;
+        Array.Copy(_cells, from + shift, _cells, from, to - from - shift);
+        Array.Fill(_cells, TerminalCell.Blank, to - shift, shift);
+    }
+
+    private void DeleteChars(int n)
+    {
+        int rs = _cursorRow * _cols, pos = rs + Math.Min(_cursorCol, _cols), end = rs + _cols;
+        int move = end - pos - n;
+        if (move > 0) Array.Copy(_cells, pos + n, _cells, pos, move);
+        int cs = Math.Max(pos, end - n);
+        Array.Fill(_cells, TerminalCell.Blank, cs, end - cs);
+    }
+
+    private void InsertChars(int n)
+    {
+        int rs = _cursorRow * _cols, pos = rs + Math.Min(_cursorCol, _cols), end = rs + _cols;
+        int move = end - pos - n;
+        if (move > 0) Array.Copy(_cells, pos, _cells, pos + n, move);
+        Array.Fill(_cells, TerminalCell.Blank, pos, Math.Min(n, end - pos));
+    }
+
+    private void ResetTerminal()
+    {
+        _currentAttr = CellAttributes.Default;
+        _cursorRow = _cursorCol = 0;
+        _scrollTop = 0; _scrollBottom = _rows - 1;
+        CursorVisible = true;
+        InitBuffer();
+    }
+}
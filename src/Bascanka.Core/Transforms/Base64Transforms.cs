@@ -0,0 +1,101 @@
+using System.Buffers;
+using System.Text;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// Encodes text as Base64 of its UTF-8 bytes, on one line without breaks.
+/// Bytes that do not complete a 3-byte group are carried into the next
+/// chunk, so the output equals encoding the whole range at once.
+/// </summary>
+/// <remarks>This class is <b>not</b> thread-safe; use one instance per run.</remarks>
+public sealed class Base64EncodeTransform : ChunkTransform
+{
+    private readonly Encoder _utf8 = new UTF8Encoding(false).GetEncoder();
+    private readonly byte[] _carry = new byte[2];
+    private int _carried;
+
+    /// <inheritdoc />
+    public override bool IsStateless => false;
+
+    /// <inheritdoc />
+    public override string Transform(string chunk, bool isFinal)
+    {
+        int max = _carried + _utf8.GetByteCount(chunk, flush: isFinal);
+        byte[] bytes = ArrayPool<byte>.Shared.Rent(Math.Max(max, 1));
+        try
+        {
+            _carry.AsSpan(0, _carried).CopyTo(bytes);
+            int count = _carried + _utf8.GetBytes(chunk, bytes.AsSpan(_carried), flush: isFinal);
+
+            int whole = isFinal ? count : count - count % 3;
+            _carried = count - whole;
+            bytes.AsSpan(whole, _carried).CopyTo(_carry);
+            return Convert.ToBase64String(bytes, 0, whole);
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(bytes);
+        }
+    }
+}
+
+/// <summary>
+/// Decodes Base64 to the UTF-8 text it holds.  Whitespace between
+/// characters is ignored, as by <see cref="Convert.FromBase64String"/>.
+/// Characters that do not complete a 4-character group, and bytes that do
+/// not complete a UTF-8 sequence, are carried into the next chunk.
+/// </summary>
+/// <remarks>This class is <b>not</b> thread-safe; use one instance per run.</remarks>
+public sealed class Base64DecodeTransform : ChunkTransform
+{
+    private readonly Decoder _utf8 = new UTF8Encoding(false).GetDecoder();
+    private readonly char[] _carry = new char[3];
+    private int _carried;
+    private bool _padded;
+
+    /// <inheritdoc />
+    public override bool IsStateless => false;
+
+    /// <inheritdoc />
+    /// <exception cref="FormatException">The text is not valid Base64.</exception>
+    public override string Transform(string chunk, bool isFinal)
+    {
+        char[] chars = ArrayPool<char>.Shared.Rent(_carried + chunk.Length + 1);
+        byte[]? bytes = null;
+        try
+        {
+            _carry.AsSpan(0, _carried).CopyTo(chars);
+            int count = _carried;
+            foreach (char c in chunk)
+            {
+                if (c is not (' ' or '\t' or '\r' or '\n'))
+                    chars[count++] = c;
+            }
+
+            int whole = count - count % 4;
+            if (isFinal && whole != count)
+                throw new FormatException("The Base64 text ends with an incomplete group.");
+            if (_padded && count > 0)
+                throw new FormatException("The Base64 text continues after its padding.");
+            if (whole > 0)
+                _padded = chars[whole - 1] == '=';
+            _carried = count - whole;
+            chars.AsSpan(whole, _carried).CopyTo(_carry);
+
+            bytes = ArrayPool<byte>.Shared.Rent(Math.Max(whole / 4 * 3, 1));
+            if (!Convert.TryFromBase64Chars(chars.AsSpan(0, whole), bytes, out int written))
+                throw new FormatException("The text is not valid Base64.");
+
+            int charCount = _utf8.GetCharCount(bytes.AsSpan(0, written), flush: isFinal);
+            return string.Create(charCount, (Decoder: _utf8, Bytes: bytes, Written: written, Flush: isFinal),
+                static (span, s) => s.Decoder.GetChars(s.Bytes.AsSpan(0, s.Written), span, s.Flush));
+        }
+        finally
+        {
+            ArrayPool<char>.Shared.Return(chars);
+            if (bytes is not null)
+                ArrayPool<byte>.Shared.Return(bytes);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// A text transform that <see cref="ChunkedTransformer"/> applies to a
+/// document range one chunk at a time, so that the range never has to be
+/// held as a single string.
+/// </summary>
+/// <remarks>
+/// <para>
+/// A <em>stateless</em> transform maps each chunk on its own.  Its chunks
+/// end at line breaks, so a transform that works within lines (case
+/// changes, trimming, escaping) gives the same result as on the whole
+/// range, and chunks are transformed in parallel.
+/// </para>
+/// <para>
+/// A <em>stateful</em> transform sees the chunks in order and carries what
+/// it cannot finish yet (such as the bytes of an incomplete Base64 group)
+/// into the next call.  Create a new instance for every run.
+/// </para>
+/// </remarks>
+public abstract class ChunkTransform
+{
+    /// <summary>
+    /// Whether chunks are independent: line-aligned and transformed in
+    /// parallel, in any order.
+    /// </summary>
+    public abstract bool IsStateless { get; }
+
+    /// <summary>Transforms the next chunk.</summary>
+    /// <param name="chunk">The chunk's text.</param>
+    /// <param name="isFinal">
+    /// Whether this is the last chunk of the range; stateful transforms
+    /// must then flush what they carry.
+    /// </param>
+    public abstract string Transform(string chunk, bool isFinal);
+
+    /// <summary>
+    /// Wraps a function that works within lines as a stateless transform.
+    /// The function must be thread-safe.
+    /// </summary>
+    public static ChunkTransform PerLine(Func<string, string> transform)
+    {
+        ArgumentNullException.ThrowIfNull(transform);
+        return new LineTransform(transform);
+    }
+
+    private sealed class LineTransform(Func<string, string> transform) : ChunkTransform
+    {
+        public override bool IsStateless => true;
+
+        public override string Transform(string chunk, bool isFinal) => transform(chunk);
+    }
+}
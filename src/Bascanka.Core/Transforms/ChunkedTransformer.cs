@@ -0,0 +1,138 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// Applies a <see cref="ChunkTransform"/> to a document range one chunk at
+/// a time: stateless transforms over line-aligned windows in parallel,
+/// stateful ones over fixed-size windows in order.  Results are always
+/// delivered in document order.
+/// </summary>
+public static class ChunkedTransformer
+{
+    /// <summary>Characters per chunk for stateful transforms.</summary>
+    private const int StatefulChunkSize = LineWindows.WindowSize;
+
+    /// <summary>
+    /// Transforms <c>source[start, start + length)</c> and returns one edit
+    /// per chunk that changed, sorted by offset, ready for a single
+    /// <see cref="Commands.BulkEditCommand"/>.  Unchanged chunks produce no
+    /// edit and keep their pieces.
+    /// </summary>
+    /// <param name="source">The document to read; it is not modified.</param>
+    /// <param name="start">Offset of the first character of the range.</param>
+    /// <param name="length">Number of characters in the range.</param>
+    /// <param name="transform">The transform to apply.</param>
+    /// <param name="progress">Receives the percentage done after each chunk.</param>
+    /// <param name="cancellationToken">Cancels the operation between chunks.</param>
+    /// <exception cref="OperationCanceledException">The operation was cancelled.</exception>
+    public static List<TextEdit> CreateEdits(PieceTable source, long start, long length, ChunkTransform transform,
+        IProgress<int>? progress = null, CancellationToken cancellationToken = default)
+    {
+        var edits = new List<TextEdit>();
+        Run(source, start, length, transform, (offset, chunk, result) =>
+        {
+            if (!string.Equals(chunk, result, StringComparison.Ordinal))
+                edits.Add(new TextEdit(offset, chunk.Length, result));
+        }, progress, cancellationToken);
+        return edits;
+    }
+
+    /// <summary>
+    /// Transforms <c>source[start, start + length)</c> and writes the result
+    /// to <paramref name="output"/>.
+    /// </summary>
+    /// <exception cref="OperationCanceledException">The operation was cancelled.</exception>
+    public static void WriteTo(PieceTable source, long start, long length, ChunkTransform transform,
+        TextWriter output, IProgress<int>? progress = null, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(output);
+        Run(source, start, length, transform, (_, _, result) => output.Write(result), progress, cancellationToken);
+    }
+
+    /// <summary>Returns <paramref name="transform"/> as a <see cref="StreamingTransform"/>.</summary>
+    public static StreamingTransform ToStreaming(ChunkTransform transform)
+    {
+        ArgumentNullException.ThrowIfNull(transform);
+        return (source, start, length, output, progress, cancellationToken) =>
+            WriteTo(source, start, length, transform, output, progress, cancellationToken);
+    }
+
+    private static void Run(PieceTable source, long start, long length, ChunkTransform transform,
+        Action<long, string, string> sink, IProgress<int>? progress, CancellationToken cancellationToken)
+    {
+        ArgumentNullException.ThrowIfNull(source);
+        ArgumentNullException.ThrowIfNull(transform);
+        ArgumentOutOfRangeException.ThrowIfNegative(start);
+        ArgumentOutOfRangeException.ThrowIfNegative(length);
+
+        if (transform.IsStateless)
+            RunParallel(source, start, length, transform, sink, progress, cancellationToken);
+        else
+            RunInOrder(source, start, length, transform, sink, progress, cancellationToken);
+    }
+
+    /// <summary>
+    /// Reads line-aligned windows in batches of one per core, transforms a
+    /// batch in parallel and hands its results to the sink in order.
+    /// </summary>
+    private static void RunParallel(PieceTable source, long start, long length, ChunkTransform transform,
+        Action<long, string, string> sink, IProgress<int>? progress, CancellationToken cancellationToken)
+    {
+        long end = start + length;
+        int batchSize = Environment.ProcessorCount;
+        var batch = new List<(long Offset, string Text)>(batchSize);
+        var results = new string[batchSize];
+        var options = new ParallelOptions { CancellationToken = cancellationToken };
+        int lastPercent = -1;
+
+        void flush()
+        {
+            Parallel.For(0, batch.Count, options, i =>
+            {
+                var (offset, text) = batch[i];
+                results[i] = transform.Transform(text, offset + text.Length >= end);
+            });
+
+            for (int i = 0; i < batch.Count; i++)
+                sink(batch[i].Offset, batch[i].Text, results[i]);
+
+            var (lastOffset, lastText) = batch[^1];
+            LineWindows.Report(progress, (int)((lastOffset + lastText.Length - start) * 100 / Math.Max(length, 1)), ref lastPercent);
+            batch.Clear();
+        }
+
+        foreach (var (offset, text) in LineWindows.Enumerate(source, start, length, cancellationToken))
+        {
+            batch.Add((offset, text.ToString()));
+            if (batch.Count == batchSize)
+                flush();
+        }
+        if (batch.Count > 0)
+            flush();
+    }
+
+    /// <summary>Transforms fixed-size windows one after another.</summary>
+    private static void RunInOrder(PieceTable source, long start, long length, ChunkTransform transform,
+        Action<long, string, string> sink, IProgress<int>? progress, CancellationToken cancellationToken)
+    {
+        long end = start + length;
+        long offset = start;
+        int lastPercent = -1;
+
+        // An empty range still gets one final call, so that the transform
+        // can write whatever an empty input produces.
+        do
+        {
+            cancellationToken.ThrowIfCancellationRequested();
+
+            int take = (int)Math.Min(StatefulChunkSize, end - offset);
+            string chunk = take > 0 ? source.GetText(offset, take) : string.Empty;
+            sink(offset, chunk, transform.Transform(chunk, offset + take >= end));
+            offset += take;
+
+            LineWindows.Report(progress, (int)((offset - start) * 100 / Math.Max(length, 1)), ref lastPercent);
+        }
+        while (offset < end);
+    }
+}
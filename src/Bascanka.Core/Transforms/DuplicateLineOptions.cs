@@ -0,0 +1,42 @@
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// What <see cref="LineDeduplicator"/> writes for each distinct line.
+/// Lines are always written once, at their first occurrence.
+/// </summary>
+public enum DuplicateLineMode
+{
+    /// <summary>Every distinct line; later copies are dropped.</summary>
+    RemoveDuplicates,
+
+    /// <summary>Only lines that occur more than once.</summary>
+    KeepOnlyDuplicates,
+
+    /// <summary>
+    /// Every distinct line, prefixed with the number of times it occurs
+    /// and a tab.
+    /// </summary>
+    CountDuplicates,
+}
+
+/// <summary>
+/// Options for <see cref="LineDeduplicator"/>.
+/// </summary>
+public sealed class DuplicateLineOptions
+{
+    /// <summary>What to write for each distinct line.</summary>
+    public DuplicateLineMode Mode { get; init; } = DuplicateLineMode.RemoveDuplicates;
+
+    /// <summary>
+    /// Approximate memory, in bytes, for the table of distinct lines.  When
+    /// the table outgrows it, line hashes are partitioned to temporary
+    /// files and counted one partition at a time.
+    /// </summary>
+    public long MemoryBudget { get; init; } = 256L * 1024 * 1024;
+
+    /// <summary>
+    /// Directory for partition files, or <see langword="null"/> for the
+    /// system temporary directory.
+    /// </summary>
+    public string? TempDirectory { get; init; }
+}
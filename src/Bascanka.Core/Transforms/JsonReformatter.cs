@@ -0,0 +1,223 @@
+using System.Buffers;
+using System.Text;
+using System.Text.Encodings.Web;
+using System.Text.Json;
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// Pretty-prints or minifies JSON of any size.  The range is encoded to
+/// UTF-8 a window at a time and read with a resumable
+/// <see cref="Utf8JsonReader"/>; every token is copied to a
+/// <see cref="Utf8JsonWriter"/> whose output is drained to the destination
+/// as it grows.  Memory use depends on the longest single token, not on
+/// the size of the document.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Numbers are copied exactly as written.  Strings and property names are
+/// unescaped and re-escaped with relaxed escaping, so that non-ASCII text
+/// stays readable.  Comments are dropped and trailing commas are accepted.
+/// </para>
+/// <para>
+/// Invalid JSON throws a <see cref="JsonException"/> when it is reached, so
+/// the destination may already hold part of the output and should be
+/// discarded.
+/// </para>
+/// <para>Instances are immutable and may process several ranges at once.</para>
+/// </remarks>
+public sealed class JsonReformatter
+{
+    /// <summary>Characters read from the document per window.</summary>
+    private const int WindowChars = 1024 * 1024;
+
+    /// <summary>Pending output is drained once it reaches this many bytes.</summary>
+    private const int DrainBytes = 1024 * 1024;
+
+    private static readonly JsonReaderOptions ReaderOptions = new()
+    {
+        AllowTrailingCommas = true,
+        CommentHandling = JsonCommentHandling.Skip,
+        MaxDepth = 1000,
+    };
+
+    private readonly JsonWriterOptions _writerOptions;
+
+    /// <summary>Creates a reformatter.</summary>
+    /// <param name="indented">
+    /// <see langword="true"/> to indent with one tab per level and one
+    /// value per line; <see langword="false"/> to remove all whitespace.
+    /// </param>
+    public JsonReformatter(bool indented)
+    {
+        _writerOptions = new JsonWriterOptions
+        {
+            Indented = indented,
+            IndentCharacter = '\t',
+            IndentSize = 1,
+            NewLine = "\n",
+            MaxDepth = ReaderOptions.MaxDepth,
+            Encoder = JavaScriptEncoder.UnsafeRelaxedJsonEscaping,
+        };
+    }
+
+    /// <summary>Returns a transform that pretty-prints or minifies JSON.</summary>
+    public static StreamingTransform Create(bool indented) => new JsonReformatter(indented).Reformat;
+
+    /// <summary>
+    /// Writes the JSON value in <c>source[start, start + length)</c> to
+    /// <paramref name="output"/>, reformatted.
+    /// </summary>
+    /// <param name="source">The document to read; it is not modified.</param>
+    /// <param name="start">Offset of the first character of the range.</param>
+    /// <param name="length">Number of characters in the range.</param>
+    /// <param name="output">Receives the reformatted JSON.</param>
+    /// <param name="progress">Receives the percentage done when it changes.</param>
+    /// <param name="cancellationToken">Cancels the operation.</param>
+    /// <exception cref="JsonException">The range is not a single valid JSON value.</exception>
+    /// <exception cref="OperationCanceledException">The operation was cancelled.</exception>
+    public void Reformat(PieceTable source, long start, long length, TextWriter output,
+        IProgress<int>? progress = null, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(source);
+        ArgumentNullException.ThrowIfNull(output);
+        ArgumentOutOfRangeException.ThrowIfNegative(start);
+        ArgumentOutOfRangeException.ThrowIfNegative(length);
+
+        var utf8 = new UTF8Encoding(false, throwOnInvalidBytes: false);
+        var encoder = utf8.GetEncoder();
+        var sink = new OutputSink(output, utf8.GetDecoder());
+        using var writer = new Utf8JsonWriter(sink.Buffer, _writerOptions);
+
+        var state = new JsonReaderState(ReaderOptions);
+        byte[] input = ArrayPool<byte>.Shared.Rent(WindowChars * 3);
+        byte[] scratch = ArrayPool<byte>.Shared.Rent(256);
+        int buffered = 0;
+        long offset = start;
+        long end = start + length;
+        int lastPercent = -1;
+
+        try
+        {
+            while (true)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+
+                int take = (int)Math.Min(WindowChars, end - offset);
+                string text = take > 0 ? source.GetText(offset, take) : string.Empty;
+                offset += take;
+                bool isFinal = offset >= end;
+
+                int needed = buffered + utf8.GetMaxByteCount(text.Length);
+                if (needed > input.Length)
+                    Grow(ref input, buffered, needed);
+                buffered += encoder.GetBytes(text, input.AsSpan(buffered), flush: isFinal);
+
+                var reader = new Utf8JsonReader(input.AsSpan(0, buffered), isFinal, state);
+                CopyTokens(ref reader, writer, ref scratch);
+                state = reader.CurrentState;
+
+                // Keep the incomplete token at the end for the next window.
+                int consumed = (int)reader.BytesConsumed;
+                input.AsSpan(consumed, buffered - consumed).CopyTo(input);
+                buffered -= consumed;
+
+                if (writer.BytesPending + sink.Buffer.WrittenCount >= DrainBytes)
+                {
+                    writer.Flush();
+                    sink.Drain(flush: false);
+                }
+
+                LineWindows.Report(progress, (int)((offset - start) * 100 / Math.Max(length, 1)), ref lastPercent);
+                if (isFinal) break;
+            }
+
+            writer.Flush();
+            sink.Drain(flush: true);
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(input);
+            ArrayPool<byte>.Shared.Return(scratch);
+        }
+    }
+
+    /// <summary>Copies every complete token the reader holds to the writer.</summary>
+    private static void CopyTokens(ref Utf8JsonReader reader, Utf8JsonWriter writer, ref byte[] scratch)
+    {
+        while (reader.Read())
+        {
+            switch (reader.TokenType)
+            {
+                case JsonTokenType.StartObject:
+                    writer.WriteStartObject();
+                    break;
+                case JsonTokenType.EndObject:
+                    writer.WriteEndObject();
+                    break;
+                case JsonTokenType.StartArray:
+                    writer.WriteStartArray();
+                    break;
+                case JsonTokenType.EndArray:
+                    writer.WriteEndArray();
+                    break;
+                case JsonTokenType.PropertyName:
+                    writer.WritePropertyName(Unescape(ref reader, ref scratch));
+                    break;
+                case JsonTokenType.String:
+                    writer.WriteStringValue(Unescape(ref reader, ref scratch));
+                    break;
+                case JsonTokenType.Number:
+                    writer.WriteRawValue(reader.ValueSpan, skipInputValidation: true);
+                    break;
+                case JsonTokenType.True:
+                case JsonTokenType.False:
+                    writer.WriteBooleanValue(reader.TokenType == JsonTokenType.True);
+                    break;
+                case JsonTokenType.Null:
+                    writer.WriteNullValue();
+                    break;
+            }
+        }
+    }
+
+    /// <summary>The unescaped UTF-8 text of the current string or property name.</summary>
+    private static ReadOnlySpan<byte> Unescape(ref Utf8JsonReader reader, ref byte[] scratch)
+    {
+        if (!reader.ValueIsEscaped)
+            return reader.ValueSpan;
+
+        if (scratch.Length < reader.ValueSpan.Length)
+            Grow(ref scratch, 0, reader.ValueSpan.Length);
+        int written = reader.CopyString(scratch);
+        return scratch.AsSpan(0, written);
+    }
+
+    private static void Grow(ref byte[] buffer, int keep, int size)
+    {
+        byte[] larger = ArrayPool<byte>.Shared.Rent(size);
+        buffer.AsSpan(0, keep).CopyTo(larger);
+        ArrayPool<byte>.Shared.Return(buffer);
+        buffer = larger;
+    }
+
+    /// <summary>Collects the writer's UTF-8 output and decodes it to the destination.</summary>
+    private sealed class OutputSink(TextWriter output, Decoder decoder)
+    {
+        private char[] _chars = [];
+
+        public ArrayBufferWriter<byte> Buffer { get; } = new(DrainBytes * 2);
+
+        public void Drain(bool flush)
+        {
+            ReadOnlySpan<byte> bytes = Buffer.WrittenSpan;
+            int count = decoder.GetCharCount(bytes, flush);
+            if (_chars.Length < count)
+                _chars = new char[Math.Max(count, DrainBytes)];
+            int written = decoder.GetChars(bytes, _chars, flush);
+            output.Write(_chars, 0, written);
+            Buffer.ResetWrittenCount();
+        }
+    }
+}
@@ -0,0 +1,364 @@
+using System.Buffers.Binary;
+using System.Runtime.InteropServices;
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// Removes, keeps or counts duplicate lines in a document range of any
+/// size.  Lines are identified by a 128-bit hash rather than by their text,
+/// so memory use depends on the number of distinct lines, not their length,
+/// and a table that outgrows its budget is partitioned to temporary files.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The range is read twice.  The first pass hashes each window's lines in
+/// parallel and counts every hash, remembering where it first occurred.
+/// While the table fits in the memory budget it stays in memory; after
+/// that, hashes go to partition files by their top bits and each partition
+/// is counted on its own.  The second pass writes each kept line at its
+/// first occurrence, so output order is input order.
+/// </para>
+/// <para>
+/// Lines are joined with the first line break of the range, and a line
+/// break at the end of the range stays at the end of the output.
+/// </para>
+/// <para>Instances are immutable and may process several ranges at once.</para>
+/// </remarks>
+public sealed class LineDeduplicator
+{
+    // Estimated bytes per distinct line in the in-memory table: the key,
+    // the group, the cached hash code, the chain link and the bucket.
+    private const int GroupBytes = 48;
+
+    // Partitions are chosen by the top byte of the hash.
+    private const int PartitionBits = 8;
+
+    // Windows with fewer lines are hashed on the calling thread.
+    private const int ParallelHashLines = 4096;
+
+    private readonly DuplicateLineOptions _options;
+
+    /// <summary>Creates a deduplicator with the given options.</summary>
+    public LineDeduplicator(DuplicateLineOptions options)
+    {
+        ArgumentNullException.ThrowIfNull(options);
+        if (options.MemoryBudget <= 0)
+            throw new ArgumentOutOfRangeException(nameof(options), options.MemoryBudget, "The memory budget must be positive.");
+
+        _options = options;
+    }
+
+    /// <summary>Returns a transform that processes duplicate lines with the given options.</summary>
+    public static StreamingTransform Create(DuplicateLineOptions options) => new LineDeduplicator(options).Deduplicate;
+
+    /// <summary>
+    /// Writes the distinct lines of <c>source[start, start + length)</c> to
+    /// <paramref name="output"/> as selected by <see cref="DuplicateLineOptions.Mode"/>.
+    /// </summary>
+    /// <param name="source">The document to read; it is not modified.</param>
+    /// <param name="start">Offset of the first character of the range.</param>
+    /// <param name="length">Number of characters in the range.</param>
+    /// <param name="output">Receives the kept lines.</param>
+    /// <param name="progress">Receives the percentage done when it changes.</param>
+    /// <param name="cancellationToken">Cancels the operation.</param>
+    /// <exception cref="OperationCanceledException">The operation was cancelled.</exception>
+    public void Deduplicate(PieceTable source, long start, long length, TextWriter output,
+        IProgress<int>? progress = null, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(source);
+        ArgumentNullException.ThrowIfNull(output);
+        ArgumentOutOfRangeException.ThrowIfNegative(start);
+        ArgumentOutOfRangeException.ThrowIfNegative(length);
+
+        HashPartitions? partitions = null;
+        var runs = new List<RecordFile>();
+        try
+        {
+            var groups = new Dictionary<UInt128, Group>();
+            long maxGroups = Math.Max(1, _options.MemoryBudget / GroupBytes);
+            long sequence = 0;
+            UInt128[] hashes = [];
+
+            LineWindows.ForEachLineBatch(source, start, length, lines =>
+            {
+                if (hashes.Length < lines.Count)
+                    hashes = new UInt128[lines.Count];
+                HashLines(lines, hashes, cancellationToken);
+
+                for (int i = 0; i < lines.Count; i++)
+                {
+                    long seq = sequence++;
+                    if (partitions is not null)
+                    {
+                        partitions.Write(hashes[i], seq, 1);
+                        continue;
+                    }
+
+                    ref Group group = ref CollectionsMarshal.GetValueRefOrAddDefault(groups, hashes[i], out bool exists);
+                    if (!exists)
+                        group.FirstSequence = seq;
+                    group.Count++;
+
+                    if (!exists && groups.Count > maxGroups)
+                    {
+                        partitions = new HashPartitions(_options.TempDirectory);
+                        foreach (var (hash, g) in groups)
+                            partitions.Write(hash, g.FirstSequence, g.Count);
+                        groups = new Dictionary<UInt128, Group>();
+                    }
+                }
+            }, progress, 0, 50, out string lineBreak, cancellationToken);
+
+            IEnumerator<(long Sequence, long Count)> kept;
+            if (partitions is null)
+            {
+                kept = SortKept(groups).GetEnumerator();
+            }
+            else
+            {
+                groups.Clear();
+                runs = CountPartitions(partitions, cancellationToken);
+                partitions.Dispose();
+                partitions = null;
+                kept = MergeRuns(runs).GetEnumerator();
+            }
+
+            WriteKeptLines(source, start, length, output, kept, lineBreak, progress, cancellationToken);
+        }
+        finally
+        {
+            partitions?.Dispose();
+            foreach (RecordFile run in runs)
+                run.Dispose();
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Counting
+    // ────────────────────────────────────────────────────────────────────
+
+    private static void HashLines(List<ReadOnlyMemory<char>> lines, UInt128[] hashes, CancellationToken cancellationToken)
+    {
+        if (lines.Count < ParallelHashLines)
+        {
+            for (int i = 0; i < lines.Count; i++)
+                hashes[i] = LineHash.Compute(lines[i].Span);
+            return;
+        }
+
+        var options = new ParallelOptions { CancellationToken = cancellationToken };
+        Parallel.ForEach(System.Collections.Concurrent.Partitioner.Create(0, lines.Count, ParallelHashLines), options, range =>
+        {
+            for (int i = range.Item1; i < range.Item2; i++)
+                hashes[i] = LineHash.Compute(lines[i].Span);
+        });
+    }
+
+    private bool Keeps(long count) => _options.Mode != DuplicateLineMode.KeepOnlyDuplicates || count > 1;
+
+    /// <summary>The kept groups of an in-memory table, in input order.</summary>
+    private List<(long Sequence, long Count)> SortKept(Dictionary<UInt128, Group> groups)
+    {
+        var kept = new List<(long Sequence, long Count)>(groups.Count);
+        foreach (Group g in groups.Values)
+        {
+            if (Keeps(g.Count))
+                kept.Add((g.FirstSequence, g.Count));
+        }
+        groups.Clear();
+        kept.Sort((a, b) => a.Sequence.CompareTo(b.Sequence));
+        return kept;
+    }
+
+    /// <summary>
+    /// Counts each partition in memory and writes its kept groups, in input
+    /// order, to a run file.  A hash lives in exactly one partition, so the
+    /// partitions' counts are final.
+    /// </summary>
+    private List<RecordFile> CountPartitions(HashPartitions partitions, CancellationToken cancellationToken)
+    {
+        var runs = new List<RecordFile>();
+        try
+        {
+            var groups = new Dictionary<UInt128, Group>();
+            foreach (RecordFile partition in partitions.Files)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+
+                partition.Rewind();
+                while (partition.TryRead(out UInt128 hash, out long seq, out long count))
+                {
+                    ref Group group = ref CollectionsMarshal.GetValueRefOrAddDefault(groups, hash, out bool exists);
+                    group.FirstSequence = exists ? Math.Min(group.FirstSequence, seq) : seq;
+                    group.Count += count;
+                }
+
+                var run = new RecordFile(_options.TempDirectory);
+                runs.Add(run);
+                foreach (var (seq, count) in SortKept(groups))
+                    run.Write(default, seq, count);
+                run.Rewind();
+            }
+            return runs;
+        }
+        catch
+        {
+            foreach (RecordFile run in runs)
+                run.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>Merges the runs into one sequence in input order.</summary>
+    private static IEnumerable<(long Sequence, long Count)> MergeRuns(List<RecordFile> runs)
+    {
+        var queue = new PriorityQueue<int, long>(runs.Count);
+        var counts = new long[runs.Count];
+        for (int i = 0; i < runs.Count; i++)
+        {
+            if (runs[i].TryRead(out _, out long seq, out counts[i]))
+                queue.Enqueue(i, seq);
+        }
+
+        while (queue.TryDequeue(out int index, out long seq))
+        {
+            yield return (seq, counts[index]);
+            if (runs[index].TryRead(out _, out long next, out counts[index]))
+                queue.Enqueue(index, next);
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Output
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Reads the range again and writes the lines whose sequence numbers
+    /// <paramref name="kept"/> lists.
+    /// </summary>
+    private void WriteKeptLines(PieceTable source, long start, long length, TextWriter output,
+        IEnumerator<(long Sequence, long Count)> kept, string lineBreak, IProgress<int>? progress,
+        CancellationToken cancellationToken)
+    {
+        bool hasNext = kept.MoveNext();
+        long sequence = 0;
+        bool any = false;
+
+        bool endsWithLineBreak = LineWindows.ForEachLine(source, start, length, line =>
+        {
+            long seq = sequence++;
+            if (!hasNext || seq != kept.Current.Sequence) return;
+
+            if (any)
+                output.Write(lineBreak);
+            if (_options.Mode == DuplicateLineMode.CountDuplicates)
+            {
+                output.Write(kept.Current.Count);
+                output.Write('\t');
+            }
+            output.Write(line.Span);
+            any = true;
+            hasNext = kept.MoveNext();
+        }, progress, 50, 100, out _, cancellationToken);
+
+        if (endsWithLineBreak && any)
+            output.Write(lineBreak);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Temporary files
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>Where a hash first occurred and how often.</summary>
+    private struct Group
+    {
+        public long FirstSequence;
+        public long Count;
+    }
+
+    /// <summary>Hash records split across files by the top bits of the hash.</summary>
+    private sealed class HashPartitions(string? directory) : IDisposable
+    {
+        public RecordFile[] Files { get; } = CreateFiles(directory);
+
+        public void Write(UInt128 hash, long sequence, long count) =>
+            Files[(int)(hash >> (128 - PartitionBits))].Write(hash, sequence, count);
+
+        private static RecordFile[] CreateFiles(string? directory)
+        {
+            var files = new RecordFile[1 << PartitionBits];
+            try
+            {
+                for (int i = 0; i < files.Length; i++)
+                    files[i] = new RecordFile(directory);
+                return files;
+            }
+            catch
+            {
+                foreach (RecordFile? file in files)
+                    file?.Dispose();
+                throw;
+            }
+        }
+
+        public void Dispose()
+        {
+            foreach (RecordFile file in Files)
+                file.Dispose();
+        }
+    }
+
+    /// <summary>
+    /// A temporary file of fixed-size (hash, sequence, count) records,
+    /// written once and then read back in order.
+    /// </summary>
+    private sealed class RecordFile : IDisposable
+    {
+        private const int RecordSize = 32;
+        private const int BufferSize = 64 * 1024;
+
+        private readonly FileStream _stream;
+        private readonly byte[] _record = new byte[RecordSize];
+
+        public RecordFile(string? directory)
+        {
+            string path = Path.Combine(directory ?? Path.GetTempPath(), $"bascanka-{Guid.NewGuid():N}.spill");
+            _stream = new FileStream(path, FileMode.CreateNew, FileAccess.ReadWrite, FileShare.None,
+                BufferSize, FileOptions.DeleteOnClose | FileOptions.SequentialScan);
+        }
+
+        public void Write(UInt128 hash, long sequence, long count)
+        {
+            BinaryPrimitives.WriteUInt64LittleEndian(_record, (ulong)(hash >> 64));
+            BinaryPrimitives.WriteUInt64LittleEndian(_record.AsSpan(8), (ulong)hash);
+            BinaryPrimitives.WriteInt64LittleEndian(_record.AsSpan(16), sequence);
+            BinaryPrimitives.WriteInt64LittleEndian(_record.AsSpan(24), count);
+            _stream.Write(_record);
+        }
+
+        public void Rewind()
+        {
+            _stream.Flush();
+            _stream.Position = 0;
+        }
+
+        public bool TryRead(out UInt128 hash, out long sequence, out long count)
+        {
+            if (_stream.ReadAtLeast(_record, RecordSize, throwOnEndOfStream: false) < RecordSize)
+            {
+                hash = default;
+                sequence = count = 0;
+                return false;
+            }
+
+            hash = new UInt128(BinaryPrimitives.ReadUInt64LittleEndian(_record),
+                BinaryPrimitives.ReadUInt64LittleEndian(_record.AsSpan(8)));
+            sequence = BinaryPrimitives.ReadInt64LittleEndian(_record.AsSpan(16));
+            count = BinaryPrimitives.ReadInt64LittleEndian(_record.AsSpan(24));
+            return true;
+        }
+
+        public void Dispose() => _stream.Dispose();
+    }
+}
@@ -0,0 +1,92 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Search;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// Keeps the lines of a document range that a predicate selects, for
+/// ranges of any size: each window of lines is tested in parallel and the
+/// kept lines are written in their original order.
+/// </summary>
+/// <remarks>
+/// Kept lines are joined with the first line break of the range, and a line
+/// break at the end of the range stays at the end of the output.
+/// </remarks>
+public static class LineFilter
+{
+    // Windows with fewer lines are tested on the calling thread.
+    private const int MinParallelLines = 4096;
+
+    /// <summary>
+    /// Returns a transform that keeps the lines <paramref name="keep"/>
+    /// selects.
+    /// </summary>
+    /// <param name="keep">Selects the lines to keep; called from several threads at once.</param>
+    /// <param name="keepFirstLine">Keeps the first line of the range regardless, for a header row.</param>
+    public static StreamingTransform Create(LinePredicate keep, bool keepFirstLine = false)
+    {
+        ArgumentNullException.ThrowIfNull(keep);
+        return (source, start, length, output, progress, cancellationToken) =>
+            Filter(source, start, length, output, keep, keepFirstLine, progress, cancellationToken);
+    }
+
+    private static void Filter(PieceTable source, long start, long length, TextWriter output,
+        LinePredicate keep, bool keepFirstLine, IProgress<int>? progress, CancellationToken cancellationToken)
+    {
+        ArgumentNullException.ThrowIfNull(source);
+        ArgumentNullException.ThrowIfNull(output);
+
+        bool[] kept = [];
+        var options = new ParallelOptions { CancellationToken = cancellationToken };
+        bool first = true;
+        long written = 0;
+        string? lineBreak = null;
+
+        bool endsWithLineBreak = LineWindows.ForEachLineBatch(source, start, length, lines =>
+        {
+            if (kept.Length < lines.Count)
+                kept = new bool[lines.Count];
+
+            if (lines.Count < MinParallelLines)
+            {
+                for (int i = 0; i < lines.Count; i++)
+                    kept[i] = keep(lines[i].Span);
+            }
+            else
+            {
+                bool[] results = kept;
+                Parallel.For(0, lines.Count, options, i => results[i] = keep(lines[i].Span));
+            }
+
+            if (first && keepFirstLine && lines.Count > 0)
+                kept[0] = true;
+            first = false;
+
+            for (int i = 0; i < lines.Count; i++)
+            {
+                if (!kept[i]) continue;
+                if (written++ > 0)
+                    output.Write(lineBreak ??= FindLineBreak(source, start, length));
+                output.Write(lines[i].Span);
+            }
+        }, progress, 0, 100, out string firstBreak, cancellationToken);
+
+        if (endsWithLineBreak && written > 0)
+            output.Write(firstBreak);
+    }
+
+    /// <summary>
+    /// The first line break of the range.  Only needed once a second line
+    /// is written, by which point the range is known to have one.
+    /// </summary>
+    private static string FindLineBreak(PieceTable source, long start, long length)
+    {
+        foreach (var (_, text) in LineWindows.Enumerate(source, start, length, CancellationToken.None))
+        {
+            int lf = text.Span.IndexOf('\n');
+            if (lf >= 0)
+                return lf > 0 && text.Span[lf - 1] == '\r' ? "\r\n" : "\n";
+        }
+        return "\n";
+    }
+}
@@ -0,0 +1,75 @@
+using System.Buffers.Binary;
+using System.Numerics;
+using System.Runtime.InteropServices;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// 128-bit hash of a line (MurmurHash3 x64/128 over its UTF-16 code units).
+/// Wide enough that line-level transforms can identify lines by hash alone:
+/// a collision between two distinct lines of even a multi-billion-line
+/// document is vanishingly unlikely.
+/// </summary>
+internal static class LineHash
+{
+    private const ulong C1 = 0x87c37b91114253d5;
+    private const ulong C2 = 0x4cf5ad432745937f;
+
+    /// <summary>Hashes <paramref name="line"/>.</summary>
+    public static UInt128 Compute(ReadOnlySpan<char> line)
+    {
+        ReadOnlySpan<byte> data = MemoryMarshal.AsBytes(line);
+        ulong h1 = 0, h2 = 0;
+
+        int blocks = data.Length / 16;
+        for (int i = 0; i < blocks; i++)
+        {
+            ulong k1 = BinaryPrimitives.ReadUInt64LittleEndian(data.Slice(i * 16));
+            ulong k2 = BinaryPrimitives.ReadUInt64LittleEndian(data.Slice(i * 16 + 8));
+
+            h1 ^= MixK1(k1);
+            h1 = BitOperations.RotateLeft(h1, 27) + h2;
+            h1 = h1 * 5 + 0x52dce729;
+
+            h2 ^= MixK2(k2);
+            h2 = BitOperations.RotateLeft(h2, 31) + h1;
+            h2 = h2 * 5 + 0x38495ab5;
+        }
+
+        ReadOnlySpan<byte> tail = data.Slice(blocks * 16);
+        if (tail.Length > 0)
+        {
+            Span<byte> padded = stackalloc byte[16];
+            padded.Clear();
+            tail.CopyTo(padded);
+            if (tail.Length > 8)
+                h2 ^= MixK2(BinaryPrimitives.ReadUInt64LittleEndian(padded.Slice(8)));
+            h1 ^= MixK1(BinaryPrimitives.ReadUInt64LittleEndian(padded));
+        }
+
+        h1 ^= (ulong)data.Length;
+        h2 ^= (ulong)data.Length;
+        h1 += h2;
+        h2 += h1;
+        h1 = FMix(h1);
+        h2 = FMix(h2);
+        h1 += h2;
+        h2 += h1;
+
+        return new UInt128(h1, h2);
+    }
+
+    private static ulong MixK1(ulong k) => BitOperations.RotateLeft(k * C1, 31) * C2;
+
+    private static ulong MixK2(ulong k) => BitOperations.RotateLeft(k * C2, 33) * C1;
+
+    private static ulong FMix(ulong k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccd;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53;
+        k ^= k >> 33;
+        return k;
+    }
+}
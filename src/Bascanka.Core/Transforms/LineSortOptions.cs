@@ -0,0 +1,72 @@
+using Bascanka.Core.Navigation;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// How <see cref="LineSorter"/> compares sort keys.
+/// </summary>
+public enum LineComparison
+{
+    /// <summary>By UTF-16 code unit.</summary>
+    Ordinal,
+
+    /// <summary>By code unit after invariant case folding.</summary>
+    IgnoreCase,
+
+    /// <summary>
+    /// By the number the key starts with (optional sign, digits, optional
+    /// fraction).  Keys without a number sort before all numbers; ties are
+    /// broken ordinally.
+    /// </summary>
+    Numeric,
+}
+
+/// <summary>
+/// Options for <see cref="LineSorter"/>.
+/// </summary>
+public sealed class LineSortOptions
+{
+    /// <summary>How keys are compared.</summary>
+    public LineComparison Comparison { get; init; } = LineComparison.Ordinal;
+
+    /// <summary>Sorts from the largest key to the smallest.</summary>
+    /// <remarks>Lines with equal keys keep their order in either direction.</remarks>
+    public bool Descending { get; init; }
+
+    /// <summary>
+    /// One-based index of the field used as the key, or 0 to use the whole
+    /// line.  A line with fewer fields has an empty key.
+    /// </summary>
+    public int KeyField { get; init; }
+
+    /// <summary>
+    /// Separates fields when <see cref="KeyField"/> is set.  When
+    /// <see langword="null"/>, fields are separated by runs of spaces and
+    /// tabs, and leading blanks are ignored.
+    /// </summary>
+    public char? FieldSeparator { get; init; }
+
+    /// <summary>
+    /// Splits fields as CSV when <see cref="KeyField"/> is set: separators
+    /// inside quoted fields are ignored and the key is the field without its
+    /// quotes.  Takes precedence over <see cref="FieldSeparator"/>.  Each
+    /// line is sorted as one record, so quoted line breaks are not supported.
+    /// </summary>
+    public CsvDialect? Csv { get; init; }
+
+    /// <summary>Leaves the first line of the range at the top, for a header row.</summary>
+    public bool KeepFirstLine { get; init; }
+
+    /// <summary>
+    /// Approximate memory, in bytes, for lines held in memory at once.
+    /// Larger inputs are sorted in runs of this size that are spilled to
+    /// temporary files and merged.
+    /// </summary>
+    public long MemoryBudget { get; init; } = 256L * 1024 * 1024;
+
+    /// <summary>
+    /// Directory for spilled runs, or <see langword="null"/> for the system
+    /// temporary directory.
+    /// </summary>
+    public string? TempDirectory { get; init; }
+}
@@ -0,0 +1,348 @@
+using System.Globalization;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Navigation;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// Sorts the lines of a document range of any size: runs that fit in a
+/// memory budget are sorted in parallel, spilled to temporary files when
+/// the input is larger, and merged into the output.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The sort is stable: lines with equal keys keep their input order, also
+/// when sorting in descending order.  Every line carries its sequence
+/// number through runs and spill files and ties are broken by it, so the
+/// result does not depend on how the input was split into runs.
+/// </para>
+/// <para>
+/// Lines are joined with the first line break of the range, so CRLF text
+/// stays CRLF.  A line break at the end of the range stays at the end of
+/// the output; the line before it is sorted like any other rather than
+/// leaving an empty line at the top.
+/// </para>
+/// <para>Instances are immutable and may sort several ranges at once.</para>
+/// </remarks>
+public sealed class LineSorter
+{
+    // Estimated bytes per line beyond its characters: the string header,
+    // the entry and the list slot.
+    private const int LineOverheadBytes = 64;
+
+    // Runs are split into at most one segment per core, each at least this long.
+    private const int MinSegmentLines = 16 * 1024;
+
+    private readonly LineSortOptions _options;
+    private readonly EntryComparer _comparer;
+
+    /// <summary>Creates a sorter with the given options.</summary>
+    public LineSorter(LineSortOptions options)
+    {
+        ArgumentNullException.ThrowIfNull(options);
+        if (options.KeyField < 0)
+            throw new ArgumentOutOfRangeException(nameof(options), options.KeyField, "The key field must not be negative.");
+        if (options.MemoryBudget <= 0)
+            throw new ArgumentOutOfRangeException(nameof(options), options.MemoryBudget, "The memory budget must be positive.");
+
+        _options = options;
+        _comparer = new EntryComparer(options.Comparison, options.Descending);
+    }
+
+    /// <summary>Returns a transform that sorts lines with the given options.</summary>
+    public static StreamingTransform Create(LineSortOptions options) => new LineSorter(options).Sort;
+
+    /// <summary>
+    /// Writes the lines of <c>source[start, start + length)</c> to
+    /// <paramref name="output"/> in sorted order.
+    /// </summary>
+    /// <param name="source">The document to read; it is not modified.</param>
+    /// <param name="start">Offset of the first character of the range.</param>
+    /// <param name="length">Number of characters in the range.</param>
+    /// <param name="output">Receives the sorted lines.</param>
+    /// <param name="progress">Receives the percentage done when it changes.</param>
+    /// <param name="cancellationToken">Cancels the sort.</param>
+    /// <exception cref="OperationCanceledException">The sort was cancelled.</exception>
+    public void Sort(PieceTable source, long start, long length, TextWriter output,
+        IProgress<int>? progress = null, CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(source);
+        ArgumentNullException.ThrowIfNull(output);
+        ArgumentOutOfRangeException.ThrowIfNegative(start);
+        ArgumentOutOfRangeException.ThrowIfNegative(length);
+
+        var runs = new List<SpillFile>();
+        try
+        {
+            var buffer = new List<Entry>();
+            long bufferBytes = 0;
+            long sequence = 0;
+            string? header = null;
+
+            bool endsWithLineBreak = LineWindows.ForEachLine(source, start, length, line =>
+            {
+                if (_options.KeepFirstLine && header is null)
+                {
+                    header = line.ToString();
+                    return;
+                }
+
+                buffer.Add(CreateEntry(line.ToString(), sequence++));
+                bufferBytes += line.Length * 2L + LineOverheadBytes;
+                if (bufferBytes >= _options.MemoryBudget)
+                {
+                    runs.Add(SpillRun(buffer, cancellationToken));
+                    buffer.Clear();
+                    bufferBytes = 0;
+                }
+            }, progress, 0, 50, out string lineBreak, cancellationToken);
+
+            var writer = new LineWriter(output, lineBreak, sequence + (header is null ? 0 : 1), progress);
+            if (header is not null)
+                writer.Write(header);
+            if (runs.Count == 0)
+            {
+                var segments = SortSegments(buffer, cancellationToken);
+                Merge(segments.Select(s => ((IEnumerable<Entry>)s).GetEnumerator()).ToList(), writer, cancellationToken);
+            }
+            else
+            {
+                if (buffer.Count > 0)
+                    runs.Add(SpillRun(buffer, cancellationToken));
+                buffer = [];
+                Merge(runs.Select(ReadRun).ToList(), writer, cancellationToken);
+            }
+
+            if (endsWithLineBreak && (sequence > 0 || header is not null))
+                output.Write(lineBreak);
+        }
+        finally
+        {
+            foreach (SpillFile run in runs)
+                run.Dispose();
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Runs
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Sorts <paramref name="buffer"/> as independent segments in parallel
+    /// and returns the sorted segments, ready to be merged.
+    /// </summary>
+    private List<ArraySegment<Entry>> SortSegments(List<Entry> buffer, CancellationToken cancellationToken)
+    {
+        Entry[] entries = buffer.ToArray();
+        buffer.Clear();
+
+        int count = Math.Clamp(entries.Length / MinSegmentLines, 1, Environment.ProcessorCount);
+        var segments = new List<ArraySegment<Entry>>(count);
+        for (int i = 0; i < count; i++)
+        {
+            int lo = (int)((long)entries.Length * i / count);
+            int hi = (int)((long)entries.Length * (i + 1) / count);
+            segments.Add(new ArraySegment<Entry>(entries, lo, hi - lo));
+        }
+
+        Parallel.ForEach(segments, new ParallelOptions { CancellationToken = cancellationToken },
+            segment => Array.Sort(entries, segment.Offset, segment.Count, _comparer));
+        return segments;
+    }
+
+    /// <summary>Sorts the buffered lines and writes them to a new spill file.</summary>
+    private SpillFile SpillRun(List<Entry> buffer, CancellationToken cancellationToken)
+    {
+        var run = new SpillFile(_options.TempDirectory);
+        try
+        {
+            var segments = SortSegments(buffer, cancellationToken);
+            var lines = MergeEntries(segments.Select(s => ((IEnumerable<Entry>)s).GetEnumerator()).ToList(), cancellationToken);
+            foreach (Entry entry in lines)
+                run.Write(entry.Sequence, entry.Line);
+            run.Rewind();
+            return run;
+        }
+        catch
+        {
+            run.Dispose();
+            throw;
+        }
+    }
+
+    private IEnumerator<Entry> ReadRun(SpillFile run)
+    {
+        while (run.TryRead(out long sequence, out string line))
+            yield return CreateEntry(line, sequence);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Merging
+    // ────────────────────────────────────────────────────────────────────
+
+    private void Merge(List<IEnumerator<Entry>> sources, LineWriter writer, CancellationToken cancellationToken)
+    {
+        foreach (Entry entry in MergeEntries(sources, cancellationToken))
+            writer.Write(entry.Line);
+    }
+
+    /// <summary>K-way merge of sorted sequences.</summary>
+    private IEnumerable<Entry> MergeEntries(List<IEnumerator<Entry>> sources, CancellationToken cancellationToken)
+    {
+        var queue = new PriorityQueue<int, Entry>(sources.Count, _comparer);
+        for (int i = 0; i < sources.Count; i++)
+        {
+            if (sources[i].MoveNext())
+                queue.Enqueue(i, sources[i].Current);
+        }
+
+        int sinceCheck = 0;
+        while (queue.TryDequeue(out int index, out Entry entry))
+        {
+            if (++sinceCheck == 4096)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+                sinceCheck = 0;
+            }
+
+            yield return entry;
+            if (sources[index].MoveNext())
+                queue.Enqueue(index, sources[index].Current);
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Keys
+    // ────────────────────────────────────────────────────────────────────
+
+    private Entry CreateEntry(string line, long sequence)
+    {
+        (int keyStart, int keyLength) = FindKey(line);
+        double number = 0;
+        bool hasNumber = _options.Comparison == LineComparison.Numeric
+            && TryParseLeadingNumber(line.AsSpan(keyStart, keyLength), out number);
+        return new Entry(line, sequence, keyStart, keyLength, number, hasNumber);
+    }
+
+    /// <summary>Finds the key field of a line.</summary>
+    private (int Start, int Length) FindKey(string line)
+    {
+        int field = _options.KeyField;
+        if (field == 0)
+            return (0, line.Length);
+
+        if (_options.Csv is { } csv)
+        {
+            return csv.TryGetField(line, field - 1, out Range key)
+                ? key.GetOffsetAndLength(line.Length)
+                : (line.Length, 0);
+        }
+
+        if (_options.FieldSeparator is char separator)
+        {
+            int pos = 0;
+            for (int i = 1; i < field; i++)
+            {
+                int next = line.IndexOf(separator, pos);
+                if (next < 0) return (line.Length, 0);
+                pos = next + 1;
+            }
+            int end = line.IndexOf(separator, pos);
+            return (pos, (end < 0 ? line.Length : end) - pos);
+        }
+
+        int p = 0;
+        for (int i = 1; ; i++)
+        {
+            while (p < line.Length && line[p] is ' ' or '\t') p++;
+            int fieldStart = p;
+            while (p < line.Length && line[p] is not (' ' or '\t')) p++;
+            if (i == field || p == fieldStart)
+                return (fieldStart, p - fieldStart);
+        }
+    }
+
+    /// <summary>
+    /// Parses an optional sign, digits and an optional fraction at the start
+    /// of <paramref name="key"/>, after leading blanks.
+    /// </summary>
+    private static bool TryParseLeadingNumber(ReadOnlySpan<char> key, out double number)
+    {
+        key = key.TrimStart(" \t");
+        int i = 0;
+        if (i < key.Length && key[i] is '+' or '-') i++;
+        int digitsStart = i;
+        while (i < key.Length && char.IsAsciiDigit(key[i])) i++;
+        int digits = i - digitsStart;
+        if (i < key.Length && key[i] == '.')
+        {
+            int fractionStart = ++i;
+            while (i < key.Length && char.IsAsciiDigit(key[i])) i++;
+            digits += i - fractionStart;
+            if (i == fractionStart) i--;  // "12." parses as 12
+        }
+
+        number = 0;
+        return digits > 0 && double.TryParse(key[..i], NumberStyles.Float, CultureInfo.InvariantCulture, out number);
+    }
+
+    /// <summary>A line, its position in the input and its parsed key.</summary>
+    private readonly record struct Entry(string Line, long Sequence, int KeyStart, int KeyLength,
+        double Number, bool HasNumber)
+    {
+        public ReadOnlySpan<char> Key => Line.AsSpan(KeyStart, KeyLength);
+    }
+
+    private sealed class EntryComparer(LineComparison comparison, bool descending) : IComparer<Entry>
+    {
+        public int Compare(Entry x, Entry y)
+        {
+            int c = CompareKeys(in x, in y);
+            if (descending) c = -c;
+            return c != 0 ? c : x.Sequence.CompareTo(y.Sequence);
+        }
+
+        private int CompareKeys(in Entry x, in Entry y)
+        {
+            switch (comparison)
+            {
+                case LineComparison.IgnoreCase:
+                    return x.Key.CompareTo(y.Key, StringComparison.OrdinalIgnoreCase);
+
+                case LineComparison.Numeric:
+                    if (x.HasNumber != y.HasNumber)
+                        return x.HasNumber ? 1 : -1;
+                    if (x.HasNumber)
+                    {
+                        int n = x.Number.CompareTo(y.Number);
+                        if (n != 0) return n;
+                    }
+                    return x.Key.SequenceCompareTo(y.Key);
+
+                default:
+                    return x.Key.SequenceCompareTo(y.Key);
+            }
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Output
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>Writes lines separated by line breaks and reports progress.</summary>
+    private sealed class LineWriter(TextWriter output, string lineBreak, long total, IProgress<int>? progress)
+    {
+        private long _written;
+        private int _lastPercent = -1;
+
+        public void Write(string line)
+        {
+            if (_written > 0)
+                output.Write(lineBreak);
+            output.Write(line);
+            _written++;
+            if ((_written & 0xFFF) == 0 || _written == total)
+                LineWindows.Report(progress, 50 + (int)(_written * 50 / total), ref _lastPercent);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// Reads a range of a document in windows that hold whole lines, so that
+/// line-oriented transforms never see a line split across two reads.
+/// </summary>
+internal static class LineWindows
+{
+    /// <summary>Windows are about this many characters long.</summary>
+    public const int WindowSize = 1024 * 1024;
+
+    /// <summary>
+    /// Yields the range as consecutive windows.  Every window ends just
+    /// after a line feed, except the last, which ends at the end of the
+    /// range.  A line longer than <see cref="WindowSize"/> is returned in
+    /// one larger window.
+    /// </summary>
+    public static IEnumerable<(long Offset, ReadOnlyMemory<char> Text)> Enumerate(
+        PieceTable source, long start, long length, CancellationToken cancellationToken)
+    {
+        long end = start + length;
+        long offset = start;
+        int window = WindowSize;
+
+        while (offset < end)
+        {
+            cancellationToken.ThrowIfCancellationRequested();
+
+            int take = (int)Math.Min(window, end - offset);
+            string text = source.GetText(offset, take);
+            int usable = text.Length;
+            if (offset + take < end)
+            {
+                int lf = text.LastIndexOf('\n');
+                if (lf < 0)
+                {
+                    window = (int)Math.Min((long)window * 2, Array.MaxLength);
+                    continue;
+                }
+                usable = lf + 1;
+            }
+
+            yield return (offset, text.AsMemory(0, usable));
+            offset += usable;
+            window = WindowSize;
+        }
+    }
+
+    /// <summary>
+    /// Calls <paramref name="action"/> with every line of the range, without
+    /// its line break.  A line break at the very end of the range terminates
+    /// the last line rather than starting an empty one.
+    /// </summary>
+    /// <param name="progressStart">Percentage reported before the first line.</param>
+    /// <param name="progressEnd">Percentage reported after the last line.</param>
+    /// <param name="lineBreak">
+    /// The first line break in the range, <c>"\r\n"</c> or <c>"\n"</c>;
+    /// <c>"\n"</c> when the range has none.  Transforms join their output
+    /// lines with it.
+    /// </param>
+    /// <returns>Whether the range ends with a line break.</returns>
+    public static bool ForEachLine(PieceTable source, long start, long length,
+        Action<ReadOnlyMemory<char>> action, IProgress<int>? progress, int progressStart, int progressEnd,
+        out string lineBreak, CancellationToken cancellationToken)
+    {
+        return ForEachLineBatch(source, start, length, lines =>
+        {
+            foreach (ReadOnlyMemory<char> line in lines)
+                action(line);
+        }, progress, progressStart, progressEnd, out lineBreak, cancellationToken);
+    }
+
+    /// <summary>
+    /// Like <see cref="ForEachLine"/>, but calls <paramref name="action"/>
+    /// once per window with all of its lines, so that callers can process
+    /// them in parallel.  The list is reused between calls.
+    /// </summary>
+    public static bool ForEachLineBatch(PieceTable source, long start, long length,
+        Action<List<ReadOnlyMemory<char>>> action, IProgress<int>? progress, int progressStart, int progressEnd,
+        out string lineBreak, CancellationToken cancellationToken)
+    {
+        var lines = new List<ReadOnlyMemory<char>>();
+        string? firstBreak = null;
+        bool endsWithLineBreak = false;
+        int lastPercent = -1;
+        foreach (var (offset, text) in Enumerate(source, start, length, cancellationToken))
+        {
+            lines.Clear();
+            ReadOnlySpan<char> span = text.Span;
+            int pos = 0;
+            while (pos < span.Length)
+            {
+                int lf = span[pos..].IndexOf('\n');
+                int lineEnd = lf < 0 ? span.Length : pos + lf;
+                bool crlf = lf >= 0 && lineEnd > pos && span[lineEnd - 1] == '\r';
+                if (lf >= 0)
+                    firstBreak ??= crlf ? "\r\n" : "\n";
+                lines.Add(text[pos..(crlf ? lineEnd - 1 : lineEnd)]);
+                pos = lf < 0 ? span.Length : lineEnd + 1;
+            }
+            action(lines);
+
+            endsWithLineBreak = span.Length > 0 && span[^1] == '\n';
+            long done = offset + text.Length - start;
+            Report(progress, progressStart + (int)(done * (progressEnd - progressStart) / Math.Max(length, 1)), ref lastPercent);
+        }
+        lineBreak = firstBreak ?? "\n";
+        return endsWithLineBreak;
+    }
+
+    /// <summary>Reports <paramref name="percent"/> if it changed.</summary>
+    public static void Report(IProgress<int>? progress, int percent, ref int lastPercent)
+    {
+        if (progress is null || percent == lastPercent) return;
+        lastPercent = percent;
+        progress.Report(percent);
+    }
+}
@@ -0,0 +1,88 @@
+using System.Buffers.Binary;
+using System.Runtime.InteropServices;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// A temporary file of tagged lines that is written once, then read back
+/// in the same order.  The file is deleted when the instance is disposed
+/// (or the process ends).
+/// </summary>
+/// <remarks>
+/// Records are an int64 tag, an int32 character count and the characters
+/// as UTF-16 in machine byte order; the file never leaves the process, and
+/// UTF-16 round-trips any string, including lone surrogates.
+/// <para>This class is <b>not</b> thread-safe.</para>
+/// </remarks>
+internal sealed class SpillFile : IDisposable
+{
+    private const int BufferSize = 1024 * 1024;
+
+    private readonly FileStream _stream;
+    private readonly byte[] _header = new byte[12];
+    private bool _reading;
+
+    /// <summary>Creates an empty spill file in <paramref name="directory"/>.</summary>
+    /// <param name="directory">
+    /// Directory for the file, or <see langword="null"/> for the system
+    /// temporary directory.
+    /// </param>
+    public SpillFile(string? directory)
+    {
+        string path = Path.Combine(directory ?? Path.GetTempPath(), $"bascanka-{Guid.NewGuid():N}.spill");
+        _stream = new FileStream(path, FileMode.CreateNew, FileAccess.ReadWrite, FileShare.None,
+            BufferSize, FileOptions.DeleteOnClose | FileOptions.SequentialScan);
+    }
+
+    /// <summary>Number of records written.</summary>
+    public long Count { get; private set; }
+
+    /// <summary>Size of the file, in bytes.</summary>
+    public long Length => _stream.Length;
+
+    /// <summary>Appends a record.</summary>
+    public void Write(long tag, ReadOnlySpan<char> line)
+    {
+        if (_reading)
+            throw new InvalidOperationException("The spill file has been rewound for reading.");
+
+        BinaryPrimitives.WriteInt64LittleEndian(_header, tag);
+        BinaryPrimitives.WriteInt32LittleEndian(_header.AsSpan(8), line.Length);
+        _stream.Write(_header);
+        _stream.Write(MemoryMarshal.AsBytes(line));
+        Count++;
+    }
+
+    /// <summary>Finishes writing; records are then read from the start.</summary>
+    public void Rewind()
+    {
+        _stream.Flush();
+        _stream.Position = 0;
+        _reading = true;
+    }
+
+    /// <summary>Reads the next record, or returns false at the end of the file.</summary>
+    public bool TryRead(out long tag, out string line)
+    {
+        if (!_reading)
+            throw new InvalidOperationException("Call Rewind before reading.");
+
+        if (_stream.ReadAtLeast(_header, _header.Length, throwOnEndOfStream: false) < _header.Length)
+        {
+            tag = 0;
+            line = string.Empty;
+            return false;
+        }
+
+        tag = BinaryPrimitives.ReadInt64LittleEndian(_header);
+        int length = BinaryPrimitives.ReadInt32LittleEndian(_header.AsSpan(8));
+        line = length == 0
+            ? string.Empty
+            : string.Create(length, _stream, static (chars, stream) =>
+                stream.ReadExactly(MemoryMarshal.AsBytes(chars)));
+        return true;
+    }
+
+    /// <inheritdoc />
+    public void Dispose() => _stream.Dispose();
+}
@@ -0,0 +1,20 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Transforms;
+
+/// <summary>
+/// Reads a range of a document and writes its replacement text to
+/// <paramref name="output"/>, without holding the range in memory.
+/// </summary>
+/// <param name="source">The document to read; it is not modified.</param>
+/// <param name="start">Offset of the first character of the range.</param>
+/// <param name="length">Number of characters in the range.</param>
+/// <param name="output">Receives the replacement text.</param>
+/// <param name="progress">Receives the percentage done when it changes.</param>
+/// <param name="cancellationToken">Cancels the transform.</param>
+/// <remarks>
+/// Transforms run on a background thread against a document that the
+/// caller keeps read-only until they return.
+/// </remarks>
+public delegate void StreamingTransform(PieceTable source, long start, long length, TextWriter output,
+    IProgress<int>? progress, CancellationToken cancellationToken);
@@ -0,0 +1,123 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Editor.Controls;
+
+/// <summary>
+/// Keeps an index of a document, such as its JSON structure or CSV fields.
+/// The index is built on the thread pool from a snapshot of the document,
+/// dropped as soon as the document is edited, and rebuilt once edits pause.
+/// </summary>
+/// <remarks>
+/// Dropping the index on an edit is silent: <see cref="IndexChanged"/> is
+/// raised when the rebuilt index lands, not on every keystroke, so
+/// listeners keep showing what they derived from the previous index in the
+/// meantime.  All members must be called on the UI thread.
+/// </remarks>
+/// <typeparam name="TIndex">The index type; instances must be safe to query once built.</typeparam>
+public sealed class DocumentIndexer<TIndex> : IDisposable
+    where TIndex : class
+{
+    /// <summary>Milliseconds without edits before the index is rebuilt.</summary>
+    private const int RebuildDelay = 750;
+
+    private readonly Func<PieceTable, CancellationToken, TIndex> _build;
+    private readonly System.Windows.Forms.Timer _rebuildTimer;
+    private PieceTable? _document;
+    private CancellationTokenSource? _cts;
+
+    /// <param name="build">
+    /// Builds the index of a snapshot on a background thread, throwing
+    /// <see cref="OperationCanceledException"/> when cancelled.
+    /// </param>
+    public DocumentIndexer(Func<PieceTable, CancellationToken, TIndex> build)
+    {
+        ArgumentNullException.ThrowIfNull(build);
+        _build = build;
+        _rebuildTimer = new System.Windows.Forms.Timer { Interval = RebuildDelay };
+        _rebuildTimer.Tick += (_, _) => Rebuild();
+    }
+
+    /// <summary>
+    /// The index of the document's current text, or <see langword="null"/>
+    /// while it is being built.
+    /// </summary>
+    public TIndex? Index { get; private set; }
+
+    /// <summary>
+    /// Raised when a built index is set, and when the index is dropped
+    /// because <see cref="Document"/> was replaced.
+    /// </summary>
+    public event EventHandler? IndexChanged;
+
+    /// <summary>The document to index, or <see langword="null"/> to stop indexing.</summary>
+    public PieceTable? Document
+    {
+        get => _document;
+        set
+        {
+            if (ReferenceEquals(_document, value)) return;
+            if (_document is not null)
+                _document.TextChanged -= OnDocumentTextChanged;
+            _document = value;
+            if (_document is not null)
+                _document.TextChanged += OnDocumentTextChanged;
+
+            SetIndex(null);
+            Rebuild();
+        }
+    }
+
+    private void OnDocumentTextChanged(object? sender, TextChangedEventArgs e)
+    {
+        _cts?.Cancel();
+        Index = null;
+        _rebuildTimer.Stop();
+        _rebuildTimer.Start();
+    }
+
+    private async void Rebuild()
+    {
+        _rebuildTimer.Stop();
+        _cts?.Cancel();
+        if (_document is not { Length: > 0 } document) return;
+
+        var cts = new CancellationTokenSource();
+        _cts = cts;
+        PieceTable snapshot = document.CreateSnapshot();
+        try
+        {
+            var index = await Task.Run(() => _build(snapshot, cts.Token), cts.Token);
+            if (!cts.IsCancellationRequested && ReferenceEquals(document, _document))
+                SetIndex(index);
+        }
+        catch (OperationCanceledException)
+        {
+        }
+        catch (ObjectDisposedException)
+        {
+            // The document was closed during the build.
+        }
+        finally
+        {
+            if (ReferenceEquals(_cts, cts))
+                _cts = null;
+            cts.Dispose();
+        }
+    }
+
+    private void SetIndex(TIndex? index)
+    {
+        if (ReferenceEquals(Index, index)) return;
+        Index = index;
+        IndexChanged?.Invoke(this, EventArgs.Empty);
+    }
+
+    public void Dispose()
+    {
+        if (_document is not null)
+            _document.TextChanged -= OnDocumentTextChanged;
+        _document = null;
+        _cts?.Cancel();
+        _rebuildTimer.Dispose();
+    }
+}
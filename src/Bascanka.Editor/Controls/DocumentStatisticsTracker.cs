@@ -0,0 +1,222 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Navigation;
+
+namespace Bascanka.Editor.Controls;
+
+/// <summary>
+/// Keeps the <see cref="DocumentStatistics"/> of a document current: the
+/// document is counted on the thread pool from a snapshot, and each edit
+/// counts again only the chunks it touched, on the UI thread.  Edits made
+/// while a count runs are merged into one range and applied once it ends,
+/// so typing never waits for the count.
+/// </summary>
+/// <remarks>All members must be called on the UI thread.</remarks>
+public sealed class DocumentStatisticsTracker : IDisposable
+{
+    private PieceTable? _document;
+    private DocumentStatistics _statistics = new();
+    private CancellationTokenSource? _cts;
+    private Task? _count;
+    private volatile int _percent;
+    private int _reportedPercent = -1;
+
+    // The edits made during the running count, merged into one range of
+    // the snapshot it counts and its replacement in the document now.
+    private (long Offset, long OldLength, long NewLength)? _pendingEdit;
+
+    /// <summary>The document to count, or <see langword="null"/> to stop counting.</summary>
+    public PieceTable? Document
+    {
+        get => _document;
+        set
+        {
+            if (ReferenceEquals(_document, value)) return;
+            CancelCount();
+            if (_document is not null)
+                _document.TextChanged -= OnDocumentTextChanged;
+            _document = value;
+            if (_document is not null)
+                _document.TextChanged += OnDocumentTextChanged;
+
+            // A cancelled count may still be writing to the old statistics.
+            _statistics = new DocumentStatistics(_statistics.Encoding);
+            StartCount();
+        }
+    }
+
+    /// <summary>
+    /// The encoding whose byte count is kept; changing it counts the
+    /// document again.
+    /// </summary>
+    public System.Text.Encoding Encoding
+    {
+        get => _statistics.Encoding;
+        set
+        {
+            ArgumentNullException.ThrowIfNull(value);
+            if (_statistics.Encoding.CodePage == value.CodePage) return;
+            CancelCount();
+            _statistics = new DocumentStatistics(value);
+            StartCount();
+        }
+    }
+
+    /// <summary>Whether the whole document has been counted.</summary>
+    public bool IsComplete =>
+        _count is null && _document is not null && _statistics.CountedLength == _document.Length;
+
+    /// <summary>Percentage of the document counted.</summary>
+    public int Percent => _count is null ? 100 : _percent;
+
+    /// <summary>
+    /// Why counting stopped, such as a file that could no longer be read;
+    /// cleared when the document or encoding changes.
+    /// </summary>
+    public Exception? Error { get; private set; }
+
+    /// <summary>
+    /// The counts of the whole document, or <see langword="null"/> while it
+    /// is being counted.
+    /// </summary>
+    public TextStatistics? Total => IsComplete ? _statistics.Total : null;
+
+    /// <summary>
+    /// Raised when <see cref="Total"/> changes, and as the count progresses.
+    /// </summary>
+    public event EventHandler? Changed;
+
+    /// <summary>
+    /// Returns the counts of a range of the document, or
+    /// <see langword="null"/> while the document is being counted.
+    /// </summary>
+    public TextStatistics? GetRange(long start, long length) =>
+        IsComplete ? _statistics.GetRange(_document!, start, length) : null;
+
+    private async void StartCount()
+    {
+        if (_document is not { } document) return;
+
+        var cts = new CancellationTokenSource();
+        _cts = cts;
+        _percent = 0;
+        _pendingEdit = null;
+        Error = null;
+        DocumentStatistics statistics = _statistics;
+        PieceTable snapshot = document.CreateSnapshot();
+        var progress = new Progress<int>(p =>
+        {
+            _percent = p;
+            if (ReferenceEquals(_cts, cts) && p / 10 != _reportedPercent / 10)
+            {
+                _reportedPercent = p;
+                Changed?.Invoke(this, EventArgs.Empty);
+            }
+        });
+
+        Task count = Task.Run(() => statistics.CountRemaining(snapshot, progress, cts.Token), cts.Token);
+        _count = count;
+        bool failed = false;
+        try
+        {
+            await count;
+        }
+        catch (OperationCanceledException)
+        {
+        }
+        catch (ObjectDisposedException)
+        {
+            // The document was closed during the count.
+        }
+        catch (IOException ex)
+        {
+            // The file behind the document could not be read.
+            if (ReferenceEquals(_cts, cts))
+                Error = ex;
+            failed = true;
+        }
+        finally
+        {
+            cts.Dispose();
+        }
+
+        // A newer count, document or encoding took over, or the tracker
+        // was disposed.
+        if (!ReferenceEquals(_cts, cts) || _document is null) return;
+        _cts = null;
+        _count = null;
+        _reportedPercent = -1;
+
+        if (!failed && _pendingEdit is { } edit)
+            ApplyEdit(edit.Offset, edit.OldLength, edit.NewLength);
+        else
+            _pendingEdit = null;
+        Changed?.Invoke(this, EventArgs.Empty);
+    }
+
+    /// <summary>
+    /// Lets the current count run out without waiting for it; its results
+    /// are ignored.
+    /// </summary>
+    private void CancelCount()
+    {
+        _cts?.Cancel();
+        _cts = null;
+        _count = null;
+        _pendingEdit = null;
+        _reportedPercent = -1;
+        Error = null;
+    }
+
+    private void OnDocumentTextChanged(object? sender, TextChangedEventArgs e)
+    {
+        if (Error is not null) return;
+
+        if (_count is not null)
+        {
+            // Merge with the edits already waiting for the count to end.
+            if (_pendingEdit is { } p)
+            {
+                long start = Math.Min(p.Offset, e.Offset);
+                long end = Math.Max(p.Offset + p.NewLength, e.Offset + e.OldLength);
+                long oldEnd = p.Offset + p.OldLength + (end - (p.Offset + p.NewLength));
+                long newEnd = end + e.NewLength - e.OldLength;
+                _pendingEdit = (start, oldEnd - start, newEnd - start);
+            }
+            else
+            {
+                _pendingEdit = (e.Offset, e.OldLength, e.NewLength);
+            }
+            return;
+        }
+
+        ApplyEdit(e.Offset, e.OldLength, e.NewLength);
+        Changed?.Invoke(this, EventArgs.Empty);
+    }
+
+    /// <summary>
+    /// Counts again the chunks an edit touched, and counts on in the
+    /// background if the document is longer than what was counted.
+    /// </summary>
+    private void ApplyEdit(long offset, long oldLength, long newLength)
+    {
+        try
+        {
+            _statistics.Update(_document!, offset, oldLength, newLength);
+        }
+        catch (IOException ex)
+        {
+            Error = ex;
+            return;
+        }
+        if (_statistics.CountedLength < _document!.Length)
+            StartCount();
+    }
+
+    public void Dispose()
+    {
+        if (_document is not null)
+            _document.TextChanged -= OnDocumentTextChanged;
+        _document = null;
+        _cts?.Cancel();
+    }
+}
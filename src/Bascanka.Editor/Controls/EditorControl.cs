@@ -3,6 +3,8 @@ using System.Text.RegularExpressions;
 using Bascanka.Core.Buffer;
 using Bascanka.Core.Commands;
 using Bascanka.Core.Diff;
+using Bascanka.Core.Macros;
+using Bascanka.Core.Navigation;
 using Bascanka.Core.Search;
 using Bascanka.Core.Syntax;
 using Bascanka.Editor.HexEditor;
@@ -41,12 +43,19 @@ public sealed class EditorControl : UserControl
 
     // ── Syntax ─────────────────────────────────────────────────────────
     private readonly TokenCache _tokenCache;
+    private readonly ScrollPrefetcher _scrollPrefetcher;
+    private readonly DocumentIndexer<JsonIndexState> _jsonIndexer;
+    private string _lastJsonPath = string.Empty;
     private ILexer? _lexer;
     private string _language = string.Empty;
     private ITheme _theme;
 
     // ── Document ───────────────────────────────────────────────────────
     private PieceTable _document;
+    private LogTimeIndex? _logTimeIndex;
+    private bool _logTimeIndexBuilt;
+    private int _logTimeIndexVersion;
+    private DocumentStatisticsTracker? _statisticsTracker;
     private bool _readOnly;
     private string? _filePath;
     private long _fileSizeBytes;
@@ -54,7 +63,9 @@ public sealed class EditorControl : UserControl
     // ── Custom highlighting ─────────────────────────────────────────────
     private CustomHighlightMatcher? _customHighlightMatcher;
     private string? _customProfileName;
-    private List<BlockRegion>? _customBlockRegions;
+    private IReadOnlyList<BlockRegion>? _customBlockRegions;
+    private BlockRegionTracker? _customBlockTracker;
+    private bool _customFoldUpdatePending;
 
     // ── Find/Replace panel ─────────────────────────────────────────────
     private FindReplacePanel? _findPanel;
@@ -161,6 +172,30 @@ public sealed class EditorControl : UserControl
     /// <summary>Raised when insert/overwrite mode is toggled via the Insert key.</summary>
     public event EventHandler? InsertModeChanged;
 
+    /// <summary>
+    /// Raised when a rebuilt <see cref="JsonIndex"/> becomes available, or
+    /// it is dropped because the document or language changed.
+    /// </summary>
+    public event EventHandler? JsonIndexChanged;
+
+    /// <summary>Raised when <see cref="Statistics"/> changes, and as counting progresses.</summary>
+    public event EventHandler? StatisticsChanged;
+
+    /// <summary>Raised when a macro starts playing back.</summary>
+    public event EventHandler? MacroPlaybackStarted;
+
+    /// <summary>Raised as a macro playback progresses.</summary>
+    public event EventHandler<MacroPlaybackProgressEventArgs>? MacroPlaybackProgressChanged;
+
+    /// <summary>Raised when a macro playback completes, fails or is cancelled.</summary>
+    public event EventHandler? MacroPlaybackFinished;
+
+    /// <summary>
+    /// Raised when a macro playback fails, or its edits cannot be applied;
+    /// the document is left unchanged.
+    /// </summary>
+    public event EventHandler<MacroPlaybackErrorEventArgs>? MacroPlaybackError;
+
     // ────────────────────────────────────────────────────────────────────
     //  Construction
     // ────────────────────────────────────────────────────────────────────
@@ -173,6 +208,9 @@ public sealed class EditorControl : UserControl
         _document = new PieceTable(string.Empty);
         _commandHistory = new CommandHistory();
         _tokenCache = new TokenCache();
+        _scrollPrefetcher = new ScrollPrefetcher(_tokenCache) { Document = _document };
+        _jsonIndexer = new DocumentIndexer<JsonIndexState>(BuildJsonIndex);
+        _jsonIndexer.IndexChanged += OnJsonIndexChanged;
         _theme = new DarkTheme();
 
         // Create managers.
@@ -252,10 +290,15 @@ public sealed class EditorControl : UserControl
         _inputHandler.InsertModeChanged += () => InsertModeChanged?.Invoke(this, EventArgs.Empty);
         _commandHistory.SavePointChanged += OnSavePointChanged;
         _document.TextChanged += OnDocumentTextChanged;
+        _macroPlayer.PlaybackStarted += (_, e) => MacroPlaybackStarted?.Invoke(this, e);
+        _macroPlayer.ProgressChanged += (_, e) => MacroPlaybackProgressChanged?.Invoke(this, e);
+        _macroPlayer.PlaybackFinished += (_, e) => MacroPlaybackFinished?.Invoke(this, e);
+        _macroPlayer.PlaybackError += (_, e) => MacroPlaybackError?.Invoke(this, e);
 
         _surface.Resize += (_, _) =>
         {
-            _surface.InvalidateWrapRowCache();
+            // Wrap rows are re-measured by the layout engine only when the
+            // wrap width actually changes.
             UpdateScrollBars();
             RetokenizeAllVisible();
             if (_wordWrap)
@@ -332,10 +375,31 @@ public sealed class EditorControl : UserControl
             _selectionManager.Document = _document;
             _inputHandler.Document = _document;
             _surface.Document = _document;
+            _scrollPrefetcher.Document = _document;
 
             _tokenCache.Clear();
             _commandHistory.Clear();
             _maxLinePixelWidthCache = 0;
+            InvalidateLogTimeIndex();
+            _statisticsTracker?.Document = _document;
+
+            // Same size limit as SetCustomHighlighting: block scanning reads
+            // every line.
+            if (_customHighlightMatcher is { HasBlockRules: true } && _document.Length < FoldingMaxFileSize)
+            {
+                _customBlockTracker ??= _customHighlightMatcher.CreateBlockTracker();
+                _customBlockTracker.Rebuild(GetLineTexts, _document.LineCount);
+                _customBlockRegions = _customBlockTracker.Regions;
+            }
+            else
+            {
+                _customBlockTracker = null;
+                _customBlockRegions = null;
+                if (_customHighlightMatcher is not null)
+                    _foldingManager.SetRegions([]);
+            }
+            _surface.CustomBlockRegions = _customBlockRegions;
+            DetectFoldingRegions();
 
             UpdateScrollBars();
             _caretManager.MoveTo(0);
@@ -457,6 +521,29 @@ public sealed class EditorControl : UserControl
     /// <summary>The folding manager.</summary>
     public FoldingManager FoldingMgr => _foldingManager;
 
+    /// <summary>
+    /// The structural index of a JSON document, or <see langword="null"/>
+    /// for other languages and while the index is being rebuilt.
+    /// </summary>
+    public JsonStructureIndex? JsonIndex => _jsonIndexer.Index?.Structure;
+
+    /// <summary>
+    /// The path of the innermost JSON object or array at the caret, such as
+    /// <c>$.items[3]</c>, or an empty string when there is no index.  While
+    /// the index is rebuilt after an edit, the last path is returned.
+    /// </summary>
+    public string JsonPathAtCaret
+    {
+        get
+        {
+            if (_jsonIndexer.Index is { } index)
+                _lastJsonPath = index.Structure.GetPath(_caretManager.Offset, _document);
+            else if (_jsonIndexer.Document is null)
+                _lastJsonPath = string.Empty;
+            return _lastJsonPath;
+        }
+    }
+
     /// <summary>The gutter renderer.</summary>
     public GutterRenderer Gutter => _gutterRenderer;
 
@@ -730,11 +817,41 @@ public sealed class EditorControl : UserControl
         }
     }
 
+    /// <summary>
+    /// Maps a line of the document to the zero-based line number the gutter
+    /// shows for it, for views whose lines stand for lines of another
+    /// document; <see langword="null"/> shows each line's own number.
+    /// </summary>
+    public Func<long, long>? LineNumberMap
+    {
+        get => _gutterRenderer.LineNumberMap;
+        set
+        {
+            _gutterRenderer.LineNumberMap = value;
+            _gutterPanel.Invalidate();
+        }
+    }
+
     /// <summary>
     /// Opens raw bytes in hex-only mode: the text editor is hidden and only
     /// the hex editor is shown. Used for binary files (exe, images, etc.).
     /// </summary>
     public void ShowHexOnly(byte[] data)
+    {
+        ShowHexOnlyView().Data = data;
+    }
+
+    /// <summary>
+    /// Opens a file in hex-only mode.  The file is memory-mapped by the hex
+    /// editor, so files of any size open instantly without being read into
+    /// memory.
+    /// </summary>
+    public void ShowHexOnly(string path)
+    {
+        ShowHexOnlyView().LoadFile(path);
+    }
+
+    private HexEditorControl ShowHexOnlyView()
     {
         _isBinaryMode = true;
         _hexPanelVisible = true;
@@ -747,13 +864,12 @@ public sealed class EditorControl : UserControl
                 IsReadOnly = _readOnly,
             };
 
-        _hexEditor.Data = data;
-
         // Remove all existing controls and show only the hex editor.
         SuspendLayout();
         Controls.Clear();
         Controls.Add(_hexEditor);
         ResumeLayout(true);
+        return _hexEditor;
     }
 
     /// <summary>The current line ending mode (CRLF, LF, CR).</summary>
@@ -763,6 +879,34 @@ public sealed class EditorControl : UserControl
         set => _lineEnding = value ?? "CRLF";
     }
 
+    /// <summary>
+    /// Counts of the whole document — words, lines, bytes and more — or
+    /// <see langword="null"/> while they are being counted.  Counting starts
+    /// on first use and runs in the background; after that, edits count
+    /// again only the chunks they touch.
+    /// </summary>
+    public TextStatistics? Statistics => GetStatisticsTracker().Total;
+
+    /// <summary>Percentage of the document counted for <see cref="Statistics"/>.</summary>
+    public int StatisticsPercent => GetStatisticsTracker().Percent;
+
+    /// <summary>
+    /// Why <see cref="Statistics"/> stopped counting, such as a file that
+    /// could no longer be read, or <see langword="null"/>.
+    /// </summary>
+    public Exception? StatisticsError => GetStatisticsTracker().Error;
+
+    /// <summary>
+    /// Counts of the selected text, or <see langword="null"/> without a
+    /// selection or while the document is being counted.  Only the ends of
+    /// the selection are read; the rest comes from the document's counts.
+    /// </summary>
+    public TextStatistics? SelectionStatistics =>
+        !_selectionManager.IsColumnMode && _selectionManager.HasSelection
+            ? GetStatisticsTracker().GetRange(_selectionManager.SelectionStart,
+                _selectionManager.SelectionEnd - _selectionManager.SelectionStart)
+            : null;
+
     /// <summary>Length of the current text selection in characters.</summary>
     public int SelectionLength =>
         _selectionManager.IsColumnMode
@@ -927,7 +1071,7 @@ public sealed class EditorControl : UserControl
         return true;
     }
 
-    private void SelectAndScrollTo(long offset, int length)
+    private void SelectAndScrollTo(long offset, long length)
     {
         _selectionManager.ClearSelection();
         // Auto-expand any collapsed region hiding the target.
@@ -961,6 +1105,7 @@ public sealed class EditorControl : UserControl
         _customHighlightMatcher = null;
         _customProfileName = null;
         _customBlockRegions = null;
+        _customBlockTracker = null;
         _surface.CustomHighlightMatcher = null;
         _surface.CustomBlockRegions = null;
 
@@ -987,22 +1132,16 @@ public sealed class EditorControl : UserControl
             _language = string.Empty;
             _surface.Lexer = null;
             _tokenCache.Clear();
+            _jsonIndexer.Document = null;
 
             // Scan block regions if the matcher has block rules and the document is small enough.
             // Block scanning uses efficient batch line reads — allow up to 50 M chars
             // (vs 10 M for language fold detection which uses per-line GetLine calls).
             if (_customHighlightMatcher.HasBlockRules && _document.Length < FoldingMaxFileSize)
             {
-                _customBlockRegions = _customHighlightMatcher.ScanBlocks(
-                    (start, count) =>
-                    {
-                        var data = _document.GetLineRange(start, count);
-                        var texts = new string[data.Length];
-                        for (int i = 0; i < data.Length; i++)
-                            texts[i] = data[i].Text;
-                        return texts;
-                    },
-                    _document.LineCount);
+                _customBlockTracker = _customHighlightMatcher.CreateBlockTracker();
+                _customBlockTracker.Rebuild(GetLineTexts, _document.LineCount);
+                _customBlockRegions = _customBlockTracker.Regions;
                 _surface.CustomBlockRegions = _customBlockRegions;
 
                 // Set foldable block regions.
@@ -1014,6 +1153,7 @@ public sealed class EditorControl : UserControl
             else
             {
                 _customBlockRegions = null;
+                _customBlockTracker = null;
                 _surface.CustomBlockRegions = null;
             }
         }
@@ -1022,6 +1162,7 @@ public sealed class EditorControl : UserControl
             _customHighlightMatcher = null;
             _customProfileName = null;
             _customBlockRegions = null;
+            _customBlockTracker = null;
             _surface.CustomBlockRegions = null;
             _foldingManager.SetRegions([]);
         }
@@ -1154,6 +1295,144 @@ public sealed class EditorControl : UserControl
             GoToLine(lineNum.Value - 1);
     }
 
+    /// <summary>
+    /// Prompts for a JSON path and moves the caret to the value it names.
+    /// Does nothing until the JSON index is available.
+    /// </summary>
+    public void ShowGoToJsonPathDialog()
+    {
+        if (JsonIndex is not { } index) return;
+
+        long? offset = Dialogs.GoToJsonPathDialog.Show(FindForm(),
+            path => index.FindPath(path, _document), JsonPathAtCaret);
+        if (offset.HasValue)
+            SelectAndScrollTo(offset.Value, 0);
+    }
+
+    /// <summary>
+    /// Moves the caret to the bracket matching the one at or just before
+    /// the caret.  JSON documents use the structural index; other documents
+    /// are scanned when they are smaller than <see cref="FoldingMaxFileSize"/>.
+    /// </summary>
+    public void GoToMatchingBracket()
+    {
+        long caret = _caretManager.Offset;
+        foreach (long offset in new[] { caret, caret - 1 })
+        {
+            if (offset < 0 || offset >= _document.Length) continue;
+
+            (long Open, long Close)? match = null;
+            if (JsonIndex is { } index)
+                match = index.FindMatchingBracket(offset);
+            else if (!IsJsonLanguage && _document.Length < FoldingMaxFileSize)
+                match = BracketMatcher.FindMatchingBracket(_document, offset);
+
+            if (match is { } m)
+            {
+                SelectAndScrollTo(offset == m.Open ? m.Close : m.Open, 0);
+                return;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Whether <see cref="GetLogTimeIndexAsync"/> has an index, or knows the
+    /// document has no timestamps, for the document as it is now.
+    /// </summary>
+    public bool IsLogTimeIndexBuilt => _logTimeIndexBuilt;
+
+    /// <summary>
+    /// Returns the timestamp index of a log whose lines start with
+    /// timestamps, or <see langword="null"/> for other documents.  The index
+    /// is built on first use from a snapshot on a background thread, which
+    /// reads the start of up to 65536 lines, and dropped on the next edit.
+    /// </summary>
+    /// <param name="progress">Receives the percentage of the document sampled.</param>
+    /// <param name="cancellationToken">Cancels the build.</param>
+    /// <exception cref="OperationCanceledException">The build was cancelled.</exception>
+    public async Task<LogTimeIndex?> GetLogTimeIndexAsync(IProgress<int>? progress = null,
+        CancellationToken cancellationToken = default)
+    {
+        // An edit during the build makes its result stale; build again.
+        while (!_logTimeIndexBuilt)
+        {
+            int version = _logTimeIndexVersion;
+            PieceTable snapshot = _document.CreateSnapshot();
+            LogTimeIndex? index = await Task.Run(
+                () => LogTimeIndex.Build(snapshot, null, progress, cancellationToken), cancellationToken);
+            if (version != _logTimeIndexVersion) continue;
+
+            _logTimeIndex = index;
+            _logTimeIndexBuilt = true;
+        }
+        return _logTimeIndex;
+    }
+
+    /// <summary>
+    /// Prompts for a time and moves the caret to the first line of the log
+    /// stamped at or after it.  Does nothing until
+    /// <see cref="GetLogTimeIndexAsync"/> has found timestamps.
+    /// </summary>
+    public void ShowGoToTimeDialog()
+    {
+        if (_logTimeIndex is not { } index) return;
+
+        long? ticks = Dialogs.GoToTimeDialog.Show(FindForm(), index.Format, GetTimeAtCaret(index));
+        if (ticks.HasValue)
+            GoToLine(index.FindFirstLineAtOrAfter(_document, ticks.Value));
+    }
+
+    /// <summary>
+    /// Prompts for a range of times and returns the character range of the
+    /// lines stamped within it, or <see langword="null"/> if the user
+    /// cancelled or <see cref="GetLogTimeIndexAsync"/> has not found
+    /// timestamps.
+    /// </summary>
+    public (long Start, long Length)? PromptTimeRange()
+    {
+        if (_logTimeIndex is not { } index) return null;
+
+        var range = Dialogs.GoToTimeDialog.ShowRange(FindForm(), index.Format, GetTimeAtCaret(index));
+        return range is { } r ? index.GetRange(_document, r.From, r.To) : null;
+    }
+
+    /// <summary>
+    /// Prompts for a range of times and selects the lines stamped within it.
+    /// </summary>
+    public void ShowSelectTimeRangeDialog()
+    {
+        if (PromptTimeRange() is { } range)
+            SelectAndScrollTo(range.Start, range.Length);
+    }
+
+    private long GetTimeAtCaret(LogTimeIndex index) =>
+        index.TryGetTimestamp(_document, _caretManager.Line, out long ticks) ? ticks : index.FirstTicks;
+
+    private void InvalidateLogTimeIndex()
+    {
+        _logTimeIndex = null;
+        _logTimeIndexBuilt = false;
+        _logTimeIndexVersion++;
+    }
+
+    private DocumentStatisticsTracker GetStatisticsTracker()
+    {
+        if (_statisticsTracker is null)
+        {
+            _statisticsTracker = new DocumentStatisticsTracker();
+            _statisticsTracker.Changed += OnStatisticsChanged;
+            _statisticsTracker.Document = _document;
+        }
+        _statisticsTracker.Encoding = _encodingManager?.CurrentEncoding ?? new System.Text.UTF8Encoding(false);
+        return _statisticsTracker;
+    }
+
+    private void OnStatisticsChanged(object? sender, EventArgs e)
+    {
+        RecalcFileSizeBytes();
+        StatisticsChanged?.Invoke(this, EventArgs.Empty);
+    }
+
     /// <summary>Increases the font size.</summary>
     public void ZoomIn()
     {
@@ -1307,20 +1586,105 @@ public sealed class EditorControl : UserControl
     /// <summary>Plays the last recorded macro.</summary>
     public async void PlayMacro()
     {
-        if (s_lastRecordedMacro is null || _macroRecorder.IsRecording || _macroPlayer.IsPlaying)
+        if (s_lastRecordedMacro is not { } macro) return;
+        await RunMacroAsync(() => _macroPlayer.PlayAsync(macro, _document, _caretManager.Offset));
+    }
+
+    /// <summary>
+    /// Plays the last recorded macro repeatedly from the caret until it
+    /// reaches the end of the document or stops making progress.
+    /// </summary>
+    public async void PlayMacroToEnd()
+    {
+        if (s_lastRecordedMacro is not { } macro) return;
+        await RunMacroAsync(() => _macroPlayer.PlayToEndAsync(macro, _document, _caretManager.Offset));
+    }
+
+    /// <summary>
+    /// Plays the last recorded macro once on every line matching
+    /// <paramref name="options"/>, treating each line as a document of its
+    /// own.  All changed lines are committed as a single undoable change.
+    /// </summary>
+    public async void PlayMacroOnMatchingLines(SearchOptions options)
+    {
+        ArgumentNullException.ThrowIfNull(options);
+        if (s_lastRecordedMacro is not { } macro) return;
+        await RunMacroAsync(() =>
+            _macroPlayer.PlayOnMatchingLinesAsync(macro, _document, _caretManager.Offset, options));
+    }
+
+    /// <summary>Whether a macro is currently being played back.</summary>
+    public bool IsPlayingMacro => _macroPlayer.IsPlaying;
+
+    /// <summary>
+    /// Cancels the running macro playback, if any; the document is left
+    /// unchanged.
+    /// </summary>
+    public void CancelMacroPlayback() => _macroPlayer.CancelPlayback();
+
+    /// <summary>
+    /// Runs a macro playback in the background and commits its edits as a
+    /// single undoable change.  The editor is read-only while the macro runs
+    /// because playback reads the live document.  Failures are reported
+    /// through <see cref="MacroPlaybackError"/>.
+    /// </summary>
+    private async Task RunMacroAsync(Func<Task<MacroRunResult?>> play)
+    {
+        if (_macroRecorder.IsRecording || _macroPlayer.IsPlaying || _readOnly)
             return;
 
-        _macroPlayer.ActionExecuted += OnMacroActionExecuted;
-        _macroPlayer.PlaybackFinished += OnMacroPlaybackFinished;
+        PieceTable document = _document;
+        ReadOnly = true;
+        MacroRunResult? result;
+        try
+        {
+            result = await play();
+        }
+        catch (Exception ex)
+        {
+            // Failures inside playback are reported by the player; this
+            // catches the ones thrown before it starts.
+            MacroPlaybackError?.Invoke(this, new MacroPlaybackErrorEventArgs(ex));
+            return;
+        }
+        finally
+        {
+            ReadOnly = false;
+        }
+
+        // The edits are offsets into the document that was played against.
+        if (result is null || IsDisposed || !ReferenceEquals(_document, document)) return;
 
         try
         {
-            await _macroPlayer.PlayAsync(s_lastRecordedMacro, _document, _caretManager.Offset);
+            ApplyBulkEdit(result.Edits, "Play Macro");
         }
-        catch
+        catch (ArgumentException ex)
         {
-            // Playback errors are reported via the PlaybackError event.
+            MacroPlaybackError?.Invoke(this, new MacroPlaybackErrorEventArgs(ex));
+            return;
         }
+        _caretManager.MoveTo(Math.Min(result.Caret, _document.Length));
+        _selectionManager.ClearSelection();
+    }
+
+    /// <summary>
+    /// Applies a batch of edits, given against the current document and
+    /// sorted by offset, as a single undoable operation.
+    /// </summary>
+    public void ApplyBulkEdit(IReadOnlyList<TextEdit> edits, string description)
+    {
+        if (edits.Count == 0) return;
+
+        _commandHistory.Execute(new Core.Commands.BulkEditCommand(_document, edits, description));
+
+        _selectionManager.ClearSelection();
+        _tokenCache.Clear();
+        RetokenizeAllVisible();
+        UpdateScrollBars();
+        Invalidate(true);
+        TextChanged?.Invoke(this, EventArgs.Empty);
+        ContentChanged?.Invoke(this, EventArgs.Empty);
     }
 
     /// <summary>Shows the macro manager dialog.</summary>
@@ -1419,33 +1783,6 @@ public sealed class EditorControl : UserControl
             listBox.Items.Add("(No macros recorded)");
     }
 
-    private void OnMacroActionExecuted(object? sender, MacroPlaybackProgressEventArgs e)
-    {
-        if (InvokeRequired)
-        {
-            Invoke(() => OnMacroActionExecuted(sender, e));
-            return;
-        }
-        _caretManager.MoveTo(e.CaretOffset);
-    }
-
-    private void OnMacroPlaybackFinished(object? sender, EventArgs e)
-    {
-        if (InvokeRequired)
-        {
-            Invoke(() => OnMacroPlaybackFinished(sender, e));
-            return;
-        }
-        _macroPlayer.ActionExecuted -= OnMacroActionExecuted;
-        _macroPlayer.PlaybackFinished -= OnMacroPlaybackFinished;
-        _tokenCache.Clear();
-        RetokenizeAllVisible();
-        UpdateScrollBars();
-        Invalidate(true);
-        TextChanged?.Invoke(this, EventArgs.Empty);
-        ContentChanged?.Invoke(this, EventArgs.Empty);
-    }
-
     /// <summary>Replaces the document content with new text, preserving state.</summary>
     public void ReloadContent(string text)
     {
@@ -1570,6 +1907,59 @@ public sealed class EditorControl : UserControl
         ContentChanged?.Invoke(this, EventArgs.Empty);
     }
 
+    /// <summary>
+    /// Replaces the whole document with an edited copy built outside the
+    /// editor, such as the output of a transform too large for the undo
+    /// history.  Unlike <see cref="Document"/>, this is an edit: the
+    /// document is marked changed.  Undo history is cleared.
+    /// </summary>
+    /// <param name="document">The new content.</param>
+    /// <param name="caretOffset">Where to place the caret afterwards.</param>
+    public void ReplaceDocumentContent(PieceTable document, long caretOffset)
+    {
+        Document = document;
+
+        _selectionManager.ClearSelection();
+        _caretManager.MoveTo(Math.Clamp(caretOffset, 0, document.Length));
+
+        UpdateScrollBars();
+        RetokenizeAllVisible();
+        Invalidate(true);
+        TextChanged?.Invoke(this, EventArgs.Empty);
+        ContentChanged?.Invoke(this, EventArgs.Empty);
+    }
+
+    /// <summary>
+    /// Replaces the document with a newer version of the same read-only
+    /// view, such as a filtered view that found more lines, keeping the
+    /// caret line and the scroll position where they were.
+    /// </summary>
+    public void RefreshDocument(PieceTable document)
+    {
+        long caretLine = _caretManager.Line;
+        long firstVisible = _scrollManager.FirstVisibleLine;
+
+        Document = document;
+
+        _caretManager.MoveToLineColumn(caretLine, 0);
+        UpdateScrollBars();
+        _scrollManager.FirstVisibleLine = firstVisible;
+        RetokenizeAllVisible();
+        Invalidate(true);
+    }
+
+    /// <summary>
+    /// Shows text appended to the end of the document without going through
+    /// the editor, such as with <see cref="PieceTable.AppendFromOriginal"/>,
+    /// keeping the caret, the selection and the scroll position.
+    /// </summary>
+    public void RefreshAppended()
+    {
+        UpdateScrollBars();
+        RetokenizeAllVisible();
+        Invalidate(true);
+    }
+
     /// <summary>Copies the selected text to the clipboard.</summary>
     public void Copy()
     {
@@ -2117,9 +2507,28 @@ public sealed class EditorControl : UserControl
         _gutterPanel.Update();
     }
 
+    private bool IsJsonLanguage => string.Equals(_language, "json", StringComparison.OrdinalIgnoreCase);
+
+    /// <summary>Most fold regions taken from the JSON index.</summary>
+    private const int MaxJsonFoldRegions = 100_000;
+
     private void DetectFoldingRegions()
     {
-        if (_language.Length > 0)
+        // JSON folds come from the structural index, which is built in the
+        // background for documents of any size.
+        PieceTable? jsonDocument = IsJsonLanguage ? _document : null;
+        if (!ReferenceEquals(_jsonIndexer.Document, jsonDocument))
+        {
+            _jsonIndexer.Document = jsonDocument;
+            if (jsonDocument is not null)
+                _foldingManager.SetRegions([]);
+        }
+
+        if (IsJsonLanguage)
+        {
+            ApplyJsonFoldRegions();
+        }
+        else if (_language.Length > 0)
         {
             // Language fold detection uses per-line GetLine() — too expensive for large docs.
             if (_document.Length >= FoldingMaxFileSize) return;
@@ -2133,13 +2542,61 @@ public sealed class EditorControl : UserControl
         }
     }
 
+    /// <summary>
+    /// The JSON structure of a snapshot and the fold regions taken from it,
+    /// both built on the indexer's background thread.
+    /// </summary>
+    private sealed record JsonIndexState(JsonStructureIndex Structure, List<FoldRegion> FoldRegions);
+
+    /// <summary>
+    /// Indexes a JSON snapshot and folds every object and array that spans
+    /// several lines, down to the deepest level that keeps the regions
+    /// within <see cref="MaxJsonFoldRegions"/>.
+    /// </summary>
+    private static JsonIndexState BuildJsonIndex(PieceTable snapshot, CancellationToken cancellationToken)
+    {
+        var index = JsonStructureIndex.Build(snapshot, null, cancellationToken);
+
+        var regions = new List<FoldRegion>();
+        foreach (var container in index.EnumerateToDepth(index.GetMaxDepthWithin(MaxJsonFoldRegions)))
+        {
+            if (!container.IsClosed) continue;
+            if ((regions.Count & 0xFFF) == 0)
+                cancellationToken.ThrowIfCancellationRequested();
+            var (startLine, _) = snapshot.OffsetToLineColumn(container.Start);
+            var (endLine, _) = snapshot.OffsetToLineColumn(container.End);
+            if (endLine > startLine)
+                regions.Add(new FoldRegion(startLine, endLine));
+        }
+        return new JsonIndexState(index, regions);
+    }
+
+    /// <summary>
+    /// Applies the fold regions built with the JSON index.  While the index
+    /// is rebuilt after an edit, the previous regions stay in place.
+    /// </summary>
+    private void ApplyJsonFoldRegions()
+    {
+        if (_jsonIndexer.Index is not { } index || !IsJsonLanguage) return;
+        _foldingManager.SetRegions(index.FoldRegions);
+    }
+
+    private void OnJsonIndexChanged(object? sender, EventArgs e)
+    {
+        ApplyJsonFoldRegions();
+        JsonIndexChanged?.Invoke(this, EventArgs.Empty);
+    }
+
     // ────────────────────────────────────────────────────────────────────
     //  Gutter painting
     // ────────────────────────────────────────────────────────────────────
 
     private void OnGutterPaint(object? sender, PaintEventArgs e)
     {
-        _gutterRenderer.UpdateWidth(_document.LineCount, _surface.Font, e.Graphics);
+        long widestNumber = _gutterRenderer.LineNumberMap is { } map
+            ? map(_document.LineCount - 1) + 1
+            : _document.LineCount;
+        _gutterRenderer.UpdateWidth(widestNumber, _surface.Font, e.Graphics);
 
         if (_gutterPanel.Width != _gutterRenderer.Width)
             _gutterPanel.Width = _gutterRenderer.Width;
@@ -2281,6 +2738,11 @@ public sealed class EditorControl : UserControl
             // Keep line numbers responsive during very fast plain-text scrolling.
             _gutterPanel.Update();
         }
+
+        // Warm the lines ahead of the scroll direction in the background.
+        _scrollPrefetcher.Lexer = _lexer;
+        _scrollPrefetcher.HighlightMatcher = _customHighlightMatcher;
+        _scrollPrefetcher.OnScrolled(visDocLine, _surface.VisibleLineCount);
     }
 
     private void EnsureVisibleLineTokenizedInFastMode(long visDocLine)
@@ -2345,7 +2807,7 @@ public sealed class EditorControl : UserControl
             _caretManager.MoveToLineColumn(visLine, 0);
         }
 
-        _surface.InvalidateWrapRowCache();
+        _surface.InvalidateWrapVisibility();
         UpdateScrollBars();
         RetokenizeAllVisible();
         _surface.Invalidate();
@@ -2361,7 +2823,6 @@ public sealed class EditorControl : UserControl
         bool interactiveFastMode = largeDoc || ultraLongCaretLine;
         if (!interactiveFastMode)
             _maxLinePixelWidthCache = 0;
-        _surface.InvalidateWrapRowCache();
         UpdateScrollBars(allowExpensiveWidthScan: !interactiveFastMode);
 
         // Incremental re-lexing from the edit point, then ensure all
@@ -2381,6 +2842,10 @@ public sealed class EditorControl : UserControl
 
     private void OnDocumentTextChanged(object? sender, Bascanka.Core.Buffer.TextChangedEventArgs e)
     {
+        // Bring the wrap layout up to date first; everything below may
+        // query wrap rows.
+        _surface.ApplyTextChange(e);
+
         // Adjust token cache for line insertions/deletions.
         if (e.NewLength > 0 || e.OldLength > 0)
         {
@@ -2393,15 +2858,68 @@ public sealed class EditorControl : UserControl
                 (changeLine, _) = _document.OffsetToLineColumn(e.Offset);
             }
             _tokenCache.Invalidate(changeLine, _document.LineCount - changeLine);
+
+            if (_customBlockTracker is not null)
+                UpdateCustomBlockRegions(changeLine, e.Offset + e.NewLength);
         }
 
-        _surface.InvalidateWrapRowCache();
         _surface.InvalidateUltraWrapLexerCache();
+        InvalidateLogTimeIndex();
 
         // Update live byte-size estimate.
         RecalcFileSizeBytes();
     }
 
+    /// <summary>
+    /// Re-scans custom block regions from the edited line until their state
+    /// reconverges, and refreshes the surface and fold regions if they moved.
+    /// Fold regions are applied after the current change notification has
+    /// reached every subscriber, since folding reshapes the visible lines
+    /// other handlers may still be mapping.
+    /// </summary>
+    private void UpdateCustomBlockRegions(long changeLine, long changeEndOffset)
+    {
+        long lastLine = changeLine;
+        if (changeEndOffset > 0 && changeEndOffset <= _document.Length)
+            (lastLine, _) = _document.OffsetToLineColumn(changeEndOffset);
+
+        if (!_customBlockTracker!.Update(GetLineTexts, _document.LineCount, changeLine, lastLine))
+            return;
+
+        _customBlockRegions = _customBlockTracker.Regions;
+        _surface.CustomBlockRegions = _customBlockRegions;
+
+        if (_customFoldUpdatePending) return;
+        _customFoldUpdatePending = true;
+        if (IsHandleCreated)
+            BeginInvoke(ApplyCustomFoldRegions);
+        else
+            ApplyCustomFoldRegions();    // no message loop yet, nothing to defer to
+    }
+
+    /// <summary>
+    /// Pushes the latest custom block regions to the folding manager.  Runs
+    /// once for any number of edits made before it is dispatched.
+    /// </summary>
+    private void ApplyCustomFoldRegions()
+    {
+        _customFoldUpdatePending = false;
+        if (_customBlockTracker is null || _customBlockRegions is null) return;
+
+        _foldingManager.SetRegions(_customBlockRegions
+            .Where(b => b.Foldable)
+            .Select(b => new FoldRegion(b.StartLine, b.EndLine)));
+    }
+
+    private string[] GetLineTexts(long start, int count)
+    {
+        var data = _document.GetLineRange(start, count);
+        var texts = new string[data.Length];
+        for (int i = 0; i < data.Length; i++)
+            texts[i] = data[i].Text;
+        return texts;
+    }
+
     private void RecalcFileSizeBytes()
     {
         var encoding = _encodingManager?.CurrentEncoding
@@ -2419,6 +2937,18 @@ public sealed class EditorControl : UserControl
             _fileSizeBytes = charCount * 4 + (_encodingManager?.HasBom == true ? 4 : 0);
         else if (encoding.IsSingleByte)
             _fileSizeBytes = charCount + (_encodingManager?.HasBom == true ? encoding.GetPreamble().Length : 0);
+        else if (_statisticsTracker is not null && encoding.CodePage == _statisticsTracker.Encoding.CodePage)
+        {
+            // UTF-8 or other variable-width: exact from the document's
+            // counts, which edits keep current.  While they are being
+            // counted, keep the last known value.
+            if (_statisticsTracker.Total is { } statistics)
+            {
+                long lineBreakBytes = _lineEnding == "CRLF" ? encoding.GetByteCount("\r") * statistics.LineFeeds : 0;
+                _fileSizeBytes = statistics.EncodedBytes + lineBreakBytes
+                    + (_encodingManager?.HasBom == true ? encoding.GetPreamble().Length : 0);
+            }
+        }
         else
         {
             // UTF-8 or other variable-width: compute from text for small files.
@@ -2501,6 +3031,9 @@ public sealed class EditorControl : UserControl
             _hexSplit?.Dispose();
             _contextMenu.Dispose();
             _findPanel?.Dispose();
+            _scrollPrefetcher.Dispose();
+            _jsonIndexer.Dispose();
+            _statisticsTracker?.Dispose();
             _caretManager.Dispose();
             _surface.Dispose();
             _gutterPanel.Dispose();
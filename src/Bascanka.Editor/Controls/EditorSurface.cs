@@ -1,7 +1,8 @@
+using System.Diagnostics.CodeAnalysis;
 using System.Drawing;
-using System.Runtime.CompilerServices;
 using Bascanka.Core.Buffer;
 using Bascanka.Core.Diff;
+using Bascanka.Core.Layout;
 using Bascanka.Core.Search;
 using Bascanka.Core.Syntax;
 using Bascanka.Editor.Highlighting;
@@ -19,48 +20,15 @@ public sealed class EditorSurface : Control
 {
     private const int ExactLongLineThreshold = 1_000_000;
     private const long UltraLongLineThreshold = 1_000_000;
-    private const int BmpRangeLimit = 0x10000;
-    private static readonly uint[] s_bmpDoubleWidthBitmap = BuildBmpDoubleWidthBitmap();
+    private const int WidthMapCacheSize = 16;
+    private const int WidthMapMaxLength = 65_536;
+    private const int ExpandedTabsCacheSize = 128;
+    private const int MaxCachedBrushes = 64;
 
     private static readonly TextFormatFlags DrawFlags =
         TextFormatFlags.NoPadding | TextFormatFlags.NoPrefix |
         TextFormatFlags.PreserveGraphicsClipping | TextFormatFlags.SingleLine;
 
-    private static uint[] BuildBmpDoubleWidthBitmap()
-    {
-        var bitmap = new uint[BmpRangeLimit / 32];
-        static void SetRange(uint[] bits, int start, int end)
-        {
-            int s = Math.Clamp(start, 0, BmpRangeLimit - 1);
-            int e = Math.Clamp(end, 0, BmpRangeLimit - 1);
-            for (int cp = s; cp <= e; cp++)
-                bits[cp >> 5] |= (1u << (cp & 31));
-        }
-
-        // East Asian Fullwidth/Wide BMP ranges (UAX #11 subset used previously).
-        SetRange(bitmap, 0x1100, 0x115F); // Hangul Jamo
-        SetRange(bitmap, 0x2E80, 0x303E); // CJK Radicals/Kangxi/Ideographic/CJK Symbols
-        SetRange(bitmap, 0x3041, 0x33BF); // Hiragana/Katakana/Bopomofo/etc.
-        SetRange(bitmap, 0x3400, 0x4DBF); // CJK Unified Ideographs Extension A
-        SetRange(bitmap, 0x4E00, 0x9FFF); // CJK Unified Ideographs
-        SetRange(bitmap, 0xA000, 0xA4CF); // Yi
-        SetRange(bitmap, 0xAC00, 0xD7AF); // Hangul Syllables
-        SetRange(bitmap, 0xF900, 0xFAFF); // CJK Compatibility Ideographs
-        SetRange(bitmap, 0xFE30, 0xFE6F); // CJK Compatibility Forms/Small Form Variants
-        SetRange(bitmap, 0xFF01, 0xFF60); // Fullwidth forms
-        SetRange(bitmap, 0xFFE0, 0xFFE6); // Fullwidth signs
-
-        return bitmap;
-    }
-
-    [MethodImpl(MethodImplOptions.AggressiveInlining)]
-    private static bool IsBmpDoubleWidth(char c)
-    {
-        int cp = c;
-        if (cp >= BmpRangeLimit) return false;
-        return (s_bmpDoubleWidthBitmap[cp >> 5] & (1u << (cp & 31))) != 0;
-    }
-
     /// <summary>Horizontal padding in pixels between the gutter and text content.</summary>
     private static int TextLeftPadding => EditorControl.DefaultTextLeftPadding;
     private int ViewportX(int localPixelX) => localPixelX + TextLeftPadding - _activeHorizontalPixelShift;
@@ -80,14 +48,40 @@ public sealed class EditorSurface : Control
     private int _suppEmojiCharWidth; // supplementary emoji (e.g. 😀) via Segoe UI Symbol/Emoji
     private Font? _emojiFallbackFont; // Segoe UI Emoji for keycap sequences (GDI can't combine them with monospace fonts)
     private int _lineHeight;
-    private readonly Dictionary<char, string> _singleGlyphCache = [];
-    private readonly Dictionary<int, string> _surrogateGlyphCache = [];
+    // Shaped glyph runs shared by every surface; painting happens on the UI
+    // thread only.  Font keys identify a font at a given set of measured widths.
+    private static readonly GlyphRunCache s_glyphRuns = new();
+    private static readonly Dictionary<(string Name, float Size, GraphicsUnit Unit, CharWidthMetrics Metrics), int> s_glyphFontKeys = [];
+    private Font? _glyphFont;
+    private CharWidthMetrics _glyphFontMetrics;
+    private int _glyphFontKey;
+
+    // Per-frame buffers reused across paints so that a steady-state frame
+    // allocates nothing: line text survives between paints in the snapshot
+    // cache, tab expansions are kept for the lines they were computed for,
+    // and brushes are created once per colour.
+    private readonly LineSnapshotCache _lineSnapshots = new();
+    private long[] _paintDocLines = [];
+    private (string Text, long StartOffset)[] _paintLineData = [];
+    private readonly List<(int Start, int Length)> _paintWrapSegments = [];
+    private readonly List<Token> _paintClippedTokens = [];
+    private readonly List<(int Start, int End, Color Fg)> _paintExpandedSpans = [];
+    private readonly (string Source, string Expanded)?[] _expandedTabs = new (string, string)?[ExpandedTabsCacheSize];
+    private int _expandedTabsNext;
+    private readonly Dictionary<Color, SolidBrush> _brushes = [];
+    private readonly List<SolidBrush> _retiredBrushes = [];
+    private Pen? _caretPen;
     private readonly Dictionary<char, int> _cjkOpeningGlyphWidthCache = [];
+    private CharWidthMetrics _widthMetrics = CharWidthMetrics.Cells;
+    // Small MRU of per-line width prefix sums; paint and hit testing ask for
+    // the same few visible lines many times per frame.
+    private readonly LineWidthMap?[] _widthMaps = new LineWidthMap?[WidthMapCacheSize];
+    private int _widthMapNext;
     private long _ultraWrapLexLine = -1;
     private readonly List<(long StartCol, LexerState State)> _ultraWrapLexCheckpoints = [];
 
-    // Cached total wrap rows to avoid O(document) recomputation on every scroll.
-    private long _totalWrapRowsCache = -1;
+    // Per-line wrap-row cache with O(log n) row ↔ line mapping.
+    private readonly WrapLayoutEngine _wrapLayout;
 
     // References to collaborating managers.
     private CaretManager? _caret;
@@ -112,6 +106,8 @@ public sealed class EditorSurface : Control
 
     public EditorSurface()
     {
+        _wrapLayout = new WrapLayoutEngine(new SurfaceTextMeasurer(this));
+
         SetStyle(
             ControlStyles.AllPaintingInWmPaint |
             ControlStyles.UserPaint |
@@ -140,7 +136,8 @@ public sealed class EditorSurface : Control
         set
         {
             _document = value;
-            _totalWrapRowsCache = -1;
+            _wrapLayout.Document = value;
+            _lineSnapshots.Document = value;
             Invalidate();
         }
     }
@@ -153,7 +150,7 @@ public sealed class EditorSurface : Control
         {
             _editorFont = value ?? throw new ArgumentNullException(nameof(value));
             RecalcFontMetrics();
-            _totalWrapRowsCache = -1;
+            _wrapLayout.InvalidateMeasurements();
             Invalidate();
         }
     }
@@ -165,7 +162,9 @@ public sealed class EditorSurface : Control
         set
         {
             _tabSize = Math.Max(1, value);
-            _totalWrapRowsCache = -1;
+            _wrapLayout.InvalidateMeasurements();
+            Array.Clear(_widthMaps);
+            Array.Clear(_expandedTabs);
             Invalidate();
         }
     }
@@ -178,6 +177,8 @@ public sealed class EditorSurface : Control
         {
             _theme = value ?? throw new ArgumentNullException(nameof(value));
             BackColor = _theme.EditorBackground;
+            _caretPen?.Dispose();
+            _caretPen = null;
             Invalidate();
         }
     }
@@ -189,7 +190,7 @@ public sealed class EditorSurface : Control
         set
         {
             _wordWrap = value;
-            _totalWrapRowsCache = -1;
+            _wrapLayout.InvalidateMeasurements();
             Invalidate();
         }
     }
@@ -225,25 +226,8 @@ public sealed class EditorSurface : Control
     {
         if (!_wordWrap || _document is null || docLine >= _document.LineCount)
             return 1;
-        int wrapPx = WrapPixelWidth;
-        int maxCPx = MaxCharPixelWidth;
-
-        // Fast path: even if every char uses the widest glyph, it still fits.
-        long len = _document.GetLineLength(docLine);
-        if (len * maxCPx <= wrapPx)
-            return 1;
-
-        // Ultra-long line fast path: avoid materializing/scanning full line text.
-        if (len > UltraLongLineThreshold)
-        {
-            int wrapColsFast = Math.Max(1, WrapColumns);
-            long rowsFast = (len + wrapColsFast - 1) / wrapColsFast;
-            return (int)Math.Max(1, Math.Min(int.MaxValue, rowsFast));
-        }
-
-        string lineText = _document.GetLine(docLine);
-        string expanded = ExpandTabs(lineText);
-        return Math.Max(1, CountWrapRowsPixel(expanded, wrapPx));
+        _wrapLayout.WrapWidth = WrapPixelWidth;
+        return _wrapLayout.GetRowCount(docLine);
     }
 
     /// <summary>Width of a single character cell in pixels.</summary>
@@ -271,7 +255,15 @@ public sealed class EditorSurface : Control
     public CaretManager? Caret { get => _caret; set => _caret = value; }
     public SelectionManager? Selection { get => _selection; set => _selection = value; }
     public ScrollManager? Scroll { get => _scroll; set => _scroll = value; }
-    public FoldingManager? Folding { get => _folding; set => _folding = value; }
+    public FoldingManager? Folding
+    {
+        get => _folding;
+        set
+        {
+            _folding = value;
+            _wrapLayout.IsLineVisible = value is null ? null : value.IsLineVisible;
+        }
+    }
     public TokenCache? Tokens { get => _tokenCache; set => _tokenCache = value; }
     public ILexer? Lexer { get => _lexer; set => _lexer = value; }
 
@@ -318,39 +310,27 @@ public sealed class EditorSurface : Control
             return _folding is not null ? _folding.GetVisibleLineCount(lineCount) : lineCount;
         }
 
-        if (_totalWrapRowsCache >= 0)
-            return _totalWrapRowsCache;
-
-        long total = 0;
-        long docLines = _document.LineCount;
-        int wrapPx = WrapPixelWidth;
-        int maxCPx = MaxCharPixelWidth;
-
-        for (long line = 0; line < docLines; line++)
-        {
-            if (_folding is not null && !_folding.IsLineVisible(line))
-                continue;
-
-            // Fast path: even if every char uses the widest glyph, it still fits.
-            long len = _document.GetLineLength(line);
-            if (len * maxCPx <= wrapPx)
-            {
-                total += 1;
-            }
-            else
-            {
-                total += GetWrapRowCount(line);
-            }
-        }
+        _wrapLayout.WrapWidth = WrapPixelWidth;
+        return _wrapLayout.TotalRows;
+    }
 
-        _totalWrapRowsCache = Math.Max(1, total);
-        return _totalWrapRowsCache;
+    /// <summary>
+    /// Re-applies folding visibility to the wrap layout without re-measuring
+    /// any line.  Call after folds are collapsed or expanded.
+    /// </summary>
+    internal void InvalidateWrapVisibility()
+    {
+        _wrapLayout.InvalidateVisibility();
     }
 
-    /// <summary>Invalidates the cached total wrap row count, forcing recomputation on next access.</summary>
-    internal void InvalidateWrapRowCache()
+    /// <summary>
+    /// Forwards a document edit to the wrap layout, which re-measures only
+    /// the touched lines.  Must run before anything reads wrap rows for the
+    /// edited document.
+    /// </summary>
+    internal void ApplyTextChange(Bascanka.Core.Buffer.TextChangedEventArgs e)
     {
-        _totalWrapRowsCache = -1;
+        _wrapLayout.ApplyTextChange(e);
     }
 
     internal void InvalidateUltraWrapLexerCache()
@@ -443,35 +423,9 @@ public sealed class EditorSurface : Control
     {
         if (_document is null) return (0, 0);
 
-        long docLines = _document.LineCount;
-        int wrapPx = WrapPixelWidth;
-        int maxCPx = MaxCharPixelWidth;
-        long accumulated = 0;
-
-        for (long line = 0; line < docLines; line++)
-        {
-            if (_folding is not null && !_folding.IsLineVisible(line))
-                continue;
-
-            long len = _document.GetLineLength(line);
-            int rows = len * maxCPx <= wrapPx ? 1 : GetWrapRowCount(line);
-
-            if (accumulated + rows > wrapRow)
-                return (line, (int)(wrapRow - accumulated));
-
-            accumulated += rows;
-        }
-
-        long lastVisibleLine = Math.Max(0, docLines - 1);
-        if (_folding is not null)
-        {
-            while (lastVisibleLine > 0 && !_folding.IsLineVisible(lastVisibleLine))
-                lastVisibleLine--;
-        }
-
-        long lastLen = _document.GetLineLength(lastVisibleLine);
-        int lastRows = lastLen * maxCPx <= wrapPx ? 1 : GetWrapRowCount(lastVisibleLine);
-        return (lastVisibleLine, Math.Max(0, lastRows - 1));
+        _wrapLayout.WrapWidth = WrapPixelWidth;
+        var (line, rowOffset) = _wrapLayout.RowToLine(wrapRow);
+        return (line, rowOffset);
     }
 
     /// <summary>
@@ -481,29 +435,8 @@ public sealed class EditorSurface : Control
     {
         if (_document is null) return 0;
 
-        long docLines = _document.LineCount;
-        int wrapPx = WrapPixelWidth;
-        int maxCPx = MaxCharPixelWidth;
-        long accumulated = 0;
-
-        for (long line = 0; line < docLines; line++)
-        {
-            if (_folding is not null && !_folding.IsLineVisible(line))
-                continue;
-
-            if (line == docLine)
-            {
-                long lineLenForTarget = _document.GetLineLength(line);
-                int rowsForLine = lineLenForTarget * maxCPx <= wrapPx ? 1 : GetWrapRowCount(line);
-                int clampedWrapRow = Math.Clamp(wrapRowOffset, 0, Math.Max(0, rowsForLine - 1));
-                return accumulated + clampedWrapRow;
-            }
-
-            long len = _document.GetLineLength(line);
-            accumulated += len * maxCPx <= wrapPx ? 1 : GetWrapRowCount(line);
-        }
-
-        return accumulated;
+        _wrapLayout.WrapWidth = WrapPixelWidth;
+        return _wrapLayout.LineToRow(docLine, wrapRowOffset);
     }
 
     // ────────────────────────────────────────────────────────────────────
@@ -555,8 +488,10 @@ public sealed class EditorSurface : Control
         try { _emojiFallbackFont = new Font("Segoe UI Emoji", _editorFont.Size, FontStyle.Regular, _editorFont.Unit); }
         catch { _emojiFallbackFont = null; }
 
-        _singleGlyphCache.Clear();
-        _surrogateGlyphCache.Clear();
+        _widthMetrics = new CharWidthMetrics(
+            _charWidth, _cjkCharWidth, _bmpEmojiCharWidth, _suppCjkCharWidth, _suppEmojiCharWidth);
+        Array.Clear(_widthMaps);
+
         _cjkOpeningGlyphWidthCache.Clear();
     }
 
@@ -568,6 +503,10 @@ public sealed class EditorSurface : Control
     {
         base.OnPaint(e);
 
+        foreach (SolidBrush retired in _retiredBrushes)
+            retired.Dispose();
+        _retiredBrushes.Clear();
+
         Graphics g = e.Graphics;
         g.Clear(_theme.EditorBackground);
 
@@ -586,7 +525,9 @@ public sealed class EditorSurface : Control
         // ── Pass 1: Determine which document lines are visible ──────────
         int entryCount = 0;
         long minDocLine = long.MaxValue, maxDocLine = long.MinValue;
-        var docLines = new long[visibleCount + 1];
+        if (_paintDocLines.Length < visibleCount + 1)
+            _paintDocLines = new long[visibleCount + 1];
+        long[] docLines = _paintDocLines;
 
         // When word-wrap is on, firstVisible is a wrap-row index.
         // Map it to the starting document line and the wrap-row offset within that line.
@@ -598,8 +539,6 @@ public sealed class EditorSurface : Control
 
             // Collect document lines that contribute wrap rows to the visible area.
             int wrapRowsBudget = visibleCount;
-            int wrapPx0 = WrapPixelWidth;
-            int maxCPx0 = MaxCharPixelWidth;
             for (long dl = startDocLine; dl < totalDocLines && wrapRowsBudget > 0; dl++)
             {
                 if (_folding is not null && !_folding.IsLineVisible(dl))
@@ -609,15 +548,13 @@ public sealed class EditorSurface : Control
                 if (dl < minDocLine) minDocLine = dl;
                 if (dl > maxDocLine) maxDocLine = dl;
 
-                // Use GetLineLength for O(1) row count (avoids fetching full line text).
-                long lineLen = _document.GetLineLength(dl);
-                int rows = lineLen * maxCPx0 <= wrapPx0 ? 1
-                    : GetWrapRowCount(dl);
+                // Row counts come from the wrap layout cache (measured once per edit).
+                int rows = GetWrapRowCount(dl);
                 // For the first line, only remaining rows after the offset count.
                 int usedRows = (dl == startDocLine) ? rows - wrapOff : rows;
                 wrapRowsBudget -= usedRows;
 
-                if (entryCount >= docLines.Length) break;
+                if (entryCount >= visibleCount + 1) break;
             }
         }
         else
@@ -646,14 +583,17 @@ public sealed class EditorSurface : Control
         int rangeCount = (int)(maxDocLine - minDocLine + 1);
         bool skipBulkLineRange = rangeCount == 1 &&
             _document.GetLineLength(minDocLine) > UltraLongLineThreshold;
-        var lineData = skipBulkLineRange
-            ? []
-            : _document.GetLineRange(minDocLine, rangeCount);
-
-        // ── Pre-create reusable GDI brushes ─────────────────────────────
-        using var hlBrush = new SolidBrush(_theme.LineHighlight);
-        using var selBrush = new SolidBrush(_theme.SelectionBackground);
-        using var matchBrush = new SolidBrush(_theme.MatchHighlight);
+        if (_paintLineData.Length < rangeCount)
+            _paintLineData = new (string, long)[rangeCount];
+        int lineDataCount = skipBulkLineRange
+            ? 0
+            : _lineSnapshots.GetLines(minDocLine, _paintLineData.AsSpan(0, rangeCount));
+        ReadOnlySpan<(string Text, long StartOffset)> lineData = _paintLineData.AsSpan(0, lineDataCount);
+
+        // ── Cached GDI brushes ──────────────────────────────────────────
+        SolidBrush hlBrush = GetBrush(_theme.LineHighlight);
+        SolidBrush selBrush = GetBrush(_theme.SelectionBackground);
+        SolidBrush matchBrush = GetBrush(_theme.MatchHighlight);
 
         // ── Pass 3: Render each visible line ────────────────────────────
         int visualRow = 0;
@@ -779,14 +719,16 @@ public sealed class EditorSurface : Control
                 }
 
                 string expanded = ExpandTabs(wrapText);
-                var wrapSegments = GetWrapSegmentsPixel(expanded, wrapPx);
-                int rowsForClip = wrapSegments.Length;
+                List<(int Start, int Length)> wrapSegments = _paintWrapSegments;
+                GetWrapSegmentsPixel(expanded, wrapPx, wrapSegments);
+                int rowsForClip = wrapSegments.Count;
                 List<Token>? tokens = _tokenCache?.GetCachedTokens(docLine);
 
                 // Filter and shift tokens into the clipped window.
                 if (tokens is not null && tokens.Count > 0 && wrapText.Length < lineText.Length)
                 {
-                    var adjusted = new List<Token>();
+                    var adjusted = _paintClippedTokens;
+                    adjusted.Clear();
                     int clipEnd = charClipStart + wrapText.Length;
                     foreach (var t in tokens)
                     {
@@ -857,8 +799,7 @@ public sealed class EditorSurface : Control
                     // Block background (lowest priority — painted first per row).
                     if (wrapBlock.HasValue && wrapBlock.Value.Background != Color.Empty)
                     {
-                        using var blockBgBrush = new SolidBrush(wrapBlock.Value.Background);
-                        g.FillRectangle(blockBgBrush, 0, y, ClientSize.Width, _lineHeight);
+                        g.FillRectangle(GetBrush(wrapBlock.Value.Background), 0, y, ClientSize.Width, _lineHeight);
                     }
 
                     // Highlight current line (all wrap rows).
@@ -872,8 +813,7 @@ public sealed class EditorSurface : Control
                     // Custom line background (fills entire visual row).
                     if (wrapCustomResult.HasValue && wrapCustomResult.Value.LineBackground != Color.Empty)
                     {
-                        using var customBgBrush = new SolidBrush(wrapCustomResult.Value.LineBackground);
-                        g.FillRectangle(customBgBrush, 0, y, ClientSize.Width, _lineHeight);
+                        g.FillRectangle(GetBrush(wrapCustomResult.Value.LineBackground), 0, y, ClientSize.Width, _lineHeight);
                     }
 
                     // Paint match-rule span backgrounds BEFORE selection.
@@ -899,7 +839,7 @@ public sealed class EditorSurface : Control
                     // Text rendering.
                     if (segLen > 0)
                     {
-                        string segment = expanded.Substring(segStart, segLen);
+                        ReadOnlySpan<char> segment = expanded.AsSpan(segStart, segLen);
                         if (wrapCustomResult.HasValue)
                             RenderCustomHighlightedWrapSegment(g, wrapText, expanded, segStart, segLen, y, wrapCustomResult.Value);
                         else if (tokens is not null && tokens.Count > 0)
@@ -1033,8 +973,7 @@ public sealed class EditorSurface : Control
                         blockFg = block.Value.Foreground;
                         if (block.Value.Background != Color.Empty)
                         {
-                            using var blockBgBrush = new SolidBrush(block.Value.Background);
-                            g.FillRectangle(blockBgBrush, 0, y, ClientSize.Width, _lineHeight);
+                            g.FillRectangle(GetBrush(block.Value.Background), 0, y, ClientSize.Width, _lineHeight);
                         }
                     }
                 }
@@ -1054,8 +993,7 @@ public sealed class EditorSurface : Control
                     customResult = CustomHighlightMatcher.MatchLine(renderText);
                     if (customResult.Value.LineBackground != Color.Empty)
                     {
-                        using var customBgBrush = new SolidBrush(customResult.Value.LineBackground);
-                        g.FillRectangle(customBgBrush, 0, y, ClientSize.Width, _lineHeight);
+                        g.FillRectangle(GetBrush(customResult.Value.LineBackground), 0, y, ClientSize.Width, _lineHeight);
                     }
                     // Paint match-rule span backgrounds BEFORE selection so
                     // selection is visible on top.
@@ -1097,7 +1035,8 @@ public sealed class EditorSurface : Control
                     // When the line was clipped, filter and shift tokens into the window.
                     if (tokens is not null && tokens.Count > 0 && renderText.Length < lineText.Length)
                     {
-                        var adjusted = new List<Token>();
+                        var adjusted = _paintClippedTokens;
+                        adjusted.Clear();
                         int clipEnd = clipStart + renderText.Length;
                         foreach (var t in tokens)
                         {
@@ -1128,7 +1067,7 @@ public sealed class EditorSurface : Control
                     int foldHChar = PixelToCharIndex(expandedFold, hPixelOffset);
                     int textEndX = ViewportX(DisplayX(expandedFold, foldHChar, expandedFold.Length));
                     string indicator = " ... ";
-                    using var bgBrush = new SolidBrush(Color.FromArgb(EditorControl.DefaultFoldIndicatorOpacity, 128, 128, 128));
+                    SolidBrush bgBrush = GetBrush(Color.FromArgb(EditorControl.DefaultFoldIndicatorOpacity, 128, 128, 128));
                     int indicatorWidth = indicator.Length * _charWidth;
                     g.FillRectangle(bgBrush, textEndX + 4, y, indicatorWidth, _lineHeight);
                     TextRenderer.DrawText(g, indicator, _editorFont,
@@ -1147,6 +1086,31 @@ public sealed class EditorSurface : Control
             RenderCaret(g, firstVisible, hPixelOffset);
     }
 
+    /// <summary>
+    /// Returns a cached solid brush for <paramref name="color"/>.  The cache is
+    /// flushed if a theme or highlight rules produce an unusual number of
+    /// colours; flushed brushes may still be in use by the current frame, so
+    /// they are disposed at the start of the next paint.
+    /// </summary>
+    private SolidBrush GetBrush(Color color)
+    {
+        if (_brushes.TryGetValue(color, out SolidBrush? brush))
+            return brush;
+
+        if (_brushes.Count >= MaxCachedBrushes)
+        {
+            _retiredBrushes.AddRange(_brushes.Values);
+            _brushes.Clear();
+        }
+
+        brush = new SolidBrush(color);
+        _brushes[color] = brush;
+        return brush;
+    }
+
+    private Pen GetCaretPen()
+        => _caretPen ??= new Pen(_theme.CaretColor, 2);
+
     private void RenderPlainLine(Graphics g, string lineText, int y, int hOffset)
     {
         string expanded = ExpandTabs(lineText);
@@ -1154,7 +1118,7 @@ public sealed class EditorSurface : Control
 
         if (startCol >= expanded.Length) return;
 
-        string visible = expanded.Substring(startCol,
+        ReadOnlySpan<char> visible = expanded.AsSpan(startCol,
             Math.Min(MaxVisibleColumns + 1, expanded.Length - startCol));
 
         DrawTextAligned(g, visible, _editorFont, ViewportX(0), y, _theme.EditorForeground);
@@ -1180,7 +1144,7 @@ public sealed class EditorSurface : Control
             int px = DisplayX(expanded, hOffset, srcStart);
             if (px > ClientSize.Width) continue;
 
-            string fragment = expanded.Substring(srcStart,
+            ReadOnlySpan<char> fragment = expanded.AsSpan(srcStart,
                 Math.Min(srcEnd - srcStart, expanded.Length - srcStart));
 
             int x = ViewportX(px);
@@ -1217,7 +1181,7 @@ public sealed class EditorSurface : Control
 
             int x = ViewportX(DisplayX(expanded, hOffset, drawStart));
             int w = DisplayX(expanded, drawStart, drawEnd);
-            using var bgBrush = new SolidBrush(span.Background);
+            SolidBrush bgBrush = GetBrush(span.Background);
             g.FillRectangle(bgBrush, x, y, w, _lineHeight);
         }
     }
@@ -1243,7 +1207,7 @@ public sealed class EditorSurface : Control
 
             int x = ViewportX(DisplayX(expanded, segStart, drawStart));
             int w = DisplayX(expanded, drawStart, drawEnd);
-            using var bgBrush = new SolidBrush(span.Background);
+            SolidBrush bgBrush = GetBrush(span.Background);
             g.FillRectangle(bgBrush, x, y, w, _lineHeight);
         }
     }
@@ -1264,13 +1228,14 @@ public sealed class EditorSurface : Control
 
         if (result.Spans is null or { Count: 0 })
         {
-            string visible = expanded[startCol..endCol];
+            ReadOnlySpan<char> visible = expanded.AsSpan(startCol, endCol - startCol);
             DrawTextAligned(g, visible, _editorFont, ViewportX(0), y, defaultFg);
             return;
         }
 
         // Build expanded-column spans from raw-char spans.
-        var expandedSpans = new List<(int Start, int End, Color Fg)>(result.Spans.Count);
+        var expandedSpans = _paintExpandedSpans;
+        expandedSpans.Clear();
         foreach (var span in result.Spans)
         {
             int expStart = ExpandedColumn(lineText, span.Start);
@@ -1314,13 +1279,14 @@ public sealed class EditorSurface : Control
 
         if (result.Spans is null or { Count: 0 })
         {
-            string segment = expanded.Substring(segStart, segLen);
+            ReadOnlySpan<char> segment = expanded.AsSpan(segStart, segLen);
             DrawTextAligned(g, segment, _editorFont, ViewportX(0), y, defaultFg);
             return;
         }
 
         // Build expanded-column spans clipped to this segment.
-        var expandedSpans = new List<(int Start, int End, Color Fg)>(result.Spans.Count);
+        var expandedSpans = _paintExpandedSpans;
+        expandedSpans.Clear();
         foreach (var span in result.Spans)
         {
             int expStart = ExpandedColumn(lineText, span.Start);
@@ -1335,7 +1301,7 @@ public sealed class EditorSurface : Control
             if (cursor < spanStart && cursor < segEnd)
             {
                 int gapEnd = Math.Min(spanStart, segEnd);
-                string fragment = expanded[cursor..gapEnd];
+                ReadOnlySpan<char> fragment = expanded.AsSpan(cursor, gapEnd - cursor);
                 int x = ViewportX(DisplayX(expanded, segStart, cursor));
                 DrawTextAligned(g, fragment, _editorFont, x, y, defaultFg);
             }
@@ -1344,7 +1310,7 @@ public sealed class EditorSurface : Control
             int drawEnd = Math.Min(spanEnd, segEnd);
             if (drawStart < drawEnd)
             {
-                string fragment = expanded[drawStart..drawEnd];
+                ReadOnlySpan<char> fragment = expanded.AsSpan(drawStart, drawEnd - drawStart);
                 int x = ViewportX(DisplayX(expanded, segStart, drawStart));
                 Color fg = spanFg != Color.Empty ? spanFg : defaultFg;
                 DrawTextAligned(g, fragment, _editorFont, x, y, fg);
@@ -1355,7 +1321,7 @@ public sealed class EditorSurface : Control
 
         if (cursor < segEnd)
         {
-            string fragment = expanded[cursor..segEnd];
+            ReadOnlySpan<char> fragment = expanded.AsSpan(cursor, segEnd - cursor);
             int x = ViewportX(DisplayX(expanded, segStart, cursor));
             DrawTextAligned(g, fragment, _editorFont, x, y, defaultFg);
         }
@@ -1367,7 +1333,7 @@ public sealed class EditorSurface : Control
         if (colStart >= colEnd || colStart >= expanded.Length) return;
 
         int drawEnd = Math.Min(colEnd, expanded.Length);
-        string fragment = expanded[colStart..drawEnd];
+        ReadOnlySpan<char> fragment = expanded.AsSpan(colStart, drawEnd - colStart);
         int x = ViewportX(DisplayX(expanded, hOffset, colStart));
 
         DrawTextAligned(g, fragment, _editorFont, x, y, fgColor);
@@ -1486,7 +1452,7 @@ public sealed class EditorSurface : Control
 
         if (bgColor.HasValue)
         {
-            using var brush = new SolidBrush(bgColor.Value);
+            SolidBrush brush = GetBrush(bgColor.Value);
             g.FillRectangle(brush, 0, y, ClientSize.Width, _lineHeight);
         }
 
@@ -1494,7 +1460,7 @@ public sealed class EditorSurface : Control
         if (marker.CharDiffs is { Count: > 0 })
         {
             string expanded = ExpandTabs(lineText);
-            using var charBrush = new SolidBrush(_theme.DiffModifiedCharBackground);
+            SolidBrush charBrush = GetBrush(_theme.DiffModifiedCharBackground);
             foreach (var range in marker.CharDiffs)
             {
                 int startCol = ExpandedColumn(lineText, Math.Min(range.Start, lineText.Length));
@@ -1536,7 +1502,7 @@ public sealed class EditorSurface : Control
             long colFast = Math.Clamp(_caret.Column, 0, lineLenFast);
             int xFast = (int)(colFast * (long)_charWidth - hPixelOffset) + TextLeftPadding;
             if (xFast < 0 || xFast > ClientSize.Width) return;
-            using var caretPenFast = new Pen(_theme.CaretColor, 2);
+            Pen caretPenFast = GetCaretPen();
             g.DrawLine(caretPenFast, xFast, y, xFast, y + _lineHeight);
             return;
         }
@@ -1552,7 +1518,7 @@ public sealed class EditorSurface : Control
 
         if (x < 0 || x > ClientSize.Width) return;
 
-        using var caretPen = new Pen(_theme.CaretColor, 2);
+        Pen caretPen = GetCaretPen();
         g.DrawLine(caretPen, x, y, x, y + _lineHeight);
     }
 
@@ -1560,6 +1526,20 @@ public sealed class EditorSurface : Control
     //  Pixel-based wrap helpers (CJK-aware)
     // ────────────────────────────────────────────────────────────────────
 
+    /// <summary>
+    /// Feeds the surface's measured font metrics to the <see cref="WrapLayoutEngine"/>
+    /// so cached wrap rows match <see cref="CountWrapRowsPixel"/> exactly.
+    /// </summary>
+    private sealed class SurfaceTextMeasurer(EditorSurface surface) : ITextMeasurer
+    {
+        public int CellWidth => surface._charWidth;
+        public int MaxCharWidth => surface.MaxCharPixelWidth;
+        public int TabSize => surface._tabSize;
+
+        public int MeasureChar(string text, int index)
+            => surface._widthMetrics.GetWidth(CharWidthTable.Classify(text, index));
+    }
+
     /// <summary>
     /// Counts how many wrap rows a tab-expanded line needs using actual
     /// pixel widths for accurate CJK/emoji handling.
@@ -1567,6 +1547,11 @@ public sealed class EditorSurface : Control
     private int CountWrapRowsPixel(string expanded, int maxPixelWidth)
     {
         if (expanded.Length == 0 || maxPixelWidth <= 0) return 1;
+        if (CharWidthTable.IsNarrowWithoutTabs(expanded))
+        {
+            int perRow = NarrowCharsPerRow(maxPixelWidth);
+            return (expanded.Length + perRow - 1) / perRow;
+        }
         int rows = 1;
         int px = 0;
         for (int i = 0; i < expanded.Length; i++)
@@ -1593,10 +1578,32 @@ public sealed class EditorSurface : Control
     /// </summary>
     private (int Start, int Length)[] GetWrapSegmentsPixel(string expanded, int maxPixelWidth)
     {
+        var segments = new List<(int Start, int Length)>();
+        GetWrapSegmentsPixel(expanded, maxPixelWidth, segments);
+        return [.. segments];
+    }
+
+    /// <summary>
+    /// Fills <paramref name="segments"/> with the wrap rows of
+    /// <paramref name="expanded"/>; the paint path passes a reused list.
+    /// </summary>
+    private void GetWrapSegmentsPixel(string expanded, int maxPixelWidth, List<(int Start, int Length)> segments)
+    {
+        segments.Clear();
         if (expanded.Length == 0 || maxPixelWidth <= 0)
-            return [(0, expanded.Length)];
+        {
+            segments.Add((0, expanded.Length));
+            return;
+        }
+
+        if (CharWidthTable.IsNarrowWithoutTabs(expanded))
+        {
+            int perRow = NarrowCharsPerRow(maxPixelWidth);
+            for (int start = 0; start < expanded.Length; start += perRow)
+                segments.Add((start, Math.Min(perRow, expanded.Length - start)));
+            return;
+        }
 
-        var segments = new List<(int Start, int Length)>();
         int rowStart = 0;
         int px = 0;
         for (int i = 0; i < expanded.Length; i++)
@@ -1616,7 +1623,6 @@ public sealed class EditorSurface : Control
             }
         }
         segments.Add((rowStart, expanded.Length - rowStart));
-        return [.. segments];
     }
 
     /// <summary>
@@ -1626,6 +1632,9 @@ public sealed class EditorSurface : Control
     private int GetWrapSegmentStartPixel(string expanded, int maxPixelWidth, int targetRow)
     {
         if (targetRow <= 0 || expanded.Length == 0 || maxPixelWidth <= 0) return 0;
+        if (CharWidthTable.IsNarrowWithoutTabs(expanded))
+            return (int)Math.Min(expanded.Length, (long)targetRow * NarrowCharsPerRow(maxPixelWidth));
+
         int row = 0;
         int px = 0;
         for (int i = 0; i < expanded.Length; i++)
@@ -1647,6 +1656,45 @@ public sealed class EditorSurface : Control
         return expanded.Length;
     }
 
+    /// <summary>
+    /// Number of narrow characters a wrap row holds; a glyph wider than the
+    /// row still gets a row of its own.
+    /// </summary>
+    private int NarrowCharsPerRow(int maxPixelWidth)
+        => Math.Max(1, maxPixelWidth / Math.Max(1, _charWidth));
+
+    /// <summary>
+    /// Returns the cached prefix-sum width map for <paramref name="text"/>,
+    /// building it on a miss.  Lines longer than
+    /// <see cref="WidthMapMaxLength"/> or containing line breaks are not
+    /// mapped, which keeps the cache to a few hundred KB; callers fall back
+    /// to a linear scan.
+    /// </summary>
+    private bool TryGetWidthMap(string text, [NotNullWhen(true)] out LineWidthMap? map)
+    {
+        map = null;
+        if (text.Length > WidthMapMaxLength) return false;
+
+        for (int i = 0; i < _widthMaps.Length; i++)
+        {
+            LineWidthMap? candidate = _widthMaps[i];
+            if (candidate is not null &&
+                (ReferenceEquals(candidate.Text, text) ||
+                 (candidate.Text.Length == text.Length && string.Equals(candidate.Text, text, StringComparison.Ordinal))))
+            {
+                map = candidate;
+                return true;
+            }
+        }
+
+        if (text.AsSpan().IndexOfAny('\r', '\n') >= 0) return false;
+
+        map = LineWidthMap.Build(text, _widthMetrics, _tabSize);
+        _widthMaps[_widthMapNext] = map;
+        _widthMapNext = (_widthMapNext + 1) % _widthMaps.Length;
+        return true;
+    }
+
     // Keep the visual-column versions for backward compat with column selection.
     private static int CountVisualWrapRows(string expanded, int maxVisualCols)
     {
@@ -1741,7 +1789,7 @@ public sealed class EditorSurface : Control
 
             if (drawStart >= drawEnd) continue;
 
-            string fragment = expanded.Substring(drawStart,
+            ReadOnlySpan<char> fragment = expanded.AsSpan(drawStart,
                 Math.Min(drawEnd - drawStart, expanded.Length - drawStart));
             int x = DisplayX(expanded, segStart, drawStart) + TextLeftPadding;
             Color color = _theme.GetTokenColor(token.Type);
@@ -1771,7 +1819,7 @@ public sealed class EditorSurface : Control
     }
 
     private void RenderCaretWrapped(Graphics g, int firstLineWrapOffset,
-        (string Text, long StartOffset)[] lineData, long minDocLine,
+        ReadOnlySpan<(string Text, long StartOffset)> lineData, long minDocLine,
         long[] docLines, int entryCount)
     {
         if (_caret is null || !_caret.IsVisible || _document is null) return;
@@ -1809,7 +1857,7 @@ public sealed class EditorSurface : Control
                     int xFast = colInRowFast * _charWidth + TextLeftPadding;
                     if (yFast >= 0 && yFast < ClientSize.Height)
                     {
-                        using var caretPenFast = new Pen(_theme.CaretColor, 2);
+                        Pen caretPenFast = GetCaretPen();
                         g.DrawLine(caretPenFast, xFast, yFast, xFast, yFast + _lineHeight);
                     }
                     return;
@@ -1829,8 +1877,9 @@ public sealed class EditorSurface : Control
             string lineText = lineData[dataIndex].Text;
 
             string expandedStr = ExpandTabs(lineText);
-            var segments = GetWrapSegmentsPixel(expandedStr, wrapPx);
-            int rowsForLine = segments.Length;
+            List<(int Start, int Length)> segments = _paintWrapSegments;
+            GetWrapSegmentsPixel(expandedStr, wrapPx, segments);
+            int rowsForLine = segments.Count;
             int renderedRows = rowsForLine - startRow;
 
             if (docLine == caretLine)
@@ -1839,10 +1888,10 @@ public sealed class EditorSurface : Control
 
                 // Find which segment contains the caret.
                 int wrapRow = 0;
-                for (int s = 0; s < segments.Length; s++)
+                for (int s = 0; s < segments.Count; s++)
                 {
                     int segEnd = segments[s].Start + segments[s].Length;
-                    if (expandedCol < segEnd || s == segments.Length - 1)
+                    if (expandedCol < segEnd || s == segments.Count - 1)
                     {
                         wrapRow = s;
                         break;
@@ -1856,7 +1905,7 @@ public sealed class EditorSurface : Control
 
                 if (y >= 0 && y <= ClientSize.Height)
                 {
-                    using var caretPen = new Pen(_theme.CaretColor, 2);
+                    Pen caretPen = GetCaretPen();
                     g.DrawLine(caretPen, x, y, x, y + _lineHeight);
                 }
                 return;
@@ -2031,10 +2080,30 @@ public sealed class EditorSurface : Control
     internal int CharPixelWidthPublic(string text, int index, int displayWidth)
         => CharPixelWidth(text, index, displayWidth);
 
+    /// <summary>
+    /// Returns <paramref name="text"/> with tabs expanded to spaces.  Results
+    /// are remembered per source string, so repeated calls for the same line
+    /// during a paint (and across paints, via <see cref="LineSnapshotCache"/>)
+    /// do not rebuild the string.
+    /// </summary>
     private string ExpandTabs(string text)
     {
         if (!text.Contains('\t')) return text;
 
+        for (int i = 0; i < _expandedTabs.Length; i++)
+        {
+            if (_expandedTabs[i] is { } entry && ReferenceEquals(entry.Source, text))
+                return entry.Expanded;
+        }
+
+        string expanded = ExpandTabsUncached(text);
+        _expandedTabs[_expandedTabsNext] = (text, expanded);
+        _expandedTabsNext = (_expandedTabsNext + 1) % _expandedTabs.Length;
+        return expanded;
+    }
+
+    private string ExpandTabsUncached(string text)
+    {
         var sb = new System.Text.StringBuilder(text.Length + 16);
         int col = 0;
         foreach (char c in text)
@@ -2494,6 +2563,14 @@ public sealed class EditorSurface : Control
     {
         if (pixelOffset <= 0) return (0, 0);
 
+        // The raw-line walk advances tab stops by display width, so only
+        // tab-free lines can share the expanded-text width map.
+        if (!lineText.Contains('\t') && TryGetWidthMap(lineText, out LineWidthMap? map))
+        {
+            int index = map.IndexAtOrAfterX(pixelOffset);
+            return (index, map.GetX(index));
+        }
+
         int px = 0;
         int col = 0;
         for (int i = 0; i < lineText.Length; i++)
@@ -2530,6 +2607,9 @@ public sealed class EditorSurface : Control
     /// </summary>
     private int PixelAtRawCharIndex(string lineText, int charIndex)
     {
+        if (!lineText.Contains('\t') && TryGetWidthMap(lineText, out LineWidthMap? map))
+            return map.GetX(Math.Max(0, charIndex));
+
         int px = 0;
         int col = 0;
         int end = Math.Min(charIndex, lineText.Length);
@@ -2565,6 +2645,9 @@ public sealed class EditorSurface : Control
     /// </summary>
     private int DisplayX(string expanded, int from, int to)
     {
+        if (TryGetWidthMap(expanded, out LineWidthMap? map))
+            return to <= from ? 0 : map.GetX(to) - map.GetX(from);
+
         int px = 0;
         int end = Math.Min(to, expanded.Length);
         for (int i = Math.Max(0, from); i < end; i++)
@@ -2583,6 +2666,9 @@ public sealed class EditorSurface : Control
     /// </summary>
     private int CharIndexFromPixel(string expanded, int startChar, int pixelX)
     {
+        if (TryGetWidthMap(expanded, out LineWidthMap? map))
+            return startChar >= expanded.Length ? expanded.Length : map.NearestIndex(startChar, pixelX);
+
         int accumulated = 0;
         for (int i = startChar; i < expanded.Length; i++)
         {
@@ -2603,6 +2689,9 @@ public sealed class EditorSurface : Control
     /// </summary>
     internal int PixelToCharIndex(string expanded, int pixelOffset)
     {
+        if (TryGetWidthMap(expanded, out LineWidthMap? map))
+            return map.IndexAtOrAfterX(pixelOffset);
+
         int acc = 0;
         for (int i = 0; i < expanded.Length; i++)
         {
@@ -2657,6 +2746,9 @@ public sealed class EditorSurface : Control
     /// </summary>
     internal int LinePixelWidth(string lineText)
     {
+        if (CharWidthTable.IsNarrowWithoutTabs(lineText))
+            return lineText.Length * _charWidth;
+
         int px = 0;
         int col = 0;
         for (int i = 0; i < lineText.Length; i++)
@@ -2689,6 +2781,9 @@ public sealed class EditorSurface : Control
     /// </summary>
     internal int ColumnToPixelOffset(string lineText, int column)
     {
+        if (TryGetWidthMap(lineText, out LineWidthMap? map))
+            return map.GetX(Math.Min(column, lineText.Length));
+
         string expanded = ExpandTabs(lineText);
         // Convert document column (char index in raw text) to the
         // corresponding index in the tab-expanded text.
@@ -2703,6 +2798,9 @@ public sealed class EditorSurface : Control
     /// </summary>
     internal static int CharIndexToVisualColumn(string expanded, int charIndex)
     {
+        if (CharWidthTable.IsNarrowWithoutTabs(expanded))
+            return Math.Clamp(charIndex, 0, expanded.Length);
+
         int vc = 0;
         int end = Math.Min(charIndex, expanded.Length);
         for (int i = 0; i < end; i++)
@@ -2741,99 +2839,68 @@ public sealed class EditorSurface : Control
     /// from our per-character calculations on mixed-width lines.
     /// </summary>
     private static bool ContainsWideOrSpecialChars(string text)
-    {
-        for (int i = 0; i < text.Length; i++)
-        {
-            int w = GetCharDisplayWidth(text, i);
-            if (w != 1) return true; // wide CJK/emoji or zero-width marks
-            if (char.IsHighSurrogate(text[i]) && i + 1 < text.Length && char.IsLowSurrogate(text[i + 1]))
-                i++;
-        }
-        return false;
-    }
+        => !GlyphRun.IsSimpleText(text);
 
     /// <summary>
     /// Renders text with per-character positioning when emoji are present,
     /// so each character is placed at exactly its calculated pixel offset.
     /// Falls back to standard <see cref="TextRenderer.DrawText"/> for
-    /// pure ASCII/CJK text where GDI positioning is consistent.
+    /// pure ASCII/CJK text where GDI positioning is consistent.  Shaping is
+    /// shared through <see cref="s_glyphRuns"/>, so repeated tokens and lines
+    /// neither re-classify nor allocate.
     /// </summary>
-    private void DrawTextAligned(Graphics g, string text, Font font, int x, int y, Color color)
+    private void DrawTextAligned(Graphics g, ReadOnlySpan<char> text, Font font, int x, int y, Color color)
     {
-        if (!ContainsWideOrSpecialChars(text))
+        if (text.IsEmpty) return;
+
+        GlyphRun run = s_glyphRuns.GetOrAdd(text, GetGlyphFontKey(font), (int)font.Style, _widthMetrics);
+        if (run.IsSimple)
         {
-            TextRenderer.DrawText(g, text, font, new Point(x, y), color, DrawFlags);
+            TextRenderer.DrawText(g, run.Text, font, new Point(x, y), color, DrawFlags);
             return;
         }
 
-        int px = x;
-        for (int i = 0; i < text.Length; i++)
+        foreach (GlyphCluster cluster in run.Clusters)
         {
-            int w = GetCharDisplayWidth(text, i);
-            if (w == 0) continue;
-            int charPx = CharPixelWidth(text, i, w);
-            int len = (char.IsHighSurrogate(text[i]) && i + 1 < text.Length &&
-                       char.IsLowSurrogate(text[i + 1])) ? 2 : 1;
-
-            // Collect following zero-width characters (skin tone modifiers,
-            // ZWJ, variation selectors) into the same render unit so GDI
-            // can compose them into a single glyph (e.g. 👍 + 🏽 → 👍🏽).
-            while (i + len < text.Length)
-            {
-                int nextW = GetCharDisplayWidth(text, i + len);
-                if (nextW != 0) break;
-                if (char.IsHighSurrogate(text[i + len]) && i + len + 1 < text.Length &&
-                    char.IsLowSurrogate(text[i + len + 1]))
-                    len += 2; // supplementary zero-width char (e.g. skin tone modifier)
-                else
-                    len += 1; // BMP zero-width char (e.g. ZWJ, VS16)
-            }
-
             // Keycap sequences (digit + FE0F + 20E3) need the Segoe UI Emoji font
             // because GDI's per-char font fallback can't compose the combining mark.
-            Font renderFont = (IsKeycapBase(text[i]) && HasKeycapSuffix(text, i + 1) && _emojiFallbackFont is not null)
+            Font renderFont = (CharWidthTable.IsKeycapSequence(run.Text, cluster.Offset) && _emojiFallbackFont is not null)
                 ? _emojiFallbackFont : font;
 
-            string glyph = GetCachedGlyph(text, i, len);
+            int px = x + cluster.X;
             int drawX = px;
-            if (w >= 2 && !_suppressCjkOpeningAlignment && ShouldRightAlignCjkOpening(text, i))
+            if (cluster.IsWide && !_suppressCjkOpeningAlignment && ShouldRightAlignCjkOpening(run.Text, cluster.Offset))
             {
-                int actualWidth = GetCjkOpeningGlyphPixelWidth(g, renderFont, text[i], glyph);
-                if (actualWidth < charPx)
-                    drawX = px + charPx - actualWidth;
+                int actualWidth = GetCjkOpeningGlyphPixelWidth(g, renderFont, run.Text[cluster.Offset], cluster.Text);
+                if (actualWidth < cluster.Advance)
+                    drawX = px + cluster.Advance - actualWidth;
             }
 
-            TextRenderer.DrawText(g, glyph, renderFont, new Point(drawX, y), color, DrawFlags);
-            px += charPx;
+            TextRenderer.DrawText(g, cluster.Text, renderFont, new Point(drawX, y), color, DrawFlags);
         }
     }
 
-    private string GetCachedGlyph(string text, int index, int len)
+    /// <summary>
+    /// Returns the <see cref="GlyphRunCache"/> font key for <paramref name="font"/>
+    /// at the current measured widths.  Surfaces sharing a font and DPI share
+    /// keys, and therefore cached runs.
+    /// </summary>
+    private int GetGlyphFontKey(Font font)
     {
-        if (len == 1)
-        {
-            char c = text[index];
-            if (!_singleGlyphCache.TryGetValue(c, out string? glyph))
-            {
-                glyph = c.ToString();
-                _singleGlyphCache[c] = glyph;
-            }
-            return glyph;
-        }
+        if (ReferenceEquals(font, _glyphFont) && _glyphFontMetrics == _widthMetrics)
+            return _glyphFontKey;
 
-        if (len == 2 && index + 1 < text.Length &&
-            char.IsHighSurrogate(text[index]) && char.IsLowSurrogate(text[index + 1]))
+        var id = (font.Name, font.Size, font.Unit, _widthMetrics);
+        if (!s_glyphFontKeys.TryGetValue(id, out int key))
         {
-            int cp = char.ConvertToUtf32(text[index], text[index + 1]);
-            if (!_surrogateGlyphCache.TryGetValue(cp, out string? glyph))
-            {
-                glyph = char.ConvertFromUtf32(cp);
-                _surrogateGlyphCache[cp] = glyph;
-            }
-            return glyph;
+            key = s_glyphFontKeys.Count + 1;
+            s_glyphFontKeys[id] = key;
         }
 
-        return text.Substring(index, len);
+        _glyphFont = font;
+        _glyphFontMetrics = _widthMetrics;
+        _glyphFontKey = key;
+        return key;
     }
 
     private int GetCjkOpeningGlyphPixelWidth(Graphics g, Font renderFont, char c, string glyph)
@@ -2859,25 +2926,7 @@ public sealed class EditorSurface : Control
     private int CharPixelWidth(string text, int index, int displayWidth)
     {
         if (displayWidth <= 1) return _charWidth;
-
-        char c = text[index];
-        if (char.IsHighSurrogate(c))
-        {
-            // Supplementary plane: distinguish CJK vs emoji for correct fallback font width.
-            if (index + 1 < text.Length && char.IsLowSurrogate(text[index + 1]))
-            {
-                int cp = char.ConvertToUtf32(c, text[index + 1]);
-                if (cp >= 0x1F1E0 && cp <= 0x1FAFF)
-                    return _suppEmojiCharWidth;
-            }
-            return _suppCjkCharWidth;
-        }
-
-        // BMP emoji uses separately measured width (also keycap sequences).
-        if (IsDefaultEmojiPresentation(c) || IsKeycapBase(c))
-            return _bmpEmojiCharWidth;
-
-        return _cjkCharWidth;
+        return _widthMetrics.GetWidth(CharWidthTable.Classify(text, index));
     }
 
     /// <summary>
@@ -2885,196 +2934,14 @@ public sealed class EditorSurface : Control
     /// East Asian fullwidth and wide characters occupy 2 cells;
     /// all others occupy 1 cell.
     /// </summary>
-    internal static int GetCharDisplayWidth(char c)
-    {
-        // Fast path: ASCII + Latin-1 Supplement + Latin Extended-A/B.
-        if (c < 0x0300) return 1;
-
-        // Combining diacritical marks — zero width (accents, Zalgo text, etc.)
-        if (c <= 0x036F) return 0;                               // U+0300–U+036F Combining Diacritical Marks
-        if (c >= 0x0483 && c <= 0x0489) return 0;                // Combining Cyrillic
-
-        // Rest of BMP below CJK/wide ranges.
-        if (c < 0x1100) return 1;
-
-        // Low surrogate of a pair — caller should use the string overload instead.
-        // Return 0 so it doesn't add extra width when encountered alone.
-        if (char.IsLowSurrogate(c)) return 0;
-
-        // Zero-width characters: ZWJ, variation selectors, etc.
-        if (c == '\u200B' || c == '\u200C' || c == '\u200D' ||  // ZWS, ZWNJ, ZWJ
-            c == '\uFE0E' || c == '\uFE0F' ||                   // variation selectors
-            c == '\u2060' || c == '\uFEFF' ||                    // word joiner, BOM
-            c == '\u20E3')                                       // combining enclosing keycap
-            return 0;
-
-        // Combining mark ranges above U+1100.
-        if (c >= 0x1AB0 && c <= 0x1AFF) return 0;               // Combining Diacritical Marks Extended
-        if (c >= 0x1DC0 && c <= 0x1DFF) return 0;               // Combining Diacritical Marks Supplement
-        if (c >= 0x20D0 && c <= 0x20FF) return 0;               // Combining Diacritical Marks for Symbols
-        if (c >= 0xFE20 && c <= 0xFE2F) return 0;               // Combining Half Marks
-        if (IsBmpDoubleWidth(c)) return 2;
-
-        // BMP characters with default emoji presentation (Emoji_Presentation=Yes).
-        // GDI renders these via Segoe UI Symbol at wider-than-_charWidth advance.
-        if (IsDefaultEmojiPresentation(c)) return 2;
-
-        // High surrogate — can't determine width without the low surrogate.
-        // Callers iterating strings should use GetCharDisplayWidth(string, int).
-        if (char.IsHighSurrogate(c)) return 2; // Assume wide (most supplementary CJK/emoji are)
-
-        return 1;
-    }
+    internal static int GetCharDisplayWidth(char c) => CharWidthTable.GetCellWidth(c);
 
     /// <summary>
     /// Returns the display width of the character at <paramref name="index"/>
     /// in <paramref name="text"/>, correctly handling surrogate pairs for
     /// supplementary-plane characters (e.g. CJK Extension B/C/D/E/F/G/H).
     /// </summary>
-    internal static int GetCharDisplayWidth(string text, int index)
-    {
-        char c = text[index];
-
-        // Low surrogate — already counted with its high surrogate.
-        if (char.IsLowSurrogate(c)) return 0;
-
-        if (!char.IsHighSurrogate(c))
-        {
-            // Keycap sequence: digit/# /* + (optional FE0F) + U+20E3 → wide emoji.
-            if (IsKeycapBase(c) && HasKeycapSuffix(text, index + 1))
-                return 2;
-            return GetCharDisplayWidth(c);
-        }
-
-        // Surrogate pair → decode full code point.
-        if (index + 1 < text.Length && char.IsLowSurrogate(text[index + 1]))
-        {
-            int cp = char.ConvertToUtf32(c, text[index + 1]);
-
-            // Second Regional Indicator in a flag pair → zero width.
-            if (cp >= 0x1F1E0 && cp <= 0x1F1FF && IsSecondRegionalIndicator(text, index))
-                return 0;
-
-            return GetCodePointDisplayWidth(cp);
-        }
-
-        // Unpaired high surrogate — treat as narrow.
-        return 1;
-    }
-
-    /// <summary>
-    /// Returns the display width for a full Unicode code point (including supplementary planes).
-    /// </summary>
-    private static int GetCodePointDisplayWidth(int codePoint)
-    {
-        // BMP range — delegate to the char overload.
-        if (codePoint <= 0xFFFF)
-            return GetCharDisplayWidth((char)codePoint);
-
-        // Skin tone modifiers — zero-width, they modify the preceding emoji.
-        if (codePoint >= 0x1F3FB && codePoint <= 0x1F3FF) return 0;
-
-        // Emoji ranges in supplementary planes.
-        if (codePoint >= 0x1F1E0 && codePoint <= 0x1F1FF) return 2; // Regional Indicator Symbols (flags)
-        if (codePoint >= 0x1F300 && codePoint <= 0x1F5FF) return 2; // Misc Symbols and Pictographs
-        if (codePoint >= 0x1F600 && codePoint <= 0x1F64F) return 2; // Emoticons
-        if (codePoint >= 0x1F680 && codePoint <= 0x1F6FF) return 2; // Transport and Map Symbols
-        if (codePoint >= 0x1F900 && codePoint <= 0x1F9FF) return 2; // Supplemental Symbols and Pictographs
-        if (codePoint >= 0x1FA70 && codePoint <= 0x1FAFF) return 2; // Symbols and Pictographs Extended-A
-
-        // Supplementary CJK / East Asian wide ranges (UAX #11).
-        if (codePoint >= 0x20000 && codePoint <= 0x2A6DF) return 2; // CJK Unified Ideographs Extension B
-        if (codePoint >= 0x2A700 && codePoint <= 0x2B73F) return 2; // Extension C
-        if (codePoint >= 0x2B740 && codePoint <= 0x2B81F) return 2; // Extension D
-        if (codePoint >= 0x2B820 && codePoint <= 0x2CEAF) return 2; // Extension E
-        if (codePoint >= 0x2CEB0 && codePoint <= 0x2EBEF) return 2; // Extension F
-        if (codePoint >= 0x2EBF0 && codePoint <= 0x2F7FF) return 2; // Extension I
-        if (codePoint >= 0x2F800 && codePoint <= 0x2FA1F) return 2; // CJK Compat Ideographs Supplement
-        if (codePoint >= 0x30000 && codePoint <= 0x3134F) return 2; // Extension G
-        if (codePoint >= 0x31350 && codePoint <= 0x323AF) return 2; // Extension H
-
-        return 1;
-    }
-
-    /// <summary>
-    /// Returns true if the BMP character has default emoji presentation
-    /// (Emoji_Presentation=Yes in Unicode), meaning it renders as a wide
-    /// emoji glyph even without a trailing U+FE0F variation selector.
-    /// </summary>
-    private static bool IsDefaultEmojiPresentation(char c)
-    {
-        return c switch
-        {
-            '\u231A' or '\u231B' => true,
-            >= '\u23E9' and <= '\u23F3' => true,
-            >= '\u23F8' and <= '\u23FA' => true,
-            >= '\u25FD' and <= '\u25FE' => true,
-            >= '\u2614' and <= '\u2615' => true,
-            >= '\u2648' and <= '\u2653' => true,
-            '\u267F' or '\u2693' or '\u26A1' => true,
-            >= '\u26AA' and <= '\u26AB' => true,
-            >= '\u26BD' and <= '\u26BE' => true,
-            >= '\u26C4' and <= '\u26C5' => true,
-            '\u26CE' or '\u26D4' or '\u26EA' => true,
-            >= '\u26F2' and <= '\u26F3' => true,
-            '\u26F5' or '\u26FA' or '\u26FD' => true,
-            '\u2702' or '\u2705' => true,
-            >= '\u2708' and <= '\u270D' => true,
-            '\u270F' or '\u2712' or '\u2714' or '\u2716' => true,
-            '\u271D' or '\u2721' or '\u2728' => true,
-            >= '\u2733' and <= '\u2734' => true,
-            '\u2744' or '\u2747' or '\u274C' or '\u274E' => true,
-            >= '\u2753' and <= '\u2755' => true,
-            '\u2757' => true,
-            >= '\u2763' and <= '\u2764' => true,
-            >= '\u2795' and <= '\u2797' => true,
-            '\u27A1' or '\u27B0' or '\u27BF' => true,
-            >= '\u2934' and <= '\u2935' => true,
-            >= '\u2B05' and <= '\u2B07' => true,
-            >= '\u2B1B' and <= '\u2B1C' => true,
-            '\u2B50' or '\u2B55' => true,
-            '\u3030' or '\u303D' or '\u3297' or '\u3299' => true,
-            _ => false,
-        };
-    }
-
-    /// <summary>
-    /// Returns true if the Regional Indicator surrogate pair at <paramref name="index"/>
-    /// is the second in a flag pair (e.g. 🇧 in 🇬🇧), by counting consecutive
-    /// preceding Regional Indicators.
-    /// </summary>
-    private static bool IsSecondRegionalIndicator(string text, int index)
-    {
-        int riCount = 0;
-        int j = index;
-        while (j >= 2)
-        {
-            j -= 2;
-            if (!char.IsHighSurrogate(text[j]) || !char.IsLowSurrogate(text[j + 1])) break;
-            int prevCp = char.ConvertToUtf32(text[j], text[j + 1]);
-            if (prevCp < 0x1F1E0 || prevCp > 0x1F1FF) break;
-            riCount++;
-        }
-        return riCount % 2 == 1;
-    }
-
-    /// <summary>
-    /// Returns true if <paramref name="c"/> is a valid keycap base character
-    /// (0-9, #, *) that can form a keycap emoji sequence with U+FE0F + U+20E3.
-    /// </summary>
-    private static bool IsKeycapBase(char c) =>
-        (c >= '0' && c <= '9') || c == '#' || c == '*';
-
-    /// <summary>
-    /// Returns true if the text starting at <paramref name="i"/> contains
-    /// an optional U+FE0F followed by U+20E3 (combining enclosing keycap).
-    /// </summary>
-    private static bool HasKeycapSuffix(string text, int i)
-    {
-        if (i >= text.Length) return false;
-        if (text[i] == '\uFE0F') i++;
-        return i < text.Length && text[i] == '\u20E3';
-    }
+    internal static int GetCharDisplayWidth(string text, int index) => CharWidthTable.GetCellWidth(text, index);
 
     /// <summary>
     /// Right-align opening CJK punctuation only when there is a following
@@ -3119,6 +2986,14 @@ public sealed class EditorSurface : Control
         {
             _editorFont.Dispose();
             _emojiFallbackFont?.Dispose();
+            _lineSnapshots.Document = null;
+            foreach (SolidBrush brush in _brushes.Values)
+                brush.Dispose();
+            foreach (SolidBrush brush in _retiredBrushes)
+                brush.Dispose();
+            _brushes.Clear();
+            _retiredBrushes.Clear();
+            _caretPen?.Dispose();
         }
 
         base.Dispose(disposing);
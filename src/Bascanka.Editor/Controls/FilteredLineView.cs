@@ -0,0 +1,318 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Search;
+
+namespace Bascanka.Editor.Controls;
+
+/// <summary>
+/// Shows the lines of one editor's document that a predicate selects in
+/// another, read-only editor, with the gutter numbering each line as in the
+/// source document.  The lines are read from the source document on demand
+/// through a <see cref="MatchLineIndex"/>; nothing is copied.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The index is built on the thread pool from a snapshot of the source,
+/// and the view grows at its end as batches of matches come in, keeping
+/// its caret, selection and scroll position.  Edits of the source are
+/// collected while a build runs and applied to the index block by block on
+/// the thread pool before the build resumes; the view shows the snapshot
+/// the index was built from until then.  When the source reloads its file
+/// and the old text is still the start of the new one, as with a log that
+/// grew, only the new text is read.
+/// </para>
+/// <para>All members must be called on the UI thread.</para>
+/// </remarks>
+public sealed class FilteredLineView : IDisposable
+{
+    /// <summary>Milliseconds between refreshes of the view during a build.</summary>
+    private const int RefreshInterval = 250;
+
+    private readonly EditorControl _source;
+    private readonly EditorControl _view;
+    private readonly MatchLineIndex _index;
+    private readonly System.Windows.Forms.Timer _refreshTimer;
+    private PieceTable _document;
+    private FilteredTextSource? _shown;
+    private PieceTable? _shownDocument;
+    private int _shownVersion = -1;
+    private CancellationTokenSource? _cts;
+    private Task? _build;
+    private volatile int _percent;
+    private bool _disposed;
+
+    // Work for the next build: the source edits since the last one, merged
+    // into one range, and whether the source document was replaced.
+    private (long Offset, long OldLength, long NewLength)? _pendingEdit;
+    private bool _pendingReload;
+    private bool _restartPending;
+
+    // Counts source document replacements; the view shows the index only
+    // once a build has moved it to the current document, since the old one
+    // is disposed.
+    private int _documentEpoch;
+    private volatile int _indexedEpoch;
+
+    /// <summary>
+    /// Starts filtering the document of <paramref name="source"/> into
+    /// <paramref name="view"/>, which becomes read-only.
+    /// </summary>
+    /// <param name="source">The editor whose lines are shown.</param>
+    /// <param name="view">The editor that shows them.</param>
+    /// <param name="match">Selects the lines to show; called from several threads at once.</param>
+    public FilteredLineView(EditorControl source, EditorControl view, LinePredicate match)
+    {
+        ArgumentNullException.ThrowIfNull(source);
+        ArgumentNullException.ThrowIfNull(view);
+        ArgumentNullException.ThrowIfNull(match);
+
+        _source = source;
+        _view = view;
+        _index = new MatchLineIndex(match);
+        _view.IsReadOnly = true;
+
+        _refreshTimer = new System.Windows.Forms.Timer { Interval = RefreshInterval };
+        _refreshTimer.Tick += (_, _) => Refresh();
+
+        _document = source.Document;
+        _document.TextChanged += OnSourceTextChanged;
+        _source.DocumentChanged += OnSourceDocumentChanged;
+
+        Refresh();
+        StartBuild();
+    }
+
+    /// <summary>The editor whose lines are shown.</summary>
+    public EditorControl Source => _source;
+
+    /// <summary>The editor that shows them.</summary>
+    public EditorControl View => _view;
+
+    /// <summary>Number of matching lines shown.</summary>
+    public long MatchCount => _shown?.MatchCount ?? 0;
+
+    /// <summary>Whether the source is still being read.</summary>
+    public bool IsBuilding => _build is not null;
+
+    /// <summary>Percentage of the source read by the current build.</summary>
+    public int Percent => _build is null ? 100 : _percent;
+
+    /// <summary>
+    /// Why the last build stopped early, such as a predicate that threw.
+    /// When applying an edit failed, the index is emptied.
+    /// </summary>
+    public Exception? Error { get; private set; }
+
+    /// <summary>
+    /// Raised when the view shows a new set of lines, or the build
+    /// progresses or finishes.
+    /// </summary>
+    public event EventHandler? Updated;
+
+    /// <summary>
+    /// Returns the zero-based source line shown as line
+    /// <paramref name="viewLine"/> of the view.
+    /// </summary>
+    public long GetSourceLine(long viewLine) => _shown?.GetDocumentLine(viewLine) ?? 0;
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Building
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Applies the pending edit or reload and indexes the rest of the
+    /// source, on the thread pool.  At most one build runs at a time; a
+    /// build requested meanwhile starts when the running one has stopped.
+    /// </summary>
+    private async void StartBuild()
+    {
+        if (_build is not null)
+        {
+            _restartPending = true;
+            _cts?.Cancel();
+            return;
+        }
+
+        var cts = new CancellationTokenSource();
+        _cts = cts;
+        _percent = 0;
+        _restartPending = false;
+        Error = null;
+        PieceTable snapshot = _document.CreateSnapshot();
+        var edit = _pendingEdit;
+        bool reload = _pendingReload;
+        int epoch = _documentEpoch;
+        _pendingEdit = null;
+        _pendingReload = false;
+        var progress = new Progress<int>(p => _percent = p);
+
+        // Not started with the token: a pending edit must reach the index
+        // even when the build is cancelled at once.
+        Task build = Task.Run(() =>
+        {
+            // A file that grew at the end keeps what was read of it.
+            if (reload)
+                _index.Rebase(snapshot);
+            _indexedEpoch = epoch;
+
+            if (edit is { } e)
+            {
+                try
+                {
+                    _index.Update(snapshot, e.Offset, e.OldLength, e.NewLength);
+                }
+                catch
+                {
+                    // The index no longer matches the document.
+                    _index.Clear();
+                    throw;
+                }
+            }
+
+            _index.IndexRemaining(snapshot, progress, cts.Token);
+        });
+        _build = build;
+        _refreshTimer.Start();
+        try
+        {
+            await build;
+        }
+        catch (OperationCanceledException)
+        {
+        }
+        catch (ObjectDisposedException)
+        {
+            // The source was closed during the build.
+        }
+        catch (Exception ex)
+        {
+            // Such as a RegexMatchTimeoutException from the predicate.
+            Error = ex;
+        }
+        finally
+        {
+            _cts = null;
+            _build = null;
+            cts.Dispose();
+        }
+
+        if (_disposed) return;
+        if (_restartPending)
+        {
+            StartBuild();
+            return;
+        }
+        _refreshTimer.Stop();
+        Refresh();
+        Updated?.Invoke(this, EventArgs.Empty);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Source changes
+    // ────────────────────────────────────────────────────────────────────
+
+    private void OnSourceTextChanged(object? sender, TextChangedEventArgs e)
+    {
+        // Merge with the edits not yet applied into one range of the text
+        // the index describes and its replacement in the document now.
+        if (_pendingEdit is { } p)
+        {
+            long start = Math.Min(p.Offset, e.Offset);
+            long end = Math.Max(p.Offset + p.NewLength, e.Offset + e.OldLength);
+            long oldEnd = p.Offset + p.OldLength + (end - (p.Offset + p.NewLength));
+            long newEnd = end + e.NewLength - e.OldLength;
+            _pendingEdit = (start, oldEnd - start, newEnd - start);
+        }
+        else
+        {
+            _pendingEdit = (e.Offset, e.OldLength, e.NewLength);
+        }
+        StartBuild();
+    }
+
+    private void OnSourceDocumentChanged(object? sender, EventArgs e)
+    {
+        if (ReferenceEquals(_source.Document, _document)) return;
+
+        _document.TextChanged -= OnSourceTextChanged;
+        _document = _source.Document;
+        _document.TextChanged += OnSourceTextChanged;
+
+        // Edits of the old document no longer apply, and the old document
+        // is disposed: show nothing until the index has moved on.
+        _pendingEdit = null;
+        _pendingReload = true;
+        _documentEpoch++;
+        _shown = null;
+        _shownDocument = null;
+        _shownVersion = -1;
+        _view.LineNumberMap = null;
+        _view.RefreshDocument(new PieceTable(string.Empty));
+        StartBuild();
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  View
+    // ────────────────────────────────────────────────────────────────────
+
+    private void Refresh()
+    {
+        int version = _index.Version;
+        if (version != _shownVersion && _indexedEpoch == _documentEpoch)
+        {
+            _shownVersion = version;
+            if (_shown is not null && _shownDocument is not null &&
+                ReferenceEquals(_view.Document, _shownDocument) && _index.TryExtend(_shown))
+            {
+                // Only new matches at the end: the view grows in place.
+                _shownDocument.AppendFromOriginal();
+                _view.RefreshAppended();
+            }
+            else
+            {
+                ShowNewSource();
+            }
+        }
+        if (_build is not null)
+            Updated?.Invoke(this, EventArgs.Empty);
+    }
+
+    /// <summary>
+    /// Replaces the view's document after the index changed other than at
+    /// its end, keeping the selection at the same lines and columns.
+    /// </summary>
+    private void ShowNewSource()
+    {
+        SelectionManager selection = _view.SelectionMgr;
+        PieceTable old = _view.Document;
+        (long Line, long Column)? selectionStart = null, selectionEnd = null;
+        if (selection.HasSelection && !selection.IsColumnMode)
+        {
+            selectionStart = old.OffsetToLineColumn(selection.SelectionStart);
+            selectionEnd = old.OffsetToLineColumn(selection.SelectionEnd);
+        }
+
+        _shown = _index.CreateSource();
+        _shownDocument = new PieceTable(_shown);
+        _view.RefreshDocument(_shownDocument);
+        _view.LineNumberMap = _shown.GetDocumentLine;
+
+        if (selectionStart is { } from && selectionEnd is { } to && from.Line < _shownDocument.LineCount)
+        {
+            long start = _shownDocument.LineColumnToOffset(from.Line, from.Column);
+            long end = _shownDocument.LineColumnToOffset(Math.Min(to.Line, _shownDocument.LineCount - 1), to.Column);
+            if (end > start)
+                _view.Select(start, (int)Math.Min(end - start, int.MaxValue));
+        }
+    }
+
+    public void Dispose()
+    {
+        if (_disposed) return;
+        _disposed = true;
+
+        _document.TextChanged -= OnSourceTextChanged;
+        _source.DocumentChanged -= OnSourceDocumentChanged;
+        _cts?.Cancel();
+        _refreshTimer.Dispose();
+    }
+}
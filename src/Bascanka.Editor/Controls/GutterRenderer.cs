@@ -46,6 +46,12 @@ public sealed class GutterRenderer
     /// <summary>Per-line diff metadata. When set, line numbers are remapped and gutter bars drawn.</summary>
     public DiffLine[]? DiffLineMarkers { get; set; }
 
+    /// <summary>
+    /// Maps a document line to the zero-based line number shown for it, for
+    /// views whose lines stand for lines of another document.
+    /// </summary>
+    public Func<long, long>? LineNumberMap { get; set; }
+
     // ────────────────────────────────────────────────────────────────────
     //  Width calculation
     // ────────────────────────────────────────────────────────────────────
@@ -222,7 +228,7 @@ public sealed class GutterRenderer
             }
             else
             {
-                lineNum = (docLine + 1).ToString();
+                lineNum = ((LineNumberMap?.Invoke(docLine) ?? docLine) + 1).ToString();
             }
 
             Color textColor = isCurrent ? CurrentLineColor : TextColor;
@@ -0,0 +1,272 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Layout;
+using Bascanka.Core.Syntax;
+using Bascanka.Editor.Highlighting;
+
+namespace Bascanka.Editor.Controls;
+
+/// <summary>
+/// Warms the lines the user is about to scroll to: lexes them into the
+/// shared <see cref="TokenCache"/> and runs custom highlight matching, so
+/// that by the time they enter the viewport the paint path finds everything
+/// cached.
+/// </summary>
+/// <remarks>
+/// <para>
+/// A <see cref="ScrollPrefetchPlanner"/> turns scroll positions into a
+/// velocity-sized range ahead of the viewport.  Line text is read on the UI
+/// thread (the piece table is not thread-safe); lexing and regex matching
+/// run on the thread pool.  Lexed tokens are committed back on the UI
+/// thread, and only if the token cache has not been invalidated in the
+/// meantime.
+/// </para>
+/// <para>
+/// Work for the old direction is cancelled as soon as the scroll reverses,
+/// and whenever the document, lexer or highlight profile changes.  Folding
+/// is ignored when sizing the range, so hidden lines may be warmed too.
+/// </para>
+/// <para>All members must be called on the UI thread.</para>
+/// </remarks>
+public sealed class ScrollPrefetcher : IDisposable
+{
+    /// <summary>Most characters read for a single prefetch batch.</summary>
+    public const int MaxBatchChars = 1024 * 1024;
+
+    /// <summary>
+    /// How far back a cached lexer state is searched for; beyond this the
+    /// range is not lexed because its start state is unknown.
+    /// </summary>
+    private const int MaxLexBacktrack = 500;
+
+    // How often the background loop checks for cancellation.
+    private const int CancellationCheckInterval = 64;
+
+    private readonly TokenCache _tokenCache;
+    private readonly ScrollPrefetchPlanner _planner = new();
+    private PieceTable? _document;
+    private ILexer? _lexer;
+    private CustomHighlightMatcher? _highlightMatcher;
+    private CancellationTokenSource? _cts;
+
+    public ScrollPrefetcher(TokenCache tokenCache)
+    {
+        ArgumentNullException.ThrowIfNull(tokenCache);
+        _tokenCache = tokenCache;
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Properties
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>The document lines are read from.  Edits cancel pending work.</summary>
+    public PieceTable? Document
+    {
+        get => _document;
+        set
+        {
+            if (ReferenceEquals(_document, value)) return;
+            if (_document is not null)
+                _document.TextChanged -= OnDocumentTextChanged;
+            _document = value;
+            if (_document is not null)
+                _document.TextChanged += OnDocumentTextChanged;
+            Reset();
+        }
+    }
+
+    /// <summary>The lexer used to warm the token cache, or <c>null</c>.</summary>
+    public ILexer? Lexer
+    {
+        get => _lexer;
+        set
+        {
+            if (ReferenceEquals(_lexer, value)) return;
+            _lexer = value;
+            Cancel();
+        }
+    }
+
+    /// <summary>The custom highlight matcher to warm, or <c>null</c>.</summary>
+    public CustomHighlightMatcher? HighlightMatcher
+    {
+        get => _highlightMatcher;
+        set
+        {
+            if (ReferenceEquals(_highlightMatcher, value)) return;
+            _highlightMatcher = value;
+            Cancel();
+        }
+    }
+
+    /// <summary>Lines whose tokens were committed by a prefetch batch.</summary>
+    public long PrefetchedLines { get; private set; }
+
+    /// <summary>Batches abandoned because of a reversal, edit or reconfiguration.</summary>
+    public long CancelledBatches { get; private set; }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Scheduling
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Records a scroll to <paramref name="firstVisibleLine"/> (a document
+    /// line) and starts warming the lines ahead of it if no batch is
+    /// already running.
+    /// </summary>
+    public void OnScrolled(long firstVisibleLine, int visibleLines)
+    {
+        PieceTable? doc = _document;
+        if (doc is null || (_lexer is null && _highlightMatcher is null)) return;
+
+        if (_planner.Observe(firstVisibleLine, Environment.TickCount64))
+            Cancel();
+
+        // Let the running batch finish; the next scroll tick plans further ahead.
+        if (_cts is not null) return;
+
+        var (start, end) = _planner.GetPrefetchRange(firstVisibleLine, visibleLines, doc.LineCount);
+        if (end <= start) return;
+
+        StartBatch(doc, start, end);
+    }
+
+    /// <summary>Cancels any running batch.</summary>
+    public void Cancel()
+    {
+        if (_cts is null) return;
+        _cts.Cancel();
+        _cts = null;
+    }
+
+    /// <summary>Cancels any running batch and forgets the scroll gesture.</summary>
+    public void Reset()
+    {
+        Cancel();
+        _planner.Reset();
+    }
+
+    public void Dispose()
+    {
+        Document = null;
+        Cancel();
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Internals
+    // ────────────────────────────────────────────────────────────────────
+
+    private void StartBatch(PieceTable doc, long start, long end)
+    {
+        ILexer? lexer = _lexer;
+        CustomHighlightMatcher? matcher = _highlightMatcher;
+
+        // Lexing must start from a known state: the line after the nearest
+        // cached end-state.  Skip it when everything is already cached or
+        // no state is close enough.
+        long lexFrom = -1;
+        LexerState lexState = LexerState.Normal;
+        if (lexer is not null)
+        {
+            long firstUncached = _tokenCache.FindFirstUncached(start, end);
+            if (firstUncached < end && _tokenCache.FindLexStart(firstUncached, MaxLexBacktrack) is { } lexStart)
+                (lexFrom, lexState) = lexStart;
+        }
+
+        if (lexFrom < 0 && matcher is null) return;
+
+        long readFrom = lexFrom >= 0 ? Math.Min(lexFrom, start) : start;
+        long readEnd = ClampToCharBudget(doc, readFrom, end);
+        if (readEnd <= readFrom) return;
+
+        var lines = doc.GetLineRange(readFrom, (int)(readEnd - readFrom));
+        long generation = _tokenCache.Generation;
+
+        var cts = new CancellationTokenSource();
+        _cts = cts;
+        RunBatch(cts, lines, readFrom, lexer, lexFrom, lexState, matcher, start, generation);
+    }
+
+    private static long ClampToCharBudget(PieceTable doc, long startLine, long endLine)
+    {
+        long startOffset = doc.GetLineStartOffset(startLine);
+        while (endLine > startLine + 1)
+        {
+            long endOffset = endLine < doc.LineCount ? doc.GetLineStartOffset(endLine) : doc.Length;
+            if (endOffset - startOffset <= MaxBatchChars) break;
+            endLine = startLine + (endLine - startLine) / 2;
+        }
+
+        // A single oversized line is not worth warming.
+        if (endLine == startLine + 1 && doc.GetLineLength(startLine) > MaxBatchChars)
+            return startLine;
+        return endLine;
+    }
+
+    private async void RunBatch(CancellationTokenSource cts, (string Text, long StartOffset)[] lines,
+        long firstLine, ILexer? lexer, long lexFrom, LexerState lexState,
+        CustomHighlightMatcher? matcher, long matchFrom, long generation)
+    {
+        CancellationToken token = cts.Token;
+        try
+        {
+            var lexed = await Task.Run(() =>
+                Compute(lines, firstLine, lexer, lexFrom, lexState, matcher, matchFrom, token), token);
+
+            // Back on the UI thread: commit only if nothing was invalidated.
+            if (token.IsCancellationRequested || generation != _tokenCache.Generation)
+            {
+                CancelledBatches++;
+                return;
+            }
+
+            for (int i = 0; i < lexed.Count; i++)
+                _tokenCache.SetCache(lexFrom + i, lexed[i].Tokens, lexed[i].EndState);
+            PrefetchedLines += lexed.Count;
+        }
+        catch (OperationCanceledException)
+        {
+            CancelledBatches++;
+        }
+        finally
+        {
+            if (ReferenceEquals(_cts, cts))
+                _cts = null;
+            cts.Dispose();
+        }
+    }
+
+    private static List<(List<Token> Tokens, LexerState EndState)> Compute(
+        (string Text, long StartOffset)[] lines, long firstLine,
+        ILexer? lexer, long lexFrom, LexerState state,
+        CustomHighlightMatcher? matcher, long matchFrom, CancellationToken token)
+    {
+        var lexed = new List<(List<Token>, LexerState)>();
+        if (lexer is not null && lexFrom >= 0)
+        {
+            for (long i = lexFrom - firstLine; i < lines.Length; i++)
+            {
+                if (lexed.Count % CancellationCheckInterval == 0)
+                    token.ThrowIfCancellationRequested();
+
+                var (tokens, endState) = lexer.Tokenize(lines[i].Text, state);
+                lexed.Add((tokens, endState));
+                state = endState;
+            }
+        }
+
+        if (matcher is not null)
+        {
+            // Results land in the matcher's content-keyed line cache.
+            for (long i = matchFrom - firstLine; i < lines.Length; i++)
+            {
+                if (i % CancellationCheckInterval == 0)
+                    token.ThrowIfCancellationRequested();
+                matcher.MatchLine(lines[i].Text);
+            }
+        }
+
+        return lexed;
+    }
+
+    private void OnDocumentTextChanged(object? sender, Bascanka.Core.Buffer.TextChangedEventArgs e) => Cancel();
+}
@@ -0,0 +1,157 @@
+using Bascanka.Editor.Themes;
+
+namespace Bascanka.Editor.Dialogs;
+
+/// <summary>
+/// A dialog that prompts for a JSON path such as <c>$.items[3].name</c>,
+/// resolves it when OK is pressed and stays open with a message when the
+/// path is malformed or names no value.
+/// </summary>
+public class GoToJsonPathDialog : Form
+{
+    // ── Controls ──────────────────────────────────────────────────────
+    private readonly Label _promptLabel;
+    private readonly Label _messageLabel;
+    private readonly TextBox _pathBox;
+    private readonly Button _btnOk;
+    private readonly Button _btnCancel;
+
+    // ── State ─────────────────────────────────────────────────────────
+    private readonly Func<string, long> _resolve;
+    private readonly ITheme _theme;
+
+    /// <summary>
+    /// The offset of the value the entered path names, or
+    /// <see langword="null"/> if the dialog was cancelled.
+    /// </summary>
+    public long? Offset { get; private set; }
+
+    // ── Construction ──────────────────────────────────────────────────
+
+    /// <summary>
+    /// Creates a new Go To JSON Path dialog.
+    /// </summary>
+    /// <param name="resolve">
+    /// Returns the offset of the value at a path, or <c>-1</c> when there is
+    /// none; throws <see cref="FormatException"/> for a malformed path.
+    /// </param>
+    /// <param name="currentPath">The path at the caret, pre-filled in the text box.</param>
+    public GoToJsonPathDialog(Func<string, long> resolve, string currentPath = "$")
+    {
+        ArgumentNullException.ThrowIfNull(resolve);
+        _resolve = resolve;
+        _theme = ThemeManager.Instance.CurrentTheme;
+
+        // ── Form properties ───────────────────────────────────────────
+        Text = "Go To JSON Path";
+        FormBorderStyle = FormBorderStyle.FixedDialog;
+        StartPosition = FormStartPosition.CenterParent;
+        MaximizeBox = false;
+        MinimizeBox = false;
+        ShowInTaskbar = false;
+        ClientSize = new Size(420, 150);
+        KeyPreview = true;
+        BackColor = _theme.EditorBackground;
+        ForeColor = _theme.EditorForeground;
+
+        // ── Prompt label ──────────────────────────────────────────────
+        _promptLabel = new Label
+        {
+            Text = "Path (e.g. $.items[3].name):",
+            Location = new Point(12, 14),
+            AutoSize = true,
+            ForeColor = _theme.EditorForeground,
+            BackColor = _theme.EditorBackground,
+        };
+
+        // ── Path text box ─────────────────────────────────────────────
+        _pathBox = new TextBox
+        {
+            Location = new Point(12, 36),
+            Width = 396,
+            Text = currentPath,
+            BackColor = _theme.FindPanelBackground,
+            ForeColor = _theme.EditorForeground,
+        };
+        _pathBox.SelectAll();
+        _pathBox.TextChanged += (_, _) => _messageLabel!.Text = string.Empty;
+
+        // ── Message label ─────────────────────────────────────────────
+        _messageLabel = new Label
+        {
+            Location = new Point(12, 66),
+            AutoSize = true,
+            ForeColor = Color.IndianRed,
+            BackColor = _theme.EditorBackground,
+        };
+
+        // ── OK button ─────────────────────────────────────────────────
+        _btnOk = new Button
+        {
+            Text = "OK",
+            Location = new Point(252, 112),
+            Size = new Size(75, 28),
+            FlatStyle = FlatStyle.Flat,
+            BackColor = _theme.EditorBackground,
+            ForeColor = _theme.EditorForeground,
+        };
+        _btnOk.FlatAppearance.BorderColor = _theme.TabBorder;
+        _btnOk.Click += OnOkClick;
+
+        // ── Cancel button ─────────────────────────────────────────────
+        _btnCancel = new Button
+        {
+            Text = "Cancel",
+            DialogResult = DialogResult.Cancel,
+            Location = new Point(333, 112),
+            Size = new Size(75, 28),
+            FlatStyle = FlatStyle.Flat,
+            BackColor = _theme.EditorBackground,
+            ForeColor = _theme.EditorForeground,
+        };
+        _btnCancel.FlatAppearance.BorderColor = _theme.TabBorder;
+
+        AcceptButton = _btnOk;
+        CancelButton = _btnCancel;
+
+        // ── Layout ────────────────────────────────────────────────────
+        Controls.AddRange([_promptLabel, _pathBox, _messageLabel, _btnOk, _btnCancel]);
+    }
+
+    // ── OK handling ───────────────────────────────────────────────────
+
+    private void OnOkClick(object? sender, EventArgs e)
+    {
+        long offset;
+        try
+        {
+            offset = _resolve(_pathBox.Text.Trim());
+        }
+        catch (FormatException ex)
+        {
+            _messageLabel.Text = ex.Message;
+            return;
+        }
+
+        if (offset < 0)
+        {
+            _messageLabel.Text = "No value at this path.";
+            return;
+        }
+
+        Offset = offset;
+        DialogResult = DialogResult.OK;
+        Close();
+    }
+
+    /// <summary>
+    /// Shows the dialog modally and returns the offset of the value at the
+    /// entered path, or <see langword="null"/> if the user cancelled.
+    /// </summary>
+    public static long? Show(IWin32Window? owner, Func<string, long> resolve, string currentPath = "$")
+    {
+        using var dialog = new GoToJsonPathDialog(resolve, currentPath);
+        DialogResult result = dialog.ShowDialog(owner);
+        return result == DialogResult.OK ? dialog.Offset : null;
+    }
+}
@@ -0,0 +1,205 @@
+using Bascanka.Core.Navigation;
+using Bascanka.Editor.Themes;
+
+namespace Bascanka.Editor.Dialogs;
+
+/// <summary>
+/// A dialog that prompts for a time, or a range of times, in a log with
+/// timestamps at the start of its lines.  Accepts timestamps as the log
+/// writes them, general dates and bare times of day, and stays open with
+/// a message when the text is not a time.
+/// </summary>
+public class GoToTimeDialog : Form
+{
+    // ── Controls ──────────────────────────────────────────────────────
+    private readonly Label _fromLabel;
+    private readonly TextBox _fromBox;
+    private readonly Label? _toLabel;
+    private readonly TextBox? _toBox;
+    private readonly Label _messageLabel;
+    private readonly Button _btnOk;
+    private readonly Button _btnCancel;
+
+    // ── State ─────────────────────────────────────────────────────────
+    private readonly LogTimestampFormat _format;
+    private readonly long _referenceTicks;
+    private readonly ITheme _theme;
+
+    /// <summary>The entered time, or the start of the entered range.</summary>
+    public long FromTicks { get; private set; }
+
+    /// <summary>The end of the entered range; equal to <see cref="FromTicks"/> for a single time.</summary>
+    public long ToTicks { get; private set; }
+
+    // ── Construction ──────────────────────────────────────────────────
+
+    /// <summary>
+    /// Creates a new Go To Time dialog.
+    /// </summary>
+    /// <param name="format">The timestamp format of the log.</param>
+    /// <param name="referenceTicks">
+    /// The timestamp at the caret: pre-filled in the text boxes, and the
+    /// date of a bare time of day.
+    /// </param>
+    /// <param name="range">Prompts for a start and an end instead of a single time.</param>
+    public GoToTimeDialog(LogTimestampFormat format, long referenceTicks, bool range = false)
+    {
+        ArgumentNullException.ThrowIfNull(format);
+        _format = format;
+        _referenceTicks = referenceTicks;
+        _theme = ThemeManager.Instance.CurrentTheme;
+        int top = range ? 50 : 0;
+
+        // ── Form properties ───────────────────────────────────────────
+        Text = range ? "Time Range" : "Go To Time";
+        FormBorderStyle = FormBorderStyle.FixedDialog;
+        StartPosition = FormStartPosition.CenterParent;
+        MaximizeBox = false;
+        MinimizeBox = false;
+        ShowInTaskbar = false;
+        ClientSize = new Size(420, 150 + top);
+        KeyPreview = true;
+        BackColor = _theme.EditorBackground;
+        ForeColor = _theme.EditorForeground;
+
+        string initial = format.Format(referenceTicks);
+
+        // ── From label and text box ───────────────────────────────────
+        _fromLabel = new Label
+        {
+            Text = (range ? "From" : "Time") + $" ({format.Pattern}, or a time of day):",
+            Location = new Point(12, 14),
+            AutoSize = true,
+            ForeColor = _theme.EditorForeground,
+            BackColor = _theme.EditorBackground,
+        };
+
+        _fromBox = CreateTextBox(36, initial);
+
+        // ── To label and text box (range only) ────────────────────────
+        if (range)
+        {
+            _toLabel = new Label
+            {
+                Text = "To:",
+                Location = new Point(12, 64),
+                AutoSize = true,
+                ForeColor = _theme.EditorForeground,
+                BackColor = _theme.EditorBackground,
+            };
+            _toBox = CreateTextBox(86, initial);
+        }
+
+        // ── Message label ─────────────────────────────────────────────
+        _messageLabel = new Label
+        {
+            Location = new Point(12, 66 + top),
+            AutoSize = true,
+            ForeColor = Color.IndianRed,
+            BackColor = _theme.EditorBackground,
+        };
+
+        // ── OK button ─────────────────────────────────────────────────
+        _btnOk = new Button
+        {
+            Text = "OK",
+            Location = new Point(252, 112 + top),
+            Size = new Size(75, 28),
+            FlatStyle = FlatStyle.Flat,
+            BackColor = _theme.EditorBackground,
+            ForeColor = _theme.EditorForeground,
+        };
+        _btnOk.FlatAppearance.BorderColor = _theme.TabBorder;
+        _btnOk.Click += OnOkClick;
+
+        // ── Cancel button ─────────────────────────────────────────────
+        _btnCancel = new Button
+        {
+            Text = "Cancel",
+            DialogResult = DialogResult.Cancel,
+            Location = new Point(333, 112 + top),
+            Size = new Size(75, 28),
+            FlatStyle = FlatStyle.Flat,
+            BackColor = _theme.EditorBackground,
+            ForeColor = _theme.EditorForeground,
+        };
+        _btnCancel.FlatAppearance.BorderColor = _theme.TabBorder;
+
+        AcceptButton = _btnOk;
+        CancelButton = _btnCancel;
+
+        // ── Layout ────────────────────────────────────────────────────
+        Controls.AddRange([_fromLabel, _fromBox, _messageLabel, _btnOk, _btnCancel]);
+        if (_toLabel is not null && _toBox is not null)
+            Controls.AddRange([_toLabel, _toBox]);
+    }
+
+    private TextBox CreateTextBox(int y, string text)
+    {
+        var box = new TextBox
+        {
+            Location = new Point(12, y),
+            Width = 396,
+            Text = text,
+            BackColor = _theme.FindPanelBackground,
+            ForeColor = _theme.EditorForeground,
+        };
+        box.SelectAll();
+        box.TextChanged += (_, _) => _messageLabel.Text = string.Empty;
+        return box;
+    }
+
+    // ── OK handling ───────────────────────────────────────────────────
+
+    private void OnOkClick(object? sender, EventArgs e)
+    {
+        if (!_format.TryParseInput(_fromBox.Text, _referenceTicks, out long from))
+        {
+            _messageLabel.Text = "Not a time: " + _fromBox.Text.Trim();
+            return;
+        }
+
+        long to = from;
+        if (_toBox is not null)
+        {
+            if (!_format.TryParseInputEnd(_toBox.Text, _referenceTicks, out to))
+            {
+                _messageLabel.Text = "Not a time: " + _toBox.Text.Trim();
+                return;
+            }
+            if (to < from)
+            {
+                _messageLabel.Text = "The end of the range is before its start.";
+                return;
+            }
+        }
+
+        FromTicks = from;
+        ToTicks = to;
+        DialogResult = DialogResult.OK;
+        Close();
+    }
+
+    /// <summary>
+    /// Shows the dialog modally and returns the entered time, or
+    /// <see langword="null"/> if the user cancelled.
+    /// </summary>
+    public static long? Show(IWin32Window? owner, LogTimestampFormat format, long referenceTicks)
+    {
+        using var dialog = new GoToTimeDialog(format, referenceTicks);
+        DialogResult result = dialog.ShowDialog(owner);
+        return result == DialogResult.OK ? dialog.FromTicks : null;
+    }
+
+    /// <summary>
+    /// Shows the dialog modally and returns the entered range, or
+    /// <see langword="null"/> if the user cancelled.
+    /// </summary>
+    public static (long From, long To)? ShowRange(IWin32Window? owner, LogTimestampFormat format,
+        long referenceTicks)
+    {
+        using var dialog = new GoToTimeDialog(format, referenceTicks, range: true);
+        DialogResult result = dialog.ShowDialog(owner);
+        return result == DialogResult.OK ? (dialog.FromTicks, dialog.ToTicks) : null;
+    }
+}
@@ -1,7 +1,10 @@
 using System.Drawing;
-using System.IO.MemoryMappedFiles;
 using System.Text;
 using System.Windows.Forms;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Commands;
+using Bascanka.Core.IO;
+using Bascanka.Core.Search;
 using Bascanka.Editor.Themes;
 
 namespace Bascanka.Editor.HexEditor;
@@ -11,21 +14,36 @@ namespace Bascanka.Editor.HexEditor;
 /// </summary>
 public sealed class HexDataChangedEventArgs : EventArgs
 {
-    /// <summary>The offset of the changed byte.</summary>
+    /// <summary>The offset of the changed byte (or range).</summary>
     public long Offset { get; }
 
-    /// <summary>The old byte value.</summary>
-    public byte OldValue { get; }
+    /// <summary>The old byte value, for single-byte overwrites.</summary>
+    public byte OldValue { get; private init; }
 
-    /// <summary>The new byte value.</summary>
-    public byte NewValue { get; }
+    /// <summary>The new byte value, for single-byte overwrites.</summary>
+    public byte NewValue { get; private init; }
 
-    public HexDataChangedEventArgs(long offset, byte oldValue, byte newValue)
+    /// <summary>Number of bytes removed at <see cref="Offset"/>.</summary>
+    public long RemovedLength { get; }
+
+    /// <summary>Number of bytes inserted at <see cref="Offset"/>.</summary>
+    public long InsertedLength { get; }
+
+    /// <summary>Describes <paramref name="removedLength"/> bytes replaced by <paramref name="insertedLength"/> bytes.</summary>
+    public HexDataChangedEventArgs(long offset, long removedLength, long insertedLength)
     {
         Offset = offset;
-        OldValue = oldValue;
-        NewValue = newValue;
+        RemovedLength = removedLength;
+        InsertedLength = insertedLength;
     }
+
+    /// <summary>
+    /// Describes a single byte overwritten in place.  A factory rather than
+    /// a constructor overload, because integer arguments would otherwise
+    /// bind to whichever of (byte, byte) or (long, long) fits.
+    /// </summary>
+    public static HexDataChangedEventArgs Overwrite(long offset, byte oldValue, byte newValue) =>
+        new(offset, 1, 1) { OldValue = oldValue, NewValue = newValue };
 }
 
 /// <summary>
@@ -40,6 +58,11 @@ public sealed class HexEditorControl : UserControl
 
     private const int DefaultBytesPerRow = 16;
 
+    // Largest value handed to the scroll bar; larger row counts are scaled.
+    private const int MaxScrollBarValue = int.MaxValue / 2;
+
+    // Bytes shown by the data inspector.
+    private const int InspectorWindow = 16;
 
     // ── Child controls ──────────────────────────────────────────────────
 
@@ -50,10 +73,14 @@ public sealed class HexEditorControl : UserControl
 
     // ── State ───────────────────────────────────────────────────────────
 
-    private byte[] _data = [];
-    private readonly List<HexUndoEntry> _undoStack = [];
-    private readonly List<HexUndoEntry> _redoStack = [];
+    private BytePieceTable _buffer = new([]);
+    private long _scrollScale = 1;  // rows per scroll-bar unit
+    private readonly CommandHistory _history = new();
     private bool _isReadOnly;
+    // Set when a save over the mapped file failed and the buffer now maps
+    // the complete copy left in _recoveryPath; its edits are still unsaved.
+    private string? _recoveryPath;
+    private bool _hasUnsavedRecovery;
     private ITheme _theme;
 
     // ── Events ──────────────────────────────────────────────────────────
@@ -129,21 +156,24 @@ public sealed class HexEditorControl : UserControl
 
     /// <summary>
     /// The raw data being edited. Setting this replaces the entire buffer.
+    /// Getting it copies the whole document into a new array, so prefer
+    /// <see cref="Buffer"/> for anything that may be large.
     /// </summary>
     public byte[] Data
     {
-        get => _data;
-        set
-        {
-            _data = value ?? [];
-            _undoStack.Clear();
-            _redoStack.Clear();
-            _renderer.Data = _data;
-            UpdateScrollBar();
-            UpdateInspector();
-        }
+        get => _buffer.ToArray();
+        set => SetBuffer(new BytePieceTable(value ?? []));
     }
 
+    /// <summary>
+    /// The byte piece table holding the document.  Edits made through this
+    /// control are applied to it; it is disposed when replaced.
+    /// </summary>
+    public BytePieceTable Buffer => _buffer;
+
+    /// <summary>Total number of bytes in the document.</summary>
+    public long Length => _buffer.Length;
+
     /// <summary>Number of bytes displayed per row.</summary>
     public int BytesPerRow
     {
@@ -194,62 +224,181 @@ public sealed class HexEditorControl : UserControl
     }
 
     /// <summary>Whether an undo operation is available.</summary>
-    public bool CanUndo => _undoStack.Count > 0;
+    public bool CanUndo => _history.CanUndo;
 
     /// <summary>Whether a redo operation is available.</summary>
-    public bool CanRedo => _redoStack.Count > 0;
+    public bool CanRedo => _history.CanRedo;
+
+    /// <summary>Whether the document differs from when it was loaded or last saved.</summary>
+    public bool IsModified => _history.IsDirty || _hasUnsavedRecovery;
 
     // ── File loading ────────────────────────────────────────────────────
 
     /// <summary>
-    /// Loads a file into the hex editor. For large files, uses a
-    /// <see cref="MemoryMappedFile"/> to avoid allocating the entire file
-    /// into managed memory at once.
+    /// Loads a file into the hex editor.  The file is memory-mapped rather
+    /// than read, so opening is instant and only the rows on screen are
+    /// paged in, whatever the file size.  The file stays open (shared for
+    /// reading) until another document is loaded or the control is disposed.
     /// </summary>
     /// <param name="path">The file path to load.</param>
     public void LoadFile(string path)
     {
         ArgumentException.ThrowIfNullOrWhiteSpace(path);
 
-        FileInfo fi = new(path);
-        if (!fi.Exists)
+        if (!File.Exists(path))
             throw new FileNotFoundException("File not found.", path);
 
-        long fileSize = fi.Length;
-        if (fileSize == 0)
+        SetBuffer(BytePieceTable.FromFile(path));
+    }
+
+    /// <summary>
+    /// Loads a byte array directly into the hex editor.
+    /// </summary>
+    public void LoadBytes(byte[] data)
+    {
+        Data = data;
+    }
+
+    /// <summary>
+    /// Writes the document to <paramref name="path"/>.  Unmodified ranges
+    /// are streamed from the original file, so saving a large file with a
+    /// few edits costs one sequential copy and no extra memory.
+    /// </summary>
+    /// <remarks>
+    /// The document is written to a temporary file first.  When saving over
+    /// the file that is currently mapped, the mapping is released, the
+    /// temporary file replaces the original and the saved file is mapped
+    /// again; undo history is cleared in that case.  If the replacement
+    /// fails, the editor maps the temporary file instead, so no edit is
+    /// lost, and the document stays modified.
+    /// </remarks>
+    public void SaveFile(string path)
+    {
+        ArgumentException.ThrowIfNullOrWhiteSpace(path);
+
+        string fullPath = Path.GetFullPath(path);
+        // Unique, because after a failed save the previous temporary file
+        // may be the one the buffer maps.
+        string tempPath = $"{fullPath}.{Guid.NewGuid():N}.tmp";
+        try
         {
-            Data = [];
-            return;
+            using var stream = new FileStream(tempPath, FileMode.CreateNew, FileAccess.Write,
+                FileShare.None, 1024 * 1024);
+            _buffer.WriteTo(stream);
         }
+        catch
+        {
+            TryDeleteFile(tempPath);
+            throw;
+        }
+
+        bool overwritingSource = _buffer.Original is MemoryMappedByteSource mapped &&
+            string.Equals(Path.GetFullPath(mapped.FilePath), fullPath, StringComparison.OrdinalIgnoreCase);
 
-        // For files larger than 64 MB, use memory-mapped I/O.
-        const long MmapThreshold = 64 * 1024 * 1024;
+        if (!overwritingSource)
+        {
+            try
+            {
+                File.Move(tempPath, fullPath, overwrite: true);
+            }
+            catch
+            {
+                TryDeleteFile(tempPath);
+                throw;
+            }
+            _history.SetSavePoint();
+            _hasUnsavedRecovery = false;
+            return;
+        }
 
-        if (fileSize <= MmapThreshold)
+        // The mapping of the original has to be released before it can be
+        // replaced, which discards the buffer.  The temporary file holds the
+        // whole document, so it is the fallback if the move fails.
+        long selected = _renderer.SelectedOffset;
+        long scroll = _renderer.ScrollOffset;
+        SetBuffer(new BytePieceTable([]));
+        try
         {
-            Data = File.ReadAllBytes(path);
+            File.Move(tempPath, fullPath, overwrite: true);
+            LoadFile(fullPath);
         }
-        else
+        catch
         {
-            // Memory-mapped load: read the entire file into a byte array
-            // using a memory-mapped view for efficient sequential access.
-            byte[] buffer = new byte[fileSize];
+            // Map whichever file now holds the document.  If that fails too,
+            // the buffer stays empty and the save's own exception is the
+            // one reported.
+            try
+            {
+                if (File.Exists(tempPath))
+                {
+                    SetBuffer(BytePieceTable.FromFile(tempPath));
+                    _recoveryPath = tempPath;
+                    _hasUnsavedRecovery = true;
+                }
+                else
+                {
+                    // The move went through but mapping the result failed.
+                    LoadFile(fullPath);
+                }
+                _renderer.ScrollOffset = scroll;
+                GoToOffset(selected);
+            }
+            catch (IOException)
+            {
+            }
+            catch (UnauthorizedAccessException)
+            {
+            }
+            throw;
+        }
+        _renderer.ScrollOffset = scroll;
+        GoToOffset(selected);
+    }
 
-            using var mmf = MemoryMappedFile.CreateFromFile(path, FileMode.Open,
-                null, 0, MemoryMappedFileAccess.Read);
-            using var accessor = mmf.CreateViewAccessor(0, fileSize, MemoryMappedFileAccess.Read);
-            accessor.ReadArray(0, buffer, 0, (int)fileSize);
+    private static void TryDeleteFile(string path)
+    {
+        try
+        {
+            File.Delete(path);
+        }
+        catch (IOException)
+        {
+        }
+        catch (UnauthorizedAccessException)
+        {
+        }
+    }
 
-            Data = buffer;
+    private void SetBuffer(BytePieceTable buffer)
+    {
+        BytePieceTable old = _buffer;
+        _buffer = buffer;
+        _history.Clear();
+        _history.SetSavePoint();
+        _renderer.Buffer = _buffer;
+        if (!ReferenceEquals(old, buffer))
+        {
+            old.Dispose();
+            ReleaseRecoveryFile();
         }
+        UpdateScrollBar();
+        UpdateInspector();
     }
 
     /// <summary>
-    /// Loads a byte array directly into the hex editor.
+    /// Deletes the temporary file left by a failed save once no buffer maps
+    /// it any more.
     /// </summary>
-    public void LoadBytes(byte[] data)
+    private void ReleaseRecoveryFile()
     {
-        Data = data;
+        if (_recoveryPath is null) return;
+        if (_buffer.Original is MemoryMappedByteSource mapped &&
+            string.Equals(mapped.FilePath, _recoveryPath, StringComparison.OrdinalIgnoreCase))
+            return;
+
+        TryDeleteFile(_recoveryPath);
+        _recoveryPath = null;
+        _hasUnsavedRecovery = false;
     }
 
     // ── Edit operations ─────────────────────────────────────────────────
@@ -261,20 +410,13 @@ public sealed class HexEditorControl : UserControl
     public void OverwriteByte(long offset, byte newValue)
     {
         if (_isReadOnly) return;
-        if (offset < 0 || offset >= _data.Length) return;
+        if (offset < 0 || offset >= _buffer.Length) return;
 
-        byte oldValue = _data[offset];
+        byte oldValue = _buffer[offset];
         if (oldValue == newValue) return;
 
-        _data[offset] = newValue;
-        _renderer.ModifiedOffsets.Add(offset);
-
-        _undoStack.Add(new HexUndoEntry(HexUndoType.Overwrite, offset, oldValue, newValue));
-        _redoStack.Clear();
-
-        _renderer.Invalidate();
-        DataChanged?.Invoke(this, new HexDataChangedEventArgs(offset, oldValue, newValue));
-        UpdateInspector();
+        Execute(new ByteReplaceCommand(_buffer, offset, 1, [newValue]), updateScrollBar: false);
+        DataChanged?.Invoke(this, HexDataChangedEventArgs.Overwrite(offset, oldValue, newValue));
     }
 
     /// <summary>
@@ -283,25 +425,10 @@ public sealed class HexEditorControl : UserControl
     public void InsertByte(long offset, byte value)
     {
         if (_isReadOnly) return;
-        offset = Math.Clamp(offset, 0, _data.Length);
-
-        var newData = new byte[_data.Length + 1];
-        if (offset > 0)
-            Array.Copy(_data, 0, newData, 0, (int)offset);
-        newData[offset] = value;
-        if (offset < _data.Length)
-            Array.Copy(_data, (int)offset, newData, (int)(offset + 1), (int)(_data.Length - offset));
-
-        _data = newData;
-        _renderer.Data = _data;
-        _renderer.ModifiedOffsets.Add(offset);
+        offset = Math.Clamp(offset, 0, _buffer.Length);
 
-        _undoStack.Add(new HexUndoEntry(HexUndoType.Insert, offset, 0, value));
-        _redoStack.Clear();
-
-        UpdateScrollBar();
-        DataChanged?.Invoke(this, new HexDataChangedEventArgs(offset, 0, value));
-        UpdateInspector();
+        Execute(new ByteReplaceCommand(_buffer, offset, 0, [value]), updateScrollBar: true);
+        DataChanged?.Invoke(this, new HexDataChangedEventArgs(offset, 0L, 1L));
     }
 
     /// <summary>
@@ -310,26 +437,62 @@ public sealed class HexEditorControl : UserControl
     public void DeleteByte(long offset)
     {
         if (_isReadOnly) return;
-        if (offset < 0 || offset >= _data.Length) return;
+        if (offset < 0 || offset >= _buffer.Length) return;
 
-        byte oldValue = _data[offset];
-        var newData = new byte[_data.Length - 1];
-        if (offset > 0)
-            Array.Copy(_data, 0, newData, 0, (int)offset);
-        if (offset < _data.Length - 1)
-            Array.Copy(_data, (int)(offset + 1), newData, (int)offset, (int)(_data.Length - offset - 1));
+        Execute(new ByteReplaceCommand(_buffer, offset, 1, []), updateScrollBar: true);
+        DataChanged?.Invoke(this, new HexDataChangedEventArgs(offset, 1L, 0L));
+    }
 
-        _data = newData;
-        _renderer.Data = _data;
+    /// <summary>
+    /// Replaces <paramref name="length"/> bytes at <paramref name="offset"/>
+    /// with <paramref name="data"/> as a single undo step.  Covers paste
+    /// (insert or overwrite) and range deletion; the cost is proportional to
+    /// <paramref name="data"/>, not to the document.
+    /// </summary>
+    public void ReplaceBytes(long offset, long length, byte[] data)
+    {
+        ArgumentNullException.ThrowIfNull(data);
+        if (_isReadOnly) return;
+        if (offset < 0 || offset > _buffer.Length) return;
+        length = Math.Clamp(length, 0, _buffer.Length - offset);
+        if (length == 0 && data.Length == 0) return;
 
-        _undoStack.Add(new HexUndoEntry(HexUndoType.Delete, offset, oldValue, 0));
-        _redoStack.Clear();
+        Execute(new ByteReplaceCommand(_buffer, offset, length, data), updateScrollBar: length != data.Length);
+        DataChanged?.Invoke(this, new HexDataChangedEventArgs(offset, length, data.Length));
+    }
 
-        if (_renderer.SelectedOffset >= _data.Length && _data.Length > 0)
-            _renderer.SelectedOffset = _data.Length - 1;
+    /// <summary>Inserts <paramref name="data"/> at <paramref name="offset"/> as one undo step.</summary>
+    public void InsertBytes(long offset, byte[] data) => ReplaceBytes(offset, 0, data);
 
-        UpdateScrollBar();
-        DataChanged?.Invoke(this, new HexDataChangedEventArgs(offset, oldValue, 0));
+    /// <summary>Deletes a range of bytes as one undo step.</summary>
+    public void DeleteBytes(long offset, long length) => ReplaceBytes(offset, length, []);
+
+    /// <summary>
+    /// Overwrites <paramref name="length"/> bytes at <paramref name="offset"/>
+    /// with <paramref name="value"/> as one undo step.
+    /// </summary>
+    public void Fill(long offset, long length, byte value)
+    {
+        if (offset < 0 || length <= 0 || offset >= _buffer.Length) return;
+        length = Math.Min(length, _buffer.Length - offset);
+        if (length > Array.MaxLength)
+            throw new ArgumentOutOfRangeException(nameof(length));
+
+        byte[] data = new byte[length];
+        data.AsSpan().Fill(value);
+        ReplaceBytes(offset, length, data);
+    }
+
+    private void Execute(ByteReplaceCommand command, bool updateScrollBar)
+    {
+        _history.Execute(command);
+
+        if (_renderer.SelectedOffset >= _buffer.Length && _buffer.Length > 0)
+            _renderer.SelectedOffset = _buffer.Length - 1;
+
+        if (updateScrollBar)
+            UpdateScrollBar();
+        _renderer.Invalidate();
         UpdateInspector();
     }
 
@@ -340,49 +503,10 @@ public sealed class HexEditorControl : UserControl
     /// </summary>
     public void Undo()
     {
-        if (_undoStack.Count == 0) return;
-
-        HexUndoEntry entry = _undoStack[^1];
-        _undoStack.RemoveAt(_undoStack.Count - 1);
-
-        switch (entry.Type)
-        {
-            case HexUndoType.Overwrite:
-                _data[entry.Offset] = entry.OldValue;
-                _renderer.ModifiedOffsets.Remove(entry.Offset);
-                break;
-
-            case HexUndoType.Insert:
-                // Remove the inserted byte
-                var shrunk = new byte[_data.Length - 1];
-                if (entry.Offset > 0)
-                    Array.Copy(_data, 0, shrunk, 0, (int)entry.Offset);
-                if (entry.Offset < _data.Length - 1)
-                    Array.Copy(_data, (int)(entry.Offset + 1), shrunk, (int)entry.Offset,
-                        (int)(_data.Length - entry.Offset - 1));
-                _data = shrunk;
-                _renderer.Data = _data;
-                break;
-
-            case HexUndoType.Delete:
-                // Re-insert the deleted byte
-                var grown = new byte[_data.Length + 1];
-                if (entry.Offset > 0)
-                    Array.Copy(_data, 0, grown, 0, (int)entry.Offset);
-                grown[entry.Offset] = entry.OldValue;
-                if (entry.Offset < _data.Length)
-                    Array.Copy(_data, (int)entry.Offset, grown, (int)(entry.Offset + 1),
-                        (int)(_data.Length - entry.Offset));
-                _data = grown;
-                _renderer.Data = _data;
-                break;
-        }
+        if (_history.NextUndo is not ByteReplaceCommand command) return;
 
-        _redoStack.Add(entry);
-        _renderer.SelectedOffset = entry.Offset;
-        UpdateScrollBar();
-        _renderer.Invalidate();
-        UpdateInspector();
+        _history.Undo();
+        AfterHistoryStep(command.Offset, command.InsertedLength, command.RemovedLength);
     }
 
     /// <summary>
@@ -390,56 +514,21 @@ public sealed class HexEditorControl : UserControl
     /// </summary>
     public void Redo()
     {
-        if (_redoStack.Count == 0) return;
+        if (_history.NextRedo is not ByteReplaceCommand command) return;
 
-        HexUndoEntry entry = _redoStack[^1];
-        _redoStack.RemoveAt(_redoStack.Count - 1);
-
-        switch (entry.Type)
-        {
-            case HexUndoType.Overwrite:
-                _data[entry.Offset] = entry.NewValue;
-                _renderer.ModifiedOffsets.Add(entry.Offset);
-                break;
-
-            case HexUndoType.Insert:
-                InsertByteInternal(entry.Offset, entry.NewValue);
-                break;
-
-            case HexUndoType.Delete:
-                DeleteByteInternal(entry.Offset);
-                break;
-        }
+        _history.Redo();
+        AfterHistoryStep(command.Offset, command.RemovedLength, command.InsertedLength);
+    }
 
-        _undoStack.Add(entry);
-        _renderer.SelectedOffset = entry.Offset;
+    private void AfterHistoryStep(long offset, long removedLength, long insertedLength)
+    {
+        // An undone insert at the end leaves offset == Length.
+        _renderer.SelectedOffset = Math.Clamp(offset, 0, Math.Max(0, _buffer.Length - 1));
         UpdateScrollBar();
+        _renderer.EnsureVisible(_renderer.SelectedOffset);
         _renderer.Invalidate();
         UpdateInspector();
-    }
-
-    private void InsertByteInternal(long offset, byte value)
-    {
-        var newData = new byte[_data.Length + 1];
-        if (offset > 0)
-            Array.Copy(_data, 0, newData, 0, (int)offset);
-        newData[offset] = value;
-        if (offset < _data.Length)
-            Array.Copy(_data, (int)offset, newData, (int)(offset + 1), (int)(_data.Length - offset));
-        _data = newData;
-        _renderer.Data = _data;
-    }
-
-    private void DeleteByteInternal(long offset)
-    {
-        if (offset < 0 || offset >= _data.Length) return;
-        var newData = new byte[_data.Length - 1];
-        if (offset > 0)
-            Array.Copy(_data, 0, newData, 0, (int)offset);
-        if (offset < _data.Length - 1)
-            Array.Copy(_data, (int)(offset + 1), newData, (int)offset, (int)(_data.Length - offset - 1));
-        _data = newData;
-        _renderer.Data = _data;
+        DataChanged?.Invoke(this, new HexDataChangedEventArgs(offset, removedLength, insertedLength));
     }
 
     // ── Navigation ──────────────────────────────────────────────────────
@@ -449,8 +538,8 @@ public sealed class HexEditorControl : UserControl
     /// </summary>
     public void GoToOffset(long offset)
     {
-        if (_data.Length == 0) return;
-        _renderer.SelectedOffset = Math.Clamp(offset, 0, _data.Length - 1);
+        if (_buffer.Length == 0) return;
+        _renderer.SelectedOffset = Math.Clamp(offset, 0, _buffer.Length - 1);
         _renderer.SelectionLength = 0;
         _renderer.EnsureVisible(_renderer.SelectedOffset);
         UpdateInspector();
@@ -466,42 +555,49 @@ public sealed class HexEditorControl : UserControl
     /// </summary>
     public long Find(byte[] pattern)
     {
-        if (pattern is null || pattern.Length == 0 || _data.Length == 0)
-            return -1;
+        if (pattern is null || pattern.Length == 0) return -1;
+        return Find(new BytePattern(pattern));
+    }
 
-        long startOffset = _renderer.SelectedOffset + 1;
-        if (startOffset >= _data.Length) startOffset = 0;
+    /// <summary>
+    /// Finds the next (or, with <paramref name="backwards"/>, previous)
+    /// occurrence of <paramref name="pattern"/> relative to the caret,
+    /// wrapping around the end of the document, and selects it.  Returns
+    /// the offset of the match, or -1 if not found.
+    /// </summary>
+    public long Find(BytePattern pattern, bool backwards = false)
+    {
+        ArgumentNullException.ThrowIfNull(pattern);
+        if (_buffer.Length == 0) return -1;
 
-        // Simple linear search with wrap-around.
-        long dataLen = _data.Length;
-        int patternLen = pattern.Length;
+        long caret = _renderer.SelectedOffset;
+        long idx = backwards
+            ? BytePatternSearcher.FindPrevious(_buffer, pattern, caret, wrapAround: true)
+            : BytePatternSearcher.FindNext(_buffer, pattern, caret + 1, wrapAround: true);
 
-        for (long pass = 0; pass < dataLen; pass++)
+        if (idx >= 0)
         {
-            long idx = (startOffset + pass) % dataLen;
-            if (idx + patternLen > dataLen) continue;
-
-            bool match = true;
-            for (int j = 0; j < patternLen; j++)
-            {
-                if (_data[idx + j] != pattern[j])
-                {
-                    match = false;
-                    break;
-                }
-            }
-
-            if (match)
-            {
-                _renderer.SelectedOffset = idx;
-                _renderer.SelectionLength = patternLen;
-                _renderer.EnsureVisible(idx);
-                UpdateInspector();
-                return idx;
-            }
+            _renderer.SelectedOffset = idx;
+            _renderer.SelectionLength = pattern.Length;
+            _renderer.EnsureVisible(idx);
+            UpdateInspector();
         }
 
-        return -1;
+        return idx;
+    }
+
+    /// <summary>
+    /// Returns the offsets of every occurrence of <paramref name="pattern"/>
+    /// in the document.  Runs on the thread pool; the document must not be
+    /// edited until the task completes.
+    /// </summary>
+    public Task<ByteMatchList> FindAllAsync(BytePattern pattern, IProgress<int>? progress = null,
+        CancellationToken cancellationToken = default)
+    {
+        ArgumentNullException.ThrowIfNull(pattern);
+        BytePieceTable buffer = _buffer;
+        return Task.Run(() => BytePatternSearcher.FindAll(buffer, pattern,
+            BytePatternSearcher.MaxResults, progress, cancellationToken), cancellationToken);
     }
 
     /// <summary>
@@ -535,7 +631,7 @@ public sealed class HexEditorControl : UserControl
 
     private void OnScrollBarScroll(object? sender, ScrollEventArgs e)
     {
-        _renderer.ScrollOffset = _scrollBar.Value;
+        _renderer.ScrollOffset = _scrollBar.Value * _scrollScale;
     }
 
     // ── Scroll bar ──────────────────────────────────────────────────────
@@ -552,9 +648,13 @@ public sealed class HexEditorControl : UserControl
             return;
         }
 
+        // Files beyond ~32 GB (at 16 bytes per row) have more rows than a
+        // scroll bar can represent; each unit then stands for several rows.
+        _scrollScale = (totalRows + MaxScrollBarValue - 1) / MaxScrollBarValue;
+
         _scrollBar.Enabled = true;
         _scrollBar.Minimum = 0;
-        _scrollBar.Maximum = (int)Math.Min(totalRows, int.MaxValue);
+        _scrollBar.Maximum = (int)(totalRows / _scrollScale);
         _scrollBar.LargeChange = Math.Max(1, visible);
         _scrollBar.SmallChange = 1;
         SyncScrollBarFromRenderer();
@@ -562,7 +662,7 @@ public sealed class HexEditorControl : UserControl
 
     private void SyncScrollBarFromRenderer()
     {
-        int val = (int)Math.Min(_renderer.ScrollOffset, _scrollBar.Maximum);
+        int val = (int)Math.Min(_renderer.ScrollOffset / _scrollScale, _scrollBar.Maximum);
         if (val >= _scrollBar.Minimum && val <= _scrollBar.Maximum)
             _scrollBar.Value = val;
     }
@@ -571,8 +671,12 @@ public sealed class HexEditorControl : UserControl
 
     private void UpdateInspector()
     {
-        _inspector.Inspect(_data, _renderer.SelectedOffset,
-            Math.Max(1, _renderer.SelectionLength));
+        // The inspector only ever looks at the first few selected bytes.
+        long offset = _renderer.SelectedOffset;
+        byte[] window = new byte[(int)Math.Clamp(_buffer.Length - offset, 0, InspectorWindow)];
+        if (window.Length > 0)
+            _buffer.Read(offset, window);
+        _inspector.Inspect(window, 0, Math.Max(1, _renderer.SelectionLength));
     }
 
     // ── Resize ──────────────────────────────────────────────────────────
@@ -610,30 +714,12 @@ public sealed class HexEditorControl : UserControl
         {
             _renderer.Dispose();
             _inspector.Dispose();
+            _buffer.Dispose();
+            if (_recoveryPath is not null)
+                TryDeleteFile(_recoveryPath);
             _scrollBar.Dispose();
             _splitter.Dispose();
         }
         base.Dispose(disposing);
     }
 }
-
-// ── Undo infrastructure ─────────────────────────────────────────────────
-
-/// <summary>
-/// The type of hex-editor edit that was recorded for undo/redo.
-/// </summary>
-internal enum HexUndoType
-{
-    Overwrite,
-    Insert,
-    Delete,
-}
-
-/// <summary>
-/// A single undo/redo entry for a hex-editor operation.
-/// </summary>
-internal sealed record HexUndoEntry(
-    HexUndoType Type,
-    long Offset,
-    byte OldValue,
-    byte NewValue);
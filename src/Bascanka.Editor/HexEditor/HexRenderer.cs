@@ -1,5 +1,6 @@
 using System.Drawing;
 using System.Windows.Forms;
+using Bascanka.Core.Buffer;
 using Bascanka.Editor.Themes;
 
 namespace Bascanka.Editor.HexEditor;
@@ -30,8 +31,9 @@ public sealed class HexRenderer : Control
 
     // ── Fields ──────────────────────────────────────────────────────────
 
-    private byte[] _data = [];
-    private HashSet<long> _modifiedOffsets = [];
+    private BytePieceTable _buffer = new([]);
+    private byte[] _pageBuffer = [];  // visible rows, refilled on every paint
+    private bool[] _pageModified = [];  // per byte of _pageBuffer: from the add buffer
     private int _bytesPerRow = 16;
     private long _selectedOffset;
     private long _selectionLength;
@@ -98,14 +100,16 @@ public sealed class HexRenderer : Control
 
     // ── Properties ──────────────────────────────────────────────────────
 
-    /// <summary>The raw data being displayed.</summary>
-    public byte[] Data
+    /// <summary>
+    /// The bytes being displayed.  Only the visible rows are read on each
+    /// paint, so the buffer may be backed by a file of any size.
+    /// </summary>
+    public BytePieceTable Buffer
     {
-        get => _data;
+        get => _buffer;
         set
         {
-            _data = value ?? [];
-            _modifiedOffsets.Clear();
+            _buffer = value ?? new BytePieceTable([]);
             _selectedOffset = 0;
             _selectionLength = 0;
             _scrollOffset = 0;
@@ -114,13 +118,6 @@ public sealed class HexRenderer : Control
         }
     }
 
-    /// <summary>Set of byte offsets that have been modified (rendered in red).</summary>
-    public HashSet<long> ModifiedOffsets
-    {
-        get => _modifiedOffsets;
-        set { _modifiedOffsets = value ?? []; Invalidate(); }
-    }
-
     /// <summary>Number of bytes displayed per row.</summary>
     public int BytesPerRow
     {
@@ -139,7 +136,7 @@ public sealed class HexRenderer : Control
         get => _selectedOffset;
         set
         {
-            long clamped = Math.Clamp(value, 0, Math.Max(0, _data.Length - 1));
+            long clamped = Math.Clamp(value, 0, Math.Max(0, _buffer.Length - 1));
             if (_selectedOffset == clamped) return;
             _selectedOffset = clamped;
             _currentNibble = 0;
@@ -191,7 +188,7 @@ public sealed class HexRenderer : Control
     }
 
     /// <summary>Total number of rows needed to display all data.</summary>
-    public long TotalRows => _data.Length == 0 ? 1 : (_data.Length + _bytesPerRow - 1) / _bytesPerRow;
+    public long TotalRows => _buffer.Length == 0 ? 1 : (_buffer.Length + _bytesPerRow - 1) / _bytesPerRow;
 
     /// <summary>Number of fully visible rows in the current control height.</summary>
     public int VisibleRows => _visibleRows;
@@ -253,7 +250,7 @@ public sealed class HexRenderer : Control
         Graphics g = e.Graphics;
         g.Clear(_theme.EditorBackground);
 
-        if (_data.Length == 0) return;
+        if (_buffer.Length == 0) return;
 
         using Brush foregroundBrush = new SolidBrush(_theme.EditorForeground);
         using Brush offsetBrush = new SolidBrush(_theme.GutterForeground);
@@ -270,6 +267,19 @@ public sealed class HexRenderer : Control
         long selStart = _selectedOffset;
         long selEnd = _selectedOffset + Math.Max(1, _selectionLength);
 
+        // Page in just the visible rows.
+        long firstVisibleByte = _scrollOffset * _bytesPerRow;
+        int pageSize = Math.Max(0, _visibleRows) * _bytesPerRow;
+        if (_pageBuffer.Length < pageSize)
+        {
+            _pageBuffer = new byte[pageSize];
+            _pageModified = new bool[pageSize];
+        }
+        // Bytes that came from the add buffer (typed, pasted, filled) are
+        // the modified ones; undoing an edit restores the original pieces.
+        int pageLength = _buffer.Read(firstVisibleByte, _pageBuffer.AsSpan(0, pageSize),
+            _pageModified.AsSpan(0, pageSize));
+
         for (int row = 0; row < _visibleRows; row++)
         {
             long rowIndex = _scrollOffset + row;
@@ -286,11 +296,11 @@ public sealed class HexRenderer : Control
             for (int col = 0; col < _bytesPerRow; col++)
             {
                 long dataIndex = byteOffset + col;
-                if (dataIndex >= _data.Length) break;
+                if (dataIndex >= firstVisibleByte + pageLength) break;
 
-                byte b = _data[dataIndex];
+                byte b = _pageBuffer[dataIndex - firstVisibleByte];
                 bool isSelected = dataIndex >= selStart && dataIndex < selEnd;
-                bool isModified = _modifiedOffsets.Contains(dataIndex);
+                bool isModified = _pageModified[dataIndex - firstVisibleByte];
                 bool isCursorByte = dataIndex == _selectedOffset;
 
                 // Determine foreground colour
@@ -335,7 +345,7 @@ public sealed class HexRenderer : Control
 
     private void InvalidateCurrentByte()
     {
-        if (_data.Length == 0) return;
+        if (_buffer.Length == 0) return;
         long row = _selectedOffset / _bytesPerRow - _scrollOffset;
         if (row < 0 || row >= _visibleRows) return;
         // Invalidate full row for simplicity
@@ -433,7 +443,7 @@ public sealed class HexRenderer : Control
             int col = (p.X - _asciiColumnStart) / _charWidth;
             col = Math.Clamp(col, 0, _bytesPerRow - 1);
             long offset = byteOffset + col;
-            return offset < _data.Length ? offset : -1;
+            return offset < _buffer.Length ? offset : -1;
         }
 
         // Check hex area
@@ -446,7 +456,7 @@ public sealed class HexRenderer : Control
             if (col >= 8) col = (relX - _charWidth) / (_charWidth * 3);
             col = Math.Clamp(col, 0, _bytesPerRow - 1);
             long offset = byteOffset + col;
-            return offset < _data.Length ? offset : -1;
+            return offset < _buffer.Length ? offset : -1;
         }
 
         return -1;
@@ -469,7 +479,7 @@ public sealed class HexRenderer : Control
     protected override void OnKeyDown(KeyEventArgs e)
     {
         base.OnKeyDown(e);
-        if (_data.Length == 0) return;
+        if (_buffer.Length == 0) return;
 
         bool shift = e.Shift;
         long oldOffset = _selectedOffset;
@@ -516,11 +526,11 @@ public sealed class HexRenderer : Control
 
             case Keys.End:
                 if (e.Control)
-                    SetCaretPosition(_data.Length - 1, shift);
+                    SetCaretPosition(_buffer.Length - 1, shift);
                 else
                 {
                     long rowEnd = _selectedOffset - _selectedOffset % _bytesPerRow + _bytesPerRow - 1;
-                    SetCaretPosition(Math.Min(rowEnd, _data.Length - 1), shift);
+                    SetCaretPosition(Math.Min(rowEnd, _buffer.Length - 1), shift);
                 }
                 e.Handled = true;
                 break;
@@ -537,14 +547,14 @@ public sealed class HexRenderer : Control
     protected override void OnKeyPress(KeyPressEventArgs e)
     {
         base.OnKeyPress(e);
-        if (_isReadOnly || _data.Length == 0) return;
+        if (_isReadOnly || _buffer.Length == 0) return;
 
         if (_editArea == HexEditArea.Hex)
         {
             int nibbleValue = HexCharToValue(e.KeyChar);
             if (nibbleValue >= 0)
             {
-                byte oldByte = _data[_selectedOffset];
+                byte oldByte = _buffer[_selectedOffset];
                 byte newByte;
                 if (_currentNibble == 0)
                 {
@@ -559,7 +569,7 @@ public sealed class HexRenderer : Control
 
                 ByteEdited?.Invoke(this, new HexEditEventArgs(_selectedOffset, oldByte, newByte));
 
-                if (_currentNibble == 0 && _selectedOffset < _data.Length - 1)
+                if (_currentNibble == 0 && _selectedOffset < _buffer.Length - 1)
                     SelectedOffset++;
 
                 e.Handled = true;
@@ -570,11 +580,11 @@ public sealed class HexRenderer : Control
         {
             if (e.KeyChar >= 0x20 && e.KeyChar < 0x7F)
             {
-                byte oldByte = _data[_selectedOffset];
+                byte oldByte = _buffer[_selectedOffset];
                 byte newByte = (byte)e.KeyChar;
                 ByteEdited?.Invoke(this, new HexEditEventArgs(_selectedOffset, oldByte, newByte));
 
-                if (_selectedOffset < _data.Length - 1)
+                if (_selectedOffset < _buffer.Length - 1)
                     SelectedOffset++;
 
                 e.Handled = true;
@@ -585,13 +595,13 @@ public sealed class HexRenderer : Control
 
     private void MoveCaret(long delta, bool extendSelection)
     {
-        long newOffset = Math.Clamp(_selectedOffset + delta, 0, Math.Max(0, _data.Length - 1));
+        long newOffset = Math.Clamp(_selectedOffset + delta, 0, Math.Max(0, _buffer.Length - 1));
         SetCaretPosition(newOffset, extendSelection);
     }
 
     private void SetCaretPosition(long newOffset, bool extendSelection)
     {
-        long clamped = Math.Clamp(newOffset, 0, Math.Max(0, _data.Length - 1));
+        long clamped = Math.Clamp(newOffset, 0, Math.Max(0, _buffer.Length - 1));
 
         if (extendSelection)
         {
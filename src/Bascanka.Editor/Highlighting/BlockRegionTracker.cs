@@ -0,0 +1,84 @@
+using System.Drawing;
+using System.Text.RegularExpressions;
+using Bascanka.Core.Syntax;
+
+namespace Bascanka.Editor.Highlighting;
+
+/// <summary>
+/// Maintains the block regions of a custom highlight profile across edits.
+/// The spans are tracked by a <see cref="BlockSpanTracker"/>, which re-scans
+/// only the lines around an edit; this class gives them the colours and
+/// fold setting of their rules.
+/// </summary>
+/// <remarks>
+/// <para>Create instances with <see cref="CustomHighlightMatcher.CreateBlockTracker"/>.
+/// This class is <b>not</b> thread-safe; callers must synchronize
+/// externally if they access it from multiple threads.</para>
+/// </remarks>
+public sealed class BlockRegionTracker
+{
+    private readonly BlockSpanTracker _spans;
+    private readonly (Color Foreground, Color Background, bool Foldable)[] _styles;
+    private List<BlockRegion> _regions = [];
+
+    internal BlockRegionTracker((Regex Begin, Regex End, Color Foreground, Color Background, bool Foldable)[] rules)
+    {
+        _spans = new BlockSpanTracker([.. rules.Select(r => (r.Begin, r.End))]);
+        _styles = [.. rules.Select(r => (r.Foreground, r.Background, r.Foldable))];
+    }
+
+    /// <summary>
+    /// All block regions ordered by start line; blocks still open at the end
+    /// of the document extend to its last line.
+    /// </summary>
+    public IReadOnlyList<BlockRegion> Regions => _regions;
+
+    /// <summary>Number of lines the regions were computed for.</summary>
+    public long LineCount => _spans.LineCount;
+
+    /// <summary>
+    /// Scans every line, replacing all previous state.
+    /// </summary>
+    /// <param name="getLineRange">Batch line fetcher: (startLine, count) → array of line texts.</param>
+    /// <param name="lineCount">Total number of lines in the document.</param>
+    public void Rebuild(Func<long, int, string[]> getLineRange, long lineCount)
+    {
+        _spans.Rebuild(getLineRange, lineCount);
+        Materialize();
+    }
+
+    /// <summary>
+    /// Brings the regions up to date after an edit that replaced some lines.
+    /// </summary>
+    /// <param name="getLineRange">Batch line fetcher over the edited document.</param>
+    /// <param name="lineCount">Line count after the edit.</param>
+    /// <param name="firstChangedLine">First line touched by the edit.</param>
+    /// <param name="lastChangedLine">Last line touched by the edit, after the edit.</param>
+    /// <returns>Whether <see cref="Regions"/> changed.</returns>
+    public bool Update(Func<long, int, string[]> getLineRange, long lineCount,
+        long firstChangedLine, long lastChangedLine)
+    {
+        if (!_spans.Update(getLineRange, lineCount, firstChangedLine, lastChangedLine))
+            return false;
+        Materialize();
+        return true;
+    }
+
+    private void Materialize()
+    {
+        var regions = new List<BlockRegion>(_spans.Spans.Count);
+        foreach (BlockSpan span in _spans.Spans)
+        {
+            var (foreground, background, foldable) = _styles[span.Rule];
+            regions.Add(new BlockRegion
+            {
+                StartLine = span.StartLine,
+                EndLine = span.EndLine,
+                Foreground = foreground,
+                Background = background,
+                Foldable = foldable,
+            });
+        }
+        _regions = regions;
+    }
+}
@@ -1,5 +1,7 @@
+using System.Collections.Concurrent;
 using System.Drawing;
 using System.Text.RegularExpressions;
+using Bascanka.Core.Search;
 
 namespace Bascanka.Editor.Highlighting;
 
@@ -45,11 +47,57 @@ public readonly struct BlockRegion
 /// Pre-compiles regexes from a <see cref="CustomHighlightProfile"/> and
 /// provides fast per-line matching.
 /// </summary>
+/// <remarks>
+/// <para>
+/// Line and match rules share one literal prefilter: every pattern is
+/// analysed for literals it cannot match without (see
+/// <see cref="RegexLiteralExtractor"/>), and a single
+/// <see cref="MultiLiteralMatcher"/> pass over the line decides which rules
+/// can possibly match.  Only those rules run their regex, so a line that
+/// mentions one log level pays for one rule rather than for the whole
+/// profile.  Rules without a usable literal always run.
+/// </para>
+/// <para>
+/// Line results are cached by line content, so repeated lines and lines
+/// warmed ahead of the viewport by a background prefetch are not matched
+/// again at paint time.  Matching and the cache are safe to use from
+/// multiple threads; returned span lists must be treated as read-only.
+/// </para>
+/// </remarks>
 public sealed class CustomHighlightMatcher
 {
+    /// <summary>
+    /// Approximate maximum number of characters of cached lines, about
+    /// 8 MB of line text.  The cache keeps two generations of half this
+    /// size; when the newer one fills, the older one is dropped, so recently
+    /// used lines survive the trim.
+    /// </summary>
+    public const int MaxCachedCharacters = 4 * 1024 * 1024;
+
+    /// <summary>
+    /// Characters charged per cached line on top of its length, for the
+    /// entry and its span list, so that many short lines are bounded too.
+    /// </summary>
+    private const int EntryOverheadCharacters = 64;
+
+    /// <summary>Lines longer than this are matched every time rather than cached.</summary>
+    public const int MaxCachedLineLength = 16 * 1024;
+
     private readonly (Regex Regex, Color Foreground, Color Background)[] _lineRules;
     private readonly (Regex Regex, Color Foreground, Color Background)[] _matchRules;
     private readonly (Regex Begin, Regex End, Color Foreground, Color Background, bool Foldable)[] _blockRules;
+    private readonly object _rotateLock = new();
+    private CacheGeneration _recentLines = new();
+    private CacheGeneration _olderLines = new();
+
+    // Prefilter: rule indices count line rules first, then match rules.
+    private readonly MultiLiteralMatcher? _prefilter;
+    private readonly int[] _literalRule = [];       // literal id → rule index
+    private readonly bool[] _alwaysRun;            // rules with no required literal
+
+    // Per-thread scratch for collecting spans before they are sorted.
+    [ThreadStatic]
+    private static List<(CustomColorSpan Span, int Rule)>? t_spanScratch;
 
     /// <summary>Whether this matcher has any block-scope rules.</summary>
     public bool HasBlockRules => _blockRules.Length > 0;
@@ -105,6 +153,32 @@ public sealed class CustomHighlightMatcher
         _lineRules = lineRules.ToArray();
         _matchRules = matchRules.ToArray();
         _blockRules = blockRules.ToArray();
+
+        // Build the shared literal prefilter.
+        _alwaysRun = new bool[_lineRules.Length + _matchRules.Length];
+        var literals = new List<string>();
+        var literalRule = new List<int>();
+        for (int r = 0; r < _alwaysRun.Length; r++)
+        {
+            Regex regex = r < _lineRules.Length ? _lineRules[r].Regex : _matchRules[r - _lineRules.Length].Regex;
+            string[]? required = RegexLiteralExtractor.GetRequiredLiterals(regex.ToString(), regex.Options);
+            if (required is null)
+            {
+                _alwaysRun[r] = true;
+                continue;
+            }
+            foreach (string literal in required)
+            {
+                literals.Add(literal);
+                literalRule.Add(r);
+            }
+        }
+
+        if (literals.Count > 0)
+        {
+            _prefilter = new MultiLiteralMatcher(literals);
+            _literalRule = literalRule.ToArray();
+        }
     }
 
     /// <summary>
@@ -114,80 +188,19 @@ public sealed class CustomHighlightMatcher
     /// <param name="lineCount">Total number of lines in the document.</param>
     public List<BlockRegion> ScanBlocks(Func<long, int, string[]> getLineRange, long lineCount)
     {
-        var regions = new List<BlockRegion>();
-        if (_blockRules.Length == 0 || lineCount == 0) return regions;
-
-        // Per-rule state: the line where the current open block started (-1 = not in block).
-        var openStartLine = new long[_blockRules.Length];
-        for (int r = 0; r < _blockRules.Length; r++)
-            openStartLine[r] = -1;
-
-        const int batchSize = 1000;
-        for (long batchStart = 0; batchStart < lineCount; batchStart += batchSize)
-        {
-            int count = (int)Math.Min(batchSize, lineCount - batchStart);
-            string[] lines = getLineRange(batchStart, count);
+        if (_blockRules.Length == 0 || lineCount == 0) return [];
 
-            for (int i = 0; i < lines.Length; i++)
-            {
-                long line = batchStart + i;
-                string text = lines[i].TrimEnd('\r');
-
-                for (int r = 0; r < _blockRules.Length; r++)
-                {
-                    try
-                    {
-                        if (openStartLine[r] < 0)
-                        {
-                            // Not in block — test begin pattern.
-                            if (_blockRules[r].Begin.IsMatch(text))
-                                openStartLine[r] = line;
-                        }
-                        else
-                        {
-                            // In block — test end pattern.
-                            if (_blockRules[r].End.IsMatch(text))
-                            {
-                                regions.Add(new BlockRegion
-                                {
-                                    StartLine = openStartLine[r],
-                                    EndLine = line,
-                                    Foreground = _blockRules[r].Foreground,
-                                    Background = _blockRules[r].Background,
-                                    Foldable = _blockRules[r].Foldable,
-                                });
-                                openStartLine[r] = -1;
-                            }
-                        }
-                    }
-                    catch (RegexMatchTimeoutException)
-                    {
-                        // Skip slow patterns.
-                    }
-                }
-            }
-        }
-
-        // Unterminated blocks extend to end of document.
-        for (int r = 0; r < _blockRules.Length; r++)
-        {
-            if (openStartLine[r] >= 0)
-            {
-                regions.Add(new BlockRegion
-                {
-                    StartLine = openStartLine[r],
-                    EndLine = lineCount - 1,
-                    Foreground = _blockRules[r].Foreground,
-                    Background = _blockRules[r].Background,
-                    Foldable = _blockRules[r].Foldable,
-                });
-            }
-        }
-
-        regions.Sort((a, b) => a.StartLine.CompareTo(b.StartLine));
-        return regions;
+        var tracker = CreateBlockTracker();
+        tracker.Rebuild(getLineRange, lineCount);
+        return [.. tracker.Regions];
     }
 
+    /// <summary>
+    /// Creates a tracker that keeps this matcher's block regions up to date
+    /// across edits without re-scanning the whole document.
+    /// </summary>
+    public BlockRegionTracker CreateBlockTracker() => new(_blockRules);
+
     /// <summary>
     /// Binary search for the first block region containing the given line.
     /// </summary>
@@ -227,13 +240,53 @@ public sealed class CustomHighlightMatcher
     /// Evaluates all rules against the given line text.
     /// </summary>
     public CustomLineResult MatchLine(string lineText)
+    {
+        if (lineText.Length > MaxCachedLineLength)
+            return MatchLineUncached(lineText);
+
+        CacheGeneration recent = Volatile.Read(ref _recentLines);
+        if (recent.Lines.TryGetValue(lineText, out CustomLineResult cached))
+            return cached;
+
+        // A hit in the older generation is promoted so it outlives the
+        // next rotation.
+        if (!Volatile.Read(ref _olderLines).Lines.TryGetValue(lineText, out cached))
+            cached = MatchLineUncached(lineText);
+
+        AddToCache(recent, lineText, cached);
+        return cached;
+    }
+
+    private void AddToCache(CacheGeneration generation, string lineText, CustomLineResult result)
+    {
+        // ConcurrentDictionary.Count takes every bucket lock, so the size
+        // is tracked with an approximate counter instead.
+        if (!generation.Lines.TryAdd(lineText, result) ||
+            Interlocked.Add(ref generation.Characters, lineText.Length + EntryOverheadCharacters)
+                < MaxCachedCharacters / 2)
+            return;
+
+        lock (_rotateLock)
+        {
+            if (!ReferenceEquals(_recentLines, generation)) return;
+            Volatile.Write(ref _olderLines, generation);
+            Volatile.Write(ref _recentLines, new CacheGeneration());
+        }
+    }
+
+    private CustomLineResult MatchLineUncached(string lineText)
     {
         Color lineBg = Color.Empty;
         Color lineFg = Color.Empty;
 
+        int ruleCount = _alwaysRun.Length;
+        Span<bool> candidates = ruleCount <= 256 ? stackalloc bool[ruleCount] : new bool[ruleCount];
+        FindCandidateRules(lineText, candidates);
+
         // Line rules: first match wins.
         for (int i = 0; i < _lineRules.Length; i++)
         {
+            if (!candidates[i]) continue;
             try
             {
                 if (_lineRules[i].Regex.IsMatch(lineText))
@@ -250,23 +303,23 @@ public sealed class CustomHighlightMatcher
         }
 
         // Match rules: find all occurrences.
-        List<CustomColorSpan>? spans = null;
+        List<(CustomColorSpan Span, int Rule)> scratch = t_spanScratch ??= new List<(CustomColorSpan, int)>();
+        scratch.Clear();
         for (int i = 0; i < _matchRules.Length; i++)
         {
+            if (!candidates[_lineRules.Length + i]) continue;
             try
             {
-                var matches = _matchRules[i].Regex.Matches(lineText);
-                foreach (Match m in matches)
+                foreach (ValueMatch m in _matchRules[i].Regex.EnumerateMatches(lineText))
                 {
                     if (m.Length == 0) continue;
-                    spans ??= new List<CustomColorSpan>();
-                    spans.Add(new CustomColorSpan
+                    scratch.Add((new CustomColorSpan
                     {
                         Start = m.Index,
                         Length = m.Length,
                         Foreground = _matchRules[i].Foreground,
                         Background = _matchRules[i].Background,
-                    });
+                    }, i));
                 }
             }
             catch (RegexMatchTimeoutException)
@@ -275,9 +328,19 @@ public sealed class CustomHighlightMatcher
             }
         }
 
-        // Sort spans by start position for rendering.
-        if (spans is { Count: > 1 })
-            spans.Sort((a, b) => a.Start.CompareTo(b.Start));
+        // Sort spans by start position for rendering; ties keep rule order.
+        List<CustomColorSpan>? spans = null;
+        if (scratch.Count > 0)
+        {
+            if (scratch.Count > 1)
+                scratch.Sort(static (a, b) => a.Span.Start != b.Span.Start
+                    ? a.Span.Start.CompareTo(b.Span.Start)
+                    : a.Rule.CompareTo(b.Rule));
+
+            spans = new List<CustomColorSpan>(scratch.Count);
+            foreach (var (span, _) in scratch)
+                spans.Add(span);
+        }
 
         return new CustomLineResult
         {
@@ -286,4 +349,31 @@ public sealed class CustomHighlightMatcher
             Spans = spans,
         };
     }
+
+    /// <summary>
+    /// Marks the rules that can possibly match <paramref name="lineText"/>:
+    /// those without a required literal, plus those whose literal occurs.
+    /// </summary>
+    private void FindCandidateRules(string lineText, Span<bool> candidates)
+    {
+        _alwaysRun.CopyTo(candidates);
+        if (_prefilter is null) return;
+
+        int literalCount = _prefilter.Count;
+        Span<bool> present = literalCount <= 512 ? stackalloc bool[literalCount] : new bool[literalCount];
+        if (_prefilter.FindPresent(lineText, present) == 0) return;
+
+        for (int id = 0; id < literalCount; id++)
+        {
+            if (present[id])
+                candidates[_literalRule[id]] = true;
+        }
+    }
+
+    /// <summary>One generation of the line result cache.</summary>
+    private sealed class CacheGeneration
+    {
+        public readonly ConcurrentDictionary<string, CustomLineResult> Lines = new(StringComparer.Ordinal);
+        public long Characters;
+    }
 }
@@ -1,16 +1,22 @@
 using System.Windows.Forms;
 using Bascanka.Core.Buffer;
+using Bascanka.Core.Macros;
+using Bascanka.Core.Search;
 
 namespace Bascanka.Editor.Macros;
 
 /// <summary>
-/// Replays a recorded <see cref="Macro"/> against an editor control by
-/// interpreting each <see cref="MacroAction"/> and applying the corresponding
-/// edit or navigation command to the provided <see cref="PieceTable"/> buffer.
+/// Replays a recorded <see cref="Macro"/> against a document.  The macro is
+/// compiled into buffer operations and run headlessly by a
+/// <see cref="MacroEngine"/> on a background thread; the player returns the
+/// resulting edits for the host to commit as one undoable bulk edit.
 /// <para>
-/// Playback is asynchronous and yields to the UI message loop between actions
-/// to keep the application responsive.  Playback can be cancelled at any time
-/// via <see cref="CancelPlayback"/>.
+/// The document must not be edited while playback runs — the host should
+/// make its editor read-only for the duration.  Progress is reported as a
+/// percentage only when it changes, and playback can be cancelled at any
+/// time via <see cref="CancelPlayback"/>, in which case no edits are
+/// returned.  A playback that fails raises <see cref="PlaybackError"/> and
+/// also returns no edits.
 /// </para>
 /// </summary>
 public sealed class MacroPlayer
@@ -27,10 +33,13 @@ public sealed class MacroPlayer
     /// <summary>Raised when playback completes or is cancelled.</summary>
     public event EventHandler? PlaybackFinished;
 
-    /// <summary>Raised after each action is executed during playback.</summary>
-    public event EventHandler<MacroPlaybackProgressEventArgs>? ActionExecuted;
+    /// <summary>
+    /// Raised on the calling thread's synchronization context when the
+    /// completed percentage changes.
+    /// </summary>
+    public event EventHandler<MacroPlaybackProgressEventArgs>? ProgressChanged;
 
-    /// <summary>Raised when an action fails during playback.</summary>
+    /// <summary>Raised when playback fails; no edits are returned.</summary>
     public event EventHandler<MacroPlaybackErrorEventArgs>? PlaybackError;
 
     // ── Properties ──────────────────────────────────────────────────────
@@ -41,81 +50,103 @@ public sealed class MacroPlayer
     // ── Playback API ────────────────────────────────────────────────────
 
     /// <summary>
-    /// Plays a macro once against the given <paramref name="buffer"/>.
-    /// Caret position management must be handled by the caller through
-    /// the <paramref name="caretOffset"/> ref parameter and the
-    /// <see cref="ActionExecuted"/> event.
+    /// Plays a macro once against <paramref name="buffer"/>.
     /// </summary>
     /// <param name="macro">The macro to replay.</param>
-    /// <param name="buffer">The text buffer to apply edits to.</param>
-    /// <param name="caretOffset">
-    /// The current caret offset; updated by movement and insertion actions.
-    /// </param>
-    public async Task PlayAsync(Macro macro, PieceTable buffer, long caretOffset)
-    {
-        await PlayMultipleAsync(macro, 1, buffer, caretOffset).ConfigureAwait(false);
-    }
+    /// <param name="buffer">The document to read; it is not modified.</param>
+    /// <param name="caretOffset">The caret offset playback starts from.</param>
+    /// <returns>
+    /// The edits and final caret, or <see langword="null"/> if playback was
+    /// cancelled.
+    /// </returns>
+    public Task<MacroRunResult?> PlayAsync(Macro macro, PieceTable buffer, long caretOffset) =>
+        PlayMultipleAsync(macro, 1, buffer, caretOffset);
 
     /// <summary>
     /// Plays a macro the specified number of times.
     /// </summary>
     /// <param name="macro">The macro to replay.</param>
     /// <param name="times">Number of repetitions (must be at least 1).</param>
-    /// <param name="buffer">The text buffer to apply edits to.</param>
+    /// <param name="buffer">The document to read; it is not modified.</param>
     /// <param name="caretOffset">The starting caret offset.</param>
-    public async Task PlayMultipleAsync(Macro macro, int times, PieceTable buffer, long caretOffset)
+    public Task<MacroRunResult?> PlayMultipleAsync(Macro macro, int times, PieceTable buffer, long caretOffset)
     {
-        ArgumentNullException.ThrowIfNull(macro);
-        ArgumentNullException.ThrowIfNull(buffer);
         if (times < 1)
             throw new ArgumentOutOfRangeException(nameof(times), times, "Must play at least once.");
 
+        return RunAsync(macro, buffer,
+            (engine, progress, token) => engine.Run(buffer, caretOffset, times, progress, token));
+    }
+
+    /// <summary>
+    /// Plays a macro repeatedly from <paramref name="caretOffset"/> until it
+    /// reaches the end of the document or stops making progress.
+    /// </summary>
+    /// <param name="macro">The macro to replay.</param>
+    /// <param name="buffer">The document to read; it is not modified.</param>
+    /// <param name="caretOffset">The starting caret offset.</param>
+    public Task<MacroRunResult?> PlayToEndAsync(Macro macro, PieceTable buffer, long caretOffset) =>
+        RunAsync(macro, buffer,
+            (engine, progress, token) => engine.RunToEnd(buffer, caretOffset, progress, token));
+
+    /// <summary>
+    /// Plays a macro once on every line that matches <paramref name="options"/>,
+    /// each line in isolation.  Matching lines are played in parallel and
+    /// their replacements returned in document order.
+    /// </summary>
+    /// <param name="macro">The macro to replay.</param>
+    /// <param name="buffer">The document to read; it is not modified.</param>
+    /// <param name="caretOffset">The caret offset to map through the edits.</param>
+    /// <param name="options">Selects the lines; only the pattern and its flags are used.</param>
+    public Task<MacroRunResult?> PlayOnMatchingLinesAsync(Macro macro, PieceTable buffer,
+        long caretOffset, SearchOptions options)
+    {
+        LinePredicate filter = SearchEngine.CreateLinePredicate(options);
+        return RunAsync(macro, buffer,
+            (engine, progress, token) => engine.RunOnMatchingLines(buffer, filter, caretOffset, progress, token));
+    }
+
+    /// <summary>
+    /// Cancels the currently running playback, if any.
+    /// </summary>
+    public void CancelPlayback()
+    {
+        _cts?.Cancel();
+    }
+
+    private async Task<MacroRunResult?> RunAsync(Macro macro, PieceTable buffer,
+        Func<MacroEngine, IProgress<int>, CancellationToken, MacroRunResult> run)
+    {
+        ArgumentNullException.ThrowIfNull(macro);
+        ArgumentNullException.ThrowIfNull(buffer);
+
         if (_cts is not null)
             throw new InvalidOperationException("A playback session is already in progress.");
 
         _cts = new CancellationTokenSource();
         CancellationToken token = _cts.Token;
+        MacroEngine engine = Compile(macro);
+
+        // Progress<T> captures the caller's context, so ProgressChanged is
+        // raised on the UI thread.
+        var progress = new Progress<int>(percent =>
+            ProgressChanged?.Invoke(this, new MacroPlaybackProgressEventArgs(percent)));
 
         PlaybackStarted?.Invoke(this, EventArgs.Empty);
 
+        Exception error;
         try
         {
-            long caret = caretOffset;
-            int totalActions = macro.Actions.Count * times;
-            int executedCount = 0;
-
-            for (int iteration = 0; iteration < times; iteration++)
-            {
-                for (int i = 0; i < macro.Actions.Count; i++)
-                {
-                    token.ThrowIfCancellationRequested();
-
-                    MacroAction action = macro.Actions[i];
-                    try
-                    {
-                        caret = ExecuteAction(action, buffer, caret);
-                    }
-                    catch (OperationCanceledException) { throw; }
-                    catch (Exception ex)
-                    {
-                        PlaybackError?.Invoke(this, new MacroPlaybackErrorEventArgs(action, i, ex));
-                        // Continue with next action unless cancelled.
-                    }
-
-                    executedCount++;
-                    ActionExecuted?.Invoke(this,
-                        new MacroPlaybackProgressEventArgs(action, executedCount, totalActions, caret));
-
-                    // Yield to the UI message loop every 64 actions to
-                    // keep the application responsive.
-                    if (executedCount % 64 == 0)
-                        await Task.Delay(1, token).ConfigureAwait(false);
-                }
-            }
+            return await Task.Run(() => run(engine, progress, token), token);
         }
         catch (OperationCanceledException)
         {
-            // Playback was cancelled -- fall through to finally.
+            return null;
+        }
+        catch (Exception ex)
+        {
+            // Parallel playback wraps failures; report the first one.
+            error = ex is AggregateException aggregate ? aggregate.Flatten().InnerExceptions[0] : ex;
         }
         finally
         {
@@ -123,215 +154,107 @@ public sealed class MacroPlayer
             _cts = null;
             PlaybackFinished?.Invoke(this, EventArgs.Empty);
         }
-    }
 
-    /// <summary>
-    /// Cancels the currently running playback, if any.
-    /// </summary>
-    public void CancelPlayback()
-    {
-        _cts?.Cancel();
+        if (error is not OperationCanceledException)
+            PlaybackError?.Invoke(this, new MacroPlaybackErrorEventArgs(error));
+        return null;
     }
 
-    // ── Action execution ────────────────────────────────────────────────
+    // ── Compilation ─────────────────────────────────────────────────────
 
     /// <summary>
-    /// Applies a single <see cref="MacroAction"/> to the buffer and returns
-    /// the updated caret offset.
+    /// Compiles a recorded macro into a <see cref="MacroEngine"/>.
+    /// <see cref="MacroActionType.Find"/> and
+    /// <see cref="MacroActionType.Command"/> actions are host-specific and
+    /// compile to nothing; so do keys with no caret movement.
     /// </summary>
-    private static long ExecuteAction(MacroAction action, PieceTable buffer, long caret)
+    public static MacroEngine Compile(Macro macro)
     {
-        switch (action.ActionType)
+        ArgumentNullException.ThrowIfNull(macro);
+
+        var ops = new List<MacroOp>(macro.Actions.Count);
+        foreach (MacroAction action in macro.Actions)
         {
-            case MacroActionType.TypeText:
-                if (action.Text is not null && action.Text.Length > 0)
-                {
-                    buffer.Insert(caret, action.Text);
-                    caret += action.Text.Length;
-                }
-                break;
-
-            case MacroActionType.Delete:
-                if (caret < buffer.Length)
-                    buffer.Delete(caret, 1);
-                break;
-
-            case MacroActionType.Backspace:
-                if (caret > 0)
-                {
-                    caret--;
-                    buffer.Delete(caret, 1);
-                }
-                break;
-
-            case MacroActionType.MoveCaret:
-                if (action.Offset.HasValue)
-                {
-                    caret = Math.Clamp(action.Offset.Value, 0, buffer.Length);
-                }
-                else if (action.Key.HasValue)
-                {
-                    caret = ApplyMovementKey(action.Key.Value, buffer, caret);
-                }
-                break;
-
-            case MacroActionType.Select:
-                // Selection is a UI-layer concept; the macro player records
-                // the target offset so that the host can update the visual
-                // selection after receiving the ActionExecuted event.
-                if (action.Offset.HasValue)
-                    caret = Math.Clamp(action.Offset.Value, 0, buffer.Length);
-                break;
-
-            case MacroActionType.Find:
-                // Find is informational during playback.  The host should
-                // listen for ActionExecuted and use the SearchEngine to
-                // locate the next match.
-                break;
-
-            case MacroActionType.Replace:
-                // Replace: extract search/replace text from parameters.
-                if (action.Parameters is not null &&
-                    action.Parameters.TryGetValue("SearchText", out string? searchText) &&
-                    action.Parameters.TryGetValue("ReplaceText", out string? replaceText) &&
-                    searchText is not null && replaceText is not null)
-                {
-                    string docText = buffer.Length > 0 ? buffer.GetText(0, buffer.Length) : "";
-                    int idx = docText.IndexOf(searchText, (int)Math.Min(caret, int.MaxValue),
-                        StringComparison.Ordinal);
-                    if (idx >= 0)
+            switch (action.ActionType)
+            {
+                case MacroActionType.TypeText when !string.IsNullOrEmpty(action.Text):
+                    ops.Add(MacroOp.Insert(action.Text));
+                    break;
+
+                case MacroActionType.Delete:
+                    ops.Add(MacroOp.Delete());
+                    break;
+
+                case MacroActionType.Backspace:
+                    ops.Add(MacroOp.Backspace());
+                    break;
+
+                case MacroActionType.MoveCaret when action.Offset.HasValue:
+                case MacroActionType.Select when action.Offset.HasValue:
+                    // Selection is a UI-layer concept; playback only moves
+                    // the caret to the recorded target.
+                    ops.Add(MacroOp.MoveTo(action.Offset.Value));
+                    break;
+
+                case MacroActionType.MoveCaret when action.Key.HasValue:
+                    if (CompileMovementKey(action.Key.Value) is { } move)
+                        ops.Add(move);
+                    break;
+
+                case MacroActionType.Replace:
+                    if (action.Parameters is not null &&
+                        action.Parameters.TryGetValue("SearchText", out string? searchText) &&
+                        action.Parameters.TryGetValue("ReplaceText", out string? replaceText) &&
+                        !string.IsNullOrEmpty(searchText) && replaceText is not null)
                     {
-                        buffer.Delete(idx, searchText.Length);
-                        buffer.Insert(idx, replaceText);
-                        caret = idx + replaceText.Length;
+                        ops.Add(MacroOp.Replace(searchText, replaceText));
                     }
-                }
-                break;
-
-            case MacroActionType.Command:
-                // Named commands are host-specific.  The host should listen
-                // for ActionExecuted and dispatch the command by name.
-                break;
+                    break;
+            }
         }
-
-        return caret;
+        return new MacroEngine(ops);
     }
 
     /// <summary>
     /// Translates a navigation <see cref="Keys"/> value into a caret
-    /// movement within the buffer.
+    /// movement, or <see langword="null"/> for keys that do not move it.
     /// </summary>
-    private static long ApplyMovementKey(Keys key, PieceTable buffer, long caret)
-    {
-        return key switch
-        {
-            Keys.Left => Math.Max(0, caret - 1),
-            Keys.Right => Math.Min(buffer.Length, caret + 1),
-            Keys.Home => 0,
-            Keys.End => buffer.Length,
-            Keys.Up => MoveUp(buffer, caret),
-            Keys.Down => MoveDown(buffer, caret),
-            _ => caret,
-        };
-    }
-
-    /// <summary>Moves the caret up one line, preserving approximate column position.</summary>
-    private static long MoveUp(PieceTable buffer, long caret)
-    {
-        // Find start of current line.
-        long lineStart = caret;
-        while (lineStart > 0 && buffer.GetCharAt(lineStart - 1) != '\n')
-            lineStart--;
-
-        if (lineStart == 0)
-            return 0; // Already on the first line.
-
-        long column = caret - lineStart;
-
-        // Find start of previous line.
-        long prevLineEnd = lineStart - 1; // the '\n' character
-        long prevLineStart = prevLineEnd;
-        while (prevLineStart > 0 && buffer.GetCharAt(prevLineStart - 1) != '\n')
-            prevLineStart--;
-
-        long prevLineLength = prevLineEnd - prevLineStart;
-        return prevLineStart + Math.Min(column, prevLineLength);
-    }
-
-    /// <summary>Moves the caret down one line, preserving approximate column position.</summary>
-    private static long MoveDown(PieceTable buffer, long caret)
+    private static MacroOp? CompileMovementKey(Keys key) => key switch
     {
-        // Find start of current line.
-        long lineStart = caret;
-        while (lineStart > 0 && buffer.GetCharAt(lineStart - 1) != '\n')
-            lineStart--;
-
-        long column = caret - lineStart;
-
-        // Find end of current line ('\n' or end of buffer).
-        long lineEnd = caret;
-        while (lineEnd < buffer.Length && buffer.GetCharAt(lineEnd) != '\n')
-            lineEnd++;
-
-        if (lineEnd >= buffer.Length)
-            return buffer.Length; // Already on the last line.
-
-        long nextLineStart = lineEnd + 1;
-
-        // Find end of next line.
-        long nextLineEnd = nextLineStart;
-        while (nextLineEnd < buffer.Length && buffer.GetCharAt(nextLineEnd) != '\n')
-            nextLineEnd++;
-
-        long nextLineLength = nextLineEnd - nextLineStart;
-        return nextLineStart + Math.Min(column, nextLineLength);
-    }
+        Keys.Left => MacroOp.MoveBy(-1),
+        Keys.Right => MacroOp.MoveBy(1),
+        Keys.Home => MacroOp.MoveToDocumentStart(),
+        Keys.End => MacroOp.MoveToDocumentEnd(),
+        Keys.Up => MacroOp.MoveLineUp(),
+        Keys.Down => MacroOp.MoveLineDown(),
+        _ => null,
+    };
 }
 
 /// <summary>
-/// Progress information emitted after each macro action is executed.
+/// Progress information emitted while a macro plays back.
 /// </summary>
 public sealed class MacroPlaybackProgressEventArgs : EventArgs
 {
-    /// <summary>The action that was just executed.</summary>
-    public MacroAction Action { get; }
+    /// <summary>Completed share of the playback, from 0 to 100.</summary>
+    public int Percent { get; }
 
-    /// <summary>Number of actions executed so far.</summary>
-    public int ExecutedCount { get; }
-
-    /// <summary>Total number of actions in the playback session.</summary>
-    public int TotalCount { get; }
-
-    /// <summary>The caret offset after execution.</summary>
-    public long CaretOffset { get; }
-
-    public MacroPlaybackProgressEventArgs(MacroAction action, int executedCount, int totalCount, long caretOffset)
+    public MacroPlaybackProgressEventArgs(int percent)
     {
-        Action = action;
-        ExecutedCount = executedCount;
-        TotalCount = totalCount;
-        CaretOffset = caretOffset;
+        Percent = percent;
     }
 }
 
 /// <summary>
-/// Information about an error that occurred while executing a macro action.
+/// Information about an error that stopped a macro playback.
 /// </summary>
 public sealed class MacroPlaybackErrorEventArgs : EventArgs
 {
-    /// <summary>The action that caused the error.</summary>
-    public MacroAction Action { get; }
-
-    /// <summary>Zero-based index of the action within the macro.</summary>
-    public int ActionIndex { get; }
-
     /// <summary>The exception that was thrown.</summary>
     public Exception Exception { get; }
 
-    public MacroPlaybackErrorEventArgs(MacroAction action, int actionIndex, Exception exception)
+    public MacroPlaybackErrorEventArgs(Exception exception)
     {
-        Action = action;
-        ActionIndex = actionIndex;
         Exception = exception;
     }
 }
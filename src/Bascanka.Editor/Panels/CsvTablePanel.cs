@@ -0,0 +1,498 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Navigation;
+using Bascanka.Editor.Controls;
+using Bascanka.Editor.Themes;
+
+namespace Bascanka.Editor.Panels;
+
+/// <summary>
+/// A bottom panel that shows a CSV or TSV document as a table with aligned
+/// columns.  The grid runs in virtual mode: only the visible rows are read
+/// from the document, through a <see cref="CsvFieldIndex"/> that is built in
+/// the background and rebuilt after edits.
+/// <para>
+/// <see cref="DataGridView"/> keeps state for every row it has, so it is
+/// given at most <see cref="PageRows"/> rows at a time: larger documents are
+/// shown a page at a time, with toolbar buttons to move between pages.
+/// </para>
+/// <para>
+/// Column headers offer sorting and statistics, cells offer filtering by
+/// their value.  Sorting and filtering rewrite the document, so the panel
+/// only raises requests for them; the host runs them as transforms.
+/// </para>
+/// </summary>
+public class CsvTablePanel : UserControl
+{
+    // ── Constants ─────────────────────────────────────────────────────
+    private const int RowCacheSize = 1024;
+    private const int PageRows = 100_000;
+    private const int MinColumnWidth = 48;
+    private const int MaxColumnWidth = 480;
+
+    // ── Controls ──────────────────────────────────────────────────────
+    private readonly Panel _toolbar;
+    private readonly Label _statusLabel;
+    private readonly CheckBox _headerCheckBox;
+    private readonly Button _previousPageButton;
+    private readonly Button _nextPageButton;
+    private readonly DataGridView _grid;
+    private readonly ContextMenuStrip _columnMenu;
+    private readonly ContextMenuStrip _cellMenu;
+    private readonly ToolStripMenuItem _sortAscendingItem;
+    private readonly ToolStripMenuItem _sortDescendingItem;
+    private readonly ToolStripMenuItem _sortNumericAscendingItem;
+    private readonly ToolStripMenuItem _sortNumericDescendingItem;
+    private readonly ToolStripMenuItem _filterItem;
+
+    // ── State ─────────────────────────────────────────────────────────
+    private readonly DocumentIndexer<CsvFieldIndex> _indexer;
+    private readonly Dictionary<int, string[]> _rowCache = [];
+    private CsvDialect _dialect = CsvDialect.Comma;
+    private long _pageStart;
+    private CancellationTokenSource? _statisticsCts;
+    private ITheme? _theme;
+    private int _menuColumn;
+    private int _menuRow;
+
+    // ── Events ────────────────────────────────────────────────────────
+
+    /// <summary>Raised when the user double-clicks a row to show it in the editor.</summary>
+    public event EventHandler<CsvLineEventArgs>? NavigateToLine;
+
+    /// <summary>Raised when the user asks to sort the document by a column.</summary>
+    public event EventHandler<CsvSortRequestEventArgs>? SortRequested;
+
+    /// <summary>Raised when the user asks to keep only the rows with a cell's value.</summary>
+    public event EventHandler<CsvFilterRequestEventArgs>? FilterRequested;
+
+    // ── Construction ──────────────────────────────────────────────────
+
+    public CsvTablePanel()
+    {
+        Dock = DockStyle.Fill;
+
+        _indexer = new DocumentIndexer<CsvFieldIndex>(
+            (snapshot, ct) => CsvFieldIndex.Build(snapshot, _dialect, null, ct));
+        _indexer.IndexChanged += (_, _) => Reload();
+
+        // ── Toolbar ───────────────────────────────────────────────────
+        _statusLabel = new Label
+        {
+            Dock = DockStyle.Fill,
+            TextAlign = ContentAlignment.MiddleLeft,
+            AutoEllipsis = true,
+        };
+        _headerCheckBox = new CheckBox
+        {
+            Dock = DockStyle.Right,
+            Text = "First row is header",
+            Checked = true,
+            AutoSize = true,
+        };
+        _headerCheckBox.CheckedChanged += (_, _) => Reload();
+        _previousPageButton = new Button
+        {
+            Dock = DockStyle.Right,
+            Text = "◀",
+            Width = 28,
+            FlatStyle = FlatStyle.Flat,
+            Visible = false,
+        };
+        _previousPageButton.Click += (_, _) => ShowPage(_pageStart - PageRows);
+        _nextPageButton = new Button
+        {
+            Dock = DockStyle.Right,
+            Text = "▶",
+            Width = 28,
+            FlatStyle = FlatStyle.Flat,
+            Visible = false,
+        };
+        _nextPageButton.Click += (_, _) => ShowPage(_pageStart + PageRows);
+        _toolbar = new Panel { Dock = DockStyle.Top, Height = 24, Padding = new Padding(4, 0, 4, 0) };
+        _toolbar.Controls.Add(_statusLabel);
+        _toolbar.Controls.Add(_previousPageButton);
+        _toolbar.Controls.Add(_nextPageButton);
+        _toolbar.Controls.Add(_headerCheckBox);
+
+        // ── Grid ──────────────────────────────────────────────────────
+        _grid = new DataGridView
+        {
+            Dock = DockStyle.Fill,
+            VirtualMode = true,
+            ReadOnly = true,
+            AllowUserToAddRows = false,
+            AllowUserToDeleteRows = false,
+            AllowUserToResizeRows = false,
+            AllowUserToOrderColumns = false,
+            RowHeadersVisible = false,
+            SelectionMode = DataGridViewSelectionMode.CellSelect,
+            BorderStyle = BorderStyle.None,
+            EnableHeadersVisualStyles = false,
+            ColumnHeadersHeightSizeMode = DataGridViewColumnHeadersHeightSizeMode.DisableResizing,
+        };
+        _grid.RowTemplate.Height = 20;
+        _grid.CellValueNeeded += OnCellValueNeeded;
+        _grid.CellDoubleClick += OnCellDoubleClick;
+        _grid.CellMouseClick += OnCellMouseClick;
+
+        // ── Context menus ─────────────────────────────────────────────
+        _sortAscendingItem = new ToolStripMenuItem("Sort Ascending", null, (_, _) => RequestSort(false, false));
+        _sortDescendingItem = new ToolStripMenuItem("Sort Descending", null, (_, _) => RequestSort(true, false));
+        _sortNumericAscendingItem = new ToolStripMenuItem("Sort Numerically Ascending", null, (_, _) => RequestSort(false, true));
+        _sortNumericDescendingItem = new ToolStripMenuItem("Sort Numerically Descending", null, (_, _) => RequestSort(true, true));
+        _columnMenu = new ContextMenuStrip();
+        _columnMenu.Items.AddRange(new ToolStripItem[]
+        {
+            _sortAscendingItem,
+            _sortDescendingItem,
+            _sortNumericAscendingItem,
+            _sortNumericDescendingItem,
+            new ToolStripSeparator(),
+            new ToolStripMenuItem("Column Statistics", null, (_, _) => ShowStatistics(_menuColumn)),
+        });
+
+        _filterItem = new ToolStripMenuItem("Keep Rows with This Value", null, (_, _) => RequestFilter());
+        _cellMenu = new ContextMenuStrip();
+        _cellMenu.Items.AddRange(new ToolStripItem[]
+        {
+            new ToolStripMenuItem("Go to Line", null, (_, _) => Navigate(_menuRow)),
+            _filterItem,
+            new ToolStripSeparator(),
+            new ToolStripMenuItem("Column Statistics", null, (_, _) => ShowStatistics(_menuColumn)),
+        });
+
+        // ── Layout ────────────────────────────────────────────────────
+        Controls.Add(_grid);
+        Controls.Add(_toolbar);
+        Reload();
+    }
+
+    // ── Public API ────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Shows <paramref name="document"/> split with <paramref name="dialect"/>,
+    /// or nothing when <paramref name="document"/> is <see langword="null"/>.
+    /// </summary>
+    public void Attach(PieceTable? document, CsvDialect dialect)
+    {
+        ArgumentNullException.ThrowIfNull(dialect);
+        if (ReferenceEquals(document, _indexer.Document)
+            && dialect.Separator == _dialect.Separator && dialect.Quote == _dialect.Quote)
+            return;
+
+        _dialect = dialect;
+        _pageStart = 0;
+        _indexer.Document = null;
+        _indexer.Document = document;
+    }
+
+    /// <summary>The dialect the document is split with.</summary>
+    public CsvDialect Dialect => _dialect;
+
+    /// <summary>Whether the first record holds the column names.</summary>
+    public bool FirstRowIsHeader => _headerCheckBox.Checked;
+
+    /// <summary>
+    /// Whether sorting and filtering are available: they work line by line,
+    /// so not on documents with quoted line breaks.
+    /// </summary>
+    public bool CanRewriteByLine => _indexer.Index is { HasMultilineRecords: false };
+
+    /// <summary>
+    /// The theme used for rendering panel colours.
+    /// </summary>
+    public ITheme? Theme
+    {
+        get => _theme;
+        set
+        {
+            _theme = value;
+            ApplyTheme();
+        }
+    }
+
+    // ── Rows ──────────────────────────────────────────────────────────
+
+    private long FirstDataRecord => FirstRowIsHeader ? 1 : 0;
+
+    /// <summary>The record shown in a row of the grid.</summary>
+    private long RecordAt(int row) => _pageStart + row + FirstDataRecord;
+
+    /// <summary>Shows the page of rows starting at data row <paramref name="start"/>.</summary>
+    private void ShowPage(long start)
+    {
+        _pageStart = Math.Max(start, 0);
+        Reload();
+    }
+
+    /// <summary>Rebuilds the columns and row count from the current index.</summary>
+    private void Reload()
+    {
+        _rowCache.Clear();
+        _grid.RowCount = 0;
+        _grid.Columns.Clear();
+
+        if (_indexer.Index is not { } index || _indexer.Document is not { } document)
+        {
+            _statusLabel.Text = _indexer.Document is null ? string.Empty : "Indexing…";
+            _previousPageButton.Visible = _nextPageButton.Visible = false;
+            return;
+        }
+
+        string[] names = FirstRowIsHeader && index.RecordCount > 0
+            ? index.ReadRecord(document, 0)
+            : [];
+        float charWidth = TextRenderer.MeasureText("0000000000", _grid.Font).Width / 10f;
+
+        _grid.Columns.Add(new DataGridViewTextBoxColumn
+        {
+            HeaderText = "Line",
+            Width = Math.Max(MinColumnWidth, (int)(charWidth * (index.LineCount.ToString().Length + 2))),
+            SortMode = DataGridViewColumnSortMode.NotSortable,
+            Frozen = true,
+        });
+        for (int c = 0; c < index.ColumnCount; c++)
+        {
+            string name = c < names.Length && names[c].Length > 0 ? names[c] : $"Column {c + 1}";
+            int chars = Math.Max(c < index.ColumnWidths.Count ? index.ColumnWidths[c] : 0, name.Length);
+            _grid.Columns.Add(new DataGridViewTextBoxColumn
+            {
+                HeaderText = name,
+                Width = Math.Clamp((int)(charWidth * (chars + 2)), MinColumnWidth, MaxColumnWidth),
+                SortMode = DataGridViewColumnSortMode.NotSortable,
+            });
+        }
+
+        long rows = Math.Max(index.RecordCount - FirstDataRecord, 0);
+        // Keep the page after edits, unless the rows it showed are gone.
+        if (_pageStart >= rows)
+            _pageStart = Math.Max(rows - 1, 0) / PageRows * PageRows;
+        int pageRows = (int)Math.Min(rows - _pageStart, PageRows);
+        _grid.RowCount = pageRows;
+
+        bool paged = rows > PageRows;
+        _previousPageButton.Visible = _nextPageButton.Visible = paged;
+        _previousPageButton.Enabled = _pageStart > 0;
+        _nextPageButton.Enabled = _pageStart + pageRows < rows;
+        string shown = paged
+            ? $"rows {_pageStart + 1:N0}–{_pageStart + pageRows:N0} of {rows:N0}"
+            : $"{rows:N0} rows";
+        _statusLabel.Text = $"{shown} · {index.ColumnCount:N0} columns · {index.Dialect}"
+            + (index.HasMultilineRecords ? " · quoted line breaks: sort and filter are off" : string.Empty);
+    }
+
+    private void OnCellValueNeeded(object? sender, DataGridViewCellValueEventArgs e)
+    {
+        if (_indexer.Index is not { } index || _indexer.Document is not { } document) return;
+
+        long record = RecordAt(e.RowIndex);
+        if (record >= index.RecordCount) return;
+        if (e.ColumnIndex == 0)
+        {
+            e.Value = (index.GetRecordLine(record) + 1).ToString("N0");
+            return;
+        }
+
+        if (!_rowCache.TryGetValue(e.RowIndex, out string[]? fields))
+        {
+            if (_rowCache.Count >= RowCacheSize)
+                _rowCache.Clear();
+            fields = index.ReadRecord(document, record);
+            _rowCache[e.RowIndex] = fields;
+        }
+
+        int column = e.ColumnIndex - 1;
+        e.Value = column < fields.Length ? fields[column].Replace('\n', '↵') : string.Empty;
+    }
+
+    // ── Mouse handling ────────────────────────────────────────────────
+
+    private void OnCellDoubleClick(object? sender, DataGridViewCellEventArgs e)
+    {
+        if (e.RowIndex >= 0)
+            Navigate(e.RowIndex);
+    }
+
+    private void OnCellMouseClick(object? sender, DataGridViewCellMouseEventArgs e)
+    {
+        if (e.Button != MouseButtons.Right || e.ColumnIndex < 1) return;
+
+        _menuColumn = e.ColumnIndex - 1;
+        _menuRow = e.RowIndex;
+        bool canRewrite = CanRewriteByLine;
+        Point location = _grid.PointToClient(Cursor.Position);
+        if (e.RowIndex < 0)
+        {
+            _sortAscendingItem.Enabled = canRewrite;
+            _sortDescendingItem.Enabled = canRewrite;
+            _sortNumericAscendingItem.Enabled = canRewrite;
+            _sortNumericDescendingItem.Enabled = canRewrite;
+            _columnMenu.Show(_grid, location);
+        }
+        else
+        {
+            _grid.CurrentCell = _grid[e.ColumnIndex, e.RowIndex];
+            _filterItem.Enabled = canRewrite;
+            _cellMenu.Show(_grid, location);
+        }
+    }
+
+    private void Navigate(int row)
+    {
+        if (_indexer.Index is not { } index || row < 0) return;
+        long record = RecordAt(row);
+        if (record >= index.RecordCount) return;
+        NavigateToLine?.Invoke(this, new CsvLineEventArgs(index.GetRecordLine(record)));
+    }
+
+    private void RequestSort(bool descending, bool numeric)
+    {
+        if (!CanRewriteByLine) return;
+        SortRequested?.Invoke(this, new CsvSortRequestEventArgs(_menuColumn, descending, numeric));
+    }
+
+    private void RequestFilter()
+    {
+        if (!CanRewriteByLine || _indexer.Index is not { } index || _indexer.Document is not { } document) return;
+
+        long record = RecordAt(_menuRow);
+        if (record >= index.RecordCount) return;
+        string[] fields = index.ReadRecord(document, record);
+        string value = _menuColumn < fields.Length ? fields[_menuColumn] : string.Empty;
+        FilterRequested?.Invoke(this, new CsvFilterRequestEventArgs(_menuColumn, value));
+    }
+
+    // ── Statistics ────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Computes the statistics of a column on a snapshot of the document
+    /// in the background and shows them in the toolbar.
+    /// </summary>
+    private async void ShowStatistics(int column)
+    {
+        if (_indexer.Index is not { } index || _indexer.Document is not { } document) return;
+
+        _statisticsCts?.Cancel();
+        var cts = new CancellationTokenSource();
+        _statisticsCts = cts;
+
+        string name = _grid.Columns[column + 1].HeaderText;
+        bool skipHeader = FirstRowIsHeader;
+        PieceTable snapshot = document.CreateSnapshot();
+        var progress = new Progress<int>(percent =>
+        {
+            if (!cts.IsCancellationRequested)
+                _statusLabel.Text = $"{name}: computing statistics… {percent}%";
+        });
+        try
+        {
+            var stats = await Task.Run(() =>
+                CsvColumnStatistics.Compute(snapshot, index, column, skipHeader, progress, cts.Token));
+            if (cts.IsCancellationRequested || !ReferenceEquals(index, _indexer.Index)) return;
+
+            string distinct = stats.IsDistinctCountExact ? $"{stats.DistinctCount:N0}" : $"~{stats.DistinctCount:N0}";
+            string range = stats.IsNumeric
+                ? $"min {stats.NumericMin:G} · max {stats.NumericMax:G}"
+                : $"min “{stats.Min}” · max “{stats.Max}”";
+            _statusLabel.Text = $"{name}: {stats.Count:N0} values · {stats.EmptyCount:N0} empty · "
+                + $"{distinct} distinct · {range}";
+        }
+        catch (OperationCanceledException)
+        {
+        }
+        catch (ObjectDisposedException)
+        {
+            // The document was closed while the statistics were computed.
+        }
+        catch (Exception ex)
+        {
+            if (!cts.IsCancellationRequested && !IsDisposed)
+                _statusLabel.Text = $"{name}: {ex.Message}";
+        }
+        finally
+        {
+            if (ReferenceEquals(_statisticsCts, cts))
+                _statisticsCts = null;
+            cts.Dispose();
+        }
+    }
+
+    // ── Theme ─────────────────────────────────────────────────────────
+
+    private void ApplyTheme()
+    {
+        if (_theme is null) return;
+
+        BackColor = _theme.EditorBackground;
+        ForeColor = _theme.EditorForeground;
+        _toolbar.BackColor = _theme.FindPanelBackground;
+        _statusLabel.ForeColor = _theme.FindPanelForeground;
+        _headerCheckBox.ForeColor = _theme.FindPanelForeground;
+        foreach (Button button in new[] { _previousPageButton, _nextPageButton })
+        {
+            button.BackColor = _theme.FindPanelBackground;
+            button.ForeColor = _theme.FindPanelForeground;
+            button.FlatAppearance.BorderColor = _theme.TabBorder;
+        }
+        _grid.BackgroundColor = _theme.EditorBackground;
+        _grid.GridColor = _theme.TabBorder;
+        _grid.DefaultCellStyle.BackColor = _theme.EditorBackground;
+        _grid.DefaultCellStyle.ForeColor = _theme.EditorForeground;
+        _grid.DefaultCellStyle.SelectionBackColor = _theme.SelectionBackground;
+        _grid.DefaultCellStyle.SelectionForeColor = _theme.SelectionForeground;
+        _grid.ColumnHeadersDefaultCellStyle.BackColor = _theme.TabInactiveBackground;
+        _grid.ColumnHeadersDefaultCellStyle.ForeColor = _theme.TabInactiveForeground;
+
+        Invalidate(true);
+    }
+
+    // ── Disposal ──────────────────────────────────────────────────────
+
+    protected override void Dispose(bool disposing)
+    {
+        if (disposing)
+        {
+            _statisticsCts?.Cancel();
+            _indexer.Dispose();
+            _columnMenu.Dispose();
+            _cellMenu.Dispose();
+        }
+        base.Dispose(disposing);
+    }
+}
+
+/// <summary>
+/// Event arguments naming a document line.
+/// </summary>
+public sealed class CsvLineEventArgs(long line) : EventArgs
+{
+    /// <summary>Zero-based line number.</summary>
+    public long Line { get; } = line;
+}
+
+/// <summary>
+/// Event arguments for a request to sort the document by a column.
+/// </summary>
+public sealed class CsvSortRequestEventArgs(int column, bool descending, bool numeric) : EventArgs
+{
+    /// <summary>Zero-based column.</summary>
+    public int Column { get; } = column;
+
+    /// <summary>Sort from the largest value to the smallest.</summary>
+    public bool Descending { get; } = descending;
+
+    /// <summary>Compare values as numbers.</summary>
+    public bool Numeric { get; } = numeric;
+}
+
+/// <summary>
+/// Event arguments for a request to keep only the rows with a value in a column.
+/// </summary>
+public sealed class CsvFilterRequestEventArgs(int column, string value) : EventArgs
+{
+    /// <summary>Zero-based column.</summary>
+    public int Column { get; } = column;
+
+    /// <summary>The value rows must have in <see cref="Column"/>.</summary>
+    public string Value { get; } = value;
+}
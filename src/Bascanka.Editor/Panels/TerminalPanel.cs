@@ -2,6 +2,7 @@ using System.Drawing;
 using System.Drawing.Text;
 using System.Runtime.InteropServices;
 using System.Text;
+using Bascanka.Core.Terminal;
 using Bascanka.Editor.Themes;
 using Microsoft.Win32.SafeHandles;
 
@@ -120,14 +121,6 @@ public partial class TerminalPanel : UserControl
         Color.FromArgb(242, 242, 242),   // 15 Bright White
     ];
 
-    // ── Cell Attribute ────────────────────────────────────────────────
-
-    private struct CellAttr
-    {
-        public byte Fg, Bg;
-        public bool Bold, Underline, Reverse;
-    }
-
     // ── Fields ────────────────────────────────────────────────────────
 
     // ConPTY handles
@@ -138,32 +131,16 @@ public partial class TerminalPanel : UserControl
     private volatile bool _isRunning;
     private ITheme? _theme;
 
-    // Screen buffer
-    private char[] _chars = [];
-    private CellAttr[] _attrs = [];
+    // Screen state.  Output is parsed on the read thread; the emulator is
+    // only touched under _screenLock.
+    private readonly object _screenLock = new();
+    private readonly TerminalEmulator _terminal = new(80, 24);
     private int _cols = 80, _rows = 24;
-
-    // Cursor & scroll region
-    private int _cursorRow, _cursorCol;
-    private CellAttr _currentAttr;
-    private bool _cursorVisible = true;
-    private int _savedCursorRow, _savedCursorCol;
-    private int _scrollTop, _scrollBottom;
-
-    // Wide-character continuation sentinel (placed in the trailing cell).
-    private const char WideCharCont = '\uFFFF';
-
-    // Scrollback
-    private readonly List<char[]> _scrollbackChars = new();
-    private readonly List<CellAttr[]> _scrollbackAttrs = new();
-    private const int ScrollbackMax = 5000;
     private int _viewOffset; // 0 = live view
+    private int _repaintPending;
 
-    // VT parser
-    private enum VtState { Normal, Escape, Csi, Osc, OscEsc }
-    private VtState _vtState;
-    private readonly StringBuilder _csiParams = new();
-    private bool _csiPrivate;
+    // Visible rows copied out of the emulator so painting runs unlocked.
+    private TerminalCell[] _paintCells = [];
 
     // Rendering
     public const int DefaultTerminalPadding = 6;
@@ -185,10 +162,6 @@ public partial class TerminalPanel : UserControl
         _termFont = new Font("Consolas", 10f, FontStyle.Regular);
         MeasureCell();
 
-        _currentAttr = new CellAttr { Fg = 7, Bg = 0 };
-        _scrollBottom = _rows - 1;
-        InitBuffer();
-
         _caretTimer = new System.Windows.Forms.Timer { Interval = 530 };
         _caretTimer.Tick += (_, _) => { _caretOn = !_caretOn; InvalidateCursor(); };
         _caretTimer.Start();
@@ -313,18 +286,26 @@ public partial class TerminalPanel : UserControl
 
     private void ReadLoop()
     {
-        var buf = new byte[4096];
+        var buf = new byte[64 * 1024];
+        var chars = new char[Encoding.UTF8.GetMaxCharCount(buf.Length)];
+        // A stateful decoder keeps UTF-8 sequences split across reads intact.
+        Decoder decoder = Encoding.UTF8.GetDecoder();
         try
         {
             while (_isRunning && _outputStream is not null)
             {
                 int n = _outputStream.Read(buf, 0, buf.Length);
                 if (n <= 0) break;
-                string text = Encoding.UTF8.GetString(buf, 0, n);
+                int count = decoder.GetChars(buf, 0, n, chars, 0);
 
-                if (IsHandleCreated && !IsDisposed)
+                lock (_screenLock)
+                    _terminal.Write(chars.AsSpan(0, count));
+
+                // At most one repaint is queued however fast output arrives.
+                if (IsHandleCreated && !IsDisposed &&
+                    Interlocked.Exchange(ref _repaintPending, 1) == 0)
                 {
-                    try { BeginInvoke(() => ProcessVtOutput(text)); }
+                    try { BeginInvoke(OnOutputProcessed); }
                     catch { break; }
                 }
             }
@@ -334,394 +315,13 @@ public partial class TerminalPanel : UserControl
         _isRunning = false;
     }
 
-    // ── VT100 Parser ──────────────────────────────────────────────────
-
-    private void ProcessVtOutput(string text)
+    private void OnOutputProcessed()
     {
-        foreach (char c in text)
-        {
-            switch (_vtState)
-            {
-                case VtState.Normal:  HandleNormal(c); break;
-                case VtState.Escape:  HandleEscape(c); break;
-                case VtState.Csi:     HandleCsi(c);    break;
-                case VtState.Osc:     HandleOsc(c);    break;
-                case VtState.OscEsc:  _vtState = VtState.Normal; break; // ST
-            }
-        }
+        Volatile.Write(ref _repaintPending, 0);
         _viewOffset = 0;
         Invalidate();
     }
 
-    private void HandleNormal(char c)
-    {
-        switch (c)
-        {
-            case '\x1B': _vtState = VtState.Escape; break;
-            case '\r':   _cursorCol = 0; break;
-            case '\n':   LineFeed(); break;
-            case '\b':   if (_cursorCol > 0) _cursorCol--; break;
-            case '\t':   _cursorCol = Math.Min((_cursorCol / 8 + 1) * 8, _cols - 1); break;
-            case '\x07': break; // BEL
-            default:
-                if (c >= ' ') PutChar(c);
-                break;
-        }
-    }
-
-    private void HandleEscape(char c)
-    {
-        _vtState = VtState.Normal;
-        switch (c)
-        {
-            case '[':
-                _vtState = VtState.Csi;
-                _csiParams.Clear();
-                _csiPrivate = false;
-                break;
-            case ']': _vtState = VtState.Osc; break;
-            case '7': _savedCursorRow = _cursorRow; _savedCursorCol = _cursorCol; break;
-            case '8': _cursorRow = _savedCursorRow; _cursorCol = _savedCursorCol; break;
-            case 'M': // Reverse index
-                if (_cursorRow == _scrollTop) ScrollDown();
-                else if (_cursorRow > 0) _cursorRow--;
-                break;
-            case 'D': LineFeed(); break;
-            case 'E': _cursorCol = 0; LineFeed(); break;
-            case 'c': ResetTerminal(); break;
-        }
-    }
-
-    private void HandleCsi(char c)
-    {
-        if (c == '?') { _csiPrivate = true; return; }
-        if ((c >= '0' && c <= '9') || c == ';') { _csiParams.Append(c); return; }
-        ExecuteCsi(c);
-        _vtState = VtState.Normal;
-    }
-
-    private void HandleOsc(char c)
-    {
-        if (c == '\x07') _vtState = VtState.Normal;      // BEL terminates
-        else if (c == '\x1B') _vtState = VtState.OscEsc;  // ESC \ terminates
-    }
-
-    // ── CSI Execution ─────────────────────────────────────────────────
-
-    private int[] GetParams()
-    {
-        if (_csiParams.Length == 0) return [];
-        var parts = _csiParams.ToString().Split(';');
-        var r = new int[parts.Length];
-        for (int i = 0; i < parts.Length; i++) int.TryParse(parts[i], out r[i]);
-        return r;
-    }
-
-    private void ExecuteCsi(char cmd)
-    {
-        var p = GetParams();
-        int p0 = p.Length > 0 && p[0] > 0 ? p[0] : 1;
-        int p1 = p.Length > 1 && p[1] > 0 ? p[1] : 1;
-
-        if (_csiPrivate)
-        {
-            int v = p.Length > 0 ? p[0] : 0;
-            if (cmd == 'h' && v == 25) _cursorVisible = true;
-            if (cmd == 'l' && v == 25) _cursorVisible = false;
-            return;
-        }
-
-        switch (cmd)
-        {
-            case 'A': _cursorRow = Math.Max(_scrollTop, _cursorRow - p0); break;
-            case 'B': _cursorRow = Math.Min(_scrollBottom, _cursorRow + p0); break;
-            case 'C': _cursorCol = Math.Min(_cols - 1, _cursorCol + p0); break;
-            case 'D': _cursorCol = Math.Max(0, _cursorCol - p0); break;
-            case 'E': _cursorCol = 0; _cursorRow = Math.Min(_scrollBottom, _cursorRow + p0); break;
-            case 'F': _cursorCol = 0; _cursorRow = Math.Max(_scrollTop, _cursorRow - p0); break;
-            case 'G': _cursorCol = Math.Clamp(p0 - 1, 0, _cols - 1); break;
-            case 'H' or 'f':
-                _cursorRow = Math.Clamp(p0 - 1, 0, _rows - 1);
-                _cursorCol = Math.Clamp(p1 - 1, 0, _cols - 1);
-                break;
-            case 'J': EraseDisplay(p.Length > 0 ? p[0] : 0); break;
-            case 'K': EraseLine(p.Length > 0 ? p[0] : 0); break;
-            case 'L': InsertLines(p0); break;
-            case 'M': DeleteLines(p0); break;
-            case 'P': DeleteChars(p0); break;
-            case '@': InsertChars(p0); break;
-            case 'S': for (int i = 0; i < p0; i++) ScrollUp(); break;
-            case 'T': for (int i = 0; i < p0; i++) ScrollDown(); break;
-            case 'd': _cursorRow = Math.Clamp(p0 - 1, 0, _rows - 1); break;
-            case 'm': ExecuteSgr(p); break;
-            case 'r':
-                _scrollTop = Math.Clamp(p0 - 1, 0, _rows - 1);
-                _scrollBottom = Math.Clamp((p.Length > 1 && p[1] > 0 ? p[1] : _rows) - 1, 0, _rows - 1);
-                _cursorRow = _scrollTop; _cursorCol = 0;
-                break;
-            case 's': _savedCursorRow = _cursorRow; _savedCursorCol = _cursorCol; break;
-            case 'u': _cursorRow = _savedCursorRow; _cursorCol = _savedCursorCol; break;
-            case 'X': // Erase characters
-                for (int i = 0; i < p0 && _cursorCol + i < _cols; i++)
-                {
-                    int idx = _cursorRow * _cols + _cursorCol + i;
-                    _chars[idx] = ' '; _attrs[idx] = _currentAttr;
-                }
-                break;
-        }
-    }
-
-    // ── SGR (Select Graphic Rendition) ────────────────────────────────
-
-    private void ExecuteSgr(int[] p)
-    {
-        if (p.Length == 0) { _currentAttr = new CellAttr { Fg = 7, Bg = 0 }; return; }
-
-        for (int i = 0; i < p.Length; i++)
-        {
-            switch (p[i])
-            {
-                case 0:  _currentAttr = new CellAttr { Fg = 7, Bg = 0 }; break;
-                case 1:  _currentAttr.Bold = true; break;
-                case 4:  _currentAttr.Underline = true; break;
-                case 7:  _currentAttr.Reverse = true; break;
-                case 22: _currentAttr.Bold = false; break;
-                case 24: _currentAttr.Underline = false; break;
-                case 27: _currentAttr.Reverse = false; break;
-                case >= 30 and <= 37: _currentAttr.Fg = (byte)(p[i] - 30); break;
-                case 38:
-                    if (i + 2 < p.Length && p[i + 1] == 5) { _currentAttr.Fg = Map256(p[i + 2]); i += 2; }
-                    else if (i + 4 < p.Length && p[i + 1] == 2) i += 4;
-                    break;
-                case 39: _currentAttr.Fg = 7; break;
-                case >= 40 and <= 47: _currentAttr.Bg = (byte)(p[i] - 40); break;
-                case 48:
-                    if (i + 2 < p.Length && p[i + 1] == 5) { _currentAttr.Bg = Map256(p[i + 2]); i += 2; }
-                    else if (i + 4 < p.Length && p[i + 1] == 2) i += 4;
-                    break;
-                case 49: _currentAttr.Bg = 0; break;
-                case >= 90 and <= 97:   _currentAttr.Fg = (byte)(p[i] - 90 + 8); break;
-                case >= 100 and <= 107: _currentAttr.Bg = (byte)(p[i] - 100 + 8); break;
-            }
-        }
-    }
-
-    private static byte Map256(int c)
-    {
-        if (c < 16) return (byte)c;
-        if (c >= 232) { int g = (c - 232) * 10 + 8; return g < 128 ? (byte)0 : (byte)7; }
-        return (byte)(c < 128 ? 0 : 7);
-    }
-
-    // ── Buffer Operations ─────────────────────────────────────────────
-
-    private void InitBuffer()
-    {
-        int sz = _rows * _cols;
-        _chars = new char[sz];
-        _attrs = new CellAttr[sz];
-        Array.Fill(_chars, ' ');
-        Array.Fill(_attrs, new CellAttr { Fg = 7, Bg = 0 });
-    }
-
-    private void PutChar(char c)
-    {
-        bool wide = IsFullWidth(c);
-
-        if (wide && _cursorCol >= _cols - 1)
-        {
-            // Wide char won't fit on the remainder of this line — blank
-            // the last cell (if any) and wrap to the next line.
-            if (_cursorCol < _cols)
-            {
-                int idx0 = _cursorRow * _cols + _cursorCol;
-                _chars[idx0] = ' '; _attrs[idx0] = _currentAttr;
-            }
-            _cursorCol = 0; LineFeed();
-        }
-        else if (_cursorCol >= _cols)
-        {
-            _cursorCol = 0; LineFeed();
-        }
-
-        int idx = _cursorRow * _cols + _cursorCol;
-
-        // If we're overwriting the trailing half of a previous wide char,
-        // blank its leading half so it doesn't render as a partial glyph.
-        if (_chars[idx] == WideCharCont && _cursorCol > 0)
-            _chars[idx - 1] = ' ';
-
-        // If we're overwriting the leading half of a wide char, blank
-        // its trailing continuation cell.
-        if (_cursorCol + 1 < _cols && _chars[idx + 1] == WideCharCont)
-            _chars[idx + 1] = ' ';
-
-        _chars[idx] = c;
-        _attrs[idx] = _currentAttr;
-        _cursorCol++;
-
-        if (wide && _cursorCol < _cols)
-        {
-            int idx2 = _cursorRow * _cols + _cursorCol;
-            // Same cleanup for the continuation cell.
-            if (_cursorCol + 1 < _cols && _chars[idx2 + 1] == WideCharCont)
-                _chars[idx2 + 1] = ' ';
-            _chars[idx2] = WideCharCont;
-            _attrs[idx2] = _currentAttr;
-            _cursorCol++;
-        }
-    }
-
-    /// <summary>
-    /// Returns true for characters that occupy two columns in a terminal
-    /// (CJK ideographs, Hangul syllables, fullwidth forms, etc.).
-    /// Based on Unicode East Asian Width categories W and F.
-    /// </summary>
-    private static bool IsFullWidth(char c)
-    {
-        if (c < 0x1100) return false;
-        return (c <= 0x115F) ||                          // Hangul Jamo
-               (c >= 0x2E80 && c <= 0x303E) ||           // CJK Radicals, Kangxi, Symbols & Punctuation
-               (c >= 0x3041 && c <= 0x33BF) ||           // Hiragana, Katakana, Bopomofo, Hangul Compat Jamo, Kanbun
-               (c >= 0x3400 && c <= 0x4DBF) ||           // CJK Extension A
-               (c >= 0x4E00 && c <= 0xA4CF) ||           // CJK Unified Ideographs, Yi Syllables/Radicals
-               (c >= 0xA960 && c <= 0xA97F) ||           // Hangul Jamo Extended-A
-               (c >= 0xAC00 && c <= 0xD7AF) ||           // Hangul Syllables
-               (c >= 0xF900 && c <= 0xFAFF) ||           // CJK Compatibility Ideographs
-               (c >= 0xFE10 && c <= 0xFE6F) ||           // CJK Compatibility Forms, Small Form Variants
-               (c >= 0xFF01 && c <= 0xFF60) ||           // Fullwidth Forms
-               (c >= 0xFFE0 && c <= 0xFFE6);            // Fullwidth Signs
-    }
-
-    private void LineFeed()
-    {
-        if (_cursorRow == _scrollBottom) ScrollUp();
-        else if (_cursorRow < _rows - 1) _cursorRow++;
-    }
-
-    private void ScrollUp()
-    {
-        // Save top line to scrollback
-        if (_scrollTop == 0)
-        {
-            var lc = new char[_cols]; var la = new CellAttr[_cols];
-            Array.Copy(_chars, 0, lc, 0, _cols);
-            Array.Copy(_attrs, 0, la, 0, _cols);
-            _scrollbackChars.Add(lc); _scrollbackAttrs.Add(la);
-            if (_scrollbackChars.Count > ScrollbackMax)
-            { _scrollbackChars.RemoveAt(0); _scrollbackAttrs.RemoveAt(0); }
-        }
-
-        int start = _scrollTop * _cols, end = _scrollBottom * _cols;
-        Array.Copy(_chars, start + _cols, _chars, start, end - start);
-        Array.Copy(_attrs, start + _cols, _attrs, start, end - start);
-        Array.Fill(_chars, ' ', end, _cols);
-        Array.Fill(_attrs, new CellAttr { Fg = 7, Bg = 0 }, end, _cols);
-    }
-
-    private void ScrollDown()
-    {
-        int start = _scrollTop * _cols, end = _scrollBottom * _cols;
-        Array.Copy(_chars, start, _chars, start + _cols, end - start);
-        Array.Copy(_attrs, start, _attrs, start + _cols, end - start);
-        Array.Fill(_chars, ' ', start, _cols);
-        Array.Fill(_attrs, new CellAttr { Fg = 7, Bg = 0 }, start, _cols);
-    }
-
-    private void EraseDisplay(int mode)
-    {
-        var d = new CellAttr { Fg = 7, Bg = 0 };
-        switch (mode)
-        {
-            case 0:
-                int s0 = _cursorRow * _cols + _cursorCol;
-                Array.Fill(_chars, ' ', s0, _chars.Length - s0);
-                Array.Fill(_attrs, d, s0, _attrs.Length - s0);
-                break;
-            case 1:
-                int c1 = _cursorRow * _cols + _cursorCol + 1;
-                Array.Fill(_chars, ' ', 0, c1);
-                Array.Fill(_attrs, d, 0, c1);
-                break;
-            case 2 or 3:
-                Array.Fill(_chars, ' ');
-                Array.Fill(_attrs, d);
-                if (mode == 3) { _scrollbackChars.Clear(); _scrollbackAttrs.Clear(); }
-                break;
-        }
-    }
-
-    private void EraseLine(int mode)
-    {
-        var d = new CellAttr { Fg = 7, Bg = 0 };
-        int rs = _cursorRow * _cols;
-        switch (mode)
-        {
-            case 0: Array.Fill(_chars, ' ', rs + _cursorCol, _cols - _cursorCol);
-                    Array.Fill(_attrs, d, rs + _cursorCol, _cols - _cursorCol); break;
-            case 1: Array.Fill(_chars, ' ', rs, _cursorCol + 1);
-                    Array.Fill(_attrs, d, rs, _cursorCol + 1); break;
-            case 2: Array.Fill(_chars, ' ', rs, _cols);
-                    Array.Fill(_attrs, d, rs, _cols); break;
-        }
-    }
-
-    private void InsertLines(int n)
-    {
-        if (_cursorRow < _scrollTop || _cursorRow > _scrollBottom) return;
-        var d = new CellAttr { Fg = 7, Bg = 0 };
-        for (int i = 0; i < n; i++)
-        {
-            int from = _cursorRow * _cols, to = _scrollBottom * _cols;
-            if (to > from) { Array.Copy(_chars, from, _chars, from + _cols, to - from);
-                             Array.Copy(_attrs, from, _attrs, from + _cols, to - from); }
-            Array.Fill(_chars, ' ', from, _cols); Array.Fill(_attrs, d, from, _cols);
-        }
-    }
-
-    private void DeleteLines(int n)
-    {
-        if (_cursorRow < _scrollTop || _cursorRow > _scrollBottom) return;
-        var d = new CellAttr { Fg = 7, Bg = 0 };
-        for (int i = 0; i < n; i++)
-        {
-            int from = _cursorRow * _cols, to = _scrollBottom * _cols;
-            if (to > from) { Array.Copy(_chars, from + _cols, _chars, from, to - from);
-                             Array.Copy(_attrs, from + _cols, _attrs, from, to - from); }
-            Array.Fill(_chars, ' ', to, _cols); Array.Fill(_attrs, d, to, _cols);
-        }
-    }
-
-    private void DeleteChars(int n)
-    {
-        int rs = _cursorRow * _cols, pos = rs + _cursorCol, end = rs + _cols;
-        int move = end - pos - n;
-        if (move > 0) { Array.Copy(_chars, pos + n, _chars, pos, move);
-                        Array.Copy(_attrs, pos + n, _attrs, pos, move); }
-        int cs = Math.Max(pos, end - n);
-        Array.Fill(_chars, ' ', cs, end - cs);
-        Array.Fill(_attrs, new CellAttr { Fg = 7, Bg = 0 }, cs, end - cs);
-    }
-
-    private void InsertChars(int n)
-    {
-        int rs = _cursorRow * _cols, pos = rs + _cursorCol, end = rs + _cols;
-        int move = end - pos - n;
-        if (move > 0) { Array.Copy(_chars, pos, _chars, pos + n, move);
-                        Array.Copy(_attrs, pos, _attrs, pos + n, move); }
-        Array.Fill(_chars, ' ', pos, Math.Min(n, end - pos));
-        Array.Fill(_attrs, new CellAttr { Fg = 7, Bg = 0 }, pos, Math.Min(n, end - pos));
-    }
-
-    private void ResetTerminal()
-    {
-        _currentAttr = new CellAttr { Fg = 7, Bg = 0 };
-        _cursorRow = _cursorCol = 0;
-        _scrollTop = 0; _scrollBottom = _rows - 1;
-        _cursorVisible = true;
-        InitBuffer();
-    }
-
     // ── Cell Measurement ──────────────────────────────────────────────
 
     private void MeasureCell()
@@ -746,21 +346,9 @@ public partial class TerminalPanel : UserControl
         int nr = Math.Max(1, usableH / _cellH);
         if (nc == _cols && nr == _rows) return;
 
-        int oc = _cols, or2 = _rows;
-        var oldC = _chars; var oldA = _attrs;
         _cols = nc; _rows = nr;
-        InitBuffer();
-
-        int cr = Math.Min(or2, _rows), cc = Math.Min(oc, _cols);
-        for (int r = 0; r < cr; r++)
-        {
-            Array.Copy(oldC, r * oc, _chars, r * _cols, cc);
-            Array.Copy(oldA, r * oc, _attrs, r * _cols, cc);
-        }
-
-        _cursorRow = Math.Min(_cursorRow, _rows - 1);
-        _cursorCol = Math.Min(_cursorCol, _cols - 1);
-        _scrollTop = 0; _scrollBottom = _rows - 1;
+        lock (_screenLock)
+            _terminal.Resize(nc, nr);
     }
 
     // ── Input ─────────────────────────────────────────────────────────
@@ -867,7 +455,10 @@ public partial class TerminalPanel : UserControl
     protected override void OnMouseWheel(MouseEventArgs e)
     {
         base.OnMouseWheel(e);
-        _viewOffset = Math.Clamp(_viewOffset + (e.Delta > 0 ? 3 : -3), 0, _scrollbackChars.Count);
+        int lines;
+        lock (_screenLock)
+            lines = _terminal.Scrollback.Count;
+        _viewOffset = Math.Clamp(_viewOffset + (e.Delta > 0 ? 3 : -3), 0, lines);
         Invalidate();
     }
 
@@ -890,52 +481,45 @@ public partial class TerminalPanel : UserControl
         var g = e.Graphics;
         g.TextRenderingHint = TextRenderingHint.ClearTypeGridFit;
 
+        int cols, rows, cursorRow, cursorCol;
+        bool cursorVisible;
+        lock (_screenLock)
+        {
+            CopyVisibleRows();
+            cols = _terminal.Columns;
+            rows = _terminal.Rows;
+            cursorRow = _terminal.CursorRow;
+            cursorCol = _terminal.CursorColumn;
+            cursorVisible = _terminal.CursorVisible;
+        }
+
         int pad = ConfigTerminalPadding;
         Color defBg = Palette[0], defFg = Palette[7];
         g.Clear(defBg);
 
-        for (int row = 0; row < _rows; row++)
+        var flags = TextFormatFlags.NoPadding | TextFormatFlags.NoPrefix;
+
+        for (int row = 0; row < rows; row++)
         {
             int y = pad + row * _cellH;
             if (y > Height) break;
 
-            char[]? srcC; CellAttr[]? srcA; int off;
-
-            if (_viewOffset > 0)
-            {
-                int sbRow = _scrollbackChars.Count - _viewOffset + row;
-                if (sbRow < 0) continue;
-                if (sbRow < _scrollbackChars.Count)
-                { srcC = _scrollbackChars[sbRow]; srcA = _scrollbackAttrs[sbRow]; off = 0; }
-                else
-                {
-                    int br = sbRow - _scrollbackChars.Count;
-                    if (br >= _rows) continue;
-                    srcC = _chars; srcA = _attrs; off = br * _cols;
-                }
-            }
-            else
-            { srcC = _chars; srcA = _attrs; off = row * _cols; }
-
-            int colsInRow = Math.Min(_cols, srcC.Length - off);
-            if (colsInRow <= 0) continue;
-
-            var flags = TextFormatFlags.NoPadding | TextFormatFlags.NoPrefix;
+            ReadOnlySpan<TerminalCell> cells = _paintCells.AsSpan(row * cols, cols);
 
             // First pass: draw background rectangles (batched by attribute)
-            for (int col = 0; col < colsInRow;)
+            for (int col = 0; col < cells.Length;)
             {
-                var attr = srcA[off + col];
+                var attr = cells[col].Attributes;
                 int run = 1;
-                while (col + run < colsInRow)
+                while (col + run < cells.Length)
                 {
-                    var na = srcA[off + col + run];
-                    if (na.Fg != attr.Fg || na.Bg != attr.Bg ||
+                    var na = cells[col + run].Attributes;
+                    if (na.Foreground != attr.Foreground || na.Background != attr.Background ||
                         na.Bold != attr.Bold || na.Reverse != attr.Reverse) break;
                     run++;
                 }
-                Color bg = Palette[attr.Bg];
-                if (attr.Reverse) bg = Palette[attr.Bold && attr.Fg < 8 ? attr.Fg + 8 : attr.Fg];
+                Color bg = Palette[attr.Background];
+                if (attr.Reverse) bg = Palette[attr.Bold && attr.Foreground < 8 ? attr.Foreground + 8 : attr.Foreground];
                 if (bg != defBg)
                 {
                     using var bgBrush = new SolidBrush(bg);
@@ -945,15 +529,15 @@ public partial class TerminalPanel : UserControl
             }
 
             // Second pass: draw each character at its exact grid position
-            for (int col = 0; col < colsInRow; col++)
+            for (int col = 0; col < cells.Length; col++)
             {
-                char ch = srcC[off + col];
-                if (ch == ' ' || ch == '\0' || ch == WideCharCont) continue;
-                var attr = srcA[off + col];
-                Color fg = Palette[attr.Bold && attr.Fg < 8 ? attr.Fg + 8 : attr.Fg];
-                if (attr.Reverse) fg = Palette[attr.Bg];
+                char ch = cells[col].Char;
+                if (ch == ' ' || ch == '\0' || ch == TerminalCell.WideContinuation) continue;
+                var attr = cells[col].Attributes;
+                Color fg = Palette[attr.Bold && attr.Foreground < 8 ? attr.Foreground + 8 : attr.Foreground];
+                if (attr.Reverse) fg = Palette[attr.Background];
 
-                if (IsFullWidth(ch))
+                if (TerminalEmulator.IsFullWidth(ch))
                 {
                     // Draw the wide glyph into a 2-cell-wide rectangle.
                     var rect = new Rectangle(pad + col * _cellW, y, _cellW * 2, _cellH);
@@ -968,23 +552,55 @@ public partial class TerminalPanel : UserControl
         }
 
         // Cursor
-        if (_cursorVisible && _viewOffset == 0 && _caretOn && Focused)
+        if (cursorVisible && _viewOffset == 0 && _caretOn && Focused)
         {
-            int cx = pad + _cursorCol * _cellW, cy = pad + _cursorRow * _cellH;
+            int cx = pad + cursorCol * _cellW, cy = pad + cursorRow * _cellH;
             using var cb = new SolidBrush(Color.FromArgb(200, defFg));
             g.FillRectangle(cb, cx, cy, Math.Max(2, (int)(_cellW * 0.15f)), _cellH);
         }
     }
 
+    /// <summary>
+    /// Copies the rows in view into <see cref="_paintCells"/>: the tail of
+    /// the scrollback followed by the top of the screen when scrolled back,
+    /// otherwise the screen.  Called under <see cref="_screenLock"/>.
+    /// </summary>
+    private void CopyVisibleRows()
+    {
+        int cols = _terminal.Columns, rows = _terminal.Rows;
+        if (_paintCells.Length != cols * rows)
+            _paintCells = new TerminalCell[cols * rows];
+
+        ScrollbackBuffer scrollback = _terminal.Scrollback;
+        int first = scrollback.Count - Math.Min(_viewOffset, scrollback.Count);
+        for (int row = 0; row < rows; row++)
+        {
+            Span<TerminalCell> target = _paintCells.AsSpan(row * cols, cols);
+            int line = first + row;
+            if (line < scrollback.Count)
+                scrollback.CopyLine(line, target);
+            else
+                _terminal.GetRow(line - scrollback.Count).CopyTo(target);
+        }
+    }
+
     private void InvalidateCursor()
     {
-        if (_cursorCol < _cols && _cursorRow < _rows)
+        int cursorRow, cursorCol;
+        lock (_screenLock)
+        {
+            cursorRow = _terminal.CursorRow;
+            cursorCol = _terminal.CursorColumn;
+        }
+
+        if (cursorCol < _cols && cursorRow < _rows)
         {
             int pad = ConfigTerminalPadding;
-            Invalidate(new Rectangle(pad + _cursorCol * _cellW, pad + _cursorRow * _cellH, _cellW + 1, _cellH + 1));
+            Invalidate(new Rectangle(pad + cursorCol * _cellW, pad + cursorRow * _cellH, _cellW + 1, _cellH + 1));
         }
     }
 
+
     // ── Resize & Focus ────────────────────────────────────────────────
 
     protected override void OnResize(EventArgs e)
@@ -66,6 +66,14 @@ public sealed class TabInfo
     /// <summary>Pending scroll position to apply after loading/activation.</summary>
     public int PendingScroll { get; set; }
 
+    /// <summary>
+    /// Character offset of the first visible line saved with the session.
+    /// Large files are scanned progressively; the editor scrolls here as
+    /// soon as the scan reaches it, without waiting for line numbers of
+    /// the whole file.
+    /// </summary>
+    public long PendingScrollOffset { get; set; }
+
     /// <summary>Pending caret offset to apply after loading/activation.</summary>
     public long PendingCaret { get; set; }
 
@@ -85,8 +93,8 @@ public sealed class TabInfo
     public string? SelectedCustomProfileName { get; set; }
 
     /// <summary>
-    /// When set (e.g. "pieces"), indicates this deferred tab has modified content
-    /// stored in the recovery directory.  Used by the recovery manifest writer to
+    /// When set ("pieces" or "text"), indicates this deferred tab has modified
+    /// content stored in the recovery directory that is read on activation.  Used by the recovery manifest writer to
     /// preserve the format across re-saves, so the data survives even if the tab
     /// is never activated.
     /// </summary>
@@ -0,0 +1,25 @@
+namespace Bascanka.Core.Benchmarks;
+
+/// <summary>
+/// Benchmark runner.  The first argument names the benchmark; the rest are
+/// passed to it.  Run with <c>dotnet run -c Release -- &lt;name&gt; [args]</c>.
+/// </summary>
+internal static class Program
+{
+    private static readonly Dictionary<string, Func<string[], int>> Benchmarks =
+        new(StringComparer.OrdinalIgnoreCase)
+        {
+            ["terminal"] = TerminalBenchmark.Run,
+        };
+
+    private static int Main(string[] args)
+    {
+        if (args.Length == 0 || !Benchmarks.TryGetValue(args[0], out var run))
+        {
+            Console.WriteLine("Usage: Bascanka.Core.Benchmarks <benchmark> [args]");
+            Console.WriteLine("Benchmarks: " + string.Join(", ", Benchmarks.Keys));
+            return 2;
+        }
+        return run(args[1..]);
+    }
+}
@@ -0,0 +1,124 @@
+using System.Diagnostics;
+using System.Text;
+using TextEncoding = System.Text.Encoding;
+using Bascanka.Core.Terminal;
+
+namespace Bascanka.Core.Benchmarks;
+
+/// <summary>
+/// Feeds escape-sequence streams through <see cref="TerminalEmulator"/> the
+/// way the terminal panel does (UTF-8 reads of 64 KB, decoded
+/// incrementally) and reports throughput and allocations.
+/// </summary>
+/// <remarks>
+/// Arguments are files holding raw terminal output, for example captured
+/// on Linux with <c>script -q -c "dotnet build" build.vt</c>.  Without
+/// arguments, built-in streams modelled on build output are used.  Each
+/// stream is replayed until about 256 MB has been processed.
+/// </remarks>
+internal static class TerminalBenchmark
+{
+    private const int ReadSize = 64 * 1024;
+    private const long TargetBytes = 256L * 1024 * 1024;
+
+    public static int Run(string[] args)
+    {
+        var streams = new List<(string Name, byte[] Data)>();
+        foreach (string path in args)
+            streams.Add((Path.GetFileName(path), File.ReadAllBytes(path)));
+        if (streams.Count == 0)
+        {
+            streams.Add(("build-log", TextEncoding.UTF8.GetBytes(BuildLog(20_000))));
+            streams.Add(("progress", TextEncoding.UTF8.GetBytes(ProgressBars(20_000))));
+            streams.Add(("sgr-heavy", TextEncoding.UTF8.GetBytes(SgrHeavy(20_000))));
+        }
+
+        Console.WriteLine($"{"stream",-16} {"MB",8} {"MB/s",9} {"alloc KB",10} {"scrollback",11}");
+        foreach (var (name, data) in streams)
+        {
+            if (data.Length == 0) continue;
+            Replay(data, TargetBytes / 8);  // warm-up
+
+            long allocated = GC.GetAllocatedBytesForCurrentThread();
+            var sw = Stopwatch.StartNew();
+            (long bytes, TerminalEmulator term) = Replay(data, TargetBytes);
+            sw.Stop();
+            allocated = GC.GetAllocatedBytesForCurrentThread() - allocated;
+
+            double mb = bytes / (1024.0 * 1024.0);
+            Console.WriteLine($"{name,-16} {mb,8:F0} {mb / sw.Elapsed.TotalSeconds,9:F1} " +
+                $"{allocated / 1024,10:N0} {term.Scrollback.Count,11:N0}");
+        }
+        return 0;
+    }
+
+    private static (long Bytes, TerminalEmulator Terminal) Replay(byte[] data, long target)
+    {
+        var term = new TerminalEmulator(120, 30);
+        Decoder decoder = TextEncoding.UTF8.GetDecoder();
+        var chars = new char[TextEncoding.UTF8.GetMaxCharCount(ReadSize)];
+        long bytes = 0;
+
+        while (bytes < target)
+        {
+            for (int offset = 0; offset < data.Length; offset += ReadSize)
+            {
+                int n = Math.Min(ReadSize, data.Length - offset);
+                int count = decoder.GetChars(data, offset, n, chars, 0);
+                term.Write(chars.AsSpan(0, count));
+            }
+            bytes += data.Length;
+        }
+        return (bytes, term);
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Built-in streams
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>Compiler output: mostly plain lines, some coloured diagnostics.</summary>
+    private static string BuildLog(int lines)
+    {
+        var random = new Random(1);
+        var sb = new StringBuilder();
+        for (int i = 0; i < lines; i++)
+        {
+            int n = random.Next(10);
+            if (n == 0)
+                sb.Append($"src/Module{i % 50}/File{i}.cs(12,7): \x1B[33mwarning CS0168\x1B[0m: The variable 'e' is declared but never used\r\n");
+            else if (n == 1)
+                sb.Append($"src/Module{i % 50}/File{i}.cs(40,3): \x1B[1;31merror CS1002\x1B[0m: ; expected\r\n");
+            else
+                sb.Append($"  Bascanka.Module{i % 50} -> /home/build/src/Module{i % 50}/bin/Release/net10.0/Module{i}.dll\r\n");
+        }
+        return sb.ToString();
+    }
+
+    /// <summary>Progress output that redraws the current line.</summary>
+    private static string ProgressBars(int updates)
+    {
+        var sb = new StringBuilder();
+        for (int i = 0; i < updates; i++)
+        {
+            int pct = i % 101;
+            sb.Append($"\r\x1B[K\x1B[32m[{new string('=', pct / 2)}>{new string(' ', 50 - pct / 2)}]\x1B[0m {pct,3}% restoring packages");
+            if (pct == 100) sb.Append("\r\n");
+        }
+        return sb.ToString();
+    }
+
+    /// <summary>Short coloured tokens with cursor movement, as from a TUI.</summary>
+    private static string SgrHeavy(int lines)
+    {
+        var random = new Random(2);
+        var sb = new StringBuilder();
+        for (int i = 0; i < lines; i++)
+        {
+            sb.Append($"\x1B[{random.Next(1, 30)};1H");
+            for (int w = 0; w < 12; w++)
+                sb.Append($"\x1B[38;5;{random.Next(256)}m{(char)('a' + w)}word\x1B[0m ");
+            sb.Append("\x1B[K\r\n");
+        }
+        return sb.ToString();
+    }
+}
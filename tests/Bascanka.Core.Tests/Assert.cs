@@ -0,0 +1,42 @@
+using System.Runtime.CompilerServices;
+
+namespace Bascanka.Core.Tests;
+
+/// <summary>Assertion helpers; each throws <see cref="AssertionException"/> on failure.</summary>
+internal static class Assert
+{
+    public static void True(bool condition, [CallerArgumentExpression(nameof(condition))] string? expression = null)
+    {
+        if (!condition)
+            throw new AssertionException($"Expected true: {expression}");
+    }
+
+    public static void Equal<T>(T expected, T actual, [CallerArgumentExpression(nameof(actual))] string? expression = null)
+    {
+        if (!EqualityComparer<T>.Default.Equals(expected, actual))
+            throw new AssertionException($"{expression}: expected <{expected}>, got <{actual}>");
+    }
+
+    public static void SequenceEqual<T>(IEnumerable<T> expected, IEnumerable<T> actual,
+        [CallerArgumentExpression(nameof(actual))] string? expression = null)
+    {
+        T[] e = [.. expected];
+        T[] a = [.. actual];
+        if (e.Length != a.Length)
+            throw new AssertionException($"{expression}: expected {e.Length} items, got {a.Length}");
+        for (int i = 0; i < e.Length; i++)
+        {
+            if (!EqualityComparer<T>.Default.Equals(e[i], a[i]))
+                throw new AssertionException($"{expression}[{i}]: expected <{e[i]}>, got <{a[i]}>");
+        }
+    }
+
+    public static void AtMost(long limit, long actual, [CallerArgumentExpression(nameof(actual))] string? expression = null)
+    {
+        if (actual > limit)
+            throw new AssertionException($"{expression}: expected at most {limit}, got {actual}");
+    }
+}
+
+/// <summary>Thrown when an assertion fails.</summary>
+internal sealed class AssertionException(string message) : Exception(message);
@@ -0,0 +1,122 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Tests.Buffer;
+
+/// <summary>
+/// Random inserts, deletes and overwrites must leave the byte piece table
+/// equal to the same edits applied to a plain list, through every way of
+/// reading it back, including over a memory-mapped file.
+/// </summary>
+public sealed class BytePieceTableTests
+{
+    [Test]
+    public void EditsMatchAPlainList()
+    {
+        var random = new Random(83);
+        byte[] original = new byte[200_000];
+        random.NextBytes(original);
+        var table = new BytePieceTable(original);
+        var model = new List<byte>(original);
+        // Whether each byte of the model came from the add buffer.
+        var inserted = new List<bool>(new bool[original.Length]);
+
+        for (int round = 0; round < 2000; round++)
+        {
+            long offset = random.NextInt64(model.Count + 1);
+            byte[] bytes = new byte[random.Next(1, round % 50 == 0 ? 100_000 : 40)];
+            random.NextBytes(bytes);
+            switch (random.Next(3))
+            {
+                case 0:
+                    table.Insert(offset, bytes);
+                    model.InsertRange((int)offset, bytes);
+                    inserted.InsertRange((int)offset, Enumerable.Repeat(true, bytes.Length));
+                    break;
+                case 1:
+                    int length = (int)Math.Min(bytes.Length, model.Count - offset);
+                    table.Delete(offset, length);
+                    model.RemoveRange((int)offset, length);
+                    inserted.RemoveRange((int)offset, length);
+                    break;
+                default:
+                    table.Overwrite(offset, bytes);
+                    int kept = (int)Math.Min(bytes.Length, model.Count - offset);
+                    model.RemoveRange((int)offset, kept);
+                    model.InsertRange((int)offset, bytes);
+                    inserted.RemoveRange((int)offset, kept);
+                    inserted.InsertRange((int)offset, Enumerable.Repeat(true, bytes.Length));
+                    break;
+            }
+
+            Assert.Equal((long)model.Count, table.Length);
+            if (model.Count == 0) continue;
+
+            // A window read, with the inserted flags, and a single byte.
+            long at = random.NextInt64(model.Count);
+            var window = new byte[300];
+            var flags = new bool[300];
+            int read = table.Read(at, window, flags);
+            Assert.Equal((int)Math.Min(300, model.Count - at), read);
+            Assert.SequenceEqual(model.GetRange((int)at, read), window[..read]);
+            Assert.SequenceEqual(inserted.GetRange((int)at, read), flags[..read]);
+            Assert.Equal(model[(int)at], table[at]);
+        }
+
+        Assert.SequenceEqual(model, table.ToArray());
+        var written = new MemoryStream();
+        table.WriteTo(written);
+        Assert.SequenceEqual(model, written.ToArray());
+    }
+
+    [Test]
+    public void RemovedPiecesCanBePutBack()
+    {
+        var table = new BytePieceTable("0123456789"u8.ToArray());
+        table.Insert(5, "abc"u8);
+        List<Piece> removed = table.GetPieces(3, 6);
+        table.Delete(3, 6);
+        Assert.SequenceEqual("0126789"u8.ToArray(), table.ToArray());
+
+        table.InsertPieces(3, removed);
+        Assert.SequenceEqual("01234abc56789"u8.ToArray(), table.ToArray());
+    }
+
+    [Test]
+    public void MappedFileStaysOpenToOtherWriters()
+    {
+        string path = Path.Combine(Path.GetTempPath(), $"bascanka-{Guid.NewGuid():N}.bin");
+        byte[] bytes = new byte[3 * 1024 * 1024 + 17];
+        new Random(84).NextBytes(bytes);
+        File.WriteAllBytes(path, bytes);
+        try
+        {
+            using (var table = BytePieceTable.FromFile(path))
+            {
+                table.Overwrite(10, "edit"u8);
+                Assert.Equal((long)bytes.Length, table.Length);
+                Assert.Equal(bytes[^1], table[bytes.Length - 1]);
+                Assert.Equal((byte)'e', table[10]);
+
+                // Another program may still open the file for writing.
+                using (new FileStream(path, FileMode.Open, FileAccess.ReadWrite,
+                    FileShare.ReadWrite | FileShare.Delete))
+                {
+                }
+
+                var copy = new MemoryStream();
+                table.WriteTo(copy);
+                "edit"u8.CopyTo(bytes.AsSpan(10));
+                Assert.SequenceEqual(bytes, copy.ToArray());
+            }
+
+            // An empty file cannot be mapped, but opens as an empty table.
+            File.WriteAllBytes(path, []);
+            using var empty = BytePieceTable.FromFile(path);
+            Assert.Equal(0L, empty.Length);
+        }
+        finally
+        {
+            File.Delete(path);
+        }
+    }
+}
@@ -0,0 +1,119 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Tests.Buffer;
+
+/// <summary>
+/// Correctness of <see cref="LineSnapshotCache"/> against
+/// <see cref="PieceTable.GetLineRange"/>, and allocation limits for the
+/// per-frame line retrieval path.
+/// </summary>
+public sealed class LineSnapshotCacheTests
+{
+    private const int VisibleLines = 60;
+
+    [Test]
+    public void MatchesGetLineRangeAcrossEdits()
+    {
+        var random = new Random(79);
+        var doc = new PieceTable(string.Join('\n', Enumerable.Range(0, 500).Select(i => new string('a', i % 37))));
+        var cache = new LineSnapshotCache { Document = doc };
+        var lines = new (string Text, long StartOffset)[VisibleLines];
+
+        for (int i = 0; i < 300; i++)
+        {
+            long start = random.NextInt64(doc.LineCount);
+            int count = cache.GetLines(start, lines);
+            Assert.SequenceEqual(doc.GetLineRange(start, VisibleLines), lines.Take(count));
+
+            if (i % 3 == 0)
+                doc.Insert(random.NextInt64(doc.Length + 1), random.Next(2) == 0 ? "\n" : "text");
+        }
+    }
+
+    [Test]
+    public void ReadsRunsLongerThanTheBatchBudget()
+    {
+        // Several lines of a few hundred thousand characters each, so a run
+        // of missing lines exceeds the pooled-buffer budget.
+        string longLine = new('x', 300_000);
+        var doc = new PieceTable(string.Join('\n', "first", longLine, longLine + "y", "", longLine, "last"));
+        var cache = new LineSnapshotCache { Document = doc };
+        var lines = new (string Text, long StartOffset)[10];
+
+        int count = cache.GetLines(0, lines);
+
+        Assert.Equal(6, count);
+        Assert.SequenceEqual(doc.GetLineRange(0, 10), lines.Take(count));
+    }
+
+    [Test]
+    public void SteadyStateFrameDoesNotAllocate()
+    {
+        var doc = new PieceTable(string.Join('\n', Enumerable.Range(0, 10_000).Select(i => $"line {i}\twith a tab")));
+        var cache = new LineSnapshotCache { Document = doc };
+        var lines = new (string Text, long StartOffset)[VisibleLines];
+
+        // First frame reads the window; later frames of the same window must
+        // be served from the cache.
+        cache.GetLines(5_000, lines);
+        cache.GetLines(5_000, lines);
+
+        long before = GC.GetAllocatedBytesForCurrentThread();
+        for (int frame = 0; frame < 100; frame++)
+            cache.GetLines(5_000, lines);
+        long allocated = GC.GetAllocatedBytesForCurrentThread() - before;
+
+        Assert.Equal(0L, allocated);
+    }
+
+    [Test]
+    public void ScrollingByOneLineAllocatesOnlyTheNewLine()
+    {
+        var doc = new PieceTable(string.Join('\n', Enumerable.Range(0, 10_000).Select(i => $"line {i:D5}")));
+        var cache = new LineSnapshotCache { Document = doc };
+        var lines = new (string Text, long StartOffset)[VisibleLines];
+        cache.GetLines(1_000, lines);
+        cache.GetLines(1_001, lines);
+
+        long before = GC.GetAllocatedBytesForCurrentThread();
+        for (int frame = 2; frame < 102; frame++)
+            cache.GetLines(1_000 + frame, lines);
+        long perFrame = (GC.GetAllocatedBytesForCurrentThread() - before) / 100;
+
+        // One 10-character line string per frame, plus object header slack.
+        Assert.AtMost(64, perFrame);
+    }
+
+    [Test]
+    public void CopyToDoesNotAllocate()
+    {
+        var doc = new PieceTable(new string('a', 100_000));
+        for (int i = 0; i < 100; i++)
+            doc.Insert(i * 997, "edit");
+        var buffer = new char[4_096];
+        doc.CopyTo(50_000, buffer);
+
+        long before = GC.GetAllocatedBytesForCurrentThread();
+        for (int i = 0; i < 100; i++)
+            doc.CopyTo(i * 900, buffer);
+        long allocated = GC.GetAllocatedBytesForCurrentThread() - before;
+
+        Assert.Equal(0L, allocated);
+    }
+
+    [Test]
+    public void GetTextAllocatesOnlyTheResult()
+    {
+        var doc = new PieceTable(new string('a', 100_000));
+        for (int i = 0; i < 100; i++)
+            doc.Insert(i * 997, "edit");
+        _ = doc.GetText(1_000, 10_000);
+
+        long before = GC.GetAllocatedBytesForCurrentThread();
+        _ = doc.GetText(1_000, 10_000);
+        long allocated = GC.GetAllocatedBytesForCurrentThread() - before;
+
+        // 10,000 UTF-16 chars plus the string header.
+        Assert.AtMost(20_000 + 64, allocated);
+    }
+}
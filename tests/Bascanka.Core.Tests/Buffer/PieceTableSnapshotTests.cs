@@ -0,0 +1,29 @@
+using Bascanka.Core.Buffer;
+
+namespace Bascanka.Core.Tests.Buffer;
+
+/// <summary>
+/// A snapshot keeps the text it was taken with while its table is edited,
+/// and disposing it leaves the shared original source alone.
+/// </summary>
+public sealed class PieceTableSnapshotTests
+{
+    [Test]
+    public void SnapshotIsUnaffectedByLaterEdits()
+    {
+        var doc = new PieceTable("line one\nline two\nline three");
+        doc.Insert(5, "number ");
+        doc.Delete(0, 1);
+        string before = doc.ToString();
+
+        var snapshot = doc.CreateSnapshot();
+        doc.Insert(0, "new\n");
+        doc.Delete(10, 8);
+        snapshot.Dispose();
+
+        Assert.Equal(before, snapshot.ToString());
+        Assert.Equal(3L, snapshot.LineCount);
+        Assert.Equal("ine number one", snapshot.GetLine(0));
+        Assert.Equal("new", doc.GetLine(0));
+    }
+}
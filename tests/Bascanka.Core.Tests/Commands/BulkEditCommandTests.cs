@@ -0,0 +1,107 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Commands;
+
+namespace Bascanka.Core.Tests.Commands;
+
+/// <summary>
+/// A bulk edit must leave the same text as applying its edits one by one,
+/// and undo must restore the original exactly.
+/// </summary>
+public sealed class BulkEditCommandTests
+{
+    [Test]
+    public void ExecuteAndUndoMatchSequentialEdits()
+    {
+        var random = new Random(86);
+        for (int round = 0; round < 50; round++)
+        {
+            string original = RandomText(random, random.Next(0, 400));
+            List<TextEdit> edits = RandomEdits(random, original.Length);
+
+            var doc = new PieceTable(original);
+            int changes = 0;
+            doc.TextChanged += (_, _) => changes++;
+            var command = new BulkEditCommand(doc, edits);
+
+            command.Execute();
+            Assert.Equal(ApplySequentially(original, edits), doc.ToString());
+            Assert.Equal(edits.Count == 0 ? 0 : 1, changes);
+            AssertLineIndex(doc);
+
+            command.Undo();
+            Assert.Equal(original, doc.ToString());
+            AssertLineIndex(doc);
+
+            command.Execute();
+            Assert.Equal(ApplySequentially(original, edits), doc.ToString());
+        }
+    }
+
+    [Test]
+    public void LargeBatchUsesTheSameResultAsSmallOnes()
+    {
+        // Enough edits to take the whole-tree rebuild path.
+        string original = string.Join('\n', Enumerable.Range(0, 5_000).Select(i => $"line {i}"));
+        var edits = new List<TextEdit>();
+        for (int offset = 0; offset + 4 < original.Length; offset += 7)
+            edits.Add(new TextEdit(offset, 2, offset % 3 == 0 ? "\n" : "xyz"));
+
+        var doc = new PieceTable(original);
+        var command = new BulkEditCommand(doc, edits);
+        command.Execute();
+
+        Assert.Equal(ApplySequentially(original, edits), doc.ToString());
+        AssertLineIndex(doc);
+
+        command.Undo();
+        Assert.Equal(original, doc.ToString());
+        AssertLineIndex(doc);
+    }
+
+    private static string RandomText(Random random, int length)
+    {
+        var chars = new char[length];
+        for (int i = 0; i < length; i++)
+            chars[i] = random.Next(8) == 0 ? '\n' : (char)('a' + random.Next(26));
+        return new string(chars);
+    }
+
+    private static List<TextEdit> RandomEdits(Random random, int length)
+    {
+        var edits = new List<TextEdit>();
+        long offset = 0;
+        while (offset <= length && random.Next(6) != 0)
+        {
+            offset += random.Next(0, 30);
+            if (offset > length) break;
+            long removed = random.Next(0, (int)Math.Min(10, length - offset) + 1);
+            edits.Add(new TextEdit(offset, removed, RandomText(random, random.Next(0, 8))));
+            offset += removed + 1;
+        }
+        return edits;
+    }
+
+    private static string ApplySequentially(string text, List<TextEdit> edits)
+    {
+        for (int i = edits.Count - 1; i >= 0; i--)
+        {
+            TextEdit e = edits[i];
+            text = text.Remove((int)e.Offset, (int)e.Length).Insert((int)e.Offset, e.Text);
+        }
+        return text;
+    }
+
+    private static void AssertLineIndex(PieceTable doc)
+    {
+        string text = doc.ToString();
+        string[] lines = text.Split('\n');
+        Assert.Equal((long)lines.Length, doc.LineCount);
+        long offset = 0;
+        for (int i = 0; i < lines.Length; i++)
+        {
+            Assert.Equal(offset, doc.GetLineStartOffset(i));
+            Assert.Equal(lines[i], doc.GetLine(i));
+            offset += lines[i].Length + 1;
+        }
+    }
+}
@@ -0,0 +1,151 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Commands;
+
+namespace Bascanka.Core.Tests.Commands;
+
+/// <summary>
+/// Hex edits that continue each other merge into one undo step, and undo
+/// and redo through the history must walk back and forth through exactly
+/// the states the document had between steps.
+/// </summary>
+public sealed class ByteReplaceCommandTests
+{
+    [Test]
+    public void ContinuingEditsMergeIntoOneStep()
+    {
+        byte[] original = [.. Enumerable.Range(0, 100).Select(i => (byte)i)];
+        var table = new BytePieceTable(original);
+        var history = new CommandHistory();
+
+        // Typing forwards: one step whose pieces stay coalesced on redo.
+        for (int i = 0; i < 1000; i++)
+            history.Execute(new ByteReplaceCommand(table, 10 + i, 0, [(byte)i]));
+        var typed = (ByteReplaceCommand)history.NextUndo!;
+        Assert.Equal(1000L, typed.InsertedLength);
+        Assert.Equal("Insert bytes", typed.Description);
+        byte[] afterTyping = table.ToArray();
+        history.Undo();
+        Assert.True(!history.CanUndo);
+        Assert.SequenceEqual(original, table.ToArray());
+        history.Redo();
+        Assert.SequenceEqual(afterTyping, table.ToArray());
+        Assert.AtMost(3, table.PieceCount);
+
+        // Overwriting forwards, Delete at a fixed caret and Backspace each
+        // merge; switching from one to another starts a new step.
+        history.Execute(new ByteReplaceCommand(table, 0, 1, [0xAA]));
+        history.Execute(new ByteReplaceCommand(table, 1, 1, [0xBB]));
+        history.Execute(new ByteReplaceCommand(table, 2, 1, [0xCC]));
+        var overwrite = (ByteReplaceCommand)history.NextUndo!;
+        Assert.Equal(("Overwrite bytes", 0L, 3L, 3L),
+            (overwrite.Description, overwrite.Offset, overwrite.RemovedLength, overwrite.InsertedLength));
+
+        history.Execute(new ByteReplaceCommand(table, 500, 1, []));
+        history.Execute(new ByteReplaceCommand(table, 500, 1, []));
+        var delete = (ByteReplaceCommand)history.NextUndo!;
+        Assert.True(!ReferenceEquals(overwrite, delete));
+        Assert.Equal((500L, 2L), (delete.Offset, delete.RemovedLength));
+
+        history.Execute(new ByteReplaceCommand(table, 300, 1, []));
+        history.Execute(new ByteReplaceCommand(table, 299, 1, []));
+        history.Execute(new ByteReplaceCommand(table, 298, 1, []));
+        var backspace = (ByteReplaceCommand)history.NextUndo!;
+        Assert.True(!ReferenceEquals(delete, backspace));
+        Assert.Equal((298L, 3L, 0L), (backspace.Offset, backspace.RemovedLength, backspace.InsertedLength));
+
+        // Edits on another table never merge.
+        var other = new BytePieceTable(original);
+        Assert.True(!backspace.CanMergeWith(new ByteReplaceCommand(other, 297, 1, [])));
+
+        history.Undo();
+        history.Undo();
+        history.Undo();
+        Assert.SequenceEqual(afterTyping, table.ToArray());
+    }
+
+    [Test]
+    public void UndoAndRedoRestoreEveryStep()
+    {
+        var random = new Random(85);
+        for (int round = 0; round < 20; round++)
+        {
+            byte[] original = new byte[random.Next(0, 2000)];
+            random.NextBytes(original);
+            var table = new BytePieceTable(original);
+            var model = new List<byte>(original);
+            var history = new CommandHistory();
+
+            // The document as it was before each undo step began.
+            var stepStarts = new List<byte[]>();
+            long caret = random.NextInt64(model.Count + 1);
+
+            for (int edit = 0; edit < 400; edit++)
+            {
+                // Mostly keystrokes that continue from the caret, so many
+                // of them merge; sometimes a jump or a paste.
+                if (random.Next(20) == 0)
+                    caret = random.NextInt64(model.Count + 1);
+
+                ByteReplaceCommand command;
+                int kind = random.Next(5);
+                if (kind == 0 && caret > 0)
+                {
+                    caret--;                                        // Backspace
+                    command = new ByteReplaceCommand(table, caret, 1, []);
+                    model.RemoveAt((int)caret);
+                }
+                else if (kind == 1 && caret < model.Count)
+                {
+                    command = new ByteReplaceCommand(table, caret, 1, []);    // Delete
+                    model.RemoveAt((int)caret);
+                }
+                else if (kind == 2 && caret < model.Count)
+                {
+                    byte value = (byte)random.Next(256);           // overwrite
+                    command = new ByteReplaceCommand(table, caret, 1, [value]);
+                    model[(int)caret] = value;
+                    caret++;
+                }
+                else if (kind == 3)
+                {
+                    byte[] bytes = new byte[random.Next(1, 300)];  // paste over a selection
+                    random.NextBytes(bytes);
+                    long removed = Math.Min(random.Next(0, 50), model.Count - caret);
+                    command = new ByteReplaceCommand(table, caret, removed, bytes);
+                    model.RemoveRange((int)caret, (int)removed);
+                    model.InsertRange((int)caret, bytes);
+                    caret += bytes.Length;
+                }
+                else
+                {
+                    byte value = (byte)random.Next(256);           // insert
+                    command = new ByteReplaceCommand(table, caret, 0, [value]);
+                    model.Insert((int)caret, value);
+                    caret++;
+                }
+
+                byte[] before = table.ToArray();
+                history.Execute(command);
+                if (ReferenceEquals(history.NextUndo, command))
+                    stepStarts.Add(before);
+                Assert.SequenceEqual(model, table.ToArray());
+            }
+
+            byte[] final = table.ToArray();
+            Assert.True(stepStarts.Count < 400);
+            for (int step = stepStarts.Count - 1; step >= 0; step--)
+            {
+                history.Undo();
+                Assert.SequenceEqual(stepStarts[step], table.ToArray());
+            }
+            Assert.True(!history.CanUndo);
+
+            for (int step = 1; step <= stepStarts.Count; step++)
+            {
+                history.Redo();
+                Assert.SequenceEqual(step < stepStarts.Count ? stepStarts[step] : final, table.ToArray());
+            }
+            Assert.True(!history.CanRedo);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+using System.Text;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Encoding;
+
+namespace Bascanka.Core.Tests.Encoding;
+
+/// <summary>
+/// Streamed conversion must produce the same bytes as converting the whole
+/// text at once, across block boundaries that fall inside multi-byte
+/// characters, surrogate pairs and CR LF pairs, whether the blocks are
+/// converted in parallel or in sequence.
+/// </summary>
+public sealed class StreamingTranscoderTests
+{
+    private static readonly System.Text.Encoding Utf8 = new UTF8Encoding(false);
+    private static readonly System.Text.Encoding Gb18030 = CodePagesEncoding(54936);
+
+    [Test]
+    public void TranscodedBytesMatchAWholeConversion()
+    {
+        string text = BuildText(seed: 100, length: 2_700_000);
+        System.Text.Encoding[] encodings = [Utf8, System.Text.Encoding.Unicode, System.Text.Encoding.BigEndianUnicode, Gb18030];
+
+        foreach (System.Text.Encoding source in encodings)
+        {
+            byte[] input = [.. source.GetPreamble(), .. source.GetBytes(text)];
+            foreach (System.Text.Encoding target in encodings)
+            {
+                var output = new MemoryStream();
+                StreamingTranscoder.Transcode(new MemoryStream(input), source, output, target, writePreamble: true);
+                byte[] expected = [.. target.GetPreamble(), .. target.GetBytes(text)];
+                Assert.SequenceEqual(expected, output.ToArray());
+            }
+        }
+
+        // A UTF-8 byte order mark is skipped even when the encoding would not write one.
+        var withBom = new MemoryStream([0xEF, 0xBB, 0xBF, .. Utf8.GetBytes("héllo")]);
+        var unicode = new MemoryStream();
+        StreamingTranscoder.Transcode(withBom, Utf8, unicode, System.Text.Encoding.Unicode);
+        Assert.Equal("héllo", System.Text.Encoding.Unicode.GetString(unicode.ToArray()));
+    }
+
+    [Test]
+    public void EncodedDocumentMatchesAWholeConversion()
+    {
+        string text = BuildText(seed: 101, length: 3_200_000);
+        var document = new PieceTable(text);
+        string stored = document.ToString();
+        long start = 17, length = stored.Length - 40;
+
+        foreach (string lineEnding in new[] { "CRLF", "LF", "CR" })
+        {
+            string lineBreak = lineEnding == "CRLF" ? "\r\n" : lineEnding == "CR" ? "\r" : "\n";
+            string expected = stored.Substring((int)start, (int)length)
+                .Replace("\r\n", "\n").Replace("\r", "\n").Replace("\n", lineBreak);
+
+            foreach (System.Text.Encoding encoding in new[] { Utf8, System.Text.Encoding.Unicode, Gb18030 })
+            {
+                var output = new MemoryStream();
+                long reported = 0;
+                StreamingTranscoder.Encode(document, start, length, output, encoding, lineEnding,
+                    new SynchronousProgress(n => reported = n));
+                Assert.SequenceEqual(encoding.GetBytes(expected), output.ToArray());
+                Assert.Equal(length, reported);
+            }
+        }
+    }
+
+    private static string BuildText(int seed, int length)
+    {
+        var random = new Random(seed);
+        string[] pieces = ["plain ascii ", "é", "中文", "\U0001F600", "\r\n", "\n", "\r", "ГБ", "x"];
+        var sb = new StringBuilder(length + 16);
+        while (sb.Length < length)
+            sb.Append(pieces[random.Next(pieces.Length)]);
+        return sb.ToString();
+    }
+
+    private static System.Text.Encoding CodePagesEncoding(int codePage)
+    {
+        System.Text.Encoding.RegisterProvider(CodePagesEncodingProvider.Instance);
+        return System.Text.Encoding.GetEncoding(codePage);
+    }
+
+    private sealed class SynchronousProgress(Action<long> report) : IProgress<long>
+    {
+        public void Report(long value) => report(value);
+    }
+}
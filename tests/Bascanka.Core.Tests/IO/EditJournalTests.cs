@@ -0,0 +1,111 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Commands;
+using Bascanka.Core.IO;
+
+namespace Bascanka.Core.Tests.IO;
+
+/// <summary>
+/// Replaying the checkpoint and log must reproduce the document after every
+/// write, and a write after a small edit must be small.
+/// </summary>
+public sealed class EditJournalTests
+{
+    [Test]
+    public void ReplayMatchesTheDocumentAfterEveryWrite()
+    {
+        using var files = new JournalFiles();
+        var doc = new PieceTable(string.Join('\n', Enumerable.Range(0, 2_000).Select(i => $"line {i}")));
+        var history = new CommandHistory();
+        using var journal = new EditJournal(files.Checkpoint, files.Log);
+        var random = new Random(3);
+
+        for (int tick = 0; tick < 60; tick++)
+        {
+            for (int i = 0; i < 5; i++)
+            {
+                long at = random.NextInt64(doc.Length + 1);
+                if (random.Next(4) == 0 && history.CanUndo)
+                    history.Undo();
+                else if (random.Next(3) == 0 && at < doc.Length)
+                    history.Execute(new DeleteCommand(doc, at, Math.Min(random.Next(1, 30), doc.Length - at)));
+                else
+                    history.Execute(new InsertCommand(doc, at, random.Next(2) == 0 ? "x" : "😀 typed\n"));
+            }
+
+            journal.Write(doc, includeOriginal: true);
+
+            JournalSnapshot? snapshot = EditJournal.Read(files.Checkpoint, files.Log);
+            Assert.True(snapshot is not null);
+            Assert.Equal(doc.ToString(), snapshot!.BuildText());
+        }
+    }
+
+    [Test]
+    public void SmallEditsAppendSmallRecords()
+    {
+        using var files = new JournalFiles();
+        var doc = new PieceTable(new string('a', 4 * 1024 * 1024));
+        using var journal = new EditJournal(files.Checkpoint, files.Log);
+        journal.Write(doc, includeOriginal: true);
+        Assert.True(journal.LastWriteWasCheckpoint);
+
+        doc.Insert(1_000_000, "hello");
+        journal.Write(doc, includeOriginal: true);
+
+        Assert.True(!journal.LastWriteWasCheckpoint);
+        Assert.AtMost(200, journal.LastWriteBytes);
+
+        journal.Write(doc, includeOriginal: true);
+        Assert.Equal(0L, journal.LastWriteBytes);
+    }
+
+    [Test]
+    public void TornRecordIsIgnored()
+    {
+        using var files = new JournalFiles();
+        var doc = new PieceTable("first line\n");
+        using var journal = new EditJournal(files.Checkpoint, files.Log);
+        journal.Write(doc, includeOriginal: true);
+        doc.Insert(0, "A");
+        journal.Write(doc, includeOriginal: true);
+        string afterFirst = doc.ToString();
+        doc.Insert(3, "BBBB");
+        journal.Write(doc, includeOriginal: true);
+        journal.Dispose();
+
+        using (var fs = new FileStream(files.Log, FileMode.Open))
+            fs.SetLength(fs.Length - 3);
+
+        Assert.Equal(afterFirst, EditJournal.Read(files.Checkpoint, files.Log)!.BuildText());
+    }
+
+    [Test]
+    public void LargeLogIsCompactedIntoACheckpoint()
+    {
+        using var files = new JournalFiles();
+        var doc = new PieceTable("start");
+        using var journal = new EditJournal(files.Checkpoint, files.Log);
+        journal.Write(doc, includeOriginal: true);
+
+        doc.Insert(doc.Length, new string('z', 600_000));
+        journal.Write(doc, includeOriginal: true);
+        Assert.True(journal.LogBytes > EditJournal.CompactionMinBytes);
+
+        doc.Insert(0, "!");
+        journal.Write(doc, includeOriginal: true);
+        Assert.True(journal.LastWriteWasCheckpoint);
+        Assert.AtMost(64, journal.LogBytes);
+        Assert.Equal(doc.ToString(), EditJournal.Read(files.Checkpoint, files.Log)!.BuildText());
+    }
+
+    /// <summary>A checkpoint and log path in a temporary directory.</summary>
+    private sealed class JournalFiles : IDisposable
+    {
+        private readonly string _dir = Directory.CreateTempSubdirectory("bascanka-journal").FullName;
+
+        public string Checkpoint => Path.Combine(_dir, "doc.checkpoint");
+        public string Log => Path.Combine(_dir, "doc.journal");
+
+        public void Dispose() => Directory.Delete(_dir, recursive: true);
+    }
+}
@@ -0,0 +1,89 @@
+using Bascanka.Core.Layout;
+
+namespace Bascanka.Core.Tests.Layout;
+
+/// <summary>
+/// Shaping places clusters at the widths of their classes, and the cache
+/// shares runs by text, font and style while staying within its budget.
+/// </summary>
+public sealed class GlyphRunCacheTests
+{
+    private static readonly CharWidthMetrics Metrics = new(7, 14, 15, 13, 16);
+
+    [Test]
+    public void ShapingFoldsZeroWidthMarksIntoClusters()
+    {
+        GlyphRun simple = GlyphRun.Shape("plain text", Metrics);
+        Assert.True(simple.IsSimple);
+        Assert.Equal(70, simple.Width);
+
+        // Base + combining accent, a wide ideograph, an emoji with a
+        // variation selector, and a supplementary ideograph.
+        GlyphRun run = GlyphRun.Shape("e\u0301中⌚\uFE0F\U00020000x", Metrics);
+        Assert.True(!run.IsSimple);
+        Assert.SequenceEqual(["e\u0301", "中", "⌚\uFE0F", "\U00020000", "x"], run.Clusters.Select(c => c.Text));
+        Assert.SequenceEqual([0, 2, 3, 5, 7], run.Clusters.Select(c => c.Offset));
+        Assert.SequenceEqual([0, 7, 21, 36, 49], run.Clusters.Select(c => c.X));
+        Assert.Equal(56, run.Width);
+
+        // A leading zero-width character has nothing to attach to.
+        Assert.Equal(1, GlyphRun.Shape("\u0301中", Metrics).Clusters.Length);
+    }
+
+    [Test]
+    public void RunsAreSharedByTextFontAndStyle()
+    {
+        var cache = new GlyphRunCache();
+        GlyphRun first = cache.GetOrAdd("let 中 = 1;".AsSpan(), fontKey: 1, style: 0, Metrics);
+        Assert.True(ReferenceEquals(first, cache.GetOrAdd("let 中 = 1;", 1, 0, Metrics)));
+        Assert.True(ReferenceEquals(first, cache.Peek("xlet 中 = 1;".AsSpan(1), 1, 0)));
+        Assert.True(!ReferenceEquals(first, cache.GetOrAdd("let 中 = 1;", 2, 0, Metrics)));
+        Assert.True(!ReferenceEquals(first, cache.GetOrAdd("let 中 = 1;", 1, 1, Metrics)));
+        Assert.Equal(1L, cache.Hits);
+        Assert.Equal(3L, cache.Misses);
+        Assert.Equal(3, cache.Count);
+
+        // Short clusters are one string across the runs of a cache, but
+        // not across caches.
+        GlyphRun other = cache.GetOrAdd("中文", 1, 0, Metrics);
+        Assert.True(ReferenceEquals(first.Clusters[4].Text, other.Clusters[0].Text));
+        GlyphRun elsewhere = new GlyphRunCache().GetOrAdd("中文", 1, 0, Metrics);
+        Assert.True(!ReferenceEquals(first.Clusters[4].Text, elsewhere.Clusters[0].Text));
+
+        cache.RemoveFont(1);
+        Assert.Equal(1, cache.Count);
+        Assert.True(cache.Peek("let 中 = 1;", 1, 0) is null);
+        Assert.True(cache.Peek("let 中 = 1;", 2, 0) is not null);
+    }
+
+    [Test]
+    public void LeastRecentlyUsedRunsAreEvictedWithinTheBudget()
+    {
+        var cache = new GlyphRunCache(maxBytes: 64 * 1024);
+        for (int i = 0; i < 2000; i++)
+        {
+            cache.GetOrAdd($"token {i}", 0, 0, Metrics);
+            // Keep the first run in use; it must never be evicted.
+            cache.GetOrAdd("token 0", 0, 0, Metrics);
+            Assert.AtMost(cache.MaxBytes, cache.Bytes);
+        }
+        Assert.True(cache.Evictions > 0);
+        Assert.True(cache.Peek("token 0", 0, 0) is not null);
+        Assert.True(cache.Peek("token 1", 0, 0) is null);
+        Assert.True(cache.Peek("token 1999", 0, 0) is not null);
+
+        // Lowering the budget evicts at once.
+        cache.MaxBytes = 4096;
+        Assert.AtMost(4096, cache.Bytes);
+
+        // A run too long to keep is shaped but not stored.
+        var big = new GlyphRunCache();
+        string line = new('x', GlyphRunCache.MaxRunLength + 1);
+        Assert.Equal(line.Length * Metrics.Narrow, big.GetOrAdd(line, 0, 0, Metrics).Width);
+        Assert.Equal(0, big.Count);
+
+        cache.Clear();
+        Assert.Equal(0, cache.Count);
+        Assert.Equal(0L, cache.Bytes);
+    }
+}
@@ -0,0 +1,133 @@
+using System.Text;
+using Bascanka.Core.Layout;
+
+namespace Bascanka.Core.Tests.Layout;
+
+/// <summary>
+/// The vectorised narrow fast path must agree with classifying one
+/// character at a time: for the width table itself, and for line width
+/// maps built with and without a position array.
+/// </summary>
+public sealed class LineWidthMapTests
+{
+    private static readonly CharWidthMetrics Metrics = new(7, 14, 15, 13, 16);
+
+    [Test]
+    public void NarrowFastPathAgreesWithClassification()
+    {
+        // Every BMP code unit on its own: the fast path may only claim
+        // characters that classify as narrow, and must claim all of the
+        // printable Latin range it covers.
+        for (int c = 0; c <= char.MaxValue; c++)
+        {
+            string text = ((char)c).ToString();
+            bool fast = CharWidthTable.IsNarrowWithoutTabs(text);
+            if (fast)
+                Assert.Equal(CharWidthClass.Narrow, CharWidthTable.Classify(text, 0));
+            if (c >= ' ' && c < 0x0300)
+                Assert.True(fast, $"U+{c:X4}");
+        }
+
+        // Long runs, so that the vector loop and its tail both see a
+        // character outside the range at every position.
+        string plain = new('a', 300);
+        Assert.True(CharWidthTable.IsNarrowWithoutTabs(plain));
+        foreach (char odd in "\t̀中😀\u001F")
+        {
+            for (int i = 0; i < plain.Length; i += 13)
+            {
+                string text = plain[..i] + odd + plain[(i + 1)..];
+                Assert.True(!CharWidthTable.IsNarrowWithoutTabs(text), $"{(int)odd:X4} at {i}");
+            }
+        }
+    }
+
+    [Test]
+    public void MapsMatchAScalarLayout()
+    {
+        var random = new Random(77);
+        string[] pieces = ["abc", " ", "\t", "é", "́", "中", "한", "⌚", "\U0001F600",
+            "\U00020000", "\U0001F1EC\U0001F1E7", "1️⃣", "‍", "\uD83D", "ž"];
+
+        for (int round = 0; round < 400; round++)
+        {
+            var sb = new StringBuilder();
+            int count = random.Next(0, 40);
+            // Half the lines use only narrow pieces, to exercise the fast path.
+            int limit = round % 2 == 0 ? 2 : pieces.Length;
+            for (int i = 0; i < count; i++)
+                sb.Append(pieces[random.Next(limit)]);
+            string text = sb.ToString();
+            int tabSize = 1 + random.Next(8);
+
+            LineWidthMap map = LineWidthMap.Build(text, Metrics, tabSize);
+            int[] x = ScalarPositions(text, tabSize);
+            Assert.Equal(CharWidthTable.IsNarrowWithoutTabs(text), map.IsUniformNarrow);
+            Assert.Equal(x[^1], map.TotalWidth);
+
+            for (int i = 0; i <= text.Length; i++)
+                Assert.Equal(x[i], map.GetX(i));
+            for (int i = 0; i < text.Length; i++)
+                Assert.Equal(x[i + 1] - x[i], map.GetAdvance(i));
+
+            for (int px = -3; px <= x[^1] + 10; px += 1 + random.Next(5))
+            {
+                Assert.Equal(ScalarIndexAtOrAfterX(x, px), map.IndexAtOrAfterX(px));
+                int start = random.Next(text.Length + 1);
+                Assert.Equal(ScalarNearestIndex(x, start, px), map.NearestIndex(start, px));
+            }
+        }
+    }
+
+    /// <summary>Character positions computed one character at a time.</summary>
+    private static int[] ScalarPositions(string text, int tabSize)
+    {
+        var x = new int[text.Length + 1];
+        int col = 0;
+        for (int i = 0; i < text.Length; i++)
+        {
+            CharWidthClass cls = CharWidthTable.Classify(text, i);
+            if (cls == CharWidthClass.Tab)
+            {
+                int spaces = tabSize - col % tabSize;
+                x[i + 1] = x[i] + spaces * Metrics.Narrow;
+                col += spaces;
+            }
+            else
+            {
+                x[i + 1] = x[i] + Metrics.GetWidth(cls);
+                col++;
+            }
+        }
+        return x;
+    }
+
+    private static int ScalarIndexAtOrAfterX(int[] x, int px)
+    {
+        int length = x.Length - 1;
+        for (int i = 0; i < length; i++)
+        {
+            if (x[i + 1] > px)
+                return SkipZeroWidth(x, i);
+        }
+        return length;
+    }
+
+    private static int ScalarNearestIndex(int[] x, int start, int px)
+    {
+        int length = x.Length - 1;
+        for (int i = start; i < length; i++)
+        {
+            if (x[i] + (x[i + 1] - x[i]) / 2 > x[start] + px)
+                return SkipZeroWidth(x, i);
+        }
+        return length;
+    }
+
+    private static int SkipZeroWidth(int[] x, int i)
+    {
+        while (i < x.Length - 1 && x[i + 1] == x[i])
+            i++;
+        return i;
+    }
+}
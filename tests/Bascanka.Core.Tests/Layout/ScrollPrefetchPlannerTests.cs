@@ -0,0 +1,66 @@
+using Bascanka.Core.Layout;
+
+namespace Bascanka.Core.Tests.Layout;
+
+/// <summary>
+/// The look-ahead window follows the scroll direction, grows with a
+/// sustained scroll within its bounds, and starts over after a pause.
+/// </summary>
+public sealed class ScrollPrefetchPlannerTests
+{
+    private const int Visible = 50;
+    private const long LineCount = 1_000_000;
+
+    [Test]
+    public void WindowFollowsDirectionAndSpeed()
+    {
+        var planner = new ScrollPrefetchPlanner();
+
+        // Idle: the screen below the viewport.
+        Assert.Equal((1050L, 1100L), planner.GetPrefetchRange(1000, Visible, LineCount));
+
+        // A slow scroll down keeps one screen ahead.
+        planner.Observe(1000, 0);
+        planner.Observe(1003, 100);
+        Assert.Equal(1, planner.Direction);
+        Assert.Equal((1053L, 1103L), planner.GetPrefetchRange(1003, Visible, LineCount));
+
+        // A fast flick reaches further ahead, up to the bound.
+        for (long t = 1, line = 1003; t <= 20; t++)
+            planner.Observe(line += 2000, 100 + t * 16);
+        var (start, end) = planner.GetPrefetchRange(41_003, Visible, LineCount);
+        Assert.Equal(41_053L, start);
+        Assert.Equal((long)Visible * ScrollPrefetchPlanner.MaxLookaheadScreens, end - start);
+
+        // Reversing is reported, and the window moves above the viewport.
+        Assert.True(planner.Observe(40_000, 500));
+        Assert.Equal(-1, planner.Direction);
+        (start, end) = planner.GetPrefetchRange(40_000, Visible, LineCount);
+        Assert.Equal(40_000L, end);
+        Assert.True(start < end);
+
+        // Near the document edges the window is clipped.
+        Assert.Equal((0L, 20L), planner.GetPrefetchRange(20, Visible, LineCount));
+        planner.Reset();
+        Assert.Equal((LineCount, LineCount), planner.GetPrefetchRange(LineCount - 10, Visible, LineCount));
+    }
+
+    [Test]
+    public void PauseStartsANewGesture()
+    {
+        var planner = new ScrollPrefetchPlanner();
+        planner.Observe(0, 0);
+        planner.Observe(500, 50);
+        Assert.True(planner.Velocity > 0);
+
+        // Samples too far apart start over; a gesture that had a direction
+        // reports it as dropped.
+        Assert.True(planner.Observe(100, 5_000));
+        Assert.Equal(0, planner.Direction);
+        Assert.Equal(0.0, planner.Velocity);
+
+        // A sample at the same line changes nothing.
+        Assert.True(!planner.Observe(100, 5_010));
+        Assert.Equal(0, planner.Direction);
+    }
+}
@@ -0,0 +1,129 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Commands;
+using Bascanka.Core.Layout;
+
+namespace Bascanka.Core.Tests.Layout;
+
+/// <summary>
+/// Checks that incremental splicing after an edit leaves the same layout
+/// as laying the edited document out from scratch.
+/// </summary>
+public sealed class WrapLayoutEngineTests
+{
+    private const int WrapWidth = 10;
+
+    private static readonly string Sample = string.Join('\n',
+        "short",
+        "a line that wraps over several rows",
+        "",
+        "\tindented with a tab and long enough to wrap",
+        "x",
+        "another fairly long line of text here",
+        "end");
+
+    [Test]
+    public void InsertWithinLineMatchesFullRelayout()
+    {
+        AssertSplice(Sample, doc => doc.Insert(8, "inserted text that wraps"));
+    }
+
+    [Test]
+    public void InsertLinesMatchesFullRelayout()
+    {
+        AssertSplice(Sample, doc => doc.Insert(20, "one\ntwo that is long enough\n\nfour"));
+    }
+
+    [Test]
+    public void InsertAtDocumentEdgesMatchesFullRelayout()
+    {
+        AssertSplice(Sample, doc => doc.Insert(0, "head\n"));
+        AssertSplice(Sample, doc => doc.Insert(doc.Length, "\ntail that wraps once"));
+    }
+
+    [Test]
+    public void DeleteWithinLineMatchesFullRelayout()
+    {
+        AssertSplice(Sample, doc => doc.Delete(10, 12));
+    }
+
+    [Test]
+    public void DeleteAcrossLinesMatchesFullRelayout()
+    {
+        AssertSplice(Sample, doc => doc.Delete(3, 40));
+        AssertSplice(Sample, doc => doc.Delete(0, doc.Length));
+    }
+
+    [Test]
+    public void BulkReplaceMatchesFullRelayout()
+    {
+        // A single TextChanged that both removes and inserts text.
+        AssertSplice(Sample, doc => new BulkEditCommand(doc,
+        [
+            new TextEdit(2, 4, "A\nB\nC"),
+            new TextEdit(30, 15, "replaced"),
+            new TextEdit(60, 0, "\n\n"),
+        ]).Execute());
+    }
+
+    [Test]
+    public void RandomEditsMatchFullRelayout()
+    {
+        var random = new Random(76);
+        var doc = new PieceTable(Sample);
+        var engine = CreateEngine(doc);
+
+        for (int i = 0; i < 500; i++)
+        {
+            _ = engine.TotalRows;   // measure, so the edit is spliced rather than reset
+
+            long offset = random.NextInt64(doc.Length + 1);
+            if (random.Next(2) == 0 || doc.Length == offset)
+            {
+                string text = random.Next(3) switch
+                {
+                    0 => "\n",
+                    1 => new string('w', random.Next(1, 25)),
+                    _ => "p\nq that wraps past the width\n",
+                };
+                doc.Insert(offset, text);
+            }
+            else
+            {
+                doc.Delete(offset, random.NextInt64(1, Math.Min(30, doc.Length - offset) + 1));
+            }
+
+            AssertSameLayout(doc, engine);
+        }
+    }
+
+    private static void AssertSplice(string text, Action<PieceTable> edit)
+    {
+        var doc = new PieceTable(text);
+        var engine = CreateEngine(doc);
+        _ = engine.TotalRows;
+
+        edit(doc);
+        AssertSameLayout(doc, engine);
+    }
+
+    private static WrapLayoutEngine CreateEngine(PieceTable doc)
+    {
+        var engine = new WrapLayoutEngine(new MonospaceTextMeasurer()) { Document = doc, WrapWidth = WrapWidth };
+        doc.TextChanged += (_, e) => engine.ApplyTextChange(e);
+        return engine;
+    }
+
+    private static void AssertSameLayout(PieceTable doc, WrapLayoutEngine engine)
+    {
+        var fresh = new WrapLayoutEngine(new MonospaceTextMeasurer()) { Document = doc, WrapWidth = WrapWidth };
+
+        Assert.Equal(fresh.TotalRows, engine.TotalRows);
+        for (long line = 0; line < doc.LineCount; line++)
+        {
+            Assert.Equal(fresh.GetRowCount(line), engine.GetRowCount(line));
+            Assert.Equal(fresh.LineToRow(line), engine.LineToRow(line));
+        }
+        for (long row = 0; row < fresh.TotalRows; row++)
+            Assert.Equal(fresh.RowToLine(row), engine.RowToLine(row));
+    }
+}
@@ -0,0 +1,194 @@
+using System.Text.RegularExpressions;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Commands;
+using Bascanka.Core.Macros;
+
+namespace Bascanka.Core.Tests.Macros;
+
+/// <summary>
+/// Headless playback must produce the same text and caret as performing
+/// the same operations on the document directly.
+/// </summary>
+public sealed class MacroEngineTests
+{
+    [Test]
+    public void RunMatchesDirectPlayback()
+    {
+        MacroOp[] ops =
+        [
+            MacroOp.Insert("// "),
+            MacroOp.MoveLineDown(),
+            MacroOp.MoveBy(-3),
+            MacroOp.Delete(2),
+            MacroOp.Backspace(),
+        ];
+        string text = string.Join('\n', Enumerable.Range(0, 200).Select(i => $"statement {i};"));
+
+        AssertSameAsDirect(text, 5, ops, times: 150);
+    }
+
+    [Test]
+    public void RunToEndStopsAtTheEndAndCommitsAsOneStep()
+    {
+        string text = string.Join('\n', Enumerable.Range(0, 1_000).Select(i => $"key{i} = value{i}"));
+        var engine = new MacroEngine([MacroOp.Replace(" = ", ": ")]);
+        var doc = new PieceTable(text);
+
+        MacroRunResult result = engine.RunToEnd(doc, 0);
+        var history = new CommandHistory();
+        history.Execute(new BulkEditCommand(doc, result.Edits));
+
+        Assert.Equal(text.Replace(" = ", ": "), doc.ToString());
+        history.Undo();
+        Assert.Equal(text, doc.ToString());
+    }
+
+    [Test]
+    public void RunToEndStopsWhenTheMacroMakesNoProgress()
+    {
+        var doc = new PieceTable("abc");
+        var engine = new MacroEngine([MacroOp.Insert("x"), MacroOp.MoveBy(-1)]);
+
+        MacroRunResult result = engine.RunToEnd(doc, 0);
+
+        Assert.Equal(1, result.Iterations);
+    }
+
+    [Test]
+    public void FoldingJoinsAdjacentOperations()
+    {
+        var engine = new MacroEngine(
+        [
+            MacroOp.Insert("a"), MacroOp.Insert("b"),
+            MacroOp.MoveBy(1), MacroOp.MoveBy(2),
+            MacroOp.Delete(), MacroOp.Delete(),
+            MacroOp.MoveBy(5), MacroOp.MoveTo(0),
+        ]);
+
+        Assert.SequenceEqual(
+            [MacroOp.Insert("ab"), MacroOp.MoveBy(3), MacroOp.Delete(2), MacroOp.MoveTo(0)],
+            engine.Operations);
+    }
+
+    [Test]
+    public void RunOnMatchingLinesMatchesPlayingEachLineSeparately()
+    {
+        // Long enough to span several read windows, with a final line that
+        // has no line feed.
+        string text = string.Join('\n', Enumerable.Range(0, 60_000).Select(i => i % 3 == 0
+            ? $"TODO item {i} needs review"
+            : $"done item {i}"));
+        MacroOp[] ops = [MacroOp.Delete(5), MacroOp.MoveToDocumentEnd(), MacroOp.Insert(";")];
+        var doc = new PieceTable(text);
+
+        MacroRunResult result = new MacroEngine(ops).RunOnMatchingLines(doc, line => line.StartsWith("TODO"));
+        new BulkEditCommand(doc, result.Edits).Execute();
+
+        string expected = string.Join('\n', text.Split('\n')
+            .Select(line => line.StartsWith("TODO") ? line[5..] + ";" : line));
+        Assert.Equal(expected, doc.ToString());
+        Assert.Equal(20_000, result.Iterations);
+    }
+
+    [Test]
+    public void RunOnMatchingLinesMapsTheCaretAndSkipsUnchangedLines()
+    {
+        var doc = new PieceTable("a=1\nb=2\nc=3");
+        var engine = new MacroEngine([MacroOp.Replace("=", " = ")]);
+
+        MacroRunResult result = engine.RunOnMatchingLines(doc, line => !line.StartsWith("b"), caret: 10);
+
+        Assert.Equal(2, result.Edits.Count);
+        Assert.Equal(12, result.Caret);
+
+        result = engine.RunOnMatchingLines(doc, line => line.Contains('x'));
+        Assert.Equal(0, result.Edits.Count);
+        Assert.Equal(0, result.Iterations);
+    }
+
+    [Test]
+    public void RunOnMatchingLinesIsCancellable()
+    {
+        var doc = new PieceTable(string.Join('\n', Enumerable.Range(0, 1_000).Select(i => $"line {i}")));
+        using var cts = new CancellationTokenSource();
+        cts.Cancel();
+
+        bool cancelled = false;
+        try
+        {
+            new MacroEngine([MacroOp.Insert("x")]).RunOnMatchingLines(doc, _ => true, cancellationToken: cts.Token);
+        }
+        catch (OperationCanceledException)
+        {
+            cancelled = true;
+        }
+        Assert.True(cancelled);
+    }
+
+    [Test]
+    public void RunOnMatchingLinesRethrowsARegexTimeoutUnwrapped()
+    {
+        // Enough lines for several parallel batches, each of which fails.
+        var doc = new PieceTable(string.Join('\n', Enumerable.Range(0, 50_000).Select(i => $"line {i}")));
+        var slow = new Regex("(a+)+$", RegexOptions.None, TimeSpan.FromMilliseconds(1));
+        string input = new string('a', 40) + "!";
+
+        Exception? thrown = null;
+        try
+        {
+            new MacroEngine([MacroOp.Insert("x")]).RunOnMatchingLines(doc, _ => slow.IsMatch(input));
+        }
+        catch (Exception ex)
+        {
+            thrown = ex;
+        }
+        Assert.True(thrown is RegexMatchTimeoutException);
+    }
+
+    private static void AssertSameAsDirect(string text, long caret, MacroOp[] ops, int times)
+    {
+        var snapshot = new PieceTable(text);
+        MacroRunResult result = new MacroEngine(ops).Run(snapshot, caret, times);
+        new BulkEditCommand(snapshot, result.Edits).Execute();
+
+        var direct = new PieceTable(text);
+        long directCaret = caret;
+        for (int i = 0; i < times; i++)
+        {
+            foreach (MacroOp op in ops)
+                directCaret = ApplyDirect(direct, directCaret, op);
+        }
+
+        Assert.Equal(direct.ToString(), snapshot.ToString());
+        Assert.Equal(directCaret, result.Caret);
+    }
+
+    private static long ApplyDirect(PieceTable doc, long caret, MacroOp op)
+    {
+        switch (op.Kind)
+        {
+            case MacroOpKind.Insert:
+                doc.Insert(caret, op.Text!);
+                return caret + op.Text!.Length;
+            case MacroOpKind.Delete:
+                doc.Delete(caret, Math.Min(op.Count, doc.Length - caret));
+                return caret;
+            case MacroOpKind.Backspace:
+            {
+                long count = Math.Min(op.Count, caret);
+                doc.Delete(caret - count, count);
+                return caret - count;
+            }
+            case MacroOpKind.MoveBy:
+                return Math.Clamp(caret + op.Count, 0, doc.Length);
+            case MacroOpKind.MoveLineDown:
+            {
+                var (line, column) = doc.OffsetToLineColumn(caret);
+                if (line + 1 >= doc.LineCount) return doc.Length;
+                return doc.GetLineStartOffset(line + 1) + Math.Min(column, doc.GetLineLength(line + 1));
+            }
+            default:
+                throw new NotSupportedException(op.Kind.ToString());
+        }
+    }
+}
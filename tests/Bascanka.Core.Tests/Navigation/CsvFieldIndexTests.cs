@@ -0,0 +1,131 @@
+using System.Text;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Navigation;
+using Bascanka.Core.Transforms;
+
+namespace Bascanka.Core.Tests.Navigation;
+
+/// <summary>
+/// The field index built from parallel blocks must agree with a sequential
+/// parse, also when quoted line breaks straddle the block boundaries, and
+/// the column operations built on it must honour quotes.
+/// </summary>
+public sealed class CsvFieldIndexTests
+{
+    [Test]
+    public void QuotedLineBreaksAcrossBlocksMatchASequentialParse()
+    {
+        // Most line feeds are inside quoted fields, so most block
+        // boundaries fall inside a record.
+        var sb = new StringBuilder("id,note,tail\r\n");
+        for (int i = 0; sb.Length < 3_500_000; i++)
+        {
+            sb.Append(i).Append(",\"");
+            for (int j = 0; j < i % 40; j++)
+                sb.Append("part ").Append(j).Append(", \"\"q\"\"\n");
+            sb.Append("end\",").Append(i % 3 == 0 ? "\"a,b\"" : "x").Append("\r\n");
+        }
+        string csv = sb.ToString();
+        var document = new PieceTable(csv);
+
+        var index = CsvFieldIndex.Build(document, CsvDialect.Comma);
+        List<string[]> expected = Reference(csv);
+
+        Assert.Equal(expected.Count, index.RecordCount);
+        Assert.Equal(3, index.ColumnCount);
+        Assert.True(index.HasMultilineRecords);
+        foreach (int record in new[] { 0, 1, 2, 39, expected.Count / 2, expected.Count - 1 })
+            Assert.SequenceEqual(expected[record], index.ReadRecord(document, record));
+        for (long record = 0; record < index.RecordCount; record += 97)
+            Assert.True(!index.StartsInQuotes(index.GetRecordLine(record)));
+        Assert.Equal(4, index.ColumnWidths[2]);  // "tail"; "a,b" counts without its quotes
+    }
+
+    [Test]
+    public void ColumnStatisticsSortAndFilter()
+    {
+        string csv = "name,price,city\n" +
+                     "pear,\"1,200.5\",Split\n" +
+                     "apple,3,\"Zagreb\"\n" +
+                     "fig,-2,Split\n" +
+                     "kiwi,,\"Say \"\"hi\"\"\"\n";
+        var document = new PieceTable(csv);
+        var index = CsvFieldIndex.Build(document, CsvDialect.Detect(csv));
+
+        var city = CsvColumnStatistics.Compute(document, index, 2, skipHeader: true);
+        Assert.Equal(4L, city.Count);
+        Assert.Equal(3L, city.DistinctCount);
+        Assert.Equal("Say \"hi\"", city.Min);
+        Assert.Equal("Zagreb", city.Max);
+        Assert.True(!city.IsNumeric);
+
+        var price = CsvColumnStatistics.Compute(document, index, 1, skipHeader: true);
+        Assert.Equal(1L, price.EmptyCount);
+        Assert.True(!price.IsNumeric);  // "1,200.5" is not an invariant number.
+
+        var sorted = new StringWriter();
+        LineSorter.Create(new LineSortOptions { Csv = CsvDialect.Comma, KeyField = 3, KeepFirstLine = true })
+            (document, 0, csv.Length, sorted, null, default);
+        Assert.Equal("name,price,city\nkiwi,,\"Say \"\"hi\"\"\"\npear,\"1,200.5\",Split\nfig,-2,Split\napple,3,\"Zagreb\"\n",
+            sorted.ToString());
+
+        var filtered = new StringWriter();
+        LineFilter.Create(CsvDialect.Comma.CreateFieldPredicate(2, "Say \"hi\""), keepFirstLine: true)
+            (document, 0, csv.Length, filtered, null, default);
+        Assert.Equal("name,price,city\nkiwi,,\"Say \"\"hi\"\"\"\n", filtered.ToString());
+    }
+
+    [Test]
+    public void LargeDistinctCountsAreEstimated()
+    {
+        var sb = new StringBuilder();
+        const int distinct = 1_500_000;
+        for (int i = 0; i < distinct; i++)
+            sb.Append(i % 7).Append('\t').Append(i).Append('\n');
+        string tsv = sb.ToString();
+        var document = new PieceTable(tsv);
+        var index = CsvFieldIndex.Build(document, CsvDialect.Detect(tsv));
+
+        var ids = CsvColumnStatistics.Compute(document, index, 1);
+        Assert.True(!ids.IsDistinctCountExact);
+        Assert.True(Math.Abs(ids.DistinctCount - distinct) < distinct / 50, $"estimate {ids.DistinctCount}");
+        Assert.Equal(distinct - 1.0, ids.NumericMax);
+
+        var groups = CsvColumnStatistics.Compute(document, index, 0);
+        Assert.True(groups.IsDistinctCountExact);
+        Assert.Equal(7L, groups.DistinctCount);
+    }
+
+    /// <summary>A straightforward RFC 4180 parse of the whole text.</summary>
+    private static List<string[]> Reference(string csv)
+    {
+        var records = new List<string[]>();
+        var fields = new List<string>();
+        var field = new StringBuilder();
+        bool inQuotes = false, atFieldStart = true;
+        for (int i = 0; i < csv.Length; i++)
+        {
+            char c = csv[i];
+            if (inQuotes)
+            {
+                if (c == '"' && i + 1 < csv.Length && csv[i + 1] == '"') { field.Append('"'); i++; }
+                else if (c == '"') inQuotes = false;
+                else if (c != '\r') field.Append(c);
+                continue;
+            }
+
+            if (c == '"' && atFieldStart) { inQuotes = true; atFieldStart = false; }
+            else if (c == ',') { fields.Add(field.ToString()); field.Clear(); atFieldStart = true; }
+            else if (c == '\n')
+            {
+                fields.Add(field.ToString());
+                field.Clear();
+                records.Add([.. fields]);
+                fields.Clear();
+                atFieldStart = true;
+            }
+            else if (c != '\r') { field.Append(c); atFieldStart = false; }
+        }
+        return records;
+    }
+}
@@ -0,0 +1,84 @@
+using System.Text;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Navigation;
+
+namespace Bascanka.Core.Tests.Navigation;
+
+/// <summary>
+/// Counts kept per chunk must equal a count of the whole text after a
+/// parallel count, after edits applied chunk by chunk, and for ranges made
+/// of cached chunks and the text at their ends.
+/// </summary>
+public sealed class DocumentStatisticsTests
+{
+    private static readonly System.Text.Encoding Gb18030 = CodePagesEncoding(54936);
+
+    [Test]
+    public void CountsFollowEditsAndRanges()
+    {
+        var random = new Random(99);
+        var sb = new StringBuilder();
+        string[] words = ["alpha", "beta", "été", "中文", "\U0001F600", "  ", "\t"];
+        while (sb.Length < 2_600_000)
+        {
+            int count = random.Next(0, 12);
+            for (int w = 0; w < count; w++)
+                sb.Append(words[random.Next(words.Length)]).Append(' ');
+            sb.Append(random.Next(4) == 0 ? "\r\n" : "\n");
+        }
+        var document = new PieceTable(sb.ToString());
+        var statistics = new DocumentStatistics(Gb18030);
+        statistics.CountRemaining(document);
+        Assert.Equal(document.Length, statistics.CountedLength);
+        Assert.Equal(TextStatistics.Count(document.ToString(), Gb18030), statistics.Total);
+        Assert.Equal(document.LineCount, statistics.Total.Lines);
+
+        // Edits are applied as the document reports them.
+        document.TextChanged += (_, e) => statistics.Update(document, e.Offset, e.OldLength, e.NewLength);
+        string[] inserts = ["", "word", "\n", "a b\n\nc", " ", "x\r\n"];
+        for (int round = 0; round < 40; round++)
+        {
+            long offset = round % 10 == 0 ? document.Length : random.NextInt64(document.Length);
+            long removed = round % 3 == 0 ? 0 : Math.Min(random.Next(0, 1_500_000 / (round + 1)), document.Length - offset);
+            string inserted = inserts[round % inserts.Length];
+            if (removed > 0) document.Delete(offset, removed);
+            if (inserted.Length > 0) document.Insert(offset, inserted);
+
+            string text = document.ToString();
+            Assert.Equal(TextStatistics.Count(text, Gb18030), statistics.Total);
+
+            long start = random.NextInt64(text.Length + 1);
+            int length = (int)random.NextInt64(text.Length - start + 1);
+            Assert.Equal(TextStatistics.Count(text.AsSpan((int)start, length), Gb18030),
+                statistics.GetRange(document, start, length));
+        }
+
+        // A document that grew at the end only needs its new text counted.
+        var grown = new PieceTable(document.ToString() + "tail words\nmore");
+        statistics.CountRemaining(grown);
+        Assert.Equal(TextStatistics.Count(grown.ToString(), Gb18030), statistics.Total);
+    }
+
+    [Test]
+    public void CountsWordsLinesAndBytes()
+    {
+        var counts = TextStatistics.Count("one two\r\n\r\n  three\n\t\nfour", System.Text.Encoding.Unicode);
+        Assert.Equal(4L, counts.Words);
+        Assert.Equal(5L, counts.Lines);
+        Assert.Equal(3L, counts.NonBlankLines);
+        Assert.Equal(7L, counts.MaxLineLength);
+        Assert.Equal(25L, counts.Utf8Bytes);
+        Assert.Equal(50L, counts.EncodedBytes);
+        Assert.Equal(counts.EncodedBytes, counts.Utf16Bytes);
+
+        var empty = TextStatistics.Count("");
+        Assert.Equal(1L, empty.Lines);
+        Assert.Equal(0L, empty.NonBlankLines);
+    }
+
+    private static System.Text.Encoding CodePagesEncoding(int codePage)
+    {
+        System.Text.Encoding.RegisterProvider(CodePagesEncodingProvider.Instance);
+        return System.Text.Encoding.GetEncoding(codePage);
+    }
+}
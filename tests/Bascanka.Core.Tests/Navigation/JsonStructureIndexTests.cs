@@ -0,0 +1,124 @@
+using System.Text;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Navigation;
+
+namespace Bascanka.Core.Tests.Navigation;
+
+/// <summary>
+/// The index built from parallel chunks must match a sequential scan, also
+/// when strings and escapes straddle the 1M-character chunk boundaries.
+/// </summary>
+public sealed class JsonStructureIndexTests
+{
+    private const int ChunkSize = 1024 * 1024;
+
+    [Test]
+    public void ParallelChunksMatchASequentialScan()
+    {
+        var sb = new StringBuilder("[\n");
+        for (int i = 0; sb.Length < 3 * ChunkSize + 100_000; i++)
+        {
+            // Put a backslash last in chunk 1 and a quote first in chunk 2,
+            // so that the escape decides whether chunk 2 starts in a string.
+            if (sb.Length > ChunkSize && sb.Length < 2 * ChunkSize - 100)
+            {
+                sb.Append("  \"");
+                sb.Append('x', 2 * ChunkSize - 1 - sb.Length);
+                sb.Append("\\\"{[still in the string\",\n");
+            }
+            sb.Append($$"""  {"id": {{i}}, "s{": "a\\\\", "arr": [1, {"x": "]},\"["}, [], [[{}]]], "q": "\"" },""").Append('\n');
+        }
+        sb.Append("  {}\n]");
+        string json = sb.ToString();
+
+        var index = JsonStructureIndex.Build(new PieceTable(json));
+        var expected = Reference(json);
+
+        Assert.Equal(expected.Count, index.Count);
+        for (int i = 0; i < expected.Count; i++)
+            Assert.Equal(expected[i], index[i]);
+    }
+
+    [Test]
+    public void AnswersBracketAndPathQueries()
+    {
+        string json = """
+            {
+              "store": {
+                "book": [
+                  {"title": "A", "tags": ["x"]},
+                  {"title": "B", "tags": ["y", "z"]}
+                ],
+                "odd key\"": {"n": 1}
+              }
+            }
+            """;
+        var document = new PieceTable(json);
+        var index = JsonStructureIndex.Build(document);
+
+        long tags = json.IndexOf("[\"y\"", StringComparison.Ordinal);
+        Assert.Equal("$.store.book[1].tags", index.GetPath(tags + 2, document));
+        Assert.Equal("$.store['odd key\"']", index.GetPath(json.IndexOf("\"n\"", StringComparison.Ordinal), document));
+        Assert.Equal(string.Empty, index.GetPath(json.Length, document));
+
+        long close = json.IndexOf(']', (int)tags);
+        Assert.Equal((tags, close), index.FindMatchingBracket(close));
+        Assert.Equal((tags, close), index.FindMatchingBracket(tags));
+        Assert.True(index.FindMatchingBracket(tags + 1) is null);
+
+        Assert.Equal(tags, index.FindPath("$.store.book[1].tags", document));
+        Assert.Equal(json.IndexOf("\"z\"", StringComparison.Ordinal), index.FindPath("store.book[1]['tags'][1]", document));
+        Assert.Equal(json.IndexOf('1'), index.FindPath("$['store'][\"odd key\\\"\"].n", document));
+        Assert.Equal(-1L, index.FindPath("$.store.book[2]", document));
+        Assert.Equal(-1L, index.FindPath("$.store.book.title", document));
+
+        bool threw = false;
+        try { index.FindPath("$.store[", document); }
+        catch (FormatException) { threw = true; }
+        Assert.True(threw);
+
+        Assert.Equal(1, index.GetMaxDepthWithin(2));
+        Assert.Equal(4, index.EnumerateToDepth(2).Count());
+    }
+
+    /// <summary>A straightforward character-by-character scan.</summary>
+    private static List<JsonContainer> Reference(string json)
+    {
+        var result = new List<JsonContainer>();
+        var open = new Stack<(int Index, int Members)>();
+        int topLevel = 0;
+        bool inString = false;
+        for (int i = 0; i < json.Length; i++)
+        {
+            char c = json[i];
+            if (inString)
+            {
+                if (c == '\\') i++;
+                else if (c == '"') inString = false;
+                continue;
+            }
+
+            switch (c)
+            {
+                case '"':
+                    inString = true;
+                    break;
+                case '{' or '[':
+                    int parent = open.Count > 0 ? open.Peek().Index : -1;
+                    int ordinal = open.Count > 0 ? open.Peek().Members : topLevel++;
+                    result.Add(new JsonContainer(result.Count, i, -1, parent, ordinal, c == '{'));
+                    open.Push((result.Count - 1, 0));
+                    break;
+                case '}' or ']':
+                    var (index, _) = open.Pop();
+                    result[index] = result[index] with { End = i };
+                    break;
+                case ',':
+                    var (top, members) = open.Pop();
+                    open.Push((top, members + 1));
+                    break;
+            }
+        }
+        return result;
+    }
+}
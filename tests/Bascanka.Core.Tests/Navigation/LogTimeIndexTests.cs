@@ -0,0 +1,162 @@
+using System.Text;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Navigation;
+
+namespace Bascanka.Core.Tests.Navigation;
+
+/// <summary>
+/// Lookups through the sparse index must find the same line as a scan from
+/// the top, also across unstamped stack-trace lines, lines that are
+/// slightly out of order and time-only stamps that pass midnight.
+/// </summary>
+public sealed class LogTimeIndexTests
+{
+    [Test]
+    public void LookupsMatchALinearScan()
+    {
+        var random = new Random(97);
+        var stamps = new List<(long Line, long Ticks)>();
+        var sb = new StringBuilder();
+        long line = 0;
+        long time = new DateTime(2024, 3, 1, 23, 0, 0).Ticks;
+        for (int i = 0; i < 200_000; i++)
+        {
+            time += random.Next(0, 3) * TimeSpan.TicksPerSecond / 2;
+            // Every so often a line arrives a little late.
+            long ticks = i % 53 == 0 ? time - 3 * TimeSpan.TicksPerSecond : time;
+            stamps.Add((line++, ticks));
+            sb.Append(new DateTime(ticks).ToString("yyyy-MM-dd'T'HH:mm:ss.fff")).Append("Z INFO request ").Append(i).Append('\n');
+            if (i % 11 == 0)
+            {
+                sb.Append("System.Exception: boom\n   at Handler.Run()\n");
+                line += 2;
+            }
+        }
+        var document = new PieceTable(sb.ToString());
+
+        var index = LogTimeIndex.Build(document)!;
+        Assert.True(index.Format == LogTimestampFormat.IsoDate);
+
+        for (int q = 0; q < 500; q++)
+        {
+            long target = stamps[0].Ticks + (long)(random.NextDouble() * (time - stamps[0].Ticks + TimeSpan.TicksPerSecond));
+            Assert.Equal(Reference(stamps, document.LineCount, s => s >= target), index.FindFirstLineAtOrAfter(document, target));
+            Assert.Equal(Reference(stamps, document.LineCount, s => s > target), index.FindFirstLineAfter(document, target));
+        }
+        Assert.Equal(0L, index.FindFirstLineAtOrAfter(document, 0));
+        Assert.Equal(document.LineCount, index.FindFirstLineAfter(document, time));
+    }
+
+    [Test]
+    public void RangesKeepTheLinesThatContinueAnEntry()
+    {
+        string log = "Mar  3 14:32:04 host app: start\n" +
+                     "Mar  3 14:32:05 host app: failed\n" +
+                     "  at Main()\n" +
+                     "Mar  3 14:32:06 host app: retry\n" +
+                     "Mar  3 14:32:07 host app: done\n";
+        var document = new PieceTable(log);
+        var index = LogTimeIndex.Build(document)!;
+        Assert.True(index.Format == LogTimestampFormat.Syslog);
+
+        Assert.True(index.TryGetTimestamp(document, 2, out long reference));
+        Assert.True(index.Format.TryParseInput("14:32:05", reference, out long from));
+        Assert.True(index.Format.TryParseInput("Mar 3 14:32:06", reference, out long to));
+        var (start, length) = index.GetRange(document, from, to);
+        Assert.Equal("Mar  3 14:32:05 host app: failed\n  at Main()\nMar  3 14:32:06 host app: retry\n",
+            document.GetText(start, length));
+        Assert.Equal("Mar 3 14:32:05", index.Format.Format(from));
+    }
+
+    [Test]
+    public void TimesOfDayRollOverMidnight()
+    {
+        // Three days of time-only stamps, with late lines around midnight.
+        var random = new Random(970);
+        var stamps = new List<(long Line, long Ticks)>();
+        var sb = new StringBuilder();
+        long time = 22 * TimeSpan.TicksPerHour;
+        for (int i = 0; time < 3 * TimeSpan.TicksPerDay; i++)
+        {
+            time += random.Next(0, 6) * TimeSpan.TicksPerSecond;
+            long ticks = i % 7 == 0 ? time - 3 * TimeSpan.TicksPerSecond : time;
+            stamps.Add((i, ticks));
+            sb.Append(new TimeSpan(ticks % TimeSpan.TicksPerDay).ToString(@"hh\:mm\:ss")).Append(" tick ").Append(i).Append('\n');
+        }
+        var document = new PieceTable(sb.ToString());
+
+        var index = LogTimeIndex.Build(document)!;
+        Assert.True(index.Format == LogTimestampFormat.TimeOfDay);
+        for (int q = 0; q < 500; q++)
+        {
+            long target = stamps[0].Ticks + (long)(random.NextDouble() * (time - stamps[0].Ticks));
+            if (q % 5 == 0)
+                target = (random.Next(1, 3) * TimeSpan.TicksPerDay) + random.Next(-5, 5) * TimeSpan.TicksPerSecond;
+            Assert.Equal(Reference(stamps, document.LineCount, s => s >= target), index.FindFirstLineAtOrAfter(document, target));
+            Assert.Equal(Reference(stamps, document.LineCount, s => s > target), index.FindFirstLineAfter(document, target));
+        }
+
+        // Typed times land on the day nearest the reference.
+        Assert.True(index.TryGetTimestamp(document, stamps.Count - 1, out long last));
+        Assert.Equal(stamps[^1].Ticks, last);
+        Assert.True(index.Format.TryParseInput("23:59:59", 2 * TimeSpan.TicksPerDay + 60 * TimeSpan.TicksPerSecond, out long typed));
+        Assert.Equal(2 * TimeSpan.TicksPerDay - TimeSpan.TicksPerSecond, typed);
+        Assert.True(index.Format.TryParseInput("00:00:01", TimeSpan.TicksPerDay - 60 * TimeSpan.TicksPerSecond, out typed));
+        Assert.Equal(TimeSpan.TicksPerDay + TimeSpan.TicksPerSecond, typed);
+    }
+
+    [Test]
+    public void SyslogDatesRollOverNewYearAndEndsCoverTheTypedPrecision()
+    {
+        string log = "Dec 31 23:59:58 host app: a\n" +
+                     "Dec 31 23:59:59 host app: b\n" +
+                     "Jan  1 00:00:00 host app: c\n" +
+                     "Jan  1 00:00:01 host app: d\n" +
+                     "Jan  1 00:01:30 host app: e\n";
+        var document = new PieceTable(log);
+        var index = LogTimeIndex.Build(document)!;
+
+        Assert.True(index.TryGetTimestamp(document, 0, out long reference));
+        Assert.True(index.Format.TryParseInput("Dec 31 23:59:59", reference, out long from));
+        Assert.True(index.Format.TryParseInputEnd("Jan 1 00:00:00", reference, out long to));
+        Assert.True(to > from);
+        var (start, length) = index.GetRange(document, from, to);
+        Assert.Equal("Dec 31 23:59:59 host app: b\nJan  1 00:00:00 host app: c\n", document.GetText(start, length));
+
+        // An end without seconds covers the whole minute.
+        Assert.True(index.Format.TryParseInputEnd("00:01", to, out to));
+        (start, length) = index.GetRange(document, from, to);
+        Assert.Equal((long)log.Length, start + length);
+
+        var time = LogTimestampFormat.TimeOfDay;
+        Assert.True(time.TryParseInputEnd("14:32:05", 0, out long end));
+        Assert.Equal(new TimeSpan(0, 14, 32, 6).Ticks - 1, end);
+        Assert.True(time.TryParseInputEnd("14:32:05.25", 0, out end));
+        Assert.Equal(new TimeSpan(0, 14, 32, 5, 260).Ticks - 1, end);
+        Assert.True(time.TryParseInputEnd("14:32", 0, out end));
+        Assert.Equal(new TimeSpan(0, 14, 33, 0).Ticks - 1, end);
+    }
+
+    [Test]
+    public void DetectsTheFormatAtLineStart()
+    {
+        Assert.True(LogTimestampFormat.SlashDate ==
+            LogTimestampFormat.Detect(["[2024/03/01 14:32:05,250] a", "  b", "[2024/03/01 14:32:06,001] c"]));
+        Assert.True(LogTimestampFormat.TimeOfDay ==
+            LogTimestampFormat.Detect(["14:32:05.123 a", "14:32:06 b"]));
+        Assert.True(LogTimestampFormat.Detect(["Hello 2024-03-01 14:32:05", "world", "14:32:05 once"]) is null);
+        Assert.True(!LogTimestampFormat.IsoDate.TryParse("2024-02-30 10:00:00", out _));
+        Assert.True(LogTimestampFormat.IsoDate.TryParse("2024-02-29T10:00:00.5+02:00", out long ticks));
+        Assert.Equal(new DateTime(2024, 2, 29, 10, 0, 0, 500).Ticks, ticks);
+        Assert.True(LogTimeIndex.Build(new PieceTable("plain\ntext\n")) is null);
+    }
+
+    private static long Reference(List<(long Line, long Ticks)> stamps, long lineCount, Func<long, bool> reaches)
+    {
+        foreach (var (line, ticks) in stamps)
+        {
+            if (reaches(ticks)) return line;
+        }
+        return lineCount;
+    }
+}
@@ -0,0 +1,52 @@
+using System.Diagnostics;
+using System.Reflection;
+
+namespace Bascanka.Core.Tests;
+
+/// <summary>
+/// Minimal test runner.  Runs every public parameterless method marked with
+/// <see cref="TestAttribute"/> on a fresh instance of its class and exits
+/// with a non-zero code if any of them throws.  An optional argument
+/// filters tests by a substring of "Class.Method".
+/// </summary>
+internal static class Program
+{
+    private static int Main(string[] args)
+    {
+        string? filter = args.Length > 0 ? args[0] : null;
+        int passed = 0;
+        var failures = new List<string>();
+
+        var tests = typeof(Program).Assembly.GetTypes()
+            .Where(t => t.IsClass && !t.IsAbstract)
+            .SelectMany(t => t.GetMethods(BindingFlags.Public | BindingFlags.Instance)
+                .Where(m => m.GetCustomAttribute<TestAttribute>() is not null)
+                .Select(m => (Type: t, Method: m)))
+            .OrderBy(x => x.Type.FullName, StringComparer.Ordinal)
+            .ThenBy(x => x.Method.Name, StringComparer.Ordinal);
+
+        foreach (var (type, method) in tests)
+        {
+            string name = $"{type.Name}.{method.Name}";
+            if (filter is not null && !name.Contains(filter, StringComparison.OrdinalIgnoreCase))
+                continue;
+
+            var sw = Stopwatch.StartNew();
+            try
+            {
+                method.Invoke(Activator.CreateInstance(type), null);
+                passed++;
+                Console.WriteLine($"  PASS  {name} ({sw.ElapsedMilliseconds} ms)");
+            }
+            catch (TargetInvocationException ex) when (ex.InnerException is not null)
+            {
+                failures.Add(name);
+                Console.WriteLine($"  FAIL  {name}: {ex.InnerException.GetType().Name}: {ex.InnerException.Message}");
+            }
+        }
+
+        Console.WriteLine();
+        Console.WriteLine($"{passed} passed, {failures.Count} failed.");
+        return failures.Count == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,137 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Search;
+
+namespace Bascanka.Core.Tests.Search;
+
+/// <summary>
+/// Parallel byte search must return the same matches, in the same order,
+/// as a sequential scan, and next/previous search must step through them
+/// one at a time, wrapping around the ends of the document on request.
+/// </summary>
+public sealed class BytePatternSearcherTests
+{
+    private static readonly BytePattern Pattern = BytePattern.Parse("CA FE");
+
+    [Test]
+    public void FindAllReturnsTheFirstMatchesWhenLaterChunksAreDense()
+    {
+        // One match in each of the first four chunks, then chunks full of
+        // matches: later chunks reach the limit long before the early ones
+        // have enough, which must not cut the result short.
+        const int chunks = 10;
+        var data = new byte[chunks * BytePatternSearcher.ChunkSize];
+        for (int c = 0; c < 4; c++)
+            Place(data, c * (long)BytePatternSearcher.ChunkSize + 1000);
+        for (long at = 4L * BytePatternSearcher.ChunkSize; at + 1 < data.Length; at += 64)
+            Place(data, at);
+
+        const int limit = 50;
+        ByteMatchList matches = BytePatternSearcher.FindAll(new BytePieceTable(data), Pattern, limit);
+
+        Assert.SequenceEqual(SequentialMatches(data).Take(limit), matches);
+        Assert.True(matches.IsTruncated);
+    }
+
+    [Test]
+    public void FindAllMatchesSequentialScanAcrossChunkBoundaries()
+    {
+        var data = new byte[3 * BytePatternSearcher.ChunkSize + 17];
+        var random = new Random(84);
+        for (int i = 0; i < 500; i++)
+            Place(data, random.NextInt64(data.Length - 1));
+        Place(data, BytePatternSearcher.ChunkSize - 1);       // straddles a boundary
+        Place(data, data.Length - 2);
+
+        ByteMatchList matches = BytePatternSearcher.FindAll(new BytePieceTable(data), Pattern);
+
+        Assert.SequenceEqual(SequentialMatches(data), matches);
+        Assert.True(!matches.IsTruncated);
+    }
+
+    [Test]
+    public void NextAndPreviousStepThroughEveryMatch()
+    {
+        // More than one batch of chunks on most machines, with matches on
+        // both sides of each boundary and at the very ends.
+        var data = new byte[5 * BytePatternSearcher.ChunkSize + 9];
+        var random = new Random(840);
+        for (int i = 0; i < 40; i++)
+            Place(data, random.NextInt64(data.Length - 1));
+        for (int c = 1; c < 5; c++)
+        {
+            Place(data, c * (long)BytePatternSearcher.ChunkSize - 1);
+            Place(data, c * (long)BytePatternSearcher.ChunkSize + 3);
+        }
+        Place(data, 0);
+        Place(data, data.Length - 2);
+        var buffer = new BytePieceTable(data);
+        long[] expected = [.. SequentialMatches(data)];
+
+        var forward = new List<long>();
+        for (long at = BytePatternSearcher.FindNext(buffer, Pattern, 0); at >= 0;
+             at = BytePatternSearcher.FindNext(buffer, Pattern, at + 1))
+            forward.Add(at);
+        Assert.SequenceEqual(expected, forward);
+
+        var backward = new List<long>();
+        for (long at = BytePatternSearcher.FindPrevious(buffer, Pattern, data.Length); at >= 0;
+             at = BytePatternSearcher.FindPrevious(buffer, Pattern, at))
+            backward.Add(at);
+        Assert.SequenceEqual(expected.Reverse(), backward);
+
+        // Arbitrary starting points agree with the sequential scan.
+        for (int i = 0; i < 50; i++)
+        {
+            long from = random.NextInt64(data.Length + 1);
+            long next = expected.Where(m => m >= from).DefaultIfEmpty(-1).First();
+            long previous = expected.Where(m => m < from).DefaultIfEmpty(-1).Last();
+            Assert.Equal(next, BytePatternSearcher.FindNext(buffer, Pattern, from));
+            Assert.Equal(previous, BytePatternSearcher.FindPrevious(buffer, Pattern, from));
+        }
+    }
+
+    [Test]
+    public void WrapAroundContinuesFromTheOtherEnd()
+    {
+        var data = new byte[2 * BytePatternSearcher.ChunkSize + 100];
+        Place(data, 1000);
+        Place(data, BytePatternSearcher.ChunkSize + 5);
+        var buffer = new BytePieceTable(data);
+        long first = 1000, last = BytePatternSearcher.ChunkSize + 5;
+
+        // Past the last match: nothing, unless the search wraps to the start.
+        Assert.Equal(-1L, BytePatternSearcher.FindNext(buffer, Pattern, last + 1));
+        Assert.Equal(first, BytePatternSearcher.FindNext(buffer, Pattern, last + 1, wrapAround: true));
+        Assert.Equal(last, BytePatternSearcher.FindNext(buffer, Pattern, first + 1, wrapAround: true));
+
+        // Before the first match: nothing, unless the search wraps to the end.
+        Assert.Equal(-1L, BytePatternSearcher.FindPrevious(buffer, Pattern, first));
+        Assert.Equal(last, BytePatternSearcher.FindPrevious(buffer, Pattern, first, wrapAround: true));
+        Assert.Equal(first, BytePatternSearcher.FindPrevious(buffer, Pattern, last, wrapAround: true));
+
+        // A single match is found again from itself; no match stays -1.
+        var single = new byte[500];
+        Place(single, 200);
+        var singleBuffer = new BytePieceTable(single);
+        Assert.Equal(200L, BytePatternSearcher.FindNext(singleBuffer, Pattern, 201, wrapAround: true));
+        Assert.Equal(200L, BytePatternSearcher.FindPrevious(singleBuffer, Pattern, 200, wrapAround: true));
+        var none = new BytePieceTable(new byte[500]);
+        Assert.Equal(-1L, BytePatternSearcher.FindNext(none, Pattern, 10, wrapAround: true));
+        Assert.Equal(-1L, BytePatternSearcher.FindPrevious(none, Pattern, 10, wrapAround: true));
+    }
+
+    private static void Place(byte[] data, long offset)
+    {
+        data[offset] = 0xCA;
+        data[offset + 1] = 0xFE;
+    }
+
+    private static IEnumerable<long> SequentialMatches(byte[] data)
+    {
+        for (long i = 0; i + 1 < data.Length; i++)
+        {
+            if (data[i] == 0xCA && data[i + 1] == 0xFE)
+                yield return i;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+using Bascanka.Core.Search;
+
+namespace Bascanka.Core.Tests.Search;
+
+/// <summary>
+/// Hex patterns parse into the values and masks they spell out, with
+/// <c>?</c> nibbles and an explicit mask clearing bits, and malformed
+/// patterns are rejected.
+/// </summary>
+public sealed class BytePatternTests
+{
+    [Test]
+    public void WildcardsBecomeMasks()
+    {
+        BytePattern pattern = BytePattern.Parse("4D 5A ?? 00 4? ?f");
+        Assert.SequenceEqual(new byte[] { 0x4D, 0x5A, 0x00, 0x00, 0x40, 0x0F }, pattern.Values.ToArray());
+        Assert.SequenceEqual(new byte[] { 0xFF, 0xFF, 0x00, 0xFF, 0xF0, 0x0F }, pattern.Masks.ToArray());
+        Assert.True(!pattern.IsExact);
+        Assert.Equal("4D 5A ?? 00 4? ?F", pattern.ToString());
+
+        // Spaces are optional, and the formatted text parses back the same.
+        BytePattern compact = BytePattern.Parse("CAFE\tba be");
+        Assert.True(compact.IsExact);
+        Assert.Equal("CA FE BA BE", compact.ToString());
+        Assert.Equal(pattern.ToString(), BytePattern.Parse(pattern.ToString()).ToString());
+
+        Assert.True(pattern.MatchesAt([0x4D, 0x5A, 0x99, 0x00, 0x4E, 0xAF]));
+        Assert.True(!pattern.MatchesAt([0x4D, 0x5A, 0x99, 0x00, 0x5E, 0xAF]));
+        Assert.True(!pattern.MatchesAt([0x4D, 0x5A, 0x99, 0x00, 0x4E, 0xAE]));
+
+        // All wildcards: no anchor, matches anywhere.
+        BytePattern any = BytePattern.Parse("?? ??");
+        Assert.Equal(-1, any.AnchorIndex);
+        Assert.Equal(3, BytePatternSearcher.IndexOf([1, 2, 3, 4, 5], any, 3));
+    }
+
+    [Test]
+    public void ExplicitMaskIsCombinedWithWildcards()
+    {
+        BytePattern pattern = BytePattern.Parse("41 4? FF", "DF FF 7F");
+        Assert.SequenceEqual(new byte[] { 0xDF, 0xF0, 0x7F }, pattern.Masks.ToArray());
+        Assert.SequenceEqual(new byte[] { 0x41, 0x40, 0x7F }, pattern.Values.ToArray());
+
+        // 'a' matches 'A' with bit 5 masked out; the top bit of the last
+        // byte is ignored.
+        Assert.True(pattern.MatchesAt([0x61, 0x4C, 0x7F]));
+        Assert.True(pattern.MatchesAt([0x41, 0x40, 0xFF]));
+        Assert.True(!pattern.MatchesAt([0x42, 0x40, 0xFF]));
+        Assert.True(!pattern.MatchesAt([0x41, 0x40, 0x7E]));
+    }
+
+    [Test]
+    public void MalformedPatternsAreRejected()
+    {
+        foreach (var (hex, mask) in new (string, string?)[]
+        {
+            ("", null), ("   ", null), ("4", null), ("4 D", null), ("4G", null), ("CA FE 0", null),
+            ("CA FE", "FF"), ("CA FE", "FF FF FF"), ("CA FE", "F? FF"), ("CA", "X0"),
+        })
+        {
+            bool threw = false;
+            try { BytePattern.Parse(hex, mask); }
+            catch (FormatException) { threw = true; }
+            Assert.True(threw);
+        }
+
+        Assert.True(!BytePattern.TryParse("ZZ", out BytePattern? bad));
+        Assert.True(bad is null);
+        Assert.True(BytePattern.TryParse("e8 ?? ?? ?? ?f", out BytePattern? good));
+        Assert.Equal(5, good!.Length);
+    }
+}
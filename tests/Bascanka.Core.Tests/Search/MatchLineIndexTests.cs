@@ -0,0 +1,145 @@
+using System.Text;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Search;
+
+namespace Bascanka.Core.Tests.Search;
+
+/// <summary>
+/// The filtered view must hold exactly the matching lines of the document,
+/// mapped to their real line numbers, after a parallel build, after edits
+/// applied block by block, and after the document grows, and a view that
+/// grows in place must read and find its lines as a plain copy does.
+/// </summary>
+public sealed class MatchLineIndexTests
+{
+    private static readonly LinePredicate ContainsError = line => line.Contains("ERROR", StringComparison.Ordinal);
+
+    [Test]
+    public void ViewHoldsTheMatchingLinesAcrossBlocks()
+    {
+        var sb = new StringBuilder();
+        for (int i = 0; sb.Length < 3_500_000; i++)
+            sb.Append(i % 7 == 0 ? "ERROR " : "info ").Append(i).Append(i % 2 == 0 ? "\r\n" : "\n");
+        var document = new PieceTable(sb.ToString());
+
+        var index = new MatchLineIndex(ContainsError);
+        index.IndexRemaining(document);
+        var source = index.CreateSource(document);
+        var view = new PieceTable(source);
+
+        List<long> expected = Reference(document);
+        Assert.Equal((long)expected.Count, index.MatchCount);
+        Assert.Equal((long)expected.Count, view.LineCount);
+        Assert.Equal(view.Length, source.Length);
+        Assert.Equal(expected.Count - 1, source.CountLineFeeds(0, source.Length));
+        foreach (long line in new long[] { 0, 1, expected.Count / 3, expected.Count - 1 })
+        {
+            Assert.Equal(expected[(int)line], source.GetDocumentLine(line));
+            Assert.Equal(document.GetLine(expected[(int)line]).TrimEnd('\r'), view.GetLine(line));
+        }
+    }
+
+    [Test]
+    public void EditsAndGrowthUpdateOnlyWhatTheyTouch()
+    {
+        var random = new Random(98);
+        var sb = new StringBuilder();
+        for (int i = 0; sb.Length < 2_300_000; i++)
+            sb.Append(random.Next(5) == 0 ? "x ERROR " : "x ok ").Append(i).Append('\n');
+        var document = new PieceTable(sb.ToString());
+        var index = new MatchLineIndex(ContainsError);
+        index.IndexRemaining(document);
+
+        string[] inserts = ["", "ERROR", "\n", "a\nERROR b\n", "\nERR", "OR\n"];
+        for (int round = 0; round < 60; round++)
+        {
+            long offset = round % 10 == 0 ? document.Length : random.NextInt64(document.Length);
+            long removed = round % 3 == 0 ? 0 : Math.Min(random.Next(0, 2_000_000 / (round + 1)), document.Length - offset);
+            string inserted = inserts[round % inserts.Length];
+            if (removed > 0) document.Delete(offset, removed);
+            if (inserted.Length > 0) document.Insert(offset, inserted);
+            index.Update(document, offset, removed, inserted.Length);
+
+            AssertMatches(index, document);
+        }
+
+        // A reloaded document that grew at the end keeps the index.
+        var grown = new PieceTable(document.ToString() + "tail ERROR\nmore\nERROR last");
+        Assert.True(index.IsPrefixOf(grown));
+        index.IndexRemaining(grown);
+        AssertMatches(index, grown);
+        Assert.True(!index.IsPrefixOf(new PieceTable("other text\n")));
+    }
+
+    [Test]
+    public void ViewGrowsInPlaceAndFindsLinesThroughTheIndex()
+    {
+        var random = new Random(980);
+        string Lines(int count) => string.Concat(Enumerable.Range(0, count)
+            .Select(i => (random.Next(3) == 0 ? "ERROR " : "ok ") + new string('x', random.Next(0, 40)) + "\n"));
+
+        var document = new PieceTable(Lines(40_000));
+        var index = new MatchLineIndex(ContainsError);
+        index.IndexRemaining(document);
+        var source = index.CreateSource();
+        var view = new PieceTable(source);
+
+        // More lines arrive at the end of the same document.
+        for (int round = 0; round < 3; round++)
+        {
+            document.Insert(document.Length, Lines(30_000));
+            index.IndexRemaining(document);
+            Assert.True(index.TryExtend(source));
+            view.AppendFromOriginal();
+
+            var copy = new PieceTable(view.ToString());
+            Assert.Equal((long)Reference(document).Count, view.LineCount);
+            Assert.Equal(copy.LineCount, view.LineCount);
+            for (int q = 0; q < 300; q++)
+            {
+                long line = random.NextInt64(view.LineCount);
+                Assert.Equal(copy.GetLineStartOffset(line), view.GetLineStartOffset(line));
+                long offset = random.NextInt64(view.Length + 1);
+                Assert.Equal(copy.OffsetToLineColumn(offset), view.OffsetToLineColumn(offset));
+            }
+        }
+
+        // An edit before the end needs a new source.
+        document.Insert(0, "ERROR first\n");
+        index.Update(document, 0, 0, 12);
+        Assert.True(!index.TryExtend(source));
+        AssertMatches(index, document);
+
+        // An edited view no longer reads as its source and cannot grow.
+        view.Insert(0, "x");
+        bool threw = false;
+        try { view.AppendFromOriginal(); }
+        catch (InvalidOperationException) { threw = true; }
+        Assert.True(threw);
+        Assert.Equal("x", view.GetText(0, 1));
+        Assert.Equal(source.GetText(0, 10), view.GetText(1, 10));
+    }
+
+    private static void AssertMatches(MatchLineIndex index, PieceTable document)
+    {
+        List<long> expected = Reference(document);
+        var source = index.CreateSource(document);
+        Assert.Equal((long)expected.Count, source.MatchCount);
+        for (int i = 0; i < expected.Count; i += Math.Max(1, expected.Count / 50))
+            Assert.Equal(expected[i], source.GetDocumentLine(i));
+        if (expected.Count > 0)
+            Assert.Equal(expected[^1], source.GetDocumentLine(expected.Count - 1));
+    }
+
+    private static List<long> Reference(PieceTable document)
+    {
+        var lines = new List<long>();
+        string[] all = document.ToString().Split('\n');
+        for (int i = 0; i < all.Length; i++)
+        {
+            if (all[i].Contains("ERROR", StringComparison.Ordinal))
+                lines.Add(i);
+        }
+        return lines;
+    }
+}
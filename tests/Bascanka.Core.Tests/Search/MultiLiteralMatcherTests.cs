@@ -0,0 +1,63 @@
+using System.Text;
+using Bascanka.Core.Search;
+
+namespace Bascanka.Core.Tests.Search;
+
+/// <summary>
+/// A single pass of the automaton must report exactly the literals an
+/// ordinal <see cref="string.Contains(string)"/> finds, including literals
+/// that overlap, nest or share prefixes and suffixes.
+/// </summary>
+public sealed class MultiLiteralMatcherTests
+{
+    [Test]
+    public void ReportsTheLiteralsContainedInTheText()
+    {
+        string[] literals = ["he", "she", "his", "hers", "", "e", "she", "ushers!"];
+        var matcher = new MultiLiteralMatcher(literals);
+        Assert.Equal(literals.Length, matcher.Count);
+
+        var present = new bool[literals.Length];
+        Assert.Equal(5, matcher.FindPresent("ushers", present));
+        Assert.SequenceEqual([true, true, false, true, false, true, true, false], present);
+
+        // Entries already set are left alone and not counted again.
+        Assert.Equal(1, matcher.FindPresent("this", present));
+        Assert.True(present[2]);
+        Assert.Equal(0, matcher.FindPresent("no match at all", new bool[literals.Length]));
+
+        bool threw = false;
+        try { matcher.FindPresent("he", new bool[2]); }
+        catch (ArgumentException) { threw = true; }
+        Assert.True(threw);
+    }
+
+    [Test]
+    public void MatchesContainOnRandomText()
+    {
+        // A small alphabet makes overlaps and failure-link chains common.
+        var random = new Random(81);
+        const string Alphabet = "abcab.";
+        string RandomText(int length)
+        {
+            var sb = new StringBuilder(length);
+            for (int i = 0; i < length; i++)
+                sb.Append(Alphabet[random.Next(Alphabet.Length)]);
+            return sb.ToString();
+        }
+
+        for (int round = 0; round < 300; round++)
+        {
+            string[] literals = [.. Enumerable.Range(0, random.Next(1, 12)).Select(_ => RandomText(random.Next(1, 6)))];
+            var matcher = new MultiLiteralMatcher(literals);
+            // Long runs without a first character exercise the vectorised skip.
+            string text = RandomText(random.Next(0, 80)) + new string('z', random.Next(0, 100)) + RandomText(random.Next(0, 20));
+
+            var present = new bool[literals.Length];
+            int found = matcher.FindPresent(text, present);
+            bool[] expected = [.. literals.Select(l => text.Contains(l, StringComparison.Ordinal))];
+            Assert.SequenceEqual(expected, present);
+            Assert.Equal(expected.Count(p => p), found);
+        }
+    }
+}
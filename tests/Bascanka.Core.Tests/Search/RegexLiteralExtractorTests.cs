@@ -0,0 +1,66 @@
+using System.Text.RegularExpressions;
+using Bascanka.Core.Search;
+
+namespace Bascanka.Core.Tests.Search;
+
+/// <summary>
+/// The extracted literals are only sound if prefiltering never hides a
+/// match: every line the regex matches must contain one of them.
+/// </summary>
+public sealed class RegexLiteralExtractorTests
+{
+    private static readonly string[] Patterns =
+    [
+        @"\b(ERROR|FATAL)\b",
+        @"WARN(ING)?:",
+        @"[a-z-[aeiou]]x",
+        @"[a-z-[aeiou]]+end",
+        @"[0-9-[5]]{2}-id",
+        @"[-[]x",
+        @"[\]]close",
+        @"(?:foo|bar)+baz",
+        @"a{2,}b",
+        @"\x41BC",
+        @"(?<name>key)=\k<name>",
+        @"(?i)case",
+        @"x(?=look)ahead",
+    ];
+
+    private static readonly string[] Lines =
+    [
+        "bx", "ax", "]x", "zzx", "BX", "rend", "aend", "]end", "12-id", "15-id", "1-[5]]-id",
+        "-x", "[x", "]close", "foobaz", "barbarbaz", "baz", "aab", "ab", "ABC", "key=key",
+        "CASE", "xlookahead", "xahead", "an ERROR here", "FATALITY", "WARN:", "WARNING:",
+    ];
+
+    [Test]
+    public void PrefilterNeverHidesAMatch()
+    {
+        foreach (string pattern in Patterns)
+        {
+            var regex = new Regex(pattern);
+            string[]? literals = RegexLiteralExtractor.GetRequiredLiterals(pattern);
+            foreach (string line in Lines)
+            {
+                bool unfiltered = regex.IsMatch(line);
+                bool prefiltered = (literals is null || literals.Any(l => line.Contains(l, StringComparison.Ordinal)))
+                    && regex.IsMatch(line);
+                Assert.True(unfiltered == prefiltered, $"{pattern} on \"{line}\"");
+            }
+        }
+    }
+
+    [Test]
+    public void ClassSubtractionIsSkippedAsOneAtom()
+    {
+        Assert.SequenceEqual(["x"], RegexLiteralExtractor.GetRequiredLiterals(@"[a-z-[aeiou]]x")!);
+        Assert.SequenceEqual(["end"], RegexLiteralExtractor.GetRequiredLiterals(@"[a-z-[aeiou]]+end")!);
+    }
+
+    [Test]
+    public void AlternationYieldsOneLiteralPerBranch()
+    {
+        Assert.SequenceEqual(["ERROR", "FATAL"], RegexLiteralExtractor.GetRequiredLiterals(@"\b(ERROR|FATAL)\b")!);
+        Assert.True(RegexLiteralExtractor.GetRequiredLiterals(@"(?i)case") is null);
+    }
+}
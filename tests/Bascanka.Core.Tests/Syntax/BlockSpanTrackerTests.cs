@@ -0,0 +1,131 @@
+using System.Text;
+using System.Text.RegularExpressions;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Syntax;
+
+namespace Bascanka.Core.Tests.Syntax;
+
+/// <summary>
+/// Spans kept up to date edit by edit, and spans from a parallel first scan,
+/// must equal a plain line-by-line scan of the whole document.
+/// </summary>
+public sealed class BlockSpanTrackerTests
+{
+    private static readonly (Regex Begin, Regex End)[] Rules =
+    [
+        (new Regex("BEGIN"), new Regex("END")),
+        (new Regex("<<"), new Regex(">>")),
+    ];
+
+    private static readonly string[] LinePool =
+        ["BEGIN", "END", "<<", ">>", "text", "BEGIN >>", "", "x END <<", "plain line", "more"];
+
+    [Test]
+    public void ParallelScanMatchesASequentialScan()
+    {
+        // Blocks that stay open across the boundaries of the parallel chunks.
+        var random = new Random(82);
+        var sb = new StringBuilder();
+        for (int i = 0; i < BlockSpanTracker.ChunkLines * 3 + 500; i++)
+        {
+            string line = i % BlockSpanTracker.ChunkLines == BlockSpanTracker.ChunkLines - 10 ? "BEGIN"
+                : random.Next(400) == 0 ? LinePool[random.Next(4)] : "text";
+            sb.Append(line).Append('\n');
+        }
+        var document = new PieceTable(sb.ToString());
+
+        var tracker = new BlockSpanTracker(Rules);
+        tracker.Rebuild(LineFetcher(document), document.LineCount);
+        Assert.Equal(document.LineCount, tracker.LineCount);
+        Assert.SequenceEqual(Reference(document), tracker.Spans);
+    }
+
+    [Test]
+    public void UpdatesMatchAFullScanAfterEveryEdit()
+    {
+        var random = new Random(2400);
+        for (int round = 0; round < 8; round++)
+        {
+            var sb = new StringBuilder();
+            int lines = random.Next(1, 2000);
+            for (int i = 0; i < lines; i++)
+                sb.Append(RandomLine(random)).Append('\n');
+            var document = new PieceTable(sb.ToString());
+            var tracker = new BlockSpanTracker(Rules);
+            tracker.Rebuild(LineFetcher(document), document.LineCount);
+
+            // The edited lines are worked out from the change as the editor does.
+            document.TextChanged += (_, e) =>
+            {
+                long first = 0;
+                if (e.Offset > 0 && e.Offset <= document.Length)
+                    (first, _) = document.OffsetToLineColumn(e.Offset);
+                long last = first;
+                long end = e.Offset + e.NewLength;
+                if (end > 0 && end <= document.Length)
+                    (last, _) = document.OffsetToLineColumn(end);
+                tracker.Update(LineFetcher(document), document.LineCount, first, last);
+            };
+
+            for (int edit = 0; edit < 300; edit++)
+            {
+                long offset = random.NextInt64(document.Length + 1);
+                if (random.Next(3) == 0 && document.Length > 0)
+                {
+                    long length = Math.Min(document.Length - offset, random.Next(1, random.Next(2) == 0 ? 20 : 2000));
+                    if (length > 0)
+                        document.Delete(offset, length);
+                }
+                else
+                {
+                    var insert = new StringBuilder();
+                    int count = random.Next(0, 4);
+                    for (int i = 0; i < count; i++)
+                        insert.Append(RandomLine(random)).Append('\n');
+                    insert.Append(random.Next(2) == 0 ? RandomLine(random) : "");
+                    if (insert.Length > 0)
+                        document.Insert(offset, insert.ToString());
+                }
+
+                Assert.Equal(document.LineCount, tracker.LineCount);
+                Assert.SequenceEqual(Reference(document), tracker.Spans);
+            }
+        }
+    }
+
+    private static string RandomLine(Random random) => LinePool[random.Next(LinePool.Length)];
+
+    private static Func<long, int, string[]> LineFetcher(PieceTable document) =>
+        (start, count) => [.. document.GetLineRange(start, count).Select(l => l.Text)];
+
+    /// <summary>Spans from one pass over every line, ordered by start line, then rule.</summary>
+    private static List<BlockSpan> Reference(PieceTable document)
+    {
+        var spans = new List<BlockSpan>();
+        var open = new long[Rules.Length];
+        Array.Fill(open, -1L);
+        for (long line = 0; line < document.LineCount; line++)
+        {
+            string text = document.GetLine(line);
+            for (int r = 0; r < Rules.Length; r++)
+            {
+                if (open[r] < 0)
+                {
+                    if (Rules[r].Begin.IsMatch(text))
+                        open[r] = line;
+                }
+                else if (Rules[r].End.IsMatch(text))
+                {
+                    spans.Add(new BlockSpan(r, open[r], line));
+                    open[r] = -1;
+                }
+            }
+        }
+        for (int r = 0; r < Rules.Length; r++)
+        {
+            if (open[r] >= 0)
+                spans.Add(new BlockSpan(r, open[r], document.LineCount - 1));
+        }
+        return [.. spans.OrderBy(s => s.StartLine).ThenBy(s => s.Rule)];
+    }
+}
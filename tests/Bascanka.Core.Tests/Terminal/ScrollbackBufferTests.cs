@@ -0,0 +1,61 @@
+using Bascanka.Core.Terminal;
+
+namespace Bascanka.Core.Tests.Terminal;
+
+/// <summary>
+/// The scrollback must stay within its cell budget and return the newest
+/// lines intact, including lines that wrap around the end of the ring.
+/// </summary>
+public sealed class ScrollbackBufferTests
+{
+    [Test]
+    public void OldestLinesAreEvictedToStayWithinTheBudget()
+    {
+        var buffer = new ScrollbackBuffer(cellBudget: 50, maxLines: 100);
+        for (int i = 0; i < 40; i++)
+            buffer.Append(Line($"row{i:D2}", width: 12));
+
+        // Each line stores 5 cells without its trailing blanks.
+        Assert.Equal(10, buffer.Count);
+        var row = new TerminalCell[12];
+        for (int i = 0; i < buffer.Count; i++)
+        {
+            buffer.CopyLine(i, row);
+            Assert.Equal($"row{30 + i:D2}".PadRight(12), Text(row));
+        }
+    }
+
+    [Test]
+    public void LinesWrappingAroundTheRingAreReadBack()
+    {
+        var buffer = new ScrollbackBuffer(cellBudget: 16, maxLines: 8);
+        buffer.Append(Line("abcdefghij", width: 10));
+        buffer.Append(Line("0123456789", width: 10));
+
+        Assert.Equal(1, buffer.Count);
+        var row = new TerminalCell[10];
+        buffer.CopyLine(0, row);
+        Assert.Equal("0123456789", Text(row));
+    }
+
+    [Test]
+    public void LineLimitAppliesToBlankLines()
+    {
+        var buffer = new ScrollbackBuffer(cellBudget: 100, maxLines: 4);
+        for (int i = 0; i < 10; i++)
+            buffer.Append(Line("", width: 8));
+
+        Assert.Equal(4, buffer.Count);
+        Assert.Equal(0, buffer.GetLineLength(0));
+    }
+
+    private static TerminalCell[] Line(string text, int width)
+    {
+        var cells = new TerminalCell[width];
+        for (int i = 0; i < width; i++)
+            cells[i] = i < text.Length ? new TerminalCell(text[i], CellAttributes.Default) : TerminalCell.Blank;
+        return cells;
+    }
+
+    private static string Text(TerminalCell[] cells) => new(cells.Select(c => c.Char).ToArray());
+}
@@ -0,0 +1,138 @@
+using Bascanka.Core.Terminal;
+
+namespace Bascanka.Core.Tests.Terminal;
+
+/// <summary>
+/// The screen must not depend on how output is split into writes, and the
+/// ASCII fast path must leave the grid as per-character output would.
+/// </summary>
+public sealed class TerminalEmulatorTests
+{
+    [Test]
+    public void ScreenDoesNotDependOnHowOutputIsSplit()
+    {
+        string stream = BuildStream(seed: 7, lines: 400);
+
+        var whole = new TerminalEmulator(40, 10);
+        whole.Write(stream);
+
+        var split = new TerminalEmulator(40, 10);
+        var random = new Random(11);
+        for (int i = 0; i < stream.Length;)
+        {
+            int n = Math.Min(random.Next(1, 9), stream.Length - i);
+            split.Write(stream.AsSpan(i, n));
+            i += n;
+        }
+
+        AssertSameScreen(whole, split);
+    }
+
+    [Test]
+    public void AsciiRunsWrapAtTheLastColumn()
+    {
+        var term = new TerminalEmulator(5, 3);
+        term.Write("abcdefgh");
+
+        Assert.Equal("abcde", RowText(term, 0));
+        Assert.Equal("fgh  ", RowText(term, 1));
+        Assert.Equal(1, term.CursorRow);
+        Assert.Equal(3, term.CursorColumn);
+    }
+
+    [Test]
+    public void AsciiRunOverAWideCharacterBlanksItsOtherHalf()
+    {
+        var term = new TerminalEmulator(6, 2);
+        term.Write("中文\r");
+        term.Write("\x1B[2Gxy");
+
+        // "x" lands on the continuation of 中 and "y" on the lead of 文.
+        Assert.Equal(' ', term.GetRow(0)[0].Char);
+        Assert.Equal("xy", RowText(term, 0).Substring(1, 2));
+        Assert.Equal(' ', term.GetRow(0)[3].Char);
+    }
+
+    [Test]
+    public void CsiParametersAndSgrAreApplied()
+    {
+        var term = new TerminalEmulator(20, 5);
+        term.Write("\x1B[3;4H\x1B[1;38;5;9;44mX\x1B[0mY");
+
+        TerminalCell x = term.GetRow(2)[3];
+        Assert.Equal('X', x.Char);
+        Assert.Equal(new CellAttributes(9, 4, CellFlags.Bold), x.Attributes);
+        Assert.Equal(CellAttributes.Default, term.GetRow(2)[4].Attributes);
+    }
+
+    [Test]
+    public void ScrolledLinesReachTheScrollbackInOrder()
+    {
+        var term = new TerminalEmulator(10, 3);
+        for (int i = 0; i < 20; i++)
+            term.Write($"line {i}\r\n");
+
+        // 21 lines were shown (the last one empty); 3 remain on screen.
+        Assert.Equal(18, term.Scrollback.Count);
+        var row = new TerminalCell[10];
+        for (int i = 0; i < 18; i++)
+        {
+            term.Scrollback.CopyLine(i, row);
+            Assert.Equal($"line {i}".PadRight(10), new string(row.Select(c => c.Char).ToArray()));
+        }
+    }
+
+    // ────────────────────────────────────────────────────────────────────
+    //  Helpers
+    // ────────────────────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Output resembling a colourized build log with progress redraws,
+    /// cursor movement and some CJK text.
+    /// </summary>
+    internal static string BuildStream(int seed, int lines)
+    {
+        var random = new Random(seed);
+        var sb = new System.Text.StringBuilder();
+        for (int i = 0; i < lines; i++)
+        {
+            switch (random.Next(6))
+            {
+                case 0:
+                    sb.Append($"\x1B[33mwarning\x1B[0m CS{random.Next(9999):D4}: unused variable 'x{i}'\r\n");
+                    break;
+                case 1:
+                    sb.Append($"\r\x1B[K[{new string('#', random.Next(20))}] {random.Next(100)}%");
+                    break;
+                case 2:
+                    sb.Append($"\x1B[{random.Next(1, 8)};{random.Next(1, 30)}H\x1B[1;32m构建成功\x1B[22m ok");
+                    break;
+                case 3:
+                    sb.Append("\x1B]0;title\x07\x1B[?25l\t-> tab\x1B[?25h\r\n");
+                    break;
+                default:
+                    sb.Append($"  Compiling src/module_{i}/file_{random.Next(1000)}.cs\r\n");
+                    break;
+            }
+        }
+        return sb.ToString();
+    }
+
+    private static string RowText(TerminalEmulator term, int row)
+    {
+        ReadOnlySpan<TerminalCell> cells = term.GetRow(row);
+        var chars = new char[cells.Length];
+        for (int i = 0; i < cells.Length; i++)
+            chars[i] = cells[i].Char;
+        return new string(chars);
+    }
+
+    private static void AssertSameScreen(TerminalEmulator expected, TerminalEmulator actual)
+    {
+        for (int row = 0; row < expected.Rows; row++)
+            Assert.True(expected.GetRow(row).SequenceEqual(actual.GetRow(row)), $"row {row}");
+        Assert.Equal(expected.CursorRow, actual.CursorRow);
+        Assert.Equal(expected.CursorColumn, actual.CursorColumn);
+        Assert.Equal(expected.Scrollback.Count, actual.Scrollback.Count);
+    }
+}
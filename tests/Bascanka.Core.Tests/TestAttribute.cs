@@ -0,0 +1,5 @@
+namespace Bascanka.Core.Tests;
+
+/// <summary>Marks a public parameterless instance method as a test.</summary>
+[AttributeUsage(AttributeTargets.Method, AllowMultiple = false, Inherited = false)]
+internal sealed class TestAttribute : Attribute;
@@ -0,0 +1,78 @@
+using System.Text;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Commands;
+using Bascanka.Core.Transforms;
+using TextEncoding = System.Text.Encoding;
+
+namespace Bascanka.Core.Tests.Transforms;
+
+/// <summary>
+/// Chunked transforms must give the same result as transforming the whole
+/// range at once, however the chunks fall.
+/// </summary>
+public sealed class ChunkedTransformerTests
+{
+    [Test]
+    public void ParallelChunksCommitAsOneBulkEdit()
+    {
+        var sb = new StringBuilder();
+        for (int i = 0; i < 200_000; i++)
+            sb.Append(i % 3 == 0 ? "ALREADY UPPER\n" : $"line {i} mixed Case\n");
+        string text = sb.ToString();
+        var doc = new PieceTable(text);
+        long start = 7;
+
+        var edits = ChunkedTransformer.CreateEdits(doc, start, text.Length - start,
+            ChunkTransform.PerLine(s => s.ToUpperInvariant()));
+        new BulkEditCommand(doc, edits).Execute();
+
+        Assert.True(edits.Count > 1);
+        Assert.Equal(text[..(int)start] + text[(int)start..].ToUpperInvariant(), doc.GetText(0, (int)doc.Length));
+    }
+
+    [Test]
+    public void Base64CarriesAcrossChunks()
+    {
+        // Three-byte groups, surrogate pairs and UTF-8 sequences all straddle
+        // the 1M-character chunk boundaries somewhere in here.
+        var sb = new StringBuilder();
+        for (int i = 0; sb.Length < 2_500_000; i++)
+            sb.Append(i % 5 == 0 ? "😀" : i % 7 == 0 ? "中é" : "ab");
+        string text = sb.ToString();
+
+        string encoded = Write(text, new Base64EncodeTransform());
+        Assert.Equal(Convert.ToBase64String(TextEncoding.UTF8.GetBytes(text)), encoded);
+
+        // Decoding ignores line breaks, as Convert.FromBase64String does.
+        string wrapped = string.Join("\r\n", encoded.Chunk(76).Select(c => new string(c)));
+        Assert.Equal(text, Write(wrapped, new Base64DecodeTransform()));
+    }
+
+    [Test]
+    public void InvalidBase64AndCancellationThrow()
+    {
+        foreach (string bad in new[] { "QUJD!", "QUI", "QQ==QQ==" })
+        {
+            bool threw = false;
+            try { Write(bad, new Base64DecodeTransform()); }
+            catch (FormatException) { threw = true; }
+            Assert.True(threw, bad);
+        }
+
+        bool cancelled = false;
+        try
+        {
+            ChunkedTransformer.CreateEdits(new PieceTable("a\nb\n"), 0, 4,
+                ChunkTransform.PerLine(s => s), cancellationToken: new CancellationToken(canceled: true));
+        }
+        catch (OperationCanceledException) { cancelled = true; }
+        Assert.True(cancelled);
+    }
+
+    private static string Write(string text, ChunkTransform transform)
+    {
+        var output = new StringWriter();
+        ChunkedTransformer.WriteTo(new PieceTable(text), 0, text.Length, transform, output);
+        return output.ToString();
+    }
+}
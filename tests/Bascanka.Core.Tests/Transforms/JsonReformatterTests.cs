@@ -0,0 +1,76 @@
+using System.Text;
+using TextEncoding = System.Text.Encoding;
+using System.Text.Encodings.Web;
+using System.Text.Json;
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Transforms;
+
+namespace Bascanka.Core.Tests.Transforms;
+
+/// <summary>
+/// Streaming reformatting must match formatting the parsed document in
+/// one piece, also when tokens straddle the reader's windows.
+/// </summary>
+public sealed class JsonReformatterTests
+{
+    [Test]
+    public void LargeDocumentMatchesInMemoryFormatting()
+    {
+        var sb = new StringBuilder("[\n");
+        for (int i = 0; i < 40_000; i++)
+        {
+            if (i > 0) sb.Append(",\n");
+            sb.Append($$"""  {"id": {{i}}, "price": {{i}}.50e-3, "name": "item \"{{i}}\" é中😀", "tags": [true, false, null], "empty": {} }""");
+        }
+        sb.Append("\n]");
+        string json = sb.ToString();
+
+        foreach (bool indented in new[] { true, false })
+            Assert.Equal(Reference(json, indented), Run(json, indented));
+    }
+
+    [Test]
+    public void NumbersCommentsAndTrailingCommas()
+    {
+        const string json = "{ /* note */ \"big\": 12345678901234567890.000, \"list\": [1, 2,], }";
+
+        Assert.Equal("{\"big\":12345678901234567890.000,\"list\":[1,2]}", Run(json, indented: false));
+    }
+
+    [Test]
+    public void InvalidJsonThrows()
+    {
+        foreach (string json in new[] { "{\"a\": [1, 2}", "   ", "{} {}" })
+        {
+            bool threw = false;
+            try { Run(json, indented: true); }
+            catch (JsonException) { threw = true; }
+            Assert.True(threw, json);
+        }
+    }
+
+    private static string Run(string json, bool indented)
+    {
+        var output = new StringWriter();
+        new JsonReformatter(indented).Reformat(new PieceTable(json), 0, json.Length, output);
+        return output.ToString();
+    }
+
+    private static string Reference(string json, bool indented)
+    {
+        using var doc = JsonDocument.Parse(json);
+        using var ms = new MemoryStream();
+        using (var writer = new Utf8JsonWriter(ms, new JsonWriterOptions
+        {
+            Indented = indented,
+            IndentCharacter = '\t',
+            IndentSize = 1,
+            NewLine = "\n",
+            Encoder = JavaScriptEncoder.UnsafeRelaxedJsonEscaping,
+        }))
+        {
+            doc.WriteTo(writer);
+        }
+        return TextEncoding.UTF8.GetString(ms.ToArray());
+    }
+}
@@ -0,0 +1,55 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Transforms;
+
+namespace Bascanka.Core.Tests.Transforms;
+
+/// <summary>
+/// Every mode must keep first occurrences in input order, whether the hash
+/// table stays in memory or is partitioned to disk.
+/// </summary>
+public sealed class LineDeduplicatorTests
+{
+    [Test]
+    public void ModesKeepFirstOccurrencesInOrder()
+    {
+        const string text = "b\r\na\r\nb\r\nc\r\na\r\nb\r\n";
+
+        Assert.Equal("b\r\na\r\nc\r\n", Run(text, DuplicateLineMode.RemoveDuplicates));
+        Assert.Equal("b\r\na\r\n", Run(text, DuplicateLineMode.KeepOnlyDuplicates));
+        Assert.Equal("3\tb\r\n2\ta\r\n1\tc\r\n", Run(text, DuplicateLineMode.CountDuplicates));
+    }
+
+    [Test]
+    public void PartitionedTableGivesTheSameResult()
+    {
+        var random = new Random(92);
+        string[] lines = Enumerable.Range(0, 30_000)
+            .Select(_ => $"line {random.Next(12_000)}")
+            .ToArray();
+        string text = string.Join('\n', lines);
+
+        var counts = lines.GroupBy(l => l).ToDictionary(g => g.Key, g => g.Count());
+        var distinct = lines.Distinct().ToArray();
+        var expected = new Dictionary<DuplicateLineMode, string>
+        {
+            [DuplicateLineMode.RemoveDuplicates] = string.Join('\n', distinct),
+            [DuplicateLineMode.KeepOnlyDuplicates] = string.Join('\n', distinct.Where(l => counts[l] > 1)),
+            [DuplicateLineMode.CountDuplicates] = string.Join('\n', distinct.Select(l => $"{counts[l]}\t{l}")),
+        };
+
+        foreach (var (mode, result) in expected)
+        {
+            // 48 bytes per distinct line: the table overflows after ~1000 lines.
+            Assert.Equal(result, Run(text, mode, memoryBudget: 48 * 1000));
+            Assert.Equal(result, Run(text, mode));
+        }
+    }
+
+    private static string Run(string text, DuplicateLineMode mode, long memoryBudget = 1024 * 1024)
+    {
+        var output = new StringWriter();
+        new LineDeduplicator(new DuplicateLineOptions { Mode = mode, MemoryBudget = memoryBudget })
+            .Deduplicate(new PieceTable(text), 0, text.Length, output);
+        return output.ToString();
+    }
+}
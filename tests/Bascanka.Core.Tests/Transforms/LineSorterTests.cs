@@ -0,0 +1,73 @@
+using Bascanka.Core.Buffer;
+using Bascanka.Core.Transforms;
+
+namespace Bascanka.Core.Tests.Transforms;
+
+/// <summary>
+/// Sorting through spilled runs must give the same stable order as an
+/// in-memory sort, for every comparison and key option.
+/// </summary>
+public sealed class LineSorterTests
+{
+    [Test]
+    public void SpilledRunsMergeIntoAStableOrder()
+    {
+        var random = new Random(91);
+        string[] lines = Enumerable.Range(0, 20_000)
+            .Select(i => $"{(char)('a' + random.Next(26))}{random.Next(50)} #{i}")
+            .ToArray();
+        string text = string.Join('\n', lines) + "\n";
+
+        foreach (var comparison in new[] { LineComparison.Ordinal, LineComparison.IgnoreCase })
+        {
+            // Keys are the part before '#', so equal keys must keep input order.
+            var options = new LineSortOptions
+            {
+                Comparison = comparison,
+                KeyField = 1,
+                MemoryBudget = 64 * 1024,
+            };
+            var expected = lines.OrderBy(l => l.Split(' ')[0], StringComparer.Ordinal);
+            Assert.Equal(string.Join('\n', expected) + "\n", Sort(text, options));
+        }
+    }
+
+    [Test]
+    public void NumericDescendingKeepsEqualKeysInOrder()
+    {
+        const string text = "b,10\na,2.5\nc,10\nd,x\ne,-3\nf,11.";
+        var options = new LineSortOptions
+        {
+            Comparison = LineComparison.Numeric,
+            Descending = true,
+            KeyField = 2,
+            FieldSeparator = ',',
+        };
+
+        Assert.Equal("f,11.\nb,10\nc,10\na,2.5\ne,-3\nd,x", Sort(text, options));
+    }
+
+    [Test]
+    public void OnlyTheSelectedRangeIsSorted()
+    {
+        var doc = new PieceTable("keep\nzeta\nAlpha\nbeta\nkeep");
+        long start = "keep\n".Length;
+        long length = "zeta\nAlpha\nbeta\n".Length;
+        var output = new StringWriter();
+
+        new LineSorter(new LineSortOptions { Comparison = LineComparison.IgnoreCase })
+            .Sort(doc, start, length, output);
+
+        Assert.Equal("Alpha\nbeta\nzeta\n", output.ToString());
+
+        // CRLF text keeps CRLF, including the last line of an unterminated range.
+        Assert.Equal("a\r\nb\r\nc", Sort("c\r\nb\r\na", new LineSortOptions()));
+    }
+
+    private static string Sort(string text, LineSortOptions options)
+    {
+        var output = new StringWriter();
+        new LineSorter(options).Sort(new PieceTable(text), 0, text.Length, output);
+        return output.ToString();
+    }
+}